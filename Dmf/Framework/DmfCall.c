@@ -3150,7 +3150,10 @@ Return Value:
 
     dmfObject = DMF_ModuleToObject(DmfModule);
 
-    if (dmfObject->Synchronizations[DMF_DEFAULT_LOCK_INDEX].LockHeldByThread != NULL)
+    // NOTE: Shared owners are not tracked by thread. Any shared owner means the lock is held.
+    //
+    if ((dmfObject->Synchronizations[DMF_DEFAULT_LOCK_INDEX].LockHeldByThread != NULL) ||
+        (dmfObject->Synchronizations[DMF_DEFAULT_LOCK_INDEX].Statistics.SharedOwners > 0))
     {
         lockHeld = TRUE;
     }
@@ -3278,7 +3281,8 @@ Return Value:
         // Device lock is at 0. Auxiliary locks starts from 1.
         // AuxiliaryLockIndex is 0 based
         //
-        if (dmfObject->Synchronizations[AuxiliaryLockIndex + DMF_NUMBER_OF_DEFAULT_LOCKS].LockHeldByThread != NULL)
+        if ((dmfObject->Synchronizations[AuxiliaryLockIndex + DMF_NUMBER_OF_DEFAULT_LOCKS].LockHeldByThread != NULL) ||
+            (dmfObject->Synchronizations[AuxiliaryLockIndex + DMF_NUMBER_OF_DEFAULT_LOCKS].Statistics.SharedOwners > 0))
         {
             lockHeld = TRUE;
         }
@@ -3297,6 +3301,274 @@ Return Value:
 }
 #endif // defined(DEBUG)
 
+#if defined(DMF_LOCK_PROFILING)
+static
+ULONG64
+DmfModuleLockStatisticsMicrosecondsGet(
+    _In_ LONGLONG Ticks,
+    _In_ LONGLONG Frequency
+    )
+/*++
+
+Routine Description:
+
+    Convert a lock statistics time from performance counter ticks to microseconds.
+
+Arguments:
+
+    Ticks - The time in performance counter ticks.
+    Frequency - Performance counter ticks per second.
+
+Return Value:
+
+    The time in microseconds.
+
+--*/
+{
+    ULONG64 microseconds;
+
+    if ((Ticks <= 0) ||
+        (Frequency <= 0))
+    {
+        microseconds = 0;
+    }
+    else
+    {
+        // Split the conversion so that it does not overflow for large totals.
+        //
+        microseconds = ((ULONG64)(Ticks / Frequency) * 1000000) +
+                       (((ULONG64)(Ticks % Frequency) * 1000000) / (ULONG64)Frequency);
+    }
+
+    return microseconds;
+}
+
+#pragma code_seg("PAGE")
+static
+VOID
+DmfModuleLockStatisticsEnumerate(
+    _In_ DMF_OBJECT* DmfObject,
+    _In_ EVT_DMF_MODULE_LockStatistics* LockStatisticsCallback,
+    _In_opt_ VOID* CallbackContext
+    )
+/*++
+
+Routine Description:
+
+    Call the given callback for each lock of the given DMF Module and all its Child Modules.
+
+Arguments:
+
+    DmfObject - The given DMF Object.
+    LockStatisticsCallback - Called for each lock.
+    CallbackContext - Passed to LockStatisticsCallback.
+
+Return Value:
+
+    None
+
+--*/
+{
+    DMF_OBJECT* childDmfObject;
+    CHILD_OBJECT_INTERATION_CONTEXT childObjectIterationContext;
+    DMFMODULE dmfModule;
+    DMF_MODULE_LOCK_STATISTICS lockStatistics;
+    ULONG lockIndex;
+    NTSTATUS ntStatus;
+
+    PAGED_CODE();
+
+    childDmfObject = DmfChildObjectFirstGet(DmfObject,
+                                            &childObjectIterationContext);
+    while (childDmfObject != NULL)
+    {
+        DmfModuleLockStatisticsEnumerate(childDmfObject,
+                                         LockStatisticsCallback,
+                                         CallbackContext);
+        childDmfObject = DmfChildObjectNextGet(&childObjectIterationContext);
+    }
+
+    dmfModule = DMF_ObjectToModule(DmfObject);
+    for (lockIndex = 0; lockIndex < DmfObject->ModuleDescriptor.NumberOfAuxiliaryLocks + DMF_NUMBER_OF_DEFAULT_LOCKS; lockIndex++)
+    {
+        ntStatus = DMF_ModuleLockStatisticsGet(dmfModule,
+                                               lockIndex,
+                                               &lockStatistics);
+        if (NT_SUCCESS(ntStatus))
+        {
+            LockStatisticsCallback(dmfModule,
+                                   &lockStatistics,
+                                   CallbackContext);
+        }
+    }
+}
+#pragma code_seg()
+#endif // defined(DMF_LOCK_PROFILING)
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+_Must_inspect_result_
+NTSTATUS
+DMF_ModuleLockStatisticsGet(
+    _In_ DMFMODULE DmfModule,
+    _In_ ULONG LockIndex,
+    _Out_ DMF_MODULE_LOCK_STATISTICS* LockStatistics
+    )
+/*++
+
+Routine Description:
+
+    Returns the lock profiling data of one of the given DMF Module's locks.
+
+Arguments:
+
+    DmfModule - The given DMF Module.
+    LockIndex - Index of the lock. Module lock is at 0. Auxiliary locks start from 1.
+    LockStatistics - The lock profiling data is written here.
+
+Return Value:
+
+    STATUS_SUCCESS - LockStatistics is valid.
+    STATUS_INVALID_PARAMETER - The Module does not have the given lock.
+    STATUS_NOT_SUPPORTED - DMF is not built with DMF_LOCK_PROFILING.
+
+--*/
+{
+    NTSTATUS ntStatus;
+#if defined(DMF_LOCK_PROFILING)
+    DMF_OBJECT* dmfObject;
+    DMF_SYNCHRONIZATION_STATISTICS* statistics;
+#endif // defined(DMF_LOCK_PROFILING)
+
+    DmfAssert(LockStatistics != NULL);
+
+    RtlZeroMemory(LockStatistics,
+                  sizeof(DMF_MODULE_LOCK_STATISTICS));
+
+#if defined(DMF_LOCK_PROFILING)
+    dmfObject = DMF_ModuleToObject(DmfModule);
+    DmfAssert(dmfObject != NULL);
+
+    if (LockIndex >= dmfObject->ModuleDescriptor.NumberOfAuxiliaryLocks + DMF_NUMBER_OF_DEFAULT_LOCKS)
+    {
+        ntStatus = STATUS_INVALID_PARAMETER;
+        goto Exit;
+    }
+
+    statistics = &dmfObject->Synchronizations[LockIndex].Statistics;
+
+    strncpy_s(LockStatistics->ModuleInstanceName,
+              sizeof(LockStatistics->ModuleInstanceName),
+              dmfObject->ClientModuleInstanceName,
+              sizeof(LockStatistics->ModuleInstanceName) - sizeof(CHAR));
+    LockStatistics->LockIndex = LockIndex;
+
+    // NOTE: The lock is not acquired here so the values may be slightly inconsistent
+    //       with each other if the lock is in use.
+    //
+    LockStatistics->ExclusiveAcquisitions = (ULONG64)statistics->ExclusiveAcquisitions;
+    LockStatistics->SharedAcquisitions = (ULONG64)statistics->SharedAcquisitions;
+    LockStatistics->ContendedAcquisitions = (ULONG64)statistics->ContendedAcquisitions;
+    LockStatistics->HoldTimeTotalMicroseconds = DmfModuleLockStatisticsMicrosecondsGet(statistics->ExclusiveHoldTimeTotal,
+                                                                                       statistics->TimestampFrequency);
+    LockStatistics->HoldTimeMaximumMicroseconds = DmfModuleLockStatisticsMicrosecondsGet(statistics->ExclusiveHoldTimeMaximum,
+                                                                                         statistics->TimestampFrequency);
+    LockStatistics->WaitTimeMaximumMicroseconds = DmfModuleLockStatisticsMicrosecondsGet(statistics->WaitTimeMaximum,
+                                                                                         statistics->TimestampFrequency);
+
+    ntStatus = STATUS_SUCCESS;
+#else
+    UNREFERENCED_PARAMETER(DmfModule);
+    UNREFERENCED_PARAMETER(LockIndex);
+
+    ntStatus = STATUS_NOT_SUPPORTED;
+    goto Exit;
+#endif // defined(DMF_LOCK_PROFILING)
+
+Exit:
+
+    return ntStatus;
+}
+
+#pragma code_seg("PAGE")
+_IRQL_requires_max_(PASSIVE_LEVEL)
+_Must_inspect_result_
+NTSTATUS
+DMF_ModuleLockStatisticsEnumerate(
+    _In_ DMFMODULE DmfModule,
+    _In_ EVT_DMF_MODULE_LockStatistics* LockStatisticsCallback,
+    _In_opt_ VOID* CallbackContext
+    )
+/*++
+
+Routine Description:
+
+    Call the given callback with the lock profiling data of every lock of every Module
+    in the Module Collection that contains the given DMF Module. If the given DMF Module is
+    a Dynamic Module, only the locks of that Module and its Child Modules are enumerated.
+
+Arguments:
+
+    DmfModule - The given DMF Module.
+    LockStatisticsCallback - Called for each lock.
+    CallbackContext - Passed to LockStatisticsCallback.
+
+Return Value:
+
+    STATUS_SUCCESS - All the locks have been enumerated.
+    STATUS_NOT_SUPPORTED - DMF is not built with DMF_LOCK_PROFILING.
+
+--*/
+{
+    NTSTATUS ntStatus;
+#if defined(DMF_LOCK_PROFILING)
+    DMF_OBJECT* dmfObject;
+    DMF_MODULE_COLLECTION* moduleCollection;
+    LONG driverModuleIndex;
+#endif // defined(DMF_LOCK_PROFILING)
+
+    PAGED_CODE();
+
+    FuncEntry(DMF_TRACE);
+
+    DmfAssert(LockStatisticsCallback != NULL);
+
+#if defined(DMF_LOCK_PROFILING)
+    dmfObject = DMF_ModuleToObject(DmfModule);
+    DmfAssert(dmfObject != NULL);
+
+    moduleCollection = dmfObject->ModuleCollection;
+    if (NULL == moduleCollection)
+    {
+        DmfModuleLockStatisticsEnumerate(dmfObject,
+                                         LockStatisticsCallback,
+                                         CallbackContext);
+    }
+    else
+    {
+        for (driverModuleIndex = 0; driverModuleIndex < moduleCollection->NumberOfClientDriverDmfModules; driverModuleIndex++)
+        {
+            DmfAssert(moduleCollection->ClientDriverDmfModules[driverModuleIndex] != NULL);
+            DmfModuleLockStatisticsEnumerate(moduleCollection->ClientDriverDmfModules[driverModuleIndex],
+                                             LockStatisticsCallback,
+                                             CallbackContext);
+        }
+    }
+
+    ntStatus = STATUS_SUCCESS;
+#else
+    UNREFERENCED_PARAMETER(DmfModule);
+    UNREFERENCED_PARAMETER(LockStatisticsCallback);
+    UNREFERENCED_PARAMETER(CallbackContext);
+
+    ntStatus = STATUS_NOT_SUPPORTED;
+#endif // defined(DMF_LOCK_PROFILING)
+
+    FuncExit(DMF_TRACE, "ntStatus=%!STATUS!", ntStatus);
+
+    return ntStatus;
+}
+#pragma code_seg()
+
 _Must_inspect_result_
 NTSTATUS
 DMF_Module_ResourcesAssign(
@@ -245,6 +245,87 @@ Return Value:
 }
 #pragma code_seg()
 
+#pragma code_seg("PAGE")
+static
+VOID*
+DmfModuleMemoryAllocate(
+    _In_ DMF_OBJECT* DmfObject,
+    _In_ size_t Size,
+    _In_ ULONG Tag
+    )
+/*++
+
+Routine Description:
+
+    Allocates memory owned by DMF on behalf of a given DMF_OBJECT. The memory is carved from
+    the Module's arena if it has one. Otherwise, it is allocated from pool.
+
+Arguments:
+
+    DmfObject - The given DMF_OBJECT structure.
+    Size - Number of bytes to allocate.
+    Tag - Tag to assign for debug purposes.
+
+Return Value:
+
+    NULL if memory cannot be allocated.
+    If not NULL, it is the address of allocated memory
+
+--*/
+{
+    VOID* returnValue;
+
+    PAGED_CODE();
+
+    if (DmfObject->ModuleArena != NULL)
+    {
+        returnValue = DMF_ModuleArenaAllocate(DmfObject->ModuleArena,
+                                              Size);
+    }
+    else
+    {
+        returnValue = DMF_GenericMemoryAllocate(POOL_FLAG_NON_PAGED,
+                                                Size,
+                                                Tag);
+    }
+
+    return returnValue;
+}
+#pragma code_seg()
+
+static
+VOID
+DmfModuleMemoryFree(
+    _In_ DMF_OBJECT* DmfObject,
+    _In_ VOID* Pointer,
+    _In_ ULONG Tag
+    )
+/*++
+
+Routine Description:
+
+    Frees memory allocated by DmfModuleMemoryAllocate(). Memory carved from the Module's
+    arena is not freed here. It is freed when the last Module that uses the arena is destroyed.
+
+Arguments:
+
+    DmfObject - The given DMF_OBJECT structure.
+    Pointer - Address of memory to free.
+    Tag - Tag to assign for debug purposes.
+
+Return Value:
+
+    None
+
+--*/
+{
+    if (NULL == DmfObject->ModuleArena)
+    {
+        DMF_GenericMemoryFree(Pointer,
+                              Tag);
+    }
+}
+
 #pragma code_seg("PAGE")
 _Must_inspect_result_
 static
@@ -308,9 +389,9 @@ Return Value:
     // Allocate space for the instance name. This name is useful during debugging.
     // NOTE: Don't use WDFMEMORY to reduce number of use WDFOBJECT.
     //
-    DmfObject->ClientModuleInstanceName = (CHAR*)DMF_GenericMemoryAllocate(POOL_FLAG_NON_PAGED,
-                                                                           DmfObject->ClientModuleInstanceNameSizeBytes,
-                                                                           DMF_TAG0);
+    DmfObject->ClientModuleInstanceName = (CHAR*)DmfModuleMemoryAllocate(DmfObject,
+                                                                         DmfObject->ClientModuleInstanceNameSizeBytes,
+                                                                         DMF_TAG0);
     if (DmfObject->ClientModuleInstanceName == NULL)
     {
         TraceEvents(TRACE_LEVEL_ERROR, DMF_TRACE, "Unable to allocate ClientModuleInstanceName");
@@ -376,9 +457,9 @@ Return Value:
     if (DmfModuleAttributes->SizeOfModuleSpecificConfig != NULL)
     {
         DmfAssert(ModuleDescriptor->ModuleConfigSize == DmfModuleAttributes->SizeOfModuleSpecificConfig);
-        DmfObject->ModuleConfig = DMF_GenericMemoryAllocate(POOL_FLAG_NON_PAGED,
-                                                            ModuleDescriptor->ModuleConfigSize,
-                                                            DMF_TAG1);
+        DmfObject->ModuleConfig = DmfModuleMemoryAllocate(DmfObject,
+                                                          ModuleDescriptor->ModuleConfigSize,
+                                                          DMF_TAG1);
         if (DmfObject->ModuleConfig == NULL)
         {
             ntStatus = STATUS_INSUFFICIENT_RESOURCES;
@@ -471,9 +552,9 @@ Return Value:
 
     PAGED_CODE();
 
-    DmfObject->ModuleDescriptor.CallbacksDmf = (DMF_CALLBACKS_DMF*)DMF_GenericMemoryAllocate(POOL_FLAG_NON_PAGED,
-                                                                                             sizeof(DMF_CALLBACKS_DMF),
-                                                                                             DMF_TAG2);
+    DmfObject->ModuleDescriptor.CallbacksDmf = (DMF_CALLBACKS_DMF*)DmfModuleMemoryAllocate(DmfObject,
+                                                                                           sizeof(DMF_CALLBACKS_DMF),
+                                                                                           DMF_TAG2);
     if (NULL == DmfObject->ModuleDescriptor.CallbacksDmf)
     {
         ntStatus = STATUS_INSUFFICIENT_RESOURCES;
@@ -484,13 +565,14 @@ Return Value:
     RtlZeroMemory(DmfObject->ModuleDescriptor.CallbacksDmf,
                   sizeof(DMF_CALLBACKS_DMF));
 
-    DmfObject->ModuleDescriptor.CallbacksWdf = (DMF_CALLBACKS_WDF*)DMF_GenericMemoryAllocate(POOL_FLAG_NON_PAGED,
-                                                                                             sizeof(DMF_CALLBACKS_WDF),
-                                                                                             DMF_TAG3);
+    DmfObject->ModuleDescriptor.CallbacksWdf = (DMF_CALLBACKS_WDF*)DmfModuleMemoryAllocate(DmfObject,
+                                                                                           sizeof(DMF_CALLBACKS_WDF),
+                                                                                           DMF_TAG3);
     if (NULL == DmfObject->ModuleDescriptor.CallbacksWdf)
     {
-        DMF_GenericMemoryFree(DmfObject->ModuleDescriptor.CallbacksDmf,
-                              DMF_TAG2);
+        DmfModuleMemoryFree(DmfObject,
+                            DmfObject->ModuleDescriptor.CallbacksDmf,
+                            DMF_TAG2);
         ntStatus = STATUS_INSUFFICIENT_RESOURCES;
         TraceEvents(TRACE_LEVEL_ERROR, DMF_TRACE, "WdfMemoryCreate fails: ntStatus=%!STATUS!", ntStatus);
         DmfObject->ModuleDescriptor.CallbacksDmf = NULL;
@@ -1268,6 +1350,18 @@ Return Value:
     dmfObject->ClientEvtCleanupCallback = clientEvtCleanupCallback;
     dmfObject->IsTransport = DmfModuleAttributes->IsTransportModule;
 
+    // Static Modules created by a Module Collection carve their DMF owned allocations from
+    // the Module Collection's arena. Dynamic Modules use their own allocations because they
+    // can be created and destroyed at any time.
+    //
+    if ((DmfModuleAttributes->ModuleArena != NULL) &&
+        (! DmfModuleAttributes->DynamicModule) &&
+        (! DmfModuleAttributes->DynamicModuleImmediate))
+    {
+        dmfObject->ModuleArena = (DMF_MODULE_ARENA*)DmfModuleAttributes->ModuleArena;
+        DMF_ModuleArenaReference(dmfObject->ModuleArena);
+    }
+
     // Initialize the Module State.
     // This state is to prevent asserts during fault-injection or low memory conditions.
     //
@@ -1313,6 +1407,10 @@ Return Value:
     //
     dmfObject->ModuleDescriptor.NumberOfAuxiliaryLocks = ModuleDescriptor->NumberOfAuxiliaryLocks;
 
+    // Copy the IOCTL codes declaration callback.
+    //
+    dmfObject->ModuleDescriptor.ModuleIoctlCodesGet = ModuleDescriptor->ModuleIoctlCodesGet;
+
     // IMPORTANT: The object has now been initialized so deletion code will work in case there is a 
     //            subsequent failure.
     //
@@ -1560,28 +1658,37 @@ Exit:
                 //
                 if (dmfObject->ClientModuleInstanceName != NULL)
                 {
-                    DMF_GenericMemoryFree(dmfObject->ClientModuleInstanceName,
-                                          DMF_TAG0);
+                    DmfModuleMemoryFree(dmfObject,
+                                        dmfObject->ClientModuleInstanceName,
+                                        DMF_TAG0);
                     dmfObject->ClientModuleInstanceName = NULL;
                 }
                 if (dmfObject->ModuleDescriptor.CallbacksDmf != NULL)
                 {
-                    DMF_GenericMemoryFree(dmfObject->ModuleDescriptor.CallbacksDmf,
-                                          DMF_TAG2);
+                    DmfModuleMemoryFree(dmfObject,
+                                        dmfObject->ModuleDescriptor.CallbacksDmf,
+                                        DMF_TAG2);
                     dmfObject->ModuleDescriptor.CallbacksDmf = NULL;
                 }
                 if (dmfObject->ModuleDescriptor.CallbacksWdf != NULL)
                 {
-                    DMF_GenericMemoryFree(dmfObject->ModuleDescriptor.CallbacksWdf,
-                                          DMF_TAG3);
+                    DmfModuleMemoryFree(dmfObject,
+                                        dmfObject->ModuleDescriptor.CallbacksWdf,
+                                        DMF_TAG3);
                     dmfObject->ModuleDescriptor.CallbacksWdf = NULL;
                 }
                 if (dmfObject->ModuleConfig != NULL)
                 {
-                    DMF_GenericMemoryFree(dmfObject->ModuleConfig,
-                                          DMF_TAG1);
+                    DmfModuleMemoryFree(dmfObject,
+                                        dmfObject->ModuleConfig,
+                                        DMF_TAG1);
                     dmfObject->ModuleConfig = NULL;
                 }
+                if (dmfObject->ModuleArena != NULL)
+                {
+                    DMF_ModuleArenaDereference(dmfObject->ModuleArena);
+                    dmfObject->ModuleArena = NULL;
+                }
             }
 
             // All subsequent allocations after memoryDmfObject use memoryDmfObject as parent. So, this
@@ -1707,8 +1814,9 @@ Return Value:
     //
     if (dmfObject->ClientModuleInstanceName != NULL)
     {
-        DMF_GenericMemoryFree(dmfObject->ClientModuleInstanceName,
-                              DMF_TAG0);
+        DmfModuleMemoryFree(dmfObject,
+                            dmfObject->ClientModuleInstanceName,
+                            DMF_TAG0);
         dmfObject->ClientModuleInstanceName = NULL;
     }
 
@@ -1716,8 +1824,9 @@ Return Value:
     //
     if (dmfObject->ModuleDescriptor.CallbacksDmf != NULL)
     {
-        DMF_GenericMemoryFree(dmfObject->ModuleDescriptor.CallbacksDmf,
-                              DMF_TAG2);
+        DmfModuleMemoryFree(dmfObject,
+                            dmfObject->ModuleDescriptor.CallbacksDmf,
+                            DMF_TAG2);
         dmfObject->ModuleDescriptor.CallbacksDmf = NULL;
     }
 
@@ -1725,8 +1834,9 @@ Return Value:
     //
     if (dmfObject->ModuleDescriptor.CallbacksWdf)
     {
-        DMF_GenericMemoryFree(dmfObject->ModuleDescriptor.CallbacksWdf,
-                              DMF_TAG3);
+        DmfModuleMemoryFree(dmfObject,
+                            dmfObject->ModuleDescriptor.CallbacksWdf,
+                            DMF_TAG3);
         dmfObject->ModuleDescriptor.CallbacksWdf = NULL;
     }
 
@@ -1743,8 +1853,9 @@ Return Value:
 
     if (dmfObject->ModuleConfig != NULL)
     {
-        DMF_GenericMemoryFree(dmfObject->ModuleConfig,
-                              DMF_TAG1);
+        DmfModuleMemoryFree(dmfObject,
+                            dmfObject->ModuleConfig,
+                            DMF_TAG1);
         dmfObject->ModuleConfig = NULL;
     }
     else
@@ -1753,6 +1864,14 @@ Return Value:
         //
     }
 
+    // The arena is freed when the last Module that carved memory from it is destroyed.
+    //
+    if (dmfObject->ModuleArena != NULL)
+    {
+        DMF_ModuleArenaDereference(dmfObject->ModuleArena);
+        dmfObject->ModuleArena = NULL;
+    }
+
     // This event must be manually deleted for User-mode.
     //
     DMF_Portable_EventClose(&dmfObject->ModuleCanBeDeletedEvent);
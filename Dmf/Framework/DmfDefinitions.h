@@ -216,6 +216,31 @@ DMF_ModuleTransportMethod(_In_ DMFMODULE DmfModule,
                           _Out_writes_(OutputBufferSize) VOID* OutputBuffer,
                           _In_ size_t OutputBufferSize);
 
+// Type of lock DMF creates for a Module's default lock and auxiliary locks.
+// Modules use DMF_ModuleLock()/DMF_ModuleAuxiliaryLock() when they modify data and
+// DMF_ModuleLockShared()/DMF_ModuleAuxiliaryLockShared() when they only read data.
+//
+typedef enum
+{
+    // WDFWAITLOCK (PASSIVE_LEVEL) or WDFSPINLOCK (DISPATCH_LEVEL).
+    // Shared acquisitions are exclusive.
+    //
+    DMF_MODULE_LOCK_TYPE_Exclusive = 0,
+    // Kernel-mode: EX_PUSH_LOCK (PASSIVE_LEVEL) or EX_SPIN_LOCK (DISPATCH_LEVEL).
+    // User-mode: SRWLOCK.
+    // Shared acquisitions do not block each other.
+    //
+    DMF_MODULE_LOCK_TYPE_ReaderWriter,
+    // One WDFWAITLOCK (PASSIVE_LEVEL) or WDFSPINLOCK (DISPATCH_LEVEL) per processor.
+    // Shared acquisitions only acquire the lock of the current processor. Exclusive acquisitions
+    // acquire all the locks. Use it when exclusive acquisitions are rare.
+    //
+    DMF_MODULE_LOCK_TYPE_Sharded,
+    // Sentinel.
+    //
+    DMF_MODULE_LOCK_TYPE_Maximum
+} DMF_MODULE_LOCK_TYPE;
+
 typedef struct _DMF_MODULE_ATTRIBUTES
 {
     // Size of this Structure.
@@ -260,9 +285,15 @@ typedef struct _DMF_MODULE_ATTRIBUTES
     // NOTE: Module Options must be set to MODULE_OPTIONS_DISPATCH_MAXIMUM.
     //
     BOOLEAN PassiveLevel;
+    // Type of lock used for the Module's default lock and auxiliary locks.
+    //
+    DMF_MODULE_LOCK_TYPE LockType;
     // Indicates that this Module is a Transport Module.
     //
     BOOLEAN IsTransportModule;
+    // Set by DMF only. Module Arena of the Module Collection that creates this Module.
+    //
+    VOID* ModuleArena;
 } DMF_MODULE_ATTRIBUTES;
 
 __forceinline
@@ -1241,6 +1272,26 @@ DMF_DmfFdoSetFilter(
     _In_ PDMFDEVICE_INIT DmfDeviceInit
     );
 
+// Counters that show how many IOCTLs were dispatched to the Modules of a WDFDEVICE.
+//
+typedef struct
+{
+    // Number of IOCTLs (including internal IOCTLs) that were not dispatched because no Module handles them.
+    // Filter drivers send these Requests down the stack immediately.
+    //
+    LONG64 IoctlsBypassed;
+    // Number of IOCTLs (including internal IOCTLs) that were dispatched to the Modules.
+    //
+    LONG64 IoctlsDispatched;
+} DMF_IOCTL_DISPATCH_STATISTICS;
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+VOID
+DMF_IoctlDispatchStatisticsGet(
+    _In_ WDFDEVICE Device,
+    _Out_ DMF_IOCTL_DISPATCH_STATISTICS* IoctlDispatchStatistics
+    );
+
 _IRQL_requires_max_(PASSIVE_LEVEL)
 VOID
 DMF_DmfModuleAdd(
@@ -1649,6 +1700,70 @@ DMF_Utility_CrcCompute(
     _In_ UINT32 NumberOfBytes
     );
 
+_Must_inspect_result_
+_IRQL_requires_same_
+UINT32
+DMF_Utility_Crc32Compute(
+    _In_reads_bytes_(NumberOfBytes) UINT8* Message,
+    _In_ size_t NumberOfBytes
+    );
+
+_Must_inspect_result_
+_IRQL_requires_same_
+UINT32
+DMF_Utility_Crc32cCompute(
+    _In_reads_bytes_(NumberOfBytes) UINT8* Message,
+    _In_ size_t NumberOfBytes
+    );
+
+// CRCs supported by DMF_Utility_Crc* functions.
+//
+typedef enum
+{
+    DmfCrcType_Invalid = 0,
+    // 16-bit CRC computed by DMF_Utility_CrcCompute() (CRC-16/CCITT-FALSE).
+    //
+    DmfCrcType_Crc16,
+    // CRC-32 (IEEE 802.3) computed by DMF_Utility_Crc32Compute().
+    //
+    DmfCrcType_Crc32,
+    // CRC-32C (Castagnoli) computed by DMF_Utility_Crc32cCompute().
+    //
+    DmfCrcType_Crc32c,
+    DmfCrcType_Maximum
+} DmfCrcType;
+
+// Allows a CRC to be computed over a message that is given in pieces.
+// Clients should treat the contents as opaque.
+//
+typedef struct
+{
+    DmfCrcType CrcType;
+    UINT32 AccumulatedValue;
+} DMF_CRC_CONTEXT;
+
+_IRQL_requires_same_
+VOID
+DMF_Utility_CrcInitialize(
+    _Out_ DMF_CRC_CONTEXT* CrcContext,
+    _In_ DmfCrcType CrcType
+    );
+
+_IRQL_requires_same_
+VOID
+DMF_Utility_CrcUpdate(
+    _Inout_ DMF_CRC_CONTEXT* CrcContext,
+    _In_reads_bytes_(NumberOfBytes) UINT8* Message,
+    _In_ size_t NumberOfBytes
+    );
+
+_Must_inspect_result_
+_IRQL_requires_same_
+UINT32
+DMF_Utility_CrcFinalize(
+    _In_ DMF_CRC_CONTEXT* CrcContext
+    );
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //
 // LIST_ENTRY functions for User-Mode. (These are copied as-is from Wdm.h.
@@ -2255,8 +2255,9 @@ Return Value:
     //
     if (AuxiliaryLockIndex < DMF_MAXIMUM_AUXILIARY_LOCKS + DMF_NUMBER_OF_DEFAULT_LOCKS)
     {
-        WdfWaitLockAcquire(dmfObject->Synchronizations[AuxiliaryLockIndex].SynchronizationPassiveWaitLock,
-                           NULL);
+        DMF_SynchronizationAcquire(dmfObject,
+                                   AuxiliaryLockIndex,
+                                   FALSE);
     }
     else
     {
@@ -2306,7 +2307,9 @@ Return Value:
     //
     if (AuxiliaryLockIndex < DMF_MAXIMUM_AUXILIARY_LOCKS + DMF_NUMBER_OF_DEFAULT_LOCKS)
     {
-        WdfWaitLockRelease(dmfObject->Synchronizations[AuxiliaryLockIndex].SynchronizationPassiveWaitLock);
+        DMF_SynchronizationRelease(dmfObject,
+                                   AuxiliaryLockIndex,
+                                   FALSE);
     }
     else
     {
@@ -2356,7 +2359,9 @@ Return Value:
     //
     if (AuxiliaryLockIndex < DMF_MAXIMUM_AUXILIARY_LOCKS + DMF_NUMBER_OF_DEFAULT_LOCKS)
     {
-        WdfSpinLockAcquire(dmfObject->Synchronizations[AuxiliaryLockIndex].SynchronizationDispatchSpinLock);
+        DMF_SynchronizationAcquire(dmfObject,
+                                   AuxiliaryLockIndex,
+                                   FALSE);
     }
     else
     {
@@ -2405,7 +2410,9 @@ Return Value:
     //
     if (AuxiliaryLockIndex < DMF_MAXIMUM_AUXILIARY_LOCKS + DMF_NUMBER_OF_DEFAULT_LOCKS)
     {
-        WdfSpinLockRelease(dmfObject->Synchronizations[AuxiliaryLockIndex].SynchronizationDispatchSpinLock);
+        DMF_SynchronizationRelease(dmfObject,
+                                   AuxiliaryLockIndex,
+                                   FALSE);
     }
     else
     {
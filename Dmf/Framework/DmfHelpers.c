@@ -926,417 +926,1671 @@ NonLegacy:
     #endif
 #endif
 
+static
+DMF_MODULE_ARENA_CHUNK*
+DmfModuleArenaChunkAllocate(
+    _In_ size_t SizeBytes
+    )
+/*++
+
+Routine Description:
+
+    Allocates a chunk for a Module Arena.
+
+Arguments:
+
+    SizeBytes - Number of bytes that can be carved from the chunk.
+
+Return Value:
+
+    NULL if memory cannot be allocated.
+    If not NULL, it is the address of the chunk.
+
+--*/
+{
+    DMF_MODULE_ARENA_CHUNK* chunk;
+
+    SizeBytes = DMF_MODULE_ARENA_ALIGN(SizeBytes);
+    chunk = (DMF_MODULE_ARENA_CHUNK*)DMF_GenericMemoryAllocate(POOL_FLAG_NON_PAGED,
+                                                              DMF_MODULE_ARENA_ALIGN(sizeof(DMF_MODULE_ARENA_CHUNK)) + SizeBytes,
+                                                              DMF_TAG9);
+    if (NULL == chunk)
+    {
+        goto Exit;
+    }
+
+    chunk->NextChunk = NULL;
+    chunk->SizeBytes = SizeBytes;
+    chunk->OffsetBytes = 0;
+
+Exit:
+
+    return chunk;
+}
+
 #pragma code_seg("PAGE")
 _IRQL_requires_max_(PASSIVE_LEVEL)
 _Must_inspect_result_
 NTSTATUS
-DMF_SynchronizationCreate(
-    _In_ DMF_OBJECT* DmfObject,
-    _In_ BOOLEAN PassiveLevel
+DMF_ModuleArenaCreate(
+    _In_ size_t InitialSizeBytes,
+    _Out_ DMF_MODULE_ARENA** ModuleArena
     )
 /*++
 
 Routine Description:
 
-    Create a set of Locks for a given DMF Module.
-    PassiveLevel - TRUE if Client wants the Module options to be set to MODULE_OPTIONS_PASSIVE.
-                   NOTE: Module Options must be set to MODULE_OPTIONS_DISPATCH_MAXIMUM. 
+    Creates a Module Arena whose first chunk is large enough for the given number of bytes.
+    The caller owns the single reference of the new arena.
 
 Arguments:
 
-    DmfModule - The given DMF Module.
+    InitialSizeBytes - Size of the first chunk. It should be large enough for all the Modules
+                       the caller knows it will create.
+    ModuleArena - The created Module Arena.
 
 Return Value:
 
-    STATUS_SUCCESS - locks are created.
-    STATUS_UNSUCCESSFUL - locks were not created.
+    NTSTATUS
 
 --*/
 {
     NTSTATUS ntStatus;
-    WDF_OBJECT_ATTRIBUTES attributes;
-    ULONG lockIndex;
-    DMF_MODULE_DESCRIPTOR* moduleDescriptor;
+    DMF_MODULE_ARENA* moduleArena;
 
     PAGED_CODE();
 
-    FuncEntryArguments(DMF_TRACE, "DmfObject=0x%p [%s]", DmfObject, DmfObject->ClientModuleInstanceName);
-
-    moduleDescriptor = &DmfObject->ModuleDescriptor;
-
-    DmfAssert(moduleDescriptor->NumberOfAuxiliaryLocks <= DMF_MAXIMUM_AUXILIARY_LOCKS);
+    *ModuleArena = NULL;
 
-    if (moduleDescriptor->ModuleOptions & DMF_MODULE_OPTIONS_DISPATCH_MAXIMUM)
-    {
-        if (PassiveLevel)
-        {
-            moduleDescriptor->ModuleOptions |= DMF_MODULE_OPTIONS_PASSIVE;
-        }
-        else
-        {
-            moduleDescriptor->ModuleOptions |= DMF_MODULE_OPTIONS_DISPATCH;
-        }
-    }
-    else
+    moduleArena = (DMF_MODULE_ARENA*)DMF_GenericMemoryAllocate(POOL_FLAG_NON_PAGED,
+                                                               sizeof(DMF_MODULE_ARENA),
+                                                               DMF_TAG9);
+    if (NULL == moduleArena)
     {
-        if ((moduleDescriptor->ModuleOptions & DMF_MODULE_OPTIONS_DISPATCH) &&
-            PassiveLevel)
-        {
-            DmfAssert(FALSE);
-            ntStatus = STATUS_INVALID_DEVICE_REQUEST;
-            goto Exit;
-        }
+        ntStatus = STATUS_INSUFFICIENT_RESOURCES;
+        goto Exit;
     }
+    RtlZeroMemory(moduleArena,
+                  sizeof(DMF_MODULE_ARENA));
 
-    // Create the locking mechanism based on Module Options.
-    //
-    if (moduleDescriptor->ModuleOptions & DMF_MODULE_OPTIONS_PASSIVE)
+    if (InitialSizeBytes < DMF_MODULE_ARENA_CHUNK_SIZE)
     {
-        TraceVerbose(DMF_TRACE, "DMF_MODULE_OPTIONS_PASSIVE");
-
-        DmfAssert(! (moduleDescriptor->ModuleOptions & DMF_MODULE_OPTIONS_DISPATCH));
-
-        // Create the Generic PASSIVE_LEVEL Lock for the Auxiliary Synchronization and one device lock.
-        //
-        for (lockIndex = 0; lockIndex < moduleDescriptor->NumberOfAuxiliaryLocks + DMF_NUMBER_OF_DEFAULT_LOCKS; lockIndex++)
-        {
-            WDF_OBJECT_ATTRIBUTES_INIT(&attributes);
-            attributes.ParentObject = DmfObject->MemoryDmfObject;
-            ntStatus = WdfWaitLockCreate(&attributes,
-                                         &DmfObject->Synchronizations[lockIndex].SynchronizationPassiveWaitLock);
-            if (! NT_SUCCESS(ntStatus))
-            {
-                TraceEvents(TRACE_LEVEL_ERROR, DMF_TRACE, "WdfSpinLockCreate fails: ntStatus=%!STATUS!", ntStatus);
-                goto Exit;
-            }
-        }
+        InitialSizeBytes = DMF_MODULE_ARENA_CHUNK_SIZE;
     }
-    else
+    moduleArena->CurrentChunk = DmfModuleArenaChunkAllocate(InitialSizeBytes);
+    if (NULL == moduleArena->CurrentChunk)
     {
-        TraceVerbose(DMF_TRACE, "DMF_MODULE_OPTIONS_DISPATCH");
-
-        // Create the Generic DISPATCH_LEVEL Lock for the Auxiliary Synchronization and one device lock.
-        //
-        for (lockIndex = 0; lockIndex < moduleDescriptor->NumberOfAuxiliaryLocks + DMF_NUMBER_OF_DEFAULT_LOCKS; lockIndex++)
-        {
-            WDF_OBJECT_ATTRIBUTES_INIT(&attributes);
-            attributes.ParentObject = DmfObject->MemoryDmfObject;
-            ntStatus = WdfSpinLockCreate(&attributes,
-                                         &DmfObject->Synchronizations[lockIndex].SynchronizationDispatchSpinLock);
-            if (! NT_SUCCESS(ntStatus))
-            {
-                TraceEvents(TRACE_LEVEL_ERROR, DMF_TRACE, "WdfSpinLockCreate fails: ntStatus=%!STATUS!", ntStatus);
-                goto Exit;
-            }
-        }
+        DMF_GenericMemoryFree(moduleArena,
+                              DMF_TAG9);
+        ntStatus = STATUS_INSUFFICIENT_RESOURCES;
+        goto Exit;
     }
+    moduleArena->NumberOfChunks = 1;
+    moduleArena->BytesReserved = moduleArena->CurrentChunk->SizeBytes;
+    moduleArena->ReferenceCount = 1;
 
+    *ModuleArena = moduleArena;
     ntStatus = STATUS_SUCCESS;
 
 Exit:
 
-    FuncExit(DMF_TRACE, "DmfObject=0x%p [%s] ntStatus=%!STATUS!", DmfObject, DmfObject->ClientModuleInstanceName, ntStatus);
-
     return ntStatus;
 }
 #pragma code_seg()
 
-// TODO: This function should not reference DMF_OBJECT nor DMF_MODULE_COLLECTION.
-//       Currently it is an exception because it is an "internal" Module. But, this
-//       needs to be fixed.
-//
-DMF_OBJECT*
-DMF_FeatureHandleGetFromModuleCollection(
-    _In_ DMFCOLLECTION DmfCollection,
-    _In_ DmfFeatureType DmfFeature
+#pragma code_seg("PAGE")
+_IRQL_requires_max_(PASSIVE_LEVEL)
+VOID*
+DMF_ModuleArenaAllocate(
+    _Inout_ DMF_MODULE_ARENA* ModuleArena,
+    _In_ size_t Size
     )
 /*++
 
 Routine Description:
 
-    Get the DMF Object from the DMF Collection of the specified DMF Feature.
+    Carves zeroed memory from a Module Arena. A new chunk is added to the arena if the
+    current chunk is full. Memory carved from an arena is never freed individually.
 
 Arguments:
 
-    DmfCollection - The given DMF Collection.
-    DmfFeatureType - The required DMF Feature identifier.
+    ModuleArena - The given Module Arena.
+    Size - Number of bytes to allocate.
 
 Return Value:
 
-    DMF Object of the required DMF Feature.
+    NULL if memory cannot be allocated.
+    If not NULL, it is the address of allocated memory
 
 --*/
 {
-    DMF_MODULE_COLLECTION* moduleCollectionHandle;
-    DMF_OBJECT* dmfObjectFeature;
+    VOID* returnValue;
+    DMF_MODULE_ARENA_CHUNK* chunk;
 
-    DmfAssert(DmfCollection != NULL);
+    PAGED_CODE();
 
-    moduleCollectionHandle = DMF_CollectionToHandle(DmfCollection);
+    Size = DMF_MODULE_ARENA_ALIGN(Size);
 
-    DmfAssert((DmfFeature > DmfFeature_Invalid) && 
-              (DmfFeature < DmfFeature_NumberOfFeatures));
-    __analysis_assume((DmfFeature > DmfFeature_Invalid) && 
-                      (DmfFeature < DmfFeature_NumberOfFeatures));
+    chunk = ModuleArena->CurrentChunk;
+    if (chunk->SizeBytes - chunk->OffsetBytes < Size)
+    {
+        // Older chunks are not revisited. Only a few bytes at the end of each are lost.
+        //
+        chunk = DmfModuleArenaChunkAllocate((Size > DMF_MODULE_ARENA_CHUNK_SIZE) ? Size : DMF_MODULE_ARENA_CHUNK_SIZE);
+        if (NULL == chunk)
+        {
+            returnValue = NULL;
+            goto Exit;
+        }
+        chunk->NextChunk = ModuleArena->CurrentChunk;
+        ModuleArena->CurrentChunk = chunk;
+        ModuleArena->NumberOfChunks++;
+        ModuleArena->BytesReserved += chunk->SizeBytes;
+    }
 
-    dmfObjectFeature = moduleCollectionHandle->DmfObjectFeature[DmfFeature];
-    // It can be NULL if this feature is not running.
-    //
+    returnValue = (UCHAR*)chunk + DMF_MODULE_ARENA_ALIGN(sizeof(DMF_MODULE_ARENA_CHUNK)) + chunk->OffsetBytes;
+    chunk->OffsetBytes += Size;
+    ModuleArena->BytesAllocated += Size;
 
-    return dmfObjectFeature;
+    RtlZeroMemory(returnValue,
+                  Size);
+
+Exit:
+
+    return returnValue;
 }
+#pragma code_seg()
 
-DMFMODULE
-DMF_FeatureModuleGetFromModule(
-    _In_ DMFMODULE DmfModule,
-    _In_ DmfFeatureType DmfFeature
+VOID
+DMF_ModuleArenaReference(
+    _Inout_ DMF_MODULE_ARENA* ModuleArena
     )
 /*++
 
 Routine Description:
 
-    Given a DMF Module and a feature identifier, return the corresponding Feature Handle.
+    Adds a reference to a Module Arena on behalf of a Module that carves memory from it.
 
 Arguments:
 
-    DmfModule - The given DMF Module.
-    DmfFeature - The required DMF feature identifier.
+    ModuleArena - The given Module Arena.
 
 Return Value:
 
-    The Feature Module that was created automatically for this Module.
+    None
 
 --*/
 {
-    DMF_OBJECT* dmfObjectFeature;
-    DMF_OBJECT* dmfObject;
-    DMFMODULE dmfModuleFeature;
+    LONG referenceCount;
 
-    dmfObject = DMF_ModuleToObject(DmfModule);
-    DmfAssert(dmfObject != NULL);
-    dmfObjectFeature = NULL;
+    referenceCount = InterlockedIncrement(&ModuleArena->ReferenceCount);
+    DmfAssert(referenceCount > 1);
+    ModuleArena->NumberOfModules++;
+}
 
-    if (dmfObject->ModuleCollection != NULL)
-    {
-        DMFCOLLECTION dmfCollection = DMF_ObjectToCollection(dmfObject->ModuleCollection);
+VOID
+DMF_ModuleArenaDereference(
+    _Inout_ DMF_MODULE_ARENA* ModuleArena
+    )
+/*++
 
-        dmfObjectFeature = DMF_FeatureHandleGetFromModuleCollection(dmfCollection,
-                                                                    DmfFeature);
-    }
+Routine Description:
 
-    if (dmfObjectFeature != NULL)
-    {
-        dmfModuleFeature = DMF_ObjectToModule(dmfObjectFeature);
-        DMF_ObjectValidate(dmfModuleFeature);
-    }
-    else
+    Releases a reference to a Module Arena. When the last reference is released, all the
+    chunks of the arena and the arena itself are freed.
+
+Arguments:
+
+    ModuleArena - The given Module Arena.
+
+Return Value:
+
+    None
+
+--*/
+{
+    LONG referenceCount;
+    DMF_MODULE_ARENA_CHUNK* chunk;
+    DMF_MODULE_ARENA_CHUNK* nextChunk;
+
+    referenceCount = InterlockedDecrement(&ModuleArena->ReferenceCount);
+    DmfAssert(referenceCount >= 0);
+    if (0 == referenceCount)
     {
-        // The Client Driver has not enabled this DMF Feature.
-        // Dynamic Modules do not support DMF Features.
-        //
-        dmfModuleFeature = NULL;
+        chunk = ModuleArena->CurrentChunk;
+        while (chunk != NULL)
+        {
+            nextChunk = chunk->NextChunk;
+            DMF_GenericMemoryFree(chunk,
+                                  DMF_TAG9);
+            chunk = nextChunk;
+        }
+        DMF_GenericMemoryFree(ModuleArena,
+                              DMF_TAG9);
     }
-
-    return dmfModuleFeature;
 }
 
-DMFMODULE
-DMF_FeatureModuleGetFromDevice(
-    _In_ WDFDEVICE Device,
-    _In_ DmfFeatureType DmfFeature
+static
+ULONG
+DmfProcessorCountGet(
+    VOID
     )
 /*++
 
 Routine Description:
 
-    Given a WDF Device and a feature identifier, return the corresponding Feature Module.
+    Returns the maximum number of processors the system can have.
 
 Arguments:
 
-    Device - The given WDFDEVICE handle.
-    DmfFeature - The required DMF feature identifier.
+    None
 
 Return Value:
 
-    The Feature Module that was created automatically for the given WDF Device.
+    Maximum number of processors.
 
 --*/
 {
-    DMF_OBJECT* dmfObjectFeature;
-    DMFMODULE dmfModuleFeature;
-    DMF_DEVICE_CONTEXT* dmfDeviceContext;
+#if defined(DMF_KERNEL_MODE)
+    return KeQueryMaximumProcessorCountEx(ALL_PROCESSOR_GROUPS);
+#else
+    return GetMaximumProcessorCount(ALL_PROCESSOR_GROUPS);
+#endif // defined(DMF_KERNEL_MODE)
+}
 
-    DmfAssert(Device != NULL);
+static
+ULONG
+DmfProcessorIndexGet(
+    VOID
+    )
+/*++
 
-    dmfDeviceContext = DmfDeviceContextGet(Device);
-    DmfAssert(dmfDeviceContext != NULL);
+Routine Description:
 
-    dmfObjectFeature = DMF_FeatureHandleGetFromModuleCollection(dmfDeviceContext->DmfCollection,
-                                                                DmfFeature);
-    if (dmfObjectFeature != NULL)
-    {
-        dmfModuleFeature = DMF_ObjectToModule(dmfObjectFeature);
-        DMF_ObjectValidate(dmfModuleFeature);
-    }
-    else
-    {
-        // The Client Driver has not enabled Automatic BranchTrack.
-        //
-        dmfModuleFeature = NULL;
-    }
+    Returns the index of the processor the current thread runs on.
+    NOTE: Unless the caller runs at DISPATCH_LEVEL, the thread can move to a different
+          processor right after this call.
 
-    return dmfModuleFeature;
+Arguments:
+
+    None
+
+Return Value:
+
+    Index of the current processor.
+
+--*/
+{
+#if defined(DMF_KERNEL_MODE)
+    return KeGetCurrentProcessorNumberEx(NULL);
+#else
+    return GetCurrentProcessorNumber();
+#endif // defined(DMF_KERNEL_MODE)
 }
 
-_IRQL_requires_max_(DISPATCH_LEVEL)
-VOID
-DMF_RequestPassthru(
-    _In_ WDFDEVICE Device,
-    _In_ WDFREQUEST Request
+#if defined(DMF_LOCK_PROFILING)
+static
+LONGLONG
+DmfSynchronizationTimestampFrequencyGet(
+    VOID
     )
 /*++
 
 Routine Description:
 
-    Forward the given request to next lower driver.
+    Returns the frequency of the performance counter used for lock statistics.
 
 Arguments:
 
-    DmfModule - This Module's handle.
-
-    Request - The given request.
+    None
 
 Return Value:
 
-    None. If the given request cannot be forwarded, the request is completed with error.
+    Performance counter ticks per second.
 
 --*/
 {
-    WDFIOTARGET ioTarget;
-    WDF_REQUEST_SEND_OPTIONS sendOptions; 
+    LARGE_INTEGER frequency;
 
-    ioTarget = WdfDeviceGetIoTarget(Device);
+#if defined(DMF_KERNEL_MODE)
+    KeQueryPerformanceCounter(&frequency);
+#else
+    QueryPerformanceFrequency(&frequency);
+#endif // defined(DMF_KERNEL_MODE)
 
-    WdfRequestFormatRequestUsingCurrentType(Request);
+    return frequency.QuadPart;
+}
+#endif // defined(DMF_LOCK_PROFILING)
+
+#pragma code_seg("PAGE")
+_IRQL_requires_max_(PASSIVE_LEVEL)
+_Must_inspect_result_
+static
+NTSTATUS
+DmfSynchronizationShardsCreate(
+    _In_ DMF_OBJECT* DmfObject,
+    _Inout_ DMF_SYNCHRONIZATION* Synchronization,
+    _In_ BOOLEAN PassiveLevel
+    )
+/*++
+
+Routine Description:
+
+    Create the per-processor locks of a DMF_MODULE_LOCK_TYPE_Sharded lock.
+
+Arguments:
+
+    DmfObject - The given DMF Module.
+    Synchronization - The lock to create the shards for.
+    PassiveLevel - TRUE if the shards are WDFWAITLOCK, FALSE if they are WDFSPINLOCK.
+
+Return Value:
+
+    NTSTATUS
+
+--*/
+{
+    NTSTATUS ntStatus;
+    WDF_OBJECT_ATTRIBUTES attributes;
+    WDFMEMORY shardsMemory;
+    UCHAR* shardsBuffer;
+    ULONG shardIndex;
+    ULONG numberOfShards;
+
+    PAGED_CODE();
+
+    numberOfShards = DmfProcessorCountGet();
+    if (numberOfShards > DMF_MAXIMUM_LOCK_SHARDS)
+    {
+        numberOfShards = DMF_MAXIMUM_LOCK_SHARDS;
+    }
+    DmfAssert(numberOfShards > 0);
+
+    // Allocate an extra cache line so that the shards can be aligned on a cache line boundary.
+    //
+    WDF_OBJECT_ATTRIBUTES_INIT(&attributes);
+    attributes.ParentObject = DmfObject->MemoryDmfObject;
+    ntStatus = WdfMemoryCreate(&attributes,
+                               NonPagedPoolNx,
+                               DMF_TAG,
+                               (sizeof(DMF_SYNCHRONIZATION_SHARD) * numberOfShards) + SYSTEM_CACHE_ALIGNMENT_SIZE,
+                               &shardsMemory,
+                               (VOID**)&shardsBuffer);
+    if (! NT_SUCCESS(ntStatus))
+    {
+        TraceEvents(TRACE_LEVEL_ERROR, DMF_TRACE, "WdfMemoryCreate fails: ntStatus=%!STATUS!", ntStatus);
+        goto Exit;
+    }
+
+    Synchronization->SynchronizationShards = (DMF_SYNCHRONIZATION_SHARD*)(((ULONG_PTR)shardsBuffer + SYSTEM_CACHE_ALIGNMENT_SIZE - 1) & ~((ULONG_PTR)SYSTEM_CACHE_ALIGNMENT_SIZE - 1));
+    RtlZeroMemory(Synchronization->SynchronizationShards,
+                  sizeof(DMF_SYNCHRONIZATION_SHARD) * numberOfShards);
+
+    for (shardIndex = 0; shardIndex < numberOfShards; shardIndex++)
+    {
+        WDF_OBJECT_ATTRIBUTES_INIT(&attributes);
+        attributes.ParentObject = DmfObject->MemoryDmfObject;
+        if (PassiveLevel)
+        {
+            ntStatus = WdfWaitLockCreate(&attributes,
+                                         &Synchronization->SynchronizationShards[shardIndex].SynchronizationPassiveWaitLock);
+        }
+        else
+        {
+            ntStatus = WdfSpinLockCreate(&attributes,
+                                         &Synchronization->SynchronizationShards[shardIndex].SynchronizationDispatchSpinLock);
+        }
+        if (! NT_SUCCESS(ntStatus))
+        {
+            TraceEvents(TRACE_LEVEL_ERROR, DMF_TRACE, "Shard lock create fails: ntStatus=%!STATUS!", ntStatus);
+            goto Exit;
+        }
+    }
+
+    Synchronization->NumberOfSynchronizationShards = numberOfShards;
+
+Exit:
+
+    return ntStatus;
+}
+#pragma code_seg()
+
+#pragma code_seg("PAGE")
+_IRQL_requires_max_(PASSIVE_LEVEL)
+_Must_inspect_result_
+static
+NTSTATUS
+DmfSynchronizationReaderWriterCreate(
+    _In_ DMF_OBJECT* DmfObject,
+    _Inout_ DMF_SYNCHRONIZATION* Synchronization,
+    _In_ BOOLEAN PassiveLevel
+    )
+/*++
+
+Routine Description:
+
+    Initialize a DMF_MODULE_LOCK_TYPE_ReaderWriter lock.
+
+Arguments:
+
+    DmfObject - The given DMF Module.
+    Synchronization - The lock to initialize.
+    PassiveLevel - TRUE if the lock is only acquired at PASSIVE_LEVEL.
+
+Return Value:
+
+    NTSTATUS
+
+--*/
+{
+    NTSTATUS ntStatus;
+
+    PAGED_CODE();
+
+#if defined(DMF_KERNEL_MODE)
+    if (PassiveLevel)
+    {
+        ExInitializePushLock(&Synchronization->SynchronizationPassiveReaderWriterLock);
+        ntStatus = STATUS_SUCCESS;
+    }
+    else
+    {
+        WDF_OBJECT_ATTRIBUTES attributes;
+        WDFMEMORY sharedIrqlMemory;
+
+        // Each shared owner runs at DISPATCH_LEVEL on its own processor until it releases
+        // the lock, so the IRQL to restore is stored per processor.
+        //
+        Synchronization->SynchronizationDispatchReaderWriterLock = 0;
+        WDF_OBJECT_ATTRIBUTES_INIT(&attributes);
+        attributes.ParentObject = DmfObject->MemoryDmfObject;
+        ntStatus = WdfMemoryCreate(&attributes,
+                                   NonPagedPoolNx,
+                                   DMF_TAG,
+                                   sizeof(KIRQL) * DmfProcessorCountGet(),
+                                   &sharedIrqlMemory,
+                                   (VOID**)&Synchronization->SynchronizationDispatchReaderWriterSharedIrql);
+        if (! NT_SUCCESS(ntStatus))
+        {
+            TraceEvents(TRACE_LEVEL_ERROR, DMF_TRACE, "WdfMemoryCreate fails: ntStatus=%!STATUS!", ntStatus);
+            Synchronization->SynchronizationDispatchReaderWriterSharedIrql = NULL;
+        }
+    }
+#else
+    UNREFERENCED_PARAMETER(DmfObject);
+    UNREFERENCED_PARAMETER(PassiveLevel);
+
+    InitializeSRWLock(&Synchronization->SynchronizationReaderWriterLock);
+    ntStatus = STATUS_SUCCESS;
+#endif // defined(DMF_KERNEL_MODE)
+
+    return ntStatus;
+}
+#pragma code_seg()
+
+#pragma code_seg("PAGE")
+_IRQL_requires_max_(PASSIVE_LEVEL)
+_Must_inspect_result_
+NTSTATUS
+DMF_SynchronizationCreate(
+    _In_ DMF_OBJECT* DmfObject,
+    _In_ BOOLEAN PassiveLevel
+    )
+/*++
+
+Routine Description:
+
+    Create a set of Locks for a given DMF Module.
+    PassiveLevel - TRUE if Client wants the Module options to be set to MODULE_OPTIONS_PASSIVE.
+                   NOTE: Module Options must be set to MODULE_OPTIONS_DISPATCH_MAXIMUM. 
+
+Arguments:
+
+    DmfModule - The given DMF Module.
+
+Return Value:
+
+    STATUS_SUCCESS - locks are created.
+    STATUS_UNSUCCESSFUL - locks were not created.
+
+--*/
+{
+    NTSTATUS ntStatus;
+    WDF_OBJECT_ATTRIBUTES attributes;
+    ULONG lockIndex;
+    DMF_MODULE_DESCRIPTOR* moduleDescriptor;
+
+    PAGED_CODE();
+
+    FuncEntryArguments(DMF_TRACE, "DmfObject=0x%p [%s]", DmfObject, DmfObject->ClientModuleInstanceName);
+
+    moduleDescriptor = &DmfObject->ModuleDescriptor;
+
+    DmfAssert(moduleDescriptor->NumberOfAuxiliaryLocks <= DMF_MAXIMUM_AUXILIARY_LOCKS);
+
+    if (moduleDescriptor->ModuleOptions & DMF_MODULE_OPTIONS_DISPATCH_MAXIMUM)
+    {
+        if (PassiveLevel)
+        {
+            moduleDescriptor->ModuleOptions |= DMF_MODULE_OPTIONS_PASSIVE;
+        }
+        else
+        {
+            moduleDescriptor->ModuleOptions |= DMF_MODULE_OPTIONS_DISPATCH;
+        }
+    }
+    else
+    {
+        if ((moduleDescriptor->ModuleOptions & DMF_MODULE_OPTIONS_DISPATCH) &&
+            PassiveLevel)
+        {
+            DmfAssert(FALSE);
+            ntStatus = STATUS_INVALID_DEVICE_REQUEST;
+            goto Exit;
+        }
+    }
+
+    if (DmfObject->ModuleAttributes.LockType >= DMF_MODULE_LOCK_TYPE_Maximum)
+    {
+        DmfAssert(FALSE);
+        ntStatus = STATUS_INVALID_PARAMETER;
+        goto Exit;
+    }
+
+    if (DmfObject->ModuleAttributes.LockType != DMF_MODULE_LOCK_TYPE_Exclusive)
+    {
+        TraceVerbose(DMF_TRACE, "LockType=%d", DmfObject->ModuleAttributes.LockType);
+
+        // Create the Client selected lock for the Auxiliary Synchronization and one device lock.
+        //
+        for (lockIndex = 0; lockIndex < moduleDescriptor->NumberOfAuxiliaryLocks + DMF_NUMBER_OF_DEFAULT_LOCKS; lockIndex++)
+        {
+            if (DMF_MODULE_LOCK_TYPE_ReaderWriter == DmfObject->ModuleAttributes.LockType)
+            {
+                ntStatus = DmfSynchronizationReaderWriterCreate(DmfObject,
+                                                                &DmfObject->Synchronizations[lockIndex],
+                                                                DMF_MODULE_RUNS_PASSIVE(DmfObject) ? TRUE : FALSE);
+            }
+            else
+            {
+                ntStatus = DmfSynchronizationShardsCreate(DmfObject,
+                                                          &DmfObject->Synchronizations[lockIndex],
+                                                          DMF_MODULE_RUNS_PASSIVE(DmfObject) ? TRUE : FALSE);
+            }
+            if (! NT_SUCCESS(ntStatus))
+            {
+                goto Exit;
+            }
+        }
+    }
+    // Create the locking mechanism based on Module Options.
+    //
+    else if (moduleDescriptor->ModuleOptions & DMF_MODULE_OPTIONS_PASSIVE)
+    {
+        TraceVerbose(DMF_TRACE, "DMF_MODULE_OPTIONS_PASSIVE");
+
+        DmfAssert(! (moduleDescriptor->ModuleOptions & DMF_MODULE_OPTIONS_DISPATCH));
+
+        // Create the Generic PASSIVE_LEVEL Lock for the Auxiliary Synchronization and one device lock.
+        //
+        for (lockIndex = 0; lockIndex < moduleDescriptor->NumberOfAuxiliaryLocks + DMF_NUMBER_OF_DEFAULT_LOCKS; lockIndex++)
+        {
+            WDF_OBJECT_ATTRIBUTES_INIT(&attributes);
+            attributes.ParentObject = DmfObject->MemoryDmfObject;
+            ntStatus = WdfWaitLockCreate(&attributes,
+                                         &DmfObject->Synchronizations[lockIndex].SynchronizationPassiveWaitLock);
+            if (! NT_SUCCESS(ntStatus))
+            {
+                TraceEvents(TRACE_LEVEL_ERROR, DMF_TRACE, "WdfSpinLockCreate fails: ntStatus=%!STATUS!", ntStatus);
+                goto Exit;
+            }
+        }
+    }
+    else
+    {
+        TraceVerbose(DMF_TRACE, "DMF_MODULE_OPTIONS_DISPATCH");
+
+        // Create the Generic DISPATCH_LEVEL Lock for the Auxiliary Synchronization and one device lock.
+        //
+        for (lockIndex = 0; lockIndex < moduleDescriptor->NumberOfAuxiliaryLocks + DMF_NUMBER_OF_DEFAULT_LOCKS; lockIndex++)
+        {
+            WDF_OBJECT_ATTRIBUTES_INIT(&attributes);
+            attributes.ParentObject = DmfObject->MemoryDmfObject;
+            ntStatus = WdfSpinLockCreate(&attributes,
+                                         &DmfObject->Synchronizations[lockIndex].SynchronizationDispatchSpinLock);
+            if (! NT_SUCCESS(ntStatus))
+            {
+                TraceEvents(TRACE_LEVEL_ERROR, DMF_TRACE, "WdfSpinLockCreate fails: ntStatus=%!STATUS!", ntStatus);
+                goto Exit;
+            }
+        }
+    }
+
+#if defined(DMF_LOCK_PROFILING)
+    for (lockIndex = 0; lockIndex < moduleDescriptor->NumberOfAuxiliaryLocks + DMF_NUMBER_OF_DEFAULT_LOCKS; lockIndex++)
+    {
+        DmfObject->Synchronizations[lockIndex].Statistics.TimestampFrequency = DmfSynchronizationTimestampFrequencyGet();
+    }
+#endif // defined(DMF_LOCK_PROFILING)
+
+    ntStatus = STATUS_SUCCESS;
+
+Exit:
+
+    FuncExit(DMF_TRACE, "DmfObject=0x%p [%s] ntStatus=%!STATUS!", DmfObject, DmfObject->ClientModuleInstanceName, ntStatus);
+
+    return ntStatus;
+}
+#pragma code_seg()
+
+// TODO: This function should not reference DMF_OBJECT nor DMF_MODULE_COLLECTION.
+//       Currently it is an exception because it is an "internal" Module. But, this
+//       needs to be fixed.
+//
+DMF_OBJECT*
+DMF_FeatureHandleGetFromModuleCollection(
+    _In_ DMFCOLLECTION DmfCollection,
+    _In_ DmfFeatureType DmfFeature
+    )
+/*++
+
+Routine Description:
+
+    Get the DMF Object from the DMF Collection of the specified DMF Feature.
+
+Arguments:
+
+    DmfCollection - The given DMF Collection.
+    DmfFeatureType - The required DMF Feature identifier.
+
+Return Value:
+
+    DMF Object of the required DMF Feature.
+
+--*/
+{
+    DMF_MODULE_COLLECTION* moduleCollectionHandle;
+    DMF_OBJECT* dmfObjectFeature;
+
+    DmfAssert(DmfCollection != NULL);
+
+    moduleCollectionHandle = DMF_CollectionToHandle(DmfCollection);
+
+    DmfAssert((DmfFeature > DmfFeature_Invalid) && 
+              (DmfFeature < DmfFeature_NumberOfFeatures));
+    __analysis_assume((DmfFeature > DmfFeature_Invalid) && 
+                      (DmfFeature < DmfFeature_NumberOfFeatures));
+
+    dmfObjectFeature = moduleCollectionHandle->DmfObjectFeature[DmfFeature];
+    // It can be NULL if this feature is not running.
+    //
+
+    return dmfObjectFeature;
+}
+
+DMFMODULE
+DMF_FeatureModuleGetFromModule(
+    _In_ DMFMODULE DmfModule,
+    _In_ DmfFeatureType DmfFeature
+    )
+/*++
+
+Routine Description:
+
+    Given a DMF Module and a feature identifier, return the corresponding Feature Handle.
+
+Arguments:
+
+    DmfModule - The given DMF Module.
+    DmfFeature - The required DMF feature identifier.
+
+Return Value:
+
+    The Feature Module that was created automatically for this Module.
+
+--*/
+{
+    DMF_OBJECT* dmfObjectFeature;
+    DMF_OBJECT* dmfObject;
+    DMFMODULE dmfModuleFeature;
+
+    dmfObject = DMF_ModuleToObject(DmfModule);
+    DmfAssert(dmfObject != NULL);
+    dmfObjectFeature = NULL;
+
+    if (dmfObject->ModuleCollection != NULL)
+    {
+        DMFCOLLECTION dmfCollection = DMF_ObjectToCollection(dmfObject->ModuleCollection);
+
+        dmfObjectFeature = DMF_FeatureHandleGetFromModuleCollection(dmfCollection,
+                                                                    DmfFeature);
+    }
+
+    if (dmfObjectFeature != NULL)
+    {
+        dmfModuleFeature = DMF_ObjectToModule(dmfObjectFeature);
+        DMF_ObjectValidate(dmfModuleFeature);
+    }
+    else
+    {
+        // The Client Driver has not enabled this DMF Feature.
+        // Dynamic Modules do not support DMF Features.
+        //
+        dmfModuleFeature = NULL;
+    }
+
+    return dmfModuleFeature;
+}
+
+DMFMODULE
+DMF_FeatureModuleGetFromDevice(
+    _In_ WDFDEVICE Device,
+    _In_ DmfFeatureType DmfFeature
+    )
+/*++
+
+Routine Description:
+
+    Given a WDF Device and a feature identifier, return the corresponding Feature Module.
+
+Arguments:
+
+    Device - The given WDFDEVICE handle.
+    DmfFeature - The required DMF feature identifier.
+
+Return Value:
+
+    The Feature Module that was created automatically for the given WDF Device.
+
+--*/
+{
+    DMF_OBJECT* dmfObjectFeature;
+    DMFMODULE dmfModuleFeature;
+    DMF_DEVICE_CONTEXT* dmfDeviceContext;
+
+    DmfAssert(Device != NULL);
+
+    dmfDeviceContext = DmfDeviceContextGet(Device);
+    DmfAssert(dmfDeviceContext != NULL);
+
+    dmfObjectFeature = DMF_FeatureHandleGetFromModuleCollection(dmfDeviceContext->DmfCollection,
+                                                                DmfFeature);
+    if (dmfObjectFeature != NULL)
+    {
+        dmfModuleFeature = DMF_ObjectToModule(dmfObjectFeature);
+        DMF_ObjectValidate(dmfModuleFeature);
+    }
+    else
+    {
+        // The Client Driver has not enabled Automatic BranchTrack.
+        //
+        dmfModuleFeature = NULL;
+    }
+
+    return dmfModuleFeature;
+}
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+VOID
+DMF_RequestPassthru(
+    _In_ WDFDEVICE Device,
+    _In_ WDFREQUEST Request
+    )
+/*++
+
+Routine Description:
+
+    Forward the given request to next lower driver.
+
+Arguments:
+
+    DmfModule - This Module's handle.
+
+    Request - The given request.
+
+Return Value:
+
+    None. If the given request cannot be forwarded, the request is completed with error.
+
+--*/
+{
+    WDFIOTARGET ioTarget;
+    WDF_REQUEST_SEND_OPTIONS sendOptions; 
+
+    ioTarget = WdfDeviceGetIoTarget(Device);
+
+    WdfRequestFormatRequestUsingCurrentType(Request);
     WDF_REQUEST_SEND_OPTIONS_INIT(&sendOptions,
                                   WDF_REQUEST_SEND_OPTION_SEND_AND_FORGET);
     if (! WdfRequestSend(Request,
                          ioTarget,
                          &sendOptions))
     {
-        // This is an error that generally should not happen.
+        // This is an error that generally should not happen.
+        //
+        TraceEvents(TRACE_LEVEL_ERROR, DMF_TRACE, "Unable to Passthru Request: Request=%p", Request);
+
+        // It could not be passed down, so just complete it with an error.
+        //
+        WdfRequestComplete(Request,
+                           STATUS_INVALID_DEVICE_STATE);
+    }
+    else
+    {
+        // Request will be completed by the target.
+        //
+        TraceEvents(TRACE_LEVEL_INFORMATION, DMF_TRACE, "Passthru Request: Request=%p", Request);
+    }
+}
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+VOID
+DMF_RequestPassthruWithCompletion(
+    _In_ WDFDEVICE Device,
+    _In_ WDFREQUEST Request,
+    _In_ PFN_WDF_REQUEST_COMPLETION_ROUTINE CompletionRoutine,
+    __drv_aliasesMem WDFCONTEXT CompletionContext
+    )
+/*++
+
+Routine Description:
+
+    Forward the given request to next lower driver. Sets a completion routine so that the WDFREQUEST can
+    be post-processed.
+
+Arguments:
+
+    DmfModule - This Module's handle.
+
+    Request - The given request.
+
+Return Value:
+
+    None. If the given request cannot be forwarded, the request is completed with error.
+
+--*/
+{
+    WDFIOTARGET ioTarget;
+
+    ioTarget = WdfDeviceGetIoTarget(Device);
+
+    WdfRequestFormatRequestUsingCurrentType(Request);
+    WdfRequestSetCompletionRoutine(Request,
+                                   CompletionRoutine,
+                                   CompletionContext);
+    if (! WdfRequestSend(Request,
+                         ioTarget,
+                         NULL))
+    {
+        // This is an error that generally should not happen.
+        //
+        TraceEvents(TRACE_LEVEL_ERROR, DMF_TRACE, "Unable to Passthru Request: Request=%p", Request);
+
+        // It could not be passed down, so just complete it with an error.
+        //
+        WdfRequestComplete(Request,
+                           STATUS_INVALID_DEVICE_STATE);
+    }
+    else
+    {
+        // Request will be completed by the target.
+        //
+        TraceEvents(TRACE_LEVEL_INFORMATION, DMF_TRACE, "Passthru Request: Request=%p", Request);
+    }
+}
+
+HANDLE 
+DmfGetCurrentThreadId(
+    )
+/*++
+
+Routine Description:
+
+    Helper routine to get current thread for kernel and user mode.
+
+Arguments:
+
+    None
+
+Return Value:
+
+    ID of current thread
+
+--*/
+{
+    HANDLE currentThreadId;
+
+#if defined(DMF_USER_MODE)
+    #if defined(DMF_WIN32_MODE)
+        // 'type cast': conversion from 'DWORD' to 'HANDLE' of greater size
+        //
+        #pragma warning(push)
+        #pragma warning(disable:4312)
+    #endif
+    currentThreadId = (HANDLE)GetCurrentThreadId();
+    #if defined(DMF_WIN32_MODE)
+        // 'type cast': conversion from 'DWORD' to 'HANDLE' of greater size
+        //
+        #pragma warning(pop)
+    #endif
+#else
+    currentThreadId = PsGetCurrentThread();
+#endif
+
+    DmfAssert(currentThreadId != NULL);
+    return currentThreadId;
+}
+
+#if defined(DMF_LOCK_PROFILING)
+static
+LONGLONG
+DmfSynchronizationTimestampGet(
+    VOID
+    )
+/*++
+
+Routine Description:
+
+    Returns the current value of the performance counter for lock statistics.
+
+Arguments:
+
+    None
+
+Return Value:
+
+    Current value of the performance counter.
+
+--*/
+{
+    LARGE_INTEGER counter;
+
+#if defined(DMF_KERNEL_MODE)
+    counter = KeQueryPerformanceCounter(NULL);
+#else
+    QueryPerformanceCounter(&counter);
+#endif // defined(DMF_KERNEL_MODE)
+
+    return counter.QuadPart;
+}
+
+static
+VOID
+DmfSynchronizationStatisticsMaximumUpdate(
+    _Inout_ volatile LONGLONG* Maximum,
+    _In_ LONGLONG Value
+    )
+/*++
+
+Routine Description:
+
+    Store a value as the new maximum if it is larger than the current maximum.
+    The maximum may be updated by several threads at the same time.
+
+Arguments:
+
+    Maximum - The current maximum.
+    Value - The new value.
+
+Return Value:
+
+    None
+
+--*/
+{
+    LONGLONG currentMaximum;
+
+    currentMaximum = *Maximum;
+    while (Value > currentMaximum)
+    {
+        LONGLONG previousMaximum;
+
+        previousMaximum = InterlockedCompareExchange64(Maximum,
+                                                       Value,
+                                                       currentMaximum);
+        if (previousMaximum == currentMaximum)
+        {
+            break;
+        }
+        currentMaximum = previousMaximum;
+    }
+}
+
+static
+LONGLONG
+DmfSynchronizationStatisticsAcquire(
+    _Inout_ DMF_SYNCHRONIZATION* Synchronization,
+    _In_ BOOLEAN Shared
+    )
+/*++
+
+Routine Description:
+
+    Update the statistics of a lock that is about to be acquired.
+
+Arguments:
+
+    Synchronization - The lock that is about to be acquired.
+    Shared - TRUE if the lock is acquired shared.
+
+Return Value:
+
+    The time the caller starts waiting for the lock.
+
+--*/
+{
+    DMF_SYNCHRONIZATION_STATISTICS* statistics;
+
+    statistics = &Synchronization->Statistics;
+    if (Shared)
+    {
+        InterlockedIncrement64(&statistics->SharedAcquisitions);
+        if (statistics->ExclusiveOwnersAndWaiters > 0)
+        {
+            InterlockedIncrement64(&statistics->ContendedAcquisitions);
+        }
+    }
+    else
+    {
+        InterlockedIncrement64(&statistics->ExclusiveAcquisitions);
+        if ((InterlockedIncrement(&statistics->ExclusiveOwnersAndWaiters) > 1) ||
+            (statistics->SharedOwners > 0))
+        {
+            InterlockedIncrement64(&statistics->ContendedAcquisitions);
+        }
+    }
+
+    return DmfSynchronizationTimestampGet();
+}
+
+static
+VOID
+DmfSynchronizationStatisticsAcquired(
+    _Inout_ DMF_SYNCHRONIZATION* Synchronization,
+    _In_ BOOLEAN Shared,
+    _In_ LONGLONG WaitStartTimestamp
+    )
+/*++
+
+Routine Description:
+
+    Update the statistics of a lock that has just been acquired.
+
+Arguments:
+
+    Synchronization - The lock that has been acquired.
+    Shared - TRUE if the lock is acquired shared.
+    WaitStartTimestamp - Value returned by DmfSynchronizationStatisticsAcquire().
+
+Return Value:
+
+    None
+
+--*/
+{
+    LONGLONG timestamp;
+
+    timestamp = DmfSynchronizationTimestampGet();
+    DmfSynchronizationStatisticsMaximumUpdate(&Synchronization->Statistics.WaitTimeMaximum,
+                                              timestamp - WaitStartTimestamp);
+
+    if (Shared)
+    {
+        InterlockedIncrement(&Synchronization->Statistics.SharedOwners);
+    }
+    else
+    {
+        Synchronization->Statistics.ExclusiveAcquireTimestamp = timestamp;
+    }
+}
+
+static
+VOID
+DmfSynchronizationStatisticsRelease(
+    _Inout_ DMF_SYNCHRONIZATION* Synchronization,
+    _In_ BOOLEAN Shared
+    )
+/*++
+
+Routine Description:
+
+    Update the statistics of a lock that is about to be released.
+
+Arguments:
+
+    Synchronization - The lock that is about to be released.
+    Shared - TRUE if the lock is held shared.
+
+Return Value:
+
+    None
+
+--*/
+{
+    DMF_SYNCHRONIZATION_STATISTICS* statistics;
+    LONGLONG holdTime;
+
+    statistics = &Synchronization->Statistics;
+    if (Shared)
+    {
+        InterlockedDecrement(&statistics->SharedOwners);
+    }
+    else
+    {
+        // The lock is still held exclusively so these do not need to be interlocked.
         //
-        TraceEvents(TRACE_LEVEL_ERROR, DMF_TRACE, "Unable to Passthru Request: Request=%p", Request);
+        holdTime = DmfSynchronizationTimestampGet() - statistics->ExclusiveAcquireTimestamp;
+        statistics->ExclusiveHoldTimeTotal += holdTime;
+        if (holdTime > statistics->ExclusiveHoldTimeMaximum)
+        {
+            statistics->ExclusiveHoldTimeMaximum = holdTime;
+        }
+        InterlockedDecrement(&statistics->ExclusiveOwnersAndWaiters);
+    }
+}
+#endif // defined(DMF_LOCK_PROFILING)
+
+// 'The function changes the IRQL and does not restore the IRQL before it exits.'
+//
+#pragma warning(suppress: 28167)
+_IRQL_requires_max_(DISPATCH_LEVEL)
+static
+VOID
+DmfSynchronizationReaderWriterAcquire(
+    _Inout_ DMF_SYNCHRONIZATION* Synchronization,
+    _In_ BOOLEAN PassiveLevel,
+    _In_ BOOLEAN Shared
+    )
+/*++
+
+Routine Description:
+
+    Acquire a DMF_MODULE_LOCK_TYPE_ReaderWriter lock.
+
+Arguments:
+
+    Synchronization - The lock to acquire.
+    PassiveLevel - TRUE if the lock is only acquired at PASSIVE_LEVEL.
+    Shared - TRUE if the lock is acquired shared.
+
+Return Value:
+
+    None
+
+--*/
+{
+#if defined(DMF_KERNEL_MODE)
+    if (PassiveLevel)
+    {
+        KeEnterCriticalRegion();
+        if (Shared)
+        {
+            ExAcquirePushLockSharedEx(&Synchronization->SynchronizationPassiveReaderWriterLock,
+                                      EX_DEFAULT_PUSH_LOCK_FLAGS);
+        }
+        else
+        {
+            ExAcquirePushLockExclusiveEx(&Synchronization->SynchronizationPassiveReaderWriterLock,
+                                         EX_DEFAULT_PUSH_LOCK_FLAGS);
+        }
+    }
+    else
+    {
+        KIRQL oldIrql;
+
+        if (Shared)
+        {
+            oldIrql = ExAcquireSpinLockShared(&Synchronization->SynchronizationDispatchReaderWriterLock);
+            // The thread cannot move to a different processor until the lock is released.
+            //
+            Synchronization->SynchronizationDispatchReaderWriterSharedIrql[DmfProcessorIndexGet()] = oldIrql;
+        }
+        else
+        {
+            oldIrql = ExAcquireSpinLockExclusive(&Synchronization->SynchronizationDispatchReaderWriterLock);
+            Synchronization->SynchronizationDispatchReaderWriterIrql = oldIrql;
+        }
+    }
+#else
+    UNREFERENCED_PARAMETER(PassiveLevel);
+
+    if (Shared)
+    {
+        AcquireSRWLockShared(&Synchronization->SynchronizationReaderWriterLock);
+    }
+    else
+    {
+        AcquireSRWLockExclusive(&Synchronization->SynchronizationReaderWriterLock);
+    }
+#endif // defined(DMF_KERNEL_MODE)
+}
+
+// 'The function changes the IRQL and does not restore the IRQL before it exits.'
+//
+#pragma warning(suppress: 28167)
+_IRQL_requires_max_(DISPATCH_LEVEL)
+static
+VOID
+DmfSynchronizationReaderWriterRelease(
+    _Inout_ DMF_SYNCHRONIZATION* Synchronization,
+    _In_ BOOLEAN PassiveLevel,
+    _In_ BOOLEAN Shared
+    )
+/*++
+
+Routine Description:
+
+    Release a DMF_MODULE_LOCK_TYPE_ReaderWriter lock.
+
+Arguments:
+
+    Synchronization - The lock to release.
+    PassiveLevel - TRUE if the lock is only acquired at PASSIVE_LEVEL.
+    Shared - TRUE if the lock is held shared.
+
+Return Value:
+
+    None
+
+--*/
+{
+#if defined(DMF_KERNEL_MODE)
+    if (PassiveLevel)
+    {
+        if (Shared)
+        {
+            ExReleasePushLockSharedEx(&Synchronization->SynchronizationPassiveReaderWriterLock,
+                                      EX_DEFAULT_PUSH_LOCK_FLAGS);
+        }
+        else
+        {
+            ExReleasePushLockExclusiveEx(&Synchronization->SynchronizationPassiveReaderWriterLock,
+                                         EX_DEFAULT_PUSH_LOCK_FLAGS);
+        }
+        KeLeaveCriticalRegion();
+    }
+    else
+    {
+        if (Shared)
+        {
+            ExReleaseSpinLockShared(&Synchronization->SynchronizationDispatchReaderWriterLock,
+                                    Synchronization->SynchronizationDispatchReaderWriterSharedIrql[DmfProcessorIndexGet()]);
+        }
+        else
+        {
+            ExReleaseSpinLockExclusive(&Synchronization->SynchronizationDispatchReaderWriterLock,
+                                       Synchronization->SynchronizationDispatchReaderWriterIrql);
+        }
+    }
+#else
+    UNREFERENCED_PARAMETER(PassiveLevel);
+
+    if (Shared)
+    {
+        ReleaseSRWLockShared(&Synchronization->SynchronizationReaderWriterLock);
+    }
+    else
+    {
+        ReleaseSRWLockExclusive(&Synchronization->SynchronizationReaderWriterLock);
+    }
+#endif // defined(DMF_KERNEL_MODE)
+}
+
+// 'The function changes the IRQL and does not restore the IRQL before it exits.'
+//
+#pragma warning(suppress: 28167)
+_IRQL_requires_max_(DISPATCH_LEVEL)
+static
+VOID
+DmfSynchronizationShardAcquire(
+    _Inout_ DMF_SYNCHRONIZATION_SHARD* Shard,
+    _In_ BOOLEAN PassiveLevel
+    )
+/*++
+
+Routine Description:
+
+    Acquire one shard of a DMF_MODULE_LOCK_TYPE_Sharded lock.
+
+Arguments:
+
+    Shard - The shard to acquire.
+    PassiveLevel - TRUE if the shard is a WDFWAITLOCK.
+
+Return Value:
+
+    None
+
+--*/
+{
+    if (PassiveLevel)
+    {
+        WdfWaitLockAcquire(Shard->SynchronizationPassiveWaitLock,
+                           NULL);
+    }
+    else
+    {
+        WdfSpinLockAcquire(Shard->SynchronizationDispatchSpinLock);
+    }
+    DmfAssert(NULL == Shard->LockHeldByThread);
+    Shard->LockHeldByThread = DmfGetCurrentThreadId();
+}
+
+// 'The function changes the IRQL and does not restore the IRQL before it exits.'
+//
+#pragma warning(suppress: 28167)
+_IRQL_requires_max_(DISPATCH_LEVEL)
+static
+VOID
+DmfSynchronizationShardRelease(
+    _Inout_ DMF_SYNCHRONIZATION_SHARD* Shard,
+    _In_ BOOLEAN PassiveLevel
+    )
+/*++
+
+Routine Description:
+
+    Release one shard of a DMF_MODULE_LOCK_TYPE_Sharded lock.
+
+Arguments:
+
+    Shard - The shard to release.
+    PassiveLevel - TRUE if the shard is a WDFWAITLOCK.
+
+Return Value:
+
+    None
+
+--*/
+{
+    DmfAssert(DmfGetCurrentThreadId() == Shard->LockHeldByThread);
+    Shard->LockHeldByThread = NULL;
+    if (PassiveLevel)
+    {
+        WdfWaitLockRelease(Shard->SynchronizationPassiveWaitLock);
+    }
+    else
+    {
+        WdfSpinLockRelease(Shard->SynchronizationDispatchSpinLock);
+    }
+}
+
+// 'The function changes the IRQL and does not restore the IRQL before it exits.'
+//
+#pragma warning(suppress: 28167)
+_IRQL_requires_max_(DISPATCH_LEVEL)
+static
+VOID
+DmfSynchronizationShardsAcquire(
+    _Inout_ DMF_SYNCHRONIZATION* Synchronization,
+    _In_ BOOLEAN PassiveLevel,
+    _In_ BOOLEAN Shared
+    )
+/*++
+
+Routine Description:
+
+    Acquire a DMF_MODULE_LOCK_TYPE_Sharded lock. A shared acquisition only acquires
+    the shard of the current processor. An exclusive acquisition acquires all the
+    shards in ascending order.
+
+Arguments:
+
+    Synchronization - The lock to acquire.
+    PassiveLevel - TRUE if the shards are WDFWAITLOCK.
+    Shared - TRUE if the lock is acquired shared.
+
+Return Value:
+
+    None
+
+--*/
+{
+    ULONG shardIndex;
+
+    DmfAssert(Synchronization->NumberOfSynchronizationShards > 0);
+
+    if (Shared)
+    {
+        shardIndex = DmfProcessorIndexGet() % Synchronization->NumberOfSynchronizationShards;
+        DmfSynchronizationShardAcquire(&Synchronization->SynchronizationShards[shardIndex],
+                                       PassiveLevel);
+    }
+    else
+    {
+        for (shardIndex = 0; shardIndex < Synchronization->NumberOfSynchronizationShards; shardIndex++)
+        {
+            DmfSynchronizationShardAcquire(&Synchronization->SynchronizationShards[shardIndex],
+                                           PassiveLevel);
+        }
+    }
+}
+
+// 'The function changes the IRQL and does not restore the IRQL before it exits.'
+//
+#pragma warning(suppress: 28167)
+_IRQL_requires_max_(DISPATCH_LEVEL)
+static
+VOID
+DmfSynchronizationShardsRelease(
+    _Inout_ DMF_SYNCHRONIZATION* Synchronization,
+    _In_ BOOLEAN PassiveLevel,
+    _In_ BOOLEAN Shared
+    )
+/*++
+
+Routine Description:
+
+    Release a DMF_MODULE_LOCK_TYPE_Sharded lock.
+
+Arguments:
+
+    Synchronization - The lock to release.
+    PassiveLevel - TRUE if the shards are WDFWAITLOCK.
+    Shared - TRUE if the lock is held shared.
+
+Return Value:
 
-        // It could not be passed down, so just complete it with an error.
+    None
+
+--*/
+{
+    ULONG shardIndex;
+    ULONG shardCount;
+    HANDLE currentThreadId;
+
+    DmfAssert(Synchronization->NumberOfSynchronizationShards > 0);
+
+    if (Shared)
+    {
+        // The thread may have moved to a different processor since it acquired its shard.
+        // Start looking at the shard of the current processor since that is the most likely one.
         //
-        WdfRequestComplete(Request,
-                           STATUS_INVALID_DEVICE_STATE);
+        currentThreadId = DmfGetCurrentThreadId();
+        shardIndex = DmfProcessorIndexGet() % Synchronization->NumberOfSynchronizationShards;
+        for (shardCount = 0; shardCount < Synchronization->NumberOfSynchronizationShards; shardCount++)
+        {
+            if (Synchronization->SynchronizationShards[shardIndex].LockHeldByThread == currentThreadId)
+            {
+                DmfSynchronizationShardRelease(&Synchronization->SynchronizationShards[shardIndex],
+                                               PassiveLevel);
+                break;
+            }
+            shardIndex = (shardIndex + 1) % Synchronization->NumberOfSynchronizationShards;
+        }
+        DmfAssert(shardCount < Synchronization->NumberOfSynchronizationShards);
     }
     else
     {
-        // Request will be completed by the target.
-        //
-        TraceEvents(TRACE_LEVEL_INFORMATION, DMF_TRACE, "Passthru Request: Request=%p", Request);
+        for (shardIndex = Synchronization->NumberOfSynchronizationShards; shardIndex > 0; shardIndex--)
+        {
+            DmfSynchronizationShardRelease(&Synchronization->SynchronizationShards[shardIndex - 1],
+                                           PassiveLevel);
+        }
     }
 }
 
+// 'The function changes the IRQL and does not restore the IRQL before it exits.'
+//
+#pragma warning(suppress: 28167)
 _IRQL_requires_max_(DISPATCH_LEVEL)
 VOID
-DMF_RequestPassthruWithCompletion(
-    _In_ WDFDEVICE Device,
-    _In_ WDFREQUEST Request,
-    _In_ PFN_WDF_REQUEST_COMPLETION_ROUTINE CompletionRoutine,
-    __drv_aliasesMem WDFCONTEXT CompletionContext
+DMF_SynchronizationAcquire(
+    _In_ DMF_OBJECT* DmfObject,
+    _In_ ULONG LockIndex,
+    _In_ BOOLEAN Shared
     )
 /*++
 
 Routine Description:
 
-    Forward the given request to next lower driver. Sets a completion routine so that the WDFREQUEST can
-    be post-processed.
+    Acquire one of a DMF Module's locks using the lock type selected by the Client.
 
 Arguments:
 
-    DmfModule - This Module's handle.
-
-    Request - The given request.
+    DmfObject - The given DMF Module.
+    LockIndex - Index of the lock. Device lock is at 0. Auxiliary locks start from 1.
+    Shared - TRUE if the caller only reads the data the lock protects.
+             It is ignored for DMF_MODULE_LOCK_TYPE_Exclusive locks.
 
 Return Value:
 
-    None. If the given request cannot be forwarded, the request is completed with error.
+    None
 
 --*/
 {
-    WDFIOTARGET ioTarget;
+    DMF_SYNCHRONIZATION* synchronization;
+    BOOLEAN passiveLevel;
+#if defined(DMF_LOCK_PROFILING)
+    LONGLONG waitStartTimestamp;
+#endif // defined(DMF_LOCK_PROFILING)
 
-    ioTarget = WdfDeviceGetIoTarget(Device);
+    DmfAssert(LockIndex < DMF_MAXIMUM_AUXILIARY_LOCKS + DMF_NUMBER_OF_DEFAULT_LOCKS);
 
-    WdfRequestFormatRequestUsingCurrentType(Request);
-    WdfRequestSetCompletionRoutine(Request,
-                                   CompletionRoutine,
-                                   CompletionContext);
-    if (! WdfRequestSend(Request,
-                         ioTarget,
-                         NULL))
+    synchronization = &DmfObject->Synchronizations[LockIndex];
+    passiveLevel = DMF_MODULE_RUNS_PASSIVE(DmfObject) ? TRUE : FALSE;
+    if (DMF_MODULE_LOCK_TYPE_Exclusive == DmfObject->ModuleAttributes.LockType)
     {
-        // This is an error that generally should not happen.
-        //
-        TraceEvents(TRACE_LEVEL_ERROR, DMF_TRACE, "Unable to Passthru Request: Request=%p", Request);
-
-        // It could not be passed down, so just complete it with an error.
-        //
-        WdfRequestComplete(Request,
-                           STATUS_INVALID_DEVICE_STATE);
+        Shared = FALSE;
     }
-    else
+
+#if defined(DMF_LOCK_PROFILING)
+    waitStartTimestamp = DmfSynchronizationStatisticsAcquire(synchronization,
+                                                             Shared);
+#endif // defined(DMF_LOCK_PROFILING)
+
+    switch (DmfObject->ModuleAttributes.LockType)
     {
-        // Request will be completed by the target.
-        //
-        TraceEvents(TRACE_LEVEL_INFORMATION, DMF_TRACE, "Passthru Request: Request=%p", Request);
+        case DMF_MODULE_LOCK_TYPE_ReaderWriter:
+        {
+            DmfSynchronizationReaderWriterAcquire(synchronization,
+                                                  passiveLevel,
+                                                  Shared);
+            break;
+        }
+        case DMF_MODULE_LOCK_TYPE_Sharded:
+        {
+            DmfSynchronizationShardsAcquire(synchronization,
+                                            passiveLevel,
+                                            Shared);
+            break;
+        }
+        default:
+        {
+            if (passiveLevel)
+            {
+                WdfWaitLockAcquire(synchronization->SynchronizationPassiveWaitLock,
+                                   NULL);
+            }
+            else
+            {
+                WdfSpinLockAcquire(synchronization->SynchronizationDispatchSpinLock);
+            }
+            break;
+        }
     }
+
+#if defined(DMF_LOCK_PROFILING)
+    DmfSynchronizationStatisticsAcquired(synchronization,
+                                         Shared,
+                                         waitStartTimestamp);
+#endif // defined(DMF_LOCK_PROFILING)
 }
 
-HANDLE 
-DmfGetCurrentThreadId(
+// 'The function changes the IRQL and does not restore the IRQL before it exits.'
+//
+#pragma warning(suppress: 28167)
+_IRQL_requires_max_(DISPATCH_LEVEL)
+VOID
+DMF_SynchronizationRelease(
+    _In_ DMF_OBJECT* DmfObject,
+    _In_ ULONG LockIndex,
+    _In_ BOOLEAN Shared
     )
 /*++
 
 Routine Description:
 
-    Helper routine to get current thread for kernel and user mode.
+    Release one of a DMF Module's locks acquired by DMF_SynchronizationAcquire().
 
 Arguments:
 
-    None
+    DmfObject - The given DMF Module.
+    LockIndex - Index of the lock. Device lock is at 0. Auxiliary locks start from 1.
+    Shared - Must match the value passed to DMF_SynchronizationAcquire().
 
 Return Value:
 
-    ID of current thread
+    None
 
 --*/
 {
-    HANDLE currentThreadId;
+    DMF_SYNCHRONIZATION* synchronization;
+    BOOLEAN passiveLevel;
 
-#if defined(DMF_USER_MODE)
-    #if defined(DMF_WIN32_MODE)
-        // 'type cast': conversion from 'DWORD' to 'HANDLE' of greater size
-        //
-        #pragma warning(push)
-        #pragma warning(disable:4312)
-    #endif
-    currentThreadId = (HANDLE)GetCurrentThreadId();
-    #if defined(DMF_WIN32_MODE)
-        // 'type cast': conversion from 'DWORD' to 'HANDLE' of greater size
-        //
-        #pragma warning(pop)
-    #endif
-#else
-    currentThreadId = PsGetCurrentThread();
-#endif
+    DmfAssert(LockIndex < DMF_MAXIMUM_AUXILIARY_LOCKS + DMF_NUMBER_OF_DEFAULT_LOCKS);
 
-    DmfAssert(currentThreadId != NULL);
-    return currentThreadId;
+    synchronization = &DmfObject->Synchronizations[LockIndex];
+    passiveLevel = DMF_MODULE_RUNS_PASSIVE(DmfObject) ? TRUE : FALSE;
+    if (DMF_MODULE_LOCK_TYPE_Exclusive == DmfObject->ModuleAttributes.LockType)
+    {
+        Shared = FALSE;
+    }
+
+#if defined(DMF_LOCK_PROFILING)
+    DmfSynchronizationStatisticsRelease(synchronization,
+                                        Shared);
+#endif // defined(DMF_LOCK_PROFILING)
+
+    switch (DmfObject->ModuleAttributes.LockType)
+    {
+        case DMF_MODULE_LOCK_TYPE_ReaderWriter:
+        {
+            DmfSynchronizationReaderWriterRelease(synchronization,
+                                                  passiveLevel,
+                                                  Shared);
+            break;
+        }
+        case DMF_MODULE_LOCK_TYPE_Sharded:
+        {
+            DmfSynchronizationShardsRelease(synchronization,
+                                            passiveLevel,
+                                            Shared);
+            break;
+        }
+        default:
+        {
+            if (passiveLevel)
+            {
+                WdfWaitLockRelease(synchronization->SynchronizationPassiveWaitLock);
+            }
+            else
+            {
+                WdfSpinLockRelease(synchronization->SynchronizationDispatchSpinLock);
+            }
+            break;
+        }
+    }
 }
 
 VOID
@@ -1513,5 +2767,168 @@ Return Value:
     }
 }
 
+VOID
+DMF_ModuleLockSharedPrivate(
+    _In_ DMFMODULE DmfModule
+    )
+/*++
+
+Routine Description:
+
+    Acquire a Module's primary lock for reading. Other readers are not blocked
+    unless the Client has selected DMF_MODULE_LOCK_TYPE_Exclusive.
+
+    NOTE: This function should only be called from a Module and that Module must be
+          the creator of this lock. This function is called indirectly
+          after proper ownership is verified.
+
+Arguments:
+
+    DmfModule - The given DMF Module.
+
+Return Value:
+
+    None
+
+--*/
+{
+    DMF_OBJECT* dmfObject;
+
+    dmfObject = DMF_ModuleToObject(DmfModule);
+    DmfAssert(dmfObject != NULL);
+    DMF_HandleValidate_IsAvailable(dmfObject);
+
+    DMF_SynchronizationAcquire(dmfObject,
+                               DMF_DEFAULT_LOCK_INDEX,
+                               TRUE);
+}
+
+VOID
+DMF_ModuleUnlockSharedPrivate(
+    _In_ DMFMODULE DmfModule
+    )
+/*++
+
+Routine Description:
+
+    Release a Module's primary lock acquired using DMF_ModuleLockSharedPrivate().
+
+    NOTE: This function should only be called from a Module and that Module must be
+          the creator of this lock. This function is called indirectly
+          after proper ownership is verified.
+
+Arguments:
+
+    DmfModule - The given DMF Module.
+
+Return Value:
+
+    None
+
+--*/
+{
+    DMF_OBJECT* dmfObject;
+
+    dmfObject = DMF_ModuleToObject(DmfModule);
+    DmfAssert(dmfObject != NULL);
+    DMF_HandleValidate_IsAvailable(dmfObject);
+
+    DMF_SynchronizationRelease(dmfObject,
+                               DMF_DEFAULT_LOCK_INDEX,
+                               TRUE);
+}
+
+VOID
+DMF_ModuleAuxiliaryLockSharedPrivate(
+    _In_ DMFMODULE DmfModule,
+    _In_ ULONG AuxiliaryLockIndex
+    )
+/*++
+
+Routine Description:
+
+    Acquire an auxiliary lock of a given DMF Module for reading.
+
+Arguments:
+
+    DmfModule - The given DMF Module.
+    AuxiliaryLockIndex - Index of the auxiliary lock object
+
+Return Value:
+
+    None
+
+--*/
+{
+    DMF_OBJECT* dmfObject;
+
+    dmfObject = DMF_ModuleToObject(DmfModule);
+    DmfAssert(dmfObject != NULL);
+    DMF_HandleValidate_IsAvailable(dmfObject);
+    DmfAssert(AuxiliaryLockIndex < dmfObject->ModuleDescriptor.NumberOfAuxiliaryLocks);
+
+    // This check is required for SAL.
+    //
+    if (AuxiliaryLockIndex < DMF_MAXIMUM_AUXILIARY_LOCKS)
+    {
+        // Device lock is at 0. Auxiliary locks start from 1.
+        // AuxiliaryLockIndex is 0 based.
+        //
+        DMF_SynchronizationAcquire(dmfObject,
+                                   AuxiliaryLockIndex + DMF_NUMBER_OF_DEFAULT_LOCKS,
+                                   TRUE);
+    }
+    else
+    {
+        DmfAssert(FALSE);
+    }
+}
+
+VOID
+DMF_ModuleAuxiliaryUnlockSharedPrivate(
+    _In_ DMFMODULE DmfModule,
+    _In_ ULONG AuxiliaryLockIndex
+    )
+/*++
+
+Routine Description:
+
+    Release an auxiliary lock acquired using DMF_ModuleAuxiliaryLockSharedPrivate().
+
+Arguments:
+
+    DmfModule - The given DMF Module.
+    AuxiliaryLockIndex - Index of the auxiliary lock object
+
+Return Value:
+
+    None
+
+--*/
+{
+    DMF_OBJECT* dmfObject;
+
+    dmfObject = DMF_ModuleToObject(DmfModule);
+    DmfAssert(dmfObject != NULL);
+    DMF_HandleValidate_IsAvailable(dmfObject);
+    DmfAssert(AuxiliaryLockIndex < dmfObject->ModuleDescriptor.NumberOfAuxiliaryLocks);
+
+    // This check is required for SAL.
+    //
+    if (AuxiliaryLockIndex < DMF_MAXIMUM_AUXILIARY_LOCKS)
+    {
+        // Device lock is at 0. Auxiliary locks start from 1.
+        // AuxiliaryLockIndex is 0 based.
+        //
+        DMF_SynchronizationRelease(dmfObject,
+                                   AuxiliaryLockIndex + DMF_NUMBER_OF_DEFAULT_LOCKS,
+                                   TRUE);
+    }
+    else
+    {
+        DmfAssert(FALSE);
+    }
+}
+
 // eof: DmfHelpers.c
 //
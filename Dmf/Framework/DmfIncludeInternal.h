@@ -89,6 +89,68 @@ typedef enum
     ModuleOpenedDuringType_Maximum
 } ModuleOpenedDuringType;
 
+// Maximum number of locks in a DMF_MODULE_LOCK_TYPE_Sharded lock.
+//
+#define DMF_MAXIMUM_LOCK_SHARDS             64
+
+// One of the per-processor locks of a DMF_MODULE_LOCK_TYPE_Sharded lock.
+// Each shard is in its own cache line so that processors do not contend on it.
+//
+typedef DECLSPEC_CACHEALIGN struct
+{
+    // DISPATCH_LEVEL shard lock.
+    //
+    WDFSPINLOCK SynchronizationDispatchSpinLock;
+    // PASSIVE_LEVEL shard lock.
+    //
+    WDFWAITLOCK SynchronizationPassiveWaitLock;
+    // Thread that holds this shard. It is used to find the shard when a shared
+    // acquisition is released because the thread may have moved to a different processor.
+    //
+    HANDLE LockHeldByThread;
+} DMF_SYNCHRONIZATION_SHARD;
+
+// Lock profiling records how often each Module lock is acquired, how often it is contended and
+// how long it is held and waited on. It is always enabled in DEBUG builds. Define DMF_LOCK_PROFILING
+// in the project settings to enable it in Release builds.
+//
+#if defined(DEBUG) && !defined(DMF_LOCK_PROFILING)
+#define DMF_LOCK_PROFILING
+#endif // defined(DEBUG) && !defined(DMF_LOCK_PROFILING)
+
+#if defined(DMF_LOCK_PROFILING)
+// Lock statistics. They are part of DMF_OBJECT so they are included in the DMF data
+// written to Live Kernel Memory Dumps.
+//
+typedef struct
+{
+    // Number of times the lock is acquired exclusively.
+    //
+    volatile LONG64 ExclusiveAcquisitions;
+    // Number of times the lock is acquired shared.
+    //
+    volatile LONG64 SharedAcquisitions;
+    // Number of acquisitions that had to wait for another owner.
+    //
+    volatile LONG64 ContendedAcquisitions;
+    // Number of threads that currently own or wait for the lock.
+    //
+    volatile LONG ExclusiveOwnersAndWaiters;
+    volatile LONG SharedOwners;
+    // Exclusive hold times in performance counter ticks.
+    //
+    LONGLONG ExclusiveAcquireTimestamp;
+    LONGLONG ExclusiveHoldTimeTotal;
+    LONGLONG ExclusiveHoldTimeMaximum;
+    // Longest time any caller waited to acquire the lock in performance counter ticks.
+    //
+    volatile LONGLONG WaitTimeMaximum;
+    // Performance counter frequency used to convert the above times.
+    //
+    LONGLONG TimestampFrequency;
+} DMF_SYNCHRONIZATION_STATISTICS;
+#endif // defined(DMF_LOCK_PROFILING)
+
 typedef struct
 {
     // DISPATCH_LEVEL Synchronization Generic Device Lock.
@@ -97,9 +159,31 @@ typedef struct
     // PASSIVE_LEVEL Synchronization Generic Device Lock.
     //
     WDFWAITLOCK SynchronizationPassiveWaitLock;
+    // DMF_MODULE_LOCK_TYPE_ReaderWriter lock.
+    //
+#if defined(DMF_KERNEL_MODE)
+    EX_PUSH_LOCK SynchronizationPassiveReaderWriterLock;
+    EX_SPIN_LOCK SynchronizationDispatchReaderWriterLock;
+    // IRQL to restore when the exclusive owner of SynchronizationDispatchReaderWriterLock releases it.
+    //
+    KIRQL SynchronizationDispatchReaderWriterIrql;
+    // IRQL to restore when a shared owner of SynchronizationDispatchReaderWriterLock releases it.
+    // Shared owners run at DISPATCH_LEVEL so there is one per processor.
+    //
+    KIRQL* SynchronizationDispatchReaderWriterSharedIrql;
+#else
+    SRWLOCK SynchronizationReaderWriterLock;
+#endif // defined(DMF_KERNEL_MODE)
+    // DMF_MODULE_LOCK_TYPE_Sharded locks.
+    //
+    DMF_SYNCHRONIZATION_SHARD* SynchronizationShards;
+    ULONG NumberOfSynchronizationShards;
     // For debug purposes only.
     //
     HANDLE LockHeldByThread;
+#if defined(DMF_LOCK_PROFILING)
+    DMF_SYNCHRONIZATION_STATISTICS Statistics;
+#endif // defined(DMF_LOCK_PROFILING)
 } DMF_SYNCHRONIZATION;
 
 // Maximum number of Auxiliary locks per DMF Module.
@@ -166,6 +250,57 @@ typedef struct _DMF_OBJECT_ DMF_OBJECT;
 //
 typedef struct _DMF_MODULE_COLLECTION_ DMF_MODULE_COLLECTION;
 
+// Alignment of every allocation carved from a Module Arena.
+//
+#define DMF_MODULE_ARENA_ALIGN(Size)            (((Size) + (MEMORY_ALLOCATION_ALIGNMENT - 1)) & ~((size_t)MEMORY_ALLOCATION_ALIGNMENT - 1))
+// Size of each additional chunk added to a Module Arena when the initial chunk is full.
+//
+#define DMF_MODULE_ARENA_CHUNK_SIZE             (4096)
+// Space reserved for a Module Instance Name when the initial chunk of a Module Arena is sized.
+//
+#define DMF_MODULE_ARENA_INSTANCE_NAME_SIZE     (32)
+
+// A chunk of memory that belongs to a Module Arena. Allocations are carved sequentially
+// from the memory that immediately follows this header.
+//
+typedef struct _DMF_MODULE_ARENA_CHUNK_ DMF_MODULE_ARENA_CHUNK;
+struct _DMF_MODULE_ARENA_CHUNK_
+{
+    // Previously filled chunk (or NULL).
+    //
+    DMF_MODULE_ARENA_CHUNK* NextChunk;
+    // Number of bytes that follow this header.
+    //
+    size_t SizeBytes;
+    // Number of bytes that have been carved from this chunk.
+    //
+    size_t OffsetBytes;
+};
+
+// Memory from which the DMF owned allocations (Module Config, Instance Name and Callback tables)
+// of all the static Modules in a Module tree are carved. It is created by the top level Module
+// Collection and referenced by every Module that allocates from it. It is freed, all at once,
+// when the last of those Modules is destroyed.
+// NOTE: Allocations only happen while the top level Module Collection is created, so they are
+//       not synchronized.
+//
+typedef struct
+{
+    // One reference for each Module that has carved memory from this arena and one for the
+    // Module Collection while it is being created.
+    //
+    volatile LONG ReferenceCount;
+    // Chunk that allocations are currently carved from.
+    //
+    DMF_MODULE_ARENA_CHUNK* CurrentChunk;
+    // For debug purposes only.
+    //
+    ULONG NumberOfModules;
+    ULONG NumberOfChunks;
+    size_t BytesAllocated;
+    size_t BytesReserved;
+} DMF_MODULE_ARENA;
+
 struct _DMF_OBJECT_
 {
     // This element is used to insert an instance of this structure into a list
@@ -269,6 +404,10 @@ struct _DMF_OBJECT_
     // Parent Module Collection.
     //
     DMF_MODULE_COLLECTION* ModuleCollection;
+    // Arena that this Module's DMF owned allocations are carved from.
+    // It is NULL for Dynamic Modules which use their own allocations.
+    //
+    DMF_MODULE_ARENA* ModuleArena;
     // Synchronization Locks.
     // This includes one default lock and a number of auxiliary locks as specified by Client.
     //
@@ -322,6 +461,7 @@ struct _DMF_OBJECT_
 #define DMF_TAG6                           '6fmD'
 #define DMF_TAG7                           '7fmD'
 #define DMF_TAG8                           '8fmD'
+#define DMF_TAG9                           '9fmD'
 
 #define DMF_TAG_DYNAMIC_MODULE_REFERENCE    ((VOID*)0x7654)
 
@@ -374,6 +514,21 @@ struct _DMF_MODULE_COLLECTION_
     //
     DMF_CALLBACKS_WDF_CHECK DmfCallbacksWdfCheck;
 
+    // Sorted list of the IOCTL codes that Modules (including Child Modules) declared using
+    // ModuleIoctlCodesGet. IOCTLs that are not in this list are not dispatched to the Modules
+    // unless a Module that handles the corresponding entry point did not declare its IOCTL codes.
+    //
+    ULONG* IoctlCodesOfInterest;
+    ULONG NumberOfIoctlCodesOfInterest;
+    WDFMEMORY IoctlCodesOfInterestMemory;
+    BOOLEAN DeviceIoControlInterestAll;
+    BOOLEAN InternalDeviceIoControlInterestAll;
+
+    // Number of IOCTLs that were not dispatched to the Modules and number of IOCTLs that were.
+    //
+    volatile LONG64 IoctlsBypassed;
+    volatile LONG64 IoctlsDispatched;
+
     // Indicates that Client invoked Create callbacks manually.
     // It is necessary for the case where Module Collection Cleanup callback
     // is called, but the Client has not had a chance to call the corresponding
@@ -621,6 +776,31 @@ DMF_GenericMemoryFree(
     _In_ ULONG Tag
     );
 
+_IRQL_requires_max_(PASSIVE_LEVEL)
+_Must_inspect_result_
+NTSTATUS
+DMF_ModuleArenaCreate(
+    _In_ size_t InitialSizeBytes,
+    _Out_ DMF_MODULE_ARENA** ModuleArena
+    );
+
+_IRQL_requires_max_(PASSIVE_LEVEL)
+VOID*
+DMF_ModuleArenaAllocate(
+    _Inout_ DMF_MODULE_ARENA* ModuleArena,
+    _In_ size_t Size
+    );
+
+VOID
+DMF_ModuleArenaReference(
+    _Inout_ DMF_MODULE_ARENA* ModuleArena
+    );
+
+VOID
+DMF_ModuleArenaDereference(
+    _Inout_ DMF_MODULE_ARENA* ModuleArena
+    );
+
 NTSTATUS
 DMF_GenericSpinLockCreate(
     _In_ GENERIC_SPINLOCK_CREATE_CONTEXT* NativeLockCreateContext,
@@ -652,6 +832,22 @@ DMF_SynchronizationCreate(
     _In_ BOOLEAN PassiveLevel
     );
 
+_IRQL_requires_max_(DISPATCH_LEVEL)
+VOID
+DMF_SynchronizationAcquire(
+    _In_ DMF_OBJECT* DmfObject,
+    _In_ ULONG LockIndex,
+    _In_ BOOLEAN Shared
+    );
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+VOID
+DMF_SynchronizationRelease(
+    _In_ DMF_OBJECT* DmfObject,
+    _In_ ULONG LockIndex,
+    _In_ BOOLEAN Shared
+    );
+
 VOID
 DMF_HandleValidate_Create(
     _In_ DMF_OBJECT* DmfObject
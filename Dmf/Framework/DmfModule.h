@@ -254,6 +254,16 @@ DMF_ModuleInternalDeviceIoControl(_In_ DMFMODULE DmfModule,
                                   _In_ size_t InputBufferLength, 
                                   _In_ ULONG IoControlCode);
 
+typedef
+_Function_class_(DMF_ModuleIoctlCodesGet)
+_IRQL_requires_same_
+_IRQL_requires_max_(PASSIVE_LEVEL)
+BOOLEAN
+DMF_ModuleIoctlCodesGet(_In_ DMFMODULE DmfModule,
+                        _Out_writes_opt_(IoctlCodesCount) ULONG* IoctlCodes,
+                        _In_ ULONG IoctlCodesCount,
+                        _Out_ ULONG* NumberOfIoctlCodes);
+
 typedef
 _Function_class_(DMF_ModuleSelfManagedIoCleanup)
 _IRQL_requires_same_
@@ -434,6 +444,28 @@ DMF_ModuleAuxiliaryUnlockPrivate(
     _In_ ULONG AuxiliaryLockIndex
     );
 
+VOID
+DMF_ModuleLockSharedPrivate(
+    _In_ DMFMODULE DmfModule
+    );
+
+VOID
+DMF_ModuleUnlockSharedPrivate(
+    _In_ DMFMODULE DmfModule
+    );
+
+VOID
+DMF_ModuleAuxiliaryLockSharedPrivate(
+    _In_ DMFMODULE DmfModule,
+    _In_ ULONG AuxiliaryLockIndex
+    );
+
+VOID
+DMF_ModuleAuxiliaryUnlockSharedPrivate(
+    _In_ DMFMODULE DmfModule,
+    _In_ ULONG AuxiliaryLockIndex
+    );
+
 // Macros called by Modules.
 //
 // NOTE: Lock/Unlock inline functions return NULL to force the compiler to
@@ -509,6 +541,54 @@ DMF_ModuleAuxiliaryUnlock(
                                      AuxiliaryLockIndex);                                                \
     return NULL;                                                                                         \
 }                                                                                                        \
+                                                                                                         \
+__forceinline                                                                                            \
+DMF_CONTEXT_##ModuleName*                                                                                \
+DMF_ModuleLockShared(DMFMODULE DmfModule)                                                                \
+{                                                                                                        \
+    DmfVerifierAssert("Invalid Module Handle Passed (LockShared)",                                       \
+                      WdfObjectIsCustomType(DmfModule, DMF_##ModuleName));                               \
+    DMF_ModuleLockSharedPrivate(DmfModule);                                                              \
+    return NULL;                                                                                         \
+}                                                                                                        \
+                                                                                                         \
+__forceinline                                                                                            \
+DMF_CONTEXT_##ModuleName*                                                                                \
+DMF_ModuleUnlockShared(DMFMODULE DmfModule)                                                              \
+{                                                                                                        \
+    DmfVerifierAssert("Invalid Module Handle Passed (UnlockShared)",                                     \
+                      WdfObjectIsCustomType(DmfModule, DMF_##ModuleName));                               \
+    DMF_ModuleUnlockSharedPrivate(DmfModule);                                                            \
+    return NULL;                                                                                         \
+}                                                                                                        \
+                                                                                                         \
+__forceinline                                                                                            \
+DMF_CONTEXT_##ModuleName*                                                                                \
+DMF_ModuleAuxiliaryLockShared(                                                                           \
+    _In_ DMFMODULE DmfModule,                                                                            \
+    _In_ ULONG AuxiliaryLockIndex                                                                        \
+    )                                                                                                    \
+{                                                                                                        \
+    DmfVerifierAssert("Invalid Module Handle Passed (LockShared)",                                       \
+                      WdfObjectIsCustomType(DmfModule, DMF_##ModuleName));                               \
+    DMF_ModuleAuxiliaryLockSharedPrivate(DmfModule,                                                      \
+                                         AuxiliaryLockIndex);                                            \
+    return NULL;                                                                                         \
+}                                                                                                        \
+                                                                                                         \
+__forceinline                                                                                            \
+DMF_CONTEXT_##ModuleName*                                                                                \
+DMF_ModuleAuxiliaryUnlockShared(                                                                         \
+    _In_ DMFMODULE DmfModule,                                                                            \
+    _In_ ULONG AuxiliaryLockIndex                                                                        \
+    )                                                                                                    \
+{                                                                                                        \
+    DmfVerifierAssert("Invalid Module Handle Passed (UnlockShared)",                                     \
+                      WdfObjectIsCustomType(DmfModule, DMF_##ModuleName));                               \
+    DMF_ModuleAuxiliaryUnlockSharedPrivate(DmfModule,                                                    \
+                                           AuxiliaryLockIndex);                                          \
+    return NULL;                                                                                         \
+}                                                                                                        \
 
 #define DMF_MODULE_DECLARE_CONFIG(ModuleName)                                                   \
                                                                                                 \
@@ -776,6 +856,14 @@ typedef struct
     // this method.
     //
     DMF_WdfAddCustomType* WdfAddCustomType;
+    // Allows the Module to declare the IOCTL codes handled by its ModuleDeviceIoControl and
+    // ModuleInternalDeviceIoControl callbacks (optional). DMF does not dispatch IOCTLs that no Module
+    // handles so that Filter drivers can send them down the stack immediately.
+    // The callback writes the codes to IoctlCodes if IoctlCodesCount is large enough and always sets
+    // NumberOfIoctlCodes. It returns FALSE if the Module handles IOCTLs that cannot be listed.
+    // If this element is not set, the Module is considered to handle every IOCTL.
+    //
+    DMF_ModuleIoctlCodesGet* ModuleIoctlCodesGet;
 } DMF_MODULE_DESCRIPTOR;
 
 #define DMF_MODULE_DESCRIPTOR_INIT(Descriptor, Name, Module_Options, Open_Option)                       \
@@ -888,6 +976,64 @@ DMF_ModuleAuxiliarySynchnonizationIsLocked(
     );
 #endif // defined(DEBUG)
 
+// Maximum size of the Module instance name stored in DMF_MODULE_LOCK_STATISTICS.
+//
+#define DMF_MODULE_LOCK_STATISTICS_NAME_SIZE            32
+
+// Lock profiling data of a single Module lock.
+// It is only available when DMF is built with DMF_LOCK_PROFILING (always the case in DEBUG builds).
+//
+typedef struct
+{
+    // Name of the Module instance that owns the lock (truncated if necessary).
+    //
+    CHAR ModuleInstanceName[DMF_MODULE_LOCK_STATISTICS_NAME_SIZE];
+    // Index of the lock. Module lock is at 0. Auxiliary locks start from 1.
+    //
+    ULONG LockIndex;
+    // Number of times the lock is acquired exclusively and shared.
+    //
+    ULONG64 ExclusiveAcquisitions;
+    ULONG64 SharedAcquisitions;
+    // Number of acquisitions that had to wait for another owner.
+    //
+    ULONG64 ContendedAcquisitions;
+    // Time the lock has been held exclusively.
+    //
+    ULONG64 HoldTimeTotalMicroseconds;
+    ULONG64 HoldTimeMaximumMicroseconds;
+    // Longest time any caller waited to acquire the lock.
+    //
+    ULONG64 WaitTimeMaximumMicroseconds;
+} DMF_MODULE_LOCK_STATISTICS;
+
+typedef
+_Function_class_(EVT_DMF_MODULE_LockStatistics)
+_IRQL_requires_same_
+_IRQL_requires_max_(PASSIVE_LEVEL)
+VOID
+EVT_DMF_MODULE_LockStatistics(_In_ DMFMODULE DmfModule,
+                              _In_ DMF_MODULE_LOCK_STATISTICS* LockStatistics,
+                              _In_opt_ VOID* CallbackContext);
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+_Must_inspect_result_
+NTSTATUS
+DMF_ModuleLockStatisticsGet(
+    _In_ DMFMODULE DmfModule,
+    _In_ ULONG LockIndex,
+    _Out_ DMF_MODULE_LOCK_STATISTICS* LockStatistics
+    );
+
+_IRQL_requires_max_(PASSIVE_LEVEL)
+_Must_inspect_result_
+NTSTATUS
+DMF_ModuleLockStatisticsEnumerate(
+    _In_ DMFMODULE DmfModule,
+    _In_ EVT_DMF_MODULE_LockStatistics* LockStatisticsCallback,
+    _In_opt_ VOID* CallbackContext
+    );
+
 _IRQL_requires_max_(DISPATCH_LEVEL)
 VOID*
 DMF_ModuleConfigGet(
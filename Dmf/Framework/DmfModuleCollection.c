@@ -722,6 +722,297 @@ Return Value:
     FuncExit(DMF_TRACE, "ModuleCollectionHandle=0x%p", ModuleCollectionHandle);
 }
 
+#pragma code_seg("PAGE")
+_IRQL_requires_max_(PASSIVE_LEVEL)
+static
+VOID
+DmfModuleCollectionIoctlCodesGather(
+    _In_ DMF_MODULE_COLLECTION* ModuleCollectionHandle,
+    _In_ DMF_OBJECT* DmfObject,
+    _Out_writes_opt_(IoctlCodesCount) ULONG* IoctlCodes,
+    _In_ ULONG IoctlCodesCount,
+    _Inout_ ULONG* NumberOfIoctlCodes
+    )
+/*++
+
+Routine Description:
+
+    Given a Module, gather the IOCTL codes it and its Child Modules declare. Modules that handle
+    IOCTLs but do not declare the codes cause every IOCTL to be dispatched.
+
+Arguments:
+
+    ModuleCollectionHandle - The list of the Client Driver's instantiated Modules.
+    DmfObject - The given Module.
+    IoctlCodes - Where the IOCTL codes are written. NULL to only count the IOCTL codes.
+    IoctlCodesCount - Number of entries in IoctlCodes.
+    NumberOfIoctlCodes - Number of IOCTL codes gathered so far. It is updated by this function.
+
+Return Value:
+
+    None
+
+--*/
+{
+    DMF_OBJECT* childDmfObject;
+    CHILD_OBJECT_INTERATION_CONTEXT childObjectIterationContext;
+    BOOLEAN deviceIoControlImplemented;
+    BOOLEAN internalDeviceIoControlImplemented;
+
+    PAGED_CODE();
+
+    deviceIoControlImplemented = (DmfObject->ModuleDescriptor.CallbacksWdf->ModuleDeviceIoControl != DMF_Generic_ModuleDeviceIoControl);
+    internalDeviceIoControlImplemented = (DmfObject->ModuleDescriptor.CallbacksWdf->ModuleInternalDeviceIoControl != DMF_Generic_ModuleInternalDeviceIoControl);
+
+    if (deviceIoControlImplemented || internalDeviceIoControlImplemented)
+    {
+        BOOLEAN declared;
+        ULONG numberOfModuleIoctlCodes;
+
+        declared = FALSE;
+        numberOfModuleIoctlCodes = 0;
+        if (DmfObject->ModuleDescriptor.ModuleIoctlCodesGet != NULL)
+        {
+            ULONG* moduleIoctlCodes;
+            ULONG moduleIoctlCodesCount;
+
+            if ((IoctlCodes != NULL) &&
+                (*NumberOfIoctlCodes < IoctlCodesCount))
+            {
+                moduleIoctlCodes = &IoctlCodes[*NumberOfIoctlCodes];
+                moduleIoctlCodesCount = IoctlCodesCount - *NumberOfIoctlCodes;
+            }
+            else
+            {
+                moduleIoctlCodes = NULL;
+                moduleIoctlCodesCount = 0;
+            }
+
+            declared = DmfObject->ModuleDescriptor.ModuleIoctlCodesGet(DMF_ObjectToModule(DmfObject),
+                                                                       moduleIoctlCodes,
+                                                                       moduleIoctlCodesCount,
+                                                                       &numberOfModuleIoctlCodes);
+        }
+
+        if (declared)
+        {
+            *NumberOfIoctlCodes += numberOfModuleIoctlCodes;
+        }
+        else
+        {
+            TraceEvents(TRACE_LEVEL_VERBOSE, DMF_TRACE, "Module [%s] handles every IOCTL", DmfObject->ClientModuleInstanceName);
+            if (deviceIoControlImplemented)
+            {
+                ModuleCollectionHandle->DeviceIoControlInterestAll = TRUE;
+            }
+            if (internalDeviceIoControlImplemented)
+            {
+                ModuleCollectionHandle->InternalDeviceIoControlInterestAll = TRUE;
+            }
+        }
+    }
+
+    childDmfObject = DmfChildObjectFirstGet(DmfObject,
+                                            &childObjectIterationContext);
+    while (childDmfObject != NULL)
+    {
+        DmfModuleCollectionIoctlCodesGather(ModuleCollectionHandle,
+                                            childDmfObject,
+                                            IoctlCodes,
+                                            IoctlCodesCount,
+                                            NumberOfIoctlCodes);
+        childDmfObject = DmfChildObjectNextGet(&childObjectIterationContext);
+    }
+}
+#pragma code_seg()
+
+#pragma code_seg("PAGE")
+_IRQL_requires_max_(PASSIVE_LEVEL)
+_Must_inspect_result_
+static
+NTSTATUS
+DmfModuleCollectionIoctlCodesOfInterestCreate(
+    _In_ DMF_MODULE_COLLECTION* ModuleCollectionHandle
+    )
+/*++
+
+Routine Description:
+
+    Create the sorted list of IOCTL codes that Modules in the given Module Collection handle.
+    It is used to avoid dispatching IOCTLs that no Module handles.
+
+Arguments:
+
+    ModuleCollectionHandle - The list of the Client Driver's instantiated Modules.
+
+Return Value:
+
+    NTSTATUS
+
+--*/
+{
+    NTSTATUS ntStatus;
+    LONG driverModuleIndex;
+    ULONG numberOfIoctlCodes;
+    ULONG numberOfIoctlCodesWritten;
+    ULONG numberOfUniqueIoctlCodes;
+    ULONG* ioctlCodes;
+    WDF_OBJECT_ATTRIBUTES attributes;
+
+    PAGED_CODE();
+
+    FuncEntryArguments(DMF_TRACE, "ModuleCollectionHandle=0x%p", ModuleCollectionHandle);
+
+    ntStatus = STATUS_SUCCESS;
+
+    // Count the IOCTL codes.
+    //
+    numberOfIoctlCodes = 0;
+    for (driverModuleIndex = 0; driverModuleIndex < ModuleCollectionHandle->NumberOfClientDriverDmfModules; driverModuleIndex++)
+    {
+        DmfModuleCollectionIoctlCodesGather(ModuleCollectionHandle,
+                                            ModuleCollectionHandle->ClientDriverDmfModules[driverModuleIndex],
+                                            NULL,
+                                            0,
+                                            &numberOfIoctlCodes);
+    }
+
+    if ((0 == numberOfIoctlCodes) ||
+        (ModuleCollectionHandle->DeviceIoControlInterestAll && ModuleCollectionHandle->InternalDeviceIoControlInterestAll))
+    {
+        // Either no Module declared IOCTL codes or every IOCTL is dispatched anyway.
+        //
+        goto Exit;
+    }
+
+    WDF_OBJECT_ATTRIBUTES_INIT(&attributes);
+    attributes.ParentObject = ModuleCollectionHandle->ModuleCollectionHandleMemory;
+    ntStatus = WdfMemoryCreate(&attributes,
+                               NonPagedPoolNx,
+                               DMF_TAG,
+                               sizeof(ULONG) * numberOfIoctlCodes,
+                               &ModuleCollectionHandle->IoctlCodesOfInterestMemory,
+                               (VOID**)&ioctlCodes);
+    if (! NT_SUCCESS(ntStatus))
+    {
+        TraceEvents(TRACE_LEVEL_ERROR, DMF_TRACE, "WdfMemoryCreate fails: ntStatus=%!STATUS!", ntStatus);
+        ModuleCollectionHandle->IoctlCodesOfInterestMemory = NULL;
+        goto Exit;
+    }
+
+    // Write the IOCTL codes. Modules must declare the same IOCTL codes both times.
+    //
+    numberOfIoctlCodesWritten = 0;
+    for (driverModuleIndex = 0; driverModuleIndex < ModuleCollectionHandle->NumberOfClientDriverDmfModules; driverModuleIndex++)
+    {
+        DmfModuleCollectionIoctlCodesGather(ModuleCollectionHandle,
+                                            ModuleCollectionHandle->ClientDriverDmfModules[driverModuleIndex],
+                                            ioctlCodes,
+                                            numberOfIoctlCodes,
+                                            &numberOfIoctlCodesWritten);
+    }
+    DmfAssert(numberOfIoctlCodesWritten == numberOfIoctlCodes);
+
+    // Sort the IOCTL codes and remove duplicates so that they can be binary searched.
+    // (The list is small and only sorted once.)
+    //
+    for (ULONG ioctlCodeIndex = 1; ioctlCodeIndex < numberOfIoctlCodes; ioctlCodeIndex++)
+    {
+        ULONG ioctlCode = ioctlCodes[ioctlCodeIndex];
+        ULONG insertIndex = ioctlCodeIndex;
+        while ((insertIndex > 0) &&
+               (ioctlCodes[insertIndex - 1] > ioctlCode))
+        {
+            ioctlCodes[insertIndex] = ioctlCodes[insertIndex - 1];
+            insertIndex--;
+        }
+        ioctlCodes[insertIndex] = ioctlCode;
+    }
+
+    numberOfUniqueIoctlCodes = 1;
+    for (ULONG ioctlCodeIndex = 1; ioctlCodeIndex < numberOfIoctlCodes; ioctlCodeIndex++)
+    {
+        if (ioctlCodes[ioctlCodeIndex] != ioctlCodes[numberOfUniqueIoctlCodes - 1])
+        {
+            ioctlCodes[numberOfUniqueIoctlCodes] = ioctlCodes[ioctlCodeIndex];
+            numberOfUniqueIoctlCodes++;
+        }
+    }
+
+    ModuleCollectionHandle->IoctlCodesOfInterest = ioctlCodes;
+    ModuleCollectionHandle->NumberOfIoctlCodesOfInterest = numberOfUniqueIoctlCodes;
+
+Exit:
+
+    FuncExit(DMF_TRACE, "ModuleCollectionHandle=0x%p NumberOfIoctlCodesOfInterest=%d ntStatus=%!STATUS!",
+             ModuleCollectionHandle,
+             ModuleCollectionHandle->NumberOfIoctlCodesOfInterest,
+             ntStatus);
+
+    return ntStatus;
+}
+#pragma code_seg()
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+static
+BOOLEAN
+DmfModuleCollectionIoctlIsOfInterest(
+    _In_ DMF_MODULE_COLLECTION* ModuleCollectionHandle,
+    _In_ BOOLEAN InterestAll,
+    _In_ ULONG IoControlCode
+    )
+/*++
+
+Routine Description:
+
+    Determines if any Module in the given Module Collection handles the given IOCTL.
+
+Arguments:
+
+    ModuleCollectionHandle - The list of the Client Driver's instantiated Modules.
+    InterestAll - Indicates that a Module handles every IOCTL of this type.
+    IoControlCode - The given IOCTL code.
+
+Return Value:
+
+    TRUE if the IOCTL must be dispatched to the Modules.
+    FALSE if no Module handles the IOCTL.
+
+--*/
+{
+    BOOLEAN returnValue;
+    LONG lowIndex;
+    LONG highIndex;
+
+    // NOTE: No entry/exit logging since this is called for every IOCTL.
+    //
+
+    returnValue = InterestAll;
+
+    lowIndex = 0;
+    highIndex = (LONG)ModuleCollectionHandle->NumberOfIoctlCodesOfInterest - 1;
+    while ((! returnValue) &&
+           (lowIndex <= highIndex))
+    {
+        LONG middleIndex = lowIndex + ((highIndex - lowIndex) / 2);
+        ULONG ioctlCode = ModuleCollectionHandle->IoctlCodesOfInterest[middleIndex];
+        if (ioctlCode == IoControlCode)
+        {
+            returnValue = TRUE;
+        }
+        else if (ioctlCode < IoControlCode)
+        {
+            lowIndex = middleIndex + 1;
+        }
+        else
+        {
+            highIndex = middleIndex - 1;
+        }
+    }
+
+    return returnValue;
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 //
 // Module Collection Dispatch Functions
@@ -1464,10 +1755,26 @@ Return Value:
     //
     if (! moduleCollectionHandle->DmfCallbacksWdfCheck.ModuleDeviceIoControlImplemented)
     {
+        InterlockedIncrement64(&moduleCollectionHandle->IoctlsBypassed);
         TraceEvents(TRACE_LEVEL_VERBOSE, DMF_TRACE, "No Modules in Collection implement ModuleDeviceIoControl handled=%d", handled);
         goto Exit;
     }
 
+    // If every Module that handles this entry point declared the IOCTL codes it handles,
+    // do not iterate through the Collection and Child Modules for other IOCTL codes. This allows
+    // Filter drivers to send such Requests down the stack immediately.
+    //
+    if (! DmfModuleCollectionIoctlIsOfInterest(moduleCollectionHandle,
+                                               moduleCollectionHandle->DeviceIoControlInterestAll,
+                                               IoControlCode))
+    {
+        InterlockedIncrement64(&moduleCollectionHandle->IoctlsBypassed);
+        TraceEvents(TRACE_LEVEL_VERBOSE, DMF_TRACE, "No Modules in Collection handle IoControlCode=0x%08X handled=%d", IoControlCode, handled);
+        goto Exit;
+    }
+
+    InterlockedIncrement64(&moduleCollectionHandle->IoctlsDispatched);
+
     DmfAssert(moduleCollectionHandle->NumberOfClientDriverDmfModules > 0);
     for (driverModuleIndex = 0; driverModuleIndex < moduleCollectionHandle->NumberOfClientDriverDmfModules; driverModuleIndex++)
     {
@@ -1551,10 +1858,26 @@ Return Value:
     //
     if (! moduleCollectionHandle->DmfCallbacksWdfCheck.ModuleInternalDeviceIoControlImplemented)
     {
+        InterlockedIncrement64(&moduleCollectionHandle->IoctlsBypassed);
         TraceEvents(TRACE_LEVEL_VERBOSE, DMF_TRACE, "No Modules in Collection implement ModuleInternalDeviceIoControl handled=%d", handled);
         goto Exit;
     }
 
+    // If every Module that handles this entry point declared the IOCTL codes it handles,
+    // do not iterate through the Collection and Child Modules for other IOCTL codes. This allows
+    // Filter drivers to send such Requests down the stack immediately.
+    //
+    if (! DmfModuleCollectionIoctlIsOfInterest(moduleCollectionHandle,
+                                               moduleCollectionHandle->InternalDeviceIoControlInterestAll,
+                                               IoControlCode))
+    {
+        InterlockedIncrement64(&moduleCollectionHandle->IoctlsBypassed);
+        TraceEvents(TRACE_LEVEL_VERBOSE, DMF_TRACE, "No Modules in Collection handle IoControlCode=0x%08X handled=%d", IoControlCode, handled);
+        goto Exit;
+    }
+
+    InterlockedIncrement64(&moduleCollectionHandle->IoctlsDispatched);
+
     DmfAssert(moduleCollectionHandle->NumberOfClientDriverDmfModules > 0);
     for (driverModuleIndex = 0; driverModuleIndex < moduleCollectionHandle->NumberOfClientDriverDmfModules; driverModuleIndex++)
     {
@@ -3215,6 +3538,104 @@ Return Value:
 }
 #pragma code_seg()
 
+static
+ULONGLONG
+DmfModuleCollectionTimestampMicrosecondsGet(
+    VOID
+    )
+/*++
+
+Routine Description:
+
+    Returns a high resolution timestamp used to measure how long Module Collection creation takes.
+
+Arguments:
+
+    None
+
+Return Value:
+
+    The current value of the performance counter in microseconds.
+
+--*/
+{
+    LARGE_INTEGER counter;
+    LARGE_INTEGER frequency;
+
+#if defined(DMF_USER_MODE)
+    QueryPerformanceCounter(&counter);
+    QueryPerformanceFrequency(&frequency);
+#else
+    counter = KeQueryPerformanceCounter(&frequency);
+#endif // defined(DMF_USER_MODE)
+
+    return (ULONGLONG)((counter.QuadPart / frequency.QuadPart) * 1000 * 1000) +
+           (ULONGLONG)(((counter.QuadPart % frequency.QuadPart) * 1000 * 1000) / frequency.QuadPart);
+}
+
+#pragma code_seg("PAGE")
+static
+size_t
+DmfModuleCollectionArenaSizeGet(
+    _In_ DMF_MODULE_COLLECTION_CONFIG* ModuleCollectionConfig,
+    _In_ LONG FirstModuleToInstantiate,
+    _In_ LONG NumberOfModulesToCreate
+    )
+/*++
+
+Routine Description:
+
+    Calculates how much Module Arena memory the Modules in a Module Collection need for their
+    DMF owned allocations. Child Modules are only known as each Module is created, so
+    their memory is not included.
+
+Arguments:
+
+    ModuleCollectionConfig - Module Collection Config populated by the Client Driver.
+    FirstModuleToInstantiate - Index of the first Module in the list of Configs that will be created.
+    NumberOfModulesToCreate - Number of Modules in the list of Configs that will be created.
+
+Return Value:
+
+    Number of bytes needed by the Modules.
+
+--*/
+{
+    LONG moduleIndex;
+    size_t sizeBytes;
+    DMF_MODULE_ATTRIBUTES* moduleAttributes;
+    size_t instanceNameSizeBytes;
+
+    PAGED_CODE();
+
+    sizeBytes = 0;
+    for (moduleIndex = FirstModuleToInstantiate;
+         moduleIndex < FirstModuleToInstantiate + NumberOfModulesToCreate;
+         moduleIndex++)
+    {
+        #pragma warning(suppress:6387)
+        moduleAttributes = (DMF_MODULE_ATTRIBUTES*)WdfMemoryGetBuffer((WDFMEMORY)WdfCollectionGetItem(ModuleCollectionConfig->DmfPrivate.ListOfConfigs,
+                                                                                                      moduleIndex),
+                                                                      NULL);
+        // The Module Name is used when the Client does not provide an Instance Name, but it is not
+        // known until the Module is created.
+        //
+        instanceNameSizeBytes = strlen(moduleAttributes->ClientModuleInstanceName) + sizeof(CHAR);
+        if (instanceNameSizeBytes < DMF_MODULE_ARENA_INSTANCE_NAME_SIZE)
+        {
+            instanceNameSizeBytes = DMF_MODULE_ARENA_INSTANCE_NAME_SIZE;
+        }
+
+        sizeBytes += DMF_MODULE_ARENA_ALIGN(instanceNameSizeBytes) +
+                     DMF_MODULE_ARENA_ALIGN(moduleAttributes->SizeOfModuleSpecificConfig) +
+                     DMF_MODULE_ARENA_ALIGN(sizeof(DMF_CALLBACKS_DMF)) +
+                     DMF_MODULE_ARENA_ALIGN(sizeof(DMF_CALLBACKS_WDF));
+    }
+
+    return sizeBytes;
+}
+#pragma code_seg()
+
 #pragma code_seg("PAGE")
 _IRQL_requires_max_(PASSIVE_LEVEL)
 _Must_inspect_result_
@@ -3254,6 +3675,9 @@ Return Value:
     DMF_CONFIG_Bridge* bridgeModuleConfig;
     DMF_MODULE_ATTRIBUTES moduleAttributes;
     BOOLEAN createChildModuleCollection;
+    DMF_MODULE_ARENA* moduleArena;
+    BOOLEAN moduleArenaCreated;
+    ULONGLONG startTimeMicroseconds;
 
     PAGED_CODE();
 
@@ -3263,6 +3687,9 @@ Return Value:
 
     ntStatus = STATUS_UNSUCCESSFUL;
     moduleCollectionHandle = NULL;
+    moduleArena = NULL;
+    moduleArenaCreated = FALSE;
+    startTimeMicroseconds = DmfModuleCollectionTimestampMicrosecondsGet();
 
     // Module Collection can be top level Collection (created by Client Driver for top level Modules)
     // or child Module Collection (created by Module for its child Modules).
@@ -3489,6 +3916,33 @@ Return Value:
                       sizeof(DMF_OBJECT*) * numberOfClientModulesToCreate);
     }
 
+    // The top level Module Collection creates the arena that the whole static Module tree
+    // carves its DMF owned allocations from. It is sized for the top level Modules plus one
+    // chunk for their Child Modules. Child Module Collections use the arena of their Parent Module.
+    //
+    if (NULL == ModuleCollectionConfig->DmfPrivate.ParentDmfModule)
+    {
+        ntStatus = DMF_ModuleArenaCreate(DmfModuleCollectionArenaSizeGet(ModuleCollectionConfig,
+                                                                         firstModuleToInstantiate,
+                                                                         numberOfClientModulesToCreate) + DMF_MODULE_ARENA_CHUNK_SIZE,
+                                         &moduleArena);
+        if (NT_SUCCESS(ntStatus))
+        {
+            moduleArenaCreated = TRUE;
+        }
+        else
+        {
+            // Modules can still use their own allocations.
+            //
+            TraceEvents(TRACE_LEVEL_WARNING, DMF_TRACE, "DMF_ModuleArenaCreate fails: ntStatus=%!STATUS!", ntStatus);
+            moduleArena = NULL;
+        }
+    }
+    else
+    {
+        moduleArena = DMF_ModuleToObject(ModuleCollectionConfig->DmfPrivate.ParentDmfModule)->ModuleArena;
+    }
+
     // Create all the Modules in the Module Collection.
     //
     for (driverModuleIndex = firstModuleToInstantiate;
@@ -3535,6 +3989,7 @@ Return Value:
             moduleObjectAttributesPointer->ParentObject = ModuleCollectionConfig->DmfPrivate.ClientDriverWdfDevice;
             moduleAttributesPointer->DynamicModule = FALSE;
         }
+        moduleAttributesPointer->ModuleArena = moduleArena;
         ntStatus = moduleAttributesPointer->InstanceCreator(ModuleCollectionConfig->DmfPrivate.ClientDriverWdfDevice,
                                                             moduleAttributesPointer,
                                                             moduleObjectAttributesPointer,
@@ -3637,6 +4092,17 @@ Return Value:
         DmfAssert(NULL == moduleCollectionHandle->DmfObjectFeature[DmfFeature_LiveKernelDump]);
     }
 
+    if (! createChildModuleCollection)
+    {
+        // Find out which IOCTLs the Modules handle so that other IOCTLs are not dispatched.
+        //
+        ntStatus = DmfModuleCollectionIoctlCodesOfInterestCreate(moduleCollectionHandle);
+        if (! NT_SUCCESS(ntStatus))
+        {
+            goto Exit;
+        }
+    }
+
     DmfAssert(moduleCollectionHandle->NumberOfClientDriverDmfModules == numberOfClientModulesToCreate);
 
 Exit:
@@ -3670,6 +4136,29 @@ Exit:
         }
     }
 
+    if (moduleArenaCreated)
+    {
+        TraceEvents(TRACE_LEVEL_INFORMATION, DMF_TRACE, "Module Collection created in %I64u us: ntStatus=%!STATUS! NumberOfModules=%d ArenaBytesAllocated=%Iu ArenaBytesReserved=%Iu NumberOfChunks=%d",
+                    DmfModuleCollectionTimestampMicrosecondsGet() - startTimeMicroseconds,
+                    ntStatus,
+                    moduleArena->NumberOfModules,
+                    moduleArena->BytesAllocated,
+                    moduleArena->BytesReserved,
+                    moduleArena->NumberOfChunks);
+
+        // Release the reference the Module Collection holds. From now on, the arena is kept
+        // alive by the Modules that carved memory from it.
+        //
+        DMF_ModuleArenaDereference(moduleArena);
+        moduleArena = NULL;
+    }
+    else if (NULL == ModuleCollectionConfig->DmfPrivate.ParentDmfModule)
+    {
+        TraceEvents(TRACE_LEVEL_INFORMATION, DMF_TRACE, "Module Collection created in %I64u us: ntStatus=%!STATUS!",
+                    DmfModuleCollectionTimestampMicrosecondsGet() - startTimeMicroseconds,
+                    ntStatus);
+    }
+
     FuncExit(DMF_TRACE, "moduleCollectionHandle=0x%p ntStatus=%!STATUS!", moduleCollectionHandle, ntStatus);
 
     // The Client Driver stores this handle so that the it can be passed to the DMF Library's
@@ -4057,5 +4546,43 @@ Return Value:
 }
 #pragma code_seg()
 
+_IRQL_requires_max_(DISPATCH_LEVEL)
+VOID
+DMF_IoctlDispatchStatisticsGet(
+    _In_ WDFDEVICE Device,
+    _Out_ DMF_IOCTL_DISPATCH_STATISTICS* IoctlDispatchStatistics
+    )
+/*++
+
+Routine Description:
+
+    Returns the number of IOCTLs that were dispatched to the Modules of the given WDFDEVICE and
+    the number of IOCTLs that were not dispatched because no Module handles them.
+
+Arguments:
+
+    Device - The Client Driver's WDFDEVICE.
+    IoctlDispatchStatistics - Where the counters are written.
+
+Return Value:
+
+    None
+
+--*/
+{
+    DMF_DEVICE_CONTEXT* dmfDeviceContext;
+
+    RtlZeroMemory(IoctlDispatchStatistics,
+                  sizeof(DMF_IOCTL_DISPATCH_STATISTICS));
+
+    dmfDeviceContext = DmfDeviceContextGet(Device);
+    if (dmfDeviceContext->DmfCollection != NULL)
+    {
+        DMF_MODULE_COLLECTION* moduleCollectionHandle = DMF_CollectionToHandle(dmfDeviceContext->DmfCollection);
+        IoctlDispatchStatistics->IoctlsBypassed = moduleCollectionHandle->IoctlsBypassed;
+        IoctlDispatchStatistics->IoctlsDispatched = moduleCollectionHandle->IoctlsDispatched;
+    }
+}
+
 // eof: DmfModuleCollection.c
 //
@@ -70,6 +70,22 @@ typedef struct
     DMFMODULE DmfModuleRingBuffer;
 } DATA_BUFFER_SOURCE;
 
+// The public and the Framework lock profiling structures must use the same name size.
+//
+C_ASSERT(LIVEKERNELDUMP_LOCK_STATISTICS_NAME_SIZE == DMF_MODULE_LOCK_STATISTICS_NAME_SIZE);
+
+// Context used to copy lock profiling data to the output buffer of IOCTL_LIVEKERNELDUMP_LOCK_STATISTICS_QUERY.
+//
+typedef struct
+{
+    // The output buffer.
+    //
+    LIVEKERNELDUMP_LOCK_STATISTICS_OUTPUT_BUFFER* OutputBuffer;
+    // Number of entries that fit in the output buffer.
+    //
+    ULONG MaximumNumberOfEntries;
+} LOCK_STATISTICS_CONTEXT;
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////////
 // Module Private Context
 ///////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -898,6 +914,71 @@ Exit:
 #pragma code_seg()
 #endif  // IS_WIN10_RS3_OR_LATER
 
+#if IS_WIN10_RS3_OR_LATER
+#pragma code_seg("PAGE")
+_Function_class_(EVT_DMF_MODULE_LockStatistics)
+_IRQL_requires_same_
+_IRQL_requires_max_(PASSIVE_LEVEL)
+static
+VOID
+LiveKernelDump_LockStatisticsCopy(
+    _In_ DMFMODULE DmfModule,
+    _In_ DMF_MODULE_LOCK_STATISTICS* LockStatistics,
+    _In_opt_ VOID* CallbackContext
+    )
+/*++
+
+Routine Description:
+
+    Copy the lock profiling data of a single lock to the output buffer of
+    IOCTL_LIVEKERNELDUMP_LOCK_STATISTICS_QUERY if there is space for it.
+
+Arguments:
+
+    DmfModule - The Module that owns the lock.
+    LockStatistics - The lock profiling data.
+    CallbackContext - LOCK_STATISTICS_CONTEXT.
+
+Return Value:
+
+    None
+
+--*/
+{
+    LOCK_STATISTICS_CONTEXT* lockStatisticsContext;
+    LIVEKERNELDUMP_LOCK_STATISTICS* entry;
+
+    UNREFERENCED_PARAMETER(DmfModule);
+
+    PAGED_CODE();
+
+    DmfAssert(CallbackContext != NULL);
+    lockStatisticsContext = (LOCK_STATISTICS_CONTEXT*)CallbackContext;
+
+    lockStatisticsContext->OutputBuffer->NumberOfEntriesAvailable++;
+
+    // If the entry does not fit, the Client sends the IOCTL again with a larger buffer.
+    //
+    if (lockStatisticsContext->OutputBuffer->NumberOfEntries < lockStatisticsContext->MaximumNumberOfEntries)
+    {
+        entry = &lockStatisticsContext->OutputBuffer->Entries[lockStatisticsContext->OutputBuffer->NumberOfEntries];
+        lockStatisticsContext->OutputBuffer->NumberOfEntries++;
+
+        RtlCopyMemory(entry->ModuleInstanceName,
+                      LockStatistics->ModuleInstanceName,
+                      sizeof(entry->ModuleInstanceName));
+        entry->LockIndex = LockStatistics->LockIndex;
+        entry->ExclusiveAcquisitions = LockStatistics->ExclusiveAcquisitions;
+        entry->SharedAcquisitions = LockStatistics->SharedAcquisitions;
+        entry->ContendedAcquisitions = LockStatistics->ContendedAcquisitions;
+        entry->HoldTimeTotalMicroseconds = LockStatistics->HoldTimeTotalMicroseconds;
+        entry->HoldTimeMaximumMicroseconds = LockStatistics->HoldTimeMaximumMicroseconds;
+        entry->WaitTimeMaximumMicroseconds = LockStatistics->WaitTimeMaximumMicroseconds;
+    }
+}
+#pragma code_seg()
+#endif // IS_WIN10_RS3_OR_LATER
+
 #if IS_WIN10_RS3_OR_LATER
 #pragma code_seg("PAGE")
 _IRQL_requires_max_(PASSIVE_LEVEL)
@@ -929,7 +1010,7 @@ Arguments:
     InputBuffer - Input data buffer
     InputBufferSize - Input data buffer size, not used
     OutputBuffer - Output data buffer
-    OutputBufferSize - Output data buffer size, not used
+    OutputBufferSize - Output data buffer size
     BytesReturned - Amount of data to be sent back
 
 Return Value:
@@ -942,11 +1023,10 @@ Return Value:
     DMF_CONTEXT_LiveKernelDump* moduleContext;
     PLIVEKERNELDUMP_INPUT_BUFFER liveDumpInput;
     DMFMODULE liveKernelDumpModule;
+    LOCK_STATISTICS_CONTEXT lockStatisticsContext;
 
     UNREFERENCED_PARAMETER(Queue);
     UNREFERENCED_PARAMETER(Request);
-    UNREFERENCED_PARAMETER(OutputBuffer);
-    UNREFERENCED_PARAMETER(BytesReturned);
 
     PAGED_CODE();
 
@@ -984,6 +1064,26 @@ Return Value:
                                                                  liveDumpInput->SecondaryDataBuffer);
             break;
         }
+        case IOCTL_LIVEKERNELDUMP_LOCK_STATISTICS_QUERY:
+        {
+            // It is a request to read the lock profiling data of all the Modules in the driver.
+            //
+            DmfAssert(OutputBufferSize >= sizeof(LIVEKERNELDUMP_LOCK_STATISTICS_OUTPUT_BUFFER));
+            lockStatisticsContext.OutputBuffer = (LIVEKERNELDUMP_LOCK_STATISTICS_OUTPUT_BUFFER*)OutputBuffer;
+            lockStatisticsContext.MaximumNumberOfEntries = (ULONG)((OutputBufferSize - FIELD_OFFSET(LIVEKERNELDUMP_LOCK_STATISTICS_OUTPUT_BUFFER, Entries)) /
+                                                                   sizeof(LIVEKERNELDUMP_LOCK_STATISTICS));
+            lockStatisticsContext.OutputBuffer->NumberOfEntriesAvailable = 0;
+            lockStatisticsContext.OutputBuffer->NumberOfEntries = 0;
+            ntStatus = DMF_ModuleLockStatisticsEnumerate(liveKernelDumpModule,
+                                                         LiveKernelDump_LockStatisticsCopy,
+                                                         &lockStatisticsContext);
+            if (NT_SUCCESS(ntStatus))
+            {
+                *BytesReturned = FIELD_OFFSET(LIVEKERNELDUMP_LOCK_STATISTICS_OUTPUT_BUFFER, Entries) +
+                                 (lockStatisticsContext.OutputBuffer->NumberOfEntries * sizeof(LIVEKERNELDUMP_LOCK_STATISTICS));
+            }
+            break;
+        }
         default:
         {
             DmfAssert(FALSE);
@@ -1008,6 +1108,7 @@ Return Value:
 IoctlHandler_IoctlRecord LiveKernelDump_IoctlSpecification[] =
 {
     { IOCTL_LIVEKERNELDUMP_CREATE, sizeof(LIVEKERNELDUMP_INPUT_BUFFER), 0, LiveKernelDump_IoctlHandler, TRUE },
+    { IOCTL_LIVEKERNELDUMP_LOCK_STATISTICS_QUERY, 0, sizeof(LIVEKERNELDUMP_LOCK_STATISTICS_OUTPUT_BUFFER), LiveKernelDump_IoctlHandler, TRUE },
 };
 #endif // IS_WIN10_RS3_OR_LATER
 
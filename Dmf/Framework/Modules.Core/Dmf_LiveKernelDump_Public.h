@@ -71,5 +71,64 @@ typedef struct
 //------------------------------------------------------------------------------------------
 //
 
+//-[Lock Statistics Query]------------------------------------------------------------------
+//
+
+// Maximum size of the Module instance name in LIVEKERNELDUMP_LOCK_STATISTICS.
+//
+#define LIVEKERNELDUMP_LOCK_STATISTICS_NAME_SIZE    32
+
+// Lock profiling data of a single Module lock.
+//
+#pragma pack(push, 1)
+typedef struct
+{
+    // Name of the Module instance that owns the lock.
+    //
+    CHAR ModuleInstanceName[LIVEKERNELDUMP_LOCK_STATISTICS_NAME_SIZE];
+    // Index of the lock. Module lock is at 0. Auxiliary locks start from 1.
+    //
+    ULONG LockIndex;
+    // Number of times the lock is acquired exclusively and shared.
+    //
+    ULONG64 ExclusiveAcquisitions;
+    ULONG64 SharedAcquisitions;
+    // Number of acquisitions that had to wait for another owner.
+    //
+    ULONG64 ContendedAcquisitions;
+    // Time the lock has been held exclusively.
+    //
+    ULONG64 HoldTimeTotalMicroseconds;
+    ULONG64 HoldTimeMaximumMicroseconds;
+    // Longest time any caller waited to acquire the lock.
+    //
+    ULONG64 WaitTimeMaximumMicroseconds;
+} LIVEKERNELDUMP_LOCK_STATISTICS;
+#pragma pack(pop)
+
+#pragma pack(push, 1)
+typedef struct
+{
+    // Number of locks in the driver. If it is larger than NumberOfEntries, send the IOCTL
+    // again with a larger output buffer.
+    //
+    ULONG NumberOfEntriesAvailable;
+    // Number of entries written to Entries.
+    //
+    ULONG NumberOfEntries;
+    // One entry per lock.
+    //
+    LIVEKERNELDUMP_LOCK_STATISTICS Entries[ANYSIZE_ARRAY];
+} LIVEKERNELDUMP_LOCK_STATISTICS_OUTPUT_BUFFER;
+#pragma pack(pop)
+
+// Returns the lock profiling data of all the Modules in the driver.
+// The driver must be built with DMF_LOCK_PROFILING (always the case in DEBUG builds).
+//
+#define IOCTL_LIVEKERNELDUMP_LOCK_STATISTICS_QUERY    CTL_CODE(FILE_DEVICE_UNKNOWN, 4801, METHOD_BUFFERED, FILE_READ_ACCESS)
+
+//------------------------------------------------------------------------------------------
+//
+
 // eof: Dmf_LiveKernelDump_Public.h
 //
@@ -32,6 +32,7 @@ extern "C"
 #include "..\Modules.Library\DmfModules.Library.Public.h"
 
 #include "Dmf_Tests_IoctlHandler_Public.h"
+#include "Dmf_Bench_Containers_Public.h"
 
 // NOTE: The definitions in this file must be surrounded by this annotation to ensure
 //       that both C and C++ Clients can easily compile and link with Modules in this Library.
@@ -56,6 +56,15 @@ extern "C"
 #include "Dmf_Tests_String.h"
 #include "Dmf_Tests_AlertableSleep.h"
 #include "Dmf_Tests_Stack.h"
+#include "Dmf_Tests_ThreadedBufferQueue.h"
+#include "Dmf_Tests_TimerWheel.h"
+#include "Dmf_Tests_RegisterMap.h"
+#include "Dmf_Tests_LatencyHistogram.h"
+
+// Benchmarks.
+//
+
+#include "Dmf_Bench_Containers.h"
 
 // NOTE: The definitions in this file must be surrounded by this annotation to ensure
 //       that both C and C++ Clients can easily compile and link with Modules in this Library.
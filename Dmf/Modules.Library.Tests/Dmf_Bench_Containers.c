@@ -0,0 +1,1331 @@
+/*++
+
+    Copyright (c) Microsoft Corporation. All rights reserved.
+
+Module Name:
+
+    Dmf_Bench_Containers.c
+
+Abstract:
+
+    Performance benchmark for the container and queue Modules (BufferPool, BufferQueue, RingBuffer,
+    HashTable and Stack), for the String list searches (linear and indexed) and for the CRC
+    utilities (CRC-16, CRC-32 and CRC-32C). Unlike the Dmf_Tests_* Modules, which only check correctness, this Module
+    drives a container from a configurable number of threads for a configurable duration and reports
+    the number of operations per second and the latency percentiles of a single operation.
+    NOTE: Runs are started via IOCTL_Bench_Containers_RUN or, optionally, by this Module itself
+          which then traces the results.
+
+Environment:
+
+    Kernel-mode Driver Framework
+    User-mode Driver Framework
+
+--*/
+
+// DMF and this Module's Library specific definitions.
+//
+#include "DmfModule.h"
+#include "DmfModules.Library.Tests.h"
+#include "DmfModules.Library.Tests.Trace.h"
+
+#if defined(DMF_INCLUDE_TMH)
+#include "Dmf_Bench_Containers.tmh"
+#endif
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+// Module Private Enumerations and Structures
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+
+// Default size and number of items placed in the containers.
+//
+#define ITEM_SIZE_DEFAULT                       (64)
+#define ITEM_COUNT_DEFAULT                      (64)
+// Items are copied via a buffer on the stack of each thread.
+//
+#define ITEM_SIZE_MAXIMUM                       (256)
+// Elapsed time is checked once every this many operations so that it
+// does not dominate the cost of the operations.
+//
+#define OPERATIONS_PER_TIME_CHECK               (64)
+// Delay between two sweeps of all the targets when running automatically.
+//
+#define AUTO_RUN_DELAY_MILLISECONDS             (1000)
+
+// Hardware IDs searched by the String targets. This is the kind of list a driver
+// searches to find out which device it is running on.
+//
+static CHAR* Bench_ContainersHardwareIds[] =
+{
+    "ACPI\\VEN_MSHW&DEV_0100",
+    "ACPI\\VEN_MSHW&DEV_0101",
+    "ACPI\\VEN_MSHW&DEV_0102",
+    "ACPI\\VEN_MSHW&DEV_0107",
+    "ACPI\\VEN_MSHW&DEV_0108",
+    "ACPI\\VEN_MSHW&DEV_0115",
+    "ACPI\\VEN_MSHW&DEV_0133",
+    "ACPI\\VEN_MSHW&DEV_0153",
+    "ACPI\\MSHW0100",
+    "ACPI\\MSHW0101",
+    "ACPI\\MSHW0102",
+    "ACPI\\MSHW0107",
+    "HID\\VID_045E&PID_07A9&REV_0100&MI_00",
+    "HID\\VID_045E&PID_07A9&MI_00",
+    "HID\\VID_045E&PID_07A9",
+    "HID\\VID_045E&PID_07DC&MI_01&Col01",
+    "HID\\VID_045E&PID_07DC&MI_01",
+    "HID\\VID_045E&PID_07DC",
+    "HID\\VID_045E&PID_0922&REV_0100&MI_00",
+    "HID\\VID_045E&PID_0922&MI_00",
+    "HID\\VID_045E&PID_0922",
+    "HID\\VID_045E&UP:0001_U:0006",
+    "HID_DEVICE_SYSTEM_KEYBOARD",
+    "HID_DEVICE_UP:0001_U:0006",
+    "USB\\VID_045E&PID_07A5&REV_0100",
+    "USB\\VID_045E&PID_07A5",
+    "USB\\VID_045E&PID_07A9&REV_0100&MI_00",
+    "USB\\VID_045E&PID_07A9&MI_00",
+    "USB\\VID_045E&PID_07DC&REV_0110",
+    "USB\\VID_045E&PID_07DC",
+    "USB\\VID_045E&PID_0922&REV_0100",
+    "USB\\VID_045E&PID_0922",
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+// Module Private Context
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+
+typedef struct _DMF_CONTEXT_Bench_Containers
+{
+    // Containers to drive.
+    //
+    DMFMODULE DmfModuleBufferPool;
+    DMFMODULE DmfModuleBufferQueue;
+    DMFMODULE DmfModuleRingBuffer;
+    DMFMODULE DmfModuleHashTable;
+    DMFMODULE DmfModuleStack;
+    // Searches Bench_ContainersHardwareIds.
+    //
+    DMFMODULE DmfModuleString;
+    // List Index of Bench_ContainersHardwareIds.
+    //
+    WDFMEMORY HardwareIdsListIndex;
+    // Latency of a single operation. There is one probe per target.
+    //
+    DMFMODULE DmfModuleLatencyHistogram;
+    // Measures the duration of a run.
+    //
+    DMFMODULE DmfModuleTime;
+    // Receives IOCTL_Bench_Containers_RUN.
+    //
+    DMFMODULE DmfModuleIoctlHandler;
+    // Threads that drive the containers.
+    //
+    DMFMODULE DmfModuleThreadWorker[Bench_Containers_ThreadCountMaximum];
+    // Thread that starts runs when AutoRunDurationMilliseconds is set.
+    //
+    DMFMODULE DmfModuleThreadAutoRun;
+    // Size and number of the items placed in the containers.
+    //
+    ULONG ItemSize;
+    ULONG ItemCount;
+    // Parameters of the current run.
+    //
+    Bench_Containers_RunInput RunInput;
+    // TRUE while a run is in progress.
+    // NOTE: Protected by the Module lock.
+    //
+    BOOLEAN RunInProgress;
+    // TRUE while the Module is not open (or is closing). No new runs may start.
+    // NOTE: Protected by the Module lock.
+    //
+    BOOLEAN Closing;
+    // Tick when the current run started.
+    //
+    LONGLONG RunStartTick;
+    // Number of workers threads that have not finished the current run.
+    //
+    LONG RunActiveThreads;
+    // Accumulated by the worker threads when they finish the current run.
+    //
+    LONG64 RunOperations;
+    LONG64 RunOperationsFailed;
+    // Results of the last run.
+    //
+    Bench_Containers_RunOutput RunOutput;
+    // Snapshot is large so it is kept here instead of on the stack.
+    //
+    LatencyHistogram_Snapshot RunSnapshot;
+    // Request that started the current run (NULL if started by the AutoRun thread).
+    //
+    WDFREQUEST RunRequest;
+    Bench_Containers_RunOutput* RunRequestOutputBuffer;
+    // Set when a run started by the AutoRun thread completes.
+    //
+    DMF_PORTABLE_EVENT RunCompleteEvent;
+} DMF_CONTEXT_Bench_Containers;
+
+// This macro declares the following function:
+// DMF_CONTEXT_GET()
+//
+DMF_MODULE_DECLARE_CONTEXT(Bench_Containers)
+
+// This macro declares the following function:
+// DMF_CONFIG_GET()
+//
+DMF_MODULE_DECLARE_CONFIG(Bench_Containers)
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+// DMF Module Support Code
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+
+_IRQL_requires_max_(PASSIVE_LEVEL)
+static
+NTSTATUS
+Bench_Containers_OperationExecute(
+    _In_ DMF_CONTEXT_Bench_Containers* ModuleContext,
+    _In_ ULONG Target,
+    _Inout_updates_(ModuleContext->ItemSize) UCHAR* Item,
+    _In_ ULONG Key
+    )
+/*++
+
+Routine Description:
+
+    Perform one complete round trip of an item through the given container.
+
+Arguments:
+
+    ModuleContext - This Module's context.
+    Target - The container to use (Bench_Containers_TargetType).
+    Item - The item to place in the container. It is overwritten with the item removed from the container.
+    Key - Key of the item (HashTable and String only).
+
+Return Value:
+
+    NTSTATUS of the first container Method that fails.
+
+--*/
+{
+    NTSTATUS ntStatus;
+    VOID* clientBuffer;
+    LONG stringIndex;
+    UINT32 crc;
+
+    switch (Target)
+    {
+        case Bench_Containers_Target_BufferPool:
+        {
+            ntStatus = DMF_BufferPool_Get(ModuleContext->DmfModuleBufferPool,
+                                          &clientBuffer,
+                                          NULL);
+            if (!NT_SUCCESS(ntStatus))
+            {
+                break;
+            }
+            RtlCopyMemory(clientBuffer,
+                          Item,
+                          ModuleContext->ItemSize);
+            DMF_BufferPool_Put(ModuleContext->DmfModuleBufferPool,
+                               clientBuffer);
+            break;
+        }
+        case Bench_Containers_Target_BufferQueue:
+        {
+            ntStatus = DMF_BufferQueue_Fetch(ModuleContext->DmfModuleBufferQueue,
+                                             &clientBuffer,
+                                             NULL);
+            if (!NT_SUCCESS(ntStatus))
+            {
+                break;
+            }
+            RtlCopyMemory(clientBuffer,
+                          Item,
+                          ModuleContext->ItemSize);
+            DMF_BufferQueue_Enqueue(ModuleContext->DmfModuleBufferQueue,
+                                    clientBuffer);
+            // NOTE: Another thread may dequeue the buffer enqueued above. That is fine since every
+            //       thread enqueues before it dequeues.
+            //
+            ntStatus = DMF_BufferQueue_Dequeue(ModuleContext->DmfModuleBufferQueue,
+                                               &clientBuffer,
+                                               NULL);
+            if (!NT_SUCCESS(ntStatus))
+            {
+                break;
+            }
+            RtlCopyMemory(Item,
+                          clientBuffer,
+                          ModuleContext->ItemSize);
+            DMF_BufferQueue_Reuse(ModuleContext->DmfModuleBufferQueue,
+                                  clientBuffer);
+            break;
+        }
+        case Bench_Containers_Target_RingBuffer:
+        {
+            ntStatus = DMF_RingBuffer_Write(ModuleContext->DmfModuleRingBuffer,
+                                            Item,
+                                            ModuleContext->ItemSize);
+            if (!NT_SUCCESS(ntStatus))
+            {
+                break;
+            }
+            ntStatus = DMF_RingBuffer_Read(ModuleContext->DmfModuleRingBuffer,
+                                           Item,
+                                           ModuleContext->ItemSize);
+            break;
+        }
+        case Bench_Containers_Target_HashTable:
+        {
+            ntStatus = DMF_HashTable_Write(ModuleContext->DmfModuleHashTable,
+                                           (UCHAR*)&Key,
+                                           sizeof(Key),
+                                           Item,
+                                           ModuleContext->ItemSize);
+            if (!NT_SUCCESS(ntStatus))
+            {
+                break;
+            }
+            ntStatus = DMF_HashTable_Read(ModuleContext->DmfModuleHashTable,
+                                          (UCHAR*)&Key,
+                                          sizeof(Key),
+                                          Item,
+                                          ModuleContext->ItemSize,
+                                          NULL);
+            break;
+        }
+        case Bench_Containers_Target_Stack:
+        {
+            ntStatus = DMF_Stack_Push(ModuleContext->DmfModuleStack,
+                                      Item);
+            if (!NT_SUCCESS(ntStatus))
+            {
+                break;
+            }
+            ntStatus = DMF_Stack_Pop(ModuleContext->DmfModuleStack,
+                                     Item,
+                                     ModuleContext->ItemSize);
+            break;
+        }
+        case Bench_Containers_Target_StringFindInList:
+        {
+            // Every hardware ID in the list is unique so it is found at its own position.
+            //
+            Key %= ARRAYSIZE(Bench_ContainersHardwareIds);
+            stringIndex = DMF_String_FindInListExactChar(ModuleContext->DmfModuleString,
+                                                         Bench_ContainersHardwareIds,
+                                                         ARRAYSIZE(Bench_ContainersHardwareIds),
+                                                         Bench_ContainersHardwareIds[Key]);
+            ntStatus = ((LONG)Key == stringIndex) ? STATUS_SUCCESS : STATUS_NOT_FOUND;
+            break;
+        }
+        case Bench_Containers_Target_StringListIndex:
+        {
+            Key %= ARRAYSIZE(Bench_ContainersHardwareIds);
+            stringIndex = DMF_String_ListIndexFindExactChar(ModuleContext->DmfModuleString,
+                                                            ModuleContext->HardwareIdsListIndex,
+                                                            Bench_ContainersHardwareIds[Key]);
+            ntStatus = ((LONG)Key == stringIndex) ? STATUS_SUCCESS : STATUS_NOT_FOUND;
+            break;
+        }
+        case Bench_Containers_Target_Crc16:
+        case Bench_Containers_Target_Crc32:
+        case Bench_Containers_Target_Crc32c:
+        {
+            if (Bench_Containers_Target_Crc16 == Target)
+            {
+                crc = DMF_Utility_CrcCompute(Item,
+                                             ModuleContext->ItemSize);
+            }
+            else if (Bench_Containers_Target_Crc32 == Target)
+            {
+                crc = DMF_Utility_Crc32Compute(Item,
+                                               ModuleContext->ItemSize);
+            }
+            else
+            {
+                crc = DMF_Utility_Crc32cCompute(Item,
+                                                ModuleContext->ItemSize);
+            }
+            // Store the CRC in the item so that the computation is not optimized away
+            // and the next operation computes the CRC of a different message.
+            //
+            RtlCopyMemory(Item,
+                          &crc,
+                          sizeof(crc));
+            ntStatus = STATUS_SUCCESS;
+            break;
+        }
+        default:
+        {
+            DmfAssert(FALSE);
+            ntStatus = STATUS_INVALID_PARAMETER;
+            break;
+        }
+    }
+
+    return ntStatus;
+}
+
+_IRQL_requires_max_(PASSIVE_LEVEL)
+static
+VOID
+Bench_Containers_RunComplete(
+    _In_ DMFMODULE DmfModule
+    )
+/*++
+
+Routine Description:
+
+    Called by the last worker thread that finishes the current run. Computes the results
+    and returns them to the Client that started the run.
+
+Arguments:
+
+    DmfModule - This Module's handle.
+
+Return Value:
+
+    None
+
+--*/
+{
+    DMF_CONTEXT_Bench_Containers* moduleContext;
+    Bench_Containers_RunOutput* runOutput;
+    LONGLONG elapsedMilliseconds;
+    NTSTATUS ntStatus;
+    WDFREQUEST request;
+    Bench_Containers_RunOutput* requestOutputBuffer;
+
+    moduleContext = DMF_CONTEXT_GET(DmfModule);
+    runOutput = &moduleContext->RunOutput;
+
+    DMF_Time_ElapsedTimeMillisecondsGet(moduleContext->DmfModuleTime,
+                                        moduleContext->RunStartTick,
+                                        &elapsedMilliseconds);
+    // Prevent division by zero.
+    //
+    if (0 == elapsedMilliseconds)
+    {
+        elapsedMilliseconds = 1;
+    }
+
+    RtlZeroMemory(runOutput,
+                  sizeof(Bench_Containers_RunOutput));
+    runOutput->Operations = (ULONG64)moduleContext->RunOperations;
+    runOutput->OperationsFailed = (ULONG64)moduleContext->RunOperationsFailed;
+    runOutput->ElapsedMilliseconds = (ULONG64)elapsedMilliseconds;
+    runOutput->OperationsPerSecond = (runOutput->Operations * 1000) / runOutput->ElapsedMilliseconds;
+
+    ntStatus = DMF_LatencyHistogram_SnapshotGet(moduleContext->DmfModuleLatencyHistogram,
+                                                moduleContext->RunInput.Target,
+                                                &moduleContext->RunSnapshot,
+                                                TRUE);
+    if (NT_SUCCESS(ntStatus))
+    {
+        runOutput->LatencyP50Nanoseconds = DMF_LatencyHistogram_PercentileGet(moduleContext->DmfModuleLatencyHistogram,
+                                                                              &moduleContext->RunSnapshot,
+                                                                              50);
+        runOutput->LatencyP90Nanoseconds = DMF_LatencyHistogram_PercentileGet(moduleContext->DmfModuleLatencyHistogram,
+                                                                              &moduleContext->RunSnapshot,
+                                                                              90);
+        runOutput->LatencyP99Nanoseconds = DMF_LatencyHistogram_PercentileGet(moduleContext->DmfModuleLatencyHistogram,
+                                                                              &moduleContext->RunSnapshot,
+                                                                              99);
+        runOutput->LatencyMaximumNanoseconds = moduleContext->RunSnapshot.MaximumNanoseconds;
+    }
+
+    TraceEvents(TRACE_LEVEL_INFORMATION, DMF_TRACE, "Target=%d ThreadCount=%d Operations=%llu Failed=%llu OperationsPerSecond=%llu P50=%lluns P90=%lluns P99=%lluns Maximum=%lluns",
+                moduleContext->RunInput.Target,
+                moduleContext->RunInput.ThreadCount,
+                runOutput->Operations,
+                runOutput->OperationsFailed,
+                runOutput->OperationsPerSecond,
+                runOutput->LatencyP50Nanoseconds,
+                runOutput->LatencyP90Nanoseconds,
+                runOutput->LatencyP99Nanoseconds,
+                runOutput->LatencyMaximumNanoseconds);
+
+    DMF_ModuleLock(DmfModule);
+    request = moduleContext->RunRequest;
+    requestOutputBuffer = moduleContext->RunRequestOutputBuffer;
+    moduleContext->RunRequest = NULL;
+    moduleContext->RunRequestOutputBuffer = NULL;
+    moduleContext->RunInProgress = FALSE;
+    DMF_ModuleUnlock(DmfModule);
+
+    if (request != NULL)
+    {
+        RtlCopyMemory(requestOutputBuffer,
+                      runOutput,
+                      sizeof(Bench_Containers_RunOutput));
+        WdfRequestCompleteWithInformation(request,
+                                          STATUS_SUCCESS,
+                                          sizeof(Bench_Containers_RunOutput));
+    }
+    else
+    {
+        DMF_Portable_EventSet(&moduleContext->RunCompleteEvent);
+    }
+}
+
+_IRQL_requires_max_(PASSIVE_LEVEL)
+_Must_inspect_result_
+static
+NTSTATUS
+Bench_Containers_RunStart(
+    _In_ DMFMODULE DmfModule,
+    _In_ Bench_Containers_RunInput* RunInput,
+    _In_opt_ WDFREQUEST Request,
+    _In_opt_ Bench_Containers_RunOutput* RequestOutputBuffer
+    )
+/*++
+
+Routine Description:
+
+    Validate the given run parameters and, if they are valid, start a run.
+    The run completes asynchronously.
+
+Arguments:
+
+    DmfModule - This Module's handle.
+    RunInput - Parameters of the run.
+    Request - Request that is completed with the results of the run. If NULL,
+              RunCompleteEvent is set instead.
+    RequestOutputBuffer - Output buffer of Request.
+
+Return Value:
+
+    STATUS_PENDING if the run started.
+    STATUS_INVALID_PARAMETER if the parameters are not valid.
+    STATUS_DEVICE_BUSY if a run is already in progress.
+    STATUS_INVALID_DEVICE_STATE if the Module is closing.
+
+--*/
+{
+    DMF_CONTEXT_Bench_Containers* moduleContext;
+    NTSTATUS ntStatus;
+    ULONG threadIndex;
+
+    moduleContext = DMF_CONTEXT_GET(DmfModule);
+
+    if ((RunInput->Target >= Bench_Containers_Target_Count) ||
+        (0 == RunInput->ThreadCount) ||
+        (RunInput->ThreadCount > Bench_Containers_ThreadCountMaximum) ||
+        (0 == RunInput->DurationMilliseconds) ||
+        (RunInput->DurationMilliseconds > Bench_Containers_DurationMillisecondsMaximum))
+    {
+        TraceEvents(TRACE_LEVEL_ERROR, DMF_TRACE, "Invalid run: Target=%d ThreadCount=%d DurationMilliseconds=%d",
+                    RunInput->Target,
+                    RunInput->ThreadCount,
+                    RunInput->DurationMilliseconds);
+        ntStatus = STATUS_INVALID_PARAMETER;
+        goto Exit;
+    }
+
+    DMF_ModuleLock(DmfModule);
+    if (moduleContext->Closing)
+    {
+        DMF_ModuleUnlock(DmfModule);
+        ntStatus = STATUS_INVALID_DEVICE_STATE;
+        goto Exit;
+    }
+    if (moduleContext->RunInProgress)
+    {
+        DMF_ModuleUnlock(DmfModule);
+        ntStatus = STATUS_DEVICE_BUSY;
+        goto Exit;
+    }
+    moduleContext->RunInProgress = TRUE;
+    moduleContext->RunRequest = Request;
+    moduleContext->RunRequestOutputBuffer = RequestOutputBuffer;
+    DMF_ModuleUnlock(DmfModule);
+
+    // Discard the latencies recorded by previous runs. Since only one run happens at a time
+    // the snapshot in the context is not in use.
+    //
+    ntStatus = DMF_LatencyHistogram_SnapshotGet(moduleContext->DmfModuleLatencyHistogram,
+                                                RunInput->Target,
+                                                &moduleContext->RunSnapshot,
+                                                TRUE);
+    DmfAssert(NT_SUCCESS(ntStatus));
+
+    moduleContext->RunInput = *RunInput;
+    moduleContext->RunOperations = 0;
+    moduleContext->RunOperationsFailed = 0;
+    moduleContext->RunActiveThreads = (LONG)RunInput->ThreadCount;
+    moduleContext->RunStartTick = DMF_Time_TickCountGet(moduleContext->DmfModuleTime);
+
+    for (threadIndex = 0; threadIndex < RunInput->ThreadCount; threadIndex++)
+    {
+        DMF_Thread_WorkReady(moduleContext->DmfModuleThreadWorker[threadIndex]);
+    }
+
+    ntStatus = STATUS_PENDING;
+
+Exit:
+
+    return ntStatus;
+}
+
+#pragma code_seg("PAGE")
+_Function_class_(EVT_DMF_Thread_Function)
+_IRQL_requires_max_(PASSIVE_LEVEL)
+static
+VOID
+Bench_Containers_WorkerThreadWork(
+    _In_ DMFMODULE DmfModuleThread
+    )
+/*++
+
+Routine Description:
+
+    Drive the container of the current run until the duration of the run elapses
+    (or the thread is stopped).
+
+Arguments:
+
+    DmfModuleThread - The worker thread.
+
+Return Value:
+
+    None
+
+--*/
+{
+    DMFMODULE dmfModule;
+    DMF_CONTEXT_Bench_Containers* moduleContext;
+    UCHAR item[ITEM_SIZE_MAXIMUM];
+    ULONG target;
+    LONGLONG operations;
+    LONGLONG operationsFailed;
+    LONGLONG elapsedMilliseconds;
+    LONGLONG startTick;
+    NTSTATUS ntStatus;
+
+    PAGED_CODE();
+
+    dmfModule = DMF_ParentModuleGet(DmfModuleThread);
+    moduleContext = DMF_CONTEXT_GET(dmfModule);
+
+    target = moduleContext->RunInput.Target;
+    operations = 0;
+    operationsFailed = 0;
+    RtlFillMemory(item,
+                  sizeof(item),
+                  (UCHAR)target);
+
+    for (;;)
+    {
+        if (0 == ((operations + operationsFailed) % OPERATIONS_PER_TIME_CHECK))
+        {
+            if (DMF_Thread_IsStopPending(DmfModuleThread))
+            {
+                break;
+            }
+            DMF_Time_ElapsedTimeMillisecondsGet(moduleContext->DmfModuleTime,
+                                                moduleContext->RunStartTick,
+                                                &elapsedMilliseconds);
+            if (elapsedMilliseconds >= (LONGLONG)moduleContext->RunInput.DurationMilliseconds)
+            {
+                break;
+            }
+        }
+
+        startTick = DMF_LatencyHistogram_ProbeBegin(moduleContext->DmfModuleLatencyHistogram);
+        ntStatus = Bench_Containers_OperationExecute(moduleContext,
+                                                     target,
+                                                     item,
+                                                     (ULONG)((operations + operationsFailed) % moduleContext->ItemCount));
+        DMF_LatencyHistogram_ProbeEnd(moduleContext->DmfModuleLatencyHistogram,
+                                      target,
+                                      startTick);
+        if (NT_SUCCESS(ntStatus))
+        {
+            operations++;
+        }
+        else
+        {
+            operationsFailed++;
+        }
+    }
+
+    InterlockedAdd64(&moduleContext->RunOperations,
+                     operations);
+    InterlockedAdd64(&moduleContext->RunOperationsFailed,
+                     operationsFailed);
+
+    // The last thread to finish completes the run.
+    //
+    if (0 == InterlockedDecrement(&moduleContext->RunActiveThreads))
+    {
+        Bench_Containers_RunComplete(dmfModule);
+    }
+}
+#pragma code_seg()
+
+#pragma code_seg("PAGE")
+_Function_class_(EVT_DMF_Thread_Function)
+_IRQL_requires_max_(PASSIVE_LEVEL)
+static
+VOID
+Bench_Containers_AutoRunThreadWork(
+    _In_ DMFMODULE DmfModuleThread
+    )
+/*++
+
+Routine Description:
+
+    Run every target at 1, 2, 4...Bench_Containers_ThreadCountMaximum threads. Results are traced
+    by Bench_Containers_RunComplete().
+
+Arguments:
+
+    DmfModuleThread - The AutoRun thread.
+
+Return Value:
+
+    None
+
+--*/
+{
+    DMFMODULE dmfModule;
+    DMF_CONTEXT_Bench_Containers* moduleContext;
+    DMF_CONFIG_Bench_Containers* moduleConfig;
+    Bench_Containers_RunInput runInput;
+    NTSTATUS ntStatus;
+
+    PAGED_CODE();
+
+    dmfModule = DMF_ParentModuleGet(DmfModuleThread);
+    moduleContext = DMF_CONTEXT_GET(dmfModule);
+    moduleConfig = DMF_CONFIG_GET(dmfModule);
+
+    runInput.DurationMilliseconds = moduleConfig->AutoRunDurationMilliseconds;
+    for (runInput.Target = 0; runInput.Target < Bench_Containers_Target_Count; runInput.Target++)
+    {
+        for (runInput.ThreadCount = 1; runInput.ThreadCount <= Bench_Containers_ThreadCountMaximum; runInput.ThreadCount *= 2)
+        {
+            if (DMF_Thread_IsStopPending(DmfModuleThread))
+            {
+                goto Exit;
+            }
+
+            ntStatus = Bench_Containers_RunStart(dmfModule,
+                                                 &runInput,
+                                                 NULL,
+                                                 NULL);
+            if (ntStatus != STATUS_PENDING)
+            {
+                // A run started via IOCTL is in progress or the Module is closing. Skip this one.
+                //
+                continue;
+            }
+
+            ntStatus = DMF_Portable_EventWaitForSingleObject(&moduleContext->RunCompleteEvent,
+                                                             NULL,
+                                                             FALSE);
+            DmfAssert(NT_SUCCESS(ntStatus));
+        }
+    }
+
+    // Repeat the runs, until stop is signaled.
+    //
+    if (!DMF_Thread_IsStopPending(DmfModuleThread))
+    {
+        DMF_Thread_WorkReady(DmfModuleThread);
+    }
+
+    // Slow down a bit to reduce traffic.
+    //
+    DMF_Utility_DelayMilliseconds(AUTO_RUN_DELAY_MILLISECONDS);
+    TestsUtility_YieldExecution();
+
+Exit:
+    ;
+}
+#pragma code_seg()
+
+_Function_class_(EVT_DMF_IoctlHandler_Callback)
+_Must_inspect_result_
+_IRQL_requires_max_(PASSIVE_LEVEL)
+static
+NTSTATUS
+Bench_Containers_IoctlHandler(
+    _In_ DMFMODULE DmfModule,
+    _In_ WDFQUEUE Queue,
+    _In_ WDFREQUEST Request,
+    _In_ ULONG IoctlCode,
+    _In_reads_(InputBufferSize) VOID* InputBuffer,
+    _In_ size_t InputBufferSize,
+    _Out_writes_(OutputBufferSize) VOID* OutputBuffer,
+    _In_ size_t OutputBufferSize,
+    _Out_ size_t* BytesReturned
+    )
+/*++
+
+Routine Description:
+
+    Start a run. The request is completed with the results when the run completes.
+
+Arguments:
+
+    DmfModule - The Child Module from which this callback is called.
+    Queue - Target queue.
+    Request - Target request.
+    IoctlCode - IOCTL code.
+    InputBuffer - Pointer to input buffer.
+    InputBufferSize - Size of input buffer.
+    OutputBuffer - Pointer to output buffer.
+    OutputBufferSize - Size of output buffer.
+    BytesReturned - Number of bytes returned.
+
+Return Value:
+
+    STATUS_PENDING if the run started. Otherwise the request is completed with the returned NTSTATUS.
+
+--*/
+{
+    DMFMODULE dmfModuleParent;
+    NTSTATUS ntStatus;
+
+    UNREFERENCED_PARAMETER(Queue);
+    UNREFERENCED_PARAMETER(InputBufferSize);
+    UNREFERENCED_PARAMETER(OutputBufferSize);
+
+    dmfModuleParent = DMF_ParentModuleGet(DmfModule);
+    *BytesReturned = 0;
+
+    switch (IoctlCode)
+    {
+        case IOCTL_Bench_Containers_RUN:
+        {
+            // NOTE: Buffer sizes are validated by DMF_IoctlHandler.
+            //
+            ntStatus = Bench_Containers_RunStart(dmfModuleParent,
+                                                 (Bench_Containers_RunInput*)InputBuffer,
+                                                 Request,
+                                                 (Bench_Containers_RunOutput*)OutputBuffer);
+            break;
+        }
+        default:
+        {
+            DmfAssert(FALSE);
+            ntStatus = STATUS_NOT_SUPPORTED;
+            break;
+        }
+    }
+
+    return ntStatus;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+// WDF Module Callbacks
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+// DMF Module Callbacks
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+
+IoctlHandler_IoctlRecord Bench_ContainersIoctlHandlerTable[] =
+{
+    { (LONG)IOCTL_Bench_Containers_RUN, sizeof(Bench_Containers_RunInput), sizeof(Bench_Containers_RunOutput), Bench_Containers_IoctlHandler, FALSE },
+};
+
+#pragma code_seg("PAGE")
+_Function_class_(DMF_Open)
+_IRQL_requires_max_(PASSIVE_LEVEL)
+_Must_inspect_result_
+static
+NTSTATUS
+Bench_Containers_Open(
+    _In_ DMFMODULE DmfModule
+    )
+/*++
+
+Routine Description:
+
+    Initialize an instance of a DMF Module of type Bench_Containers.
+
+Arguments:
+
+    DmfModule - This Module's handle.
+
+Return Value:
+
+    NTSTATUS
+
+--*/
+{
+    DMF_CONTEXT_Bench_Containers* moduleContext;
+    DMF_CONFIG_Bench_Containers* moduleConfig;
+    NTSTATUS ntStatus;
+    ULONG threadIndex;
+    ULONG threadsStarted;
+
+    PAGED_CODE();
+
+    FuncEntry(DMF_TRACE);
+
+    moduleContext = DMF_CONTEXT_GET(DmfModule);
+    moduleConfig = DMF_CONFIG_GET(DmfModule);
+
+    // No run may start until all the threads have started.
+    //
+    moduleContext->Closing = TRUE;
+    threadsStarted = 0;
+    DMF_Portable_EventCreate(&moduleContext->RunCompleteEvent,
+                             SynchronizationEvent,
+                             FALSE);
+
+    ntStatus = DMF_String_ListIndexCreateChar(moduleContext->DmfModuleString,
+                                              Bench_ContainersHardwareIds,
+                                              ARRAYSIZE(Bench_ContainersHardwareIds),
+                                              &moduleContext->HardwareIdsListIndex);
+    if (!NT_SUCCESS(ntStatus))
+    {
+        TraceEvents(TRACE_LEVEL_ERROR, DMF_TRACE, "DMF_String_ListIndexCreateChar fails: ntStatus=%!STATUS!", ntStatus);
+        moduleContext->HardwareIdsListIndex = NULL;
+        goto Exit;
+    }
+
+    for (threadsStarted = 0; threadsStarted < Bench_Containers_ThreadCountMaximum; threadsStarted++)
+    {
+        ntStatus = DMF_Thread_Start(moduleContext->DmfModuleThreadWorker[threadsStarted]);
+        if (!NT_SUCCESS(ntStatus))
+        {
+            TraceEvents(TRACE_LEVEL_ERROR, DMF_TRACE, "DMF_Thread_Start fails: ntStatus=%!STATUS!", ntStatus);
+            goto Exit;
+        }
+    }
+
+    if (moduleContext->DmfModuleThreadAutoRun != NULL)
+    {
+        ntStatus = DMF_Thread_Start(moduleContext->DmfModuleThreadAutoRun);
+        if (!NT_SUCCESS(ntStatus))
+        {
+            TraceEvents(TRACE_LEVEL_ERROR, DMF_TRACE, "DMF_Thread_Start fails: ntStatus=%!STATUS!", ntStatus);
+            goto Exit;
+        }
+    }
+
+    DMF_ModuleLock(DmfModule);
+    moduleContext->Closing = FALSE;
+    DMF_ModuleUnlock(DmfModule);
+
+    if (moduleContext->DmfModuleThreadAutoRun != NULL)
+    {
+        DMF_Thread_WorkReady(moduleContext->DmfModuleThreadAutoRun);
+    }
+
+    ntStatus = STATUS_SUCCESS;
+
+Exit:
+
+    if (!NT_SUCCESS(ntStatus))
+    {
+        // Close is not called when Open fails. Stop the worker threads that started.
+        // No run can be in progress because Closing is still set.
+        //
+        for (threadIndex = 0; threadIndex < threadsStarted; threadIndex++)
+        {
+            DMF_Thread_Stop(moduleContext->DmfModuleThreadWorker[threadIndex]);
+        }
+        if (moduleContext->HardwareIdsListIndex != NULL)
+        {
+            DMF_String_ListIndexDestroy(moduleContext->DmfModuleString,
+                                        moduleContext->HardwareIdsListIndex);
+            moduleContext->HardwareIdsListIndex = NULL;
+        }
+        DMF_Portable_EventClose(&moduleContext->RunCompleteEvent);
+    }
+
+    FuncExit(DMF_TRACE, "ntStatus=%!STATUS!", ntStatus);
+
+    return ntStatus;
+}
+#pragma code_seg()
+
+#pragma code_seg("PAGE")
+_Function_class_(DMF_Close)
+_IRQL_requires_max_(PASSIVE_LEVEL)
+static
+VOID
+Bench_Containers_Close(
+    _In_ DMFMODULE DmfModule
+    )
+/*++
+
+Routine Description:
+
+    Uninitialize an instance of a DMF Module of type Bench_Containers.
+
+Arguments:
+
+    DmfModule - This Module's handle.
+
+Return Value:
+
+    None
+
+--*/
+{
+    DMF_CONTEXT_Bench_Containers* moduleContext;
+    ULONG threadIndex;
+    BOOLEAN runInProgress;
+    WDFREQUEST request;
+
+    PAGED_CODE();
+
+    FuncEntry(DMF_TRACE);
+
+    moduleContext = DMF_CONTEXT_GET(DmfModule);
+
+    // Prevent new runs from starting.
+    //
+    DMF_ModuleLock(DmfModule);
+    moduleContext->Closing = TRUE;
+    DMF_ModuleUnlock(DmfModule);
+
+    // Worker threads stop driving the containers as soon as stop is signaled. A worker
+    // that was signaled but has not woken up yet never runs because stop has priority
+    // over work. In that case the run never completes by itself.
+    //
+    for (threadIndex = 0; threadIndex < Bench_Containers_ThreadCountMaximum; threadIndex++)
+    {
+        DMF_Thread_Stop(moduleContext->DmfModuleThreadWorker[threadIndex]);
+    }
+
+    // Cancel the run that did not complete, if any. No worker thread is running so
+    // there is no race with Bench_Containers_RunComplete().
+    //
+    DMF_ModuleLock(DmfModule);
+    runInProgress = moduleContext->RunInProgress;
+    request = moduleContext->RunRequest;
+    moduleContext->RunRequest = NULL;
+    moduleContext->RunRequestOutputBuffer = NULL;
+    moduleContext->RunInProgress = FALSE;
+    DMF_ModuleUnlock(DmfModule);
+
+    if (request != NULL)
+    {
+        WdfRequestComplete(request,
+                           STATUS_CANCELLED);
+    }
+    else if (runInProgress)
+    {
+        // Release the AutoRun thread.
+        //
+        DMF_Portable_EventSet(&moduleContext->RunCompleteEvent);
+    }
+
+    // The AutoRun thread can no longer start runs so it stops promptly.
+    //
+    if (moduleContext->DmfModuleThreadAutoRun != NULL)
+    {
+        DMF_Thread_Stop(moduleContext->DmfModuleThreadAutoRun);
+    }
+
+    DMF_String_ListIndexDestroy(moduleContext->DmfModuleString,
+                                moduleContext->HardwareIdsListIndex);
+    moduleContext->HardwareIdsListIndex = NULL;
+
+    DMF_Portable_EventClose(&moduleContext->RunCompleteEvent);
+
+    FuncExitVoid(DMF_TRACE);
+}
+#pragma code_seg()
+
+#pragma code_seg("PAGE")
+_Function_class_(DMF_ChildModulesAdd)
+_IRQL_requires_max_(PASSIVE_LEVEL)
+VOID
+DMF_Bench_Containers_ChildModulesAdd(
+    _In_ DMFMODULE DmfModule,
+    _In_ DMF_MODULE_ATTRIBUTES* DmfParentModuleAttributes,
+    _In_ PDMFMODULE_INIT DmfModuleInit
+    )
+/*++
+
+Routine Description:
+
+    Configure and add the required Child Modules to the given Parent Module.
+
+Arguments:
+
+    DmfModule - The given Parent Module.
+    DmfParentModuleAttributes - Pointer to the parent DMF_MODULE_ATTRIBUTES structure.
+    DmfModuleInit - Opaque structure to be passed to DMF_DmfModuleAdd.
+
+Return Value:
+
+    None
+
+--*/
+{
+    DMF_MODULE_ATTRIBUTES moduleAttributes;
+    DMF_CONTEXT_Bench_Containers* moduleContext;
+    DMF_CONFIG_Bench_Containers* moduleConfig;
+    DMF_CONFIG_BufferPool moduleConfigBufferPool;
+    DMF_CONFIG_BufferQueue moduleConfigBufferQueue;
+    DMF_CONFIG_RingBuffer moduleConfigRingBuffer;
+    DMF_CONFIG_HashTable moduleConfigHashTable;
+    DMF_CONFIG_Stack moduleConfigStack;
+    DMF_CONFIG_LatencyHistogram moduleConfigLatencyHistogram;
+    DMF_CONFIG_IoctlHandler moduleConfigIoctlHandler;
+    DMF_CONFIG_Thread moduleConfigThread;
+    ULONG threadIndex;
+
+    UNREFERENCED_PARAMETER(DmfParentModuleAttributes);
+
+    PAGED_CODE();
+
+    FuncEntry(DMF_TRACE);
+
+    moduleContext = DMF_CONTEXT_GET(DmfModule);
+    moduleConfig = DMF_CONFIG_GET(DmfModule);
+
+    moduleContext->ItemSize = moduleConfig->ItemSize;
+    if ((0 == moduleContext->ItemSize) ||
+        (moduleContext->ItemSize > ITEM_SIZE_MAXIMUM))
+    {
+        moduleContext->ItemSize = ITEM_SIZE_DEFAULT;
+    }
+    // Every worker thread holds at most one item at a time.
+    //
+    moduleContext->ItemCount = moduleConfig->ItemCount;
+    if (moduleContext->ItemCount < Bench_Containers_ThreadCountMaximum)
+    {
+        moduleContext->ItemCount = ITEM_COUNT_DEFAULT;
+    }
+
+    // BufferPool
+    // ----------
+    //
+    DMF_CONFIG_BufferPool_AND_ATTRIBUTES_INIT(&moduleConfigBufferPool,
+                                              &moduleAttributes);
+    moduleConfigBufferPool.BufferPoolMode = BufferPool_Mode_Source;
+    moduleConfigBufferPool.Mode.SourceSettings.BufferSize = moduleContext->ItemSize;
+    moduleConfigBufferPool.Mode.SourceSettings.BufferCount = moduleContext->ItemCount;
+    moduleConfigBufferPool.Mode.SourceSettings.EnableLookAside = FALSE;
+    moduleConfigBufferPool.Mode.SourceSettings.CreateWithTimer = FALSE;
+    moduleConfigBufferPool.Mode.SourceSettings.PoolType = NonPagedPoolNx;
+    DMF_DmfModuleAdd(DmfModuleInit,
+                     &moduleAttributes,
+                     WDF_NO_OBJECT_ATTRIBUTES,
+                     &moduleContext->DmfModuleBufferPool);
+
+    // BufferQueue
+    // -----------
+    //
+    DMF_CONFIG_BufferQueue_AND_ATTRIBUTES_INIT(&moduleConfigBufferQueue,
+                                               &moduleAttributes);
+    moduleConfigBufferQueue.SourceSettings.BufferSize = moduleContext->ItemSize;
+    moduleConfigBufferQueue.SourceSettings.BufferCount = moduleContext->ItemCount;
+    moduleConfigBufferQueue.SourceSettings.EnableLookAside = FALSE;
+    moduleConfigBufferQueue.SourceSettings.CreateWithTimer = FALSE;
+    moduleConfigBufferQueue.SourceSettings.PoolType = NonPagedPoolNx;
+    DMF_DmfModuleAdd(DmfModuleInit,
+                     &moduleAttributes,
+                     WDF_NO_OBJECT_ATTRIBUTES,
+                     &moduleContext->DmfModuleBufferQueue);
+
+    // RingBuffer
+    // ----------
+    //
+    DMF_CONFIG_RingBuffer_AND_ATTRIBUTES_INIT(&moduleConfigRingBuffer,
+                                              &moduleAttributes);
+    moduleConfigRingBuffer.ItemSize = moduleContext->ItemSize;
+    moduleConfigRingBuffer.ItemCount = moduleContext->ItemCount;
+    moduleConfigRingBuffer.Mode = RingBuffer_Mode_FailIfFullOnWrite;
+    DMF_DmfModuleAdd(DmfModuleInit,
+                     &moduleAttributes,
+                     WDF_NO_OBJECT_ATTRIBUTES,
+                     &moduleContext->DmfModuleRingBuffer);
+
+    // HashTable
+    // ---------
+    //
+    DMF_CONFIG_HashTable_AND_ATTRIBUTES_INIT(&moduleConfigHashTable,
+                                             &moduleAttributes);
+    moduleConfigHashTable.MaximumKeyLength = sizeof(ULONG);
+    moduleConfigHashTable.MaximumValueLength = moduleContext->ItemSize;
+    moduleConfigHashTable.MaximumTableSize = moduleContext->ItemCount;
+    moduleConfigHashTable.EvtHashTableHashCalculate = NULL;
+    DMF_DmfModuleAdd(DmfModuleInit,
+                     &moduleAttributes,
+                     WDF_NO_OBJECT_ATTRIBUTES,
+                     &moduleContext->DmfModuleHashTable);
+
+    // Stack
+    // -----
+    //
+    DMF_CONFIG_Stack_AND_ATTRIBUTES_INIT(&moduleConfigStack,
+                                         &moduleAttributes);
+    moduleConfigStack.StackDepth = moduleContext->ItemCount;
+    moduleConfigStack.StackElementSize = moduleContext->ItemSize;
+    DMF_DmfModuleAdd(DmfModuleInit,
+                     &moduleAttributes,
+                     WDF_NO_OBJECT_ATTRIBUTES,
+                     &moduleContext->DmfModuleStack);
+
+    // String
+    // ------
+    //
+    DMF_String_ATTRIBUTES_INIT(&moduleAttributes);
+    DMF_DmfModuleAdd(DmfModuleInit,
+                     &moduleAttributes,
+                     WDF_NO_OBJECT_ATTRIBUTES,
+                     &moduleContext->DmfModuleString);
+
+    // LatencyHistogram
+    // ----------------
+    //
+    DMF_CONFIG_LatencyHistogram_AND_ATTRIBUTES_INIT(&moduleConfigLatencyHistogram,
+                                                    &moduleAttributes);
+    moduleConfigLatencyHistogram.NumberOfProbes = Bench_Containers_Target_Count;
+    DMF_DmfModuleAdd(DmfModuleInit,
+                     &moduleAttributes,
+                     WDF_NO_OBJECT_ATTRIBUTES,
+                     &moduleContext->DmfModuleLatencyHistogram);
+
+    // Time
+    // ----
+    //
+    DMF_Time_ATTRIBUTES_INIT(&moduleAttributes);
+    DMF_DmfModuleAdd(DmfModuleInit,
+                     &moduleAttributes,
+                     WDF_NO_OBJECT_ATTRIBUTES,
+                     &moduleContext->DmfModuleTime);
+
+    // IoctlHandler
+    // ------------
+    //
+    DMF_CONFIG_IoctlHandler_AND_ATTRIBUTES_INIT(&moduleConfigIoctlHandler,
+                                                &moduleAttributes);
+    moduleConfigIoctlHandler.IoctlRecords = Bench_ContainersIoctlHandlerTable;
+    moduleConfigIoctlHandler.IoctlRecordCount = _countof(Bench_ContainersIoctlHandlerTable);
+    if (moduleConfig->CreateDeviceInterface)
+    {
+        moduleConfigIoctlHandler.DeviceInterfaceGuid = GUID_DEVINTERFACE_Bench_Containers;
+    }
+    moduleConfigIoctlHandler.AccessModeFilter = IoctlHandler_AccessModeDefault;
+    DMF_DmfModuleAdd(DmfModuleInit,
+                     &moduleAttributes,
+                     WDF_NO_OBJECT_ATTRIBUTES,
+                     &moduleContext->DmfModuleIoctlHandler);
+
+    // Thread (Workers)
+    // ----------------
+    //
+    for (threadIndex = 0; threadIndex < Bench_Containers_ThreadCountMaximum; threadIndex++)
+    {
+        DMF_CONFIG_Thread_AND_ATTRIBUTES_INIT(&moduleConfigThread,
+                                              &moduleAttributes);
+        moduleConfigThread.ThreadControlType = ThreadControlType_DmfControl;
+        moduleConfigThread.ThreadControl.DmfControl.EvtThreadWork = Bench_Containers_WorkerThreadWork;
+        DMF_DmfModuleAdd(DmfModuleInit,
+                         &moduleAttributes,
+                         WDF_NO_OBJECT_ATTRIBUTES,
+                         &moduleContext->DmfModuleThreadWorker[threadIndex]);
+    }
+
+    // Thread (AutoRun)
+    // ----------------
+    //
+    if (moduleConfig->AutoRunDurationMilliseconds > 0)
+    {
+        DMF_CONFIG_Thread_AND_ATTRIBUTES_INIT(&moduleConfigThread,
+                                              &moduleAttributes);
+        moduleConfigThread.ThreadControlType = ThreadControlType_DmfControl;
+        moduleConfigThread.ThreadControl.DmfControl.EvtThreadWork = Bench_Containers_AutoRunThreadWork;
+        DMF_DmfModuleAdd(DmfModuleInit,
+                         &moduleAttributes,
+                         WDF_NO_OBJECT_ATTRIBUTES,
+                         &moduleContext->DmfModuleThreadAutoRun);
+    }
+
+    FuncExitVoid(DMF_TRACE);
+}
+#pragma code_seg()
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+// Public Calls by Client
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+
+#pragma code_seg("PAGE")
+_IRQL_requires_max_(PASSIVE_LEVEL)
+_Must_inspect_result_
+NTSTATUS
+DMF_Bench_Containers_Create(
+    _In_ WDFDEVICE Device,
+    _In_ DMF_MODULE_ATTRIBUTES* DmfModuleAttributes,
+    _In_ WDF_OBJECT_ATTRIBUTES* ObjectAttributes,
+    _Out_ DMFMODULE* DmfModule
+    )
+/*++
+
+Routine Description:
+
+    Create an instance of a DMF Module of type Bench_Containers.
+
+Arguments:
+
+    Device - Client driver's WDFDEVICE object.
+    DmfModuleAttributes - Opaque structure that contains parameters DMF needs to initialize the Module.
+    ObjectAttributes - WDF object attributes for DMFMODULE.
+    DmfModule - Address of the location where the created DMFMODULE handle is returned.
+
+Return Value:
+
+    NTSTATUS
+
+--*/
+{
+    NTSTATUS ntStatus;
+    DMF_MODULE_DESCRIPTOR dmfModuleDescriptor_Bench_Containers;
+    DMF_CALLBACKS_DMF dmfCallbacksDmf_Bench_Containers;
+
+    PAGED_CODE();
+
+    DMF_CALLBACKS_DMF_INIT(&dmfCallbacksDmf_Bench_Containers);
+    dmfCallbacksDmf_Bench_Containers.ChildModulesAdd = DMF_Bench_Containers_ChildModulesAdd;
+    dmfCallbacksDmf_Bench_Containers.DeviceOpen = Bench_Containers_Open;
+    dmfCallbacksDmf_Bench_Containers.DeviceClose = Bench_Containers_Close;
+
+    DMF_MODULE_DESCRIPTOR_INIT_CONTEXT_TYPE(dmfModuleDescriptor_Bench_Containers,
+                                            Bench_Containers,
+                                            DMF_CONTEXT_Bench_Containers,
+                                            DMF_MODULE_OPTIONS_PASSIVE,
+                                            DMF_MODULE_OPEN_OPTION_OPEN_PrepareHardware);
+
+    dmfModuleDescriptor_Bench_Containers.CallbacksDmf = &dmfCallbacksDmf_Bench_Containers;
+
+    ntStatus = DMF_ModuleCreate(Device,
+                                DmfModuleAttributes,
+                                ObjectAttributes,
+                                &dmfModuleDescriptor_Bench_Containers,
+                                DmfModule);
+    if (!NT_SUCCESS(ntStatus))
+    {
+        TraceEvents(TRACE_LEVEL_ERROR, DMF_TRACE, "DMF_ModuleCreate fails: ntStatus=%!STATUS!", ntStatus);
+        goto Exit;
+    }
+
+Exit:
+
+    return(ntStatus);
+}
+#pragma code_seg()
+
+// Module Methods
+//
+
+// eof: Dmf_Bench_Containers.c
+//
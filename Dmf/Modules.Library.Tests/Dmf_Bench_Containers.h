@@ -0,0 +1,54 @@
+/*++
+
+    Copyright (c) Microsoft Corporation. All rights reserved.
+
+Module Name:
+
+    Dmf_Bench_Containers.h
+
+Abstract:
+
+    Companion file to Dmf_Bench_Containers.c.
+
+Environment:
+
+    Kernel-mode Driver Framework
+    User-mode Driver Framework
+
+--*/
+
+#pragma once
+
+typedef struct
+{
+    // TRUE means that a device interface is created so that remote targets
+    // can start runs using IOCTL_Bench_Containers_RUN.
+    //
+    BOOLEAN CreateDeviceInterface;
+    // Size in bytes of each item placed in the containers. The CRC targets compute the CRC
+    // of one item per operation.
+    // Zero selects the default size.
+    //
+    ULONG ItemSize;
+    // Number of items each container can hold.
+    // Zero selects the default count.
+    //
+    ULONG ItemCount;
+    // If not zero, this Module continuously runs every target at 1, 2, 4...Bench_Containers_ThreadCountMaximum
+    // threads for this long each and traces the results.
+    //
+    ULONG AutoRunDurationMilliseconds;
+} DMF_CONFIG_Bench_Containers;
+
+// This macro declares the following functions:
+// DMF_Bench_Containers_ATTRIBUTES_INIT()
+// DMF_CONFIG_Bench_Containers_AND_ATTRIBUTES_INIT()
+// DMF_Bench_Containers_Create()
+//
+DECLARE_DMF_MODULE(Bench_Containers)
+
+// Module Methods
+//
+
+// eof: Dmf_Bench_Containers.h
+//
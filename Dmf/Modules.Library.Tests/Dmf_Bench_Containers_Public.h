@@ -0,0 +1,115 @@
+/*++
+
+    Copyright (c) Microsoft Corporation. All rights reserved.
+
+Module Name:
+
+    Dmf_Bench_Containers_Public.h
+
+Abstract:
+
+    This Module contains the common declarations shared by driver and user applications.
+
+Environment:
+
+    Kernel-mode Driver Framework
+    User-mode Driver Framework
+
+--*/
+
+#pragma once
+
+// {2D5B1E8A-7C43-4F0E-9B61-3A8D2C7E5F14}
+//
+DEFINE_GUID(GUID_DEVINTERFACE_Bench_Containers,
+    0x2d5b1e8a, 0x7c43, 0x4f0e, 0x9b, 0x61, 0x3a, 0x8d, 0x2c, 0x7e, 0x5f, 0x14);
+
+#define IOCTL_Bench_Containers_RUN              CTL_CODE(FILE_DEVICE_UNKNOWN, 4100, METHOD_BUFFERED, FILE_WRITE_ACCESS)
+
+// Maximum number of threads that can drive a container at the same time.
+//
+#define Bench_Containers_ThreadCountMaximum         (8)
+// Maximum duration of a single run.
+//
+#define Bench_Containers_DurationMillisecondsMaximum (60 * 1000)
+
+// The container Module that is driven by a run.
+//
+typedef enum
+{
+    // DMF_BufferPool_Get() followed by DMF_BufferPool_Put().
+    //
+    Bench_Containers_Target_BufferPool = 0,
+    // DMF_BufferQueue_Fetch(), _Enqueue(), _Dequeue() and _Reuse().
+    //
+    Bench_Containers_Target_BufferQueue,
+    // DMF_RingBuffer_Write() followed by DMF_RingBuffer_Read().
+    //
+    Bench_Containers_Target_RingBuffer,
+    // DMF_HashTable_Write() followed by DMF_HashTable_Read().
+    //
+    Bench_Containers_Target_HashTable,
+    // DMF_Stack_Push() followed by DMF_Stack_Pop().
+    //
+    Bench_Containers_Target_Stack,
+    // DMF_String_FindInListExactChar() over a list of hardware IDs (linear search).
+    //
+    Bench_Containers_Target_StringFindInList,
+    // DMF_String_ListIndexFindExactChar() over the same list of hardware IDs (indexed search).
+    //
+    Bench_Containers_Target_StringListIndex,
+    // DMF_Utility_CrcCompute() (CRC-16) over an item.
+    // Throughput in bytes per second is OperationsPerSecond times the item size.
+    //
+    Bench_Containers_Target_Crc16,
+    // DMF_Utility_Crc32Compute() (CRC-32) over an item.
+    //
+    Bench_Containers_Target_Crc32,
+    // DMF_Utility_Crc32cCompute() (CRC-32C) over an item.
+    //
+    Bench_Containers_Target_Crc32c,
+    Bench_Containers_Target_Count
+} Bench_Containers_TargetType;
+
+// IOCTL_Bench_Containers_RUN Parameters.
+//
+#pragma pack(push, 1)
+typedef struct
+{
+    // Container to drive (Bench_Containers_TargetType).
+    //
+    ULONG Target;
+    // Number of threads that drive the container (1...Bench_Containers_ThreadCountMaximum).
+    //
+    ULONG ThreadCount;
+    // How long the threads drive the container (1...Bench_Containers_DurationMillisecondsMaximum).
+    //
+    ULONG DurationMilliseconds;
+} Bench_Containers_RunInput;
+
+typedef struct
+{
+    // Number of operations completed by all the threads.
+    // An operation is one complete round trip through the container (for example, Push and Pop).
+    //
+    ULONG64 Operations;
+    // Number of operations completed that failed (for example, the container was full).
+    //
+    ULONG64 OperationsFailed;
+    // Actual duration of the run.
+    //
+    ULONG64 ElapsedMilliseconds;
+    // Operations per second for all threads combined.
+    //
+    ULONG64 OperationsPerSecond;
+    // Latency of a single operation.
+    //
+    ULONG64 LatencyP50Nanoseconds;
+    ULONG64 LatencyP90Nanoseconds;
+    ULONG64 LatencyP99Nanoseconds;
+    ULONG64 LatencyMaximumNanoseconds;
+} Bench_Containers_RunOutput;
+#pragma pack(pop)
+
+// eof: Dmf_Bench_Containers_Public.h
+//
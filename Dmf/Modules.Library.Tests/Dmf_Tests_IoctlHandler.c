@@ -86,6 +86,19 @@ typedef struct _DMF_CONTEXT_Tests_IoctlHandler
     // Helper for thread work.
     //
     DMFMODULE DmfModuleAlertableSleep;
+    // IoctlHandler with latency histogram enabled. It only handles IOCTL_Tests_IoctlHandler_LATENCY
+    // so that DmfModuleIoctlHandler keeps running with the default settings.
+    //
+    DMFMODULE DmfModuleIoctlHandlerLatency;
+    // Sends IOCTL_Tests_IoctlHandler_LATENCY to this device.
+    //
+    DMFMODULE DmfModuleSelfTarget;
+    // Sends requests and validates the latency histogram.
+    //
+    DMFMODULE DmfModuleThreadLatency;
+    // Latency histogram retrieved from DmfModuleIoctlHandlerLatency.
+    //
+    LatencyHistogram_Snapshot LatencySnapshot;
     // Value get/set via direct call.
     //
     UCHAR InterfaceValue;
@@ -801,6 +814,164 @@ Exit:
 
 #endif // !defined(DISABLE_INTERFACE_THREAD)
 
+// Number of requests sent to the latency histogram instance in each pass.
+//
+#define LATENCY_REQUEST_COUNT   (32)
+
+NTSTATUS
+Tests_IoctlHandler_LatencyCallback(
+    _In_ DMFMODULE DmfModule,
+    _In_ WDFQUEUE Queue,
+    _In_ WDFREQUEST Request,
+    _In_ ULONG IoControlCode,
+    _In_reads_(InputBufferSize) VOID* InputBuffer,
+    _In_ size_t InputBufferSize,
+    _Out_writes_(OutputBufferSize) VOID* OutputBuffer,
+    _In_ size_t OutputBufferSize,
+    _Out_ size_t* BytesReturned
+    )
+/*++
+
+Routine Description:
+
+    Handles IOCTL_Tests_IoctlHandler_LATENCY. The request does nothing. It only
+    exists so that the IoctlHandler instance records its latency.
+
+Arguments:
+
+    DmfModule - IoctlHandler Module handle.
+    Queue - Handle to the framework queue object that is associated with the I/O request.
+    Request - Handle to a framework request object.
+    IoControlCode - The driver-defined or system-defined I/O control code (IOCTL).
+    InputBuffer - Request input buffer.
+    InputBufferSize - Request input buffer size.
+    OutputBuffer - Request output buffer.
+    OutputBufferSize - Request output buffer size.
+    BytesReturned - Number of bytes written to the output buffer.
+
+Return Value:
+
+    STATUS_SUCCESS
+
+--*/
+{
+    UNREFERENCED_PARAMETER(DmfModule);
+    UNREFERENCED_PARAMETER(Queue);
+    UNREFERENCED_PARAMETER(Request);
+    UNREFERENCED_PARAMETER(IoControlCode);
+    UNREFERENCED_PARAMETER(InputBuffer);
+    UNREFERENCED_PARAMETER(InputBufferSize);
+    UNREFERENCED_PARAMETER(OutputBuffer);
+    UNREFERENCED_PARAMETER(OutputBufferSize);
+
+    DmfAssert(IOCTL_Tests_IoctlHandler_LATENCY == IoControlCode);
+
+    *BytesReturned = 0;
+
+    return STATUS_SUCCESS;
+}
+
+#pragma code_seg("PAGE")
+_Function_class_(EVT_DMF_Thread_Function)
+_IRQL_requires_max_(PASSIVE_LEVEL)
+static
+VOID
+Tests_IoctlHandler_LatencyWorkThread(
+    _In_ DMFMODULE DmfModuleThread
+    )
+{
+    DMFMODULE dmfModule;
+    DMF_CONTEXT_Tests_IoctlHandler* moduleContext;
+    NTSTATUS ntStatus;
+    ULONG requestIndex;
+    ULONG64 requestsCompleted;
+    ULONG64 bucketTotal;
+    ULONG bucketIndex;
+    size_t bytesWritten;
+
+    PAGED_CODE();
+
+    dmfModule = DMF_ParentModuleGet(DmfModuleThread);
+    moduleContext = DMF_CONTEXT_GET(dmfModule);
+
+    // The default instance does not keep a histogram.
+    //
+    ntStatus = DMF_IoctlHandler_LatencyHistogramGet(moduleContext->DmfModuleIoctlHandler,
+                                                    0,
+                                                    &moduleContext->LatencySnapshot,
+                                                    FALSE);
+    DmfAssert(STATUS_NOT_SUPPORTED == ntStatus);
+
+    // Start from an empty histogram.
+    //
+    ntStatus = DMF_IoctlHandler_LatencyHistogramGet(moduleContext->DmfModuleIoctlHandlerLatency,
+                                                    0,
+                                                    &moduleContext->LatencySnapshot,
+                                                    TRUE);
+    DmfAssert(NT_SUCCESS(ntStatus));
+
+    requestsCompleted = 0;
+    for (requestIndex = 0; requestIndex < LATENCY_REQUEST_COUNT; requestIndex++)
+    {
+        ntStatus = DMF_SelfTarget_SendSynchronously(moduleContext->DmfModuleSelfTarget,
+                                                    NULL,
+                                                    0,
+                                                    NULL,
+                                                    0,
+                                                    ContinuousRequestTarget_RequestType_Ioctl,
+                                                    IOCTL_Tests_IoctlHandler_LATENCY,
+                                                    0,
+                                                    &bytesWritten);
+        if (! NT_SUCCESS(ntStatus))
+        {
+            // Device is going away.
+            //
+            DmfAssert((ntStatus == STATUS_CANCELLED) || (ntStatus == STATUS_INVALID_DEVICE_STATE));
+            break;
+        }
+        requestsCompleted++;
+    }
+
+    ntStatus = DMF_IoctlHandler_LatencyHistogramGet(moduleContext->DmfModuleIoctlHandlerLatency,
+                                                    0,
+                                                    &moduleContext->LatencySnapshot,
+                                                    FALSE);
+    DmfAssert(NT_SUCCESS(ntStatus));
+
+    // Every completed request has been recorded. Other Clients may send the same IOCTL,
+    // so more may have been recorded.
+    //
+    DmfAssert(moduleContext->LatencySnapshot.Count >= requestsCompleted);
+    bucketTotal = 0;
+    for (bucketIndex = 0; bucketIndex < LatencyHistogram_NumberOfBuckets; bucketIndex++)
+    {
+        bucketTotal += moduleContext->LatencySnapshot.Buckets[bucketIndex];
+    }
+    DmfAssert(bucketTotal == moduleContext->LatencySnapshot.Count);
+    DmfAssert(moduleContext->LatencySnapshot.MaximumNanoseconds <= moduleContext->LatencySnapshot.TotalNanoseconds);
+
+    // There is only one record in the table.
+    //
+    ntStatus = DMF_IoctlHandler_LatencyHistogramGet(moduleContext->DmfModuleIoctlHandlerLatency,
+                                                    1,
+                                                    &moduleContext->LatencySnapshot,
+                                                    FALSE);
+    DmfAssert(STATUS_INVALID_PARAMETER == ntStatus);
+
+    // Repeat the test, until stop is signaled.
+    //
+    if (!DMF_Thread_IsStopPending(DmfModuleThread))
+    {
+        DMF_Thread_WorkReady(DmfModuleThread);
+    }
+
+    // Slow down a bit to reduce traffic.
+    //
+    DMF_Utility_DelayMilliseconds(1000);
+    TestsUtility_YieldExecution();
+}
+#pragma code_seg()
+
 VOID
 Tests_IoctlHandler_InterfaceReference(
     _In_ VOID* InterfaceContext
@@ -1010,6 +1181,11 @@ IoctlHandler_IoctlRecord Tests_IoctlHandlerTable[] =
     { (LONG)IOCTL_Tests_IoctlHandler_ZEROSIZE,      0,                                0,                                Tests_IoctlHandler_Callback, FALSE },
 };
 
+IoctlHandler_IoctlRecord Tests_IoctlHandlerLatencyTable[] =
+{
+    { (LONG)IOCTL_Tests_IoctlHandler_LATENCY,       0,                                0,                                Tests_IoctlHandler_LatencyCallback, FALSE },
+};
+
 #pragma code_seg("PAGE")
 _Function_class_(DMF_ChildModulesAdd)
 _IRQL_requires_max_(PASSIVE_LEVEL)
@@ -1104,6 +1280,31 @@ Return Value:
                      WDF_NO_OBJECT_ATTRIBUTES, 
                      &moduleContext->DmfModuleIoctlHandler);
 
+    // IoctlHandler (Latency Histogram)
+    // --------------------------------
+    // Handles only IOCTL_Tests_IoctlHandler_LATENCY which the instance above does not handle.
+    //
+    DMF_CONFIG_IoctlHandler_AND_ATTRIBUTES_INIT(&moduleConfigIoctlHandler,
+                                                &moduleAttributes);
+    moduleConfigIoctlHandler.IoctlRecords = Tests_IoctlHandlerLatencyTable;
+    moduleConfigIoctlHandler.IoctlRecordCount = _countof(Tests_IoctlHandlerLatencyTable);
+    moduleConfigIoctlHandler.AccessModeFilter = IoctlHandler_AccessModeDefault;
+    moduleConfigIoctlHandler.EnableLatencyHistogram = TRUE;
+    DMF_DmfModuleAdd(DmfModuleInit,
+                     &moduleAttributes,
+                     WDF_NO_OBJECT_ATTRIBUTES,
+                     &moduleContext->DmfModuleIoctlHandlerLatency);
+
+    // SelfTarget
+    // ----------
+    //
+    DMF_SelfTarget_ATTRIBUTES_INIT(&moduleAttributes);
+    moduleAttributes.PassiveLevel = TRUE;
+    DMF_DmfModuleAdd(DmfModuleInit,
+                     &moduleAttributes,
+                     WDF_NO_OBJECT_ATTRIBUTES,
+                     &moduleContext->DmfModuleSelfTarget);
+
     // TODO: Add second instance for Internal IOCTL.
     //
 
@@ -1122,6 +1323,19 @@ Return Value:
                      &moduleContext->DmfModuleThread);
 #endif // !defined(DISABLE_INTERFACE_THREAD)
 
+    // Thread (Latency Histogram)
+    // --------------------------
+    //
+    DMF_CONFIG_Thread moduleConfigThreadLatency;
+    DMF_CONFIG_Thread_AND_ATTRIBUTES_INIT(&moduleConfigThreadLatency,
+                                          &moduleAttributes);
+    moduleConfigThreadLatency.ThreadControlType = ThreadControlType_DmfControl;
+    moduleConfigThreadLatency.ThreadControl.DmfControl.EvtThreadWork = Tests_IoctlHandler_LatencyWorkThread;
+    DMF_DmfModuleAdd(DmfModuleInit,
+                     &moduleAttributes,
+                     WDF_NO_OBJECT_ATTRIBUTES,
+                     &moduleContext->DmfModuleThreadLatency);
+
     // AlertableSleep Manual (Output)
     // ---------------------
     //
@@ -1249,6 +1463,16 @@ Return Value:
     DMF_Thread_WorkReady(moduleContext->DmfModuleThread);
 #endif
 
+    // Start the thread that validates the latency histogram.
+    //
+    ntStatus = DMF_Thread_Start(moduleContext->DmfModuleThreadLatency);
+    if (! NT_SUCCESS(ntStatus))
+    {
+        TraceEvents(TRACE_LEVEL_ERROR, DMF_TRACE, "DMF_Thread_Start fails: ntStatus=%!STATUS!", ntStatus);
+        goto Exit;
+    }
+    DMF_Thread_WorkReady(moduleContext->DmfModuleThreadLatency);
+
 Exit:
 
     FuncExit(DMF_TRACE, "ntStatus=%!STATUS!", ntStatus);
@@ -1296,6 +1520,7 @@ Return Value:
 #if !defined(DISABLE_INTERFACE_THREAD)
     DMF_Thread_Stop(moduleContext->DmfModuleThread);
 #endif
+    DMF_Thread_Stop(moduleContext->DmfModuleThreadLatency);
 
     device = DMF_ParentDeviceGet(DmfModule);
     queue = WdfDeviceGetDefaultQueue(device);
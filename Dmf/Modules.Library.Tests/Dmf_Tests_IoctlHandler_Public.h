@@ -27,6 +27,9 @@ DEFINE_GUID(GUID_DEVINTERFACE_Tests_IoctlHandler,
 #define IOCTL_Tests_IoctlHandler_SLEEP          CTL_CODE(FILE_DEVICE_UNKNOWN, 4000, METHOD_BUFFERED, FILE_WRITE_ACCESS)
 #define IOCTL_Tests_IoctlHandler_ZEROBUFFER     CTL_CODE(FILE_DEVICE_UNKNOWN, 4001, METHOD_BUFFERED, FILE_WRITE_ACCESS)
 #define IOCTL_Tests_IoctlHandler_ZEROSIZE       CTL_CODE(FILE_DEVICE_UNKNOWN, 4002, METHOD_BUFFERED, FILE_WRITE_ACCESS)
+// Sent by Tests_IoctlHandler to itself to exercise the IoctlHandler latency histogram.
+//
+#define IOCTL_Tests_IoctlHandler_LATENCY        CTL_CODE(FILE_DEVICE_UNKNOWN, 4003, METHOD_BUFFERED, FILE_WRITE_ACCESS)
 
 // IOCTL_DATA_SOURCE_CREATE Parameters.
 //
@@ -0,0 +1,581 @@
+/*++
+
+    Copyright (c) Microsoft Corporation. All rights reserved.
+
+Module Name:
+
+    Dmf_Tests_LatencyHistogram.c
+
+Abstract:
+
+    Functional tests for Dmf_LatencyHistogram Module.
+
+Environment:
+
+    Kernel-mode Driver Framework
+    User-mode Driver Framework
+
+--*/
+
+// DMF and this Module's Library specific definitions.
+//
+#include "DmfModule.h"
+#include "DmfModules.Library.Tests.h"
+#include "DmfModules.Library.Tests.Trace.h"
+
+#if defined(DMF_INCLUDE_TMH)
+#include "Dmf_Tests_LatencyHistogram.tmh"
+#endif
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+// Module Private Enumerations and Structures
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+
+// Probe that accumulates all the latencies of a round.
+//
+#define PROBE_ALL                   (0)
+// Probe that holds a single latency at a time.
+//
+#define PROBE_SINGLE                (1)
+// Probe used by ProbeBegin/ProbeEnd.
+//
+#define PROBE_TIMED                 (2)
+#define NUMBER_OF_PROBES            (3)
+// Number of latencies recorded in each round.
+//
+#define NUMBER_OF_LATENCIES         (64)
+// Time measured using ProbeBegin/ProbeEnd.
+//
+#define TIMED_DELAY_MILLISECONDS    (10)
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+// Module Private Context
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+
+typedef struct _DMF_CONTEXT_Tests_LatencyHistogram
+{
+    // LatencyHistogram Module to test.
+    //
+    DMFMODULE DmfModuleLatencyHistogram;
+    // Thread that runs the tests.
+    //
+    DMFMODULE DmfModuleThread;
+    // Snapshots are large so they are kept here instead of on the stack.
+    //
+    LatencyHistogram_Snapshot SnapshotAll;
+    LatencyHistogram_Snapshot SnapshotSingle;
+} DMF_CONTEXT_Tests_LatencyHistogram;
+
+// This macro declares the following function:
+// DMF_CONTEXT_GET()
+//
+DMF_MODULE_DECLARE_CONTEXT(Tests_LatencyHistogram)
+
+// This Module has no Config.
+//
+DMF_MODULE_DECLARE_NO_CONFIG(Tests_LatencyHistogram)
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+// DMF Module Support Code
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+
+#pragma code_seg("PAGE")
+_IRQL_requires_max_(PASSIVE_LEVEL)
+static
+VOID
+Tests_LatencyHistogram_BucketsValidate(
+    _In_ DMFMODULE DmfModule
+    )
+/*++
+
+Routine Description:
+
+    Validates that the buckets cover all latencies without gaps or overlaps.
+
+Arguments:
+
+    DmfModule - This Module's handle.
+
+Return Value:
+
+    None
+
+--*/
+{
+    DMF_CONTEXT_Tests_LatencyHistogram* moduleContext;
+    ULONG bucketIndex;
+    ULONG64 lowestNanoseconds;
+    ULONG64 highestNanoseconds;
+    ULONG64 nextLowestNanoseconds;
+
+    PAGED_CODE();
+
+    moduleContext = DMF_CONTEXT_GET(DmfModule);
+
+    nextLowestNanoseconds = 0;
+    highestNanoseconds = 0;
+    for (bucketIndex = 0; bucketIndex < LatencyHistogram_NumberOfBuckets; bucketIndex++)
+    {
+        DMF_LatencyHistogram_BucketRangeGet(moduleContext->DmfModuleLatencyHistogram,
+                                            bucketIndex,
+                                            &lowestNanoseconds,
+                                            &highestNanoseconds);
+        DmfAssert(lowestNanoseconds == nextLowestNanoseconds);
+        DmfAssert(highestNanoseconds >= lowestNanoseconds);
+        // Width of a bucket is never more than 25% of its lowest latency.
+        //
+        DmfAssert((lowestNanoseconds < 4) ||
+                  (bucketIndex == LatencyHistogram_NumberOfBuckets - 1) ||
+                  ((highestNanoseconds - lowestNanoseconds + 1) <= (lowestNanoseconds / 4)));
+        nextLowestNanoseconds = highestNanoseconds + 1;
+    }
+    DmfAssert(MAXULONG64 == highestNanoseconds);
+}
+#pragma code_seg()
+
+#pragma code_seg("PAGE")
+_IRQL_requires_max_(PASSIVE_LEVEL)
+static
+VOID
+Tests_LatencyHistogram_RoundRun(
+    _In_ DMFMODULE DmfModule
+    )
+/*++
+
+Routine Description:
+
+    Records random latencies and validates the histograms that are returned.
+
+Arguments:
+
+    DmfModule - This Module's handle.
+
+Return Value:
+
+    None
+
+--*/
+{
+    DMF_CONTEXT_Tests_LatencyHistogram* moduleContext;
+    NTSTATUS ntStatus;
+    ULONG latencyIndex;
+    ULONG bucketIndex;
+    ULONG64 latency;
+    ULONG64 expectedTotal;
+    ULONG64 expectedMaximum;
+    ULONG64 bucketsTotal;
+    ULONG64 lowestNanoseconds;
+    ULONG64 highestNanoseconds;
+    ULONG64 percentile;
+    LONGLONG startTick;
+
+    PAGED_CODE();
+
+    moduleContext = DMF_CONTEXT_GET(DmfModule);
+
+    // Start from empty histograms.
+    //
+    ntStatus = DMF_LatencyHistogram_SnapshotGet(moduleContext->DmfModuleLatencyHistogram,
+                                                PROBE_ALL,
+                                                &moduleContext->SnapshotAll,
+                                                TRUE);
+    DmfAssert(NT_SUCCESS(ntStatus));
+    ntStatus = DMF_LatencyHistogram_SnapshotGet(moduleContext->DmfModuleLatencyHistogram,
+                                                PROBE_ALL,
+                                                &moduleContext->SnapshotAll,
+                                                FALSE);
+    DmfAssert(NT_SUCCESS(ntStatus));
+    DmfAssert(0 == moduleContext->SnapshotAll.Count);
+    DmfAssert(0 == DMF_LatencyHistogram_PercentileGet(moduleContext->DmfModuleLatencyHistogram,
+                                                      &moduleContext->SnapshotAll,
+                                                      50));
+
+    expectedTotal = 0;
+    expectedMaximum = 0;
+    for (latencyIndex = 0; latencyIndex < NUMBER_OF_LATENCIES; latencyIndex++)
+    {
+        // Spread the latencies over many powers of two.
+        //
+        latency = ((ULONG64)TestsUtility_GenerateRandomNumber(0,
+                                                              MAXULONG)) >> TestsUtility_GenerateRandomNumber(0,
+                                                                                                              31);
+        latency <<= TestsUtility_GenerateRandomNumber(0,
+                                                      16);
+        expectedTotal += latency;
+        expectedMaximum = max(expectedMaximum,
+                              latency);
+
+        DMF_LatencyHistogram_Record(moduleContext->DmfModuleLatencyHistogram,
+                                    PROBE_ALL,
+                                    latency);
+        DMF_LatencyHistogram_Record(moduleContext->DmfModuleLatencyHistogram,
+                                    PROBE_SINGLE,
+                                    latency);
+
+        // The latency is counted in exactly one bucket whose range contains it.
+        //
+        ntStatus = DMF_LatencyHistogram_SnapshotGet(moduleContext->DmfModuleLatencyHistogram,
+                                                    PROBE_SINGLE,
+                                                    &moduleContext->SnapshotSingle,
+                                                    TRUE);
+        DmfAssert(NT_SUCCESS(ntStatus));
+        DmfAssert(1 == moduleContext->SnapshotSingle.Count);
+        DmfAssert(latency == moduleContext->SnapshotSingle.TotalNanoseconds);
+        DmfAssert(latency == moduleContext->SnapshotSingle.MaximumNanoseconds);
+        bucketsTotal = 0;
+        for (bucketIndex = 0; bucketIndex < LatencyHistogram_NumberOfBuckets; bucketIndex++)
+        {
+            if (moduleContext->SnapshotSingle.Buckets[bucketIndex] != 0)
+            {
+                DMF_LatencyHistogram_BucketRangeGet(moduleContext->DmfModuleLatencyHistogram,
+                                                    bucketIndex,
+                                                    &lowestNanoseconds,
+                                                    &highestNanoseconds);
+                DmfAssert((latency >= lowestNanoseconds) && (latency <= highestNanoseconds));
+                bucketsTotal += moduleContext->SnapshotSingle.Buckets[bucketIndex];
+            }
+        }
+        DmfAssert(1 == bucketsTotal);
+    }
+
+    // All the latencies are accumulated.
+    //
+    ntStatus = DMF_LatencyHistogram_SnapshotGet(moduleContext->DmfModuleLatencyHistogram,
+                                                PROBE_ALL,
+                                                &moduleContext->SnapshotAll,
+                                                FALSE);
+    DmfAssert(NT_SUCCESS(ntStatus));
+    DmfAssert(NUMBER_OF_LATENCIES == moduleContext->SnapshotAll.Count);
+    DmfAssert(expectedTotal == moduleContext->SnapshotAll.TotalNanoseconds);
+    DmfAssert(expectedMaximum == moduleContext->SnapshotAll.MaximumNanoseconds);
+    bucketsTotal = 0;
+    for (bucketIndex = 0; bucketIndex < LatencyHistogram_NumberOfBuckets; bucketIndex++)
+    {
+        bucketsTotal += moduleContext->SnapshotAll.Buckets[bucketIndex];
+    }
+    DmfAssert(NUMBER_OF_LATENCIES == bucketsTotal);
+
+    // Percentiles are ordered and bounded by the maximum.
+    //
+    percentile = DMF_LatencyHistogram_PercentileGet(moduleContext->DmfModuleLatencyHistogram,
+                                                    &moduleContext->SnapshotAll,
+                                                    50);
+    DmfAssert(percentile <= DMF_LatencyHistogram_PercentileGet(moduleContext->DmfModuleLatencyHistogram,
+                                                               &moduleContext->SnapshotAll,
+                                                               99));
+    DmfAssert(expectedMaximum == DMF_LatencyHistogram_PercentileGet(moduleContext->DmfModuleLatencyHistogram,
+                                                                    &moduleContext->SnapshotAll,
+                                                                    100));
+
+    // Reset clears the histogram.
+    //
+    ntStatus = DMF_LatencyHistogram_SnapshotGet(moduleContext->DmfModuleLatencyHistogram,
+                                                PROBE_ALL,
+                                                &moduleContext->SnapshotAll,
+                                                TRUE);
+    DmfAssert(NT_SUCCESS(ntStatus));
+    DmfAssert(NUMBER_OF_LATENCIES == moduleContext->SnapshotAll.Count);
+    ntStatus = DMF_LatencyHistogram_SnapshotGet(moduleContext->DmfModuleLatencyHistogram,
+                                                PROBE_ALL,
+                                                &moduleContext->SnapshotAll,
+                                                FALSE);
+    DmfAssert(NT_SUCCESS(ntStatus));
+    DmfAssert(0 == moduleContext->SnapshotAll.Count);
+    DmfAssert(0 == moduleContext->SnapshotAll.MaximumNanoseconds);
+
+    // Probes measure elapsed time.
+    //
+    DMF_LATENCYHISTOGRAM_PROBE_BEGIN(moduleContext->DmfModuleLatencyHistogram,
+                                     startTick);
+    DMF_Utility_DelayMilliseconds(TIMED_DELAY_MILLISECONDS);
+    DMF_LATENCYHISTOGRAM_PROBE_END(moduleContext->DmfModuleLatencyHistogram,
+                                   PROBE_TIMED,
+                                   startTick);
+    ntStatus = DMF_LatencyHistogram_SnapshotGet(moduleContext->DmfModuleLatencyHistogram,
+                                                PROBE_TIMED,
+                                                &moduleContext->SnapshotSingle,
+                                                TRUE);
+    DmfAssert(NT_SUCCESS(ntStatus));
+    DmfAssert(1 == moduleContext->SnapshotSingle.Count);
+    DmfAssert(moduleContext->SnapshotSingle.MaximumNanoseconds >= (ULONG64)TIMED_DELAY_MILLISECONDS * 1000 * 1000);
+
+    // Invalid probe Ids are rejected.
+    //
+    ntStatus = DMF_LatencyHistogram_SnapshotGet(moduleContext->DmfModuleLatencyHistogram,
+                                                NUMBER_OF_PROBES,
+                                                &moduleContext->SnapshotSingle,
+                                                FALSE);
+    DmfAssert(STATUS_INVALID_PARAMETER == ntStatus);
+}
+#pragma code_seg()
+
+#pragma code_seg("PAGE")
+_Function_class_(EVT_DMF_Thread_Function)
+_IRQL_requires_max_(PASSIVE_LEVEL)
+static
+VOID
+Tests_LatencyHistogram_WorkThread(
+    _In_ DMFMODULE DmfModuleThread
+    )
+{
+    DMFMODULE dmfModule;
+
+    PAGED_CODE();
+
+    dmfModule = DMF_ParentModuleGet(DmfModuleThread);
+
+    Tests_LatencyHistogram_BucketsValidate(dmfModule);
+    Tests_LatencyHistogram_RoundRun(dmfModule);
+
+    // Repeat the test, until stop is signaled.
+    //
+    if (!DMF_Thread_IsStopPending(DmfModuleThread))
+    {
+        DMF_Thread_WorkReady(DmfModuleThread);
+    }
+
+    // Slow down a bit to reduce traffic.
+    //
+    DMF_Utility_DelayMilliseconds(1000);
+    TestsUtility_YieldExecution();
+}
+#pragma code_seg()
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+// WDF Module Callbacks
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+// DMF Module Callbacks
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+
+#pragma code_seg("PAGE")
+_Function_class_(DMF_Open)
+_IRQL_requires_max_(PASSIVE_LEVEL)
+_Must_inspect_result_
+static
+NTSTATUS
+Tests_LatencyHistogram_Open(
+    _In_ DMFMODULE DmfModule
+    )
+/*++
+
+Routine Description:
+
+    Initialize an instance of a DMF Module of type Tests_LatencyHistogram.
+
+Arguments:
+
+    DmfModule - This Module's handle.
+
+Return Value:
+
+    NTSTATUS
+
+--*/
+{
+    DMF_CONTEXT_Tests_LatencyHistogram* moduleContext;
+    NTSTATUS ntStatus;
+
+    PAGED_CODE();
+
+    FuncEntry(DMF_TRACE);
+
+    moduleContext = DMF_CONTEXT_GET(DmfModule);
+
+    ntStatus = DMF_Thread_Start(moduleContext->DmfModuleThread);
+    if (!NT_SUCCESS(ntStatus))
+    {
+        TraceEvents(TRACE_LEVEL_ERROR, DMF_TRACE, "DMF_Thread_Start fails: ntStatus=%!STATUS!", ntStatus);
+        goto Exit;
+    }
+
+    DMF_Thread_WorkReady(moduleContext->DmfModuleThread);
+
+Exit:
+
+    FuncExit(DMF_TRACE, "ntStatus=%!STATUS!", ntStatus);
+
+    return ntStatus;
+}
+#pragma code_seg()
+
+#pragma code_seg("PAGE")
+_Function_class_(DMF_Close)
+_IRQL_requires_max_(PASSIVE_LEVEL)
+static
+VOID
+Tests_LatencyHistogram_Close(
+    _In_ DMFMODULE DmfModule
+    )
+/*++
+
+Routine Description:
+
+    Uninitialize an instance of a DMF Module of type Tests_LatencyHistogram.
+
+Arguments:
+
+    DmfModule - This Module's handle.
+
+Return Value:
+
+    None
+
+--*/
+{
+    DMF_CONTEXT_Tests_LatencyHistogram* moduleContext;
+
+    PAGED_CODE();
+
+    FuncEntry(DMF_TRACE);
+
+    moduleContext = DMF_CONTEXT_GET(DmfModule);
+
+    DMF_Thread_Stop(moduleContext->DmfModuleThread);
+
+    FuncExitVoid(DMF_TRACE);
+}
+#pragma code_seg()
+
+#pragma code_seg("PAGE")
+_Function_class_(DMF_ChildModulesAdd)
+_IRQL_requires_max_(PASSIVE_LEVEL)
+VOID
+DMF_Tests_LatencyHistogram_ChildModulesAdd(
+    _In_ DMFMODULE DmfModule,
+    _In_ DMF_MODULE_ATTRIBUTES* DmfParentModuleAttributes,
+    _In_ PDMFMODULE_INIT DmfModuleInit
+    )
+/*++
+
+Routine Description:
+
+    Configure and add the required Child Modules to the given Parent Module.
+
+Arguments:
+
+    DmfModule - The given Parent Module.
+    DmfParentModuleAttributes - Pointer to the parent DMF_MODULE_ATTRIBUTES structure.
+    DmfModuleInit - Opaque structure to be passed to DMF_DmfModuleAdd.
+
+Return Value:
+
+    None
+
+--*/
+{
+    DMF_MODULE_ATTRIBUTES moduleAttributes;
+    DMF_CONTEXT_Tests_LatencyHistogram* moduleContext;
+    DMF_CONFIG_LatencyHistogram moduleConfigLatencyHistogram;
+    DMF_CONFIG_Thread moduleConfigThread;
+
+    UNREFERENCED_PARAMETER(DmfParentModuleAttributes);
+
+    PAGED_CODE();
+
+    FuncEntry(DMF_TRACE);
+
+    moduleContext = DMF_CONTEXT_GET(DmfModule);
+
+    // LatencyHistogram
+    // ----------------
+    //
+    DMF_CONFIG_LatencyHistogram_AND_ATTRIBUTES_INIT(&moduleConfigLatencyHistogram,
+                                                    &moduleAttributes);
+    moduleConfigLatencyHistogram.NumberOfProbes = NUMBER_OF_PROBES;
+    DMF_DmfModuleAdd(DmfModuleInit,
+                     &moduleAttributes,
+                     WDF_NO_OBJECT_ATTRIBUTES,
+                     &moduleContext->DmfModuleLatencyHistogram);
+
+    // Thread
+    // ------
+    //
+    DMF_CONFIG_Thread_AND_ATTRIBUTES_INIT(&moduleConfigThread,
+                                          &moduleAttributes);
+    moduleConfigThread.ThreadControlType = ThreadControlType_DmfControl;
+    moduleConfigThread.ThreadControl.DmfControl.EvtThreadWork = Tests_LatencyHistogram_WorkThread;
+    DMF_DmfModuleAdd(DmfModuleInit,
+                     &moduleAttributes,
+                     WDF_NO_OBJECT_ATTRIBUTES,
+                     &moduleContext->DmfModuleThread);
+
+    FuncExitVoid(DMF_TRACE);
+}
+#pragma code_seg()
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+// Public Calls by Client
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+
+#pragma code_seg("PAGE")
+_IRQL_requires_max_(PASSIVE_LEVEL)
+_Must_inspect_result_
+NTSTATUS
+DMF_Tests_LatencyHistogram_Create(
+    _In_ WDFDEVICE Device,
+    _In_ DMF_MODULE_ATTRIBUTES* DmfModuleAttributes,
+    _In_ WDF_OBJECT_ATTRIBUTES* ObjectAttributes,
+    _Out_ DMFMODULE* DmfModule
+    )
+/*++
+
+Routine Description:
+
+    Create an instance of a DMF Module of type Tests_LatencyHistogram.
+
+Arguments:
+
+    Device - Client driver's WDFDEVICE object.
+    DmfModuleAttributes - Opaque structure that contains parameters DMF needs to initialize the Module.
+    ObjectAttributes - WDF object attributes for DMFMODULE.
+    DmfModule - Address of the location where the created DMFMODULE handle is returned.
+
+Return Value:
+
+    NTSTATUS
+
+--*/
+{
+    NTSTATUS ntStatus;
+    DMF_MODULE_DESCRIPTOR dmfModuleDescriptor_Tests_LatencyHistogram;
+    DMF_CALLBACKS_DMF dmfCallbacksDmf_Tests_LatencyHistogram;
+
+    PAGED_CODE();
+
+    DMF_CALLBACKS_DMF_INIT(&dmfCallbacksDmf_Tests_LatencyHistogram);
+    dmfCallbacksDmf_Tests_LatencyHistogram.ChildModulesAdd = DMF_Tests_LatencyHistogram_ChildModulesAdd;
+    dmfCallbacksDmf_Tests_LatencyHistogram.DeviceOpen = Tests_LatencyHistogram_Open;
+    dmfCallbacksDmf_Tests_LatencyHistogram.DeviceClose = Tests_LatencyHistogram_Close;
+
+    DMF_MODULE_DESCRIPTOR_INIT_CONTEXT_TYPE(dmfModuleDescriptor_Tests_LatencyHistogram,
+                                            Tests_LatencyHistogram,
+                                            DMF_CONTEXT_Tests_LatencyHistogram,
+                                            DMF_MODULE_OPTIONS_PASSIVE,
+                                            DMF_MODULE_OPEN_OPTION_OPEN_Create);
+
+    dmfModuleDescriptor_Tests_LatencyHistogram.CallbacksDmf = &dmfCallbacksDmf_Tests_LatencyHistogram;
+
+    ntStatus = DMF_ModuleCreate(Device,
+                                DmfModuleAttributes,
+                                ObjectAttributes,
+                                &dmfModuleDescriptor_Tests_LatencyHistogram,
+                                DmfModule);
+    if (!NT_SUCCESS(ntStatus))
+    {
+        TraceEvents(TRACE_LEVEL_ERROR, DMF_TRACE, "DMF_ModuleCreate fails: ntStatus=%!STATUS!", ntStatus);
+    }
+
+    return(ntStatus);
+}
+#pragma code_seg()
+
+// eof: Dmf_Tests_LatencyHistogram.c
+//
@@ -0,0 +1,32 @@
+/*++
+
+    Copyright (c) Microsoft Corporation. All rights reserved.
+
+Module Name:
+
+    Dmf_Tests_LatencyHistogram.h
+
+Abstract:
+
+    Companion file to Dmf_Tests_LatencyHistogram.c.
+
+Environment:
+
+    Kernel-mode Driver Framework
+    User-mode Driver Framework
+
+--*/
+
+#pragma once
+
+// This macro declares the following functions:
+// DMF_Tests_LatencyHistogram_ATTRIBUTES_INIT()
+// DMF_Tests_LatencyHistogram_Create()
+//
+DECLARE_DMF_MODULE_NO_CONFIG(Tests_LatencyHistogram)
+
+// Module Methods
+//
+
+// eof: Dmf_Tests_LatencyHistogram.h
+//
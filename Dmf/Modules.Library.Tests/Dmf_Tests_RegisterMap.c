@@ -0,0 +1,617 @@
+/*++
+
+    Copyright (c) Microsoft Corporation. All rights reserved.
+
+Module Name:
+
+    Dmf_Tests_RegisterMap.c
+
+Abstract:
+
+    Functional tests for Dmf_RegisterMap Module. The device is simulated in memory so that
+    every bus access made by the Module can be counted and checked.
+
+Environment:
+
+    Kernel-mode Driver Framework
+    User-mode Driver Framework
+
+--*/
+
+// DMF and this Module's Library specific definitions.
+//
+#include "DmfModule.h"
+#include "DmfModules.Library.Tests.h"
+#include "DmfModules.Library.Tests.Trace.h"
+
+#if defined(DMF_INCLUDE_TMH)
+#include "Dmf_Tests_RegisterMap.tmh"
+#endif
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+// Module Private Enumerations and Structures
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+
+// Number of registers in the simulated device.
+//
+#define NUMBER_OF_REGISTERS         (32)
+// Registers from this one onwards are volatile. The simulated device changes
+// their value every time they are read.
+//
+#define FIRST_VOLATILE_REGISTER     (24)
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+// Module Private Context
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+
+typedef struct _DMF_CONTEXT_Tests_RegisterMap
+{
+    // RegisterMap Module to test.
+    //
+    DMFMODULE DmfModuleRegisterMap;
+    // Thread that runs the tests.
+    //
+    DMFMODULE DmfModuleThread;
+    // Passed to RegisterMap in its Config.
+    //
+    BOOLEAN CacheableRegisters[NUMBER_OF_REGISTERS];
+    // Simulated device.
+    //
+    UCHAR DeviceRegisters[NUMBER_OF_REGISTERS];
+    // Number of registers read and write transfers seen by the simulated device.
+    //
+    ULONG BusRegistersRead;
+    ULONG BusWrites;
+} DMF_CONTEXT_Tests_RegisterMap;
+
+// This macro declares the following function:
+// DMF_CONTEXT_GET()
+//
+DMF_MODULE_DECLARE_CONTEXT(Tests_RegisterMap)
+
+// This Module has no Config.
+//
+DMF_MODULE_DECLARE_NO_CONFIG(Tests_RegisterMap)
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+// DMF Module Support Code
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+
+#pragma code_seg("PAGE")
+_Function_class_(EVT_DMF_RegisterMap_BusRead)
+_IRQL_requires_max_(PASSIVE_LEVEL)
+_IRQL_requires_same_
+_Must_inspect_result_
+static
+NTSTATUS
+Tests_RegisterMap_BusRead(
+    _In_ DMFMODULE DmfModule,
+    _In_ ULONG FirstRegister,
+    _Out_writes_(NumberOfRegisters) UCHAR* Buffer,
+    _In_ ULONG NumberOfRegisters
+    )
+{
+    DMF_CONTEXT_Tests_RegisterMap* moduleContext;
+    ULONG registerIndex;
+
+    PAGED_CODE();
+
+    moduleContext = DMF_CONTEXT_GET(DMF_ParentModuleGet(DmfModule));
+
+    DmfAssert(FirstRegister + NumberOfRegisters <= NUMBER_OF_REGISTERS);
+
+    for (registerIndex = 0; registerIndex < NumberOfRegisters; registerIndex++)
+    {
+        Buffer[registerIndex] = moduleContext->DeviceRegisters[FirstRegister + registerIndex];
+        // Volatile registers change by themselves.
+        //
+        if (FirstRegister + registerIndex >= FIRST_VOLATILE_REGISTER)
+        {
+            moduleContext->DeviceRegisters[FirstRegister + registerIndex]++;
+        }
+    }
+    moduleContext->BusRegistersRead += NumberOfRegisters;
+
+    return STATUS_SUCCESS;
+}
+#pragma code_seg()
+
+#pragma code_seg("PAGE")
+_Function_class_(EVT_DMF_RegisterMap_BusWrite)
+_IRQL_requires_max_(PASSIVE_LEVEL)
+_IRQL_requires_same_
+_Must_inspect_result_
+static
+NTSTATUS
+Tests_RegisterMap_BusWrite(
+    _In_ DMFMODULE DmfModule,
+    _In_ ULONG FirstRegister,
+    _In_reads_(NumberOfRegisters) UCHAR* Buffer,
+    _In_ ULONG NumberOfRegisters
+    )
+{
+    DMF_CONTEXT_Tests_RegisterMap* moduleContext;
+
+    PAGED_CODE();
+
+    moduleContext = DMF_CONTEXT_GET(DMF_ParentModuleGet(DmfModule));
+
+    DmfAssert(NumberOfRegisters > 0);
+    DmfAssert(FirstRegister + NumberOfRegisters <= NUMBER_OF_REGISTERS);
+
+    RtlCopyMemory(&moduleContext->DeviceRegisters[FirstRegister],
+                  Buffer,
+                  NumberOfRegisters);
+    moduleContext->BusWrites++;
+
+    return STATUS_SUCCESS;
+}
+#pragma code_seg()
+
+#pragma code_seg("PAGE")
+_IRQL_requires_max_(PASSIVE_LEVEL)
+static
+VOID
+Tests_RegisterMap_RoundRun(
+    _In_ DMFMODULE DmfModule
+    )
+/*++
+
+Routine Description:
+
+    Validates caching of reads, deferral and coalescing of writes and pass through of
+    volatile registers against the simulated device.
+
+Arguments:
+
+    DmfModule - This Module's handle.
+
+Return Value:
+
+    None
+
+--*/
+{
+    DMF_CONTEXT_Tests_RegisterMap* moduleContext;
+    NTSTATUS ntStatus;
+    ULONG registerIndex;
+    ULONG firstRange;
+    ULONG secondRange;
+    ULONG rangeLength;
+    UCHAR value;
+    UCHAR expectedValue;
+    UCHAR expectedRegisters[NUMBER_OF_REGISTERS];
+
+    PAGED_CODE();
+
+    moduleContext = DMF_CONTEXT_GET(DmfModule);
+
+    // Start from a freshly reset device.
+    //
+    DMF_RegisterMap_Invalidate(moduleContext->DmfModuleRegisterMap);
+    for (registerIndex = 0; registerIndex < NUMBER_OF_REGISTERS; registerIndex++)
+    {
+        moduleContext->DeviceRegisters[registerIndex] = (UCHAR)TestsUtility_GenerateRandomNumber(0,
+                                                                                                   0xFF);
+    }
+    moduleContext->BusRegistersRead = 0;
+    moduleContext->BusWrites = 0;
+
+    // Cacheable registers are read from the device only once.
+    //
+    for (registerIndex = 0; registerIndex < FIRST_VOLATILE_REGISTER; registerIndex++)
+    {
+        ntStatus = DMF_RegisterMap_Read(moduleContext->DmfModuleRegisterMap,
+                                        registerIndex,
+                                        &value);
+        DmfAssert(NT_SUCCESS(ntStatus));
+        DmfAssert(value == moduleContext->DeviceRegisters[registerIndex]);
+        ntStatus = DMF_RegisterMap_Read(moduleContext->DmfModuleRegisterMap,
+                                        registerIndex,
+                                        &value);
+        DmfAssert(NT_SUCCESS(ntStatus));
+        DmfAssert(value == moduleContext->DeviceRegisters[registerIndex]);
+    }
+    DmfAssert(FIRST_VOLATILE_REGISTER == moduleContext->BusRegistersRead);
+
+    // Volatile registers are read from the device every time.
+    //
+    moduleContext->BusRegistersRead = 0;
+    for (registerIndex = FIRST_VOLATILE_REGISTER; registerIndex < NUMBER_OF_REGISTERS; registerIndex++)
+    {
+        expectedValue = moduleContext->DeviceRegisters[registerIndex];
+        ntStatus = DMF_RegisterMap_Read(moduleContext->DmfModuleRegisterMap,
+                                        registerIndex,
+                                        &value);
+        DmfAssert(NT_SUCCESS(ntStatus));
+        DmfAssert(value == expectedValue);
+        ntStatus = DMF_RegisterMap_Read(moduleContext->DmfModuleRegisterMap,
+                                        registerIndex,
+                                        &value);
+        DmfAssert(NT_SUCCESS(ntStatus));
+        DmfAssert(value == (UCHAR)(expectedValue + 1));
+    }
+    DmfAssert(2 * (NUMBER_OF_REGISTERS - FIRST_VOLATILE_REGISTER) == moduleContext->BusRegistersRead);
+
+    // Write two separate ranges of cacheable registers. Nothing is written to the device until sync.
+    //
+    RtlCopyMemory(expectedRegisters,
+                  moduleContext->DeviceRegisters,
+                  sizeof(expectedRegisters));
+    rangeLength = TestsUtility_GenerateRandomNumber(1,
+                                                    FIRST_VOLATILE_REGISTER / 4);
+    firstRange = TestsUtility_GenerateRandomNumber(0,
+                                                   (FIRST_VOLATILE_REGISTER / 2) - rangeLength - 1);
+    secondRange = TestsUtility_GenerateRandomNumber(FIRST_VOLATILE_REGISTER / 2,
+                                                    FIRST_VOLATILE_REGISTER - rangeLength);
+    for (registerIndex = 0; registerIndex < rangeLength; registerIndex++)
+    {
+        // Write in reverse order to check that ranges do not depend on the order of writes.
+        //
+        expectedRegisters[secondRange + rangeLength - 1 - registerIndex] = (UCHAR)~expectedRegisters[secondRange + rangeLength - 1 - registerIndex];
+        ntStatus = DMF_RegisterMap_Write(moduleContext->DmfModuleRegisterMap,
+                                         secondRange + rangeLength - 1 - registerIndex,
+                                         expectedRegisters[secondRange + rangeLength - 1 - registerIndex]);
+        DmfAssert(NT_SUCCESS(ntStatus));
+        expectedRegisters[firstRange + registerIndex] = (UCHAR)~expectedRegisters[firstRange + registerIndex];
+        ntStatus = DMF_RegisterMap_Write(moduleContext->DmfModuleRegisterMap,
+                                         firstRange + registerIndex,
+                                         expectedRegisters[firstRange + registerIndex]);
+        DmfAssert(NT_SUCCESS(ntStatus));
+    }
+
+    // Read-modify-write of a cacheable register does not access the bus.
+    //
+    expectedRegisters[firstRange] = (expectedRegisters[firstRange] & 0xF0) | 0x05;
+    ntStatus = DMF_RegisterMap_Update(moduleContext->DmfModuleRegisterMap,
+                                      firstRange,
+                                      0x0F,
+                                      0x05);
+    DmfAssert(NT_SUCCESS(ntStatus));
+    DmfAssert(0 == moduleContext->BusWrites);
+    DmfAssert(2 * (NUMBER_OF_REGISTERS - FIRST_VOLATILE_REGISTER) == moduleContext->BusRegistersRead);
+
+    // Reads return the values written even though the device does not have them yet.
+    //
+    ntStatus = DMF_RegisterMap_Read(moduleContext->DmfModuleRegisterMap,
+                                    firstRange,
+                                    &value);
+    DmfAssert(NT_SUCCESS(ntStatus));
+    DmfAssert(value == expectedRegisters[firstRange]);
+
+    // Each range is written using a single transfer.
+    //
+    ntStatus = DMF_RegisterMap_Sync(moduleContext->DmfModuleRegisterMap);
+    DmfAssert(NT_SUCCESS(ntStatus));
+    DmfAssert(2 == moduleContext->BusWrites);
+    DmfAssert(RtlEqualMemory(expectedRegisters,
+                             moduleContext->DeviceRegisters,
+                             FIRST_VOLATILE_REGISTER));
+
+    // Nothing is dirty anymore.
+    //
+    ntStatus = DMF_RegisterMap_Sync(moduleContext->DmfModuleRegisterMap);
+    DmfAssert(NT_SUCCESS(ntStatus));
+    DmfAssert(2 == moduleContext->BusWrites);
+
+    // Writing the value a cacheable register already has does nothing.
+    //
+    ntStatus = DMF_RegisterMap_Write(moduleContext->DmfModuleRegisterMap,
+                                     secondRange,
+                                     expectedRegisters[secondRange]);
+    DmfAssert(NT_SUCCESS(ntStatus));
+    ntStatus = DMF_RegisterMap_Sync(moduleContext->DmfModuleRegisterMap);
+    DmfAssert(NT_SUCCESS(ntStatus));
+    DmfAssert(2 == moduleContext->BusWrites);
+
+    // Volatile registers are written immediately.
+    //
+    ntStatus = DMF_RegisterMap_Write(moduleContext->DmfModuleRegisterMap,
+                                     FIRST_VOLATILE_REGISTER,
+                                     0x5A);
+    DmfAssert(NT_SUCCESS(ntStatus));
+    DmfAssert(3 == moduleContext->BusWrites);
+    DmfAssert(0x5A == moduleContext->DeviceRegisters[FIRST_VOLATILE_REGISTER]);
+
+    // After invalidation, cacheable registers are read from the device again.
+    //
+    DMF_RegisterMap_Invalidate(moduleContext->DmfModuleRegisterMap);
+    moduleContext->BusRegistersRead = 0;
+    ntStatus = DMF_RegisterMap_Read(moduleContext->DmfModuleRegisterMap,
+                                    secondRange,
+                                    &value);
+    DmfAssert(NT_SUCCESS(ntStatus));
+    DmfAssert(value == expectedRegisters[secondRange]);
+    DmfAssert(1 == moduleContext->BusRegistersRead);
+}
+#pragma code_seg()
+
+#pragma code_seg("PAGE")
+_Function_class_(EVT_DMF_Thread_Function)
+_IRQL_requires_max_(PASSIVE_LEVEL)
+static
+VOID
+Tests_RegisterMap_WorkThread(
+    _In_ DMFMODULE DmfModuleThread
+    )
+{
+    DMFMODULE dmfModule;
+    RegisterMap_Statistics statistics;
+
+    PAGED_CODE();
+
+    dmfModule = DMF_ParentModuleGet(DmfModuleThread);
+
+    Tests_RegisterMap_RoundRun(dmfModule);
+
+    DMF_RegisterMap_StatisticsGet(DMF_CONTEXT_GET(dmfModule)->DmfModuleRegisterMap,
+                                  &statistics);
+    TraceEvents(TRACE_LEVEL_INFORMATION,
+                DMF_TRACE,
+                "RegisterMap CacheHits=%I64u BusReads=%I64u BusWrites=%I64u WritesDeferred=%I64u",
+                statistics.CacheHits,
+                statistics.BusReads,
+                statistics.BusWrites,
+                statistics.WritesDeferred);
+
+    // Repeat the test, until stop is signaled.
+    //
+    if (!DMF_Thread_IsStopPending(DmfModuleThread))
+    {
+        DMF_Thread_WorkReady(DmfModuleThread);
+    }
+
+    // Slow down a bit to reduce traffic.
+    //
+    DMF_Utility_DelayMilliseconds(1000);
+    TestsUtility_YieldExecution();
+}
+#pragma code_seg()
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+// WDF Module Callbacks
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+// DMF Module Callbacks
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+
+#pragma code_seg("PAGE")
+_Function_class_(DMF_Open)
+_IRQL_requires_max_(PASSIVE_LEVEL)
+_Must_inspect_result_
+static
+NTSTATUS
+Tests_RegisterMap_Open(
+    _In_ DMFMODULE DmfModule
+    )
+/*++
+
+Routine Description:
+
+    Initialize an instance of a DMF Module of type Tests_RegisterMap.
+
+Arguments:
+
+    DmfModule - This Module's handle.
+
+Return Value:
+
+    NTSTATUS
+
+--*/
+{
+    DMF_CONTEXT_Tests_RegisterMap* moduleContext;
+    NTSTATUS ntStatus;
+
+    PAGED_CODE();
+
+    FuncEntry(DMF_TRACE);
+
+    moduleContext = DMF_CONTEXT_GET(DmfModule);
+
+    ntStatus = DMF_Thread_Start(moduleContext->DmfModuleThread);
+    if (!NT_SUCCESS(ntStatus))
+    {
+        TraceEvents(TRACE_LEVEL_ERROR, DMF_TRACE, "DMF_Thread_Start fails: ntStatus=%!STATUS!", ntStatus);
+        goto Exit;
+    }
+
+    DMF_Thread_WorkReady(moduleContext->DmfModuleThread);
+
+Exit:
+
+    FuncExit(DMF_TRACE, "ntStatus=%!STATUS!", ntStatus);
+
+    return ntStatus;
+}
+#pragma code_seg()
+
+#pragma code_seg("PAGE")
+_Function_class_(DMF_Close)
+_IRQL_requires_max_(PASSIVE_LEVEL)
+static
+VOID
+Tests_RegisterMap_Close(
+    _In_ DMFMODULE DmfModule
+    )
+/*++
+
+Routine Description:
+
+    Uninitialize an instance of a DMF Module of type Tests_RegisterMap.
+
+Arguments:
+
+    DmfModule - This Module's handle.
+
+Return Value:
+
+    None
+
+--*/
+{
+    DMF_CONTEXT_Tests_RegisterMap* moduleContext;
+
+    PAGED_CODE();
+
+    FuncEntry(DMF_TRACE);
+
+    moduleContext = DMF_CONTEXT_GET(DmfModule);
+
+    DMF_Thread_Stop(moduleContext->DmfModuleThread);
+
+    FuncExitVoid(DMF_TRACE);
+}
+#pragma code_seg()
+
+#pragma code_seg("PAGE")
+_Function_class_(DMF_ChildModulesAdd)
+_IRQL_requires_max_(PASSIVE_LEVEL)
+VOID
+DMF_Tests_RegisterMap_ChildModulesAdd(
+    _In_ DMFMODULE DmfModule,
+    _In_ DMF_MODULE_ATTRIBUTES* DmfParentModuleAttributes,
+    _In_ PDMFMODULE_INIT DmfModuleInit
+    )
+/*++
+
+Routine Description:
+
+    Configure and add the required Child Modules to the given Parent Module.
+
+Arguments:
+
+    DmfModule - The given Parent Module.
+    DmfParentModuleAttributes - Pointer to the parent DMF_MODULE_ATTRIBUTES structure.
+    DmfModuleInit - Opaque structure to be passed to DMF_DmfModuleAdd.
+
+Return Value:
+
+    None
+
+--*/
+{
+    DMF_MODULE_ATTRIBUTES moduleAttributes;
+    DMF_CONTEXT_Tests_RegisterMap* moduleContext;
+    DMF_CONFIG_RegisterMap moduleConfigRegisterMap;
+    DMF_CONFIG_Thread moduleConfigThread;
+    ULONG registerIndex;
+
+    UNREFERENCED_PARAMETER(DmfParentModuleAttributes);
+
+    PAGED_CODE();
+
+    FuncEntry(DMF_TRACE);
+
+    moduleContext = DMF_CONTEXT_GET(DmfModule);
+
+    for (registerIndex = 0; registerIndex < NUMBER_OF_REGISTERS; registerIndex++)
+    {
+        moduleContext->CacheableRegisters[registerIndex] = (registerIndex < FIRST_VOLATILE_REGISTER);
+    }
+
+    // RegisterMap
+    // -----------
+    //
+    DMF_CONFIG_RegisterMap_AND_ATTRIBUTES_INIT(&moduleConfigRegisterMap,
+                                               &moduleAttributes);
+    moduleConfigRegisterMap.NumberOfRegisters = NUMBER_OF_REGISTERS;
+    moduleConfigRegisterMap.CacheableRegisters = moduleContext->CacheableRegisters;
+    moduleConfigRegisterMap.EvtRegisterMapBusRead = Tests_RegisterMap_BusRead;
+    moduleConfigRegisterMap.EvtRegisterMapBusWrite = Tests_RegisterMap_BusWrite;
+    DMF_DmfModuleAdd(DmfModuleInit,
+                     &moduleAttributes,
+                     WDF_NO_OBJECT_ATTRIBUTES,
+                     &moduleContext->DmfModuleRegisterMap);
+
+    // Thread
+    // ------
+    //
+    DMF_CONFIG_Thread_AND_ATTRIBUTES_INIT(&moduleConfigThread,
+                                          &moduleAttributes);
+    moduleConfigThread.ThreadControlType = ThreadControlType_DmfControl;
+    moduleConfigThread.ThreadControl.DmfControl.EvtThreadWork = Tests_RegisterMap_WorkThread;
+    DMF_DmfModuleAdd(DmfModuleInit,
+                     &moduleAttributes,
+                     WDF_NO_OBJECT_ATTRIBUTES,
+                     &moduleContext->DmfModuleThread);
+
+    FuncExitVoid(DMF_TRACE);
+}
+#pragma code_seg()
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+// Public Calls by Client
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+
+#pragma code_seg("PAGE")
+_IRQL_requires_max_(PASSIVE_LEVEL)
+_Must_inspect_result_
+NTSTATUS
+DMF_Tests_RegisterMap_Create(
+    _In_ WDFDEVICE Device,
+    _In_ DMF_MODULE_ATTRIBUTES* DmfModuleAttributes,
+    _In_ WDF_OBJECT_ATTRIBUTES* ObjectAttributes,
+    _Out_ DMFMODULE* DmfModule
+    )
+/*++
+
+Routine Description:
+
+    Create an instance of a DMF Module of type Tests_RegisterMap.
+
+Arguments:
+
+    Device - Client driver's WDFDEVICE object.
+    DmfModuleAttributes - Opaque structure that contains parameters DMF needs to initialize the Module.
+    ObjectAttributes - WDF object attributes for DMFMODULE.
+    DmfModule - Address of the location where the created DMFMODULE handle is returned.
+
+Return Value:
+
+    NTSTATUS
+
+--*/
+{
+    NTSTATUS ntStatus;
+    DMF_MODULE_DESCRIPTOR dmfModuleDescriptor_Tests_RegisterMap;
+    DMF_CALLBACKS_DMF dmfCallbacksDmf_Tests_RegisterMap;
+
+    PAGED_CODE();
+
+    DMF_CALLBACKS_DMF_INIT(&dmfCallbacksDmf_Tests_RegisterMap);
+    dmfCallbacksDmf_Tests_RegisterMap.ChildModulesAdd = DMF_Tests_RegisterMap_ChildModulesAdd;
+    dmfCallbacksDmf_Tests_RegisterMap.DeviceOpen = Tests_RegisterMap_Open;
+    dmfCallbacksDmf_Tests_RegisterMap.DeviceClose = Tests_RegisterMap_Close;
+
+    DMF_MODULE_DESCRIPTOR_INIT_CONTEXT_TYPE(dmfModuleDescriptor_Tests_RegisterMap,
+                                            Tests_RegisterMap,
+                                            DMF_CONTEXT_Tests_RegisterMap,
+                                            DMF_MODULE_OPTIONS_PASSIVE,
+                                            DMF_MODULE_OPEN_OPTION_OPEN_Create);
+
+    dmfModuleDescriptor_Tests_RegisterMap.CallbacksDmf = &dmfCallbacksDmf_Tests_RegisterMap;
+
+    ntStatus = DMF_ModuleCreate(Device,
+                                DmfModuleAttributes,
+                                ObjectAttributes,
+                                &dmfModuleDescriptor_Tests_RegisterMap,
+                                DmfModule);
+    if (!NT_SUCCESS(ntStatus))
+    {
+        TraceEvents(TRACE_LEVEL_ERROR, DMF_TRACE, "DMF_ModuleCreate fails: ntStatus=%!STATUS!", ntStatus);
+    }
+
+    return(ntStatus);
+}
+#pragma code_seg()
+
+// eof: Dmf_Tests_RegisterMap.c
+//
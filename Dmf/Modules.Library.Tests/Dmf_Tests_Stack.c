@@ -48,6 +48,19 @@ Environment:
 // Number of working threads
 //
 #define THREAD_COUNT                (1)
+// Depth of the stacks in the Array modes.
+//
+#define ARRAY_STACK_DEPTH           (8)
+// Number of threads that push and pop concurrently in Stack_Mode_ArrayLockFree.
+//
+#define LOCK_FREE_THREAD_COUNT      (4)
+// Number of push/pop pairs each of those threads executes per iteration.
+//
+#define LOCK_FREE_OPERATION_COUNT   (1000)
+// Upper bits of every element pushed by those threads.
+//
+#define LOCK_FREE_ELEMENT_SIGNATURE (0x5A5A0000)
+#define LOCK_FREE_ELEMENT_MASK      (0xFFFF0000)
 
 #define CLIENT_CONTEXT_SIGNATURE    'GISB'
 
@@ -73,9 +86,19 @@ typedef struct _DMF_CONTEXT_Tests_Stack
     // Stack Module to test
     //
     DMFMODULE DmfModuleStack;
+    // Stack Modules to test in the Array modes.
+    //
+    DMFMODULE DmfModuleStackArray;
+    DMFMODULE DmfModuleStackArrayLockFree;
+    // Stack Module used concurrently by several threads in Stack_Mode_ArrayLockFree.
+    //
+    DMFMODULE DmfModuleStackLockFreeConcurrent;
     // Work threads
     //
     DMFMODULE DmfModuleThread[THREAD_COUNT];
+    // Threads that use DmfModuleStackLockFreeConcurrent.
+    //
+    DMFMODULE DmfModuleThreadLockFree[LOCK_FREE_THREAD_COUNT];
     // Stack buffer size
     //
     ULONG StackBufferSize;
@@ -419,6 +442,114 @@ Tests_Stack_ThreadAction_Flush(
 }
 #pragma code_seg()
 
+#pragma code_seg("PAGE")
+static
+void
+Tests_Stack_ArrayModeValidate(
+    _In_ DMFMODULE DmfModuleStack
+    )
+{
+    NTSTATUS ntStatus;
+    ULONG element;
+    ULONG elementIndex;
+    ULONG elements[ARRAY_STACK_DEPTH];
+    ULONG numberOfElements;
+
+    PAGED_CODE();
+
+    DMF_Stack_Flush(DmfModuleStack);
+    DmfAssert(0 == DMF_Stack_Depth(DmfModuleStack));
+
+    // Pop from an empty stack fails.
+    //
+    ntStatus = DMF_Stack_Pop(DmfModuleStack,
+                             &element,
+                             sizeof(element));
+    DmfAssert(!NT_SUCCESS(ntStatus));
+
+    // Fill the stack.
+    //
+    for (elementIndex = 0; elementIndex < ARRAY_STACK_DEPTH; elementIndex++)
+    {
+        element = elementIndex;
+        ntStatus = DMF_Stack_Push(DmfModuleStack,
+                                  &element);
+        DmfAssert(NT_SUCCESS(ntStatus));
+    }
+    DmfAssert(ARRAY_STACK_DEPTH == DMF_Stack_Depth(DmfModuleStack));
+
+    // Push to a full stack fails.
+    //
+    ntStatus = DMF_Stack_Push(DmfModuleStack,
+                              &element);
+    DmfAssert(STATUS_BUFFER_OVERFLOW == ntStatus);
+
+    // Pop half the elements in LIFO order.
+    //
+    for (elementIndex = ARRAY_STACK_DEPTH; elementIndex > ARRAY_STACK_DEPTH / 2; elementIndex--)
+    {
+        ntStatus = DMF_Stack_Pop(DmfModuleStack,
+                                 &element,
+                                 sizeof(element));
+        DmfAssert(NT_SUCCESS(ntStatus));
+        DmfAssert(element == elementIndex - 1);
+    }
+    DmfAssert(ARRAY_STACK_DEPTH / 2 == DMF_Stack_Depth(DmfModuleStack));
+
+    // PopAll requires a buffer that can hold StackDepth elements.
+    //
+    ntStatus = DMF_Stack_PopAll(DmfModuleStack,
+                                elements,
+                                sizeof(ULONG),
+                                &numberOfElements);
+    DmfAssert(STATUS_BUFFER_TOO_SMALL == ntStatus);
+    DmfAssert(0 == numberOfElements);
+
+    // Pop the rest of the elements at once, top of the stack first.
+    //
+    ntStatus = DMF_Stack_PopAll(DmfModuleStack,
+                                elements,
+                                sizeof(elements),
+                                &numberOfElements);
+    DmfAssert(NT_SUCCESS(ntStatus));
+    DmfAssert(ARRAY_STACK_DEPTH / 2 == numberOfElements);
+    for (elementIndex = 0; elementIndex < numberOfElements; elementIndex++)
+    {
+        DmfAssert(elements[elementIndex] == numberOfElements - 1 - elementIndex);
+    }
+    DmfAssert(0 == DMF_Stack_Depth(DmfModuleStack));
+
+    // All the elements are available again.
+    //
+    for (elementIndex = 0; elementIndex < ARRAY_STACK_DEPTH; elementIndex++)
+    {
+        ntStatus = DMF_Stack_Push(DmfModuleStack,
+                                  &elementIndex);
+        DmfAssert(NT_SUCCESS(ntStatus));
+    }
+    DMF_Stack_Flush(DmfModuleStack);
+    DmfAssert(0 == DMF_Stack_Depth(DmfModuleStack));
+}
+#pragma code_seg()
+
+#pragma code_seg("PAGE")
+static
+void
+Tests_Stack_ThreadAction_ArrayModes(
+    _In_ DMFMODULE DmfModule
+    )
+{
+    DMF_CONTEXT_Tests_Stack* moduleContext;
+
+    PAGED_CODE();
+
+    moduleContext = DMF_CONTEXT_GET(DmfModule);
+
+    Tests_Stack_ArrayModeValidate(moduleContext->DmfModuleStackArray);
+    Tests_Stack_ArrayModeValidate(moduleContext->DmfModuleStackArrayLockFree);
+}
+#pragma code_seg()
+
 // Test actions executed by work threads.
 //
 static
@@ -429,7 +560,8 @@ TestActionArray[] =
     Tests_Stack_ThreadAction_Push_NoLimit,
     Tests_Stack_ThreadAction_Pop,
     Tests_Stack_ThreadAction_Depth,
-    Tests_Stack_ThreadAction_Flush
+    Tests_Stack_ThreadAction_Flush,
+    Tests_Stack_ThreadAction_ArrayModes
 };
 
 #pragma code_seg("PAGE")
@@ -475,6 +607,67 @@ Tests_Stack_WorkThread(
 }
 #pragma code_seg()
 
+#pragma code_seg("PAGE")
+_Function_class_(EVT_DMF_Thread_Function)
+_IRQL_requires_max_(PASSIVE_LEVEL)
+static
+VOID
+Tests_Stack_LockFreeWorkThread(
+    _In_ DMFMODULE DmfModuleThread
+    )
+{
+    DMFMODULE dmfModule;
+    DMF_CONTEXT_Tests_Stack* moduleContext;
+    NTSTATUS ntStatus;
+    ULONG operationIndex;
+    ULONG element;
+    ULONG currentDepth;
+
+    PAGED_CODE();
+
+    dmfModule = DMF_ParentModuleGet(DmfModuleThread);
+    moduleContext = DMF_CONTEXT_GET(dmfModule);
+
+    // All the threads push and pop the same stack at the same time. Every element
+    // popped must be one that was pushed and the depth must always be in bounds.
+    //
+    for (operationIndex = 0; operationIndex < LOCK_FREE_OPERATION_COUNT; operationIndex++)
+    {
+        element = LOCK_FREE_ELEMENT_SIGNATURE | (operationIndex & ~LOCK_FREE_ELEMENT_MASK);
+        ntStatus = DMF_Stack_Push(moduleContext->DmfModuleStackLockFreeConcurrent,
+                                  &element);
+        DmfAssert(NT_SUCCESS(ntStatus) || (STATUS_BUFFER_OVERFLOW == ntStatus));
+
+        currentDepth = DMF_Stack_Depth(moduleContext->DmfModuleStackLockFreeConcurrent);
+        DmfAssert(currentDepth <= ARRAY_STACK_DEPTH);
+
+        element = 0;
+        ntStatus = DMF_Stack_Pop(moduleContext->DmfModuleStackLockFreeConcurrent,
+                                 &element,
+                                 sizeof(element));
+        if (NT_SUCCESS(ntStatus))
+        {
+            DmfAssert(LOCK_FREE_ELEMENT_SIGNATURE == (element & LOCK_FREE_ELEMENT_MASK));
+        }
+
+        currentDepth = DMF_Stack_Depth(moduleContext->DmfModuleStackLockFreeConcurrent);
+        DmfAssert(currentDepth <= ARRAY_STACK_DEPTH);
+    }
+
+    // Repeat the test, until stop is signaled.
+    //
+    if (!DMF_Thread_IsStopPending(DmfModuleThread))
+    {
+        DMF_Thread_WorkReady(DmfModuleThread);
+    }
+
+    // Slow down a bit to reduce traffic.
+    //
+    DMF_Utility_DelayMilliseconds(100);
+    TestsUtility_YieldExecution();
+}
+#pragma code_seg()
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////////
 // WDF Module Callbacks
 ///////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -536,11 +729,26 @@ Return Value:
         }
     }
 
+    for (index = 0; index < LOCK_FREE_THREAD_COUNT; index++)
+    {
+        ntStatus = DMF_Thread_Start(moduleContext->DmfModuleThreadLockFree[index]);
+        if (!NT_SUCCESS(ntStatus))
+        {
+            TraceEvents(TRACE_LEVEL_ERROR, DMF_TRACE, "DMF_Thread_Start fails: ntStatus=%!STATUS!", ntStatus);
+            goto Exit;
+        }
+    }
+
     for (index = 0; index < THREAD_COUNT; index++)
     {
         DMF_Thread_WorkReady(moduleContext->DmfModuleThread[index]);
     }
 
+    for (index = 0; index < LOCK_FREE_THREAD_COUNT; index++)
+    {
+        DMF_Thread_WorkReady(moduleContext->DmfModuleThreadLockFree[index]);
+    }
+
 Exit:
 
     FuncExit(DMF_TRACE, "ntStatus=%!STATUS!", ntStatus);
@@ -587,6 +795,11 @@ Return Value:
         DMF_Thread_Stop(moduleContext->DmfModuleThread[index]);
     }
 
+    for (index = 0; index < LOCK_FREE_THREAD_COUNT; index++)
+    {
+        DMF_Thread_Stop(moduleContext->DmfModuleThreadLockFree[index]);
+    }
+
     FuncExitVoid(DMF_TRACE);
 }
 #pragma code_seg()
@@ -645,6 +858,45 @@ Return Value:
                      WDF_NO_OBJECT_ATTRIBUTES,
                      &moduleContext->DmfModuleStack);
 
+    // Stack (Array)
+    // -------------
+    //
+    DMF_CONFIG_Stack_AND_ATTRIBUTES_INIT(&moduleConfigStack,
+                                         &moduleAttributes);
+    moduleConfigStack.StackElementSize = sizeof(ULONG);
+    moduleConfigStack.StackDepth = ARRAY_STACK_DEPTH;
+    moduleConfigStack.Mode = Stack_Mode_Array;
+    DMF_DmfModuleAdd(DmfModuleInit,
+                     &moduleAttributes,
+                     WDF_NO_OBJECT_ATTRIBUTES,
+                     &moduleContext->DmfModuleStackArray);
+
+    // Stack (ArrayLockFree)
+    // ---------------------
+    //
+    DMF_CONFIG_Stack_AND_ATTRIBUTES_INIT(&moduleConfigStack,
+                                         &moduleAttributes);
+    moduleConfigStack.StackElementSize = sizeof(ULONG);
+    moduleConfigStack.StackDepth = ARRAY_STACK_DEPTH;
+    moduleConfigStack.Mode = Stack_Mode_ArrayLockFree;
+    DMF_DmfModuleAdd(DmfModuleInit,
+                     &moduleAttributes,
+                     WDF_NO_OBJECT_ATTRIBUTES,
+                     &moduleContext->DmfModuleStackArrayLockFree);
+
+    // Stack (ArrayLockFree, concurrent)
+    // ---------------------------------
+    //
+    DMF_CONFIG_Stack_AND_ATTRIBUTES_INIT(&moduleConfigStack,
+                                         &moduleAttributes);
+    moduleConfigStack.StackElementSize = sizeof(ULONG);
+    moduleConfigStack.StackDepth = ARRAY_STACK_DEPTH;
+    moduleConfigStack.Mode = Stack_Mode_ArrayLockFree;
+    DMF_DmfModuleAdd(DmfModuleInit,
+                     &moduleAttributes,
+                     WDF_NO_OBJECT_ATTRIBUTES,
+                     &moduleContext->DmfModuleStackLockFreeConcurrent);
+
     // Thread
     // ------
     //
@@ -660,6 +912,21 @@ Return Value:
                          &moduleContext->DmfModuleThread[threadIndex]);
     }
 
+    // Thread (ArrayLockFree, concurrent)
+    // ----------------------------------
+    //
+    for (ULONG threadIndex = 0; threadIndex < LOCK_FREE_THREAD_COUNT; threadIndex++)
+    {
+        DMF_CONFIG_Thread_AND_ATTRIBUTES_INIT(&moduleConfigThread,
+                                              &moduleAttributes);
+        moduleConfigThread.ThreadControlType = ThreadControlType_DmfControl;
+        moduleConfigThread.ThreadControl.DmfControl.EvtThreadWork = Tests_Stack_LockFreeWorkThread;
+        DMF_DmfModuleAdd(DmfModuleInit,
+                         &moduleAttributes,
+                         WDF_NO_OBJECT_ATTRIBUTES,
+                         &moduleContext->DmfModuleThreadLockFree[threadIndex]);
+    }
+
     FuncExitVoid(DMF_TRACE);
 }
 #pragma code_seg()
@@ -646,6 +646,211 @@ Return Value:
 }
 #pragma code_seg()
 
+#pragma code_seg("PAGE")
+static
+VOID
+Tests_String_ListIndexLookups(
+    _In_ DMFMODULE DmfModule
+    )
+/*++
+
+Routine Description:
+
+    Performs unit tests on the List Index Methods. Every search using a List Index must
+    return the same result as the corresponding linear search Method.
+
+Arguments:
+
+    DmfModule - This Module's handle.
+
+Return Value:
+
+    None
+
+--*/
+{
+    NTSTATUS ntStatus;
+    LONG result;
+    LONG expectedResult;
+    WDFMEMORY listIndex;
+
+    PAGED_CODE();
+
+    FuncEntry(DMF_TRACE);
+
+    DMFMODULE_VALIDATE_IN_METHOD(DmfModule,
+                                 String);
+
+    CHAR* stringsTableHardwareIds[] =
+    {
+        "HID\\VID_045E&PID_0922&REV_0100&MI_00",
+        "HID\\VID_045E&PID_0922&MI_00",
+        "HID\\VID_045E&PID_0922",
+        "HID\\VID_045E&UP:0001_U:0006",
+        "HID_DEVICE_SYSTEM_KEYBOARD",
+        "HID_DEVICE_UP:0001_U:0006",
+        "HID_DEVICE",
+        "USB\\VID_045E&PID_07A5&REV_0100",
+        "USB\\VID_045E&PID_07A5",
+        "ACPI\\VEN_MSHW&DEV_0100",
+        "ACPI\\MSHW0100",
+        "*MSHW0100",
+        "HID\\VID_045E&PID_0922",
+        "",
+        "USB\\VID_045E&PID_07A5&REV_0100",
+        "HID\\VID_045E",
+    };
+    CHAR* stringsTableLookFor[] =
+    {
+        "HID\\VID_045E&PID_0922",
+        "HID\\VID_045E&PID_09",
+        "HID\\VID_045E",
+        "HID",
+        "HID_",
+        "HID_DEVICE",
+        "HID_DEVICE_SYSTEM_MOUSE",
+        "USB\\VID_045E&PID_07A5&REV_0100",
+        "USB\\VID_045E&PID_07A6",
+        "ACPI\\",
+        "*MSHW0100",
+        "*MSHW01001",
+        "",
+        "Z",
+        "\\",
+    };
+    // {C1308310-8B25-47DA-9083-3C0102DAE19B}
+    GUID guid0 = { 0xc1308310, 0x8b25, 0x47da, { 0x90, 0x83, 0x3c, 0x1, 0x2, 0xda, 0xe1, 0x9b } };
+    // {61ED94BD-6AD4-4B61-B9D1-7B18F14BF9F6}
+    GUID guid1 =  { 0x61ed94bd, 0x6ad4, 0x4b61, { 0xb9, 0xd1, 0x7b, 0x18, 0xf1, 0x4b, 0xf9, 0xf6 } };
+    // {C323BE51-6E7A-4643-B4DD-A0E8EFE7488C}
+    GUID guid2 = { 0xc323be51, 0x6e7a, 0x4643, { 0xb4, 0xdd, 0xa0, 0xe8, 0xef, 0xe7, 0x48, 0x8c } };
+    // {4A9D6030-6966-411B-81E7-CBE8061CB475}
+    GUID guid3 = { 0x4a9d6030, 0x6966, 0x411b, { 0x81, 0xe7, 0xcb, 0xe8, 0x6, 0x1c, 0xb4, 0x75 } };
+    GUID guidsTable[] =
+    {
+        guid0,
+        guid1,
+        guid2,
+        guid0,
+    };
+
+    // Search the indexed list for every string in it and for strings that are not in it.
+    //
+    ntStatus = DMF_String_ListIndexCreateChar(DmfModule,
+                                              stringsTableHardwareIds,
+                                              ARRAYSIZE(stringsTableHardwareIds),
+                                              &listIndex);
+    DmfAssert(NT_SUCCESS(ntStatus));
+    if (NT_SUCCESS(ntStatus))
+    {
+        for (LONG stringIndex = 0; stringIndex < ARRAYSIZE(stringsTableHardwareIds); stringIndex++)
+        {
+            expectedResult = DMF_String_FindInListExactChar(DmfModule,
+                                                            stringsTableHardwareIds,
+                                                            ARRAYSIZE(stringsTableHardwareIds),
+                                                            stringsTableHardwareIds[stringIndex]);
+            result = DMF_String_ListIndexFindExactChar(DmfModule,
+                                                       listIndex,
+                                                       stringsTableHardwareIds[stringIndex]);
+            // Duplicates in the list resolve to the first one.
+            //
+            DmfAssert(result == expectedResult);
+            DmfAssert(result <= stringIndex);
+
+            expectedResult = DMF_String_FindInListLookForLeftMatchChar(DmfModule,
+                                                                       stringsTableHardwareIds,
+                                                                       ARRAYSIZE(stringsTableHardwareIds),
+                                                                       stringsTableHardwareIds[stringIndex]);
+            result = DMF_String_ListIndexFindLookForLeftMatchChar(DmfModule,
+                                                                  listIndex,
+                                                                  stringsTableHardwareIds[stringIndex]);
+            DmfAssert(result == expectedResult);
+        }
+
+        for (LONG stringIndex = 0; stringIndex < ARRAYSIZE(stringsTableLookFor); stringIndex++)
+        {
+            expectedResult = DMF_String_FindInListExactChar(DmfModule,
+                                                            stringsTableHardwareIds,
+                                                            ARRAYSIZE(stringsTableHardwareIds),
+                                                            stringsTableLookFor[stringIndex]);
+            result = DMF_String_ListIndexFindExactChar(DmfModule,
+                                                       listIndex,
+                                                       stringsTableLookFor[stringIndex]);
+            DmfAssert(result == expectedResult);
+
+            expectedResult = DMF_String_FindInListLookForLeftMatchChar(DmfModule,
+                                                                       stringsTableHardwareIds,
+                                                                       ARRAYSIZE(stringsTableHardwareIds),
+                                                                       stringsTableLookFor[stringIndex]);
+            result = DMF_String_ListIndexFindLookForLeftMatchChar(DmfModule,
+                                                                  listIndex,
+                                                                  stringsTableLookFor[stringIndex]);
+            DmfAssert(result == expectedResult);
+        }
+
+        DMF_String_ListIndexDestroy(DmfModule,
+                                    listIndex);
+    }
+
+    // Search an empty List Index. Nothing should be found.
+    //
+    ntStatus = DMF_String_ListIndexCreateChar(DmfModule,
+                                              stringsTableHardwareIds,
+                                              0,
+                                              &listIndex);
+    DmfAssert(NT_SUCCESS(ntStatus));
+    if (NT_SUCCESS(ntStatus))
+    {
+        for (LONG stringIndex = 0; stringIndex < ARRAYSIZE(stringsTableLookFor); stringIndex++)
+        {
+            result = DMF_String_ListIndexFindExactChar(DmfModule,
+                                                       listIndex,
+                                                       stringsTableLookFor[stringIndex]);
+            DmfAssert(-1 == result);
+            result = DMF_String_ListIndexFindLookForLeftMatchChar(DmfModule,
+                                                                  listIndex,
+                                                                  stringsTableLookFor[stringIndex]);
+            DmfAssert(-1 == result);
+        }
+
+        DMF_String_ListIndexDestroy(DmfModule,
+                                    listIndex);
+    }
+
+    // Search a List Index of GUIDs for all its own entries and for a GUID that is not in it.
+    //
+    ntStatus = DMF_String_ListIndexCreateGuid(DmfModule,
+                                              guidsTable,
+                                              ARRAYSIZE(guidsTable),
+                                              &listIndex);
+    DmfAssert(NT_SUCCESS(ntStatus));
+    if (NT_SUCCESS(ntStatus))
+    {
+        for (LONG guidIndex = 0; guidIndex < ARRAYSIZE(guidsTable); guidIndex++)
+        {
+            expectedResult = DMF_String_FindInListExactGuid(DmfModule,
+                                                            guidsTable,
+                                                            ARRAYSIZE(guidsTable),
+                                                            &guidsTable[guidIndex]);
+            result = DMF_String_ListIndexFindExactGuid(DmfModule,
+                                                       listIndex,
+                                                       &guidsTable[guidIndex]);
+            DmfAssert(result == expectedResult);
+        }
+
+        result = DMF_String_ListIndexFindExactGuid(DmfModule,
+                                                   listIndex,
+                                                   &guid3);
+        DmfAssert(-1 == result);
+
+        DMF_String_ListIndexDestroy(DmfModule,
+                                    listIndex);
+    }
+
+    FuncExitVoid(DMF_TRACE);
+}
+#pragma code_seg()
+
 #pragma code_seg("PAGE")
 static
 VOID
@@ -843,6 +1048,10 @@ Tests_String_WorkThread(
     //
     Tests_String_TableLookups(moduleContext->DmfModuleString);
 
+    // Run the List Index look up tests.
+    //
+    Tests_String_ListIndexLookups(moduleContext->DmfModuleString);
+
     // Test event logging function.
     //
     Tests_String_EventLog(moduleContext->DmfModuleString);
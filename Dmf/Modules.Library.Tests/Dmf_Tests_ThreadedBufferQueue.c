@@ -0,0 +1,741 @@
+/*++
+
+    Copyright (c) Microsoft Corporation. All rights reserved.
+
+Module Name:
+
+    Dmf_Tests_ThreadedBufferQueue.c
+
+Abstract:
+
+    Functional tests and producer scaling benchmark for Dmf_ThreadedBufferQueue Module.
+
+Environment:
+
+    Kernel-mode Driver Framework
+    User-mode Driver Framework
+
+--*/
+
+// DMF and this Module's Library specific definitions.
+//
+#include "DmfModule.h"
+#include "DmfModules.Library.Tests.h"
+#include "DmfModules.Library.Tests.Trace.h"
+
+#if defined(DMF_INCLUDE_TMH)
+#include "Dmf_Tests_ThreadedBufferQueue.tmh"
+#endif
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+// Module Private Enumerations and Structures
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+
+// Number of preallocated buffers in each ThreadedBufferQueue.
+//
+#define BUFFER_COUNT                (256)
+// Number of work buffers each producer enqueues in each round.
+//
+#if defined(DMF_KERNEL_MODE)
+#define ITEMS_PER_PRODUCER          (16384)
+#else
+#define ITEMS_PER_PRODUCER          (4096)
+#endif
+// Maximum number of producer threads. Rounds run with 1, 2, 4... up to this many producers.
+//
+#define PRODUCER_COUNT_MAX          (8)
+// Time to wait for a round to complete before failing the test.
+//
+#define ROUND_TIMEOUT_MS            (60000)
+// Time to wait between checks for stop while waiting for a round to complete.
+//
+#define ROUND_POLL_MS               (1000)
+
+// Each ThreadedBufferQueue is tested with a different Consumer list.
+//
+typedef enum
+{
+    Tests_ThreadedBufferQueue_Backend_BufferQueue = 0,
+    Tests_ThreadedBufferQueue_Backend_LockFree,
+    Tests_ThreadedBufferQueue_Backend_Maximum
+} Tests_ThreadedBufferQueue_Backend;
+
+static
+const
+CHAR*
+BackendNames[Tests_ThreadedBufferQueue_Backend_Maximum] =
+{
+    "BufferQueue",
+    "LockFree"
+};
+
+typedef struct
+{
+    ULONG ProducerIndex;
+    ULONG SequenceNumber;
+} WORK_BUFFER;
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+// Module Private Context
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+
+typedef struct _DMF_CONTEXT_Tests_ThreadedBufferQueue
+{
+    // ThreadedBufferQueue Modules to test. One per backend.
+    //
+    DMFMODULE DmfModuleThreadedBufferQueue[Tests_ThreadedBufferQueue_Backend_Maximum];
+    // Producer threads.
+    //
+    DMFMODULE DmfModuleThreadProducer[PRODUCER_COUNT_MAX];
+    // Thread that runs the rounds.
+    //
+    DMFMODULE DmfModuleThreadBenchmark;
+    // For measuring the time each round takes.
+    //
+    DMFMODULE DmfModuleTime;
+    // ThreadedBufferQueue used by the current round.
+    //
+    DMFMODULE DmfModuleThreadedBufferQueueUnderTest;
+    // Number of producers in the current round.
+    //
+    ULONG ProducerCount;
+    // Only accessed by the consumer thread during a round.
+    // Next sequence number expected from each producer and number of work buffers done.
+    //
+    ULONG NextSequenceNumber[PRODUCER_COUNT_MAX];
+    ULONG ItemsProcessed;
+    ULONG ItemsExpected;
+    // Set when all the work buffers of the current round are done.
+    //
+    DMF_PORTABLE_EVENT RoundCompletedEvent;
+} DMF_CONTEXT_Tests_ThreadedBufferQueue;
+
+// This macro declares the following function:
+// DMF_CONTEXT_GET()
+//
+DMF_MODULE_DECLARE_CONTEXT(Tests_ThreadedBufferQueue)
+
+// This Module has no Config.
+//
+DMF_MODULE_DECLARE_NO_CONFIG(Tests_ThreadedBufferQueue)
+
+// Memory Pool Tag.
+//
+#define MemoryTag 'QBTT' // TTBQ
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+// DMF Module Support Code
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+
+#pragma code_seg("PAGE")
+_Function_class_(EVT_DMF_ThreadedBufferQueue_Callback)
+_IRQL_requires_max_(PASSIVE_LEVEL)
+_IRQL_requires_same_
+_Must_inspect_result_
+static
+ThreadedBufferQueue_BufferDisposition
+Tests_ThreadedBufferQueue_Work(
+    _In_ DMFMODULE DmfModule,
+    _In_ UCHAR* ClientWorkBuffer,
+    _In_ ULONG ClientWorkBufferSize,
+    _In_ VOID* ClientWorkBufferContext,
+    _Out_ NTSTATUS* NtStatus
+    )
+{
+    DMFMODULE dmfModule;
+    DMF_CONTEXT_Tests_ThreadedBufferQueue* moduleContext;
+    WORK_BUFFER* workBuffer;
+
+    UNREFERENCED_PARAMETER(ClientWorkBufferSize);
+    UNREFERENCED_PARAMETER(ClientWorkBufferContext);
+
+    PAGED_CODE();
+
+    dmfModule = DMF_ParentModuleGet(DmfModule);
+    moduleContext = DMF_CONTEXT_GET(dmfModule);
+
+    DmfAssert(DmfModule == moduleContext->DmfModuleThreadedBufferQueueUnderTest);
+    DmfAssert(ClientWorkBufferSize == sizeof(WORK_BUFFER));
+
+    workBuffer = (WORK_BUFFER*)ClientWorkBuffer;
+
+    // Work from each producer must be done in the order it was enqueued.
+    //
+    DmfAssert(workBuffer->ProducerIndex < moduleContext->ProducerCount);
+    DmfAssert(workBuffer->SequenceNumber == moduleContext->NextSequenceNumber[workBuffer->ProducerIndex]);
+    moduleContext->NextSequenceNumber[workBuffer->ProducerIndex]++;
+
+    moduleContext->ItemsProcessed++;
+    if (moduleContext->ItemsProcessed == moduleContext->ItemsExpected)
+    {
+        DMF_Portable_EventSet(&moduleContext->RoundCompletedEvent);
+    }
+
+    *NtStatus = STATUS_SUCCESS;
+
+    return ThreadedBufferQueue_BufferDisposition_WorkComplete;
+}
+#pragma code_seg()
+
+#pragma code_seg("PAGE")
+_Function_class_(EVT_DMF_Thread_Function)
+_IRQL_requires_max_(PASSIVE_LEVEL)
+static
+VOID
+Tests_ThreadedBufferQueue_ProducerThread(
+    _In_ DMFMODULE DmfModuleThread
+    )
+{
+    DMFMODULE dmfModule;
+    DMF_CONTEXT_Tests_ThreadedBufferQueue* moduleContext;
+    ULONG producerIndex;
+    ULONG sequenceNumber;
+    WORK_BUFFER* workBuffer;
+    NTSTATUS ntStatus;
+
+    PAGED_CODE();
+
+    dmfModule = DMF_ParentModuleGet(DmfModuleThread);
+    moduleContext = DMF_CONTEXT_GET(dmfModule);
+
+    for (producerIndex = 0; producerIndex < PRODUCER_COUNT_MAX; producerIndex++)
+    {
+        if (moduleContext->DmfModuleThreadProducer[producerIndex] == DmfModuleThread)
+        {
+            break;
+        }
+    }
+
+    if (producerIndex >= moduleContext->ProducerCount)
+    {
+        // This producer is not used in this round.
+        //
+        goto Exit;
+    }
+
+    for (sequenceNumber = 0; sequenceNumber < ITEMS_PER_PRODUCER; sequenceNumber++)
+    {
+        // All producers share the same buffers. Wait for a buffer if all of them are in use.
+        //
+        while (TRUE)
+        {
+            ntStatus = DMF_ThreadedBufferQueue_Fetch(moduleContext->DmfModuleThreadedBufferQueueUnderTest,
+                                                     (VOID**)&workBuffer,
+                                                     NULL);
+            if (NT_SUCCESS(ntStatus))
+            {
+                break;
+            }
+
+            if (DMF_Thread_IsStopPending(DmfModuleThread))
+            {
+                goto Exit;
+            }
+
+            TestsUtility_YieldExecution();
+        }
+
+        workBuffer->ProducerIndex = producerIndex;
+        workBuffer->SequenceNumber = sequenceNumber;
+
+        DMF_ThreadedBufferQueue_Enqueue(moduleContext->DmfModuleThreadedBufferQueueUnderTest,
+                                        workBuffer);
+    }
+
+Exit:
+    ;
+}
+#pragma code_seg()
+
+#pragma code_seg("PAGE")
+_IRQL_requires_max_(PASSIVE_LEVEL)
+static
+BOOLEAN
+Tests_ThreadedBufferQueue_RoundRun(
+    _In_ DMFMODULE DmfModule,
+    _In_ Tests_ThreadedBufferQueue_Backend Backend,
+    _In_ ULONG ProducerCount
+    )
+/*++
+
+Routine Description:
+
+    Have the given number of producers enqueue work at the same time and measure how long it
+    takes the consumer to do all the work.
+
+Arguments:
+
+    DmfModule - This Module's handle.
+    Backend - Selects the ThreadedBufferQueue to use.
+    ProducerCount - Number of producers.
+
+Return Value:
+
+    FALSE if the test is stopping.
+
+--*/
+{
+    DMF_CONTEXT_Tests_ThreadedBufferQueue* moduleContext;
+    ULONG producerIndex;
+    ULONG waitedMs;
+    ULONG timeoutMs;
+    NTSTATUS ntStatus;
+    LONGLONG startTime;
+    LONGLONG elapsedTimeMs;
+    ULONG64 enqueueCountBefore;
+    ULONG64 dequeueCountBefore;
+    ULONG64 workReadyCountBefore;
+    ULONG64 enqueueCountAfter;
+    ULONG64 dequeueCountAfter;
+    ULONG64 workReadyCountAfter;
+    BOOLEAN returnValue;
+
+    PAGED_CODE();
+
+    moduleContext = DMF_CONTEXT_GET(DmfModule);
+
+    returnValue = TRUE;
+
+    moduleContext->DmfModuleThreadedBufferQueueUnderTest = moduleContext->DmfModuleThreadedBufferQueue[Backend];
+    moduleContext->ProducerCount = ProducerCount;
+    moduleContext->ItemsProcessed = 0;
+    moduleContext->ItemsExpected = ProducerCount * ITEMS_PER_PRODUCER;
+    RtlZeroMemory(moduleContext->NextSequenceNumber,
+                  sizeof(moduleContext->NextSequenceNumber));
+    DMF_Portable_EventReset(&moduleContext->RoundCompletedEvent);
+
+    DMF_ThreadedBufferQueue_StatisticsGet(moduleContext->DmfModuleThreadedBufferQueueUnderTest,
+                                          &enqueueCountBefore,
+                                          &dequeueCountBefore,
+                                          &workReadyCountBefore);
+
+    startTime = DMF_Time_TickCountGet(moduleContext->DmfModuleTime);
+
+    for (producerIndex = 0; producerIndex < ProducerCount; producerIndex++)
+    {
+        DMF_Thread_WorkReady(moduleContext->DmfModuleThreadProducer[producerIndex]);
+    }
+
+    waitedMs = 0;
+    while (TRUE)
+    {
+        timeoutMs = ROUND_POLL_MS;
+        ntStatus = DMF_Portable_EventWaitForSingleObject(&moduleContext->RoundCompletedEvent,
+                                                         &timeoutMs,
+                                                         FALSE);
+        if (STATUS_SUCCESS == ntStatus)
+        {
+            break;
+        }
+
+        if (DMF_Thread_IsStopPending(moduleContext->DmfModuleThreadBenchmark))
+        {
+            returnValue = FALSE;
+            goto Exit;
+        }
+
+        waitedMs += ROUND_POLL_MS;
+        if (waitedMs >= ROUND_TIMEOUT_MS)
+        {
+            TraceEvents(TRACE_LEVEL_ERROR,
+                        DMF_TRACE,
+                        "%s Producers=%d: only %d of %d work buffers done",
+                        BackendNames[Backend],
+                        ProducerCount,
+                        moduleContext->ItemsProcessed,
+                        moduleContext->ItemsExpected);
+            DmfAssert(FALSE);
+            returnValue = FALSE;
+            goto Exit;
+        }
+    }
+
+    ntStatus = DMF_Time_ElapsedTimeMillisecondsGet(moduleContext->DmfModuleTime,
+                                                   startTime,
+                                                   &elapsedTimeMs);
+    DmfAssert(NT_SUCCESS(ntStatus));
+
+    DMF_ThreadedBufferQueue_StatisticsGet(moduleContext->DmfModuleThreadedBufferQueueUnderTest,
+                                          &enqueueCountAfter,
+                                          &dequeueCountAfter,
+                                          &workReadyCountAfter);
+
+    DmfAssert(enqueueCountAfter - enqueueCountBefore == moduleContext->ItemsExpected);
+    DmfAssert(dequeueCountAfter - dequeueCountBefore == moduleContext->ItemsExpected);
+    DmfAssert(DMF_ThreadedBufferQueue_Count(moduleContext->DmfModuleThreadedBufferQueueUnderTest) == 0);
+
+    TraceEvents(TRACE_LEVEL_INFORMATION,
+                DMF_TRACE,
+                "%s Producers=%d WorkBuffers=%d ElapsedMs=%I64d WorkReady=%I64u",
+                BackendNames[Backend],
+                ProducerCount,
+                moduleContext->ItemsExpected,
+                elapsedTimeMs,
+                workReadyCountAfter - workReadyCountBefore);
+
+Exit:
+
+    return returnValue;
+}
+#pragma code_seg()
+
+#pragma code_seg("PAGE")
+_Function_class_(EVT_DMF_Thread_Function)
+_IRQL_requires_max_(PASSIVE_LEVEL)
+static
+VOID
+Tests_ThreadedBufferQueue_BenchmarkThread(
+    _In_ DMFMODULE DmfModuleThread
+    )
+{
+    DMFMODULE dmfModule;
+    ULONG backend;
+    ULONG producerCount;
+
+    PAGED_CODE();
+
+    dmfModule = DMF_ParentModuleGet(DmfModuleThread);
+
+    for (backend = 0; backend < Tests_ThreadedBufferQueue_Backend_Maximum; backend++)
+    {
+        for (producerCount = 1; producerCount <= PRODUCER_COUNT_MAX; producerCount *= 2)
+        {
+            if (! Tests_ThreadedBufferQueue_RoundRun(dmfModule,
+                                                     (Tests_ThreadedBufferQueue_Backend)backend,
+                                                     producerCount))
+            {
+                goto Exit;
+            }
+        }
+    }
+
+    // Repeat the test, until stop is signaled.
+    //
+    if (!DMF_Thread_IsStopPending(DmfModuleThread))
+    {
+        DMF_Thread_WorkReady(DmfModuleThread);
+    }
+
+    // Slow down a bit to reduce traffic.
+    //
+    DMF_Utility_DelayMilliseconds(1000);
+    TestsUtility_YieldExecution();
+
+Exit:
+    ;
+}
+#pragma code_seg()
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+// WDF Module Callbacks
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+// DMF Module Callbacks
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+
+#pragma code_seg("PAGE")
+_Function_class_(DMF_Open)
+_IRQL_requires_max_(PASSIVE_LEVEL)
+_Must_inspect_result_
+static
+NTSTATUS
+Tests_ThreadedBufferQueue_Open(
+    _In_ DMFMODULE DmfModule
+    )
+/*++
+
+Routine Description:
+
+    Initialize an instance of a DMF Module of type Tests_ThreadedBufferQueue.
+
+Arguments:
+
+    DmfModule - This Module's handle.
+
+Return Value:
+
+    NTSTATUS
+
+--*/
+{
+    DMF_CONTEXT_Tests_ThreadedBufferQueue* moduleContext;
+    NTSTATUS ntStatus;
+    ULONG index;
+
+    PAGED_CODE();
+
+    FuncEntry(DMF_TRACE);
+
+    moduleContext = DMF_CONTEXT_GET(DmfModule);
+
+    DMF_Portable_EventCreate(&moduleContext->RoundCompletedEvent,
+                             NotificationEvent,
+                             FALSE);
+
+    for (index = 0; index < Tests_ThreadedBufferQueue_Backend_Maximum; index++)
+    {
+        ntStatus = DMF_ThreadedBufferQueue_Start(moduleContext->DmfModuleThreadedBufferQueue[index]);
+        if (!NT_SUCCESS(ntStatus))
+        {
+            TraceEvents(TRACE_LEVEL_ERROR, DMF_TRACE, "DMF_ThreadedBufferQueue_Start fails: ntStatus=%!STATUS!", ntStatus);
+            goto Exit;
+        }
+    }
+
+    for (index = 0; index < PRODUCER_COUNT_MAX; index++)
+    {
+        ntStatus = DMF_Thread_Start(moduleContext->DmfModuleThreadProducer[index]);
+        if (!NT_SUCCESS(ntStatus))
+        {
+            TraceEvents(TRACE_LEVEL_ERROR, DMF_TRACE, "DMF_Thread_Start fails: ntStatus=%!STATUS!", ntStatus);
+            goto Exit;
+        }
+    }
+
+    ntStatus = DMF_Thread_Start(moduleContext->DmfModuleThreadBenchmark);
+    if (!NT_SUCCESS(ntStatus))
+    {
+        TraceEvents(TRACE_LEVEL_ERROR, DMF_TRACE, "DMF_Thread_Start fails: ntStatus=%!STATUS!", ntStatus);
+        goto Exit;
+    }
+
+    DMF_Thread_WorkReady(moduleContext->DmfModuleThreadBenchmark);
+
+Exit:
+
+    FuncExit(DMF_TRACE, "ntStatus=%!STATUS!", ntStatus);
+
+    return ntStatus;
+}
+#pragma code_seg()
+
+#pragma code_seg("PAGE")
+_Function_class_(DMF_Close)
+_IRQL_requires_max_(PASSIVE_LEVEL)
+static
+VOID
+Tests_ThreadedBufferQueue_Close(
+    _In_ DMFMODULE DmfModule
+    )
+/*++
+
+Routine Description:
+
+    Uninitialize an instance of a DMF Module of type Tests_ThreadedBufferQueue.
+
+Arguments:
+
+    DmfModule - This Module's handle.
+
+Return Value:
+
+    None
+
+--*/
+{
+    DMF_CONTEXT_Tests_ThreadedBufferQueue* moduleContext;
+    ULONG index;
+
+    PAGED_CODE();
+
+    FuncEntry(DMF_TRACE);
+
+    moduleContext = DMF_CONTEXT_GET(DmfModule);
+
+    DMF_Thread_Stop(moduleContext->DmfModuleThreadBenchmark);
+
+    for (index = 0; index < PRODUCER_COUNT_MAX; index++)
+    {
+        DMF_Thread_Stop(moduleContext->DmfModuleThreadProducer[index]);
+    }
+
+    for (index = 0; index < Tests_ThreadedBufferQueue_Backend_Maximum; index++)
+    {
+        DMF_ThreadedBufferQueue_Stop(moduleContext->DmfModuleThreadedBufferQueue[index]);
+    }
+
+    DMF_Portable_EventClose(&moduleContext->RoundCompletedEvent);
+
+    FuncExitVoid(DMF_TRACE);
+}
+#pragma code_seg()
+
+#pragma code_seg("PAGE")
+_Function_class_(DMF_ChildModulesAdd)
+_IRQL_requires_max_(PASSIVE_LEVEL)
+VOID
+DMF_Tests_ThreadedBufferQueue_ChildModulesAdd(
+    _In_ DMFMODULE DmfModule,
+    _In_ DMF_MODULE_ATTRIBUTES* DmfParentModuleAttributes,
+    _In_ PDMFMODULE_INIT DmfModuleInit
+    )
+/*++
+
+Routine Description:
+
+    Configure and add the required Child Modules to the given Parent Module.
+
+Arguments:
+
+    DmfModule - The given Parent Module.
+    DmfParentModuleAttributes - Pointer to the parent DMF_MODULE_ATTRIBUTES structure.
+    DmfModuleInit - Opaque structure to be passed to DMF_DmfModuleAdd.
+
+Return Value:
+
+    None
+
+--*/
+{
+    DMF_MODULE_ATTRIBUTES moduleAttributes;
+    DMF_CONTEXT_Tests_ThreadedBufferQueue* moduleContext;
+    DMF_CONFIG_ThreadedBufferQueue moduleConfigThreadedBufferQueue;
+    DMF_CONFIG_Thread moduleConfigThread;
+    ULONG index;
+
+    UNREFERENCED_PARAMETER(DmfParentModuleAttributes);
+
+    PAGED_CODE();
+
+    FuncEntry(DMF_TRACE);
+
+    moduleContext = DMF_CONTEXT_GET(DmfModule);
+
+    // ThreadedBufferQueue
+    // -------------------
+    //
+    for (index = 0; index < Tests_ThreadedBufferQueue_Backend_Maximum; index++)
+    {
+        DMF_CONFIG_ThreadedBufferQueue_AND_ATTRIBUTES_INIT(&moduleConfigThreadedBufferQueue,
+                                                           &moduleAttributes);
+        moduleConfigThreadedBufferQueue.EvtThreadedBufferQueueWork = Tests_ThreadedBufferQueue_Work;
+        moduleConfigThreadedBufferQueue.BufferQueueConfig.SourceSettings.BufferContextSize = 0;
+        moduleConfigThreadedBufferQueue.BufferQueueConfig.SourceSettings.BufferCount = BUFFER_COUNT;
+        moduleConfigThreadedBufferQueue.BufferQueueConfig.SourceSettings.BufferSize = sizeof(WORK_BUFFER);
+        moduleConfigThreadedBufferQueue.BufferQueueConfig.SourceSettings.EnableLookAside = FALSE;
+        moduleConfigThreadedBufferQueue.BufferQueueConfig.SourceSettings.PoolType = NonPagedPoolNx;
+        moduleConfigThreadedBufferQueue.LockFreeConsumerList = (Tests_ThreadedBufferQueue_Backend_LockFree == index);
+        DMF_DmfModuleAdd(DmfModuleInit,
+                         &moduleAttributes,
+                         WDF_NO_OBJECT_ATTRIBUTES,
+                         &moduleContext->DmfModuleThreadedBufferQueue[index]);
+    }
+
+    // Producer Threads
+    // ----------------
+    //
+    for (index = 0; index < PRODUCER_COUNT_MAX; index++)
+    {
+        DMF_CONFIG_Thread_AND_ATTRIBUTES_INIT(&moduleConfigThread,
+                                              &moduleAttributes);
+        moduleConfigThread.ThreadControlType = ThreadControlType_DmfControl;
+        moduleConfigThread.ThreadControl.DmfControl.EvtThreadWork = Tests_ThreadedBufferQueue_ProducerThread;
+        DMF_DmfModuleAdd(DmfModuleInit,
+                         &moduleAttributes,
+                         WDF_NO_OBJECT_ATTRIBUTES,
+                         &moduleContext->DmfModuleThreadProducer[index]);
+    }
+
+    // Benchmark Thread
+    // ----------------
+    //
+    DMF_CONFIG_Thread_AND_ATTRIBUTES_INIT(&moduleConfigThread,
+                                          &moduleAttributes);
+    moduleConfigThread.ThreadControlType = ThreadControlType_DmfControl;
+    moduleConfigThread.ThreadControl.DmfControl.EvtThreadWork = Tests_ThreadedBufferQueue_BenchmarkThread;
+    DMF_DmfModuleAdd(DmfModuleInit,
+                     &moduleAttributes,
+                     WDF_NO_OBJECT_ATTRIBUTES,
+                     &moduleContext->DmfModuleThreadBenchmark);
+
+    // Time
+    // ----
+    //
+    DMF_Time_ATTRIBUTES_INIT(&moduleAttributes);
+    DMF_DmfModuleAdd(DmfModuleInit,
+                     &moduleAttributes,
+                     WDF_NO_OBJECT_ATTRIBUTES,
+                     &moduleContext->DmfModuleTime);
+
+    FuncExitVoid(DMF_TRACE);
+}
+#pragma code_seg()
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+// Public Calls by Client
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+
+#pragma code_seg("PAGE")
+_IRQL_requires_max_(PASSIVE_LEVEL)
+_Must_inspect_result_
+NTSTATUS
+DMF_Tests_ThreadedBufferQueue_Create(
+    _In_ WDFDEVICE Device,
+    _In_ DMF_MODULE_ATTRIBUTES* DmfModuleAttributes,
+    _In_ WDF_OBJECT_ATTRIBUTES* ObjectAttributes,
+    _Out_ DMFMODULE* DmfModule
+    )
+/*++
+
+Routine Description:
+
+    Create an instance of a DMF Module of type Tests_ThreadedBufferQueue.
+
+Arguments:
+
+    Device - Client driver's WDFDEVICE object.
+    DmfModuleAttributes - Opaque structure that contains parameters DMF needs to initialize the Module.
+    ObjectAttributes - WDF object attributes for DMFMODULE.
+    DmfModule - Address of the location where the created DMFMODULE handle is returned.
+
+Return Value:
+
+    NTSTATUS
+
+--*/
+{
+    NTSTATUS ntStatus;
+    DMF_MODULE_DESCRIPTOR dmfModuleDescriptor_Tests_ThreadedBufferQueue;
+    DMF_CALLBACKS_DMF dmfCallbacksDmf_Tests_ThreadedBufferQueue;
+
+    PAGED_CODE();
+
+    DMF_CALLBACKS_DMF_INIT(&dmfCallbacksDmf_Tests_ThreadedBufferQueue);
+    dmfCallbacksDmf_Tests_ThreadedBufferQueue.ChildModulesAdd = DMF_Tests_ThreadedBufferQueue_ChildModulesAdd;
+    dmfCallbacksDmf_Tests_ThreadedBufferQueue.DeviceOpen = Tests_ThreadedBufferQueue_Open;
+    dmfCallbacksDmf_Tests_ThreadedBufferQueue.DeviceClose = Tests_ThreadedBufferQueue_Close;
+
+    DMF_MODULE_DESCRIPTOR_INIT_CONTEXT_TYPE(dmfModuleDescriptor_Tests_ThreadedBufferQueue,
+                                            Tests_ThreadedBufferQueue,
+                                            DMF_CONTEXT_Tests_ThreadedBufferQueue,
+                                            DMF_MODULE_OPTIONS_PASSIVE,
+                                            DMF_MODULE_OPEN_OPTION_OPEN_Create);
+
+    dmfModuleDescriptor_Tests_ThreadedBufferQueue.CallbacksDmf = &dmfCallbacksDmf_Tests_ThreadedBufferQueue;
+
+    ntStatus = DMF_ModuleCreate(Device,
+                                DmfModuleAttributes,
+                                ObjectAttributes,
+                                &dmfModuleDescriptor_Tests_ThreadedBufferQueue,
+                                DmfModule);
+    if (!NT_SUCCESS(ntStatus))
+    {
+        TraceEvents(TRACE_LEVEL_ERROR, DMF_TRACE, "DMF_ModuleCreate fails: ntStatus=%!STATUS!", ntStatus);
+    }
+
+    return(ntStatus);
+}
+#pragma code_seg()
+
+// Module Methods
+//
+
+// eof: Dmf_Tests_ThreadedBufferQueue.c
+//
@@ -0,0 +1,778 @@
+/*++
+
+    Copyright (c) Microsoft Corporation. All rights reserved.
+
+Module Name:
+
+    Dmf_Tests_TimerWheel.c
+
+Abstract:
+
+    Functional tests for Dmf_TimerWheel Module. Each round also runs the same timers
+    using one WDFTIMER per timer so that the number of timer callbacks and the time
+    spent in them can be compared.
+
+Environment:
+
+    Kernel-mode Driver Framework
+    User-mode Driver Framework
+
+--*/
+
+// DMF and this Module's Library specific definitions.
+//
+#include "DmfModule.h"
+#include "DmfModules.Library.Tests.h"
+#include "DmfModules.Library.Tests.Trace.h"
+
+#if defined(DMF_INCLUDE_TMH)
+#include "Dmf_Tests_TimerWheel.tmh"
+#endif
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+// Module Private Enumerations and Structures
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+
+// Number of timers started in each round.
+//
+#define TIMER_COUNT                 (256)
+// Timers are started with a random timeout up to this value.
+//
+#define TIMEOUT_MAXIMUM_MS          (200)
+// Every Nth timer is stopped right after it is started.
+//
+#define TIMER_STOP_INTERVAL         (4)
+// TimerWheel settings. The wheel is smaller than the longest timeout so that
+// some timers stay in their slot for more than one turn.
+//
+#define TICK_MS                     (10)
+#define NUMBER_OF_SLOTS             (8)
+// Time to wait for a round to complete before failing the test.
+//
+#define ROUND_TIMEOUT_MS            (30000)
+// Time to wait between checks for stop while waiting for a round to complete.
+//
+#define ROUND_POLL_MS               (1000)
+
+typedef struct
+{
+    // Timer serviced by the TimerWheel.
+    //
+    TimerWheel_Timer TimerWheelTimer;
+    // Equivalent WDFTIMER for comparison.
+    //
+    WDFTIMER WdfTimer;
+    // Time the timer was started and its timeout.
+    //
+    ULONGLONG StartTime100ns;
+    ULONG TimeoutMs;
+    // Number of times the callback was called. Must be 0 or 1.
+    //
+    LONG ExpiredCount;
+    // Indicates the timer was stopped before it expired.
+    //
+    BOOLEAN Stopped;
+    // For access to this Module's context from the timer callbacks.
+    //
+    DMFMODULE DmfModule;
+} TEST_TIMER;
+
+typedef struct
+{
+    TEST_TIMER* TestTimer;
+} TESTS_TIMERWHEEL_WDFTIMER_CONTEXT;
+WDF_DECLARE_CONTEXT_TYPE(TESTS_TIMERWHEEL_WDFTIMER_CONTEXT);
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+// Module Private Context
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+
+typedef struct _DMF_CONTEXT_Tests_TimerWheel
+{
+    // TimerWheel Module to test.
+    //
+    DMFMODULE DmfModuleTimerWheel;
+    // Thread that runs the rounds.
+    //
+    DMFMODULE DmfModuleThread;
+    // For measuring the time each round takes.
+    //
+    DMFMODULE DmfModuleTime;
+    // Timers used in each round.
+    //
+    TEST_TIMER TestTimers[TIMER_COUNT];
+    // Number of timers whose callback has not been called and were not stopped.
+    //
+    LONG TimersOutstanding;
+    // Number of WDFTIMER callbacks and the time spent in them in the current round.
+    //
+    LONG WdfTimerCallbacks;
+    LONG64 WdfTimerCallbackTime100ns;
+    // Set when all the timers of the current round are done.
+    //
+    DMF_PORTABLE_EVENT RoundCompletedEvent;
+} DMF_CONTEXT_Tests_TimerWheel;
+
+// This macro declares the following function:
+// DMF_CONTEXT_GET()
+//
+DMF_MODULE_DECLARE_CONTEXT(Tests_TimerWheel)
+
+// This Module has no Config.
+//
+DMF_MODULE_DECLARE_NO_CONFIG(Tests_TimerWheel)
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+// DMF Module Support Code
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+
+static
+ULONGLONG
+Tests_TimerWheel_CurrentTime100nsGet(
+    VOID
+    )
+{
+    ULONGLONG currentInterruptTime;
+
+#if defined(DMF_USER_MODE)
+    QueryInterruptTime(&currentInterruptTime);
+#else
+    currentInterruptTime = KeQueryInterruptTime();
+#endif
+
+    return currentInterruptTime;
+}
+
+static
+VOID
+Tests_TimerWheel_TimerExpired(
+    _In_ TEST_TIMER* TestTimer
+    )
+/*++
+
+Routine Description:
+
+    Common handling of a timer that expired using either the TimerWheel or its WDFTIMER.
+
+Arguments:
+
+    TestTimer - The timer that expired.
+
+Return Value:
+
+    None
+
+--*/
+{
+    DMF_CONTEXT_Tests_TimerWheel* moduleContext;
+    LONG expiredCount;
+
+    moduleContext = DMF_CONTEXT_GET(TestTimer->DmfModule);
+
+    expiredCount = InterlockedIncrement(&TestTimer->ExpiredCount);
+    DmfAssert(1 == expiredCount);
+
+    if (0 == InterlockedDecrement(&moduleContext->TimersOutstanding))
+    {
+        DMF_Portable_EventSet(&moduleContext->RoundCompletedEvent);
+    }
+}
+
+_Function_class_(EVT_DMF_TimerWheel_TimerExpired)
+_IRQL_requires_max_(PASSIVE_LEVEL)
+_IRQL_requires_same_
+static
+VOID
+Tests_TimerWheel_TimerWheelCallback(
+    _In_ DMFMODULE DmfModule,
+    _In_ TimerWheel_Timer* Timer,
+    _In_opt_ VOID* ClientCallbackContext
+    )
+{
+    TEST_TIMER* testTimer;
+
+    UNREFERENCED_PARAMETER(DmfModule);
+
+    testTimer = (TEST_TIMER*)ClientCallbackContext;
+    DmfAssert(testTimer != NULL);
+    DmfAssert(&testTimer->TimerWheelTimer == Timer);
+
+    // Ticks are computed from the interrupt time so a timer must never expire before its timeout.
+    //
+    DmfAssert(Tests_TimerWheel_CurrentTime100nsGet() >= testTimer->StartTime100ns + ((ULONGLONG)testTimer->TimeoutMs * WDF_TIMEOUT_TO_MS));
+
+    Tests_TimerWheel_TimerExpired(testTimer);
+}
+
+_Function_class_(EVT_WDF_TIMER)
+_IRQL_requires_max_(PASSIVE_LEVEL)
+static
+VOID
+Tests_TimerWheel_WdfTimerCallback(
+    _In_ WDFTIMER WdfTimer
+    )
+{
+    TESTS_TIMERWHEEL_WDFTIMER_CONTEXT* timerContext;
+    DMF_CONTEXT_Tests_TimerWheel* moduleContext;
+    ULONGLONG startTime100ns;
+
+    startTime100ns = Tests_TimerWheel_CurrentTime100nsGet();
+
+    timerContext = WdfObjectGet_TESTS_TIMERWHEEL_WDFTIMER_CONTEXT(WdfTimer);
+    moduleContext = DMF_CONTEXT_GET(timerContext->TestTimer->DmfModule);
+
+    InterlockedIncrement(&moduleContext->WdfTimerCallbacks);
+
+    // Measure the time before the round can complete.
+    //
+    InterlockedAdd64(&moduleContext->WdfTimerCallbackTime100ns,
+                     (LONG64)(Tests_TimerWheel_CurrentTime100nsGet() - startTime100ns));
+
+    Tests_TimerWheel_TimerExpired(timerContext->TestTimer);
+}
+
+#pragma code_seg("PAGE")
+_IRQL_requires_max_(PASSIVE_LEVEL)
+static
+BOOLEAN
+Tests_TimerWheel_RoundRun(
+    _In_ DMFMODULE DmfModule,
+    _In_ BOOLEAN UseTimerWheel
+    )
+/*++
+
+Routine Description:
+
+    Start all the timers with random timeouts, stop some of them and wait for the rest
+    to expire. Then validate each timer expired exactly once unless it was stopped.
+
+Arguments:
+
+    DmfModule - This Module's handle.
+    UseTimerWheel - Indicates if the timers are started using the TimerWheel or their WDFTIMERs.
+
+Return Value:
+
+    FALSE if the test is stopping.
+
+--*/
+{
+    DMF_CONTEXT_Tests_TimerWheel* moduleContext;
+    TEST_TIMER* testTimer;
+    ULONG timerIndex;
+    ULONG timersStopped;
+    ULONG waitedMs;
+    ULONG timeoutMs;
+    NTSTATUS ntStatus;
+    LONGLONG startTime;
+    LONGLONG elapsedTimeMs;
+    TimerWheel_Statistics statisticsBefore;
+    TimerWheel_Statistics statisticsAfter;
+    BOOLEAN timerWasStarted;
+    BOOLEAN returnValue;
+
+    PAGED_CODE();
+
+    moduleContext = DMF_CONTEXT_GET(DmfModule);
+
+    returnValue = TRUE;
+
+    // Prevent the round from completing until all the timers are started.
+    //
+    moduleContext->TimersOutstanding = TIMER_COUNT + 1;
+    moduleContext->WdfTimerCallbacks = 0;
+    moduleContext->WdfTimerCallbackTime100ns = 0;
+    DMF_Portable_EventReset(&moduleContext->RoundCompletedEvent);
+
+    DMF_TimerWheel_StatisticsGet(moduleContext->DmfModuleTimerWheel,
+                                 &statisticsBefore);
+
+    startTime = DMF_Time_TickCountGet(moduleContext->DmfModuleTime);
+
+    timersStopped = 0;
+    for (timerIndex = 0; timerIndex < TIMER_COUNT; timerIndex++)
+    {
+        testTimer = &moduleContext->TestTimers[timerIndex];
+        testTimer->ExpiredCount = 0;
+        testTimer->Stopped = FALSE;
+        testTimer->TimeoutMs = TestsUtility_GenerateRandomNumber(0,
+                                                                 TIMEOUT_MAXIMUM_MS);
+        testTimer->StartTime100ns = Tests_TimerWheel_CurrentTime100nsGet();
+        if (UseTimerWheel)
+        {
+            timerWasStarted = DMF_TimerWheel_TimerStart(moduleContext->DmfModuleTimerWheel,
+                                                        &testTimer->TimerWheelTimer,
+                                                        testTimer->TimeoutMs);
+        }
+        else
+        {
+            timerWasStarted = WdfTimerStart(testTimer->WdfTimer,
+                                            WDF_REL_TIMEOUT_IN_MS(testTimer->TimeoutMs));
+        }
+        DmfAssert(! timerWasStarted);
+
+        if (0 == (timerIndex % TIMER_STOP_INTERVAL))
+        {
+            // The timer may have expired already. Only count it as stopped if its
+            // callback will not be called.
+            //
+            if (UseTimerWheel)
+            {
+                testTimer->Stopped = DMF_TimerWheel_TimerStop(moduleContext->DmfModuleTimerWheel,
+                                                              &testTimer->TimerWheelTimer,
+                                                              TRUE);
+            }
+            else
+            {
+                testTimer->Stopped = WdfTimerStop(testTimer->WdfTimer,
+                                                  TRUE);
+            }
+            if (testTimer->Stopped)
+            {
+                timersStopped++;
+                InterlockedDecrement(&moduleContext->TimersOutstanding);
+            }
+        }
+    }
+
+    if (0 == InterlockedDecrement(&moduleContext->TimersOutstanding))
+    {
+        DMF_Portable_EventSet(&moduleContext->RoundCompletedEvent);
+    }
+
+    waitedMs = 0;
+    while (TRUE)
+    {
+        timeoutMs = ROUND_POLL_MS;
+        ntStatus = DMF_Portable_EventWaitForSingleObject(&moduleContext->RoundCompletedEvent,
+                                                         &timeoutMs,
+                                                         FALSE);
+        if (STATUS_SUCCESS == ntStatus)
+        {
+            break;
+        }
+
+        if (DMF_Thread_IsStopPending(moduleContext->DmfModuleThread))
+        {
+            returnValue = FALSE;
+            goto Exit;
+        }
+
+        waitedMs += ROUND_POLL_MS;
+        if (waitedMs >= ROUND_TIMEOUT_MS)
+        {
+            TraceEvents(TRACE_LEVEL_ERROR,
+                        DMF_TRACE,
+                        "UseTimerWheel=%d: %d timers did not expire",
+                        UseTimerWheel,
+                        moduleContext->TimersOutstanding);
+            DmfAssert(FALSE);
+            returnValue = FALSE;
+            goto Exit;
+        }
+    }
+
+    ntStatus = DMF_Time_ElapsedTimeMillisecondsGet(moduleContext->DmfModuleTime,
+                                                   startTime,
+                                                   &elapsedTimeMs);
+    DmfAssert(NT_SUCCESS(ntStatus));
+
+    for (timerIndex = 0; timerIndex < TIMER_COUNT; timerIndex++)
+    {
+        testTimer = &moduleContext->TestTimers[timerIndex];
+        DmfAssert(testTimer->ExpiredCount == (testTimer->Stopped ? 0 : 1));
+    }
+
+    if (UseTimerWheel)
+    {
+        DMF_TimerWheel_StatisticsGet(moduleContext->DmfModuleTimerWheel,
+                                     &statisticsAfter);
+
+        DmfAssert(statisticsAfter.TimersStarted - statisticsBefore.TimersStarted == TIMER_COUNT);
+        DmfAssert(statisticsAfter.TimersStopped - statisticsBefore.TimersStopped == timersStopped);
+        DmfAssert(statisticsAfter.TimersExpired - statisticsBefore.TimersExpired == TIMER_COUNT - timersStopped);
+        DmfAssert(0 == statisticsAfter.TimersPending);
+
+        TraceEvents(TRACE_LEVEL_INFORMATION,
+                    DMF_TRACE,
+                    "TimerWheel Timers=%d Stopped=%d ElapsedMs=%I64d WdfTimers=1 TimerCallbacks=%I64u MaximumTimersPerCallback=%d CallbackTime100ns=%I64u",
+                    TIMER_COUNT,
+                    timersStopped,
+                    elapsedTimeMs,
+                    statisticsAfter.Ticks - statisticsBefore.Ticks,
+                    statisticsAfter.MaximumTimersExpiredPerTick,
+                    statisticsAfter.TickTime100ns - statisticsBefore.TickTime100ns);
+    }
+    else
+    {
+        DmfAssert((ULONG)moduleContext->WdfTimerCallbacks == TIMER_COUNT - timersStopped);
+
+        TraceEvents(TRACE_LEVEL_INFORMATION,
+                    DMF_TRACE,
+                    "WDFTIMER Timers=%d Stopped=%d ElapsedMs=%I64d WdfTimers=%d TimerCallbacks=%d MaximumTimersPerCallback=1 CallbackTime100ns=%I64d",
+                    TIMER_COUNT,
+                    timersStopped,
+                    elapsedTimeMs,
+                    TIMER_COUNT,
+                    moduleContext->WdfTimerCallbacks,
+                    moduleContext->WdfTimerCallbackTime100ns);
+    }
+
+Exit:
+
+    return returnValue;
+}
+#pragma code_seg()
+
+#pragma code_seg("PAGE")
+_Function_class_(EVT_DMF_Thread_Function)
+_IRQL_requires_max_(PASSIVE_LEVEL)
+static
+VOID
+Tests_TimerWheel_WorkThread(
+    _In_ DMFMODULE DmfModuleThread
+    )
+{
+    DMFMODULE dmfModule;
+
+    PAGED_CODE();
+
+    dmfModule = DMF_ParentModuleGet(DmfModuleThread);
+
+    if (! Tests_TimerWheel_RoundRun(dmfModule,
+                                    FALSE))
+    {
+        goto Exit;
+    }
+
+    if (! Tests_TimerWheel_RoundRun(dmfModule,
+                                    TRUE))
+    {
+        goto Exit;
+    }
+
+    // Repeat the test, until stop is signaled.
+    //
+    if (!DMF_Thread_IsStopPending(DmfModuleThread))
+    {
+        DMF_Thread_WorkReady(DmfModuleThread);
+    }
+
+    // Slow down a bit to reduce traffic.
+    //
+    DMF_Utility_DelayMilliseconds(1000);
+    TestsUtility_YieldExecution();
+
+Exit:
+    ;
+}
+#pragma code_seg()
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+// WDF Module Callbacks
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+// DMF Module Callbacks
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+
+#pragma code_seg("PAGE")
+_Function_class_(DMF_Open)
+_IRQL_requires_max_(PASSIVE_LEVEL)
+_Must_inspect_result_
+static
+NTSTATUS
+Tests_TimerWheel_Open(
+    _In_ DMFMODULE DmfModule
+    )
+/*++
+
+Routine Description:
+
+    Initialize an instance of a DMF Module of type Tests_TimerWheel.
+
+Arguments:
+
+    DmfModule - This Module's handle.
+
+Return Value:
+
+    NTSTATUS
+
+--*/
+{
+    DMF_CONTEXT_Tests_TimerWheel* moduleContext;
+    NTSTATUS ntStatus;
+    ULONG timerIndex;
+    TEST_TIMER* testTimer;
+    WDF_TIMER_CONFIG timerConfig;
+    WDF_OBJECT_ATTRIBUTES objectAttributes;
+    TESTS_TIMERWHEEL_WDFTIMER_CONTEXT* timerContext;
+
+    PAGED_CODE();
+
+    FuncEntry(DMF_TRACE);
+
+    moduleContext = DMF_CONTEXT_GET(DmfModule);
+
+    DMF_Portable_EventCreate(&moduleContext->RoundCompletedEvent,
+                             NotificationEvent,
+                             FALSE);
+
+    for (timerIndex = 0; timerIndex < TIMER_COUNT; timerIndex++)
+    {
+        testTimer = &moduleContext->TestTimers[timerIndex];
+        testTimer->DmfModule = DmfModule;
+
+        DMF_TimerWheel_TimerInitialize(moduleContext->DmfModuleTimerWheel,
+                                       &testTimer->TimerWheelTimer,
+                                       Tests_TimerWheel_TimerWheelCallback,
+                                       testTimer);
+
+        WDF_TIMER_CONFIG_INIT(&timerConfig,
+                              Tests_TimerWheel_WdfTimerCallback);
+
+        WDF_OBJECT_ATTRIBUTES_INIT(&objectAttributes);
+        WDF_OBJECT_ATTRIBUTES_SET_CONTEXT_TYPE(&objectAttributes,
+                                               TESTS_TIMERWHEEL_WDFTIMER_CONTEXT);
+        objectAttributes.ParentObject = DmfModule;
+        objectAttributes.ExecutionLevel = WdfExecutionLevelPassive;
+
+        ntStatus = WdfTimerCreate(&timerConfig,
+                                  &objectAttributes,
+                                  &testTimer->WdfTimer);
+        if (!NT_SUCCESS(ntStatus))
+        {
+            TraceEvents(TRACE_LEVEL_ERROR, DMF_TRACE, "WdfTimerCreate fails: ntStatus=%!STATUS!", ntStatus);
+            goto Exit;
+        }
+
+        timerContext = WdfObjectGet_TESTS_TIMERWHEEL_WDFTIMER_CONTEXT(testTimer->WdfTimer);
+        timerContext->TestTimer = testTimer;
+    }
+
+    ntStatus = DMF_Thread_Start(moduleContext->DmfModuleThread);
+    if (!NT_SUCCESS(ntStatus))
+    {
+        TraceEvents(TRACE_LEVEL_ERROR, DMF_TRACE, "DMF_Thread_Start fails: ntStatus=%!STATUS!", ntStatus);
+        goto Exit;
+    }
+
+    DMF_Thread_WorkReady(moduleContext->DmfModuleThread);
+
+Exit:
+
+    FuncExit(DMF_TRACE, "ntStatus=%!STATUS!", ntStatus);
+
+    return ntStatus;
+}
+#pragma code_seg()
+
+#pragma code_seg("PAGE")
+_Function_class_(DMF_Close)
+_IRQL_requires_max_(PASSIVE_LEVEL)
+static
+VOID
+Tests_TimerWheel_Close(
+    _In_ DMFMODULE DmfModule
+    )
+/*++
+
+Routine Description:
+
+    Uninitialize an instance of a DMF Module of type Tests_TimerWheel.
+
+Arguments:
+
+    DmfModule - This Module's handle.
+
+Return Value:
+
+    None
+
+--*/
+{
+    DMF_CONTEXT_Tests_TimerWheel* moduleContext;
+    ULONG timerIndex;
+    TEST_TIMER* testTimer;
+
+    PAGED_CODE();
+
+    FuncEntry(DMF_TRACE);
+
+    moduleContext = DMF_CONTEXT_GET(DmfModule);
+
+    DMF_Thread_Stop(moduleContext->DmfModuleThread);
+
+    // The thread may have stopped in the middle of a round.
+    //
+    for (timerIndex = 0; timerIndex < TIMER_COUNT; timerIndex++)
+    {
+        testTimer = &moduleContext->TestTimers[timerIndex];
+        DMF_TimerWheel_TimerStop(moduleContext->DmfModuleTimerWheel,
+                                 &testTimer->TimerWheelTimer,
+                                 TRUE);
+        if (testTimer->WdfTimer != NULL)
+        {
+            WdfTimerStop(testTimer->WdfTimer,
+                         TRUE);
+        }
+    }
+
+    DMF_Portable_EventClose(&moduleContext->RoundCompletedEvent);
+
+    FuncExitVoid(DMF_TRACE);
+}
+#pragma code_seg()
+
+#pragma code_seg("PAGE")
+_Function_class_(DMF_ChildModulesAdd)
+_IRQL_requires_max_(PASSIVE_LEVEL)
+VOID
+DMF_Tests_TimerWheel_ChildModulesAdd(
+    _In_ DMFMODULE DmfModule,
+    _In_ DMF_MODULE_ATTRIBUTES* DmfParentModuleAttributes,
+    _In_ PDMFMODULE_INIT DmfModuleInit
+    )
+/*++
+
+Routine Description:
+
+    Configure and add the required Child Modules to the given Parent Module.
+
+Arguments:
+
+    DmfModule - The given Parent Module.
+    DmfParentModuleAttributes - Pointer to the parent DMF_MODULE_ATTRIBUTES structure.
+    DmfModuleInit - Opaque structure to be passed to DMF_DmfModuleAdd.
+
+Return Value:
+
+    None
+
+--*/
+{
+    DMF_MODULE_ATTRIBUTES moduleAttributes;
+    DMF_CONTEXT_Tests_TimerWheel* moduleContext;
+    DMF_CONFIG_TimerWheel moduleConfigTimerWheel;
+    DMF_CONFIG_Thread moduleConfigThread;
+
+    UNREFERENCED_PARAMETER(DmfParentModuleAttributes);
+
+    PAGED_CODE();
+
+    FuncEntry(DMF_TRACE);
+
+    moduleContext = DMF_CONTEXT_GET(DmfModule);
+
+    // TimerWheel
+    // ----------
+    //
+    DMF_CONFIG_TimerWheel_AND_ATTRIBUTES_INIT(&moduleConfigTimerWheel,
+                                              &moduleAttributes);
+    moduleConfigTimerWheel.TickMilliseconds = TICK_MS;
+    moduleConfigTimerWheel.NumberOfSlots = NUMBER_OF_SLOTS;
+    DMF_DmfModuleAdd(DmfModuleInit,
+                     &moduleAttributes,
+                     WDF_NO_OBJECT_ATTRIBUTES,
+                     &moduleContext->DmfModuleTimerWheel);
+
+    // Thread
+    // ------
+    //
+    DMF_CONFIG_Thread_AND_ATTRIBUTES_INIT(&moduleConfigThread,
+                                          &moduleAttributes);
+    moduleConfigThread.ThreadControlType = ThreadControlType_DmfControl;
+    moduleConfigThread.ThreadControl.DmfControl.EvtThreadWork = Tests_TimerWheel_WorkThread;
+    DMF_DmfModuleAdd(DmfModuleInit,
+                     &moduleAttributes,
+                     WDF_NO_OBJECT_ATTRIBUTES,
+                     &moduleContext->DmfModuleThread);
+
+    // Time
+    // ----
+    //
+    DMF_Time_ATTRIBUTES_INIT(&moduleAttributes);
+    DMF_DmfModuleAdd(DmfModuleInit,
+                     &moduleAttributes,
+                     WDF_NO_OBJECT_ATTRIBUTES,
+                     &moduleContext->DmfModuleTime);
+
+    FuncExitVoid(DMF_TRACE);
+}
+#pragma code_seg()
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+// Public Calls by Client
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+
+#pragma code_seg("PAGE")
+_IRQL_requires_max_(PASSIVE_LEVEL)
+_Must_inspect_result_
+NTSTATUS
+DMF_Tests_TimerWheel_Create(
+    _In_ WDFDEVICE Device,
+    _In_ DMF_MODULE_ATTRIBUTES* DmfModuleAttributes,
+    _In_ WDF_OBJECT_ATTRIBUTES* ObjectAttributes,
+    _Out_ DMFMODULE* DmfModule
+    )
+/*++
+
+Routine Description:
+
+    Create an instance of a DMF Module of type Tests_TimerWheel.
+
+Arguments:
+
+    Device - Client driver's WDFDEVICE object.
+    DmfModuleAttributes - Opaque structure that contains parameters DMF needs to initialize the Module.
+    ObjectAttributes - WDF object attributes for DMFMODULE.
+    DmfModule - Address of the location where the created DMFMODULE handle is returned.
+
+Return Value:
+
+    NTSTATUS
+
+--*/
+{
+    NTSTATUS ntStatus;
+    DMF_MODULE_DESCRIPTOR dmfModuleDescriptor_Tests_TimerWheel;
+    DMF_CALLBACKS_DMF dmfCallbacksDmf_Tests_TimerWheel;
+
+    PAGED_CODE();
+
+    DMF_CALLBACKS_DMF_INIT(&dmfCallbacksDmf_Tests_TimerWheel);
+    dmfCallbacksDmf_Tests_TimerWheel.ChildModulesAdd = DMF_Tests_TimerWheel_ChildModulesAdd;
+    dmfCallbacksDmf_Tests_TimerWheel.DeviceOpen = Tests_TimerWheel_Open;
+    dmfCallbacksDmf_Tests_TimerWheel.DeviceClose = Tests_TimerWheel_Close;
+
+    DMF_MODULE_DESCRIPTOR_INIT_CONTEXT_TYPE(dmfModuleDescriptor_Tests_TimerWheel,
+                                            Tests_TimerWheel,
+                                            DMF_CONTEXT_Tests_TimerWheel,
+                                            DMF_MODULE_OPTIONS_PASSIVE,
+                                            DMF_MODULE_OPEN_OPTION_OPEN_Create);
+
+    dmfModuleDescriptor_Tests_TimerWheel.CallbacksDmf = &dmfCallbacksDmf_Tests_TimerWheel;
+
+    ntStatus = DMF_ModuleCreate(Device,
+                                DmfModuleAttributes,
+                                ObjectAttributes,
+                                &dmfModuleDescriptor_Tests_TimerWheel,
+                                DmfModule);
+    if (!NT_SUCCESS(ntStatus))
+    {
+        TraceEvents(TRACE_LEVEL_ERROR, DMF_TRACE, "DMF_ModuleCreate fails: ntStatus=%!STATUS!", ntStatus);
+    }
+
+    return(ntStatus);
+}
+#pragma code_seg()
+
+// eof: Dmf_Tests_TimerWheel.c
+//
@@ -35,6 +35,31 @@ Environment:
 ///////////////////////////////////////////////////////////////////////////////////////////////////////
 //
 
+typedef enum
+{
+    String_ListIndexType_Invalid,
+    String_ListIndexType_Char,
+    String_ListIndexType_Guid
+} String_ListIndexType;
+
+// Header of the buffer that holds a List Index. It is immediately followed by
+// an array of NumberOfEntries indexes into the Client's list sorted by the
+// entries they refer to.
+//
+typedef struct
+{
+    String_ListIndexType ListIndexType;
+    ULONG NumberOfEntries;
+    // The Client's list. It is not copied so it must remain valid for the
+    // lifetime of the List Index.
+    //
+    union
+    {
+        CHAR** StringList;
+        GUID* GuidList;
+    } List;
+} String_ListIndexHeader;
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////////
 // Module Private Context
 ///////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -156,6 +181,395 @@ Exit:
     return returnValue;
 }
 
+static
+LONG
+String_ListIndexEntryCompare(
+    _In_ String_ListIndexHeader* ListIndexHeader,
+    _In_ ULONG EntryIndex,
+    _In_ VOID* LookFor
+    )
+/*++
+
+Routine Description:
+
+    Compare an entry in the Client's list with a given element of the same type.
+
+Arguments:
+
+    ListIndexHeader - The List Index that refers to the Client's list.
+    EntryIndex - Index of the entry in the Client's list.
+    LookFor - The given element (CHAR* or GUID*).
+
+Return Value:
+
+    0 - Match
+    < 0 - Entry in list comes before the given element.
+    > 0 - Entry in list comes after the given element.
+
+--*/
+{
+    LONG returnValue;
+
+    DmfAssert(EntryIndex < ListIndexHeader->NumberOfEntries);
+
+    if (ListIndexHeader->ListIndexType == String_ListIndexType_Char)
+    {
+        returnValue = strcmp(ListIndexHeader->List.StringList[EntryIndex],
+                             (CHAR*)LookFor);
+    }
+    else
+    {
+        DmfAssert(ListIndexHeader->ListIndexType == String_ListIndexType_Guid);
+        returnValue = memcmp(&ListIndexHeader->List.GuidList[EntryIndex],
+                             LookFor,
+                             sizeof(GUID));
+    }
+
+    return returnValue;
+}
+
+static
+LONG
+String_ListIndexSortCompare(
+    _In_ String_ListIndexHeader* ListIndexHeader,
+    _In_ ULONG EntryIndex1,
+    _In_ ULONG EntryIndex2
+    )
+/*++
+
+Routine Description:
+
+    Ordering used to sort a List Index. Equal entries are ordered by their position in the
+    Client's list so that searches return the same index as the linear search Methods.
+
+Arguments:
+
+    ListIndexHeader - The List Index that refers to the Client's list.
+    EntryIndex1 - Index of the first entry in the Client's list.
+    EntryIndex2 - Index of the second entry in the Client's list.
+
+Return Value:
+
+    < 0, 0 or > 0 as the first entry comes before, is the same as or comes after the second entry.
+
+--*/
+{
+    LONG returnValue;
+    VOID* entry2;
+
+    if (ListIndexHeader->ListIndexType == String_ListIndexType_Char)
+    {
+        entry2 = ListIndexHeader->List.StringList[EntryIndex2];
+    }
+    else
+    {
+        entry2 = &ListIndexHeader->List.GuidList[EntryIndex2];
+    }
+
+    returnValue = String_ListIndexEntryCompare(ListIndexHeader,
+                                               EntryIndex1,
+                                               entry2);
+    if (0 == returnValue)
+    {
+        returnValue = (EntryIndex1 < EntryIndex2) ? -1 : ((EntryIndex1 > EntryIndex2) ? 1 : 0);
+    }
+
+    return returnValue;
+}
+
+static
+VOID
+String_ListIndexSiftDown(
+    _In_ String_ListIndexHeader* ListIndexHeader,
+    _Inout_updates_(NumberOfEntries) ULONG* SortedIndexes,
+    _In_ ULONG Root,
+    _In_ ULONG NumberOfEntries
+    )
+/*++
+
+Routine Description:
+
+    Restore the max-heap property of the sub-tree at Root. Used by String_ListIndexSort().
+
+Arguments:
+
+    ListIndexHeader - The List Index that refers to the Client's list.
+    SortedIndexes - The array of indexes being sorted.
+    Root - Root of the sub-tree.
+    NumberOfEntries - Number of entries in the heap.
+
+Return Value:
+
+    None
+
+--*/
+{
+    ULONG child;
+    ULONG temporary;
+
+    while ((child = (2 * Root) + 1) < NumberOfEntries)
+    {
+        if ((child + 1 < NumberOfEntries) &&
+            (String_ListIndexSortCompare(ListIndexHeader,
+                                         SortedIndexes[child],
+                                         SortedIndexes[child + 1]) < 0))
+        {
+            child++;
+        }
+
+        if (String_ListIndexSortCompare(ListIndexHeader,
+                                        SortedIndexes[Root],
+                                        SortedIndexes[child]) >= 0)
+        {
+            break;
+        }
+
+        temporary = SortedIndexes[Root];
+        SortedIndexes[Root] = SortedIndexes[child];
+        SortedIndexes[child] = temporary;
+        Root = child;
+    }
+}
+
+static
+VOID
+String_ListIndexSort(
+    _In_ String_ListIndexHeader* ListIndexHeader,
+    _Out_writes_(ListIndexHeader->NumberOfEntries) ULONG* SortedIndexes
+    )
+/*++
+
+Routine Description:
+
+    Build the sorted array of indexes of a List Index. Heap sort is used because it
+    needs no additional memory and has no quadratic worst case.
+
+Arguments:
+
+    ListIndexHeader - The List Index that refers to the Client's list.
+    SortedIndexes - The array of indexes to populate.
+
+Return Value:
+
+    None
+
+--*/
+{
+    ULONG numberOfEntries;
+    ULONG entryIndex;
+    ULONG temporary;
+
+    numberOfEntries = ListIndexHeader->NumberOfEntries;
+
+    for (entryIndex = 0; entryIndex < numberOfEntries; entryIndex++)
+    {
+        SortedIndexes[entryIndex] = entryIndex;
+    }
+
+    for (entryIndex = numberOfEntries / 2; entryIndex > 0; entryIndex--)
+    {
+        String_ListIndexSiftDown(ListIndexHeader,
+                                 SortedIndexes,
+                                 entryIndex - 1,
+                                 numberOfEntries);
+    }
+
+    for (entryIndex = numberOfEntries; entryIndex > 1; entryIndex--)
+    {
+        temporary = SortedIndexes[0];
+        SortedIndexes[0] = SortedIndexes[entryIndex - 1];
+        SortedIndexes[entryIndex - 1] = temporary;
+        String_ListIndexSiftDown(ListIndexHeader,
+                                 SortedIndexes,
+                                 0,
+                                 entryIndex - 1);
+    }
+}
+
+static
+String_ListIndexHeader*
+String_ListIndexHeaderGet(
+    _In_ WDFMEMORY ListIndex,
+    _In_ String_ListIndexType ListIndexType,
+    _Out_ ULONG** SortedIndexes
+    )
+/*++
+
+Routine Description:
+
+    Retrieve the header and the sorted array of indexes from a given List Index.
+
+Arguments:
+
+    ListIndex - The given List Index.
+    ListIndexType - The type of List Index the caller expects.
+    SortedIndexes - Returns the sorted array of indexes.
+
+Return Value:
+
+    The header of the List Index.
+
+--*/
+{
+    String_ListIndexHeader* listIndexHeader;
+
+    UNREFERENCED_PARAMETER(ListIndexType);
+
+    DmfAssert(ListIndex != NULL);
+
+    listIndexHeader = (String_ListIndexHeader*)WdfMemoryGetBuffer(ListIndex,
+                                                                  NULL);
+    DmfAssert(listIndexHeader->ListIndexType == ListIndexType);
+    *SortedIndexes = (ULONG*)(listIndexHeader + 1);
+
+    return listIndexHeader;
+}
+
+static
+ULONG
+String_ListIndexLowerBound(
+    _In_ String_ListIndexHeader* ListIndexHeader,
+    _In_reads_(ListIndexHeader->NumberOfEntries) ULONG* SortedIndexes,
+    _In_ VOID* LookFor
+    )
+/*++
+
+Routine Description:
+
+    Binary search for the first position in the sorted array of indexes whose entry
+    does not come before the given element.
+
+Arguments:
+
+    ListIndexHeader - The List Index that refers to the Client's list.
+    SortedIndexes - The sorted array of indexes.
+    LookFor - The given element (CHAR* or GUID*).
+
+Return Value:
+
+    Position in SortedIndexes. NumberOfEntries if all entries come before the given element.
+
+--*/
+{
+    ULONG low;
+    ULONG high;
+    ULONG middle;
+
+    low = 0;
+    high = ListIndexHeader->NumberOfEntries;
+
+    while (low < high)
+    {
+        middle = low + ((high - low) / 2);
+        if (String_ListIndexEntryCompare(ListIndexHeader,
+                                         SortedIndexes[middle],
+                                         LookFor) < 0)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+
+    return low;
+}
+
+#pragma code_seg("PAGE")
+_IRQL_requires_max_(PASSIVE_LEVEL)
+_Must_inspect_result_
+static
+NTSTATUS
+String_ListIndexCreate(
+    _In_ DMFMODULE DmfModule,
+    _In_ String_ListIndexType ListIndexType,
+    _In_ VOID* List,
+    _In_ ULONG NumberOfEntries,
+    _Out_ WDFMEMORY* ListIndex
+    )
+/*++
+
+Routine Description:
+
+    Allocate and populate a List Index over a given list of strings or GUIDs.
+
+Arguments:
+
+    DmfModule - This Module's handle.
+    ListIndexType - Indicates the type of entries in List.
+    List - The Client's list.
+    NumberOfEntries - Number of entries in List.
+    ListIndex - Returns the created List Index.
+
+Return Value:
+
+    NTSTATUS
+
+--*/
+{
+    NTSTATUS ntStatus;
+    WDF_OBJECT_ATTRIBUTES objectAttributes;
+    WDFMEMORY listIndexMemory;
+    String_ListIndexHeader* listIndexHeader;
+    size_t sizeToAllocate;
+
+    PAGED_CODE();
+
+    FuncEntry(DMF_TRACE);
+
+    *ListIndex = NULL;
+
+    // Methods return the index of the matching entry as a LONG.
+    //
+    if ((NumberOfEntries > MAXLONG) ||
+        (NumberOfEntries > (MAXULONG - sizeof(String_ListIndexHeader)) / sizeof(ULONG)))
+    {
+        ntStatus = STATUS_INVALID_PARAMETER;
+        TraceEvents(TRACE_LEVEL_ERROR, DMF_TRACE, "Invalid NumberOfEntries=%u", NumberOfEntries);
+        goto Exit;
+    }
+
+    sizeToAllocate = sizeof(String_ListIndexHeader) + (NumberOfEntries * sizeof(ULONG));
+
+    WDF_OBJECT_ATTRIBUTES_INIT(&objectAttributes);
+    objectAttributes.ParentObject = DmfModule;
+    ntStatus = WdfMemoryCreate(&objectAttributes,
+                               NonPagedPoolNx,
+                               MemoryTag,
+                               sizeToAllocate,
+                               &listIndexMemory,
+                               (VOID**)&listIndexHeader);
+    if (! NT_SUCCESS(ntStatus))
+    {
+        TraceEvents(TRACE_LEVEL_ERROR, DMF_TRACE, "WdfMemoryCreate fails: ntStatus=%!STATUS!", ntStatus);
+        goto Exit;
+    }
+
+    listIndexHeader->ListIndexType = ListIndexType;
+    listIndexHeader->NumberOfEntries = NumberOfEntries;
+    if (ListIndexType == String_ListIndexType_Char)
+    {
+        listIndexHeader->List.StringList = (CHAR**)List;
+    }
+    else
+    {
+        listIndexHeader->List.GuidList = (GUID*)List;
+    }
+
+    String_ListIndexSort(listIndexHeader,
+                         (ULONG*)(listIndexHeader + 1));
+
+    *ListIndex = listIndexMemory;
+
+Exit:
+
+    FuncExit(DMF_TRACE, "ntStatus=%!STATUS!", ntStatus);
+
+    return ntStatus;
+}
+#pragma code_seg()
+
 #if defined(DMF_USER_MODE)
 
 static
@@ -795,6 +1209,356 @@ Return Value:
                                      String_FindInListLeftLookForMatchCharCallback);
 }
 
+#pragma code_seg("PAGE")
+_IRQL_requires_max_(PASSIVE_LEVEL)
+_Must_inspect_result_
+NTSTATUS
+DMF_String_ListIndexCreateChar(
+    _In_ DMFMODULE DmfModule,
+    _In_reads_(NumberOfStringsInStringList) CHAR** StringList,
+    _In_ ULONG NumberOfStringsInStringList,
+    _Out_ WDFMEMORY* ListIndex
+    )
+/*++
+
+Routine Description:
+
+    Build an immutable index over a given list of strings so that the list can be
+    searched in logarithmic time using DMF_String_ListIndexFind*Char Methods.
+
+Arguments:
+
+    DmfModule - This Module's handle.
+    StringList - List of strings to index. It is not copied and must remain valid (and unchanged)
+                 until the List Index is destroyed.
+    NumberOfStringsInStringList - Number of strings in StringList.
+    ListIndex - Returns the created List Index.
+
+Return Value:
+
+    NTSTATUS
+
+--*/
+{
+    NTSTATUS ntStatus;
+
+    PAGED_CODE();
+
+    DMFMODULE_VALIDATE_IN_METHOD(DmfModule,
+                                 String);
+
+    DmfAssert(StringList != NULL);
+    DmfAssert(ListIndex != NULL);
+
+    for (ULONG stringIndex = 0; stringIndex < NumberOfStringsInStringList; stringIndex++)
+    {
+        DmfAssert(StringList[stringIndex] != NULL);
+    }
+
+    ntStatus = String_ListIndexCreate(DmfModule,
+                                      String_ListIndexType_Char,
+                                      StringList,
+                                      NumberOfStringsInStringList,
+                                      ListIndex);
+
+    return ntStatus;
+}
+#pragma code_seg()
+
+#pragma code_seg("PAGE")
+_IRQL_requires_max_(PASSIVE_LEVEL)
+_Must_inspect_result_
+NTSTATUS
+DMF_String_ListIndexCreateGuid(
+    _In_ DMFMODULE DmfModule,
+    _In_reads_(NumberOfGuidsInGuidList) GUID* GuidList,
+    _In_ ULONG NumberOfGuidsInGuidList,
+    _Out_ WDFMEMORY* ListIndex
+    )
+/*++
+
+Routine Description:
+
+    Build an immutable index over a given list of GUIDs so that the list can be
+    searched in logarithmic time using DMF_String_ListIndexFindExactGuid.
+
+Arguments:
+
+    DmfModule - This Module's handle.
+    GuidList - List of GUIDs to index. It is not copied and must remain valid (and unchanged)
+               until the List Index is destroyed.
+    NumberOfGuidsInGuidList - Number of GUIDs in GuidList.
+    ListIndex - Returns the created List Index.
+
+Return Value:
+
+    NTSTATUS
+
+--*/
+{
+    NTSTATUS ntStatus;
+
+    PAGED_CODE();
+
+    DMFMODULE_VALIDATE_IN_METHOD(DmfModule,
+                                 String);
+
+    DmfAssert(GuidList != NULL);
+    DmfAssert(ListIndex != NULL);
+
+    ntStatus = String_ListIndexCreate(DmfModule,
+                                      String_ListIndexType_Guid,
+                                      GuidList,
+                                      NumberOfGuidsInGuidList,
+                                      ListIndex);
+
+    return ntStatus;
+}
+#pragma code_seg()
+
+#pragma code_seg("PAGE")
+_IRQL_requires_max_(PASSIVE_LEVEL)
+VOID
+DMF_String_ListIndexDestroy(
+    _In_ DMFMODULE DmfModule,
+    _In_ WDFMEMORY ListIndex
+    )
+/*++
+
+Routine Description:
+
+    Destroy a List Index created by DMF_String_ListIndexCreate*. List Indexes that are not
+    destroyed by the Client are destroyed when this Module is destroyed.
+
+Arguments:
+
+    DmfModule - This Module's handle.
+    ListIndex - The List Index to destroy.
+
+Return Value:
+
+    None
+
+--*/
+{
+    PAGED_CODE();
+
+    DMFMODULE_VALIDATE_IN_METHOD(DmfModule,
+                                 String);
+
+    DmfAssert(ListIndex != NULL);
+
+    WdfObjectDelete(ListIndex);
+}
+#pragma code_seg()
+
+_Must_inspect_result_
+LONG
+DMF_String_ListIndexFindExactChar(
+    _In_ DMFMODULE DmfModule,
+    _In_ WDFMEMORY ListIndex,
+    _In_z_ CHAR* LookFor
+    )
+/*++
+
+Routine Description:
+
+    Given a List Index of strings, find a given string using an exact match.
+    The result is the same as DMF_String_FindInListExactChar() on the indexed list.
+
+Arguments:
+
+    DmfModule - This Module's handle.
+    ListIndex - List Index created by DMF_String_ListIndexCreateChar().
+    LookFor - String to look for.
+
+Return Value:
+
+    -1 - LookFor is not found in the indexed list.
+    non-negative: Index of string in the indexed list that matches LookFor.
+
+--*/
+{
+    LONG returnValue;
+    String_ListIndexHeader* listIndexHeader;
+    ULONG* sortedIndexes;
+    ULONG position;
+
+    DMFMODULE_VALIDATE_IN_METHOD(DmfModule,
+                                 String);
+
+    DmfAssert(LookFor != NULL);
+
+    listIndexHeader = String_ListIndexHeaderGet(ListIndex,
+                                                String_ListIndexType_Char,
+                                                &sortedIndexes);
+
+    // -1 indicates "not found in list".
+    //
+    returnValue = -1;
+
+    // Equal strings are sorted by their index in the list so the first one is the lowest index.
+    //
+    position = String_ListIndexLowerBound(listIndexHeader,
+                                          sortedIndexes,
+                                          LookFor);
+    if ((position < listIndexHeader->NumberOfEntries) &&
+        (String_ListIndexEntryCompare(listIndexHeader,
+                                      sortedIndexes[position],
+                                      LookFor) == 0))
+    {
+        returnValue = (LONG)sortedIndexes[position];
+    }
+
+    TraceEvents(TRACE_LEVEL_VERBOSE, DMF_TRACE, "LookFor=[%s] returnValue=%d", LookFor, returnValue);
+
+    return returnValue;
+}
+
+_Must_inspect_result_
+LONG
+DMF_String_ListIndexFindExactGuid(
+    _In_ DMFMODULE DmfModule,
+    _In_ WDFMEMORY ListIndex,
+    _In_ GUID* LookFor
+    )
+/*++
+
+Routine Description:
+
+    Given a List Index of GUIDs, find the index of a given GUID.
+    The result is the same as DMF_String_FindInListExactGuid() on the indexed list.
+
+Arguments:
+
+    DmfModule - This Module's handle.
+    ListIndex - List Index created by DMF_String_ListIndexCreateGuid().
+    LookFor - GUID to look for.
+
+Return Value:
+
+    -1 - LookFor is not found in the indexed list.
+    non-negative: Index of GUID in the indexed list that matches LookFor.
+
+--*/
+{
+    LONG returnValue;
+    String_ListIndexHeader* listIndexHeader;
+    ULONG* sortedIndexes;
+    ULONG position;
+
+    DMFMODULE_VALIDATE_IN_METHOD(DmfModule,
+                                 String);
+
+    DmfAssert(LookFor != NULL);
+
+    listIndexHeader = String_ListIndexHeaderGet(ListIndex,
+                                                String_ListIndexType_Guid,
+                                                &sortedIndexes);
+
+    // -1 indicates "not found in list".
+    //
+    returnValue = -1;
+
+    position = String_ListIndexLowerBound(listIndexHeader,
+                                          sortedIndexes,
+                                          LookFor);
+    if ((position < listIndexHeader->NumberOfEntries) &&
+        (String_ListIndexEntryCompare(listIndexHeader,
+                                      sortedIndexes[position],
+                                      LookFor) == 0))
+    {
+        returnValue = (LONG)sortedIndexes[position];
+    }
+
+    return returnValue;
+}
+
+_Must_inspect_result_
+LONG
+DMF_String_ListIndexFindLookForLeftMatchChar(
+    _In_ DMFMODULE DmfModule,
+    _In_ WDFMEMORY ListIndex,
+    _In_z_ CHAR* LookFor
+    )
+/*++
+
+Routine Description:
+
+    Given a List Index of strings, find a string in the list whose left side matches
+    the full given string. The result is the same as DMF_String_FindInListLookForLeftMatchChar()
+    on the indexed list.
+
+Arguments:
+
+    DmfModule - This Module's handle.
+    ListIndex - List Index created by DMF_String_ListIndexCreateChar().
+    LookFor - String to look for.
+
+Return Value:
+
+    -1 - LookFor is not found in the indexed list.
+    non-negative: Index of string in the indexed list that matches LookFor.
+
+--*/
+{
+    LONG returnValue;
+    String_ListIndexHeader* listIndexHeader;
+    ULONG* sortedIndexes;
+    ULONG position;
+    size_t comparisonLength;
+
+    DMFMODULE_VALIDATE_IN_METHOD(DmfModule,
+                                 String);
+
+    DmfAssert(LookFor != NULL);
+
+    comparisonLength = strlen(LookFor);
+    if (0 == comparisonLength)
+    {
+        // An empty string only matches empty strings. (See String_FindInListLeftLookForMatchCharCallback().)
+        //
+        returnValue = DMF_String_ListIndexFindExactChar(DmfModule,
+                                                        ListIndex,
+                                                        LookFor);
+        goto Exit;
+    }
+
+    listIndexHeader = String_ListIndexHeaderGet(ListIndex,
+                                                String_ListIndexType_Char,
+                                                &sortedIndexes);
+
+    // -1 indicates "not found in list".
+    //
+    returnValue = -1;
+
+    // All the strings that start with LookFor are adjacent in the sorted array starting
+    // at the first string that is not less than LookFor. Return the lowest list index among
+    // them so that the result matches the linear search.
+    //
+    position = String_ListIndexLowerBound(listIndexHeader,
+                                          sortedIndexes,
+                                          LookFor);
+    while ((position < listIndexHeader->NumberOfEntries) &&
+           (strncmp(listIndexHeader->List.StringList[sortedIndexes[position]],
+                    LookFor,
+                    comparisonLength) == 0))
+    {
+        if ((returnValue == -1) ||
+            ((LONG)sortedIndexes[position] < returnValue))
+        {
+            returnValue = (LONG)sortedIndexes[position];
+        }
+        position++;
+    }
+
+    TraceEvents(TRACE_LEVEL_VERBOSE, DMF_TRACE, "LookFor=[%s] returnValue=%d", LookFor, returnValue);
+
+Exit:
+
+    return returnValue;
+}
+
 #pragma code_seg("PAGE")
 _Must_inspect_result_
 NTSTATUS
@@ -149,6 +149,57 @@ DMF_String_FindInListLookForLeftMatchChar(
     _In_z_ CHAR* LookFor
     );
 
+_IRQL_requires_max_(PASSIVE_LEVEL)
+_Must_inspect_result_
+NTSTATUS
+DMF_String_ListIndexCreateChar(
+    _In_ DMFMODULE DmfModule,
+    _In_reads_(NumberOfStringsInStringList) CHAR** StringList,
+    _In_ ULONG NumberOfStringsInStringList,
+    _Out_ WDFMEMORY* ListIndex
+    );
+
+_IRQL_requires_max_(PASSIVE_LEVEL)
+_Must_inspect_result_
+NTSTATUS
+DMF_String_ListIndexCreateGuid(
+    _In_ DMFMODULE DmfModule,
+    _In_reads_(NumberOfGuidsInGuidList) GUID* GuidList,
+    _In_ ULONG NumberOfGuidsInGuidList,
+    _Out_ WDFMEMORY* ListIndex
+    );
+
+_IRQL_requires_max_(PASSIVE_LEVEL)
+VOID
+DMF_String_ListIndexDestroy(
+    _In_ DMFMODULE DmfModule,
+    _In_ WDFMEMORY ListIndex
+    );
+
+_Must_inspect_result_
+LONG
+DMF_String_ListIndexFindExactChar(
+    _In_ DMFMODULE DmfModule,
+    _In_ WDFMEMORY ListIndex,
+    _In_z_ CHAR* LookFor
+    );
+
+_Must_inspect_result_
+LONG
+DMF_String_ListIndexFindExactGuid(
+    _In_ DMFMODULE DmfModule,
+    _In_ WDFMEMORY ListIndex,
+    _In_ GUID* LookFor
+    );
+
+_Must_inspect_result_
+LONG
+DMF_String_ListIndexFindLookForLeftMatchChar(
+    _In_ DMFMODULE DmfModule,
+    _In_ WDFMEMORY ListIndex,
+    _In_z_ CHAR* LookFor
+    );
+
 _Must_inspect_result_
 NTSTATUS
 DMF_String_MultiSzEnumerate(
@@ -43,6 +43,31 @@ typedef struct _DMF_CONTEXT_UefiLogs
     // QueuedWorkItem
     //
     DMFMODULE DmfModuleQueuedWorkItem;
+
+    // Identifies the log that was parsed last (LogBuffer and TicksAtTime of its header).
+    // A different log (for example, after a reboot) is parsed from the start.
+    //
+    UINT64 ParsedLogBuffer;
+    UINT64 ParsedLogTicksAtTime;
+    // Offset in the log of the first message entry that has not been parsed yet.
+    //
+    size_t ParsedOffset;
+    // Parsed log that is written to the file. It keeps the lines of all the
+    // retrievals of the current log so that only new entries are parsed.
+    //
+    WDFMEMORY ParsedLogMemory;
+    UCHAR* ParsedLog;
+    size_t ParsedLogSize;
+    size_t ParsedLogLength;
+    // Buffer where a single line is assembled.
+    //
+    WDFMEMORY LineMemory;
+    UCHAR* Line;
+    // Lines waiting to be written to the event log as a single entry.
+    //
+    WDFMEMORY BatchMemory;
+    UCHAR* Batch;
+    size_t BatchLength;
 } DMF_CONTEXT_UefiLogs;
 
 // This macro declares the following function:
@@ -460,6 +485,480 @@ Exit:
 }
 #pragma code_seg()
 
+// Signature of the function the parser calls for each complete line.
+//
+typedef
+_IRQL_requires_max_(PASSIVE_LEVEL)
+_Must_inspect_result_
+NTSTATUS
+UefiLogs_LineProcess(
+    _In_ VOID* LineProcessContext,
+    _In_reads_(LineSize) UCHAR* Line,
+    _In_ size_t LineSize,
+    _In_ BOOLEAN LineIsEmpty
+    );
+
+// State of the parser for a single log blob.
+// The parser only touches memory referenced by this structure, so it can be
+// driven with captured logs outside of a driver.
+//
+typedef struct
+{
+    // Only used for tracing.
+    //
+    DMFMODULE DmfModule;
+    // UEFI logs header structure.
+    //
+    ADVANCED_LOGGER_INFO_V2* LoggerInfo;
+    // The log blob and its size.
+    //
+    UCHAR* Log;
+    size_t LogSize;
+    // Offset in Log of the first message entry that is not part of a complete line.
+    // Updated by the parser.
+    //
+    size_t Offset;
+    // Zeroed buffer where a line is assembled. It must be at least
+    // LineBufferSize plus a null terminator in size.
+    //
+    UCHAR* LineBuffer;
+    size_t LineBufferSize;
+    // Called for each complete line.
+    //
+    UefiLogs_LineProcess* LineProcess;
+    VOID* LineProcessContext;
+} UefiLogs_PARSER;
+
+// Bytes available for a single line (excluding null terminator).
+//
+#define UefiLogs_LineBufferSize                 ((DMF_EVENTLOG_MAXIMUM_LENGTH_OF_STRING * sizeof(WCHAR)) + sizeof(L"\0"))
+// Number of characters that are sent in a single event log entry (excluding null terminator).
+//
+#define UefiLogs_BatchBufferSize                (DMF_EVENTLOG_MAXIMUM_LENGTH_OF_STRING)
+// Maximum size of the "NVRAM Log Time" line written at the start of each log.
+//
+#define UefiLogs_LogTimeLineSizeMaximum         (64)
+
+#pragma code_seg("PAGE")
+_IRQL_requires_max_(PASSIVE_LEVEL)
+_Must_inspect_result_
+NTSTATUS
+UefiLogs_EntriesParse(
+    _Inout_ UefiLogs_PARSER* Parser
+    )
+/*++
+
+Routine Description:
+
+    Parse the message entries of a log blob starting at Parser->Offset. Message entries are
+    assembled into lines that are passed to the Parser's LineProcess callback. On return,
+    Parser->Offset is the offset of the first entry that is not part of a complete line so
+    that the next call only parses entries added since this call.
+
+Arguments:
+
+    Parser - State of the parser.
+
+Return Value:
+
+    STATUS_SUCCESS if all complete lines were passed to LineProcess.
+    Otherwise, the status returned by LineProcess.
+
+--*/
+{
+    NTSTATUS ntStatus;
+    size_t entryOffset;
+    size_t nextEntryOffset;
+    ADVANCED_LOGGER_MESSAGE_ENTRY* loggerMessageEntry;
+    UCHAR* messageText;
+    UCHAR* lineHead;
+    size_t lineSize;
+    size_t timeStampSize;
+
+    PAGED_CODE();
+
+    FuncEntry(DMF_TRACE);
+
+    ntStatus = STATUS_SUCCESS;
+    entryOffset = Parser->Offset;
+    lineHead = Parser->LineBuffer;
+    lineSize = 0;
+    timeStampSize = 0;
+
+    while (entryOffset + sizeof(ADVANCED_LOGGER_MESSAGE_ENTRY) <= Parser->LogSize)
+    {
+        loggerMessageEntry = (ADVANCED_LOGGER_MESSAGE_ENTRY*)(Parser->Log + entryOffset);
+        // Message is located at the end of the loggerMessageEntry.
+        //
+        messageText = (UCHAR*)loggerMessageEntry + sizeof(ADVANCED_LOGGER_MESSAGE_ENTRY);
+        if (loggerMessageEntry->Signature != LOGGER_MESSAGE_ENTRY_SIGNATURE)
+        {
+            // End of the entries written so far.
+            //
+            TraceEvents(TRACE_LEVEL_VERBOSE, DMF_TRACE, "Unknown NVRAM Log signature");
+            break;
+        }
+
+        nextEntryOffset = entryOffset + sizeof(ADVANCED_LOGGER_MESSAGE_ENTRY) + loggerMessageEntry->MessageLengthBytes;
+        if (nextEntryOffset > Parser->LogSize)
+        {
+            // The entry is still being written or is corrupt.
+            //
+            break;
+        }
+
+        // Ensure 8 byte alignment of the next entry.
+        //
+        nextEntryOffset = ((nextEntryOffset + 7) / 8) * 8;
+
+        if (loggerMessageEntry->MessageLengthBytes == 0)
+        {
+            entryOffset = nextEntryOffset;
+            continue;
+        }
+
+        // Add timestamp to line if this is the start of the line.
+        //
+        if (lineSize == 0)
+        {
+            UefiLogs_BufferTimeAppend(Parser->DmfModule,
+                                      Parser->LoggerInfo,
+                                      loggerMessageEntry,
+                                      lineHead,
+                                      Parser->LineBufferSize,
+                                      &timeStampSize);
+            lineHead += timeStampSize;
+            lineSize += timeStampSize;
+        }
+
+        // Add message to line.
+        //
+        if (lineHead + loggerMessageEntry->MessageLengthBytes <= Parser->LineBuffer + Parser->LineBufferSize)
+        {
+            RtlCopyMemory(lineHead,
+                          messageText,
+                          loggerMessageEntry->MessageLengthBytes);
+        }
+        else
+        {
+            // The payload of the message is too long.
+            //
+            DmfAssert(FALSE);
+            // Cannot trust the rest of the data. Exit now.
+            //
+            break;
+        }
+
+        // Move the line head to last character of the string which was just extracted
+        // to check if it is end of line.
+        //
+        lineHead += loggerMessageEntry->MessageLengthBytes - 1;
+        lineSize += loggerMessageEntry->MessageLengthBytes;
+
+        // Check if last character is ASCII end of line.
+        //
+        if (*lineHead == CARRIAGE_RETURN)
+        {
+            // Empty lines in UEFI logs have 2 characters, return carriage and newline.
+            //
+            ntStatus = Parser->LineProcess(Parser->LineProcessContext,
+                                           Parser->LineBuffer,
+                                           lineSize,
+                                           (lineSize <= timeStampSize + sizeof('\n') + sizeof('\r')));
+
+            // Clear out the line.
+            //
+            RtlZeroMemory(Parser->LineBuffer,
+                          lineSize);
+
+            // Set head back to start.
+            //
+            lineHead = Parser->LineBuffer;
+            lineSize = 0;
+            timeStampSize = 0;
+
+            if (!NT_SUCCESS(ntStatus))
+            {
+                // This line is parsed again next time.
+                //
+                break;
+            }
+
+            // All entries up to here have been consumed.
+            //
+            Parser->Offset = nextEntryOffset;
+        }
+        else
+        {
+            // Move head forward for next copy.
+            //
+            lineHead += 1;
+        }
+
+        entryOffset = nextEntryOffset;
+    }
+
+    // A partial line at the end of the log is parsed again when the rest of it is available.
+    //
+    RtlZeroMemory(Parser->LineBuffer,
+                  lineSize);
+
+    FuncExit(DMF_TRACE, "ntStatus=%!STATUS!", ntStatus);
+
+    return ntStatus;
+}
+#pragma code_seg()
+
+#pragma code_seg("PAGE")
+_IRQL_requires_max_(PASSIVE_LEVEL)
+VOID
+UefiLogs_BatchFlush(
+    _In_ DMFMODULE DmfModule
+    )
+/*++
+
+Routine Description:
+
+    Send all the lines accumulated in the batch buffer as a single event log entry.
+
+Arguments:
+
+    DmfModule - This Module's handle.
+
+Return Value:
+
+    None
+
+--*/
+{
+    DMF_CONTEXT_UefiLogs* moduleContext;
+
+    PAGED_CODE();
+
+    moduleContext = DMF_CONTEXT_GET(DmfModule);
+
+    if (moduleContext->BatchLength > 0)
+    {
+        DMF_Utility_LogEmitString(DmfModule,
+                                  DmfLogDataSeverity_Informational,
+                                  L"%S",
+                                  moduleContext->Batch);
+        moduleContext->BatchLength = 0;
+        moduleContext->Batch[0] = '\0';
+    }
+}
+#pragma code_seg()
+
+#pragma code_seg("PAGE")
+_IRQL_requires_max_(PASSIVE_LEVEL)
+VOID
+UefiLogs_BatchAppend(
+    _In_ DMFMODULE DmfModule,
+    _In_reads_(LineSize) UCHAR* Line,
+    _In_ size_t LineSize
+    )
+/*++
+
+Routine Description:
+
+    Add a null-terminated line to the batch buffer. The batch is sent to the event log
+    when the line does not fit. Lines that never fit are sent on their own.
+
+Arguments:
+
+    DmfModule - This Module's handle.
+    Line - The line to add.
+    LineSize - Number of characters in Line (excluding null terminator).
+
+Return Value:
+
+    None
+
+--*/
+{
+    DMF_CONTEXT_UefiLogs* moduleContext;
+
+    PAGED_CODE();
+
+    moduleContext = DMF_CONTEXT_GET(DmfModule);
+
+    if (moduleContext->BatchLength + LineSize > UefiLogs_BatchBufferSize)
+    {
+        UefiLogs_BatchFlush(DmfModule);
+    }
+
+    if (LineSize > UefiLogs_BatchBufferSize)
+    {
+        DMF_Utility_LogEmitString(DmfModule,
+                                  DmfLogDataSeverity_Informational,
+                                  L"%S",
+                                  Line);
+    }
+    else
+    {
+        RtlCopyMemory(moduleContext->Batch + moduleContext->BatchLength,
+                      Line,
+                      LineSize);
+        moduleContext->BatchLength += LineSize;
+        moduleContext->Batch[moduleContext->BatchLength] = '\0';
+    }
+}
+#pragma code_seg()
+
+#pragma code_seg("PAGE")
+_Function_class_(UefiLogs_LineProcess)
+_IRQL_requires_max_(PASSIVE_LEVEL)
+_Must_inspect_result_
+NTSTATUS
+UefiLogs_LineStore(
+    _In_ VOID* LineProcessContext,
+    _In_reads_(LineSize) UCHAR* Line,
+    _In_ size_t LineSize,
+    _In_ BOOLEAN LineIsEmpty
+    )
+/*++
+
+Routine Description:
+
+    Add a line parsed from the UEFI logs to the parsed log and (if it is not empty) to the
+    event log batch.
+
+Arguments:
+
+    LineProcessContext - This Module's handle.
+    Line - Null-terminated line.
+    LineSize - Number of characters in Line (excluding null terminator).
+    LineIsEmpty - TRUE if the line only has a timestamp.
+
+Return Value:
+
+    NTSTATUS
+
+--*/
+{
+    DMFMODULE dmfModule;
+    DMF_CONTEXT_UefiLogs* moduleContext;
+    NTSTATUS ntStatus;
+
+    PAGED_CODE();
+
+    dmfModule = (DMFMODULE)LineProcessContext;
+    moduleContext = DMF_CONTEXT_GET(dmfModule);
+
+    // Copy the line to parsed buffer.
+    //
+    if (moduleContext->ParsedLogLength + LineSize > moduleContext->ParsedLogSize)
+    {
+        // Data won't fit into target buffer to write to file.
+        // The line is parsed again during the next retrieval.
+        //
+        TraceEvents(TRACE_LEVEL_WARNING, DMF_TRACE, "Parsed log is full");
+        ntStatus = STATUS_BUFFER_TOO_SMALL;
+        goto Exit;
+    }
+
+    // 'Possibly incorrect single element annotation on buffer'
+    //
+    #pragma warning(suppress: 26007)
+    RtlCopyMemory(moduleContext->ParsedLog + moduleContext->ParsedLogLength,
+                  Line,
+                  LineSize);
+    moduleContext->ParsedLogLength += LineSize;
+
+    // Send line out as ETW event (if it is not an empty line).
+    //
+    if (! LineIsEmpty)
+    {
+        UefiLogs_BatchAppend(dmfModule,
+                             Line,
+                             LineSize);
+    }
+
+    ntStatus = STATUS_SUCCESS;
+
+Exit:
+
+    return ntStatus;
+}
+#pragma code_seg()
+
+#pragma code_seg("PAGE")
+_IRQL_requires_max_(PASSIVE_LEVEL)
+_Must_inspect_result_
+NTSTATUS
+UefiLogs_ParsedLogReserve(
+    _In_ DMFMODULE DmfModule,
+    _In_ size_t BytesRequired
+    )
+/*++
+
+Routine Description:
+
+    Make sure the parsed log buffer has room for BytesRequired more bytes. The buffer is
+    only reallocated when it is too small. Its current contents are preserved.
+
+Arguments:
+
+    DmfModule - This Module's handle.
+    BytesRequired - Number of bytes that will be added to the parsed log.
+
+Return Value:
+
+    NTSTATUS
+
+--*/
+{
+    NTSTATUS ntStatus;
+    DMF_CONTEXT_UefiLogs* moduleContext;
+    WDF_OBJECT_ATTRIBUTES objectAttributes;
+    WDFMEMORY parsedLogMemory;
+    UCHAR* parsedLog;
+    size_t parsedLogSize;
+
+    PAGED_CODE();
+
+    moduleContext = DMF_CONTEXT_GET(DmfModule);
+
+    if (moduleContext->ParsedLogSize - moduleContext->ParsedLogLength >= BytesRequired)
+    {
+        ntStatus = STATUS_SUCCESS;
+        goto Exit;
+    }
+
+    parsedLogSize = moduleContext->ParsedLogLength + BytesRequired;
+
+    WDF_OBJECT_ATTRIBUTES_INIT(&objectAttributes);
+    objectAttributes.ParentObject = DmfModule;
+    ntStatus = WdfMemoryCreate(&objectAttributes,
+                               PagedPool,
+                               MemoryTag,
+                               parsedLogSize,
+                               &parsedLogMemory,
+                               (VOID**)&parsedLog);
+    if (!NT_SUCCESS(ntStatus))
+    {
+        TraceEvents(TRACE_LEVEL_WARNING, DMF_TRACE, "WdfMemoryCreate fails: ntStatus=%!STATUS!", ntStatus);
+        goto Exit;
+    }
+
+    if (moduleContext->ParsedLogMemory != NULL)
+    {
+        RtlCopyMemory(parsedLog,
+                      moduleContext->ParsedLog,
+                      moduleContext->ParsedLogLength);
+        WdfObjectDelete(moduleContext->ParsedLogMemory);
+    }
+
+    moduleContext->ParsedLogMemory = parsedLogMemory;
+    moduleContext->ParsedLog = parsedLog;
+    moduleContext->ParsedLogSize = parsedLogSize;
+
+Exit:
+
+    return ntStatus;
+}
+#pragma code_seg()
+
 #pragma code_seg("PAGE")
 _Function_class_(EVT_DMF_QueuedWorkItem_Callback)
 ScheduledTask_Result_Type
@@ -473,6 +972,7 @@ UefiLogs_Retrieve_QueuedWorkItemCallback(
 Routine Description:
 
     Retrieve logs from UEFI and store them as file and ETW events.
+    Only entries that were not parsed during a previous retrieval of the same log are parsed.
 
 Arguments:
 
@@ -487,27 +987,17 @@ Return Value:
     DMFMODULE dmfModuleUefiLogs;
     ScheduledTask_Result_Type scheduledTaskResult;
     NTSTATUS ntStatus;
-    WDF_OBJECT_ATTRIBUTES objectAttributes;
     WDFMEMORY uefiLogMemory;
     VOID* uefiLog;
-    WDFMEMORY parsedUefiLogMemory;
-    VOID* parsedUefiLog;
-    WDFMEMORY eventLogMemory;
-    VOID* eventLogLine;
+    WDFMEMORY fileMemory;
     DMF_CONTEXT_UefiLogs* moduleContext;
     ULONG blobSize;
-    size_t maximumBytesToCopy;
-    size_t eventLogSize;
     ADVANCED_LOGGER_INFO_V2* loggerInfo;
+    size_t headerSize;
+    size_t parsedLogLength;
     UCHAR* parsedLogHead;
-    UCHAR* uefiLogHead;
-    UCHAR* eventLogLineHead;
-    size_t lineSize;
-    size_t timeStampSize;
-    ADVANCED_LOGGER_MESSAGE_ENTRY* loggerMessageEntry;
-    UCHAR* messageText;
-    UCHAR* uefiLogEndAddress;
-    UCHAR* parsedLogHeadEnd;
+    BOOLEAN logIsNew;
+    UefiLogs_PARSER parser;
 
     PAGED_CODE();
 
@@ -522,11 +1012,9 @@ Return Value:
     scheduledTaskResult = ScheduledTask_WorkResult_Success;
     uefiLog = NULL;
     uefiLogMemory = NULL;
-    parsedUefiLogMemory = NULL;
-    eventLogMemory = NULL;
-    maximumBytesToCopy = (DMF_EVENTLOG_MAXIMUM_LENGTH_OF_STRING * sizeof(WCHAR)) + sizeof(L"\0");
-    eventLogSize = maximumBytesToCopy + sizeof(L"\0");
+    fileMemory = NULL;
     blobSize = 0;
+    logIsNew = FALSE;
 
     ntStatus = DMF_UefiOperation_FirmwareEnvironmentVariableAllocateGet(moduleContext->DmfModuleUefiOperation,
                                                                         (PUNICODE_STRING)&UefiVariableName,
@@ -544,25 +1032,6 @@ Return Value:
         goto Exit;
     }
 
-    WDF_OBJECT_ATTRIBUTES_INIT(&objectAttributes);
-    objectAttributes.ParentObject = DmfModule;
-    ntStatus = WdfMemoryCreate(&objectAttributes,
-                               PagedPool,
-                               MemoryTag,
-                               eventLogSize,
-                               &eventLogMemory,
-                               (VOID**)&(eventLogLine));
-    if (!NT_SUCCESS(ntStatus))
-    {
-        TraceEvents(TRACE_LEVEL_WARNING, DMF_TRACE, "WdfMemoryCreate fails: ntStatus=%!STATUS!", ntStatus);
-        goto Exit;
-    }
-
-    // Clear so that parsing logic can just copy characters without terminating the string.
-    //
-    RtlZeroMemory(eventLogLine,
-                  eventLogSize);
-
     // Parse logs.
     //
     // Since the new fields introduced in V3 struct are not being used in
@@ -570,193 +1039,122 @@ Return Value:
     // Version is checked for offsets only.
     //
     loggerInfo = (ADVANCED_LOGGER_INFO_V2*)uefiLog;
-    if (loggerInfo->Signature != LOGGER_INFO_SIGNATURE)
+    if (blobSize < sizeof(ADVANCED_LOGGER_INFO_V2) ||
+        loggerInfo->Signature != LOGGER_INFO_SIGNATURE)
     {
         TraceEvents(TRACE_LEVEL_WARNING, DMF_TRACE, "Unknown NVRAM Log signature = %u",loggerInfo->Signature);
         goto Exit;
     }
 
-    ntStatus = WdfMemoryCreate(&objectAttributes,
-                               PagedPool,
-                               MemoryTag,
-                               blobSize,
-                               &parsedUefiLogMemory,
-                               (VOID**)&(parsedUefiLog));
-    if (!NT_SUCCESS(ntStatus))
-    {
-        TraceEvents(TRACE_LEVEL_WARNING, DMF_TRACE, "WdfMemoryCreate fails: ntStatus=%!STATUS!", ntStatus);
-        goto Exit;
-    }
-
-    RtlZeroMemory(parsedUefiLog,
-                  blobSize);
-
-    parsedLogHead = (UCHAR*) parsedUefiLog;
-    parsedLogHeadEnd = (UCHAR*) parsedLogHead + blobSize;
-
     // Version check for message offset.
     //
     if (loggerInfo->Version == ADVANCED_LOGGER_VERSION_V2)
     {
-        uefiLogHead = (UCHAR*)uefiLog + sizeof(ADVANCED_LOGGER_INFO_V2);
+        headerSize = sizeof(ADVANCED_LOGGER_INFO_V2);
     }
     else if (loggerInfo->Version == ADVANCED_LOGGER_VERSION_V3)
     {
-        uefiLogHead = (UCHAR*)uefiLog + sizeof(ADVANCED_LOGGER_INFO_V3);
+        headerSize = sizeof(ADVANCED_LOGGER_INFO_V3);
     }
     else
     {
         TraceEvents(TRACE_LEVEL_WARNING, DMF_TRACE, "Unsupported version. Version = %u",loggerInfo->Version);
         goto Exit;
     }
-    eventLogLineHead = (UCHAR*)eventLogLine;
-    lineSize = 0;
-    timeStampSize = 0;
 
-    // Add timestamp to the beginning of the log.
-    //
-    ntStatus = UefiLogs_BufferStringAppend(dmfModuleUefiLogs,
-                                           parsedUefiLog,
-                                           blobSize,
-                                           (VOID**)&parsedLogHead,
-                                           "NVRAM Log Time: %u-%u-%u %u:%u:%u\n",
-                                           loggerInfo->Time.Year,
-                                           loggerInfo->Time.Month,
-                                           loggerInfo->Time.Day,
-                                           loggerInfo->Time.Hour,
-                                           loggerInfo->Time.Minute,
-                                           loggerInfo->Time.Second);
+    // Start over if this is not the log that was parsed last time.
+    //
+    if ((loggerInfo->LogBuffer != moduleContext->ParsedLogBuffer) ||
+        (loggerInfo->TicksAtTime != moduleContext->ParsedLogTicksAtTime) ||
+        (moduleContext->ParsedOffset < headerSize) ||
+        (moduleContext->ParsedOffset > blobSize))
+    {
+        moduleContext->ParsedLogBuffer = loggerInfo->LogBuffer;
+        moduleContext->ParsedLogTicksAtTime = loggerInfo->TicksAtTime;
+        moduleContext->ParsedOffset = headerSize;
+        moduleContext->ParsedLogLength = 0;
+        logIsNew = TRUE;
+    }
+
+    ntStatus = UefiLogs_ParsedLogReserve(dmfModuleUefiLogs,
+                                         (blobSize - moduleContext->ParsedOffset) + UefiLogs_LogTimeLineSizeMaximum);
     if (!NT_SUCCESS(ntStatus))
     {
-        TraceEvents(TRACE_LEVEL_ERROR, DMF_TRACE, "UefiLogs_BufferStringAppend fails: ntStatus=%!STATUS!", ntStatus);
         goto Exit;
     }
 
-    // Add first timestamp to ETW.
-    //
-    DMF_Utility_LogEmitString(dmfModuleUefiLogs,
-                              DmfLogDataSeverity_Informational,
-                              L"%S",
-                              parsedUefiLog);
-
-    uefiLogEndAddress = (UCHAR*)uefiLog + blobSize;
-    while (uefiLogHead < uefiLogEndAddress)
+    if (logIsNew)
     {
-        loggerMessageEntry = (ADVANCED_LOGGER_MESSAGE_ENTRY*)uefiLogHead;
-        // Message is located at the end of the loggerMessageEntry.
-        //
-        messageText = uefiLogHead + sizeof(ADVANCED_LOGGER_MESSAGE_ENTRY);
-        if (loggerMessageEntry->Signature != LOGGER_MESSAGE_ENTRY_SIGNATURE)
-        {
-            TraceEvents(TRACE_LEVEL_WARNING, DMF_TRACE, "Unknown NVRAM Log signature");
-            break;
-        }
-
-        // Add timestamp to line if this is the start of the line.
-        //
-        if (lineSize == 0)
-        {
-            UefiLogs_BufferTimeAppend(dmfModuleUefiLogs,
-                                      loggerInfo,
-                                      loggerMessageEntry,
-                                      eventLogLineHead,
-                                      eventLogSize,
-                                      &timeStampSize);
-            eventLogLineHead += timeStampSize;
-            lineSize += timeStampSize;
-        }
-
-        // Add message to line.
+        // Add timestamp to the beginning of the log.
         //
-        if (eventLogLineHead + loggerMessageEntry->MessageLengthBytes <= ((UCHAR*)eventLogLine) + maximumBytesToCopy)
+        parsedLogHead = moduleContext->ParsedLog;
+        ntStatus = UefiLogs_BufferStringAppend(dmfModuleUefiLogs,
+                                               parsedLogHead,
+                                               UefiLogs_LogTimeLineSizeMaximum,
+                                               (VOID**)&parsedLogHead,
+                                               "NVRAM Log Time: %u-%u-%u %u:%u:%u\n",
+                                               loggerInfo->Time.Year,
+                                               loggerInfo->Time.Month,
+                                               loggerInfo->Time.Day,
+                                               loggerInfo->Time.Hour,
+                                               loggerInfo->Time.Minute,
+                                               loggerInfo->Time.Second);
+        if (!NT_SUCCESS(ntStatus))
         {
-            RtlCopyMemory(eventLogLineHead,
-                          messageText,
-                          loggerMessageEntry->MessageLengthBytes);
-        }
-        else
-        {
-            // The payload of the message is too long.
-            //
-            DmfAssert(FALSE);
-            // Cannot trust the rest of the data. Exit now.
-            //
-            break;
+            TraceEvents(TRACE_LEVEL_ERROR, DMF_TRACE, "UefiLogs_BufferStringAppend fails: ntStatus=%!STATUS!", ntStatus);
+            goto Exit;
         }
+        moduleContext->ParsedLogLength = (size_t)(parsedLogHead - moduleContext->ParsedLog);
 
-        // Move the event log head to last character of the string which was just extracted
-        // to check if it is end of line.
+        // Add first timestamp to ETW.
         //
-        eventLogLineHead += loggerMessageEntry->MessageLengthBytes - 1;
-        lineSize += loggerMessageEntry->MessageLengthBytes;
-
-        // Check if last character is ASCII end of line.
-        //
-        if (*eventLogLineHead == CARRIAGE_RETURN)
-        {
-            // Copy the line to parsed buffer.
-            //
-            if (parsedLogHead + lineSize <= parsedLogHeadEnd)
-            {
-                // 'Possibly incorrect single element annotation on buffer'
-                //
-                #pragma warning(suppress: 26007)
-                RtlCopyMemory(parsedLogHead,
-                              eventLogLine,
-                              lineSize);
-                parsedLogHead += lineSize;
-            }
-            else
-            {
-                // Data won't fit into target buffer to write to file.
-                //
-                DmfAssert(FALSE);
-                // Stop processing.
-                //
-                break;
-            }
-
-            // Send line out as ETW event (if it is not an empty line).
-            // Empty lines in UEFI logs have 2 characters, return carriage and newline.
-            //
-            if (lineSize > timeStampSize + sizeof('\n') + sizeof('\r'))
-            {
-                DMF_Utility_LogEmitString(dmfModuleUefiLogs,
-                                          DmfLogDataSeverity_Informational,
-                                          L"%S",
-                                          eventLogLine);
-            }
-
-            // Clear out the line.
-            //
-            RtlZeroMemory(eventLogLine,
-                          lineSize);
+        UefiLogs_BatchAppend(dmfModuleUefiLogs,
+                             moduleContext->ParsedLog,
+                             moduleContext->ParsedLogLength);
+    }
 
-            // Set head back to start.
-            //
-            eventLogLineHead = (UCHAR*)eventLogLine;
-            lineSize = 0;
-            timeStampSize = 0;
-        }
-        else
-        {
-            // Move head forward for next copy.
-            //
-            eventLogLineHead += 1;
-        }
+    parsedLogLength = moduleContext->ParsedLogLength;
+
+    parser.DmfModule = dmfModuleUefiLogs;
+    parser.LoggerInfo = loggerInfo;
+    parser.Log = (UCHAR*)uefiLog;
+    parser.LogSize = blobSize;
+    parser.Offset = moduleContext->ParsedOffset;
+    parser.LineBuffer = moduleContext->Line;
+    parser.LineBufferSize = UefiLogs_LineBufferSize;
+    parser.LineProcess = UefiLogs_LineStore;
+    parser.LineProcessContext = dmfModuleUefiLogs;
+    // Lines that do not fit are parsed again during next retrieval.
+    //
+    (VOID)UefiLogs_EntriesParse(&parser);
+    moduleContext->ParsedOffset = parser.Offset;
 
-        uefiLogHead += sizeof(ADVANCED_LOGGER_MESSAGE_ENTRY) + loggerMessageEntry->MessageLengthBytes;
+    UefiLogs_BatchFlush(dmfModuleUefiLogs);
 
-        // Ensure 8 byte alignment of the uefiLogHead.
+    if ((! logIsNew) &&
+        (moduleContext->ParsedLogLength == parsedLogLength))
+    {
+        // Nothing new since last time. The file is already up to date.
         //
-        uefiLogHead = (UCHAR*)((((UINT64)uefiLogHead + 7) / 8) * 8);
+        TraceEvents(TRACE_LEVEL_VERBOSE, DMF_TRACE, "No new UEFI log entries");
+        goto Exit;
     }
 
-    // UEFI logs obtained. Create log file.
+    // UEFI logs obtained. Create log file with only the parsed part of the buffer.
     //
+    ntStatus = WdfMemoryCreatePreallocated(WDF_NO_OBJECT_ATTRIBUTES,
+                                           moduleContext->ParsedLog,
+                                           moduleContext->ParsedLogLength,
+                                           &fileMemory);
+    if (!NT_SUCCESS(ntStatus))
+    {
+        TraceEvents(TRACE_LEVEL_ERROR, DMF_TRACE, "WdfMemoryCreatePreallocated fails: ntStatus=%!STATUS!", ntStatus);
+        goto Exit;
+    }
+
     ntStatus = DMF_File_Write(moduleContext->DmfModuleFile,
                               moduleContext->UefiLogPath,
-                              parsedUefiLogMemory);
+                              fileMemory);
     if (!NT_SUCCESS(ntStatus))
     {
         TraceEvents(TRACE_LEVEL_ERROR, DMF_TRACE, "DMF_File_Write fails: ntStatus=%!STATUS!", ntStatus);
@@ -769,13 +1167,9 @@ Exit:
     {
         WdfObjectDelete(uefiLogMemory);
     }
-    if (parsedUefiLogMemory != NULL)
-    {
-        WdfObjectDelete(parsedUefiLogMemory);
-    }
-    if (eventLogMemory != NULL)
+    if (fileMemory != NULL)
     {
-        WdfObjectDelete(eventLogMemory);
+        WdfObjectDelete(fileMemory);
     }
 
     if (!NT_SUCCESS(ntStatus))
@@ -1033,6 +1427,37 @@ Return Value:
         goto Exit;
     }
 
+    // Buffers used to parse the logs are allocated once and reused by every retrieval.
+    // Clear so that parsing logic can just copy characters without terminating the string.
+    //
+    ntStatus = WdfMemoryCreate(&objectAttributes,
+                               PagedPool,
+                               MemoryTag,
+                               UefiLogs_LineBufferSize + sizeof(L"\0"),
+                               &moduleContext->LineMemory,
+                               (VOID**)&moduleContext->Line);
+    if (!NT_SUCCESS(ntStatus))
+    {
+        TraceEvents(TRACE_LEVEL_ERROR, DMF_TRACE, "WdfMemoryCreate fails: ntStatus=%!STATUS!", ntStatus);
+        goto Exit;
+    }
+    RtlZeroMemory(moduleContext->Line,
+                  UefiLogs_LineBufferSize + sizeof(L"\0"));
+
+    ntStatus = WdfMemoryCreate(&objectAttributes,
+                               PagedPool,
+                               MemoryTag,
+                               UefiLogs_BatchBufferSize + sizeof(CHAR),
+                               &moduleContext->BatchMemory,
+                               (VOID**)&moduleContext->Batch);
+    if (!NT_SUCCESS(ntStatus))
+    {
+        TraceEvents(TRACE_LEVEL_ERROR, DMF_TRACE, "WdfMemoryCreate fails: ntStatus=%!STATUS!", ntStatus);
+        goto Exit;
+    }
+    moduleContext->Batch[0] = '\0';
+    moduleContext->BatchLength = 0;
+
 Exit:
 
     return ntStatus;
@@ -1117,5 +1542,51 @@ Return Value:
 // Module Methods
 //
 
+#pragma code_seg("PAGE")
+_IRQL_requires_max_(PASSIVE_LEVEL)
+_Must_inspect_result_
+NTSTATUS
+DMF_UefiLogs_Retrieve(
+    _In_ DMFMODULE DmfModule
+    )
+/*++
+
+Routine Description:
+
+    Retrieve the UEFI logs now. Only entries added since the last retrieval of the same
+    log are parsed and sent to the event log. The log file is rewritten if there are new entries.
+
+Arguments:
+
+    DmfModule - This Module's handle.
+
+Return Value:
+
+    NTSTATUS (fails if a retrieval is already pending).
+
+--*/
+{
+    NTSTATUS ntStatus;
+    DMF_CONTEXT_UefiLogs* moduleContext;
+
+    PAGED_CODE();
+
+    FuncEntry(DMF_TRACE);
+
+    DMFMODULE_VALIDATE_IN_METHOD(DmfModule,
+                                 UefiLogs);
+
+    moduleContext = DMF_CONTEXT_GET(DmfModule);
+
+    ntStatus = DMF_QueuedWorkItem_Enqueue(moduleContext->DmfModuleQueuedWorkItem,
+                                          NULL,
+                                          0);
+
+    FuncExit(DMF_TRACE, "ntStatus=%!STATUS!", ntStatus);
+
+    return ntStatus;
+}
+#pragma code_seg()
+
 // eof: Dmf_UefiLogs.c
 //
@@ -27,5 +27,12 @@ DECLARE_DMF_MODULE_NO_CONFIG(UefiLogs)
 // Module Methods
 //
 
+_IRQL_requires_max_(PASSIVE_LEVEL)
+_Must_inspect_result_
+NTSTATUS
+DMF_UefiLogs_Retrieve(
+    _In_ DMFMODULE DmfModule
+    );
+
 // eof: Dmf_UefiLogs.h
 //
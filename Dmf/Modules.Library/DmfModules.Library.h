@@ -50,6 +50,12 @@ extern "C"
 // Protocols
 //
 #include "Dmf_ComponentFirmwareUpdate.h"
+#include "Dmf_ComponentFirmwareUpdateLoopbackTransport.h"
+
+// Instrumentation
+// NOTE: Included before the Modules that use it as an optional Child Module.
+//
+#include "Dmf_LatencyHistogram.h"
 
 // Task Execution
 //
@@ -57,6 +63,7 @@ extern "C"
 #include "Dmf_ScheduledTask.h"
 #include "Dmf_QueuedWorkItem.h"
 #include "Dmf_Thread.h"
+#include "Dmf_TimerWheel.h"
 
 // Driver Patterns
 //
@@ -100,6 +107,7 @@ extern "C"
 //
 #include "Dmf_GpioTarget.h"
 #include "Dmf_I2cTarget.h"
+#include "Dmf_RegisterMap.h"
 #include "Dmf_RequestTarget.h"
 #include "Dmf_ContinuousRequestTarget.h"
 #include "Dmf_DefaultTarget.h"
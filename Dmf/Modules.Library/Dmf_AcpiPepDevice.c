@@ -53,9 +53,24 @@ typedef struct _DMF_CONTEXT_AcpiPepDevice
     // List for tracking devices.
     //
     LIST_ENTRY PepDeviceList;
-    // List for tracking pending work items.
+    // List of devices that have pending work requests.
     //
-    LIST_ENTRY PepPendingWorkList;
+    LIST_ENTRY PepReadyDeviceList;
+    // Workers that process pending work requests. Each one takes the next device from
+    // PepReadyDeviceList so that work of different devices is processed in parallel.
+    //
+    WDFWORKITEM* Workers;
+    ULONG NumberOfWorkers;
+    // Indexes of the workers that are not running. A device that gets pending work is given
+    // to one of them. Running workers keep taking devices from PepReadyDeviceList until it is
+    // empty, so a device only waits for a running worker when no worker is idle.
+    // NOTE: Protected by the auxiliary lock.
+    //
+    ULONG* IdleWorkers;
+    ULONG NumberOfIdleWorkers;
+    // Preallocated work requests.
+    //
+    DMFMODULE DmfModuleBufferPoolWorkRequest;
     // The full table containing all supported functions for all devices.
     //
     PEP_DEVICE_DEFINITION* PepDeviceDefinitionArray;
@@ -169,11 +184,25 @@ typedef enum _PEP_HANDLER_TYPE
     PepHandlerTypeWorkerCallback
 } PEP_HANDLER_TYPE;
 
+// Default number of workers that process pending work requests.
+//
+#define AcpiPepDevice_WorkerCountDefault            (4)
+// Number of work requests that are preallocated.
+//
+#define AcpiPepDevice_WorkRequestPoolSize           (16)
+// Work request contexts up to this size are stored in the work request itself.
+// Larger contexts are allocated separately.
+//
+#define AcpiPepDevice_WorkContextInlineSize         (256)
+
 typedef struct _PEP_WORK_ITEM_CONTEXT
 {
     DMFMODULE DmfModule;
     WDFWORKITEM WorkItem;
     PEP_NOTIFICATION_CLASS WorkType;
+    // Index of this work item in Workers.
+    //
+    ULONG WorkerIndex;
 } PEP_WORK_ITEM_CONTEXT;
 
 WDF_DECLARE_CONTEXT_TYPE_WITH_NAME(PEP_WORK_ITEM_CONTEXT, PepWorkItemContextGet)
@@ -267,12 +296,13 @@ typedef struct _PEP_WORK_CONTEXT
     //
     PEP_WORK_INFORMATION LocalPoFxWorkInfo;
 
-    // Work item context
+    // Work item context. It is stored right after this structure unless it is larger than
+    // AcpiPepDevice_WorkContextInlineSize in which case WorkContextMemory is allocated.
     //
+    VOID* WorkContext;
     WDFMEMORY WorkContextMemory;
     SIZE_T WorkContextSize;
     NTSTATUS* WorkRequestStatus;
-    WDFMEMORY WorkRequestMemory;
 } PEP_WORK_CONTEXT;
 
 _Success_(completeStatus == PEP_NOTIFICATION_HANDLER_COMPLETE)
@@ -606,7 +636,7 @@ AcpiPepDevice_WorkRequestCreate(
     _In_opt_ VOID* WorkContext,
     _In_ SIZE_T WorkContextSize,
     _In_opt_ NTSTATUS* WorkRequestStatus,
-    _Out_ WDFMEMORY* WorkRequestMemory
+    _Out_ PEP_WORK_CONTEXT** WorkRequest
     )
 /*++
 
@@ -614,7 +644,7 @@ Routine Description:
 
     This routine creates a new work request. Note the caller is responsible
     for adding this request to the pending queue after filling in
-    request-specific data.
+    request-specific data. Work requests come from a preallocated pool.
 
 Arguments:
 
@@ -627,7 +657,7 @@ Arguments:
     WorkContext - Supplies optional pointer to the context of the work request.
     WorkContextSize - Supplies the size of the work request context.
     WorkRequestStatus -  Supplies optional pointer to report the status of the work request.
-    OutputWorkRequest - Supplies a pointer that receives the created request.
+    WorkRequest - Supplies a pointer that receives the created request.
 
 Return Value:
 
@@ -640,43 +670,55 @@ Return Value:
     PEP_WORK_CONTEXT* workRequest;
     WDF_OBJECT_ATTRIBUTES objectAttributes;
     WDFMEMORY localWorkContextMemory;
+    DMF_CONTEXT_AcpiPepDevice* moduleContext;
 
     UNREFERENCED_PARAMETER(DmfModule);
 
     DmfAssert(WorkType != PEP_NOTIFICATION_CLASS_NONE);
 
+    moduleContext = DMF_CONTEXT_GET(g_DmfModuleAcpiPepDevice);
+    *WorkRequest = NULL;
     localWorkContextMemory = NULL;
 
-    WDF_OBJECT_ATTRIBUTES_INIT(&objectAttributes);
-    objectAttributes.ParentObject = g_DmfModuleAcpiPepDevice;
-
-    ntStatus = WdfMemoryCreate(&objectAttributes,
-                               NonPagedPoolNx,
-                               MemoryTag,
-                               sizeof(PEP_WORK_CONTEXT),
-                               WorkRequestMemory,
-                               (VOID**)&workRequest);
+    ntStatus = DMF_BufferPool_Get(moduleContext->DmfModuleBufferPoolWorkRequest,
+                                  (VOID**)&workRequest,
+                                  NULL);
     if (!NT_SUCCESS(ntStatus))
     {
-        TraceEvents(TRACE_LEVEL_ERROR,  DMF_TRACE, "WdfMemoryCreate fails: ntStatus=%!STATUS!", ntStatus);
+        TraceEvents(TRACE_LEVEL_ERROR,  DMF_TRACE, "DMF_BufferPool_Get fails: ntStatus=%!STATUS!", ntStatus);
         goto Exit;
     }
 
+    RtlZeroMemory(workRequest,
+                  sizeof(PEP_WORK_CONTEXT));
+
     localWorkContext = NULL;
     if (WorkContext != NULL)
     {
         DmfAssert(WorkContextSize != 0);
 
-        ntStatus = WdfMemoryCreate(&objectAttributes,
-                                   NonPagedPoolNx,
-                                   MemoryTag,
-                                   WorkContextSize,
-                                   &localWorkContextMemory,
-                                   (VOID**)&localWorkContext);
-        if (!NT_SUCCESS(ntStatus))
+        if (WorkContextSize <= AcpiPepDevice_WorkContextInlineSize)
         {
-            TraceEvents(TRACE_LEVEL_ERROR,  DMF_TRACE, "WdfMemoryCreate fails: ntStatus=%!STATUS!", ntStatus);
-            goto Exit;
+            localWorkContext = (VOID*)(workRequest + 1);
+        }
+        else
+        {
+            WDF_OBJECT_ATTRIBUTES_INIT(&objectAttributes);
+            objectAttributes.ParentObject = g_DmfModuleAcpiPepDevice;
+
+            ntStatus = WdfMemoryCreate(&objectAttributes,
+                                       NonPagedPoolNx,
+                                       MemoryTag,
+                                       WorkContextSize,
+                                       &localWorkContextMemory,
+                                       (VOID**)&localWorkContext);
+            if (!NT_SUCCESS(ntStatus))
+            {
+                TraceEvents(TRACE_LEVEL_ERROR,  DMF_TRACE, "WdfMemoryCreate fails: ntStatus=%!STATUS!", ntStatus);
+                DMF_BufferPool_Put(moduleContext->DmfModuleBufferPoolWorkRequest,
+                                   workRequest);
+                goto Exit;
+            }
         }
 
         RtlCopyMemory(localWorkContext,
@@ -689,18 +731,17 @@ Return Value:
         WorkContextSize = 0;
     }
 
-    RtlZeroMemory(workRequest,
-                  sizeof(PEP_WORK_CONTEXT));
     InitializeListHead(&workRequest->ListEntry);
-    workRequest->WorkRequestMemory = *WorkRequestMemory;
     workRequest->WorkType = WorkType;
     workRequest->NotificationId = NotificationId;
     workRequest->PepInternalDevice = PepInternalDevice;
     workRequest->DeviceDefinitionEntry = DeviceDefinitionEntry;
+    workRequest->WorkContext = localWorkContext;
     workRequest->WorkContextSize = WorkContextSize;
     workRequest->WorkContextMemory = localWorkContextMemory;
     workRequest->WorkRequestStatus = WorkRequestStatus;
     workRequest->WorkCompleted = FALSE;
+    *WorkRequest = workRequest;
     ntStatus = STATUS_SUCCESS;
 
 Exit:
@@ -722,18 +763,25 @@ AcpiPepDevice_NotificationHandlerInvoke(
 
 VOID
 AcpiPepDevice_PendingWorkRequestsProcess(
-    _In_ DMFMODULE DmfModule
+    _In_ DMFMODULE DmfModule,
+    _In_ ULONG WorkerIndex
     )
 /*++
 
 Routine Description:
 
-    This function processes all pending work. It calls the handler
-    routine for each pending work.
+    This function processes pending work. It takes the next device that has
+    pending work, calls the handler routine for that device's oldest pending
+    work and then puts the device back at the end of the list if it has more
+    work. Since a device is not in the list while its work is processed, the
+    work of each device is processed in order while other workers process
+    the work of other devices. When there is no more work, the worker
+    becomes idle.
 
 Arguments:
 
     DmfModule - This Module's handle.
+    WorkerIndex - Index of the worker that is running.
 
 Return Value:
 
@@ -743,18 +791,26 @@ Return Value:
 {
     LIST_ENTRY* nextEntry;
     PEP_WORK_CONTEXT* workRequest;
-    VOID* workContext;
+    PEP_INTERNAL_DEVICE_HEADER* pepInternalDevice;
 
     DMF_CONTEXT_AcpiPepDevice* moduleContext = DMF_CONTEXT_GET(g_DmfModuleAcpiPepDevice);
 
-    // Go through pending work list and handle them.
+    // Go through devices with pending work and handle them.
     //
     DMF_ModuleAuxiliaryLock(g_DmfModuleAcpiPepDevice,
                             0);
 
-    while (IsListEmpty(&moduleContext->PepPendingWorkList) == FALSE)
+    while (IsListEmpty(&moduleContext->PepReadyDeviceList) == FALSE)
     {
-        nextEntry = RemoveHeadList(&moduleContext->PepPendingWorkList);
+        nextEntry = RemoveHeadList(&moduleContext->PepReadyDeviceList);
+        InitializeListHead(nextEntry);
+        pepInternalDevice = CONTAINING_RECORD(nextEntry,
+                                              PEP_INTERNAL_DEVICE_HEADER,
+                                              ReadyListEntry);
+        DmfAssert(pepInternalDevice->WorkScheduled);
+        DmfAssert(IsListEmpty(&pepInternalDevice->PendingWorkList) == FALSE);
+
+        nextEntry = RemoveHeadList(&pepInternalDevice->PendingWorkList);
         InitializeListHead(nextEntry);
         workRequest = CONTAINING_RECORD(nextEntry,
                                         PEP_WORK_CONTEXT,
@@ -778,15 +834,13 @@ Return Value:
                     (ULONG)workRequest->WorkType,
                     (ULONG)workRequest->NotificationId);
 
-        workContext = WdfMemoryGetBuffer(workRequest->WorkContextMemory,
-                                         NULL);
         AcpiPepDevice_NotificationHandlerInvoke(DmfModule,
                                                 workRequest->WorkType,
                                                 workRequest,
                                                 PepHandlerTypeWorkerCallback,
                                                 workRequest->NotificationId,
                                                 workRequest->PepInternalDevice,
-                                                workContext,
+                                                workRequest->WorkContext,
                                                 workRequest->WorkContextSize,
                                                 workRequest->WorkRequestStatus);
 
@@ -794,8 +848,27 @@ Return Value:
         //
         DMF_ModuleAuxiliaryLock(g_DmfModuleAcpiPepDevice,
                                 0);
+
+        // Let the device's next request run after the ones of the other devices that are waiting.
+        //
+        if (IsListEmpty(&pepInternalDevice->PendingWorkList))
+        {
+            pepInternalDevice->WorkScheduled = FALSE;
+        }
+        else
+        {
+            InsertTailList(&moduleContext->PepReadyDeviceList,
+                           &pepInternalDevice->ReadyListEntry);
+        }
     }
 
+    // Become idle while the lock is still held. Otherwise a device could be added to the
+    // list after this worker saw it empty but before another worker is scheduled for it.
+    //
+    DmfAssert(moduleContext->NumberOfIdleWorkers < moduleContext->NumberOfWorkers);
+    moduleContext->IdleWorkers[moduleContext->NumberOfIdleWorkers] = WorkerIndex;
+    moduleContext->NumberOfIdleWorkers++;
+
     DMF_ModuleAuxiliaryUnlock(g_DmfModuleAcpiPepDevice,
                               0);
 }
@@ -823,116 +896,62 @@ Return Value:
     PEP_WORK_ITEM_CONTEXT* context;
 
     context = PepWorkItemContextGet(WorkItem);
-    AcpiPepDevice_PendingWorkRequestsProcess(context->DmfModule);
-
-    // Delete the work item as it is no longer required.
-    //
-    WdfObjectDelete(WorkItem);
+    AcpiPepDevice_PendingWorkRequestsProcess(context->DmfModule,
+                                             context->WorkerIndex);
 }
 
-_Must_inspect_result_
-NTSTATUS
+VOID
 AcpiPepDevice_ScheduleWorker(
+    _In_ ULONG WorkerIndex,
     _In_ PEP_WORK_CONTEXT* WorkContext
     )
 /*++
 
 Routine Description:
 
-    This function schedules a worker thread to process pending work requests.
+    This function schedules an idle worker to process pending work requests.
 
 Arguments:
 
+    WorkerIndex - Supplies the index of the worker to enqueue.
     WorkContext - Supplies the context of the work.
 
 Return Value:
 
-    NTSTATUS.
+    None.
 
 --*/
 {
-    WDF_OBJECT_ATTRIBUTES attributes;
-    NTSTATUS ntStatus;
-    BOOLEAN synchronous;
-    WDFWORKITEM workItem;
-    WDF_WORKITEM_CONFIG workItemConfiguration;
-
-    workItem = NULL;
-    synchronous = FALSE;
-
-    // Create a workitem to process events.
-    //
-    WDF_OBJECT_ATTRIBUTES_INIT(&attributes);
-    WDF_OBJECT_ATTRIBUTES_SET_CONTEXT_TYPE(&attributes,
-                                           PEP_WORK_ITEM_CONTEXT);
-
-    attributes.ParentObject = g_DmfModuleAcpiPepDevice;
-
-    // Initialize the handler routine and create a new workitem.
-    //
-    WDF_WORKITEM_CONFIG_INIT(&workItemConfiguration,
-                             AcpiPepDevice_WorkerWrapper);
-
-    // Disable automatic serialization by the framework for the worker thread.
-    // The parent device object is being serialized at device level (i.e.,
-    // WdfSynchronizationScopeDevice), and the framework requires it to be
-    // passive level (i.e., WdfExecutionLevelPassive) if automatic
-    // synchronization is desired.
-    //
-    workItemConfiguration.AutomaticSerialization = FALSE;
-
-    // Create the work item and queue it. If the workitem cannot be created
-    // for some reason, just call the worker routine synchronously.
-    //
-    ntStatus = WdfWorkItemCreate(&workItemConfiguration,
-                                 &attributes,
-                                 &workItem);
-    if (!NT_SUCCESS(ntStatus))
-    {
-        synchronous = TRUE;
-        TraceEvents(TRACE_LEVEL_INFORMATION,
-                    DMF_TRACE,
-                    "%s: Failed to allocate work item to process pending"
-                    "work! ntStatus = %!STATUS!. Will synchronously process.",
-                    __FUNCTION__,
-                    ntStatus);
-    }
+    DMF_CONTEXT_AcpiPepDevice* moduleContext = DMF_CONTEXT_GET(g_DmfModuleAcpiPepDevice);
 
-    // If the operation is to be performed synchronously, then directly
-    // invoke the worker routine. Otherwise, queue a workitem to run the
-    // worker routine.
-    //
-    if (synchronous != FALSE)
-    {
-        AcpiPepDevice_PendingWorkRequestsProcess(g_DmfModuleAcpiPepDevice);
-    }
-    else
-    {
-        TraceEvents(TRACE_LEVEL_INFORMATION,
-                    DMF_TRACE,
-                    "%s: Work request scheduled to run asynchronously. "
-                    "Device=%p, WorkType=%d, NotificationId=%d.",
-                    __FUNCTION__,
-                    (VOID*)WorkContext->PepInternalDevice,
-                    (ULONG)WorkContext->WorkType,
-                    (ULONG)WorkContext->NotificationId);
+    DmfAssert(WorkerIndex < moduleContext->NumberOfWorkers);
 
-        WdfWorkItemEnqueue(workItem);
-    }
+    TraceEvents(TRACE_LEVEL_INFORMATION,
+                DMF_TRACE,
+                "%s: Work request scheduled to run asynchronously. "
+                "Device=%p, WorkType=%d, NotificationId=%d, Worker=%d.",
+                __FUNCTION__,
+                (VOID*)WorkContext->PepInternalDevice,
+                (ULONG)WorkContext->WorkType,
+                (ULONG)WorkContext->NotificationId,
+                WorkerIndex);
 
-    return STATUS_SUCCESS;
+    WdfWorkItemEnqueue(moduleContext->Workers[WorkerIndex]);
 }
 
 _IRQL_requires_max_(DISPATCH_LEVEL)
 VOID
 AcpiPepDevice_WorkRequestPend(
-    _In_ WDFMEMORY WorkRequestMemory
+    _In_ PEP_WORK_CONTEXT* WorkRequest
     )
 /*++
 
 Routine Description:
 
-    This routine adds the given work request to the pending queue.
+    This routine adds the given work request to the pending queue of its device.
+    If the device has no other pending work, an idle worker is scheduled for the
+    device. If no worker is idle, a running worker takes the device when it
+    finishes its current request.
 
 Arguments:
 
@@ -944,37 +963,58 @@ Return Value:
 
 --*/
 {
-    PEP_WORK_CONTEXT* workRequest;
+    PEP_INTERNAL_DEVICE_HEADER* pepInternalDevice;
+    BOOLEAN scheduleWorker;
+    ULONG workerIndex;
     DMF_CONTEXT_AcpiPepDevice* moduleContext = DMF_CONTEXT_GET(g_DmfModuleAcpiPepDevice);
 
-    workRequest = (PEP_WORK_CONTEXT*)WdfMemoryGetBuffer(WorkRequestMemory,
-                                                        NULL);
+    pepInternalDevice = WorkRequest->PepInternalDevice;
+    scheduleWorker = FALSE;
+    workerIndex = 0;
 
     // Ensure that the request is not already on some other queue.
     //
-    DmfAssert(IsListEmpty(&workRequest->ListEntry) != FALSE);
+    DmfAssert(IsListEmpty(&WorkRequest->ListEntry) != FALSE);
 
     TraceEvents(TRACE_LEVEL_INFORMATION,
                 DMF_TRACE,
                 "%s: Insert pending work request. "
                 "Device=%p, WorkType=%d, NotificationId=%d.",
                 __FUNCTION__,
-                (VOID*)workRequest->PepInternalDevice,
-                (ULONG)workRequest->WorkType,
-                (ULONG)workRequest->NotificationId);
+                (VOID*)WorkRequest->PepInternalDevice,
+                (ULONG)WorkRequest->WorkType,
+                (ULONG)WorkRequest->NotificationId);
 
-    // Add the new request to the end of tail of the pending work queue.
+    // Add the new request to the end of tail of the device's pending work queue.
+    // If the device is already scheduled, the worker that processes the device
+    // processes this request after the device's earlier requests.
     //
     DMF_ModuleAuxiliaryLock(g_DmfModuleAcpiPepDevice,
                             0);
-    InsertTailList(&moduleContext->PepPendingWorkList,
-                   &workRequest->ListEntry);
+    InsertTailList(&pepInternalDevice->PendingWorkList,
+                   &WorkRequest->ListEntry);
+    if (! pepInternalDevice->WorkScheduled)
+    {
+        pepInternalDevice->WorkScheduled = TRUE;
+        InsertTailList(&moduleContext->PepReadyDeviceList,
+                       &pepInternalDevice->ReadyListEntry);
+        if (moduleContext->NumberOfIdleWorkers > 0)
+        {
+            moduleContext->NumberOfIdleWorkers--;
+            workerIndex = moduleContext->IdleWorkers[moduleContext->NumberOfIdleWorkers];
+            scheduleWorker = TRUE;
+        }
+    }
     DMF_ModuleAuxiliaryUnlock(g_DmfModuleAcpiPepDevice,
                               0);
 
     // Schedule a worker to pick up the new work.
     //
-    AcpiPepDevice_ScheduleWorker(workRequest);
+    if (scheduleWorker)
+    {
+        AcpiPepDevice_ScheduleWorker(workerIndex,
+                                     WorkRequest);
+    }
 }
 
 VOID
@@ -1011,7 +1051,7 @@ Return Value:
 {
     PEP_DEVICE_DEFINITION* deviceDefinition;
     NTSTATUS ntStatus;
-    WDFMEMORY workRequestMemory;
+    PEP_WORK_CONTEXT* workRequest;
 
     deviceDefinition = PepInternalDevice->DeviceDefinition;
     ntStatus = AcpiPepDevice_WorkRequestCreate(DmfModule,
@@ -1022,7 +1062,7 @@ Return Value:
                                                WorkContext,
                                                WorkContextSize,
                                                WorkRequestStatus,
-                                               &workRequestMemory);
+                                               &workRequest);
     if (!NT_SUCCESS(ntStatus))
     {
         TraceEvents(TRACE_LEVEL_ERROR,
@@ -1035,15 +1075,15 @@ Return Value:
         goto Exit;
     }
 
-    AcpiPepDevice_WorkRequestPend(workRequestMemory);
-
-    // Mark the work request status as pending.
+    // Mark the work request status as pending before the request can run.
     //
     if (WorkRequestStatus != NULL)
     {
         *WorkRequestStatus = STATUS_PENDING;
     }
 
+    AcpiPepDevice_WorkRequestPend(workRequest);
+
 Exit:
     ;
 }
@@ -1411,6 +1451,8 @@ Return Value:
 
     RtlZeroMemory(pepInternalDevice,
                   sizeNeeded);
+    InitializeListHead(&pepInternalDevice->PendingWorkList);
+    InitializeListHead(&pepInternalDevice->ReadyListEntry);
     pepInternalDevice->PepInternalDeviceMemory = pepInternelDeviceMemory;
     pepInternalDevice->DmfModule = dmfModulePepClient;
     pepInternalDevice->KernelHandle = registerDevice->KernelHandle;
@@ -1908,13 +1950,13 @@ Return Value:
 _IRQL_requires_max_(DISPATCH_LEVEL)
 VOID
 AcpiPepDevice_WorkRequestDestroy(
-    _In_ WDFMEMORY WorkRequestMemory
+    _In_ PEP_WORK_CONTEXT* WorkRequest
     )
 /*++
 
 Routine Description:
 
-    This routine destroys the given work request.
+    This routine destroys the given work request by returning it to the pool.
 
 Arguments:
 
@@ -1926,17 +1968,15 @@ Return Value:
 
 --*/
 {
-    PEP_WORK_CONTEXT* workRequest;
-
-    workRequest = (PEP_WORK_CONTEXT*)WdfMemoryGetBuffer(WorkRequestMemory,
-                                                        NULL);
+    DMF_CONTEXT_AcpiPepDevice* moduleContext = DMF_CONTEXT_GET(g_DmfModuleAcpiPepDevice);
 
-    if (workRequest->WorkContextMemory != NULL)
+    if (WorkRequest->WorkContextMemory != NULL)
     {
-        WdfObjectDelete(workRequest->WorkContextMemory);
+        WdfObjectDelete(WorkRequest->WorkContextMemory);
     }
 
-    WdfObjectDelete(WorkRequestMemory);
+    DMF_BufferPool_Put(moduleContext->DmfModuleBufferPoolWorkRequest,
+                       WorkRequest);
 }
 
 VOID
@@ -2035,7 +2075,7 @@ Return Value:
 
        // Destroy the request.
        //
-       AcpiPepDevice_WorkRequestDestroy(workRequest->WorkRequestMemory);
+       AcpiPepDevice_WorkRequestDestroy(workRequest);
     }
 
     // If there is more work left, then request another PEP_WORK.
@@ -2595,14 +2635,21 @@ Return Value:
 {
     NTSTATUS ntStatus;
     DMF_CONTEXT_AcpiPepDevice* moduleContext;
+    DMF_CONFIG_AcpiPepDevice* moduleConfig;
     WDF_OBJECT_ATTRIBUTES objectAttributes;
     WDFDEVICE device;
+    WDFMEMORY workersMemory;
+    WDFMEMORY idleWorkersMemory;
+    WDF_WORKITEM_CONFIG workItemConfiguration;
+    PEP_WORK_ITEM_CONTEXT* workItemContext;
+    ULONG workerIndex;
 
     PAGED_CODE();
 
     FuncEntry(DMF_TRACE);
 
     moduleContext = DMF_CONTEXT_GET(DmfModule);
+    moduleConfig = DMF_CONFIG_GET(DmfModule);
 
     device = DMF_ParentDeviceGet(DmfModule);
 
@@ -2626,9 +2673,98 @@ Return Value:
     // This list is protected by a DMF Auxiliary lock.
     //
     InitializeListHead(&moduleContext->PepDeviceList);
-    InitializeListHead(&moduleContext->PepPendingWorkList);
+    InitializeListHead(&moduleContext->PepReadyDeviceList);
     InitializeListHead(&moduleContext->PepCompletedWorkList);
 
+    // Create the workers that process pending work up front so that scheduling
+    // work never allocates.
+    //
+    if (moduleConfig->WorkerCount == 0)
+    {
+        moduleContext->NumberOfWorkers = AcpiPepDevice_WorkerCountDefault;
+    }
+    else
+    {
+        moduleContext->NumberOfWorkers = moduleConfig->WorkerCount;
+    }
+
+    WDF_OBJECT_ATTRIBUTES_INIT(&objectAttributes);
+    objectAttributes.ParentObject = DmfModule;
+    ntStatus = WdfMemoryCreate(&objectAttributes,
+                               NonPagedPoolNx,
+                               MemoryTag,
+                               sizeof(WDFWORKITEM) * moduleContext->NumberOfWorkers,
+                               &workersMemory,
+                               (VOID**)&moduleContext->Workers);
+    if (!NT_SUCCESS(ntStatus))
+    {
+        TraceEvents(TRACE_LEVEL_ERROR,
+                    DMF_TRACE,
+                    "WdfMemoryCreate fails: ntStatus=%!STATUS!",
+                    ntStatus);
+        moduleContext->NumberOfWorkers = 0;
+        goto Exit;
+    }
+
+    WDF_OBJECT_ATTRIBUTES_INIT(&objectAttributes);
+    objectAttributes.ParentObject = DmfModule;
+    ntStatus = WdfMemoryCreate(&objectAttributes,
+                               NonPagedPoolNx,
+                               MemoryTag,
+                               sizeof(ULONG) * moduleContext->NumberOfWorkers,
+                               &idleWorkersMemory,
+                               (VOID**)&moduleContext->IdleWorkers);
+    if (!NT_SUCCESS(ntStatus))
+    {
+        TraceEvents(TRACE_LEVEL_ERROR,
+                    DMF_TRACE,
+                    "WdfMemoryCreate fails: ntStatus=%!STATUS!",
+                    ntStatus);
+        moduleContext->NumberOfWorkers = 0;
+        goto Exit;
+    }
+    moduleContext->NumberOfIdleWorkers = 0;
+
+    // Disable automatic serialization by the framework for the worker thread.
+    // The parent device object is being serialized at device level (i.e.,
+    // WdfSynchronizationScopeDevice), and the framework requires it to be
+    // passive level (i.e., WdfExecutionLevelPassive) if automatic
+    // synchronization is desired.
+    //
+    WDF_WORKITEM_CONFIG_INIT(&workItemConfiguration,
+                             AcpiPepDevice_WorkerWrapper);
+    workItemConfiguration.AutomaticSerialization = FALSE;
+
+    for (workerIndex = 0; workerIndex < moduleContext->NumberOfWorkers; workerIndex++)
+    {
+        WDF_OBJECT_ATTRIBUTES_INIT(&objectAttributes);
+        WDF_OBJECT_ATTRIBUTES_SET_CONTEXT_TYPE(&objectAttributes,
+                                               PEP_WORK_ITEM_CONTEXT);
+        objectAttributes.ParentObject = DmfModule;
+        ntStatus = WdfWorkItemCreate(&workItemConfiguration,
+                                     &objectAttributes,
+                                     &moduleContext->Workers[workerIndex]);
+        if (!NT_SUCCESS(ntStatus))
+        {
+            TraceEvents(TRACE_LEVEL_ERROR,
+                        DMF_TRACE,
+                        "WdfWorkItemCreate fails: ntStatus=%!STATUS!",
+                        ntStatus);
+            goto Exit;
+        }
+
+        workItemContext = PepWorkItemContextGet(moduleContext->Workers[workerIndex]);
+        workItemContext->DmfModule = DmfModule;
+        workItemContext->WorkItem = moduleContext->Workers[workerIndex];
+        workItemContext->WorkType = PEP_NOTIFICATION_CLASS_NONE;
+        workItemContext->WorkerIndex = workerIndex;
+
+        // All workers start idle.
+        //
+        moduleContext->IdleWorkers[workerIndex] = workerIndex;
+        moduleContext->NumberOfIdleWorkers++;
+    }
+
     // Create a collection to hold all the PEP device definition tables.
     //
     WDF_OBJECT_ATTRIBUTES_INIT(&objectAttributes);
@@ -2708,6 +2844,7 @@ Return Value:
     DMF_MODULE_ATTRIBUTES moduleAttributes;
     DMF_CONTEXT_AcpiPepDevice* moduleContext;
     DMF_CONFIG_AcpiPepDevice* moduleConfig;
+    DMF_CONFIG_BufferPool moduleConfigBufferPool;
     WDF_OBJECT_ATTRIBUTES objectAttributes;
     WDFMEMORY childPepDeviceMemory;
     NTSTATUS ntStatus;
@@ -2748,6 +2885,25 @@ Return Value:
     }
 
     TraceEvents(TRACE_LEVEL_INFORMATION, DMF_TRACE, "Child device memory created.");
+
+    // BufferPool of work requests.
+    // It is added before the child PEP devices so that it is open before they register.
+    //
+    DMF_CONFIG_BufferPool_AND_ATTRIBUTES_INIT(&moduleConfigBufferPool,
+                                              &moduleAttributes);
+    moduleConfigBufferPool.BufferPoolMode = BufferPool_Mode_Source;
+    moduleConfigBufferPool.Mode.SourceSettings.EnableLookAside = TRUE;
+    moduleConfigBufferPool.Mode.SourceSettings.BufferCount = AcpiPepDevice_WorkRequestPoolSize;
+    // NOTE: Work requests are created and destroyed at DISPATCH_LEVEL.
+    //
+    moduleConfigBufferPool.Mode.SourceSettings.PoolType = NonPagedPoolNx;
+    moduleConfigBufferPool.Mode.SourceSettings.BufferSize = sizeof(PEP_WORK_CONTEXT) + AcpiPepDevice_WorkContextInlineSize;
+    moduleAttributes.ClientModuleInstanceName = "BufferPoolWorkRequest";
+    DMF_DmfModuleAdd(DmfModuleInit,
+                     &moduleAttributes,
+                     WDF_NO_OBJECT_ATTRIBUTES,
+                     &moduleContext->DmfModuleBufferPoolWorkRequest);
+
     // Initialize child Modules based on the passed configuration array.
     //
     for (ULONG childIndex = 0; childIndex < moduleConfig->ChildDeviceArraySize; ++childIndex)
@@ -3301,7 +3457,7 @@ Return Value:
 --*/
 {
     NTSTATUS ntStatus;
-    WDFMEMORY workRequestMemory;
+    PEP_WORK_CONTEXT* workRequest;
 
     // NOTE: Handle validation not done here because DMF handle is unused.
     //
@@ -3315,11 +3471,11 @@ Return Value:
                                                NotifyContext,
                                                sizeof(PEP_ACPI_NOTIFY_CONTEXT),
                                                NULL,
-                                               &workRequestMemory);
+                                               &workRequest);
     if (NT_SUCCESS(ntStatus))
     {
         TraceEvents(TRACE_LEVEL_INFORMATION, DMF_TRACE, "Scheduling work request");
-        AcpiPepDevice_WorkRequestPend(workRequestMemory);
+        AcpiPepDevice_WorkRequestPend(workRequest);
     }
     else
     {
@@ -317,6 +317,18 @@ typedef struct _PEP_INTERNAL_DEVICE_HEADER
     PEP_DEVICE_DEFINITION* DeviceDefinition;
     WDFMEMORY PepInternalDeviceMemory;
     DMFMODULE DmfModule;
+    // The following fields are private to Dmf_AcpiPepDevice.
+    //
+    // Work requests of this device that are waiting to be processed (in order).
+    //
+    LIST_ENTRY PendingWorkList;
+    // Entry of this device in the list of devices that have pending work.
+    //
+    LIST_ENTRY ReadyListEntry;
+    // TRUE while this device is in the list of devices that have pending work
+    // or one of its work requests is being processed.
+    //
+    BOOLEAN WorkScheduled;
 } PEP_INTERNAL_DEVICE_HEADER;
 
 // PEP_ACPI_DEVICE structure encapsulates the internal header
@@ -372,6 +384,11 @@ typedef struct
     // Number of child configuration structures placed in ChildDeviceConfigurationArray.
     //
     ULONG ChildDeviceArraySize;
+    // Number of workers that process pending work of different devices in parallel.
+    // Work of a single device is always processed in order by one worker at a time.
+    // Zero selects the default.
+    //
+    ULONG WorkerCount;
 } DMF_CONFIG_AcpiPepDevice;
 
 // This macro declares the following functions:
@@ -33,14 +33,46 @@ Environment:
 ///////////////////////////////////////////////////////////////////////////////////////////////////////
 //
 
+// A cached result of a successful evaluation. The entry is keyed by the IOCTL
+// and the exact bytes of the input buffer sent to ACPI (which contain the method
+// name and, for _DSM, the GUID, revision, function index and custom arguments).
+//
+typedef struct
+{
+    LIST_ENTRY ListEntry;
+    // Memory that holds this entry.
+    //
+    WDFMEMORY EntryMemory;
+    // IOCTL used to evaluate the method.
+    //
+    ULONG IoctlCode;
+    // Size of the input buffer that follows this structure.
+    //
+    ULONG InputBufferSize;
+    // Size of the output buffer that follows the input buffer.
+    //
+    ULONG OutputBufferSize;
+} AcpiTarget_CacheEntry;
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////////
 // Module Private Context
 ///////////////////////////////////////////////////////////////////////////////////////////////////////
 //
 
-// This Module has no Context.
+typedef struct _DMF_CONTEXT_AcpiTarget
+{
+    // List of AcpiTarget_CacheEntry when Client enables CacheResults.
+    //
+    LIST_ENTRY CacheList;
+    // Number of entries in CacheList.
+    //
+    ULONG CacheEntryCount;
+} DMF_CONTEXT_AcpiTarget;
+
+// This macro declares the following function:
+// DMF_CONTEXT_GET()
 //
-DMF_MODULE_DECLARE_NO_CONTEXT(AcpiTarget)
+DMF_MODULE_DECLARE_CONTEXT(AcpiTarget)
 
 // This macro declares the following function:
 // DMF_CONFIG_GET()
@@ -68,8 +100,364 @@ DMF_MODULE_DECLARE_CONFIG(AcpiTarget)
 
 #define NUMBER_OF_REALLOCATIONS_ALLOWED_IF_BUFFER_OVERFLOW  2
 
+// Upper bound on the number of cached results so that Clients which pass
+// ever changing arguments do not grow the cache without limit.
+//
+#define AcpiTarget_CacheEntryCountMaximum                   (64)
+
+#define AcpiTarget_CacheEntryInputBuffer(CacheEntry)        ((VOID*)((CacheEntry) + 1))
+#define AcpiTarget_CacheEntryOutputBuffer(CacheEntry)       Add2Ptr(AcpiTarget_CacheEntryInputBuffer(CacheEntry), (CacheEntry)->InputBufferSize)
+
 #pragma code_seg("PAGE")
 
+_IRQL_requires_max_(PASSIVE_LEVEL)
+static
+AcpiTarget_CacheEntry*
+AcpiTarget_CacheEntryFind(
+    _In_ DMF_CONTEXT_AcpiTarget* ModuleContext,
+    _In_ ULONG IoctlCode,
+    _In_reads_bytes_(InputBufferSize) VOID* InputBuffer,
+    _In_ ULONG InputBufferSize
+    )
+/*++
+
+Routine Description:
+
+    Find the cached result of an evaluation given the IOCTL and input buffer that
+    were sent to ACPI. Caller must hold the Module lock.
+
+Arguments:
+
+    ModuleContext - This Module's context.
+    IoctlCode - IOCTL used to evaluate the method.
+    InputBuffer - Input buffer sent to ACPI.
+    InputBufferSize - Size of InputBuffer in bytes.
+
+Return Value:
+
+    The matching cache entry or NULL if there is none.
+
+--*/
+{
+    LIST_ENTRY* listEntry;
+    AcpiTarget_CacheEntry* cacheEntry;
+    AcpiTarget_CacheEntry* foundEntry;
+
+    PAGED_CODE();
+
+    foundEntry = NULL;
+
+    listEntry = ModuleContext->CacheList.Flink;
+    while (listEntry != &ModuleContext->CacheList)
+    {
+        cacheEntry = CONTAINING_RECORD(listEntry,
+                                       AcpiTarget_CacheEntry,
+                                       ListEntry);
+        if ((cacheEntry->IoctlCode == IoctlCode) &&
+            (cacheEntry->InputBufferSize == InputBufferSize) &&
+            (RtlCompareMemory(AcpiTarget_CacheEntryInputBuffer(cacheEntry),
+                              InputBuffer,
+                              InputBufferSize) == InputBufferSize))
+        {
+            foundEntry = cacheEntry;
+            break;
+        }
+        listEntry = listEntry->Flink;
+    }
+
+    return foundEntry;
+}
+
+_IRQL_requires_max_(PASSIVE_LEVEL)
+_Must_inspect_result_
+static
+BOOLEAN
+AcpiTarget_CacheRead(
+    _In_ DMFMODULE DmfModule,
+    _In_ ULONG IoctlCode,
+    _In_reads_bytes_(InputBufferSize) VOID* InputBuffer,
+    _In_ ULONG InputBufferSize,
+    _Out_writes_bytes_opt_(OutputBufferSize) VOID* OutputBuffer,
+    _In_ ULONG OutputBufferSize,
+    _Out_opt_ WDFMEMORY* OutputBufferMemory,
+    _In_ ULONG Tag,
+    _Out_ ULONG* OutputSize
+    )
+/*++
+
+Routine Description:
+
+    Retrieve the cached result of an evaluation, if any. The result is copied either
+    to a Caller supplied buffer or to a buffer allocated on behalf of the Caller.
+
+Arguments:
+
+    DmfModule - This Module's handle.
+    IoctlCode - IOCTL used to evaluate the method.
+    InputBuffer - Input buffer that would be sent to ACPI.
+    InputBufferSize - Size of InputBuffer in bytes.
+    OutputBuffer - Optional Caller buffer where the cached result is copied.
+    OutputBufferSize - Size of OutputBuffer in bytes.
+    OutputBufferMemory - Optional address where a newly allocated copy of the cached result
+                         is returned. NULL is returned if the cached result is empty.
+    Tag - Identifies memory allocation source.
+    OutputSize - Size of the cached result in bytes.
+
+Return Value:
+
+    TRUE if a cached result was returned. FALSE if the Caller must evaluate the method.
+
+--*/
+{
+    DMF_CONTEXT_AcpiTarget* moduleContext;
+    DMF_CONFIG_AcpiTarget* moduleConfig;
+    AcpiTarget_CacheEntry* cacheEntry;
+    WDF_OBJECT_ATTRIBUTES objectAttributes;
+    VOID* outputBuffer;
+    NTSTATUS ntStatus;
+    BOOLEAN cacheHit;
+
+    PAGED_CODE();
+
+    moduleContext = DMF_CONTEXT_GET(DmfModule);
+    moduleConfig = DMF_CONFIG_GET(DmfModule);
+
+    cacheHit = FALSE;
+    *OutputSize = 0;
+    if (ARGUMENT_PRESENT(OutputBufferMemory))
+    {
+        *OutputBufferMemory = NULL;
+    }
+
+    if (! moduleConfig->CacheResults)
+    {
+        goto Exit;
+    }
+
+    DMF_ModuleLock(DmfModule);
+
+    cacheEntry = AcpiTarget_CacheEntryFind(moduleContext,
+                                           IoctlCode,
+                                           InputBuffer,
+                                           InputBufferSize);
+    if (NULL == cacheEntry)
+    {
+        // Not cached.
+        //
+    }
+    else if (ARGUMENT_PRESENT(OutputBuffer))
+    {
+        if (cacheEntry->OutputBufferSize <= OutputBufferSize)
+        {
+            RtlCopyMemory(OutputBuffer,
+                          AcpiTarget_CacheEntryOutputBuffer(cacheEntry),
+                          cacheEntry->OutputBufferSize);
+            *OutputSize = cacheEntry->OutputBufferSize;
+            cacheHit = TRUE;
+        }
+    }
+    else if (ARGUMENT_PRESENT(OutputBufferMemory) &&
+             (cacheEntry->OutputBufferSize > 0))
+    {
+        WDF_OBJECT_ATTRIBUTES_INIT(&objectAttributes);
+        objectAttributes.ParentObject = DmfModule;
+        ntStatus = WdfMemoryCreate(&objectAttributes,
+                                   PagedPool,
+                                   Tag,
+                                   cacheEntry->OutputBufferSize,
+                                   OutputBufferMemory,
+                                   &outputBuffer);
+        if (NT_SUCCESS(ntStatus))
+        {
+            RtlCopyMemory(outputBuffer,
+                          AcpiTarget_CacheEntryOutputBuffer(cacheEntry),
+                          cacheEntry->OutputBufferSize);
+            *OutputSize = cacheEntry->OutputBufferSize;
+            cacheHit = TRUE;
+        }
+        else
+        {
+            // Let the Caller evaluate the method which will report the error if it persists.
+            //
+            *OutputBufferMemory = NULL;
+            TraceEvents(TRACE_LEVEL_ERROR, DMF_TRACE, "WdfMemoryCreate ntStatus=%!STATUS!", ntStatus);
+        }
+    }
+    else
+    {
+        *OutputSize = cacheEntry->OutputBufferSize;
+        cacheHit = TRUE;
+    }
+
+    DMF_ModuleUnlock(DmfModule);
+
+Exit:
+
+    return cacheHit;
+}
+
+_IRQL_requires_max_(PASSIVE_LEVEL)
+static
+VOID
+AcpiTarget_CacheWrite(
+    _In_ DMFMODULE DmfModule,
+    _In_ ULONG IoctlCode,
+    _In_reads_bytes_(InputBufferSize) VOID* InputBuffer,
+    _In_ ULONG InputBufferSize,
+    _In_reads_bytes_opt_(OutputBufferSize) VOID* OutputBuffer,
+    _In_ ULONG OutputBufferSize
+    )
+/*++
+
+Routine Description:
+
+    Store the result of a successful evaluation so that subsequent evaluations with
+    the same input are satisfied without sending a request to ACPI.
+
+Arguments:
+
+    DmfModule - This Module's handle.
+    IoctlCode - IOCTL used to evaluate the method.
+    InputBuffer - Input buffer sent to ACPI.
+    InputBufferSize - Size of InputBuffer in bytes.
+    OutputBuffer - Output buffer returned by ACPI.
+    OutputBufferSize - Size of OutputBuffer in bytes.
+
+Return Value:
+
+    None
+
+--*/
+{
+    DMF_CONTEXT_AcpiTarget* moduleContext;
+    DMF_CONFIG_AcpiTarget* moduleConfig;
+    AcpiTarget_CacheEntry* cacheEntry;
+    WDF_OBJECT_ATTRIBUTES objectAttributes;
+    WDFMEMORY entryMemory;
+    size_t entrySize;
+    NTSTATUS ntStatus;
+
+    PAGED_CODE();
+
+    moduleContext = DMF_CONTEXT_GET(DmfModule);
+    moduleConfig = DMF_CONFIG_GET(DmfModule);
+
+    entryMemory = NULL;
+
+    if (! moduleConfig->CacheResults)
+    {
+        goto Exit;
+    }
+
+    // Both sizes come from ACPI buffers that are limited to ULONG so this cannot overflow.
+    //
+    entrySize = sizeof(AcpiTarget_CacheEntry) + (size_t)InputBufferSize + (size_t)OutputBufferSize;
+
+    WDF_OBJECT_ATTRIBUTES_INIT(&objectAttributes);
+    objectAttributes.ParentObject = DmfModule;
+    ntStatus = WdfMemoryCreate(&objectAttributes,
+                               PagedPool,
+                               MemoryTag,
+                               entrySize,
+                               &entryMemory,
+                               (VOID**)&cacheEntry);
+    if (!NT_SUCCESS(ntStatus))
+    {
+        // Caching is an optimization. The result has already been returned to the Client.
+        //
+        entryMemory = NULL;
+        TraceEvents(TRACE_LEVEL_ERROR, DMF_TRACE, "WdfMemoryCreate ntStatus=%!STATUS!", ntStatus);
+        goto Exit;
+    }
+
+    cacheEntry->EntryMemory = entryMemory;
+    cacheEntry->IoctlCode = IoctlCode;
+    cacheEntry->InputBufferSize = InputBufferSize;
+    cacheEntry->OutputBufferSize = OutputBufferSize;
+    RtlCopyMemory(AcpiTarget_CacheEntryInputBuffer(cacheEntry),
+                  InputBuffer,
+                  InputBufferSize);
+    if (OutputBufferSize > 0)
+    {
+        DmfAssert(OutputBuffer != NULL);
+        RtlCopyMemory(AcpiTarget_CacheEntryOutputBuffer(cacheEntry),
+                      OutputBuffer,
+                      OutputBufferSize);
+    }
+
+    DMF_ModuleLock(DmfModule);
+
+    // Another thread may have cached the same result while this thread evaluated it.
+    //
+    if ((moduleContext->CacheEntryCount < AcpiTarget_CacheEntryCountMaximum) &&
+        (NULL == AcpiTarget_CacheEntryFind(moduleContext,
+                                           IoctlCode,
+                                           InputBuffer,
+                                           InputBufferSize)))
+    {
+        InsertTailList(&moduleContext->CacheList,
+                       &cacheEntry->ListEntry);
+        moduleContext->CacheEntryCount++;
+        // Now owned by the cache.
+        //
+        entryMemory = NULL;
+    }
+
+    DMF_ModuleUnlock(DmfModule);
+
+Exit:
+
+    if (entryMemory != NULL)
+    {
+        WdfObjectDelete(entryMemory);
+    }
+}
+
+_IRQL_requires_max_(PASSIVE_LEVEL)
+static
+VOID
+AcpiTarget_CacheInvalidate(
+    _In_ DMFMODULE DmfModule
+    )
+/*++
+
+Routine Description:
+
+    Discard all cached results.
+
+Arguments:
+
+    DmfModule - This Module's handle.
+
+Return Value:
+
+    None
+
+--*/
+{
+    DMF_CONTEXT_AcpiTarget* moduleContext;
+    LIST_ENTRY* listEntry;
+    AcpiTarget_CacheEntry* cacheEntry;
+
+    PAGED_CODE();
+
+    moduleContext = DMF_CONTEXT_GET(DmfModule);
+
+    DMF_ModuleLock(DmfModule);
+
+    while (! IsListEmpty(&moduleContext->CacheList))
+    {
+        listEntry = RemoveHeadList(&moduleContext->CacheList);
+        cacheEntry = CONTAINING_RECORD(listEntry,
+                                       AcpiTarget_CacheEntry,
+                                       ListEntry);
+        WdfObjectDelete(cacheEntry->EntryMemory);
+    }
+    moduleContext->CacheEntryCount = 0;
+
+    DMF_ModuleUnlock(DmfModule);
+}
+
 _IRQL_requires_max_(PASSIVE_LEVEL)
 _Must_inspect_result_
 NTSTATUS
@@ -265,6 +653,7 @@ Return Value:
     ACPI_EVAL_INPUT_BUFFER smallInputBuffer;
     NTSTATUS ntStatus;
     WDFDEVICE device;
+    ULONG cachedSize;
 
     PAGED_CODE();
 
@@ -272,6 +661,7 @@ Return Value:
 
     outputBuffer = NULL;
     outputBufferMemory = NULL;
+    sizeReturned = 0;
     device = DMF_ParentDeviceGet(DmfModule);
 
     // If ReturnBuffer is present, so must ReturnBufferMemory be present.
@@ -358,64 +748,98 @@ Return Value:
         }
     }
 
-    // Set the IO target and initial size for the output buffer to be allocated.
-    // The IO target is the default underlying device object, which is ACPI
-    // in this case.
+    // Satisfy the request from the cache if the Client enabled it and this exact
+    // evaluation has succeeded before.
     //
-    attempts = 0;
-    ioTarget = WdfDeviceGetIoTarget(device);
-    outputBufferLength = INITIAL_CONTROL_METHOD_OUTPUT_SIZE;
-
-    // Set the input buffer.
-    //
-    WDF_MEMORY_DESCRIPTOR_INIT_BUFFER(&inputDescriptor,
-                                      (VOID*)inputBuffer,
-                                      inputBufferLength);
-
-    do
+    if (AcpiTarget_CacheRead(DmfModule,
+                             IOCTL_ACPI_EVAL_METHOD,
+                             inputBuffer,
+                             inputBufferLength,
+                             NULL,
+                             0,
+                             ARGUMENT_PRESENT(ReturnBuffer) ? &outputBufferMemory : NULL,
+                             Tag,
+                             &cachedSize))
     {
-        WDF_OBJECT_ATTRIBUTES objectAttributes;
-        WDF_OBJECT_ATTRIBUTES_INIT(&objectAttributes);
-        objectAttributes.ParentObject = DmfModule;
-        ntStatus = WdfMemoryCreate(&objectAttributes,
-                                   PagedPool,
-                                   Tag,
-                                   outputBufferLength,
-                                   &outputBufferMemory,
-                                   (VOID**)&outputBuffer);
-        if (!NT_SUCCESS(ntStatus))
+        if (outputBufferMemory != NULL)
         {
-            TraceEvents(TRACE_LEVEL_ERROR, DMF_TRACE, "WdfMemoryCreate ntStatus=%!STATUS!", ntStatus);
-            goto Exit;
+            outputBuffer = (PACPI_EVAL_OUTPUT_BUFFER)WdfMemoryGetBuffer(outputBufferMemory,
+                                                                        NULL);
         }
+        sizeReturned = cachedSize;
+        ntStatus = STATUS_SUCCESS;
+    }
+    else
+    {
+        // Set the IO target and initial size for the output buffer to be allocated.
+        // The IO target is the default underlying device object, which is ACPI
+        // in this case.
+        //
+        attempts = 0;
+        ioTarget = WdfDeviceGetIoTarget(device);
+        outputBufferLength = INITIAL_CONTROL_METHOD_OUTPUT_SIZE;
 
-        WDF_MEMORY_DESCRIPTOR_INIT_BUFFER(&outputDescriptor,
-                                          (VOID*)outputBuffer,
-                                          outputBufferLength);
-
-        ntStatus = WdfIoTargetSendIoctlSynchronously(ioTarget,
-                                                     NULL,
-                                                     IOCTL_ACPI_EVAL_METHOD,
-                                                     &inputDescriptor,
-                                                     &outputDescriptor,
-                                                     NULL,
-                                                     &sizeReturned);
-
-        // If the output buffer was insufficient, then re-allocate one with
-        // appropriate size and retry.
+        // Set the input buffer.
         //
-        if (STATUS_BUFFER_OVERFLOW == ntStatus)
+        WDF_MEMORY_DESCRIPTOR_INIT_BUFFER(&inputDescriptor,
+                                          (VOID*)inputBuffer,
+                                          inputBufferLength);
+
+        do
         {
-            outputBufferLength = outputBuffer->Length;
-            WdfObjectDelete(outputBufferMemory);
-            outputBufferMemory = NULL;
-            outputBuffer = NULL;
+            WDF_OBJECT_ATTRIBUTES objectAttributes;
+            WDF_OBJECT_ATTRIBUTES_INIT(&objectAttributes);
+            objectAttributes.ParentObject = DmfModule;
+            ntStatus = WdfMemoryCreate(&objectAttributes,
+                                       PagedPool,
+                                       Tag,
+                                       outputBufferLength,
+                                       &outputBufferMemory,
+                                       (VOID**)&outputBuffer);
+            if (!NT_SUCCESS(ntStatus))
+            {
+                TraceEvents(TRACE_LEVEL_ERROR, DMF_TRACE, "WdfMemoryCreate ntStatus=%!STATUS!", ntStatus);
+                goto Exit;
+            }
+
+            WDF_MEMORY_DESCRIPTOR_INIT_BUFFER(&outputDescriptor,
+                                              (VOID*)outputBuffer,
+                                              outputBufferLength);
+
+            ntStatus = WdfIoTargetSendIoctlSynchronously(ioTarget,
+                                                         NULL,
+                                                         IOCTL_ACPI_EVAL_METHOD,
+                                                         &inputDescriptor,
+                                                         &outputDescriptor,
+                                                         NULL,
+                                                         &sizeReturned);
+
+            // If the output buffer was insufficient, then re-allocate one with
+            // appropriate size and retry.
+            //
+            if (STATUS_BUFFER_OVERFLOW == ntStatus)
+            {
+                outputBufferLength = outputBuffer->Length;
+                WdfObjectDelete(outputBufferMemory);
+                outputBufferMemory = NULL;
+                outputBuffer = NULL;
+            }
+
+            attempts += 1;
         }
+        while ((ntStatus == STATUS_BUFFER_OVERFLOW) &&
+               (attempts < NUMBER_OF_REALLOCATIONS_ALLOWED_IF_BUFFER_OVERFLOW));
 
-        attempts += 1;
+        if (NT_SUCCESS(ntStatus))
+        {
+            AcpiTarget_CacheWrite(DmfModule,
+                                  IOCTL_ACPI_EVAL_METHOD,
+                                  inputBuffer,
+                                  inputBufferLength,
+                                  outputBuffer,
+                                  (ULONG)sizeReturned);
+        }
     }
-    while ((ntStatus == STATUS_BUFFER_OVERFLOW) &&
-           (attempts < NUMBER_OF_REALLOCATIONS_ALLOWED_IF_BUFFER_OVERFLOW));
 
     // If successful and data returned, return data to caller. If the method
     // returned no data, then set the return values to NULL.
@@ -431,7 +855,11 @@ Return Value:
         DmfAssert(sizeReturned >=
                   sizeof(ACPI_EVAL_OUTPUT_BUFFER) - sizeof(ACPI_METHOD_ARGUMENT));
 
-        DmfAssert(outputBuffer->Signature == ACPI_EVAL_OUTPUT_BUFFER_SIGNATURE);
+        // outputBuffer is not allocated when a cached result is used and the Caller
+        // does not want the data.
+        //
+        DmfAssert((NULL == outputBuffer) ||
+                  (outputBuffer->Signature == ACPI_EVAL_OUTPUT_BUFFER_SIGNATURE));
 
         if (ARGUMENT_PRESENT(ReturnBuffer))
         {
@@ -518,27 +946,47 @@ Return Value:
     WDF_MEMORY_DESCRIPTOR outputMemoryDescriptor;
     WDFDEVICE device;
     WDFIOTARGET ioTarget;
+    BOOLEAN cacheHit;
+    ULONG cachedSize;
 
     PAGED_CODE();
 
     FuncEntry(DMF_TRACE);
 
+    DmfAssert(InputMemoryDescriptor->Type == WdfMemoryDescriptorTypeBuffer);
+
     RtlZeroMemory(&outputBuffer,
                   sizeof(outputBuffer));
 
-    WDF_MEMORY_DESCRIPTOR_INIT_BUFFER(&outputMemoryDescriptor,
-                                      &outputBuffer,
-                                      (ULONG)sizeof(outputBuffer));
+    cacheHit = AcpiTarget_CacheRead(DmfModule,
+                                    IOCTL_ACPI_EVAL_METHOD_V1,
+                                    InputMemoryDescriptor->u.BufferType.Buffer,
+                                    InputMemoryDescriptor->u.BufferType.Length,
+                                    &outputBuffer,
+                                    (ULONG)sizeof(outputBuffer),
+                                    NULL,
+                                    0,
+                                    &cachedSize);
+    if (cacheHit)
+    {
+        ntStatus = STATUS_SUCCESS;
+    }
+    else
+    {
+        WDF_MEMORY_DESCRIPTOR_INIT_BUFFER(&outputMemoryDescriptor,
+                                          &outputBuffer,
+                                          (ULONG)sizeof(outputBuffer));
 
-    device = DMF_ParentDeviceGet(DmfModule);
-    ioTarget = WdfDeviceGetIoTarget(device);
-    ntStatus = WdfIoTargetSendIoctlSynchronously(ioTarget,
-                                                 NULL,
-                                                 IOCTL_ACPI_EVAL_METHOD_V1,
-                                                 InputMemoryDescriptor,
-                                                 &outputMemoryDescriptor,
-                                                 NULL,
-                                                 NULL);
+        device = DMF_ParentDeviceGet(DmfModule);
+        ioTarget = WdfDeviceGetIoTarget(device);
+        ntStatus = WdfIoTargetSendIoctlSynchronously(ioTarget,
+                                                     NULL,
+                                                     IOCTL_ACPI_EVAL_METHOD_V1,
+                                                     InputMemoryDescriptor,
+                                                     &outputMemoryDescriptor,
+                                                     NULL,
+                                                     NULL);
+    }
     if (!NT_SUCCESS(ntStatus))
     {
         TraceEvents(TRACE_LEVEL_ERROR, DMF_TRACE, "IOCTL_ACPI_EVAL_METHOD_V1 for method 0x%x fails: ntStatus=%!STATUS!",
@@ -565,6 +1013,15 @@ Return Value:
     else
     {
         *ReturnValue = outputBuffer.Argument[0].Argument;
+        if (! cacheHit)
+        {
+            AcpiTarget_CacheWrite(DmfModule,
+                                  IOCTL_ACPI_EVAL_METHOD_V1,
+                                  InputMemoryDescriptor->u.BufferType.Buffer,
+                                  InputMemoryDescriptor->u.BufferType.Length,
+                                  &outputBuffer,
+                                  (ULONG)sizeof(outputBuffer));
+        }
     }
 
     FuncExit(DMF_TRACE, "ntStatus=%!STATUS!", ntStatus);
@@ -919,21 +1376,149 @@ Exit:
     return ntStatus;
 }
 
+#pragma code_seg()
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////////
 // WDF Module Callbacks
 ///////////////////////////////////////////////////////////////////////////////////////////////////////
 //
 
+#pragma code_seg("PAGE")
+_Function_class_(DMF_ModuleD0Entry)
+_IRQL_requires_max_(PASSIVE_LEVEL)
+_Must_inspect_result_
+static
+NTSTATUS
+DMF_AcpiTarget_ModuleD0Entry(
+    _In_ DMFMODULE DmfModule,
+    _In_ WDF_POWER_DEVICE_STATE PreviousState
+    )
+/*++
+
+Routine Description:
+
+    Results of evaluations may change while the device is in low power so
+    discard them on the way up.
+
+Arguments:
+
+    DmfModule - The given DMF Module.
+    PreviousState - The WDF Power State that the given DMF Module should exit from.
+
+Return Value:
+
+    STATUS_SUCCESS
+
+--*/
+{
+    NTSTATUS ntStatus;
+
+    UNREFERENCED_PARAMETER(PreviousState);
+
+    PAGED_CODE();
+
+    FuncEntry(DMF_TRACE);
+
+    AcpiTarget_CacheInvalidate(DmfModule);
+
+    ntStatus = STATUS_SUCCESS;
+
+    FuncExit(DMF_TRACE, "ntStatus=%!STATUS!", ntStatus);
+
+    return ntStatus;
+}
+#pragma code_seg()
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////////
 // DMF Module Callbacks
 ///////////////////////////////////////////////////////////////////////////////////////////////////////
 //
 
+#pragma code_seg("PAGE")
+_Function_class_(DMF_Open)
+_IRQL_requires_max_(PASSIVE_LEVEL)
+_Must_inspect_result_
+static
+NTSTATUS
+DMF_AcpiTarget_Open(
+    _In_ DMFMODULE DmfModule
+    )
+/*++
+
+Routine Description:
+
+    Initialize an instance of a DMF Module of type AcpiTarget.
+
+Arguments:
+
+    DmfModule - The given DMF Module.
+
+Return Value:
+
+    STATUS_SUCCESS
+
+--*/
+{
+    NTSTATUS ntStatus;
+    DMF_CONTEXT_AcpiTarget* moduleContext;
+
+    PAGED_CODE();
+
+    FuncEntry(DMF_TRACE);
+
+    moduleContext = DMF_CONTEXT_GET(DmfModule);
+
+    InitializeListHead(&moduleContext->CacheList);
+    moduleContext->CacheEntryCount = 0;
+
+    ntStatus = STATUS_SUCCESS;
+
+    FuncExit(DMF_TRACE, "ntStatus=%!STATUS!", ntStatus);
+
+    return ntStatus;
+}
+#pragma code_seg()
+
+#pragma code_seg("PAGE")
+_Function_class_(DMF_Close)
+_IRQL_requires_max_(PASSIVE_LEVEL)
+static
+VOID
+DMF_AcpiTarget_Close(
+    _In_ DMFMODULE DmfModule
+    )
+/*++
+
+Routine Description:
+
+    Uninitialize an instance of a DMF Module of type AcpiTarget.
+
+Arguments:
+
+    DmfModule - The given DMF Module.
+
+Return Value:
+
+    None
+
+--*/
+{
+    PAGED_CODE();
+
+    FuncEntry(DMF_TRACE);
+
+    AcpiTarget_CacheInvalidate(DmfModule);
+
+    FuncExitVoid(DMF_TRACE);
+}
+#pragma code_seg()
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////////
 // Public Calls by Client
 ///////////////////////////////////////////////////////////////////////////////////////////////////////
 //
 
+#pragma code_seg("PAGE")
 _IRQL_requires_max_(PASSIVE_LEVEL)
 _Must_inspect_result_
 NTSTATUS
@@ -964,15 +1549,28 @@ Return Value:
 {
     NTSTATUS ntStatus;
     DMF_MODULE_DESCRIPTOR dmfModuleDescriptor_AcpiTarget;
+    DMF_CALLBACKS_DMF dmfCallbacksDmf_AcpiTarget;
+    DMF_CALLBACKS_WDF dmfCallbacksWdf_AcpiTarget;
 
     PAGED_CODE();
 
     FuncEntry(DMF_TRACE);
 
-    DMF_MODULE_DESCRIPTOR_INIT(dmfModuleDescriptor_AcpiTarget,
-                               AcpiTarget,
-                               DMF_MODULE_OPTIONS_PASSIVE,
-                               DMF_MODULE_OPEN_OPTION_OPEN_Create);
+    DMF_CALLBACKS_DMF_INIT(&dmfCallbacksDmf_AcpiTarget);
+    dmfCallbacksDmf_AcpiTarget.DeviceOpen = DMF_AcpiTarget_Open;
+    dmfCallbacksDmf_AcpiTarget.DeviceClose = DMF_AcpiTarget_Close;
+
+    DMF_CALLBACKS_WDF_INIT(&dmfCallbacksWdf_AcpiTarget);
+    dmfCallbacksWdf_AcpiTarget.ModuleD0Entry = DMF_AcpiTarget_ModuleD0Entry;
+
+    DMF_MODULE_DESCRIPTOR_INIT_CONTEXT_TYPE(dmfModuleDescriptor_AcpiTarget,
+                                            AcpiTarget,
+                                            DMF_CONTEXT_AcpiTarget,
+                                            DMF_MODULE_OPTIONS_PASSIVE,
+                                            DMF_MODULE_OPEN_OPTION_OPEN_Create);
+
+    dmfModuleDescriptor_AcpiTarget.CallbacksDmf = &dmfCallbacksDmf_AcpiTarget;
+    dmfModuleDescriptor_AcpiTarget.CallbacksWdf = &dmfCallbacksWdf_AcpiTarget;
 
     ntStatus = DMF_ModuleCreate(Device,
                                 DmfModuleAttributes,
@@ -992,6 +1590,139 @@ Return Value:
 // Module Methods
 //
 
+_IRQL_requires_max_(PASSIVE_LEVEL)
+VOID
+DMF_AcpiTarget_CacheInvalidate(
+    _In_ DMFMODULE DmfModule
+    )
+/*
+
+Routine Description:
+
+    Discard all results cached by this Module so that subsequent evaluations are
+    sent to ACPI.
+
+Arguments:
+
+    DmfModule - This Module's handle.
+
+Return Value:
+
+    None
+
+--*/
+{
+    PAGED_CODE();
+
+    FuncEntry(DMF_TRACE);
+
+    DMFMODULE_VALIDATE_IN_METHOD(DmfModule,
+                                 AcpiTarget);
+
+    AcpiTarget_CacheInvalidate(DmfModule);
+
+    FuncExitVoid(DMF_TRACE);
+}
+
+_IRQL_requires_max_(PASSIVE_LEVEL)
+_Must_inspect_result_
+NTSTATUS
+DMF_AcpiTarget_EvaluateBatch(
+    _In_ DMFMODULE DmfModule,
+    _Inout_updates_(NumberOfEvaluations) AcpiTarget_Evaluation* Evaluations,
+    _In_ ULONG NumberOfEvaluations,
+    _In_ ULONG Tag
+    )
+/*
+
+Routine Description:
+
+    Evaluate several ACPI Control Methods and/or DSMs in a single call. Every evaluation
+    is attempted regardless of whether a previous evaluation fails. The status and
+    result of each evaluation is returned in its entry.
+
+Arguments:
+
+    DmfModule - This Module's handle.
+    Evaluations - Array of evaluations to perform.
+    NumberOfEvaluations - Number of entries in Evaluations.
+    Tag - Identifies memory allocation source
+
+Return Value:
+
+    STATUS_SUCCESS if all evaluations succeed. Otherwise, the status of the first
+    evaluation that fails.
+
+--*/
+{
+    NTSTATUS ntStatus;
+    ULONG evaluationIndex;
+    AcpiTarget_Evaluation* evaluation;
+
+    PAGED_CODE();
+
+    FuncEntry(DMF_TRACE);
+
+    DMFMODULE_VALIDATE_IN_METHOD(DmfModule,
+                                 AcpiTarget);
+
+    ntStatus = STATUS_SUCCESS;
+
+    for (evaluationIndex = 0; evaluationIndex < NumberOfEvaluations; evaluationIndex++)
+    {
+        evaluation = &Evaluations[evaluationIndex];
+        evaluation->ReturnBufferMemory = NULL;
+        evaluation->ReturnBuffer = NULL;
+        evaluation->ReturnBufferSize = 0;
+
+        switch (evaluation->EvaluationType)
+        {
+            case AcpiTarget_EvaluationType_Method:
+            {
+                evaluation->NtStatus = AcpiTarget_EvaluateAcpiMethod(DmfModule,
+                                                                     evaluation->MethodName,
+                                                                     evaluation->InputBuffer,
+                                                                     &evaluation->ReturnBufferMemory,
+                                                                     &evaluation->ReturnBuffer,
+                                                                     &evaluation->ReturnBufferSize,
+                                                                     Tag);
+                break;
+            }
+            case AcpiTarget_EvaluationType_Dsm:
+            {
+                evaluation->NtStatus = AcpiTarget_InvokeDsm(DmfModule,
+                                                            evaluation->FunctionIndex,
+                                                            evaluation->InputBuffer,
+                                                            evaluation->InputBufferSize,
+                                                            &evaluation->ReturnBufferMemory,
+                                                            &evaluation->ReturnBuffer,
+                                                            &evaluation->ReturnBufferSize,
+                                                            Tag);
+                break;
+            }
+            default:
+            {
+                DmfAssert(FALSE);
+                evaluation->NtStatus = STATUS_INVALID_PARAMETER;
+                break;
+            }
+        }
+
+        if (! NT_SUCCESS(evaluation->NtStatus))
+        {
+            TraceEvents(TRACE_LEVEL_ERROR, DMF_TRACE, "Evaluation %u fails: ntStatus=%!STATUS!", evaluationIndex, evaluation->NtStatus);
+            if (NT_SUCCESS(ntStatus))
+            {
+                ntStatus = evaluation->NtStatus;
+            }
+        }
+    }
+
+    FuncExit(DMF_TRACE, "ntStatus=%!STATUS!", ntStatus);
+
+    return ntStatus;
+}
+
 _IRQL_requires_max_(PASSIVE_LEVEL)
 // 'ReturnBuffer' could be '0':  this does not adhere to the specification for the function 'AcpiTarget_EvaluateAcpiMethod'.
 //
@@ -30,8 +30,59 @@ typedef struct
     // The GUID that identifies the DSMs the Client will invoke.
     //
     GUID Guid;
+    // Cache the results of successful evaluations. Subsequent evaluations of the
+    // same method with the same arguments are satisfied from the cache until
+    // the device enters D0 or the Client calls DMF_AcpiTarget_CacheInvalidate().
+    //
+    BOOLEAN CacheResults;
 } DMF_CONFIG_AcpiTarget;
 
+typedef enum
+{
+    AcpiTarget_EvaluationType_Invalid = 0,
+    // Evaluate an ACPI Control Method.
+    //
+    AcpiTarget_EvaluationType_Method,
+    // Invoke a DSM using the Module's GUID and DSM revision.
+    //
+    AcpiTarget_EvaluationType_Dsm,
+    AcpiTarget_EvaluationType_Maximum
+} AcpiTarget_EvaluationType;
+
+// Describes a single evaluation passed to DMF_AcpiTarget_EvaluateBatch().
+//
+typedef struct
+{
+    // Input: Indicates how this entry is evaluated.
+    //
+    AcpiTarget_EvaluationType EvaluationType;
+    // Input: Method to evaluate (AcpiTarget_EvaluationType_Method).
+    //
+    ULONG MethodName;
+    // Input: DSM Function Index (AcpiTarget_EvaluationType_Dsm).
+    //
+    ULONG FunctionIndex;
+    // Input: Optional ACPI_EVAL_INPUT_BUFFER_* for AcpiTarget_EvaluationType_Method or
+    // DSM custom arguments for AcpiTarget_EvaluationType_Dsm.
+    //
+    VOID* InputBuffer;
+    // Input: Size of the DSM custom arguments (AcpiTarget_EvaluationType_Dsm).
+    //
+    ULONG InputBufferSize;
+    // Output: Result of this evaluation.
+    //
+    NTSTATUS NtStatus;
+    // Output: WDFMEMORY associated with ReturnBuffer. Client must delete it.
+    //
+    WDFMEMORY ReturnBufferMemory;
+    // Output: Raw ACPI output buffer.
+    //
+    VOID* ReturnBuffer;
+    // Output: Size of ReturnBuffer.
+    //
+    ULONG ReturnBufferSize;
+} AcpiTarget_Evaluation;
+
 // This macro declares the following functions:
 // DMF_AcpiTarget_ATTRIBUTES_INIT()
 // DMF_CONFIG_AcpiTarget_AND_ATTRIBUTES_INIT()
@@ -42,6 +93,22 @@ DECLARE_DMF_MODULE(AcpiTarget)
 // Module Methods
 //
 
+_IRQL_requires_max_(PASSIVE_LEVEL)
+VOID
+DMF_AcpiTarget_CacheInvalidate(
+    _In_ DMFMODULE DmfModule
+    );
+
+_IRQL_requires_max_(PASSIVE_LEVEL)
+_Must_inspect_result_
+NTSTATUS
+DMF_AcpiTarget_EvaluateBatch(
+    _In_ DMFMODULE DmfModule,
+    _Inout_updates_(NumberOfEvaluations) AcpiTarget_Evaluation* Evaluations,
+    _In_ ULONG NumberOfEvaluations,
+    _In_ ULONG Tag
+    );
+
 _IRQL_requires_max_(PASSIVE_LEVEL)
 _Must_inspect_result_
 NTSTATUS
@@ -89,6 +89,10 @@ typedef struct _DMF_CONTEXT_BufferPool
     // Offset of the second sentinel for a given buffer entry.
     //
     size_t ContextSentinelOffset;
+    // Services the timers of all the buffers created by this Module when
+    // TimerWheelTickMilliseconds is set. Otherwise, each buffer has its own WDFTIMER.
+    //
+    DMFMODULE DmfModuleTimerWheel;
 } DMF_CONTEXT_BufferPool;
 
 // This macro declares the following function:
@@ -138,6 +142,14 @@ typedef struct
     // NOTE: This timer is optionally created so it must be checked prior to use.
     //
     WDFTIMER Timer;
+    // Used instead of Timer when the Module that created this buffer services
+    // timers using a TimerWheel Child Module.
+    //
+    DMFMODULE DmfModuleTimerWheel;
+    TimerWheel_Timer TimerWheelTimer;
+    // Module whose list this buffer is in while its TimerWheelTimer is started.
+    //
+    DMFMODULE TimerWheelDmfModuleInsertedList;
     // For resetting timer again.
     //
     ULONGLONG TimerExpirationMilliseconds;
@@ -213,6 +225,116 @@ Return Value:
     BufferPoolEntry->TimerExpirationCallbackContext = NULL;
 }
 
+_IRQL_requires_max_(DISPATCH_LEVEL)
+BOOLEAN
+BufferPool_EntryTimerIsCreated(
+    _In_ BUFFERPOOL_ENTRY* BufferPoolEntry
+    )
+/*++
+
+Routine Description:
+
+    Indicates if the given buffer can be used with *WithTimer API.
+
+Arguments:
+
+    BufferPoolEntry - The given buffer.
+
+Return Value:
+
+    TRUE if the buffer has a timer.
+
+--*/
+{
+    return ((BufferPoolEntry->Timer != NULL) ||
+            (BufferPoolEntry->DmfModuleTimerWheel != NULL));
+}
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+BOOLEAN
+BufferPool_EntryTimerStart(
+    _In_ BUFFERPOOL_ENTRY* BufferPoolEntry,
+    _In_ LONGLONG DueTime
+    )
+/*++
+
+Routine Description:
+
+    Starts the timer of the given buffer using either its WDFTIMER or the
+    TimerWheel of the Module that created it.
+
+Arguments:
+
+    BufferPoolEntry - The given buffer.
+    DueTime - Relative due time in 100ns units as used by WdfTimerStart (zero or negative).
+
+Return Value:
+
+    TRUE if the timer was already started.
+
+--*/
+{
+    BOOLEAN timerWasInQueue;
+
+    DmfAssert(DueTime <= 0);
+
+    if (BufferPoolEntry->DmfModuleTimerWheel != NULL)
+    {
+        timerWasInQueue = DMF_TimerWheel_TimerStart(BufferPoolEntry->DmfModuleTimerWheel,
+                                                    &BufferPoolEntry->TimerWheelTimer,
+                                                    (ULONGLONG)(-DueTime) / WDF_TIMEOUT_TO_MS);
+    }
+    else
+    {
+        timerWasInQueue = WdfTimerStart(BufferPoolEntry->Timer,
+                                        DueTime);
+    }
+
+    return timerWasInQueue;
+}
+
+_When_(Wait == TRUE, _IRQL_requires_max_(PASSIVE_LEVEL))
+_When_(Wait == FALSE, _IRQL_requires_max_(DISPATCH_LEVEL))
+BOOLEAN
+BufferPool_EntryTimerStop(
+    _In_ BUFFERPOOL_ENTRY* BufferPoolEntry,
+    _In_ BOOLEAN Wait
+    )
+/*++
+
+Routine Description:
+
+    Stops the timer of the given buffer using either its WDFTIMER or the
+    TimerWheel of the Module that created it.
+
+Arguments:
+
+    BufferPoolEntry - The given buffer.
+    Wait - Indicates if the call waits for a running timer callback to return.
+
+Return Value:
+
+    TRUE if the timer was started and is now stopped. Its callback will not be called.
+
+--*/
+{
+    BOOLEAN timerWasInQueue;
+
+    if (BufferPoolEntry->DmfModuleTimerWheel != NULL)
+    {
+        timerWasInQueue = DMF_TimerWheel_TimerStop(BufferPoolEntry->DmfModuleTimerWheel,
+                                                   &BufferPoolEntry->TimerWheelTimer,
+                                                   Wait);
+    }
+    else
+    {
+        timerWasInQueue = WdfTimerStop(BufferPoolEntry->Timer,
+                                       Wait);
+    }
+
+    return timerWasInQueue;
+}
+
 _IRQL_requires_max_(DISPATCH_LEVEL)
 VOID
 BufferPool_BuffersInListDecrement(
@@ -348,8 +470,8 @@ Return Value:
         {
             // The timer is running. Try to stop it.
             //
-            if (! WdfTimerStop(bufferPoolEntry->Timer,
-                               FALSE))
+            if (! BufferPool_EntryTimerStop(bufferPoolEntry,
+                                            FALSE))
             {
                 // Timer callback will be called soon, so skip this buffer.
                 // (Try to remove the next buffer.)
@@ -695,7 +817,8 @@ BufferPool_BufferPoolTimerContextSet(
 
 Routine Description:
 
-    Store the given DMF Module handle in BufferPoolEntry Timer's context.
+    Store the given DMF Module handle in BufferPoolEntry Timer's context
+    (or in BufferPoolEntry itself when its timer is serviced by a TimerWheel).
 
 Arguments:
 
@@ -711,29 +834,38 @@ Return Value:
     BUFFERPOOL_TIMER_CONTEXT* bufferPoolTimerContext;
 
     DmfAssert(BufferPoolEntry != NULL);
-    DmfAssert(BufferPoolEntry->Timer != NULL);
+    DmfAssert(BufferPool_EntryTimerIsCreated(BufferPoolEntry));
 
-    bufferPoolTimerContext = WdfObjectGet_BUFFERPOOL_TIMER_CONTEXT(BufferPoolEntry->Timer);
-    DmfAssert(bufferPoolTimerContext->BufferPoolEntry == BufferPoolEntry);
+    if (BufferPoolEntry->DmfModuleTimerWheel != NULL)
+    {
+        BufferPoolEntry->TimerWheelDmfModuleInsertedList = DmfModule;
+    }
+    else
+    {
+        bufferPoolTimerContext = WdfObjectGet_BUFFERPOOL_TIMER_CONTEXT(BufferPoolEntry->Timer);
+        DmfAssert(bufferPoolTimerContext->BufferPoolEntry == BufferPoolEntry);
 
-    bufferPoolTimerContext->DmfModuleInsertedList = DmfModule;
+        bufferPoolTimerContext->DmfModuleInsertedList = DmfModule;
+    }
 }
 
 VOID
-BufferPool_BufferPoolEntryTimerHandler(
-    _In_ WDFTIMER WdfTimer
+BufferPool_BufferPoolEntryTimerExpire(
+    _In_ DMFMODULE DmfModule,
+    _In_ BUFFERPOOL_ENTRY* BufferPoolEntry
     )
 /*++
 
 Routine Description:
 
-    Timer callback. The BufferPool entry corresponding to the timer will be removed 
-    from the list, and will be passed to the Client's timer expiration callback.
-    Upon timer expiration callback, Client owns the buffer. 
+    Called when the timer of a buffer expires. The BufferPool entry corresponding to the
+    timer will be removed from the list, and will be passed to the Client's timer expiration
+    callback. Upon timer expiration callback, Client owns the buffer. 
 
 Parameters:
 
-    WdfTimer - The timer object that contains the PBUFFER_LIST_ENTRY.
+    DmfModule - The Module whose list the buffer was inserted in when its timer started.
+    BufferPoolEntry - The buffer whose timer expired.
 
 Return:
 
@@ -741,86 +873,54 @@ Return:
 
 --*/
 {
-    BUFFERPOOL_TIMER_CONTEXT* bufferPoolTimerContext;
-    BUFFERPOOL_ENTRY* bufferPoolEntryTimer;
-    BUFFERPOOL_ENTRY* bufferPoolEntryInList;
-    DMFMODULE dmfModule;
     DMF_CONTEXT_BufferPool* moduleContext;
     EVT_DMF_BufferPool_TimerCallback* timerExpirationCallback;
     VOID* timerExpirationCallbackContext;
-    LIST_ENTRY* listEntry;
 
     FuncEntry(DMF_TRACE);
 
     TraceEvents(TRACE_LEVEL_VERBOSE, DMF_TRACE, "BufferPool Entry timer expires");
 
-    // Get the BUFFERPOOL_TIMER_CONTEXT from the WDF Object.
-    //
-    bufferPoolTimerContext = WdfObjectGet_BUFFERPOOL_TIMER_CONTEXT(WdfTimer);
-    DmfAssert(bufferPoolTimerContext != NULL);
-    bufferPoolEntryTimer = bufferPoolTimerContext->BufferPoolEntry;
-    dmfModule = bufferPoolTimerContext->DmfModuleInsertedList;
-    DmfAssert(dmfModule != NULL);
+    DmfAssert(DmfModule != NULL);
 
-    moduleContext = DMF_CONTEXT_GET(dmfModule);
+    moduleContext = DMF_CONTEXT_GET(DmfModule);
 
-    DMF_ModuleLock(dmfModule);
+    DMF_ModuleLock(DmfModule);
 
     timerExpirationCallback = NULL;
     timerExpirationCallbackContext = NULL;
     // If timer callback executed, buffer associated with the timer should be present in the list.
-    // But it might not be the first one. Search for it.
+    // The buffer records the list it is in, so there is no need to search the list for it.
+    // (When many timers expire together, searching for each buffer is quadratic.)
     //
-    listEntry = moduleContext->BufferList.Flink;
-    while (listEntry != &moduleContext->BufferList)
+    // Only remove the buffer if it's in the list AND the Client Driver's
+    // callback is not NULL. It is a legitimate case that the callback is NULL if the
+    // buffer had been removed from the list and added back without a timer.
+    //
+    if ((BufferPoolEntry->CurrentlyInsertedList == &moduleContext->BufferList) &&
+        (BufferPoolEntry->TimerExpirationCallback != NULL))
     {
-        // Prepare to call the enumeration function.
-        //
-        bufferPoolEntryInList = CONTAINING_RECORD(listEntry,
-                                                  BUFFERPOOL_ENTRY,
-                                                  ListEntry);
-
-        // Prepare to read the next entry in list at top of loop.
-        //
-        listEntry = listEntry->Flink;
+        DmfAssert(BufferPoolEntry->CurrentlyInsertedDmfModule == DmfModule);
+        DmfAssert(BufferPool_EntryTimerIsCreated(BufferPoolEntry));
 
-        // Only remove the buffer if it's in the list AND the Client Driver's
-        // callback is not NULL. It is a legitimate case that the callback is NULL if the
-        // buffer had been removed from the list and added back without a timer.
+        // Remove item from list.
+        // (If the Client wants to use this buffer, Client has saved off the buffer in Client's Context).
+        // NOTE: Client Driver now owns buffer!
         //
-        if ((bufferPoolEntryInList == bufferPoolEntryTimer) &&
-            (bufferPoolEntryTimer->TimerExpirationCallback) != NULL)
-        {
-            // Found it. Remove it from list 
-            //
-            DmfAssert(bufferPoolEntryTimer->Timer != NULL);
-
-            // Remove item from list.
-            // (If the Client wants to use this buffer, Client has saved off the buffer in Client's Context).
-            // NOTE: Client Driver now owns buffer!
-            //
-            BufferPool_RemoveEntryList(dmfModule,
-                                       moduleContext,
-                                       bufferPoolEntryTimer);
-
-            // These fields are both cleared in the next call. Save off so they can be passed to
-            // Client, otherwise they are NULL.
-            //
-            timerExpirationCallback = bufferPoolEntryTimer->TimerExpirationCallback;
-            timerExpirationCallbackContext = bufferPoolEntryTimer->TimerExpirationCallbackContext;
-            BufferPool_TimerFieldsClear(dmfModule,
-                                        bufferPoolEntryTimer);
-            
-            // The only matching buffer has been found.
-            //
-            break;
-        }
+        BufferPool_RemoveEntryList(DmfModule,
+                                   moduleContext,
+                                   BufferPoolEntry);
 
-        // Keep searching.
+        // These fields are both cleared in the next call. Save off so they can be passed to
+        // Client, otherwise they are NULL.
         //
+        timerExpirationCallback = BufferPoolEntry->TimerExpirationCallback;
+        timerExpirationCallbackContext = BufferPoolEntry->TimerExpirationCallbackContext;
+        BufferPool_TimerFieldsClear(DmfModule,
+                                    BufferPoolEntry);
     }
 
-    DMF_ModuleUnlock(dmfModule);
+    DMF_ModuleUnlock(DmfModule);
 
     // Due to race conditions with cancel routines, it is possible the buffer was removed from the list
     // during timer expiration.
@@ -829,9 +929,9 @@ Return:
     {
         // Call the client driver's timer callback function.
         //
-        timerExpirationCallback(dmfModule,
-                                bufferPoolEntryTimer->ClientBuffer,
-                                bufferPoolEntryTimer->ClientBufferContext,
+        timerExpirationCallback(DmfModule,
+                                BufferPoolEntry->ClientBuffer,
+                                BufferPoolEntry->ClientBufferContext,
                                 timerExpirationCallbackContext);
     }
     else
@@ -843,6 +943,78 @@ Return:
     FuncExitVoid(DMF_TRACE);
 }
 
+VOID
+BufferPool_BufferPoolEntryTimerHandler(
+    _In_ WDFTIMER WdfTimer
+    )
+/*++
+
+Routine Description:
+
+    Timer callback of the WDFTIMER created with the buffer.
+
+Parameters:
+
+    WdfTimer - The timer object that contains the PBUFFER_LIST_ENTRY.
+
+Return:
+
+    None
+
+--*/
+{
+    BUFFERPOOL_TIMER_CONTEXT* bufferPoolTimerContext;
+
+    // Get the BUFFERPOOL_TIMER_CONTEXT from the WDF Object.
+    //
+    bufferPoolTimerContext = WdfObjectGet_BUFFERPOOL_TIMER_CONTEXT(WdfTimer);
+    DmfAssert(bufferPoolTimerContext != NULL);
+
+    BufferPool_BufferPoolEntryTimerExpire(bufferPoolTimerContext->DmfModuleInsertedList,
+                                          bufferPoolTimerContext->BufferPoolEntry);
+}
+
+_Function_class_(EVT_DMF_TimerWheel_TimerExpired)
+_IRQL_requires_max_(PASSIVE_LEVEL)
+_IRQL_requires_same_
+VOID
+BufferPool_BufferPoolEntryTimerWheelHandler(
+    _In_ DMFMODULE DmfModule,
+    _In_ TimerWheel_Timer* Timer,
+    _In_opt_ VOID* ClientCallbackContext
+    )
+/*++
+
+Routine Description:
+
+    Timer callback of the TimerWheel Child Module. All the buffers whose timers
+    expire in the same tick are passed here one after the other.
+
+Parameters:
+
+    DmfModule - TimerWheel Child Module.
+    Timer - The timer that expired.
+    ClientCallbackContext - The buffer that contains Timer.
+
+Return:
+
+    None
+
+--*/
+{
+    BUFFERPOOL_ENTRY* bufferPoolEntry;
+
+    UNREFERENCED_PARAMETER(DmfModule);
+    UNREFERENCED_PARAMETER(Timer);
+
+    bufferPoolEntry = (BUFFERPOOL_ENTRY*)ClientCallbackContext;
+    DmfAssert(bufferPoolEntry != NULL);
+    DmfAssert(&bufferPoolEntry->TimerWheelTimer == Timer);
+
+    BufferPool_BufferPoolEntryTimerExpire(bufferPoolEntry->TimerWheelDmfModuleInsertedList,
+                                          bufferPoolEntry);
+}
+
 #if defined(DMF_USER_MODE)
 _IRQL_requires_max_(PASSIVE_LEVEL)
 #else
@@ -936,7 +1108,21 @@ Return Value:
     *(bufferPoolEntry->SentinelContext) = BufferPool_SentinelContext;
     // Timer related.
     //
-    if (moduleConfig->Mode.SourceSettings.CreateWithTimer)
+    bufferPoolEntry->DmfModuleTimerWheel = NULL;
+    bufferPoolEntry->TimerWheelDmfModuleInsertedList = NULL;
+    if (moduleContext->DmfModuleTimerWheel != NULL)
+    {
+        // One timer (in the Child Module) services all the buffers.
+        //
+        DmfAssert(moduleConfig->Mode.SourceSettings.CreateWithTimer);
+        bufferPoolEntry->Timer = NULL;
+        bufferPoolEntry->DmfModuleTimerWheel = moduleContext->DmfModuleTimerWheel;
+        DMF_TimerWheel_TimerInitialize(moduleContext->DmfModuleTimerWheel,
+                                       &bufferPoolEntry->TimerWheelTimer,
+                                       BufferPool_BufferPoolEntryTimerWheelHandler,
+                                       bufferPoolEntry);
+    }
+    else if (moduleConfig->Mode.SourceSettings.CreateWithTimer)
     {
         WDF_TIMER_CONFIG_INIT(&timerConfig,
                               BufferPool_BufferPoolEntryTimerHandler);
@@ -1465,6 +1651,17 @@ Return:
         // List entry is now accessible only by this thread
         // Other threads accessing the collection will not find this list entry and hence will not access it.
 
+        if (bufferPoolEntryInList->DmfModuleTimerWheel != NULL)
+        {
+            // Stop and wait for timer callback to execute.
+            // NOTE: Callback will first look in list and see that corresponding
+            //       buffer is removed so it will do nothing.
+            //
+            DMF_TimerWheel_TimerStop(bufferPoolEntryInList->DmfModuleTimerWheel,
+                                     &bufferPoolEntryInList->TimerWheelTimer,
+                                     TRUE);
+        }
+
         if (timer != NULL)
         {
             // Stop and wait for timer callback to execute.
@@ -1632,6 +1829,67 @@ Return Value:
 ///////////////////////////////////////////////////////////////////////////////////////////////////////
 //
 
+#pragma code_seg("PAGE")
+_Function_class_(DMF_ChildModulesAdd)
+_IRQL_requires_max_(PASSIVE_LEVEL)
+VOID
+DMF_BufferPool_ChildModulesAdd(
+    _In_ DMFMODULE DmfModule,
+    _In_ DMF_MODULE_ATTRIBUTES* DmfParentModuleAttributes,
+    _In_ PDMFMODULE_INIT DmfModuleInit
+    )
+/*++
+
+Routine Description:
+
+    Configure and add the required Child Modules to the given Parent Module.
+
+Arguments:
+
+    DmfModule - The given Parent Module.
+    DmfParentModuleAttributes - Pointer to the parent DMF_MODULE_ATTRIBUTES structure.
+    DmfModuleInit - Opaque structure to be passed to DMF_DmfModuleAdd.
+
+Return Value:
+
+    None
+
+--*/
+{
+    DMF_MODULE_ATTRIBUTES moduleAttributes;
+    DMF_CONFIG_BufferPool* moduleConfig;
+    DMF_CONTEXT_BufferPool* moduleContext;
+    DMF_CONFIG_TimerWheel moduleConfigTimerWheel;
+
+    UNREFERENCED_PARAMETER(DmfParentModuleAttributes);
+
+    PAGED_CODE();
+
+    FuncEntry(DMF_TRACE);
+
+    moduleConfig = DMF_CONFIG_GET(DmfModule);
+    moduleContext = DMF_CONTEXT_GET(DmfModule);
+
+    if ((moduleConfig->BufferPoolMode == BufferPool_Mode_Source) &&
+        (moduleConfig->Mode.SourceSettings.CreateWithTimer) &&
+        (moduleConfig->Mode.SourceSettings.TimerWheelTickMilliseconds > 0))
+    {
+        // TimerWheel
+        // ----------
+        //
+        DMF_CONFIG_TimerWheel_AND_ATTRIBUTES_INIT(&moduleConfigTimerWheel,
+                                                  &moduleAttributes);
+        moduleConfigTimerWheel.TickMilliseconds = moduleConfig->Mode.SourceSettings.TimerWheelTickMilliseconds;
+        DMF_DmfModuleAdd(DmfModuleInit,
+                         &moduleAttributes,
+                         WDF_NO_OBJECT_ATTRIBUTES,
+                         &moduleContext->DmfModuleTimerWheel);
+    }
+
+    FuncExitVoid(DMF_TRACE);
+}
+#pragma code_seg()
+
 #pragma code_seg("PAGE")
 _Function_class_(DMF_Open)
 _IRQL_requires_max_(PASSIVE_LEVEL)
@@ -1752,6 +2010,7 @@ Return Value:
     FuncEntry(DMF_TRACE);
 
     DMF_CALLBACKS_DMF_INIT(&dmfCallbacksDmf_BufferPool);
+    dmfCallbacksDmf_BufferPool.ChildModulesAdd = DMF_BufferPool_ChildModulesAdd;
     dmfCallbacksDmf_BufferPool.DeviceOpen = DMF_BufferPool_Open;
     dmfCallbacksDmf_BufferPool.DeviceClose = DMF_BufferPool_Close;
 
@@ -1970,8 +2229,8 @@ Return Value:
         {
             // Temporarily try to stop the timer to prevent future race conditions. 
             //
-            if (! WdfTimerStop(bufferPoolEntry->Timer,
-                               FALSE))
+            if (! BufferPool_EntryTimerStop(bufferPoolEntry,
+                                            FALSE))
             {
                 // Timer callback will be called soon, so skip this buffer.
                 //
@@ -2020,8 +2279,8 @@ Return Value:
                 //
                 if (bufferPoolEntry->TimerExpirationCallback != NULL)
                 {
-                    timerWasInQueue = WdfTimerStart(bufferPoolEntry->Timer,
-                                                    differenceInTime100ns);
+                    timerWasInQueue = BufferPool_EntryTimerStart(bufferPoolEntry,
+                                                                 differenceInTime100ns);
                     DmfAssert(! timerWasInQueue);
                 }
                 break;
@@ -2087,8 +2346,8 @@ Return Value:
                 //
                 if (bufferPoolEntry->TimerExpirationCallback)
                 {
-                    timerWasInQueue = WdfTimerStart(bufferPoolEntry->Timer,
-                                                    WDF_REL_TIMEOUT_IN_MS(bufferPoolEntry->TimerExpirationMilliseconds));
+                    timerWasInQueue = BufferPool_EntryTimerStart(bufferPoolEntry,
+                                                                 WDF_REL_TIMEOUT_IN_MS(bufferPoolEntry->TimerExpirationMilliseconds));
                     DmfAssert(! timerWasInQueue);
                 }
                 break;
@@ -2538,7 +2797,7 @@ Return Value:
     // NOTE: Client Driver (caller) owns the buffer at this time.
     //
     bufferPoolEntry = BufferPool_BufferPoolEntryGetFromClientBuffer(ClientBuffer);
-    DmfAssert(bufferPoolEntry->Timer != NULL);
+    DmfAssert(BufferPool_EntryTimerIsCreated(bufferPoolEntry));
 
     // NOTE: The timer is guaranteed to be not running,
     //       since it was stop or expired when Client got the buffer.
@@ -2577,8 +2836,8 @@ Return Value:
     // This is because Client has no direct access to the timer. The timer was stopped when the buffer was 
     // previously retrieved.
     //
-    timerWasInQueue = WdfTimerStart(bufferPoolEntry->Timer,
-                                    WDF_REL_TIMEOUT_IN_MS(TimerExpirationMilliseconds));
+    timerWasInQueue = BufferPool_EntryTimerStart(bufferPoolEntry,
+                                                 WDF_REL_TIMEOUT_IN_MS(TimerExpirationMilliseconds));
     DmfAssert(! timerWasInQueue);
 
     DMF_ModuleUnlock(DmfModule);
@@ -111,6 +111,11 @@ typedef struct
     // another list using *WithTimer API.
     //
     ULONG CreateWithTimer;
+    // If not zero (and CreateWithTimer is set), the timers of all the buffers are
+    // serviced by a single timer that ticks at this interval in milliseconds, instead
+    // of one WDFTIMER per buffer. Timers expire on the first tick after their timeout.
+    //
+    ULONG TimerWheelTickMilliseconds;
     // Pool Type.
     // Note: Pool type can be passive if PassiveLevel in Module Attributes is set to TRUE.
     //
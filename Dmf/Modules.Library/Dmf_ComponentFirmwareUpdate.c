@@ -88,6 +88,52 @@ typedef struct _PAYLOAD_RESPONSE
     COMPONENT_FIRMWARE_UPDATE_PAYLOAD_RESPONSE ResponseStatus;
 } PAYLOAD_RESPONSE;
 
+// Structure to hold a payload chunk that was sent to device and is waiting for its response.
+//
+typedef struct _PAYLOAD_WINDOW_SLOT
+{
+    // Buffer (including the transport header) that holds the chunk. It is kept so the chunk can be sent again.
+    //
+    UCHAR* BufferHeader;
+    // Sequence number of the chunk.
+    //
+    UINT16 SequenceNumber;
+    // Where the chunk starts in the payload. Used to resume an interrupted update.
+    //
+    ULONG BinRecordStartIndex;
+    BYTE BinRecordDataOffset;
+    // Number of times the chunk was sent again after the device failed it.
+    //
+    ULONG RetransmitCount;
+    // Indicates the device responded to the chunk with success.
+    //
+    BOOLEAN Acknowledged;
+} PAYLOAD_WINDOW_SLOT;
+
+// Structure to hold the part of a payload that is available to send to device.
+// The whole payload is available when the Client provides it in a buffer. Otherwise, the payload is read
+// from the Client in parts as it is sent.
+//
+typedef struct _PAYLOAD_STREAM
+{
+    // Index of the firmware component the payload belongs to.
+    //
+    DWORD FirmwareComponentIndex;
+    // Total size of the payload in bytes.
+    //
+    size_t PayloadSize;
+    // Buffer that holds the available part of the payload and its size.
+    //
+    BYTE* Buffer;
+    size_t BufferSize;
+    // Index in the payload of the first byte in Buffer.
+    //
+    ULONG BaseIndex;
+    // Number of bytes of the payload available in Buffer.
+    //
+    size_t AvailableSize;
+} PAYLOAD_STREAM;
+
 // This context associated with the plugged in protocol Module.
 //
 typedef struct _CONTEXT_ComponentFirmwareUpdateTransaction
@@ -204,6 +250,17 @@ PCWSTR ComponentFirmwareUpdate_ResumeOnConnectValueName = L"ResumeOnConnect";
 // Firmware Version is 60 bytes long.
 //
 #define SizeOfFirmwareVersion (60)
+// Maximum number of payload chunks that can be in flight at a time.
+//
+#define MaximumPayloadWindowSize (64)
+// A payload chunk can span many bin records. At most one record per byte of the chunk plus the record
+// that follows are needed, and each record can be up to 260 bytes long. This much of the payload
+// must be available in order to fill a chunk.
+//
+#define MinimumPayloadReadAheadSize ((SizeOfPayload + 1) * (sizeof(ULONG) + sizeof(BYTE) + BYTE_MAX))
+// Size of the buffer used to read the payload from the Client if the Client does not specify one.
+//
+#define DefaultPayloadReadAheadSize (64 * 1024)
 
 #define Thread_NumberOfWaitObjects (2)
 const BYTE FWUPDATE_DRIVER_TOKEN = 0xA0;
@@ -590,6 +647,200 @@ Exit:
 }
 #pragma code_seg()
 
+static
+const BYTE*
+ComponentFirmwareUpdate_PayloadStreamBinRecordGet(
+    _In_ const PAYLOAD_STREAM* PayloadStream,
+    _In_ ULONG PayloadBufferBinRecordStartIndex
+    )
+/*++
+
+Routine Description:
+
+    Get a pointer to a bin record of the payload if the whole bin record is available.
+
+Arguments:
+
+    PayloadStream - The available part of the payload.
+    PayloadBufferBinRecordStartIndex - Index into the payload that corresponds to a bin record's beginning.
+
+Return Value:
+
+    Pointer to the bin record or NULL if the whole bin record is not available.
+
+--*/
+{
+    // Bin record header is Address (4 bytes) and Length (1 byte).
+    //
+    const size_t binRecordHeaderLength = sizeof(ULONG) + sizeof(BYTE);
+    size_t offset;
+
+    if (PayloadBufferBinRecordStartIndex < PayloadStream->BaseIndex)
+    {
+        return NULL;
+    }
+
+    offset = PayloadBufferBinRecordStartIndex - PayloadStream->BaseIndex;
+    if ((offset > PayloadStream->AvailableSize) ||
+        (PayloadStream->AvailableSize - offset < binRecordHeaderLength))
+    {
+        return NULL;
+    }
+
+    if (PayloadStream->AvailableSize - offset - binRecordHeaderLength < PayloadStream->Buffer[offset + sizeof(ULONG)])
+    {
+        return NULL;
+    }
+
+    return PayloadStream->Buffer + offset;
+}
+
+#pragma code_seg("PAGE")
+_IRQL_requires_max_(PASSIVE_LEVEL)
+_Must_inspect_result_
+static
+NTSTATUS
+ComponentFirmwareUpdate_PayloadStreamReadAhead(
+    _In_ DMFMODULE DmfModule,
+    _Inout_ PAYLOAD_STREAM* PayloadStream,
+    _In_ ULONG PayloadBufferBinRecordStartIndex
+    )
+/*++
+
+Routine Description:
+
+    Make sure that enough of the payload starting at a given index is available to fill a payload chunk.
+    When the payload is read from the Client, the part of the payload that is still needed is kept and
+    the rest of the buffer is filled from the Client.
+
+Arguments:
+
+    DmfModule - This Module's DMF Object.
+    PayloadStream - The available part of the payload.
+    PayloadBufferBinRecordStartIndex - Index into the payload of the next bin record to send.
+
+Return Value:
+
+    NTSTATUS
+
+--*/
+{
+    NTSTATUS ntStatus;
+    DMF_CONFIG_ComponentFirmwareUpdate* moduleConfig;
+    size_t requiredSize;
+    size_t keptSize;
+    size_t bytesRead;
+
+    PAGED_CODE();
+
+    ntStatus = STATUS_SUCCESS;
+
+    if (PayloadBufferBinRecordStartIndex >= PayloadStream->PayloadSize)
+    {
+        // Nothing more to read. PayloadBufferFill validates the index.
+        //
+        goto Exit;
+    }
+
+    requiredSize = PayloadStream->PayloadSize - PayloadBufferBinRecordStartIndex;
+    if (requiredSize > MinimumPayloadReadAheadSize)
+    {
+        requiredSize = MinimumPayloadReadAheadSize;
+    }
+
+    if ((PayloadBufferBinRecordStartIndex >= PayloadStream->BaseIndex) &&
+        (PayloadBufferBinRecordStartIndex - PayloadStream->BaseIndex <= PayloadStream->AvailableSize) &&
+        (PayloadStream->AvailableSize - (PayloadBufferBinRecordStartIndex - PayloadStream->BaseIndex) >= requiredSize))
+    {
+        // Already available. This is always the case when the Client provides the whole payload.
+        //
+        goto Exit;
+    }
+
+    moduleConfig = DMF_CONFIG_GET(DmfModule);
+    DmfAssert(moduleConfig->EvtComponentFirmwareUpdateFirmwarePayloadRead != NULL);
+    DmfAssert(PayloadStream->BufferSize >= MinimumPayloadReadAheadSize);
+
+    // Keep the part of the payload that is still needed and move it to the start of the buffer.
+    //
+    if ((PayloadBufferBinRecordStartIndex >= PayloadStream->BaseIndex) &&
+        (PayloadBufferBinRecordStartIndex - PayloadStream->BaseIndex <= PayloadStream->AvailableSize))
+    {
+        keptSize = PayloadStream->AvailableSize - (PayloadBufferBinRecordStartIndex - PayloadStream->BaseIndex);
+        memmove(PayloadStream->Buffer,
+                PayloadStream->Buffer + (PayloadBufferBinRecordStartIndex - PayloadStream->BaseIndex),
+                keptSize);
+    }
+    else
+    {
+        keptSize = 0;
+    }
+    PayloadStream->BaseIndex = PayloadBufferBinRecordStartIndex;
+    PayloadStream->AvailableSize = keptSize;
+
+    // Read from the Client until the buffer is full or the whole payload has been read.
+    //
+    while ((PayloadStream->AvailableSize < PayloadStream->BufferSize) &&
+           (PayloadStream->BaseIndex + PayloadStream->AvailableSize < PayloadStream->PayloadSize))
+    {
+        size_t bytesToRead;
+
+        bytesToRead = PayloadStream->BufferSize - PayloadStream->AvailableSize;
+        if (bytesToRead > PayloadStream->PayloadSize - PayloadStream->BaseIndex - PayloadStream->AvailableSize)
+        {
+            bytesToRead = PayloadStream->PayloadSize - PayloadStream->BaseIndex - PayloadStream->AvailableSize;
+        }
+
+        bytesRead = 0;
+        ntStatus = moduleConfig->EvtComponentFirmwareUpdateFirmwarePayloadRead(DmfModule,
+                                                                               PayloadStream->FirmwareComponentIndex,
+                                                                               PayloadStream->BaseIndex + PayloadStream->AvailableSize,
+                                                                               PayloadStream->Buffer + PayloadStream->AvailableSize,
+                                                                               bytesToRead,
+                                                                               &bytesRead);
+        if (!NT_SUCCESS(ntStatus))
+        {
+            TraceEvents(TRACE_LEVEL_ERROR,
+                        DMF_TRACE,
+                        "EvtComponentFirmwareUpdateFirmwarePayloadRead fails for Component %d at offset 0x%Ix: ntStatus=%!STATUS!",
+                        PayloadStream->FirmwareComponentIndex,
+                        PayloadStream->BaseIndex + PayloadStream->AvailableSize,
+                        ntStatus);
+            goto Exit;
+        }
+
+        if (bytesRead == 0)
+        {
+            TraceEvents(TRACE_LEVEL_ERROR,
+                        DMF_TRACE,
+                        "Payload of Component %d ends at offset 0x%Ix. Expected size 0x%Ix",
+                        PayloadStream->FirmwareComponentIndex,
+                        PayloadStream->BaseIndex + PayloadStream->AvailableSize,
+                        PayloadStream->PayloadSize);
+            ntStatus = STATUS_END_OF_FILE;
+            goto Exit;
+        }
+
+        if (bytesRead > bytesToRead)
+        {
+            TraceEvents(TRACE_LEVEL_ERROR,
+                        DMF_TRACE,
+                        "Client read %Iu bytes. Requested %Iu bytes",
+                        bytesRead,
+                        bytesToRead);
+            ntStatus = STATUS_INVALID_BUFFER_SIZE;
+            goto Exit;
+        }
+
+        PayloadStream->AvailableSize += bytesRead;
+    }
+
+Exit:
+
+    return ntStatus;
+}
+#pragma code_seg()
+
 #pragma code_seg("PAGE")
 _IRQL_requires_max_(PASSIVE_LEVEL)
 _Must_inspect_result_
@@ -598,8 +849,7 @@ NTSTATUS
 ComponentFirmwareUpdate_PayloadBufferFill(
     _In_ DMFMODULE DmfModule,
     _In_ const UINT16 SequenceNumber,
-    _In_reads_(PayloadBufferSize) const BYTE* PayloadBuffer,
-    _In_ const size_t PayloadBufferSize,
+    _In_ const PAYLOAD_STREAM* PayloadStream,
     _Inout_ ULONG &PayloadBufferBinRecordStartIndex,
     _Inout_ BYTE &PayloadBufferBinRecordDataOffset,
     _Out_writes_(TransferBufferSize) UCHAR* TransferBuffer,
@@ -618,8 +868,8 @@ Arguments:
 
     DmfModule - This Module's DMF Object.
     SequenceNumber - Sequence number to be used in this payload.
-    PayloadBuffer - Payload data from the blob. This is the whole payload.
-    PayloadBufferSize - Size of the above buffer.
+    PayloadStream - Payload data from the blob. Contains at least MinimumPayloadReadAheadSize bytes
+                    starting at PayloadBufferBinRecordStartIndex or the rest of the payload.
     PayloadBufferBinRecordStartIndex - Index into PayloadBuffer that corresponds to a bin record's beginning.
     PayloadBufferBinRecordDataOffset - Data offset into the current bin record.
     TransferBuffer - Buffer where the data will be written. This is the current payload chunk.
@@ -658,6 +908,7 @@ Return Value:
     NTSTATUS ntStatus;
     DMF_CONTEXT_ComponentFirmwareUpdate* moduleContext;
     CONTEXT_ComponentFirmwareUpdateTransport* componentFirmwareUpdateTransportContext;
+    const size_t PayloadBufferSize = PayloadStream->PayloadSize;
 
     errno_t errorNumber;
     BYTE dataLength;
@@ -675,7 +926,7 @@ Return Value:
 
     FuncEntry(DMF_TRACE);
 
-    DmfAssert(PayloadBuffer != NULL);
+    DmfAssert(PayloadStream != NULL);
     DmfAssert(TransferBuffer != NULL);
 
     moduleContext = DMF_CONTEXT_GET(DmfModule);
@@ -724,7 +975,17 @@ Return Value:
     ZeroMemory(TransferBuffer, 
                TransferBufferSize);
 
-    currentBinRecord = (BIN_RECORD*) (PayloadBuffer + PayloadBufferBinRecordStartIndex);
+    currentBinRecord = (BIN_RECORD*)ComponentFirmwareUpdate_PayloadStreamBinRecordGet(PayloadStream,
+                                                                                       PayloadBufferBinRecordStartIndex);
+    if (currentBinRecord == NULL)
+    {
+        TraceEvents(TRACE_LEVEL_ERROR,
+                    DMF_TRACE,
+                    "Payload Buffer is corrupted. Bin record at %d is not available",
+                    PayloadBufferBinRecordStartIndex);
+        ntStatus = STATUS_INSUFFICIENT_RESOURCES;
+        goto Exit;
+    }
     payload = (PAYLOAD*) TransferBuffer;
 
     payload->Address = currentBinRecord->Address + PayloadBufferBinRecordDataOffset;
@@ -860,7 +1121,17 @@ Return Value:
                 goto Exit;
             }
 
-            currentBinRecord = (BIN_RECORD*)(PayloadBuffer + PayloadBufferBinRecordStartIndex);
+            currentBinRecord = (BIN_RECORD*)ComponentFirmwareUpdate_PayloadStreamBinRecordGet(PayloadStream,
+                                                                                               PayloadBufferBinRecordStartIndex);
+            if (currentBinRecord == NULL)
+            {
+                TraceEvents(TRACE_LEVEL_ERROR,
+                            DMF_TRACE,
+                            "Payload Buffer is corrupted. Bin record at %d is not available",
+                            PayloadBufferBinRecordStartIndex);
+                ntStatus = STATUS_INSUFFICIENT_RESOURCES;
+                goto Exit;
+            }
             PayloadBufferBinRecordDataOffset = 0;
             TraceEvents(TRACE_LEVEL_VERBOSE,
                         DMF_TRACE,
@@ -1133,9 +1404,11 @@ Return Value:
         }
 
         // Can not have null offer or payload buffers.
+        // Payload buffer is not needed if the payload is read from the Client in parts.
         //
         if (offerBufferFromClient == NULL ||
-            payloadBufferFromClient == NULL)
+            (payloadBufferFromClient == NULL &&
+             moduleConfig->EvtComponentFirmwareUpdateFirmwarePayloadRead == NULL))
         {
             TraceEvents(TRACE_LEVEL_ERROR,
                         DMF_TRACE,
@@ -1172,59 +1445,65 @@ Return Value:
         firmwareInformation->OfferContentMemory = WDF_NO_HANDLE;
         firmwareInformation->PayloadContentMemory = WDF_NO_HANDLE;
 
-        // Client's firmware buffers are not persisted. So will need to keep a copy internally.
-        // Allocate memory locally and copy the firmware buffer contents.
+        // When the Client provides EvtComponentFirmwareUpdateFirmwarePayloadRead, the payload is read
+        // from the Client in parts as it is sent. Don't keep it.
         //
-        if (moduleConfig->FirmwareBuffersNotInPresistantMemory)
+        if (NULL == moduleConfig->EvtComponentFirmwareUpdateFirmwarePayloadRead)
         {
-            WDFMEMORY payloadMemory;
-            BYTE* payloadBufferLocallyCreated;
-            WDF_OBJECT_ATTRIBUTES_INIT(&objectAttributes);
-            objectAttributes.ParentObject = firmwareMemory;
-            ntStatus = WdfMemoryCreate(&objectAttributes,
-                                       NonPagedPoolNx,
-                                       MemoryTag,
-                                       firmwareInformation->PayloadSize,
-                                       &payloadMemory,
-                                       (VOID**)&payloadBufferLocallyCreated);
-            if (! NT_SUCCESS(ntStatus))
+            // Client's firmware buffers are not persisted. So will need to keep a copy internally.
+            // Allocate memory locally and copy the firmware buffer contents.
+            //
+            if (moduleConfig->FirmwareBuffersNotInPresistantMemory)
             {
-                TraceEvents(TRACE_LEVEL_ERROR,
-                            DMF_TRACE,
-                            "WdfMemoryCreate for Firmware fails: ntStatus=%!STATUS!",  
-                            ntStatus);
-                goto Exit;
-            }
+                WDFMEMORY payloadMemory;
+                BYTE* payloadBufferLocallyCreated;
+                WDF_OBJECT_ATTRIBUTES_INIT(&objectAttributes);
+                objectAttributes.ParentObject = firmwareMemory;
+                ntStatus = WdfMemoryCreate(&objectAttributes,
+                                           NonPagedPoolNx,
+                                           MemoryTag,
+                                           firmwareInformation->PayloadSize,
+                                           &payloadMemory,
+                                           (VOID**)&payloadBufferLocallyCreated);
+                if (! NT_SUCCESS(ntStatus))
+                {
+                    TraceEvents(TRACE_LEVEL_ERROR,
+                                DMF_TRACE,
+                                "WdfMemoryCreate for Firmware fails: ntStatus=%!STATUS!",  
+                                ntStatus);
+                    goto Exit;
+                }
 
-            // 'Possibly incorrect single element annotation on buffer'
-            //
-            #pragma warning(suppress: 26007)
-            CopyMemory(payloadBufferLocallyCreated,
-                       payloadBufferFromClient,
-                       payloadBufferSize);
+                // 'Possibly incorrect single element annotation on buffer'
+                //
+                #pragma warning(suppress: 26007)
+                CopyMemory(payloadBufferLocallyCreated,
+                           payloadBufferFromClient,
+                           payloadBufferSize);
 
-            firmwareInformation->PayloadContentMemory = payloadMemory;
-        }
-        else
-        {
-            // Use the Buffer from client; Don't copy.
-            //
-            WDFMEMORY payloadMemory;
-            WDF_OBJECT_ATTRIBUTES_INIT(&objectAttributes);
-            objectAttributes.ParentObject = firmwareMemory;
-            ntStatus = WdfMemoryCreatePreallocated(&objectAttributes,
-                                                   payloadBufferFromClient,
-                                                   payloadBufferSize,
-                                                   &payloadMemory);
-            if (! NT_SUCCESS(ntStatus))
+                firmwareInformation->PayloadContentMemory = payloadMemory;
+            }
+            else
             {
-                TraceEvents(TRACE_LEVEL_ERROR,
-                            DMF_TRACE,
-                            "WdfMemoryCreatePreallocated for Firmware fails: ntStatus=%!STATUS!",
-                            ntStatus);
-                goto Exit;
+                // Use the Buffer from client; Don't copy.
+                //
+                WDFMEMORY payloadMemory;
+                WDF_OBJECT_ATTRIBUTES_INIT(&objectAttributes);
+                objectAttributes.ParentObject = firmwareMemory;
+                ntStatus = WdfMemoryCreatePreallocated(&objectAttributes,
+                                                       payloadBufferFromClient,
+                                                       payloadBufferSize,
+                                                       &payloadMemory);
+                if (! NT_SUCCESS(ntStatus))
+                {
+                    TraceEvents(TRACE_LEVEL_ERROR,
+                                DMF_TRACE,
+                                "WdfMemoryCreatePreallocated for Firmware fails: ntStatus=%!STATUS!",
+                                ntStatus);
+                    goto Exit;
+                }
+                firmwareInformation->PayloadContentMemory = payloadMemory;
             }
-            firmwareInformation->PayloadContentMemory = payloadMemory;
         }
 
         // Client's firmware buffers are not persisted. So will need to keep a copy internally.
@@ -2301,6 +2580,434 @@ Exit:
     return ntStatus;
 }
 
+_Must_inspect_result_
+static
+NTSTATUS
+ComponentFirmwareUpdate_PayloadWindowSend(
+    _In_ DMFMODULE DmfModule,
+    _Inout_ PAYLOAD_STREAM* PayloadStream,
+    _Inout_ UINT16* SequenceNumber,
+    _Inout_ ULONG* PayloadBufferBinRecordStartIndex,
+    _Inout_ BYTE* PayloadBufferBinRecordDataOffset,
+    _Out_ BOOL* UpdateInterruptedFromIoFailure,
+    _Out_ COMPONENT_FIRMWARE_UPDATE_PAYLOAD_RESPONSE* PayloadResponse
+    )
+/*++
+
+Routine Description:
+
+    Send the payload to the device keeping up to PayloadWindowSize payload chunks outstanding at a time.
+    Responses are matched to outstanding chunks using their sequence numbers. Only the chunks that the device
+    fails with COMPONENT_FIRMWARE_UPDATE_ERROR_WRITE are sent again, up to PayloadRetransmitLimit times.
+    The last chunk is only sent after all the other chunks are acknowledged because the device may start
+    validating the image as soon as it receives the last chunk.
+
+Arguments:
+
+    DmfModule - This Module's DMF Object.
+    PayloadStream - Payload data from the blob. Read from the Client as needed.
+    SequenceNumber - On input, the sequence number of the first chunk to send.
+                     On output, the sequence number of the oldest chunk that was not acknowledged.
+    PayloadBufferBinRecordStartIndex - On input, the bin record where the first chunk starts.
+                                       On output, the bin record where the oldest chunk that was not acknowledged starts.
+    PayloadBufferBinRecordDataOffset - On input, the data offset in the bin record where the first chunk starts.
+                                       On output, the data offset where the oldest chunk that was not acknowledged starts.
+    UpdateInterruptedFromIoFailure - Set to TRUE if the transfer stopped because the device did not respond in time.
+    PayloadResponse - Response received from the device. Anything other than COMPONENT_FIRMWARE_UPDATE_SUCCESS
+                      is the response for the chunk that failed the transfer.
+
+Return Value:
+
+    NTSTATUS
+
+--*/
+{
+    NTSTATUS ntStatus;
+    DMF_CONTEXT_ComponentFirmwareUpdate* moduleContext;
+    DMF_CONFIG_ComponentFirmwareUpdate* moduleConfig;
+    CONTEXT_ComponentFirmwareUpdateTransaction* componentFirmwareUpdateTransactionContext;
+    CONTEXT_ComponentFirmwareUpdateTransport* componentFirmwareUpdateTransportContext;
+
+    WDF_OBJECT_ATTRIBUTES objectAttributes;
+    WDFMEMORY windowSlotsMemory;
+    WDFMEMORY windowBuffersMemory;
+    PAYLOAD_WINDOW_SLOT* windowSlots;
+    UCHAR* windowBuffers;
+    PAYLOAD_WINDOW_SLOT* windowSlot;
+    size_t allocatedSize;
+    ULONG windowSize;
+    ULONG slotIndex;
+
+    // Oldest chunk that is not acknowledged and number of chunks sent but not yet acknowledged.
+    //
+    ULONG oldestSlotIndex;
+    ULONG slotsInFlight;
+    // TRUE when the next chunk to send is the last chunk and it is waiting for the chunks in flight.
+    //
+    BOOLEAN lastChunkHeld;
+
+    // Position of the next chunk to send.
+    //
+    UINT16 nextSequenceNumber;
+    ULONG nextPayloadBufferBinRecordStartIndex;
+    BYTE nextPayloadBufferBinRecordDataOffset;
+
+    VOID* clientBuffer;
+    VOID* clientBufferContext;
+    ULONG responsesProcessed;
+
+    PAGED_CODE();
+
+    FuncEntry(DMF_TRACE);
+
+    moduleContext = DMF_CONTEXT_GET(DmfModule);
+    moduleConfig = DMF_CONFIG_GET(DmfModule);
+
+    componentFirmwareUpdateTransactionContext = ComponentFirmwareUpdateTransactionContextGet(moduleContext->DmfInterfaceComponentFirmwareUpdate);
+    DmfAssert(componentFirmwareUpdateTransactionContext != NULL);
+
+    componentFirmwareUpdateTransportContext = ComponentFirmwareUpdateTransportContextGet(moduleContext->DmfInterfaceComponentFirmwareUpdate);
+    DmfAssert(componentFirmwareUpdateTransportContext != NULL);
+
+    *UpdateInterruptedFromIoFailure = FALSE;
+    *PayloadResponse = COMPONENT_FIRMWARE_UPDATE_SUCCESS;
+
+    windowSlotsMemory = WDF_NO_HANDLE;
+    windowBuffersMemory = WDF_NO_HANDLE;
+    oldestSlotIndex = 0;
+    slotsInFlight = 0;
+    lastChunkHeld = FALSE;
+    windowSlots = NULL;
+
+    nextSequenceNumber = *SequenceNumber;
+    nextPayloadBufferBinRecordStartIndex = *PayloadBufferBinRecordStartIndex;
+    nextPayloadBufferBinRecordDataOffset = *PayloadBufferBinRecordDataOffset;
+
+    windowSize = moduleConfig->PayloadWindowSize;
+    if (windowSize > MaximumPayloadWindowSize)
+    {
+        TraceEvents(TRACE_LEVEL_WARNING,
+                    DMF_TRACE,
+                    "PayloadWindowSize(%d) limited to %d",
+                    windowSize,
+                    MaximumPayloadWindowSize);
+        windowSize = MaximumPayloadWindowSize;
+    }
+
+    // Allocate the window slots and one transfer buffer per slot. A buffer is kept until its chunk
+    // is acknowledged so that it can be sent again as is.
+    //
+    allocatedSize = (size_t)componentFirmwareUpdateTransportContext->TransportFirmwarePayloadBufferRequiredSize +
+                    (size_t)componentFirmwareUpdateTransportContext->TransportHeaderSize;
+    WDF_OBJECT_ATTRIBUTES_INIT(&objectAttributes);
+    objectAttributes.ParentObject = DmfModule;
+    ntStatus = WdfMemoryCreate(&objectAttributes,
+                               NonPagedPoolNx,
+                               MemoryTag,
+                               windowSize * sizeof(PAYLOAD_WINDOW_SLOT),
+                               &windowSlotsMemory,
+                               (VOID**)&windowSlots);
+    if (!NT_SUCCESS(ntStatus))
+    {
+        TraceEvents(TRACE_LEVEL_ERROR,
+                    DMF_TRACE,
+                    "WdfMemoryCreate for window slots fails: ntStatus=%!STATUS!",
+                    ntStatus);
+        goto Exit;
+    }
+
+    ntStatus = WdfMemoryCreate(&objectAttributes,
+                               NonPagedPoolNx,
+                               MemoryTag,
+                               windowSize * allocatedSize,
+                               &windowBuffersMemory,
+                               (VOID**)&windowBuffers);
+    if (!NT_SUCCESS(ntStatus))
+    {
+        TraceEvents(TRACE_LEVEL_ERROR,
+                    DMF_TRACE,
+                    "WdfMemoryCreate for window buffers fails: ntStatus=%!STATUS!",
+                    ntStatus);
+        goto Exit;
+    }
+
+    RtlZeroMemory(windowSlots,
+                  windowSize * sizeof(PAYLOAD_WINDOW_SLOT));
+    RtlZeroMemory(windowBuffers,
+                  windowSize * allocatedSize);
+    for (slotIndex = 0; slotIndex < windowSize; slotIndex++)
+    {
+        windowSlots[slotIndex].BufferHeader = windowBuffers + (slotIndex * allocatedSize);
+    }
+
+    while (TRUE)
+    {
+        // Keep the window full while there is payload data still needed to send.
+        //
+        while ((slotsInFlight < windowSize) &&
+               (nextPayloadBufferBinRecordStartIndex < PayloadStream->PayloadSize) &&
+               ((! lastChunkHeld) || (0 == slotsInFlight)))
+        {
+            windowSlot = &windowSlots[(oldestSlotIndex + slotsInFlight) % windowSize];
+            windowSlot->SequenceNumber = nextSequenceNumber;
+            windowSlot->BinRecordStartIndex = nextPayloadBufferBinRecordStartIndex;
+            windowSlot->BinRecordDataOffset = nextPayloadBufferBinRecordDataOffset;
+            windowSlot->RetransmitCount = 0;
+            windowSlot->Acknowledged = FALSE;
+
+            TraceEvents(TRACE_LEVEL_INFORMATION,
+                        DMF_TRACE,
+                        "Current sequenceNumber: %d, PayloadIndex: %d, Payload Total size: %Iu, In flight: %d",
+                        nextSequenceNumber,
+                        nextPayloadBufferBinRecordStartIndex,
+                        PayloadStream->PayloadSize,
+                        slotsInFlight);
+
+            ntStatus = ComponentFirmwareUpdate_PayloadStreamReadAhead(DmfModule,
+                                                                      PayloadStream,
+                                                                      nextPayloadBufferBinRecordStartIndex);
+            if (!NT_SUCCESS(ntStatus))
+            {
+                TraceEvents(TRACE_LEVEL_ERROR,
+                            DMF_TRACE,
+                            "PayloadStreamReadAhead fails: ntStatus=%!STATUS!",
+                            ntStatus);
+                goto Exit;
+            }
+
+            ntStatus = ComponentFirmwareUpdate_PayloadBufferFill(DmfModule,
+                                                                 nextSequenceNumber,
+                                                                 PayloadStream,
+                                                                 nextPayloadBufferBinRecordStartIndex,
+                                                                 nextPayloadBufferBinRecordDataOffset,
+                                                                 windowSlot->BufferHeader + componentFirmwareUpdateTransportContext->TransportHeaderSize,
+                                                                 SizeOfPayload);
+            if (!NT_SUCCESS(ntStatus))
+            {
+                TraceEvents(TRACE_LEVEL_ERROR,
+                            DMF_TRACE,
+                            "PayloadBufferFill fails: ntStatus=%!STATUS!",
+                            ntStatus);
+                goto Exit;
+            }
+
+            // PayloadBufferFill flags the chunk with COMPONENT_FIRMWARE_UPDATE_FLAG_LAST_BLOCK when it
+            // consumes the rest of the payload. The device may start validating the image as soon as it
+            // receives that chunk, so no other chunk may be sent (or sent again) after it. Hold it until
+            // all the chunks in flight are acknowledged. It is filled again when it is sent.
+            //
+            if ((nextPayloadBufferBinRecordStartIndex == PayloadStream->PayloadSize) &&
+                (slotsInFlight > 0))
+            {
+                TraceEvents(TRACE_LEVEL_INFORMATION,
+                            DMF_TRACE,
+                            "Holding last sequenceNumber(%d) until %d chunks in flight are acknowledged",
+                            nextSequenceNumber,
+                            slotsInFlight);
+                nextPayloadBufferBinRecordStartIndex = windowSlot->BinRecordStartIndex;
+                nextPayloadBufferBinRecordDataOffset = windowSlot->BinRecordDataOffset;
+                lastChunkHeld = TRUE;
+                break;
+            }
+
+            ntStatus = DMF_ComponentFirmwareUpdate_TransportPayloadSend(moduleContext->DmfInterfaceComponentFirmwareUpdate,
+                                                                        windowSlot->BufferHeader,
+                                                                        allocatedSize,
+                                                                        componentFirmwareUpdateTransportContext->TransportHeaderSize);
+            if (!NT_SUCCESS(ntStatus))
+            {
+                TraceEvents(TRACE_LEVEL_ERROR,
+                            DMF_TRACE,
+                            "DMF_ComponentFirmwareUpdateTransport_PayloadSend fails: ntStatus=%!STATUS!",
+                            ntStatus);
+                goto Exit;
+            }
+
+            slotsInFlight++;
+            nextSequenceNumber++;
+        }
+
+        if (slotsInFlight == 0)
+        {
+            // All the chunks have been acknowledged.
+            //
+            break;
+        }
+
+        ntStatus = ComponentFirmwareUpdate_WaitForResponse(DmfModule,
+                                                           componentFirmwareUpdateTransportContext->TransportWaitTimeout);
+        if (!NT_SUCCESS(ntStatus))
+        {
+            // Treat timeout as IoFailure.
+            //
+            if (ntStatus == STATUS_INVALID_DEVICE_STATE)
+            {
+                *UpdateInterruptedFromIoFailure = TRUE;
+            }
+
+            TraceEvents(TRACE_LEVEL_ERROR,
+                        DMF_TRACE,
+                        "WaitForResponse fails: ntStatus=%!STATUS!",
+                        ntStatus);
+            goto Exit;
+        }
+
+        // Get all the completed responses and match them to the chunks in flight.
+        //
+        responsesProcessed = 0;
+        while (TRUE)
+        {
+            clientBuffer = NULL;
+            clientBufferContext = NULL;
+            ntStatus = DMF_BufferQueue_Dequeue(componentFirmwareUpdateTransactionContext->DmfModuleBufferQueue,
+                                               &clientBuffer,
+                                               &clientBufferContext);
+            if (!NT_SUCCESS(ntStatus))
+            {
+                // No more responses.
+                //
+                ntStatus = STATUS_SUCCESS;
+                break;
+            }
+
+            DmfAssert(clientBuffer != NULL);
+            PAYLOAD_RESPONSE payloadResponse = *((PAYLOAD_RESPONSE*)clientBuffer);
+
+            // We are done with the buffer from consumer; put it back to producer.
+            //
+            DMF_BufferQueue_Reuse(componentFirmwareUpdateTransactionContext->DmfModuleBufferQueue,
+                                  clientBuffer);
+            clientBuffer = NULL;
+            responsesProcessed++;
+
+            // Distance from the oldest chunk in flight. Sequence numbers wrap around.
+            //
+            UINT16 windowOffset = (UINT16)(payloadResponse.SequenceNumber - windowSlots[oldestSlotIndex].SequenceNumber);
+            if (windowOffset >= slotsInFlight)
+            {
+                if (windowOffset > (UINT16_MAX / 2))
+                {
+                    // This can happen if the device resends a message for a chunk that is already acknowledged.
+                    //
+                    TraceEvents(TRACE_LEVEL_ERROR,
+                                DMF_TRACE,
+                                "Ignoring responseSequenceNumber(%d) older than oldest sequenceNumber(%d)",
+                                payloadResponse.SequenceNumber,
+                                windowSlots[oldestSlotIndex].SequenceNumber);
+                    continue;
+                }
+
+                TraceEvents(TRACE_LEVEL_ERROR,
+                            DMF_TRACE,
+                            "responseSequenceNumber(%d) was never sent. Oldest sequenceNumber(%d) In flight(%d)",
+                            payloadResponse.SequenceNumber,
+                            windowSlots[oldestSlotIndex].SequenceNumber,
+                            slotsInFlight);
+                ntStatus = STATUS_DEVICE_PROTOCOL_ERROR;
+                goto Exit;
+            }
+
+            windowSlot = &windowSlots[(oldestSlotIndex + windowOffset) % windowSize];
+            if (payloadResponse.ResponseStatus == COMPONENT_FIRMWARE_UPDATE_SUCCESS)
+            {
+                windowSlot->Acknowledged = TRUE;
+                continue;
+            }
+
+            if ((payloadResponse.ResponseStatus == COMPONENT_FIRMWARE_UPDATE_ERROR_WRITE) &&
+                (windowSlot->RetransmitCount < moduleConfig->PayloadRetransmitLimit))
+            {
+                windowSlot->RetransmitCount++;
+                TraceEvents(TRACE_LEVEL_WARNING,
+                            DMF_TRACE,
+                            "Retransmitting sequenceNumber(%d) attempt(%d)",
+                            windowSlot->SequenceNumber,
+                            windowSlot->RetransmitCount);
+
+                ntStatus = DMF_ComponentFirmwareUpdate_TransportPayloadSend(moduleContext->DmfInterfaceComponentFirmwareUpdate,
+                                                                            windowSlot->BufferHeader,
+                                                                            allocatedSize,
+                                                                            componentFirmwareUpdateTransportContext->TransportHeaderSize);
+                if (!NT_SUCCESS(ntStatus))
+                {
+                    TraceEvents(TRACE_LEVEL_ERROR,
+                                DMF_TRACE,
+                                "DMF_ComponentFirmwareUpdateTransport_PayloadSend fails: ntStatus=%!STATUS!",
+                                ntStatus);
+                    goto Exit;
+                }
+                continue;
+            }
+
+            TraceEvents(TRACE_LEVEL_ERROR,
+                        DMF_TRACE,
+                        "sequenceNumber(%d) returns: %d",
+                        windowSlot->SequenceNumber,
+                        payloadResponse.ResponseStatus);
+            *PayloadResponse = payloadResponse.ResponseStatus;
+            // Do not flag this with ntStatus.
+            //
+            goto Exit;
+        }
+
+        // Transport reported a failure instead of a response.
+        //
+        if ((responsesProcessed == 0) &&
+            (!NT_SUCCESS(componentFirmwareUpdateTransactionContext->ntStatus)))
+        {
+            ntStatus = componentFirmwareUpdateTransactionContext->ntStatus;
+            TraceEvents(TRACE_LEVEL_ERROR,
+                        DMF_TRACE,
+                        "PayloadSend fails: ntStatus=%!STATUS!",
+                        ntStatus);
+            goto Exit;
+        }
+
+        // Retire the acknowledged chunks in order so that the oldest chunk in flight is always
+        // the point where an interrupted update resumes.
+        //
+        while ((slotsInFlight > 0) &&
+               windowSlots[oldestSlotIndex].Acknowledged)
+        {
+            oldestSlotIndex = (oldestSlotIndex + 1) % windowSize;
+            slotsInFlight--;
+        }
+    }
+
+Exit:
+
+    // Return the position of the oldest chunk that is not acknowledged.
+    //
+    if (slotsInFlight > 0)
+    {
+        *SequenceNumber = windowSlots[oldestSlotIndex].SequenceNumber;
+        *PayloadBufferBinRecordStartIndex = windowSlots[oldestSlotIndex].BinRecordStartIndex;
+        *PayloadBufferBinRecordDataOffset = windowSlots[oldestSlotIndex].BinRecordDataOffset;
+    }
+    else
+    {
+        *SequenceNumber = nextSequenceNumber;
+        *PayloadBufferBinRecordStartIndex = nextPayloadBufferBinRecordStartIndex;
+        *PayloadBufferBinRecordDataOffset = nextPayloadBufferBinRecordDataOffset;
+    }
+
+    if (windowBuffersMemory != WDF_NO_HANDLE)
+    {
+        WdfObjectDelete(windowBuffersMemory);
+        windowBuffersMemory = WDF_NO_HANDLE;
+    }
+
+    if (windowSlotsMemory != WDF_NO_HANDLE)
+    {
+        WdfObjectDelete(windowSlotsMemory);
+        windowSlotsMemory = WDF_NO_HANDLE;
+    }
+
+    FuncExit(DMF_TRACE, "ntStatus=%!STATUS!", ntStatus);
+
+    return ntStatus;
+}
+
 _Must_inspect_result_
 static
 NTSTATUS
@@ -2340,6 +3047,11 @@ Return Value:
     ULONG* payloadContent;
     size_t payloadSizeFromCollection;
 
+    // Part of the payload that is available to send.
+    //
+    PAYLOAD_STREAM payloadStream;
+    WDFMEMORY payloadReadAheadMemory;
+
     WDF_OBJECT_ATTRIBUTES objectAttributes;
     WDFMEMORY payloadChunkMemory;
 
@@ -2395,10 +3107,6 @@ Return Value:
     firmwareInformation = (FIRMWARE_INFORMATION*)WdfMemoryGetBuffer(firmwareInformationMemory, 
                                                                     NULL);
 
-    payloadContent = (ULONG*)WdfMemoryGetBuffer(firmwareInformation->PayloadContentMemory,
-                                                &payloadSizeFromCollection);
-
-    DmfAssert(payloadSizeFromCollection == firmwareInformation->PayloadSize);
     componentFirmwareUpdateTransactionContext = ComponentFirmwareUpdateTransactionContextGet(moduleContext->DmfInterfaceComponentFirmwareUpdate);
     DmfAssert(componentFirmwareUpdateTransactionContext != NULL);
 
@@ -2407,6 +3115,7 @@ Return Value:
     DmfAssert(componentFirmwareUpdateTransportContext != NULL);
 
     payloadChunkMemory = WDF_NO_HANDLE;
+    payloadReadAheadMemory = WDF_NO_HANDLE;
 
     // Allocate memory for payload chunk, and reuse it for the sending the whole payload.
     //
@@ -2437,6 +3146,62 @@ Return Value:
     payloadBuffer = (UCHAR*)(bufferHeader + componentFirmwareUpdateTransportContext->TransportHeaderSize);
     payloadBufferLength = SizeOfPayload;
 
+    ZeroMemory(&payloadStream,
+               sizeof(payloadStream));
+    payloadStream.FirmwareComponentIndex = PayloadIndex;
+    payloadStream.PayloadSize = firmwareInformation->PayloadSize;
+
+    if (moduleConfig->EvtComponentFirmwareUpdateFirmwarePayloadRead != NULL)
+    {
+        // Payload is read from the Client as it is sent. Only the read ahead buffer is allocated
+        // so memory use does not depend on the size of the payload.
+        //
+        size_t payloadReadAheadSize = moduleConfig->PayloadReadAheadSize;
+        if (payloadReadAheadSize == 0)
+        {
+            payloadReadAheadSize = DefaultPayloadReadAheadSize;
+        }
+        if (payloadReadAheadSize < MinimumPayloadReadAheadSize)
+        {
+            payloadReadAheadSize = MinimumPayloadReadAheadSize;
+        }
+
+        WDF_OBJECT_ATTRIBUTES_INIT(&objectAttributes);
+        objectAttributes.ParentObject = DmfModule;
+        ntStatus = WdfMemoryCreate(&objectAttributes,
+                                   NonPagedPoolNx,
+                                   MemoryTag,
+                                   payloadReadAheadSize,
+                                   &payloadReadAheadMemory,
+                                   (VOID**)&payloadStream.Buffer);
+        if (!NT_SUCCESS(ntStatus))
+        {
+            TraceEvents(TRACE_LEVEL_ERROR,
+                        DMF_TRACE,
+                        "WdfMemoryCreate for payload read ahead fails: ntStatus=%!STATUS!",
+                        ntStatus);
+            goto Exit;
+        }
+
+        payloadStream.BufferSize = payloadReadAheadSize;
+        payloadStream.BaseIndex = 0;
+        payloadStream.AvailableSize = 0;
+    }
+    else
+    {
+        // The whole payload is available.
+        //
+        payloadContent = (ULONG*)WdfMemoryGetBuffer(firmwareInformation->PayloadContentMemory,
+                                                    &payloadSizeFromCollection);
+
+        DmfAssert(payloadSizeFromCollection == firmwareInformation->PayloadSize);
+
+        payloadStream.Buffer = (BYTE*)payloadContent;
+        payloadStream.BufferSize = payloadSizeFromCollection;
+        payloadStream.BaseIndex = 0;
+        payloadStream.AvailableSize = payloadSizeFromCollection;
+    }
+
     // Check whether the update should resume from a previously interrupted update.
     // This can only occur if the same pair 'that was interrupted last attempt matches the first pair to be accepted this attempt'.
     //
@@ -2578,6 +3343,24 @@ Return Value:
         goto Exit;
     }
 
+    if (moduleConfig->PayloadWindowSize > 1)
+    {
+        // Keep several chunks in flight instead of waiting for the response to each chunk.
+        // On return, the position is the oldest chunk that was not acknowledged.
+        //
+        ntStatus = ComponentFirmwareUpdate_PayloadWindowSend(DmfModule,
+                                                             &payloadStream,
+                                                             &sequenceNumber,
+                                                             &payloadBufferBinRecordStartIndex,
+                                                             &payloadBufferBinRecordDataOffset,
+                                                             &updateInterruptedFromIoFailure,
+                                                             PayloadResponse);
+        resumeSequenceNumber = sequenceNumber;
+        resumePayloadBufferBinRecordStartIndex = payloadBufferBinRecordStartIndex;
+        resumePayloadBufferBinRecordDataOffset = payloadBufferBinRecordDataOffset;
+        goto Exit;
+    }
+
     // Proceed while there is some payload data still needed to send..
     //
     while (payloadBufferBinRecordStartIndex < firmwareInformation->PayloadSize)
@@ -2595,14 +3378,27 @@ Return Value:
         resumePayloadBufferBinRecordStartIndex = payloadBufferBinRecordStartIndex;
         resumePayloadBufferBinRecordDataOffset = payloadBufferBinRecordDataOffset;
 
+        // Make sure the part of the payload needed for the next chunk is available.
+        //
+        ntStatus = ComponentFirmwareUpdate_PayloadStreamReadAhead(DmfModule,
+                                                                  &payloadStream,
+                                                                  payloadBufferBinRecordStartIndex);
+        if (!NT_SUCCESS(ntStatus))
+        {
+            TraceEvents(TRACE_LEVEL_ERROR,
+                        DMF_TRACE,
+                        "PayloadStreamReadAhead fails: ntStatus=%!STATUS!",
+                        ntStatus);
+            goto Exit;
+        }
+
         // Fill the output buffer with the next chunk of payload to send.
-        //      Content is Copied From payloadContent to payloadBuffer.
+        //      Content is Copied From payloadStream to payloadBuffer.
         //      payloadBufferIndex is updated inside as the payloadBuffer is filled up.
         //
         ntStatus = ComponentFirmwareUpdate_PayloadBufferFill(DmfModule,
                                                              sequenceNumber,
-                                                             (BYTE*)payloadContent,
-                                                             firmwareInformation->PayloadSize,
+                                                             &payloadStream,
                                                              payloadBufferBinRecordStartIndex,
                                                              payloadBufferBinRecordDataOffset,
                                                              payloadBuffer, 
@@ -2673,6 +3469,12 @@ Exit:
         payloadBuffer = NULL;
     }
 
+    if (payloadReadAheadMemory != WDF_NO_HANDLE)
+    {
+        WdfObjectDelete(payloadReadAheadMemory);
+        payloadReadAheadMemory = WDF_NO_HANDLE;
+    }
+
     // If the update was interrupted and the device supports resume on connect, store the current progress in the registry
     // Make sure to mark ResumeOnConnect last and not set it to true if any of the others fail.
     //
@@ -5003,7 +5805,14 @@ Return Value:
     DMF_CONFIG_BufferQueue_AND_ATTRIBUTES_INIT(&bufferQueueModuleConfig,
                                                &moduleAttributes);
     bufferQueueModuleConfig.SourceSettings.EnableLookAside = TRUE;
+    // Allow a response for each payload chunk that can be in flight.
+    //
     bufferQueueModuleConfig.SourceSettings.BufferCount = 5;
+    if (moduleConfig->PayloadWindowSize > bufferQueueModuleConfig.SourceSettings.BufferCount)
+    {
+        bufferQueueModuleConfig.SourceSettings.BufferCount = min(moduleConfig->PayloadWindowSize,
+                                                                 MaximumPayloadWindowSize);
+    }
     bufferQueueModuleConfig.SourceSettings.BufferSize = sizeof(PAYLOAD_RESPONSE);
     bufferQueueModuleConfig.SourceSettings.BufferContextSize = sizeof(ULONG);
     bufferQueueModuleConfig.SourceSettings.PoolType = NonPagedPoolNx;
@@ -30,6 +30,21 @@ EVT_DMF_ComponentFirmwareUpdate_FirmwareGet(_In_ DMFMODULE DmfModule,
                                             _Out_ BYTE** FirmwareBuffer,
                                             _Out_ size_t* BufferLength);
 
+// Client Driver callback function to provide part of the firmware payload blob when being called.
+// Offset is the offset in bytes from the start of the payload. The callback writes up to BufferSize bytes
+// of the payload starting at Offset to Buffer and returns the number of bytes written in BytesRead.
+//
+typedef
+_Function_class_(EVT_DMF_ComponentFirmwareUpdate_FirmwarePayloadRead)
+_Must_inspect_result_
+NTSTATUS
+EVT_DMF_ComponentFirmwareUpdate_FirmwarePayloadRead(_In_ DMFMODULE DmfModule,
+                                                    _In_ DWORD FirmwareComponentIndex,
+                                                    _In_ size_t Offset,
+                                                    _Out_writes_bytes_to_(BufferSize, *BytesRead) BYTE* Buffer,
+                                                    _In_ size_t BufferSize,
+                                                    _Out_ size_t* BytesRead);
+
 // Maximum length of characters of the instance identifier if client provides one.
 //
 #define MAX_INSTANCE_IDENTIFIER_LENGTH 256
@@ -55,6 +70,17 @@ typedef struct
     // Firmware Buffer Attribute to control whether this Module maintains local copy of the firmware buffers internally or not.
     //
     BOOLEAN FirmwareBuffersNotInPresistantMemory;
+
+    // Optional ComponentFirmwareUpdate callback function to be implemented by client to provide the firmware payload bits
+    // in parts as they are sent to the device. When set, EvtComponentFirmwareUpdateFirmwarePayloadGet only needs to
+    // provide the size of the payload and the whole payload is never held in memory.
+    //
+    EVT_DMF_ComponentFirmwareUpdate_FirmwarePayloadRead* EvtComponentFirmwareUpdateFirmwarePayloadRead;
+
+    // Size in bytes of the buffer used to read the payload using EvtComponentFirmwareUpdateFirmwarePayloadRead.
+    // 0 uses a default size. Sizes smaller than the size needed to prepare one payload chunk are increased to that size.
+    //
+    ULONG PayloadReadAheadSize;
     //-----END: Firmware binary related ---------
     //
 
@@ -76,6 +102,16 @@ typedef struct
     //
     BOOLEAN ForceIgnoreVersion;
 
+    // Maximum number of payload chunks that may be sent to the device before their responses are received.
+    // 0 or 1 sends one chunk at a time and waits for its response before sending the next one.
+    //
+    ULONG PayloadWindowSize;
+
+    // Number of times a payload chunk that the device fails with COMPONENT_FIRMWARE_UPDATE_ERROR_WRITE
+    // is sent again before the payload transfer fails. Only used when PayloadWindowSize is greater than 1.
+    //
+    ULONG PayloadRetransmitLimit;
+
     //----- END:  CFU protocol related -------
     //
 
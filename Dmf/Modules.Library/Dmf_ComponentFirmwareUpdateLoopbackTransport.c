@@ -0,0 +1,1315 @@
+/*++
+
+   Copyright (c) Microsoft Corporation. All Rights Reserved.
+   Licensed under the MIT license.
+
+Module Name:
+
+    Dmf_ComponentFirmwareUpdateLoopbackTransport.c
+
+Abstract:
+
+    This Module implements a Loopback Transport for Component Firmware Update. It simulates a device that
+    accepts all offers and payload chunks so that the protocol can be exercised and measured without hardware.
+
+Environment:
+
+    User-mode Driver Framework
+
+--*/
+
+// DMF and this Module's Library specific definitions.
+//
+#include "DmfModule.h"
+#include "DmfModules.Library.h"
+#include "DmfModules.Library.Trace.h"
+
+#if defined(DMF_INCLUDE_TMH)
+#include "Dmf_ComponentFirmwareUpdateLoopbackTransport.tmh"
+#endif
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+// Module Private Enumerations and Structures
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+
+// Kind of response the simulated device sends.
+//
+typedef enum _LoopbackTransport_ResponseType
+{
+    LoopbackTransport_ResponseType_Invalid = 0,
+    LoopbackTransport_ResponseType_FirmwareVersion,
+    LoopbackTransport_ResponseType_Offer,
+    LoopbackTransport_ResponseType_Payload,
+    LoopbackTransport_ResponseType_Maximum
+} LoopbackTransport_ResponseType;
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+// Module Private Context
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+
+// Buffer Size from specification.
+//
+// Each time 60 bytes of Payload sent.
+//
+#define SizeOfPayload (60)
+// Offer is 16 bytes long.
+//
+#define SizeOfOffer (16)
+// Firmware Version is 60 bytes long.
+//
+#define SizeOfFirmwareVersion (60)
+// Offer and Payload responses are 16 bytes long.
+//
+#define SizeOfResponse (16)
+
+// Loopback does not need a header. A header is still requested so the layout matches other transports.
+//
+#define LoopbackHeaderSize                0x1
+
+// Timeout reported to the protocol.
+//
+#define LOOPBACK_WAIT_TIMEOUT_MS          (5000)
+
+// Protocol revision reported in the firmware version response.
+//
+#define LOOPBACK_PROTOCOL_REVISION        (0x2)
+
+// Number of response buffers initially allocated.
+//
+#define LOOPBACK_RESPONSE_BUFFER_COUNT    (16)
+
+// A response that is waiting to be delivered.
+//
+typedef struct _LOOPBACK_RESPONSE
+{
+    LoopbackTransport_ResponseType ResponseType;
+    // Time the message was sent.
+    //
+    LONGLONG SendTime;
+    ULONG ResponseSize;
+    UCHAR Response[SizeOfFirmwareVersion];
+} LOOPBACK_RESPONSE;
+
+// This Module's context.
+//
+typedef struct _DMF_CONTEXT_ComponentFirmwareUpdateLoopbackTransport
+{
+    // Interface Handle.
+    //
+    DMFINTERFACE DmfInterfaceComponentFirmwareUpdate;
+    // Delivers responses after the configured latency.
+    //
+    DMFMODULE DmfModuleThreadedBufferQueue;
+    // Measures the time responses have been waiting.
+    //
+    DMFMODULE DmfModuleTime;
+    // Sequence number of the last payload chunk that was failed on purpose.
+    //
+    UINT16 LastFailedSequenceNumber;
+    // Statistics.
+    //
+    ULONG PayloadChunksReceived;
+    ULONG PayloadChunksFailed;
+} DMF_CONTEXT_ComponentFirmwareUpdateLoopbackTransport;
+
+// This macro declares the following function:
+// DMF_CONTEXT_GET()
+//
+DMF_MODULE_DECLARE_CONTEXT(ComponentFirmwareUpdateLoopbackTransport)
+
+// This macro declares the following function:
+// DMF_CONFIG_GET()
+//
+DMF_MODULE_DECLARE_CONFIG(ComponentFirmwareUpdateLoopbackTransport)
+
+#define MemoryTag 'TbpL'
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+// DMF Module Support Code
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+
+//-- Helper functions ---
+//--------START----------
+//
+_IRQL_requires_max_(PASSIVE_LEVEL)
+static
+VOID
+ComponentFirmwareUpdateLoopbackTransport_ResponseDeliver(
+    _In_ DMFMODULE DmfModule,
+    _In_ LOOPBACK_RESPONSE* LoopbackResponse
+    )
+/*++
+
+Routine Description:
+
+    Give the given response to the Protocol Module.
+
+Parameters:
+
+    DmfModule - This Module's DMF Object.
+    LoopbackResponse - The response to deliver.
+
+Return:
+
+    None
+
+--*/
+{
+    DMF_CONTEXT_ComponentFirmwareUpdateLoopbackTransport* moduleContext;
+
+    moduleContext = DMF_CONTEXT_GET(DmfModule);
+
+    switch (LoopbackResponse->ResponseType)
+    {
+        case LoopbackTransport_ResponseType_FirmwareVersion:
+        {
+            EVT_ComponentFirmwareUpdate_FirmwareVersionResponse(moduleContext->DmfInterfaceComponentFirmwareUpdate,
+                                                                LoopbackResponse->Response,
+                                                                LoopbackResponse->ResponseSize,
+                                                                STATUS_SUCCESS);
+            break;
+        }
+        case LoopbackTransport_ResponseType_Offer:
+        {
+            EVT_ComponentFirmwareUpdate_OfferResponse(moduleContext->DmfInterfaceComponentFirmwareUpdate,
+                                                      LoopbackResponse->Response,
+                                                      LoopbackResponse->ResponseSize,
+                                                      STATUS_SUCCESS);
+            break;
+        }
+        case LoopbackTransport_ResponseType_Payload:
+        {
+            EVT_ComponentFirmwareUpdate_PayloadResponse(moduleContext->DmfInterfaceComponentFirmwareUpdate,
+                                                        LoopbackResponse->Response,
+                                                        LoopbackResponse->ResponseSize,
+                                                        STATUS_SUCCESS);
+            break;
+        }
+        default:
+        {
+            DmfAssert(FALSE);
+            break;
+        }
+    }
+}
+
+#pragma code_seg("PAGE")
+_IRQL_requires_max_(PASSIVE_LEVEL)
+_Must_inspect_result_
+static
+NTSTATUS
+ComponentFirmwareUpdateLoopbackTransport_ResponseSend(
+    _In_ DMFMODULE DmfModule,
+    _In_ LoopbackTransport_ResponseType ResponseType,
+    _In_reads_bytes_(ResponseSize) UCHAR* Response,
+    _In_ ULONG ResponseSize
+    )
+/*++
+
+Routine Description:
+
+    Send a response from the simulated device. The response is delivered immediately if there
+    is no latency configured. Otherwise, it is delivered once the configured latency has elapsed.
+
+Parameters:
+
+    DmfModule - This Module's DMF Object.
+    ResponseType - Indicates which callback receives the response.
+    Response - The response.
+    ResponseSize - Size of Response in bytes.
+
+Return:
+
+    NTSTATUS
+
+--*/
+{
+    NTSTATUS ntStatus;
+    DMF_CONTEXT_ComponentFirmwareUpdateLoopbackTransport* moduleContext;
+    LOOPBACK_RESPONSE* loopbackResponse;
+    LOOPBACK_RESPONSE immediateResponse;
+
+    PAGED_CODE();
+
+    moduleContext = DMF_CONTEXT_GET(DmfModule);
+
+    DmfAssert(ResponseSize <= sizeof(loopbackResponse->Response));
+
+    if (moduleContext->DmfModuleThreadedBufferQueue == NULL)
+    {
+        immediateResponse.ResponseType = ResponseType;
+        immediateResponse.SendTime = 0;
+        immediateResponse.ResponseSize = ResponseSize;
+        RtlCopyMemory(immediateResponse.Response,
+                      Response,
+                      ResponseSize);
+        ComponentFirmwareUpdateLoopbackTransport_ResponseDeliver(DmfModule,
+                                                                 &immediateResponse);
+        ntStatus = STATUS_SUCCESS;
+        goto Exit;
+    }
+
+    ntStatus = DMF_ThreadedBufferQueue_Fetch(moduleContext->DmfModuleThreadedBufferQueue,
+                                             (VOID**)&loopbackResponse,
+                                             NULL);
+    if (!NT_SUCCESS(ntStatus))
+    {
+        TraceEvents(TRACE_LEVEL_ERROR,
+                    DMF_TRACE,
+                    "DMF_ThreadedBufferQueue_Fetch fails: ntStatus=%!STATUS!",
+                    ntStatus);
+        goto Exit;
+    }
+
+    loopbackResponse->ResponseType = ResponseType;
+    loopbackResponse->SendTime = DMF_Time_TickCountGet(moduleContext->DmfModuleTime);
+    loopbackResponse->ResponseSize = ResponseSize;
+    RtlCopyMemory(loopbackResponse->Response,
+                  Response,
+                  ResponseSize);
+    DMF_ThreadedBufferQueue_Enqueue(moduleContext->DmfModuleThreadedBufferQueue,
+                                    loopbackResponse);
+
+Exit:
+
+    return ntStatus;
+}
+#pragma code_seg()
+
+#pragma code_seg("PAGE")
+_IRQL_requires_max_(PASSIVE_LEVEL)
+_Must_inspect_result_
+static
+NTSTATUS
+ComponentFirmwareUpdateLoopbackTransport_OfferResponseSend(
+    _In_ DMFMODULE DmfModule,
+    _In_reads_bytes_(BufferSize) UCHAR* Buffer,
+    _In_ size_t BufferSize,
+    _In_ size_t HeaderSize,
+    _In_ COMPONENT_FIRMWARE_UPDATE_OFFER_RESPONSE OfferResponseStatus
+    )
+/*++
+
+Routine Description:
+
+    Respond to an offer, offer information or offer command with the given status.
+
+Parameters:
+
+    DmfModule - This Module's DMF Object.
+    Buffer - Header, followed by the offer that was sent.
+    BufferSize - Size of the above in bytes.
+    HeaderSize - Size of the header. Header is at the beginning of 'Buffer'.
+    OfferResponseStatus - Status the simulated device responds with.
+
+Return:
+
+    NTSTATUS
+
+--*/
+{
+    NTSTATUS ntStatus;
+    ULONG offer;
+    ULONG offerResponse[SizeOfResponse / sizeof(ULONG)];
+
+    PAGED_CODE();
+
+    if (BufferSize < HeaderSize + sizeof(offer))
+    {
+        TraceEvents(TRACE_LEVEL_ERROR,
+                    DMF_TRACE,
+                    "Invalid offer size %Iu",
+                    BufferSize);
+        ntStatus = STATUS_BUFFER_TOO_SMALL;
+        goto Exit;
+    }
+
+    RtlCopyMemory(&offer,
+                  Buffer + HeaderSize,
+                  sizeof(offer));
+
+    // Echo the token (Byte 3) and return the status with no reject reason.
+    //
+    RtlZeroMemory(offerResponse,
+                  sizeof(offerResponse));
+    offerResponse[0] = offer & 0xFF000000;
+    offerResponse[3] = (ULONG)OfferResponseStatus;
+
+    ntStatus = ComponentFirmwareUpdateLoopbackTransport_ResponseSend(DmfModule,
+                                                                     LoopbackTransport_ResponseType_Offer,
+                                                                     (UCHAR*)offerResponse,
+                                                                     sizeof(offerResponse));
+
+Exit:
+
+    return ntStatus;
+}
+#pragma code_seg()
+//-- Helper functions ---
+//--------END------------
+//
+
+#pragma code_seg("PAGE")
+_Function_class_(EVT_DMF_ThreadedBufferQueue_Callback)
+_IRQL_requires_max_(PASSIVE_LEVEL)
+_IRQL_requires_same_
+_Must_inspect_result_
+ThreadedBufferQueue_BufferDisposition
+ComponentFirmwareUpdateLoopbackTransport_ResponseWork(
+    _In_ DMFMODULE DmfModuleThreadedBufferQueue,
+    _In_ UCHAR* ClientWorkBuffer,
+    _In_ ULONG ClientWorkBufferSize,
+    _In_ VOID* ClientWorkBufferContext,
+    _Out_ NTSTATUS* NtStatus
+    )
+/*++
+
+Routine Description:
+
+    Waits until the configured latency has elapsed since the message was sent and then delivers the response.
+    Responses are delivered in the order the messages were sent.
+
+Parameters:
+
+    DmfModuleThreadedBufferQueue - DmfModuleThreadedBufferQueue Module's handle.
+    ClientWorkBuffer - The response to deliver.
+    ClientWorkBufferSize - Size of ClientWorkBuffer in bytes.
+    ClientWorkBufferContext - Not used.
+    NtStatus - Status of the work.
+
+Return:
+
+    ThreadedBufferQueue_BufferDisposition
+
+--*/
+{
+    NTSTATUS ntStatus;
+    DMFMODULE dmfModule;
+    DMF_CONTEXT_ComponentFirmwareUpdateLoopbackTransport* moduleContext;
+    DMF_CONFIG_ComponentFirmwareUpdateLoopbackTransport* moduleConfig;
+    LOOPBACK_RESPONSE* loopbackResponse;
+    LONGLONG elapsedTimeMs;
+
+    UNREFERENCED_PARAMETER(ClientWorkBufferSize);
+    UNREFERENCED_PARAMETER(ClientWorkBufferContext);
+
+    PAGED_CODE();
+
+    dmfModule = DMF_ParentModuleGet(DmfModuleThreadedBufferQueue);
+    moduleContext = DMF_CONTEXT_GET(dmfModule);
+    moduleConfig = DMF_CONFIG_GET(dmfModule);
+
+    loopbackResponse = (LOOPBACK_RESPONSE*)ClientWorkBuffer;
+
+    ntStatus = DMF_Time_ElapsedTimeMillisecondsGet(moduleContext->DmfModuleTime,
+                                                   loopbackResponse->SendTime,
+                                                   &elapsedTimeMs);
+    if (NT_SUCCESS(ntStatus) &&
+        (elapsedTimeMs < (LONGLONG)moduleConfig->ResponseLatencyMs))
+    {
+        DMF_Utility_DelayMilliseconds((ULONG)(moduleConfig->ResponseLatencyMs - elapsedTimeMs));
+    }
+
+    ComponentFirmwareUpdateLoopbackTransport_ResponseDeliver(dmfModule,
+                                                             loopbackResponse);
+
+    *NtStatus = STATUS_SUCCESS;
+
+    return ThreadedBufferQueue_BufferDisposition_WorkComplete;
+}
+#pragma code_seg()
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+// WDF Module Callbacks
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+// DMF Module Callbacks
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+
+// Transport Generic Callbacks.
+// (Implementation of publicly accessible callbacks required by the Interface.)
+//
+
+#pragma code_seg("PAGE")
+_IRQL_requires_max_(PASSIVE_LEVEL)
+_IRQL_requires_same_
+VOID
+DMF_ComponentFirmwareUpdateLoopbackTransport_PostBind(
+    _In_ DMFINTERFACE DmfInterface
+    )
+/*++
+
+Routine Description:
+
+    This callback tells the given Transport Module that it is bound to the given
+    Protocol Module.
+
+Arguments:
+
+    DmfInterface - Interface handle.
+
+Return Value:
+
+    None
+
+--*/
+{
+    PAGED_CODE();
+
+    UNREFERENCED_PARAMETER(DmfInterface);
+
+    FuncEntry(DMF_TRACE);
+
+    // Currently NOP.
+    //
+
+    FuncExitVoid(DMF_TRACE);
+}
+#pragma code_seg()
+
+#pragma code_seg("PAGE")
+_IRQL_requires_max_(PASSIVE_LEVEL)
+_IRQL_requires_same_
+VOID
+DMF_ComponentFirmwareUpdateLoopbackTransport_PreUnbind(
+    _In_ DMFINTERFACE DmfInterface
+    )
+/*++
+
+Routine Description:
+
+    This callback tells the given Transport Module that it is about to be unbound from
+    the given Protocol Module.
+
+Arguments:
+
+    DmfInterface - Interface handle.
+
+Return Value:
+
+    None
+
+--*/
+{
+    PAGED_CODE();
+
+    UNREFERENCED_PARAMETER(DmfInterface);
+
+    FuncEntry(DMF_TRACE);
+
+    // Currently NOP.
+    //
+
+    FuncExitVoid(DMF_TRACE);
+}
+#pragma code_seg()
+
+#pragma code_seg("PAGE")
+_IRQL_requires_max_(PASSIVE_LEVEL)
+_IRQL_requires_same_
+_Must_inspect_result_
+NTSTATUS
+DMF_ComponentFirmwareUpdateLoopbackTransport_OfferInformationSend(
+    _In_ DMFINTERFACE DmfInterface,
+    _Inout_updates_bytes_(BufferSize) UCHAR* Buffer,
+    _In_ size_t BufferSize,
+    _In_ size_t HeaderSize
+    )
+/*++
+
+Routine Description:
+
+    Sends offer information command to the simulated device. The device accepts it.
+
+Parameters:
+
+    DmfInterface - Interface handle.
+    Buffer - Header, followed by Offer Information to Send.
+    BufferSize - Size of the above in bytes.
+    HeaderSize - Size of the header. Header is at the beginning of 'Buffer'.
+
+Return:
+
+    NTSTATUS
+
+--*/
+{
+    NTSTATUS ntStatus;
+    DMFMODULE dmfModule;
+
+    PAGED_CODE();
+
+    FuncEntry(DMF_TRACE);
+
+    dmfModule = DMF_InterfaceTransportModuleGet(DmfInterface);
+    DMF_ObjectValidate(dmfModule);
+
+    ntStatus = ComponentFirmwareUpdateLoopbackTransport_OfferResponseSend(dmfModule,
+                                                                          Buffer,
+                                                                          BufferSize,
+                                                                          HeaderSize,
+                                                                          COMPONENT_FIRMWARE_UPDATE_OFFER_ACCEPT);
+
+    FuncExit(DMF_TRACE, "ntStatus=%!STATUS!", ntStatus);
+
+    return ntStatus;
+}
+#pragma code_seg()
+
+#pragma code_seg("PAGE")
+_IRQL_requires_max_(PASSIVE_LEVEL)
+_IRQL_requires_same_
+_Must_inspect_result_
+NTSTATUS
+DMF_ComponentFirmwareUpdateLoopbackTransport_OfferCommandSend(
+    _In_ DMFINTERFACE DmfInterface,
+    _Inout_updates_bytes_(BufferSize) UCHAR* Buffer,
+    _In_ size_t BufferSize,
+    _In_ size_t HeaderSize
+    )
+/*++
+
+Routine Description:
+
+    Sends offer command to the simulated device. The device is always ready.
+
+Parameters:
+
+    DmfInterface - Interface handle.
+    Buffer - Header followed by Offer Command to Send.
+    BufferSize - Size of the above in bytes.
+    HeaderSize - Size of the header. Header is at the begining of 'Buffer'.
+
+Return:
+
+    NTSTATUS
+
+--*/
+{
+    NTSTATUS ntStatus;
+    DMFMODULE dmfModule;
+
+    PAGED_CODE();
+
+    FuncEntry(DMF_TRACE);
+
+    dmfModule = DMF_InterfaceTransportModuleGet(DmfInterface);
+    DMF_ObjectValidate(dmfModule);
+
+    ntStatus = ComponentFirmwareUpdateLoopbackTransport_OfferResponseSend(dmfModule,
+                                                                          Buffer,
+                                                                          BufferSize,
+                                                                          HeaderSize,
+                                                                          COMPONENT_FIRMWARE_UPDATE_OFFER_COMMAND_READY);
+
+    FuncExit(DMF_TRACE, "ntStatus=%!STATUS!", ntStatus);
+
+    return ntStatus;
+}
+#pragma code_seg()
+
+#pragma code_seg("PAGE")
+_IRQL_requires_max_(PASSIVE_LEVEL)
+_IRQL_requires_same_
+_Must_inspect_result_
+NTSTATUS
+DMF_ComponentFirmwareUpdateLoopbackTransport_OfferSend(
+    _In_ DMFINTERFACE DmfInterface,
+    _Inout_updates_bytes_(BufferSize) UCHAR* Buffer,
+    _In_ size_t BufferSize,
+    _In_ size_t HeaderSize
+    )
+/*++
+
+Routine Description:
+
+    Sends offer to the simulated device. The device accepts all offers.
+
+Parameters:
+
+    DmfInterface - Interface handle.
+    Buffer - Header, followed by Offer Content to Send.
+    BufferSize - Size of the above in bytes.
+    HeaderSize - Size of the header. Header is at the beginning of 'Buffer'.
+
+Return:
+
+    NTSTATUS
+
+--*/
+{
+    NTSTATUS ntStatus;
+    DMFMODULE dmfModule;
+
+    PAGED_CODE();
+
+    FuncEntry(DMF_TRACE);
+
+    dmfModule = DMF_InterfaceTransportModuleGet(DmfInterface);
+    DMF_ObjectValidate(dmfModule);
+
+    ntStatus = ComponentFirmwareUpdateLoopbackTransport_OfferResponseSend(dmfModule,
+                                                                          Buffer,
+                                                                          BufferSize,
+                                                                          HeaderSize,
+                                                                          COMPONENT_FIRMWARE_UPDATE_OFFER_ACCEPT);
+
+    FuncExit(DMF_TRACE, "ntStatus=%!STATUS!", ntStatus);
+
+    return ntStatus;
+}
+#pragma code_seg()
+
+#pragma code_seg("PAGE")
+_IRQL_requires_max_(PASSIVE_LEVEL)
+_IRQL_requires_same_
+_Must_inspect_result_
+NTSTATUS
+DMF_ComponentFirmwareUpdateLoopbackTransport_FirmwareVersionGet(
+    _In_ DMFINTERFACE DmfInterface
+    )
+/*++
+
+Routine Description:
+
+    Retrieves the firmware versions from the simulated device. The device has a single component.
+
+Parameters:
+
+    DmfInterface - Interface handle.
+
+Return:
+
+    NTSTATUS
+
+--*/
+{
+    NTSTATUS ntStatus;
+    DMFMODULE dmfModule;
+    DMF_CONFIG_ComponentFirmwareUpdateLoopbackTransport* moduleConfig;
+    UCHAR firmwareVersionResponse[SizeOfFirmwareVersion];
+
+    PAGED_CODE();
+
+    FuncEntry(DMF_TRACE);
+
+    dmfModule = DMF_InterfaceTransportModuleGet(DmfInterface);
+    DMF_ObjectValidate(dmfModule);
+    moduleConfig = DMF_CONFIG_GET(dmfModule);
+
+    // Header is 4 bytes: Component Count (Byte 0) and Protocol Revision (Byte 3).
+    // Each component takes 8 bytes: Version (Bytes 0-3) and Component ID (Byte 5).
+    //
+    RtlZeroMemory(firmwareVersionResponse,
+                  sizeof(firmwareVersionResponse));
+    firmwareVersionResponse[0] = 1;
+    firmwareVersionResponse[3] = LOOPBACK_PROTOCOL_REVISION;
+    RtlCopyMemory(&firmwareVersionResponse[4],
+                  &moduleConfig->FirmwareVersion,
+                  sizeof(moduleConfig->FirmwareVersion));
+    firmwareVersionResponse[4 + 5] = moduleConfig->ComponentIdentifier;
+
+    ntStatus = ComponentFirmwareUpdateLoopbackTransport_ResponseSend(dmfModule,
+                                                                     LoopbackTransport_ResponseType_FirmwareVersion,
+                                                                     firmwareVersionResponse,
+                                                                     sizeof(firmwareVersionResponse));
+
+    FuncExit(DMF_TRACE, "ntStatus=%!STATUS!", ntStatus);
+
+    return ntStatus;
+}
+#pragma code_seg()
+
+#pragma code_seg("PAGE")
+_IRQL_requires_max_(PASSIVE_LEVEL)
+_IRQL_requires_same_
+_Must_inspect_result_
+NTSTATUS
+DMF_ComponentFirmwareUpdateLoopbackTransport_PayloadSend(
+    _In_ DMFINTERFACE DmfInterface,
+    _Inout_updates_bytes_(BufferSize) UCHAR* Buffer,
+    _In_ size_t BufferSize,
+    _In_ size_t HeaderSize
+    )
+/*++
+
+Routine Description:
+
+    Sends Payload to the simulated device. The device responds with the sequence number of the chunk.
+
+Parameters:
+
+    DmfInterface - Interface handle.
+    Buffer - Header, followed by Payload to Send.
+    BufferSize - Size of the above in bytes.
+    HeaderSize - Size of the header. Header is at the beginning of 'Buffer'.
+
+Return:
+
+    NTSTATUS
+
+--*/
+{
+    NTSTATUS ntStatus;
+    DMFMODULE dmfModule;
+    DMF_CONTEXT_ComponentFirmwareUpdateLoopbackTransport* moduleContext;
+    DMF_CONFIG_ComponentFirmwareUpdateLoopbackTransport* moduleConfig;
+    UINT16 sequenceNumber;
+    COMPONENT_FIRMWARE_UPDATE_PAYLOAD_RESPONSE responseStatus;
+    ULONG payloadResponse[SizeOfResponse / sizeof(ULONG)];
+
+    // Payload is Flags (Byte 0), Data Length (Byte 1) and Sequence Number (Bytes 2-3), followed by Address and Data.
+    //
+    const size_t sequenceNumberOffset = 2;
+
+    PAGED_CODE();
+
+    FuncEntry(DMF_TRACE);
+
+    dmfModule = DMF_InterfaceTransportModuleGet(DmfInterface);
+    DMF_ObjectValidate(dmfModule);
+    moduleContext = DMF_CONTEXT_GET(dmfModule);
+    moduleConfig = DMF_CONFIG_GET(dmfModule);
+
+    if (BufferSize < HeaderSize + sequenceNumberOffset + sizeof(sequenceNumber))
+    {
+        TraceEvents(TRACE_LEVEL_ERROR,
+                    DMF_TRACE,
+                    "Invalid payload size %Iu",
+                    BufferSize);
+        ntStatus = STATUS_BUFFER_TOO_SMALL;
+        goto Exit;
+    }
+
+    RtlCopyMemory(&sequenceNumber,
+                  Buffer + HeaderSize + sequenceNumberOffset,
+                  sizeof(sequenceNumber));
+
+    moduleContext->PayloadChunksReceived++;
+
+    // Fail selected chunks once so that the Client can exercise retransmission.
+    //
+    responseStatus = COMPONENT_FIRMWARE_UPDATE_SUCCESS;
+    if ((moduleConfig->PayloadWriteFailureInterval != 0) &&
+        (sequenceNumber % moduleConfig->PayloadWriteFailureInterval == 0) &&
+        (sequenceNumber != moduleContext->LastFailedSequenceNumber))
+    {
+        moduleContext->LastFailedSequenceNumber = sequenceNumber;
+        moduleContext->PayloadChunksFailed++;
+        responseStatus = COMPONENT_FIRMWARE_UPDATE_ERROR_WRITE;
+    }
+
+    // Sequence Number (Bytes 0-1) and Status (Byte 4).
+    //
+    RtlZeroMemory(payloadResponse,
+                  sizeof(payloadResponse));
+    payloadResponse[0] = sequenceNumber;
+    payloadResponse[1] = (ULONG)responseStatus;
+
+    ntStatus = ComponentFirmwareUpdateLoopbackTransport_ResponseSend(dmfModule,
+                                                                     LoopbackTransport_ResponseType_Payload,
+                                                                     (UCHAR*)payloadResponse,
+                                                                     sizeof(payloadResponse));
+
+Exit:
+
+    FuncExit(DMF_TRACE, "ntStatus=%!STATUS!", ntStatus);
+
+    return ntStatus;
+}
+#pragma code_seg()
+
+#pragma code_seg("PAGE")
+_IRQL_requires_max_(PASSIVE_LEVEL)
+_IRQL_requires_same_
+_Must_inspect_result_
+NTSTATUS
+DMF_ComponentFirmwareUpdateLoopbackTransport_ProtocolStop(
+    _In_ DMFINTERFACE DmfInterface
+    )
+/*++
+
+Routine Description:
+
+    Clean up the transport as the protocol is being stopped.
+
+Parameters:
+
+    DmfInterface - Interface handle.
+
+Return:
+
+    NTSTATUS
+
+--*/
+{
+    UNREFERENCED_PARAMETER(DmfInterface);
+
+    PAGED_CODE();
+
+    // Currently NOP.
+    //
+    return STATUS_SUCCESS;
+}
+#pragma code_seg()
+
+#pragma code_seg("PAGE")
+_IRQL_requires_max_(PASSIVE_LEVEL)
+_IRQL_requires_same_
+_Must_inspect_result_
+NTSTATUS
+DMF_ComponentFirmwareUpdateLoopbackTransport_ProtocolStart(
+    _In_ DMFINTERFACE DmfInterface
+    )
+/*++
+
+Routine Description:
+
+    Setup the transport for protocol transaction.
+
+Parameters:
+
+    DmfInterface - Interface handle.
+
+Return:
+
+    NTSTATUS
+
+--*/
+{
+    UNREFERENCED_PARAMETER(DmfInterface);
+
+    PAGED_CODE();
+
+    // Currently NOP.
+    //
+    return STATUS_SUCCESS;
+}
+#pragma code_seg()
+
+#pragma code_seg("PAGE")
+_IRQL_requires_max_(PASSIVE_LEVEL)
+_IRQL_requires_same_
+_Must_inspect_result_
+NTSTATUS
+DMF_ComponentFirmwareUpdateLoopbackTransport_Bind(
+    _In_ DMFINTERFACE DmfInterface,
+    _In_ DMF_INTERFACE_PROTOCOL_ComponentFirmwareUpdate_BIND_DATA* ProtocolBindData,
+    _Out_ DMF_INTERFACE_TRANSPORT_ComponentFirmwareUpdate_BIND_DATA* TransportBindData
+    )
+/*++
+
+Routine Description:
+
+    Binds the given Transport Module to the given Protocol Module.
+
+Parameters:
+
+    DmfInterface - Interface handle.
+    ProtocolBindData - Bind data provided by Protocol for the Transport.
+    TransportBindData - Bind data provided by Transport for the Protocol.
+
+Return:
+
+    NTSTATUS
+
+--*/
+{
+    NTSTATUS ntStatus;
+    DMF_CONTEXT_ComponentFirmwareUpdateLoopbackTransport* moduleContext;
+    DMF_CONFIG_ComponentFirmwareUpdateLoopbackTransport* moduleConfig;
+    DMFMODULE dmfModule;
+
+    UNREFERENCED_PARAMETER(ProtocolBindData);
+
+    PAGED_CODE();
+
+    FuncEntry(DMF_TRACE);
+
+    ntStatus = STATUS_SUCCESS;
+    dmfModule = DMF_InterfaceTransportModuleGet(DmfInterface);
+    moduleContext = DMF_CONTEXT_GET(dmfModule);
+    moduleConfig = DMF_CONFIG_GET(dmfModule);
+
+    // Save the Interface Handle representing the Interface binding.
+    //
+    moduleContext->DmfInterfaceComponentFirmwareUpdate = DmfInterface;
+
+    // Use the same sizes as the HID transport so that the results are comparable.
+    //
+    TransportBindData->TransportHeaderSize = LoopbackHeaderSize;
+    TransportBindData->TransportFirmwarePayloadBufferRequiredSize = SizeOfPayload;
+    TransportBindData->TransportFirmwareVersionBufferRequiredSize = SizeOfFirmwareVersion;
+    TransportBindData->TransportOfferBufferRequiredSize = SizeOfOffer;
+    TransportBindData->TransportWaitTimeout = LOOPBACK_WAIT_TIMEOUT_MS + moduleConfig->ResponseLatencyMs;
+    if (moduleConfig->PayloadFillAlignment == 0)
+    {
+        TransportBindData->TransportPayloadFillAlignment = 1;
+    }
+    else
+    {
+        TransportBindData->TransportPayloadFillAlignment = moduleConfig->PayloadFillAlignment;
+    }
+
+    FuncExit(DMF_TRACE, "ntStatus=%!STATUS!", ntStatus);
+
+    return ntStatus;
+}
+#pragma code_seg()
+
+_IRQL_requires_max_(PASSIVE_LEVEL)
+_IRQL_requires_same_
+VOID
+DMF_ComponentFirmwareUpdateLoopbackTransport_Unbind(
+    _In_ DMFINTERFACE DmfInterface
+    )
+/*++
+
+Routine Description:
+
+    Deregisters protocol Module from the transport Module.
+
+Parameters:
+
+    DmfInterface - Interface handle.
+
+Return:
+
+    None
+
+--*/
+{
+    UNREFERENCED_PARAMETER(DmfInterface);
+}
+
+#pragma code_seg("PAGE")
+_Function_class_(DMF_ChildModulesAdd)
+_IRQL_requires_max_(PASSIVE_LEVEL)
+VOID
+DMF_ComponentFirmwareUpdateLoopbackTransport_ChildModulesAdd(
+    _In_ DMFMODULE DmfModule,
+    _In_ DMF_MODULE_ATTRIBUTES* DmfParentModuleAttributes,
+    _In_ PDMFMODULE_INIT DmfModuleInit
+    )
+/*++
+
+Routine Description:
+
+    Configure and add the required Child Modules to the given Parent Module.
+
+Arguments:
+
+    DmfModule - The given Parent Module.
+    DmfParentModuleAttributes - Pointer to the parent DMF_MODULE_ATTRIBUTES structure.
+    DmfModuleInit - Opaque structure to be passed to DMF_DmfModuleAdd.
+
+Return Value:
+
+    None
+
+--*/
+{
+    DMF_CONTEXT_ComponentFirmwareUpdateLoopbackTransport* moduleContext;
+    DMF_CONFIG_ComponentFirmwareUpdateLoopbackTransport* moduleConfig;
+    DMF_MODULE_ATTRIBUTES moduleAttributes;
+    DMF_CONFIG_ThreadedBufferQueue moduleConfigThreadedBufferQueue;
+
+    PAGED_CODE();
+
+    UNREFERENCED_PARAMETER(DmfParentModuleAttributes);
+
+    FuncEntry(DMF_TRACE);
+
+    moduleConfig = DMF_CONFIG_GET(DmfModule);
+    moduleContext = DMF_CONTEXT_GET(DmfModule);
+
+    // Responses are delivered immediately when there is no latency.
+    //
+    if (moduleConfig->ResponseLatencyMs > 0)
+    {
+        // Time
+        // ----
+        //
+        DMF_Time_ATTRIBUTES_INIT(&moduleAttributes);
+        DMF_DmfModuleAdd(DmfModuleInit,
+                         &moduleAttributes,
+                         WDF_NO_OBJECT_ATTRIBUTES,
+                         &moduleContext->DmfModuleTime);
+
+        // ThreadedBufferQueue
+        // -------------------
+        //
+        DMF_CONFIG_ThreadedBufferQueue_AND_ATTRIBUTES_INIT(&moduleConfigThreadedBufferQueue,
+                                                           &moduleAttributes);
+        moduleConfigThreadedBufferQueue.EvtThreadedBufferQueueWork = ComponentFirmwareUpdateLoopbackTransport_ResponseWork;
+        moduleConfigThreadedBufferQueue.BufferQueueConfig.SourceSettings.BufferContextSize = 0;
+        moduleConfigThreadedBufferQueue.BufferQueueConfig.SourceSettings.BufferCount = LOOPBACK_RESPONSE_BUFFER_COUNT;
+        moduleConfigThreadedBufferQueue.BufferQueueConfig.SourceSettings.BufferSize = sizeof(LOOPBACK_RESPONSE);
+        moduleConfigThreadedBufferQueue.BufferQueueConfig.SourceSettings.EnableLookAside = TRUE;
+        moduleConfigThreadedBufferQueue.BufferQueueConfig.SourceSettings.PoolType = NonPagedPoolNx;
+        DMF_DmfModuleAdd(DmfModuleInit,
+                         &moduleAttributes,
+                         WDF_NO_OBJECT_ATTRIBUTES,
+                         &moduleContext->DmfModuleThreadedBufferQueue);
+    }
+
+    FuncExitVoid(DMF_TRACE);
+}
+#pragma code_seg()
+
+#pragma code_seg("PAGE")
+_Function_class_(DMF_Open)
+_IRQL_requires_max_(PASSIVE_LEVEL)
+_Must_inspect_result_
+static
+NTSTATUS
+DMF_ComponentFirmwareUpdateLoopbackTransport_Open(
+    _In_ DMFMODULE DmfModule
+    )
+/*++
+
+Routine Description:
+
+    Initialize an instance of a DMF Module Loopback Transport.
+
+Arguments:
+
+    DmfModule - This Module's DMF Module.
+
+Return Value:
+
+    NTSTATUS
+
+--*/
+{
+    NTSTATUS ntStatus;
+    DMF_CONTEXT_ComponentFirmwareUpdateLoopbackTransport* moduleContext;
+
+    PAGED_CODE();
+
+    FuncEntry(DMF_TRACE);
+
+    moduleContext = DMF_CONTEXT_GET(DmfModule);
+
+    moduleContext->LastFailedSequenceNumber = 0;
+    moduleContext->PayloadChunksReceived = 0;
+    moduleContext->PayloadChunksFailed = 0;
+
+    ntStatus = STATUS_SUCCESS;
+    if (moduleContext->DmfModuleThreadedBufferQueue != NULL)
+    {
+        ntStatus = DMF_ThreadedBufferQueue_Start(moduleContext->DmfModuleThreadedBufferQueue);
+        if (!NT_SUCCESS(ntStatus))
+        {
+            TraceEvents(TRACE_LEVEL_ERROR,
+                        DMF_TRACE,
+                        "DMF_ThreadedBufferQueue_Start fails: ntStatus=%!STATUS!",
+                        ntStatus);
+        }
+    }
+
+    FuncExit(DMF_TRACE, "ntStatus=%!STATUS!", ntStatus);
+
+    return(ntStatus);
+}
+#pragma code_seg()
+
+#pragma code_seg("PAGE")
+_Function_class_(DMF_Close)
+_IRQL_requires_max_(PASSIVE_LEVEL)
+static
+VOID
+DMF_ComponentFirmwareUpdateLoopbackTransport_Close(
+    _In_ DMFMODULE DmfModule
+    )
+/*++
+
+Routine Description:
+
+    Uninitialize an instance of a DMF Module Loopback Transport.
+
+Arguments:
+
+    DmfModule - This Module's DMF Module.
+
+Return Value:
+
+    None
+
+--*/
+{
+    DMF_CONTEXT_ComponentFirmwareUpdateLoopbackTransport* moduleContext;
+
+    PAGED_CODE();
+
+    FuncEntry(DMF_TRACE);
+
+    moduleContext = DMF_CONTEXT_GET(DmfModule);
+
+    if (moduleContext->DmfModuleThreadedBufferQueue != NULL)
+    {
+        DMF_ThreadedBufferQueue_Stop(moduleContext->DmfModuleThreadedBufferQueue);
+    }
+
+    FuncExitVoid(DMF_TRACE);
+}
+#pragma code_seg()
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+// Public Calls by Client
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+
+#pragma code_seg("PAGE")
+_IRQL_requires_max_(PASSIVE_LEVEL)
+_Must_inspect_result_
+NTSTATUS
+DMF_ComponentFirmwareUpdateLoopbackTransport_Create(
+    _In_ WDFDEVICE Device,
+    _In_ DMF_MODULE_ATTRIBUTES* DmfModuleAttributes,
+    _In_ WDF_OBJECT_ATTRIBUTES* ObjectAttributes,
+    _Out_ DMFMODULE* DmfModule
+    )
+/*++
+
+Routine Description:
+
+    Create an instance of a DMF Module of type Component Firmware Update Loopback Transport.
+
+Arguments:
+
+    Device - WdfDevice associated with this instance.
+    DmfModuleAttributes - Opaque structure that contains parameters DMF needs to initialize the Module.
+    ObjectAttributes - WDF object attributes for DMFMODULE.
+    DmfModule - Address of the location where the created DMFMODULE handle is returned.
+
+Return Value:
+
+    NTSTATUS
+
+--*/
+{
+    NTSTATUS ntStatus;
+    DMF_MODULE_DESCRIPTOR dmfModuleDescriptor_ComponentFirmwareUpdateLoopbackTransport;
+    DMF_CALLBACKS_DMF dmfCallbacksDmf_ComponentFirmwareUpdateLoopbackTransport;
+    DMF_INTERFACE_TRANSPORT_ComponentFirmwareUpdate_DECLARATION_DATA transportDeclarationData;
+
+    PAGED_CODE();
+
+    FuncEntry(DMF_TRACE);
+
+    DMF_CALLBACKS_DMF_INIT(&dmfCallbacksDmf_ComponentFirmwareUpdateLoopbackTransport);
+    dmfCallbacksDmf_ComponentFirmwareUpdateLoopbackTransport.ChildModulesAdd = DMF_ComponentFirmwareUpdateLoopbackTransport_ChildModulesAdd;
+    dmfCallbacksDmf_ComponentFirmwareUpdateLoopbackTransport.DeviceOpen = DMF_ComponentFirmwareUpdateLoopbackTransport_Open;
+    dmfCallbacksDmf_ComponentFirmwareUpdateLoopbackTransport.DeviceClose = DMF_ComponentFirmwareUpdateLoopbackTransport_Close;
+
+    DMF_MODULE_DESCRIPTOR_INIT_CONTEXT_TYPE(dmfModuleDescriptor_ComponentFirmwareUpdateLoopbackTransport,
+                                            ComponentFirmwareUpdateLoopbackTransport,
+                                            DMF_CONTEXT_ComponentFirmwareUpdateLoopbackTransport,
+                                            DMF_MODULE_OPTIONS_PASSIVE,
+                                            DMF_MODULE_OPEN_OPTION_OPEN_Create);
+
+    dmfModuleDescriptor_ComponentFirmwareUpdateLoopbackTransport.CallbacksDmf = &dmfCallbacksDmf_ComponentFirmwareUpdateLoopbackTransport;
+
+    ntStatus = DMF_ModuleCreate(Device,
+                                DmfModuleAttributes,
+                                ObjectAttributes,
+                                &dmfModuleDescriptor_ComponentFirmwareUpdateLoopbackTransport,
+                                DmfModule);
+    if (!NT_SUCCESS(ntStatus))
+    {
+        TraceEvents(TRACE_LEVEL_ERROR,
+                    DMF_TRACE,
+                    "DMF_ModuleCreate fails: ntStatus=%!STATUS!",
+                    ntStatus);
+        goto Exit;
+    }
+
+    // Initialize the Transport Declaration Data.
+    //
+    DMF_INTERFACE_TRANSPORT_ComponentFirmwareUpdate_DESCRIPTOR_INIT(&transportDeclarationData,
+                                                                    DMF_ComponentFirmwareUpdateLoopbackTransport_PostBind,
+                                                                    DMF_ComponentFirmwareUpdateLoopbackTransport_PreUnbind,
+                                                                    DMF_ComponentFirmwareUpdateLoopbackTransport_Bind,
+                                                                    DMF_ComponentFirmwareUpdateLoopbackTransport_Unbind,
+                                                                    DMF_ComponentFirmwareUpdateLoopbackTransport_FirmwareVersionGet,
+                                                                    DMF_ComponentFirmwareUpdateLoopbackTransport_OfferInformationSend,
+                                                                    DMF_ComponentFirmwareUpdateLoopbackTransport_OfferCommandSend,
+                                                                    DMF_ComponentFirmwareUpdateLoopbackTransport_OfferSend,
+                                                                    DMF_ComponentFirmwareUpdateLoopbackTransport_PayloadSend,
+                                                                    DMF_ComponentFirmwareUpdateLoopbackTransport_ProtocolStart,
+                                                                    DMF_ComponentFirmwareUpdateLoopbackTransport_ProtocolStop);
+
+    // Add the interface to the Transport Module.
+    //
+    ntStatus = DMF_ModuleInterfaceDescriptorAdd(*DmfModule,
+                                                (DMF_INTERFACE_DESCRIPTOR*)&transportDeclarationData);
+    if (!NT_SUCCESS(ntStatus))
+    {
+        TraceEvents(TRACE_LEVEL_ERROR, DMF_TRACE, "DMF_ModuleInterfaceDescriptorAdd fails: ntStatus=%!STATUS!", ntStatus);
+        goto Exit;
+    }
+
+Exit:
+
+    FuncExit(DMF_TRACE, "ntStatus=%!STATUS!", ntStatus);
+
+    return(ntStatus);
+}
+#pragma code_seg()
+
+// Module Methods
+//
+
+#pragma code_seg("PAGE")
+_IRQL_requires_max_(PASSIVE_LEVEL)
+VOID
+DMF_ComponentFirmwareUpdateLoopbackTransport_PayloadStatisticsGet(
+    _In_ DMFMODULE DmfModule,
+    _Out_ ULONG* PayloadChunksReceived,
+    _Out_ ULONG* PayloadChunksFailed
+    )
+/*++
+
+Routine Description:
+
+    Returns the number of payload chunks the simulated device received and the number it failed on purpose.
+
+Arguments:
+
+    DmfModule - This Module's DMF Object.
+    PayloadChunksReceived - Number of payload chunks received, including chunks that were sent again.
+    PayloadChunksFailed - Number of payload chunks failed with COMPONENT_FIRMWARE_UPDATE_ERROR_WRITE.
+
+Return Value:
+
+    None
+
+--*/
+{
+    DMF_CONTEXT_ComponentFirmwareUpdateLoopbackTransport* moduleContext;
+
+    PAGED_CODE();
+
+    FuncEntry(DMF_TRACE);
+
+    DMFMODULE_VALIDATE_IN_METHOD(DmfModule,
+                                 ComponentFirmwareUpdateLoopbackTransport);
+
+    moduleContext = DMF_CONTEXT_GET(DmfModule);
+
+    *PayloadChunksReceived = moduleContext->PayloadChunksReceived;
+    *PayloadChunksFailed = moduleContext->PayloadChunksFailed;
+
+    FuncExitVoid(DMF_TRACE);
+}
+#pragma code_seg()
+
+// eof: Dmf_ComponentFirmwareUpdateLoopbackTransport.c
+//
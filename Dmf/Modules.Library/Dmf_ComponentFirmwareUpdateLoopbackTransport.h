@@ -0,0 +1,66 @@
+/*++
+
+    Copyright (c) Microsoft Corporation. All Rights Reserved.
+    Licensed under the MIT license.
+
+Module Name:
+
+   Dmf_ComponentFirmwareUpdateLoopbackTransport.h
+
+Abstract:
+
+   Companion file to Dmf_ComponentFirmwareUpdateLoopbackTransport.c
+
+Environment:
+
+   User-mode Driver Framework
+
+--*/
+
+#pragma once
+
+
+// Configuration of the module.
+//
+typedef struct
+{
+    // Time in milliseconds from a message being sent until its response is delivered.
+    // If 0, responses are delivered before the send call returns.
+    //
+    ULONG ResponseLatencyMs;
+
+    // Component Identifier and firmware version reported by the simulated device.
+    //
+    BYTE ComponentIdentifier;
+    ULONG FirmwareVersion;
+
+    // If not 0, every payload chunk whose sequence number is a multiple of this value
+    // is failed once with COMPONENT_FIRMWARE_UPDATE_ERROR_WRITE.
+    //
+    ULONG PayloadWriteFailureInterval;
+
+    // Payload buffer fill alignment required. If 0, 1 is used.
+    //
+    UINT PayloadFillAlignment;
+} DMF_CONFIG_ComponentFirmwareUpdateLoopbackTransport;
+
+// This macro declares the following functions:
+// DMF_ComponentFirmwareUpdateLoopbackTransport_ATTRIBUTES_INIT()
+// DMF_CONFIG_ComponentFirmwareUpdateLoopbackTransport_AND_ATTRIBUTES_INIT()
+// DMF_ComponentFirmwareUpdateLoopbackTransport_Create()
+//
+DECLARE_DMF_MODULE(ComponentFirmwareUpdateLoopbackTransport)
+
+// Module Methods
+//
+
+_IRQL_requires_max_(PASSIVE_LEVEL)
+VOID
+DMF_ComponentFirmwareUpdateLoopbackTransport_PayloadStatisticsGet(
+    _In_ DMFMODULE DmfModule,
+    _Out_ ULONG* PayloadChunksReceived,
+    _Out_ ULONG* PayloadChunksFailed
+    );
+
+// eof: Dmf_ComponentFirmwareUpdateLoopbackTransport.h
+//
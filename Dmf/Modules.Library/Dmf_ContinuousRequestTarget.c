@@ -58,6 +58,10 @@ typedef struct _DMF_CONTEXT_ContinuousRequestTarget
     // Single Asynchronous Request.
     //
     DMFMODULE DmfModuleQueuedWorkitemSingle;
+    // Histogram of the time from when stream requests are sent until their completion is processed.
+    // NULL unless EnableLatencyHistogram is set.
+    //
+    DMFMODULE DmfModuleLatencyHistogram;
     // Completion routine for stream asynchronous requests.
     //
     EVT_WDF_REQUEST_COMPLETION_ROUTINE* CompletionRoutineStream;
@@ -70,6 +74,20 @@ typedef struct _DMF_CONTEXT_ContinuousRequestTarget
     // Pending reuse requests.
     //
     WDFCOLLECTION PendingReuseRequests;
+    // Completed single requests (and their memory objects) that are sent again by later
+    // single requests instead of creating new ones.
+    //
+    LIST_ENTRY RecycledRequestList;
+    // Incremented when the IoTarget changes so that requests created for a previous
+    // IoTarget are not recycled.
+    //
+    ULONG IoTargetGeneration;
+    // Number of single requests that are not in RecycledRequestList.
+    //
+    ULONG RequestsInUse;
+    // Statistics of the pool of recycled requests.
+    //
+    ContinuousRequestTarget_RequestPoolStatistics RequestPoolStatistics;
     // Indicates that the Client has stopped streaming. This flag prevents new requests from 
     // being sent to the underlying target.
     //
@@ -134,7 +152,41 @@ typedef struct
 } UNIQUE_REQUEST;
 WDF_DECLARE_CONTEXT_TYPE_WITH_NAME(UNIQUE_REQUEST, UniqueRequestContextGet)
 
+// Context of stream requests.
+//
+typedef struct
+{
+    // Tick count when the request was sent (only when latency histogram is enabled).
+    //
+    LONGLONG SendTick;
+} ContinuousRequestTarget_StreamRequestContext;
+WDF_DECLARE_CONTEXT_TYPE_WITH_NAME(ContinuousRequestTarget_StreamRequestContext, ContinuousRequestTarget_StreamRequestContextGet)
+
+// Context of requests sent by the single request Methods so that they can be recycled.
+//
+typedef struct
+{
+    // Links the request into RecycledRequestList.
+    //
+    LIST_ENTRY ListEntry;
+    // The request this context belongs to.
+    //
+    WDFREQUEST Request;
+    // Memory objects used to attach the Client's buffers to the request. They are
+    // created the first time they are needed. Afterward, only their buffer is replaced.
+    //
+    WDFMEMORY MemoryForRequest;
+    WDFMEMORY MemoryForResponse;
+    // Value of IoTargetGeneration when the request was created.
+    //
+    ULONG IoTargetGeneration;
+} ContinuousRequestTarget_RecycledRequestContext;
+WDF_DECLARE_CONTEXT_TYPE_WITH_NAME(ContinuousRequestTarget_RecycledRequestContext, ContinuousRequestTarget_RecycledRequestContextGet)
+
 #define DEFAULT_NUMBER_OF_PENDING_PASSIVE_LEVEL_COMPLETION_ROUTINES 4
+// Maximum number of completed single requests kept for reuse by later sends.
+//
+#define MAXIMUM_NUMBER_OF_RECYCLED_REQUESTS 16
 
 typedef struct
 {
@@ -641,6 +693,316 @@ Return Value:
     }
 }
 
+_Must_inspect_result_
+static
+NTSTATUS
+ContinuousRequestTarget_RecycledRequestGet(
+    _In_ DMFMODULE DmfModule,
+    _Out_ WDFREQUEST* Request
+    )
+/*++
+
+Routine Description:
+
+    Get a WDFREQUEST from the pool of recycled requests. If the pool is empty, create a new one.
+
+Arguments:
+
+    DmfModule - This Module's handle.
+    Request - Address where the request is returned.
+
+Return Value:
+
+    NTSTATUS
+
+--*/
+{
+    NTSTATUS ntStatus;
+    DMF_CONTEXT_ContinuousRequestTarget* moduleContext;
+    WDF_OBJECT_ATTRIBUTES requestAttributes;
+    WDF_OBJECT_ATTRIBUTES recycledRequestAttributes;
+    ContinuousRequestTarget_RecycledRequestContext* recycledRequestContext;
+    LIST_ENTRY* listEntry;
+    WDFREQUEST request;
+    ULONG ioTargetGeneration;
+
+    *Request = NULL;
+    moduleContext = DMF_CONTEXT_GET(DmfModule);
+
+    request = NULL;
+
+    DMF_ModuleLock(DmfModule);
+
+    if (! IsListEmpty(&moduleContext->RecycledRequestList))
+    {
+        listEntry = RemoveHeadList(&moduleContext->RecycledRequestList);
+        recycledRequestContext = CONTAINING_RECORD(listEntry,
+                                                   ContinuousRequestTarget_RecycledRequestContext,
+                                                   ListEntry);
+        request = recycledRequestContext->Request;
+        moduleContext->RequestPoolStatistics.RequestsAvailable--;
+        moduleContext->RequestPoolStatistics.RequestsRecycled++;
+    }
+    else
+    {
+        moduleContext->RequestPoolStatistics.RequestsCreated++;
+    }
+    moduleContext->RequestsInUse++;
+    if (moduleContext->RequestsInUse > moduleContext->RequestPoolStatistics.MaximumRequestsInUse)
+    {
+        moduleContext->RequestPoolStatistics.MaximumRequestsInUse = moduleContext->RequestsInUse;
+    }
+    ioTargetGeneration = moduleContext->IoTargetGeneration;
+
+    DMF_ModuleUnlock(DmfModule);
+
+    if (request != NULL)
+    {
+        ntStatus = STATUS_SUCCESS;
+        goto Exit;
+    }
+
+    WDF_OBJECT_ATTRIBUTES_INIT_CONTEXT_TYPE(&requestAttributes,
+                                            UNIQUE_REQUEST);
+    requestAttributes.ParentObject = DMF_ParentDeviceGet(DmfModule);
+    ntStatus = WdfRequestCreate(&requestAttributes,
+                                moduleContext->IoTarget,
+                                &request);
+    if (! NT_SUCCESS(ntStatus))
+    {
+        request = NULL;
+        TraceEvents(TRACE_LEVEL_ERROR, DMF_TRACE, "WdfRequestCreate fails: ntStatus=%!STATUS!", ntStatus);
+        goto Exit;
+    }
+
+    WDF_OBJECT_ATTRIBUTES_INIT_CONTEXT_TYPE(&recycledRequestAttributes,
+                                            ContinuousRequestTarget_RecycledRequestContext);
+    ntStatus = WdfObjectAllocateContext(request,
+                                        &recycledRequestAttributes,
+                                        (VOID**)&recycledRequestContext);
+    if (! NT_SUCCESS(ntStatus))
+    {
+        TraceEvents(TRACE_LEVEL_ERROR, DMF_TRACE, "WdfObjectAllocateContext fails: ntStatus=%!STATUS!", ntStatus);
+        WdfObjectDelete(request);
+        request = NULL;
+        goto Exit;
+    }
+
+    recycledRequestContext->Request = request;
+    recycledRequestContext->IoTargetGeneration = ioTargetGeneration;
+
+Exit:
+
+    if (NT_SUCCESS(ntStatus))
+    {
+        // The cancel id of a previous send must not match this send.
+        //
+        UNIQUE_REQUEST* uniqueRequestId = UniqueRequestContextGet(request);
+        uniqueRequestId->UniqueRequestIdCancel = 0;
+        *Request = request;
+    }
+    else
+    {
+        DMF_ModuleLock(DmfModule);
+        moduleContext->RequestsInUse--;
+        DMF_ModuleUnlock(DmfModule);
+    }
+
+    return ntStatus;
+}
+
+static
+VOID
+ContinuousRequestTarget_RecycledRequestPut(
+    _In_ DMFMODULE DmfModule,
+    _In_ WDFREQUEST Request
+    )
+/*++
+
+Routine Description:
+
+    Return a WDFREQUEST that is no longer in use to the pool of recycled requests. The request
+    is deleted instead if the pool is full, if the request was formatted for a previous IoTarget
+    or if the Client could still cancel it.
+
+Arguments:
+
+    DmfModule - This Module's handle.
+    Request - The given request.
+
+Return Value:
+
+    None
+
+--*/
+{
+    NTSTATUS ntStatus;
+    DMF_CONTEXT_ContinuousRequestTarget* moduleContext;
+    ContinuousRequestTarget_RecycledRequestContext* recycledRequestContext;
+    UNIQUE_REQUEST* uniqueRequestId;
+    WDF_REQUEST_REUSE_PARAMS reuseParams;
+    BOOLEAN recycled;
+
+    moduleContext = DMF_CONTEXT_GET(DmfModule);
+    recycledRequestContext = ContinuousRequestTarget_RecycledRequestContextGet(Request);
+    uniqueRequestId = UniqueRequestContextGet(Request);
+    recycled = FALSE;
+
+    // Release everything the previous send attached to the request (including
+    // references to the Client's buffers).
+    //
+    WDF_REQUEST_REUSE_PARAMS_INIT(&reuseParams,
+                                  WDF_REQUEST_REUSE_NO_FLAGS,
+                                  STATUS_SUCCESS);
+    ntStatus = WdfRequestReuse(Request,
+                               &reuseParams);
+
+    DMF_ModuleLock(DmfModule);
+
+    DmfAssert(moduleContext->RequestsInUse > 0);
+    moduleContext->RequestsInUse--;
+    // A request the Client can cancel is never recycled because DMF_ContinuousRequestTarget_Cancel()
+    // may still hold a reference to it and would cancel the next send.
+    //
+    if (NT_SUCCESS(ntStatus) &&
+        (0 == uniqueRequestId->UniqueRequestIdCancel) &&
+        (recycledRequestContext->IoTargetGeneration == moduleContext->IoTargetGeneration) &&
+        (moduleContext->RequestPoolStatistics.RequestsAvailable < MAXIMUM_NUMBER_OF_RECYCLED_REQUESTS))
+    {
+        InsertTailList(&moduleContext->RecycledRequestList,
+                       &recycledRequestContext->ListEntry);
+        moduleContext->RequestPoolStatistics.RequestsAvailable++;
+        recycled = TRUE;
+    }
+    else
+    {
+        moduleContext->RequestPoolStatistics.RequestsDeleted++;
+    }
+
+    DMF_ModuleUnlock(DmfModule);
+
+    if (! recycled)
+    {
+        WdfObjectDelete(Request);
+    }
+}
+
+_Must_inspect_result_
+static
+NTSTATUS
+ContinuousRequestTarget_RecycledRequestMemoryAssign(
+    _In_ WDFREQUEST Request,
+    _Inout_ WDFMEMORY* Memory,
+    _In_ VOID* Buffer,
+    _In_ size_t BufferSize
+    )
+/*++
+
+Routine Description:
+
+    Attach the given Client buffer to one of the memory objects of a recycled request. The memory
+    object is created the first time it is needed. Afterward, only its buffer is replaced.
+
+Arguments:
+
+    Request - The given request.
+    Memory - The memory object to update (or create).
+    Buffer - The given Client buffer.
+    BufferSize - Size of Buffer in bytes.
+
+Return Value:
+
+    NTSTATUS
+
+--*/
+{
+    NTSTATUS ntStatus;
+    WDF_OBJECT_ATTRIBUTES memoryAttributes;
+
+    if (*Memory != NULL)
+    {
+        WdfMemoryAssignBuffer(*Memory,
+                              Buffer,
+                              BufferSize);
+        ntStatus = STATUS_SUCCESS;
+        goto Exit;
+    }
+
+    WDF_OBJECT_ATTRIBUTES_INIT(&memoryAttributes);
+    memoryAttributes.ParentObject = Request;
+
+    ntStatus = WdfMemoryCreatePreallocated(&memoryAttributes,
+                                           Buffer,
+                                           BufferSize,
+                                           Memory);
+    if (! NT_SUCCESS(ntStatus))
+    {
+        *Memory = NULL;
+        TraceEvents(TRACE_LEVEL_ERROR, DMF_TRACE, "WdfMemoryCreatePreallocated fails: ntStatus=%!STATUS!", ntStatus);
+    }
+
+Exit:
+
+    return ntStatus;
+}
+
+static
+VOID
+ContinuousRequestTarget_RecycledRequestsFlush(
+    _In_ DMFMODULE DmfModule
+    )
+/*++
+
+Routine Description:
+
+    Delete all the requests in the pool of recycled requests. Requests that are in use are
+    deleted when they complete. This is done when the IoTarget changes because requests
+    are created for a specific IoTarget.
+
+Arguments:
+
+    DmfModule - This Module's handle.
+
+Return Value:
+
+    None
+
+--*/
+{
+    DMF_CONTEXT_ContinuousRequestTarget* moduleContext;
+    ContinuousRequestTarget_RecycledRequestContext* recycledRequestContext;
+    LIST_ENTRY requestsToDelete;
+    LIST_ENTRY* listEntry;
+
+    moduleContext = DMF_CONTEXT_GET(DmfModule);
+
+    InitializeListHead(&requestsToDelete);
+
+    DMF_ModuleLock(DmfModule);
+
+    moduleContext->IoTargetGeneration++;
+    while (! IsListEmpty(&moduleContext->RecycledRequestList))
+    {
+        listEntry = RemoveHeadList(&moduleContext->RecycledRequestList);
+        InsertTailList(&requestsToDelete,
+                       listEntry);
+        moduleContext->RequestPoolStatistics.RequestsAvailable--;
+        moduleContext->RequestPoolStatistics.RequestsDeleted++;
+    }
+    DmfAssert(0 == moduleContext->RequestPoolStatistics.RequestsAvailable);
+
+    DMF_ModuleUnlock(DmfModule);
+
+    while (! IsListEmpty(&requestsToDelete))
+    {
+        listEntry = RemoveHeadList(&requestsToDelete);
+        recycledRequestContext = CONTAINING_RECORD(listEntry,
+                                                   ContinuousRequestTarget_RecycledRequestContext,
+                                                   ListEntry);
+        WdfObjectDelete(recycledRequestContext->Request);
+    }
+}
+
 VOID
 ContinuousRequestTarget_ProcessAsynchronousRequestSingleRoot(
     _In_ DMFMODULE DmfModule,
@@ -721,10 +1083,11 @@ Return Value:
         // can delete the buffer returned without leaving a dangling reference in the memory manager.
         // E.g. Suppose the buffer in the callback is part of another buffer (like in the case of BufferPool) and 
         // the buffer pool deletes it during the callback, the memory manager will trigger verifier bugcheck.
-        // Since the buffer is preallocated and attached to the request, delete the request before calling the 
-        // callback so that the dangling reference is removed, and the callback is free to delete the buffer.
+        // Since the buffer is preallocated and attached to the request, recycle (or delete) the request before
+        // calling the callback so that the dangling reference is removed, and the callback is free to delete the buffer.
         //
-        WdfObjectDelete(Request);
+        ContinuousRequestTarget_RecycledRequestPut(DmfModule,
+                                                   Request);
     }
     else
     {
@@ -1128,6 +1491,10 @@ Return Value:
                 "WdfRequestGetStatus Request=0x%p completes: ntStatus=%!STATUS!",
                 Request, ntStatus);
 
+    DMF_LATENCYHISTOGRAM_PROBE_END(moduleContext->DmfModuleLatencyHistogram,
+                                   0,
+                                   ContinuousRequestTarget_StreamRequestContextGet(Request)->SendTick);
+
     // Get information about the request completion.
     //
     WdfRequestGetCompletionParams(Request,
@@ -1694,6 +2061,9 @@ Return Value:
                                            moduleContext->CompletionRoutineStream,
                                            (WDFCONTEXT) (DmfModule));
 
+            DMF_LATENCYHISTOGRAM_PROBE_BEGIN(moduleContext->DmfModuleLatencyHistogram,
+                                             ContinuousRequestTarget_StreamRequestContextGet(Request)->SendTick);
+
             // Send the request - Asynchronous call, so check for Status if it fails.
             // If it succeeds, the Status will be checked in Completion Routine.
             //
@@ -2139,6 +2509,7 @@ ContinuousRequestTarget_RequestCreateAndSend(
 Routine Description:
 
     Creates and sends a synchronous request to the IoTarget given a buffer, IOCTL and other information.
+    The request and its memory objects are taken from the pool of recycled requests when possible.
 
 Arguments:
 
@@ -2166,8 +2537,7 @@ Return Value:
     WDFREQUEST request;
     WDFMEMORY memoryForRequest;
     WDFMEMORY memoryForResponse;
-    WDF_OBJECT_ATTRIBUTES requestAttributes;
-    WDF_OBJECT_ATTRIBUTES memoryAttributes;
+    ContinuousRequestTarget_RecycledRequestContext* recycledRequestContext;
     WDF_REQUEST_SEND_OPTIONS sendOptions;
     size_t outputBufferSize;
     BOOLEAN requestSendResult;
@@ -2195,40 +2565,34 @@ Return Value:
 
     moduleConfig = DMF_CONFIG_GET(DmfModule);
 
-    WDF_OBJECT_ATTRIBUTES_INIT_CONTEXT_TYPE(&requestAttributes,
-                                            UNIQUE_REQUEST);
-    requestAttributes.ParentObject = device;
-    request = NULL;
-    ntStatus = WdfRequestCreate(&requestAttributes,
-                                moduleContext->IoTarget,
-                                &request);
+    ntStatus = ContinuousRequestTarget_RecycledRequestGet(DmfModule,
+                                                          &request);
     if (! NT_SUCCESS(ntStatus))
     {
         request = NULL;
-        TraceEvents(TRACE_LEVEL_ERROR, DMF_TRACE, "WdfRequestCreate fails: ntStatus=%!STATUS!", ntStatus);
+        TraceEvents(TRACE_LEVEL_ERROR, DMF_TRACE, "ContinuousRequestTarget_RecycledRequestGet fails: ntStatus=%!STATUS!", ntStatus);
         return ntStatus;
     }
 
     UNIQUE_REQUEST* uniqueRequestId = UniqueRequestContextGet(request);
     dmfRequestIdCancel = 0;
 
-    WDF_OBJECT_ATTRIBUTES_INIT(&memoryAttributes);
-    memoryAttributes.ParentObject = request;
+    recycledRequestContext = ContinuousRequestTarget_RecycledRequestContextGet(request);
 
     memoryForRequest = NULL;
     if (RequestLength > 0)
     {
         DmfAssert(RequestBuffer != NULL);
-        ntStatus = WdfMemoryCreatePreallocated(&memoryAttributes,
-                                               RequestBuffer,
-                                               RequestLength,
-                                               &memoryForRequest);
+        ntStatus = ContinuousRequestTarget_RecycledRequestMemoryAssign(request,
+                                                                       &recycledRequestContext->MemoryForRequest,
+                                                                       RequestBuffer,
+                                                                       RequestLength);
         if (! NT_SUCCESS(ntStatus))
         {
-            memoryForRequest = NULL;
-            TraceEvents(TRACE_LEVEL_ERROR, DMF_TRACE, "WdfMemoryCreate fails: ntStatus=%!STATUS!", ntStatus);
+            TraceEvents(TRACE_LEVEL_ERROR, DMF_TRACE, "ContinuousRequestTarget_RecycledRequestMemoryAssign fails: ntStatus=%!STATUS!", ntStatus);
             goto Exit;
         }
+        memoryForRequest = recycledRequestContext->MemoryForRequest;
     }
 
     memoryForResponse = NULL;
@@ -2238,16 +2602,16 @@ Return Value:
         // 'using uninitialized memory'
         //
         #pragma warning(suppress:6001)
-        ntStatus = WdfMemoryCreatePreallocated(&memoryAttributes,
-                                               ResponseBuffer,
-                                               ResponseLength,
-                                               &memoryForResponse);
+        ntStatus = ContinuousRequestTarget_RecycledRequestMemoryAssign(request,
+                                                                       &recycledRequestContext->MemoryForResponse,
+                                                                       ResponseBuffer,
+                                                                       ResponseLength);
         if (! NT_SUCCESS(ntStatus))
         {
-            memoryForResponse = NULL;
-            TraceEvents(TRACE_LEVEL_ERROR, DMF_TRACE, "WdfMemoryCreate for position fails: ntStatus=%!STATUS!", ntStatus);
+            TraceEvents(TRACE_LEVEL_ERROR, DMF_TRACE, "ContinuousRequestTarget_RecycledRequestMemoryAssign fails: ntStatus=%!STATUS!", ntStatus);
             goto Exit;
         }
+        memoryForResponse = recycledRequestContext->MemoryForResponse;
     }
 
     ntStatus = ContinuousRequestTarget_FormatRequestForRequestType(DmfModule,
@@ -2397,18 +2761,20 @@ Exit:
     if (IsSynchronousRequest && 
         request != NULL)
     {
-        // Delete the request if it is Synchronous.
+        // Recycle the request if it is Synchronous.
         //
-        WdfObjectDelete(request);
+        ContinuousRequestTarget_RecycledRequestPut(DmfModule,
+                                                   request);
         request = NULL;
     }
     else if (! IsSynchronousRequest && 
              ! NT_SUCCESS(ntStatus) && 
              request != NULL)
     {
-        // Delete the request if Asynchronous request failed.
+        // Recycle the request if Asynchronous request failed.
         //
-        WdfObjectDelete(request);
+        ContinuousRequestTarget_RecycledRequestPut(DmfModule,
+                                                   request);
         request = NULL;
     }
 
@@ -2984,6 +3350,18 @@ Return Value:
         moduleContext->CompletionRoutineStream = ContinuousRequestTarget_StreamCompletionRoutine;
     }
 
+    if (moduleConfig->EnableLatencyHistogram)
+    {
+        // LatencyHistogram
+        // ----------------
+        //
+        DMF_LatencyHistogram_ATTRIBUTES_INIT(&moduleAttributes);
+        DMF_DmfModuleAdd(DmfModuleInit,
+                         &moduleAttributes,
+                         WDF_NO_OBJECT_ATTRIBUTES,
+                         &moduleContext->DmfModuleLatencyHistogram);
+    }
+
     FuncExitVoid(DMF_TRACE);
 }
 #pragma code_seg()
@@ -3031,6 +3409,8 @@ Return Value:
     // 
     moduleContext->Stopping = TRUE;
 
+    InitializeListHead(&moduleContext->RecycledRequestList);
+
 #if !defined(DMF_USER_MODE)
     // Set as initialized in case Client never calls Start() because Close() waits for
     // this event to be set.
@@ -3096,7 +3476,8 @@ Return Value:
             WDF_OBJECT_ATTRIBUTES requestAttributes;
             WDFREQUEST request;
 
-            WDF_OBJECT_ATTRIBUTES_INIT(&requestAttributes);
+            WDF_OBJECT_ATTRIBUTES_INIT_CONTEXT_TYPE(&requestAttributes,
+                                                    ContinuousRequestTarget_StreamRequestContext);
             // The request is being parented to the device explicitly to handle deletion.
             // When a dynamic module tree is deleted, the child objects are deleted first before the parent.
             // So, if request is a child of this module and this module gets implicitly deleted, 
@@ -3246,6 +3627,9 @@ Return Value:
         WdfObjectDelete(moduleContext->PendingReuseRequests);
     }
 
+    ContinuousRequestTarget_RecycledRequestsFlush(DmfModule);
+    DmfAssert(0 == moduleContext->RequestsInUse);
+
     FuncExitVoid(DMF_TRACE);
 }
 #pragma code_seg()
@@ -3491,6 +3875,10 @@ Return Value:
 
     moduleContext->IoTarget = NULL;
 
+    // Recycled requests were created for the IoTarget that is cleared.
+    //
+    ContinuousRequestTarget_RecycledRequestsFlush(DmfModule);
+
     DMF_ModuleDereference(DmfModule);
 
 Exit:
@@ -3542,6 +3930,10 @@ Return Value:
 
     moduleContext->IoTarget = IoTarget;
 
+    // Recycled requests may have been created for a previous IoTarget.
+    //
+    ContinuousRequestTarget_RecycledRequestsFlush(DmfModule);
+
     DMF_ModuleDereference(DmfModule);
 
 Exit:
@@ -3551,6 +3943,102 @@ Exit:
     return ntStatus;
 }
 
+_IRQL_requires_max_(DISPATCH_LEVEL)
+_Must_inspect_result_
+NTSTATUS
+DMF_ContinuousRequestTarget_LatencyHistogramGet(
+    _In_ DMFMODULE DmfModule,
+    _Out_ LatencyHistogram_Snapshot* Snapshot,
+    _In_ BOOLEAN Reset
+    )
+/*++
+
+Routine Description:
+
+    Returns the histogram of the time from when stream requests are sent until their
+    completion is processed and, optionally, resets it.
+
+Arguments:
+
+    DmfModule - This Module's handle.
+    Snapshot - Returns the histogram.
+    Reset - TRUE to reset the histogram.
+
+Return Value:
+
+    STATUS_NOT_SUPPORTED if EnableLatencyHistogram is not set in the Module Config.
+
+--*/
+{
+    NTSTATUS ntStatus;
+    DMF_CONTEXT_ContinuousRequestTarget* moduleContext;
+
+    FuncEntry(DMF_TRACE);
+
+    DMFMODULE_VALIDATE_IN_METHOD(DmfModule,
+                                 ContinuousRequestTarget);
+
+    moduleContext = DMF_CONTEXT_GET(DmfModule);
+
+    if (NULL == moduleContext->DmfModuleLatencyHistogram)
+    {
+        RtlZeroMemory(Snapshot,
+                      sizeof(LatencyHistogram_Snapshot));
+        ntStatus = STATUS_NOT_SUPPORTED;
+        goto Exit;
+    }
+
+    ntStatus = DMF_LatencyHistogram_SnapshotGet(moduleContext->DmfModuleLatencyHistogram,
+                                                0,
+                                                Snapshot,
+                                                Reset);
+
+Exit:
+
+    FuncExit(DMF_TRACE, "ntStatus=%!STATUS!", ntStatus);
+
+    return ntStatus;
+}
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+VOID
+DMF_ContinuousRequestTarget_RequestPoolStatisticsGet(
+    _In_ DMFMODULE DmfModule,
+    _Out_ ContinuousRequestTarget_RequestPoolStatistics* RequestPoolStatistics
+    )
+/*++
+
+Routine Description:
+
+    Returns the statistics of the pool of recycled requests used by the single request Methods.
+
+Arguments:
+
+    DmfModule - This Module's handle.
+    RequestPoolStatistics - Returns the statistics.
+
+Return Value:
+
+    None
+
+--*/
+{
+    DMF_CONTEXT_ContinuousRequestTarget* moduleContext;
+
+    FuncEntry(DMF_TRACE);
+
+    DMFMODULE_VALIDATE_IN_METHOD(DmfModule,
+                                 ContinuousRequestTarget);
+
+    moduleContext = DMF_CONTEXT_GET(DmfModule);
+
+    DMF_ModuleLock(DmfModule);
+    *RequestPoolStatistics = moduleContext->RequestPoolStatistics;
+    DMF_ModuleUnlock(DmfModule);
+
+    FuncExitVoid(DMF_TRACE);
+}
+
 _IRQL_requires_max_(DISPATCH_LEVEL)
 _Must_inspect_result_
 NTSTATUS
@@ -70,6 +70,10 @@ EVT_DMF_ContinuousRequestTarget_BufferOutput(_In_ DMFMODULE DmfModule,
 //
 typedef EVT_DMF_RequestTarget_SendCompletion EVT_DMF_ContinuousRequestTarget_SendCompletion;
 
+// Statistics of the pool of WDFREQUESTs the single request Methods draw from.
+//
+typedef RequestTarget_RequestPoolStatistics ContinuousRequestTarget_RequestPoolStatistics;
+
 typedef enum
 {
     // EVT_DMF_ContinuousRequestTarget_SendCompletion will be called at dispatch level.
@@ -159,6 +163,10 @@ typedef struct
     // Indicates the mode of ContinuousRequestTarget.
     //
     ContinuousRequestTarget_ModeType ContinuousRequestTargetMode;
+    // Keep a histogram of the time from when stream requests are sent until their
+    // completion is processed. Use DMF_ContinuousRequestTarget_LatencyHistogramGet() to retrieve it.
+    //
+    BOOLEAN EnableLatencyHistogram;
 } DMF_CONFIG_ContinuousRequestTarget;
 
 // This macro declares the following functions:
@@ -200,6 +208,22 @@ DMF_ContinuousRequestTarget_IoTargetSet(
     _In_ WDFIOTARGET IoTarget
     );
 
+_IRQL_requires_max_(DISPATCH_LEVEL)
+_Must_inspect_result_
+NTSTATUS
+DMF_ContinuousRequestTarget_LatencyHistogramGet(
+    _In_ DMFMODULE DmfModule,
+    _Out_ LatencyHistogram_Snapshot* Snapshot,
+    _In_ BOOLEAN Reset
+    );
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+VOID
+DMF_ContinuousRequestTarget_RequestPoolStatisticsGet(
+    _In_ DMFMODULE DmfModule,
+    _Out_ ContinuousRequestTarget_RequestPoolStatistics* RequestPoolStatistics
+    );
+
 _IRQL_requires_max_(DISPATCH_LEVEL)
 _Must_inspect_result_
 NTSTATUS
@@ -60,6 +60,18 @@ typedef struct
     // This is the internally managed WorkItem.
     //
     WDFWORKITEM WorkItem;
+
+    // Number of times the doorbell has been rung since the callback was last called.
+    //
+    ULONG RingCount;
+
+    // Used to defer the next callback when the Client sets MinimumIntervalMs.
+    //
+    WDFTIMER Timer;
+
+    // Prevents the timer from being restarted while the Module closes.
+    //
+    BOOLEAN Closing;
 } DMF_CONTEXT_Doorbell;
 
 // This macro declares the following function:
@@ -78,29 +90,30 @@ DMF_MODULE_DECLARE_CONFIG(Doorbell)
 //
 
 EVT_WDF_WORKITEM Doorbell_WorkItemHandler;
+EVT_WDF_TIMER Doorbell_TimerHandler;
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////////
 // DMF Module Support Code
 ///////////////////////////////////////////////////////////////////////////////////////////////////////
 //
 
-_Function_class_(EVT_WDF_WORKITEM)
-_IRQL_requires_same_
 _IRQL_requires_max_(PASSIVE_LEVEL)
+static
 VOID
-Doorbell_WorkItemHandler(
-    _In_ WDFWORKITEM WorkItem
+Doorbell_CallbacksRun(
+    _In_ DMFMODULE DmfModule
     )
 /*++
 
 Routine Description:
 
-    WorkItem handler.
+    Call the Client's callback until there are no more rings. If the Client
+    set a minimum interval, call it once and start the timer so that rings
+    which arrive in the meantime are handled together when it expires.
 
 Arguments:
 
-    WorkItem - WDFORKITEM which gives access to necessary context including this
-               Module's DMF Module.
+    DmfModule - This Module's handle.
 
 Return Value:
 
@@ -108,29 +121,49 @@ Return Value:
 
 --*/
 {
-    DMFMODULE dmfModule;
     DMF_CONFIG_Doorbell* moduleConfig;
     DMF_CONTEXT_Doorbell* moduleContext;
+    ULONG ringCount;
 
-    FuncEntry(DMF_TRACE);
-
-    dmfModule = (DMFMODULE)WdfWorkItemGetParentObject(WorkItem);
-    moduleConfig = DMF_CONFIG_GET(dmfModule);
-    moduleContext = DMF_CONTEXT_GET(dmfModule);
+    moduleConfig = DMF_CONFIG_GET(DmfModule);
+    moduleContext = DMF_CONTEXT_GET(DmfModule);
 
-    DMF_ModuleLock(dmfModule);
+    DMF_ModuleLock(DmfModule);
 
     while (1)
     {
         moduleContext->TrackDoorbellRing = FALSE;
+        ringCount = moduleContext->RingCount;
+        moduleContext->RingCount = 0;
 
-        DMF_ModuleUnlock(dmfModule);
+        DMF_ModuleUnlock(DmfModule);
 
-        // dmfModule is the DMF_Doorbell Module handle.
+        // DmfModule is the DMF_Doorbell Module handle.
         //
-        moduleConfig->WorkItemCallback(dmfModule);
+        if (moduleConfig->WorkItemCallbackWithRingCount != NULL)
+        {
+            moduleConfig->WorkItemCallbackWithRingCount(DmfModule,
+                                                        ringCount);
+        }
+        else
+        {
+            moduleConfig->WorkItemCallback(DmfModule);
+        }
+
+        DMF_ModuleLock(DmfModule);
 
-        DMF_ModuleLock(dmfModule);
+        if ((moduleContext->Timer != NULL) &&
+            (! moduleContext->Closing))
+        {
+            // Remain scheduled until the interval expires. Rings that arrive
+            // before then are handled by the timer.
+            // NOTE: The timer is started while the lock is held so that it cannot
+            //       be started after Close sets Closing and stops the timer.
+            //
+            WdfTimerStart(moduleContext->Timer,
+                          WDF_REL_TIMEOUT_IN_MS(moduleConfig->MinimumIntervalMs));
+            break;
+        }
 
         if (moduleContext->TrackDoorbellRing)
         {
@@ -143,10 +176,128 @@ Return Value:
         // handle any more doorbells, thus set WorkItemScheduled to FALSE.
         //
         moduleContext->WorkItemScheduled = FALSE;
-        DMF_ModuleUnlock(dmfModule);
         break;
     }
 
+    DMF_ModuleUnlock(DmfModule);
+}
+
+_IRQL_requires_max_(PASSIVE_LEVEL)
+static
+VOID
+Doorbell_IntervalExpire(
+    _In_ DMFMODULE DmfModule
+    )
+/*++
+
+Routine Description:
+
+    Called when the minimum interval after a callback expires. Calls the Client's
+    callback if the doorbell was rung during the interval. Otherwise, the next ring
+    enqueues the workitem again.
+
+Arguments:
+
+    DmfModule - This Module's handle.
+
+Return Value:
+
+    VOID
+
+--*/
+{
+    DMF_CONTEXT_Doorbell* moduleContext;
+    BOOLEAN runCallbacks;
+
+    moduleContext = DMF_CONTEXT_GET(DmfModule);
+
+    runCallbacks = FALSE;
+
+    DMF_ModuleLock(DmfModule);
+
+    if (moduleContext->TrackDoorbellRing)
+    {
+        runCallbacks = TRUE;
+    }
+    else
+    {
+        moduleContext->WorkItemScheduled = FALSE;
+    }
+
+    DMF_ModuleUnlock(DmfModule);
+
+    if (runCallbacks)
+    {
+        Doorbell_CallbacksRun(DmfModule);
+    }
+}
+
+_Function_class_(EVT_WDF_WORKITEM)
+_IRQL_requires_same_
+_IRQL_requires_max_(PASSIVE_LEVEL)
+VOID
+Doorbell_WorkItemHandler(
+    _In_ WDFWORKITEM WorkItem
+    )
+/*++
+
+Routine Description:
+
+    WorkItem handler.
+
+Arguments:
+
+    WorkItem - WDFORKITEM which gives access to necessary context including this
+               Module's DMF Module.
+
+Return Value:
+
+    VOID
+
+--*/
+{
+    DMFMODULE dmfModule;
+
+    FuncEntry(DMF_TRACE);
+
+    dmfModule = (DMFMODULE)WdfWorkItemGetParentObject(WorkItem);
+
+    Doorbell_CallbacksRun(dmfModule);
+
+    FuncExitVoid(DMF_TRACE);
+}
+
+_Function_class_(EVT_WDF_TIMER)
+_IRQL_requires_same_
+_IRQL_requires_max_(PASSIVE_LEVEL)
+VOID
+Doorbell_TimerHandler(
+    _In_ WDFTIMER WdfTimer
+    )
+/*++
+
+Routine Description:
+
+    Timer handler. Called at PASSIVE_LEVEL when the minimum interval expires.
+
+Arguments:
+
+    WdfTimer - WDFTIMER which gives access to this Module's DMF Module.
+
+Return Value:
+
+    VOID
+
+--*/
+{
+    DMFMODULE dmfModule;
+
+    FuncEntry(DMF_TRACE);
+
+    dmfModule = (DMFMODULE)WdfTimerGetParentObject(WdfTimer);
+
+    Doorbell_IntervalExpire(dmfModule);
+
     FuncExitVoid(DMF_TRACE);
 }
 
@@ -187,8 +338,11 @@ Return Value:
 {
     NTSTATUS ntStatus;
     DMF_CONTEXT_Doorbell *moduleContext;
+    DMF_CONFIG_Doorbell* moduleConfig;
     WDF_WORKITEM_CONFIG workItemConfiguration;
     WDF_OBJECT_ATTRIBUTES workItemAttributes;
+    WDF_TIMER_CONFIG timerConfig;
+    WDF_OBJECT_ATTRIBUTES timerAttributes;
 
     PAGED_CODE();
 
@@ -197,6 +351,13 @@ Return Value:
     TraceEvents(TRACE_LEVEL_INFORMATION, DMF_TRACE, "Module Opening");
 
     moduleContext = DMF_CONTEXT_GET(DmfModule);
+    moduleConfig = DMF_CONFIG_GET(DmfModule);
+
+    DmfAssert((moduleConfig->WorkItemCallback != NULL) ||
+              (moduleConfig->WorkItemCallbackWithRingCount != NULL));
+
+    moduleContext->RingCount = 0;
+    moduleContext->Closing = FALSE;
 
     // Create the Passive Level WorkItem.
     //
@@ -216,6 +377,30 @@ Return Value:
         goto Exit;
     }
 
+    if (moduleConfig->MinimumIntervalMs > 0)
+    {
+        // Create the Passive Level Timer that enforces the minimum interval between callbacks.
+        //
+        WDF_TIMER_CONFIG_INIT(&timerConfig,
+                              Doorbell_TimerHandler);
+        timerConfig.AutomaticSerialization = WdfFalse;
+
+        WDF_OBJECT_ATTRIBUTES_INIT(&timerAttributes);
+        timerAttributes.ParentObject = DmfModule;
+        timerAttributes.ExecutionLevel = WdfExecutionLevelPassive;
+
+        ntStatus = WdfTimerCreate(&timerConfig,
+                                  &timerAttributes,
+                                  &moduleContext->Timer);
+        if (!NT_SUCCESS(ntStatus))
+        {
+            TraceEvents(TRACE_LEVEL_ERROR, DMF_TRACE, "WdfTimerCreate fails: ntStatus=%!STATUS!", ntStatus);
+            WdfObjectDelete(moduleContext->WorkItem);
+            moduleContext->WorkItem = NULL;
+            goto Exit;
+        }
+    }
+
     FuncExit(DMF_TRACE, "ntStatus=%!STATUS!", ntStatus);
 
 Exit:
@@ -257,12 +442,33 @@ Return Value:
 
     moduleContext = DMF_CONTEXT_GET(DmfModule);
 
+    // Prevent the workitem and the timer from restarting the timer.
+    //
+    DMF_ModuleLock(DmfModule);
+    moduleContext->Closing = TRUE;
+    DMF_ModuleUnlock(DmfModule);
+
     // Wait for pending work to finish.
     //
     WdfWorkItemFlush(moduleContext->WorkItem);
+
+    if (moduleContext->Timer != NULL)
+    {
+        // Now that nothing can start the timer, wait for it.
+        //
+        WdfTimerStop(moduleContext->Timer,
+                     TRUE);
+    }
+
     WdfObjectDelete(moduleContext->WorkItem);
     moduleContext->WorkItem = NULL;
 
+    if (moduleContext->Timer != NULL)
+    {
+        WdfObjectDelete(moduleContext->Timer);
+        moduleContext->Timer = NULL;
+    }
+
     FuncExitVoid(DMF_TRACE);
 }
 #pragma code_seg()
@@ -371,6 +577,18 @@ Return Value:
     //
     WdfWorkItemFlush(moduleContext->WorkItem);
 
+    if (moduleContext->Timer != NULL)
+    {
+        // If the interval has not expired yet, expire it now so that rings
+        // received during the interval are not delayed.
+        //
+        if (WdfTimerStop(moduleContext->Timer,
+                         TRUE))
+        {
+            Doorbell_IntervalExpire(DmfModule);
+        }
+    }
+
     FuncExitVoid(DMF_TRACE);
 }
 #pragma code_seg()
@@ -405,6 +623,10 @@ Return Value:
 
     DMF_ModuleLock(DmfModule);
 
+    // NOTE: When the Client sets MinimumIntervalMs, WorkItemScheduled remains set until
+    //       the interval after the last callback expires. Rings during the interval are
+    //       handled by the timer.
+    //
     if (moduleContext->WorkItemScheduled == FALSE)
     {
         enqueueWorkItem = TRUE;
@@ -412,6 +634,7 @@ Return Value:
 
     moduleContext->TrackDoorbellRing = TRUE;
     moduleContext->WorkItemScheduled = TRUE;
+    moduleContext->RingCount++;
 
     DMF_ModuleUnlock(DmfModule);
 
@@ -27,6 +27,16 @@ EVT_DMF_Doorbell_ClientCallback(
     _In_ DMFMODULE DmfModule
     );
 
+typedef
+_Function_class_(EVT_DMF_Doorbell_ClientCallbackWithRingCount)
+_IRQL_requires_max_(PASSIVE_LEVEL)
+_IRQL_requires_same_
+VOID
+EVT_DMF_Doorbell_ClientCallbackWithRingCount(
+    _In_ DMFMODULE DmfModule,
+    _In_ ULONG RingCount
+    );
+
 // Client uses this structure to configure the Module specific parameters.
 //
 typedef struct
@@ -34,6 +44,14 @@ typedef struct
     // Callback called when the doorbell is rung.
     //
     EVT_DMF_Doorbell_ClientCallback* WorkItemCallback;
+    // Optional callback called instead of WorkItemCallback which also receives
+    // the number of rings handled by the call.
+    //
+    EVT_DMF_Doorbell_ClientCallbackWithRingCount* WorkItemCallbackWithRingCount;
+    // Optional minimum time in milliseconds between the end of a callback and the
+    // start of the next one. Rings during this time are handled by a single callback.
+    //
+    ULONG MinimumIntervalMs;
 } DMF_CONFIG_Doorbell;
 
 DECLARE_DMF_MODULE(Doorbell)
@@ -33,6 +33,55 @@ Environment:
 ///////////////////////////////////////////////////////////////////////////////////////////////////////
 //
 
+// LZNT1 compresses data in independent chunks. Each compressed chunk starts with a USHORT header
+// and decompresses to at most this many bytes.
+//
+#define File_Lznt1ChunkSize                 (4096)
+#define File_Lznt1ChunkHeaderSize           (sizeof(USHORT))
+// The low 12 bits of the header contain the number of bytes that follow the header, minus one.
+//
+#define File_Lznt1ChunkDataSizeMask         (0x0FFF)
+// The low byte of the compression format selects the format. The high byte selects the engine.
+//
+#define File_CompressionFormatMask          (0x00FF)
+
+// State of a file opened using DMF_File_ReaderOpen().
+//
+struct _File_Reader
+{
+    // Memory that holds this structure.
+    //
+    WDFMEMORY ReaderMemory;
+    // Handle of the open file.
+    //
+    HANDLE FileHandle;
+    // Size of the file in bytes.
+    //
+    LONGLONG FileSize;
+    // Offset in the file where the next chunk is read from.
+    //
+    LONGLONG FileOffset;
+    // Buffer that holds the current chunk.
+    //
+    WDFMEMORY ChunkMemory;
+    UCHAR* ChunkBuffer;
+    ULONG ChunkBufferSize;
+    // Number of bytes in ChunkBuffer and number of those bytes already consumed.
+    //
+    ULONG ChunkDataSize;
+    ULONG ChunkDataOffset;
+    // Read-only view of the file created by DMF_File_ReaderMap().
+    //
+    HANDLE SectionHandle;
+    VOID* View;
+    size_t ViewSize;
+    // Referenced section object. The view is mapped in system space so that it is
+    // valid in any process context.
+    // (Kernel-mode only.)
+    //
+    VOID* SectionObject;
+};
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////////
 // Module Private Context
 ///////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -65,6 +114,328 @@ typedef NTSTATUS
     );
 #endif
 
+#pragma code_seg("PAGE")
+_IRQL_requires_max_(PASSIVE_LEVEL)
+_Must_inspect_result_
+static
+NTSTATUS
+File_ReaderChunkFill(
+    _Inout_ File_Reader* FileReader
+    )
+/*++
+
+Routine Description:
+
+    Reads the next chunk of the file into the given reader's chunk buffer.
+
+Arguments:
+
+    FileReader - The given reader.
+
+Return Value:
+
+    STATUS_END_OF_FILE if the whole file has been read.
+    Otherwise, NTSTATUS of the read.
+
+--*/
+{
+    NTSTATUS ntStatus;
+    ULONG sizeOfOneRead;
+    ULONG numberOfBytesRead;
+#if defined(DMF_USER_MODE)
+    DWORD bytesRead;
+#elif defined(DMF_KERNEL_MODE)
+    IO_STATUS_BLOCK ioStatusBlock;
+    LARGE_INTEGER byteOffset;
+#endif
+
+    PAGED_CODE();
+
+    FileReader->ChunkDataSize = 0;
+    FileReader->ChunkDataOffset = 0;
+
+    if (FileReader->FileOffset >= FileReader->FileSize)
+    {
+        ntStatus = STATUS_END_OF_FILE;
+        goto Exit;
+    }
+
+    sizeOfOneRead = FileReader->ChunkBufferSize;
+    if (FileReader->FileSize - FileReader->FileOffset < (LONGLONG)sizeOfOneRead)
+    {
+        sizeOfOneRead = (ULONG)(FileReader->FileSize - FileReader->FileOffset);
+    }
+
+#if defined(DMF_USER_MODE)
+    // The file is read sequentially so the file pointer is always at FileOffset.
+    //
+    if (! ReadFile(FileReader->FileHandle,
+                   FileReader->ChunkBuffer,
+                   sizeOfOneRead,
+                   &bytesRead,
+                   NULL))
+    {
+        ntStatus = NTSTATUS_FROM_WIN32(GetLastError());
+        TraceEvents(TRACE_LEVEL_ERROR, DMF_TRACE, "ReadFile fails: ntStatus=%!STATUS!", ntStatus);
+        goto Exit;
+    }
+    numberOfBytesRead = bytesRead;
+#elif defined(DMF_KERNEL_MODE)
+    byteOffset.QuadPart = FileReader->FileOffset;
+    ntStatus = ZwReadFile(FileReader->FileHandle,
+                          NULL,
+                          NULL,
+                          NULL,
+                          &ioStatusBlock,
+                          FileReader->ChunkBuffer,
+                          sizeOfOneRead,
+                          &byteOffset,
+                          NULL);
+    if (! NT_SUCCESS(ntStatus))
+    {
+        TraceEvents(TRACE_LEVEL_ERROR, DMF_TRACE, "ZwReadFile fails: ntStatus=%!STATUS!", ntStatus);
+        goto Exit;
+    }
+    numberOfBytesRead = (ULONG)ioStatusBlock.Information;
+#endif
+
+    if (0 == numberOfBytesRead)
+    {
+        // The file has been truncated since it was opened.
+        //
+        ntStatus = STATUS_END_OF_FILE;
+        goto Exit;
+    }
+
+    FileReader->ChunkDataSize = numberOfBytesRead;
+    FileReader->FileOffset += numberOfBytesRead;
+    ntStatus = STATUS_SUCCESS;
+
+Exit:
+
+    return ntStatus;
+}
+#pragma code_seg()
+
+#pragma code_seg("PAGE")
+_IRQL_requires_max_(PASSIVE_LEVEL)
+_Must_inspect_result_
+static
+NTSTATUS
+File_ReaderBytesCopy(
+    _Inout_ File_Reader* FileReader,
+    _Out_writes_bytes_to_(BytesToCopy, *BytesCopied) UCHAR* Destination,
+    _In_ ULONG BytesToCopy,
+    _Out_ ULONG* BytesCopied
+    )
+/*++
+
+Routine Description:
+
+    Copies the next bytes of the file to the given buffer. Chunks are read as needed so
+    that the file is still read using large reads even when the Client consumes small pieces.
+
+Arguments:
+
+    FileReader - The given reader.
+    Destination - Where the bytes are copied.
+    BytesToCopy - Number of bytes to copy.
+    BytesCopied - Number of bytes copied. It is less than BytesToCopy at the end of the file.
+
+Return Value:
+
+    STATUS_END_OF_FILE if the end of the file was reached before BytesToCopy bytes were copied.
+    Otherwise, NTSTATUS of the reads.
+
+--*/
+{
+    NTSTATUS ntStatus;
+
+    PAGED_CODE();
+
+    ntStatus = STATUS_SUCCESS;
+    *BytesCopied = 0;
+
+    while (*BytesCopied < BytesToCopy)
+    {
+        ULONG bytesToCopyFromChunk;
+
+        if (FileReader->ChunkDataOffset == FileReader->ChunkDataSize)
+        {
+            ntStatus = File_ReaderChunkFill(FileReader);
+            if (! NT_SUCCESS(ntStatus))
+            {
+                break;
+            }
+        }
+
+        bytesToCopyFromChunk = FileReader->ChunkDataSize - FileReader->ChunkDataOffset;
+        if (bytesToCopyFromChunk > BytesToCopy - *BytesCopied)
+        {
+            bytesToCopyFromChunk = BytesToCopy - *BytesCopied;
+        }
+
+        RtlCopyMemory(&Destination[*BytesCopied],
+                      &FileReader->ChunkBuffer[FileReader->ChunkDataOffset],
+                      bytesToCopyFromChunk);
+        FileReader->ChunkDataOffset += bytesToCopyFromChunk;
+        *BytesCopied += bytesToCopyFromChunk;
+    }
+
+    return ntStatus;
+}
+#pragma code_seg()
+
+#pragma code_seg("PAGE")
+_IRQL_requires_max_(PASSIVE_LEVEL)
+_Must_inspect_result_
+static
+NTSTATUS
+File_ReaderViewCreate(
+    _Inout_ File_Reader* FileReader
+    )
+/*++
+
+Routine Description:
+
+    Creates a read-only view of the whole file associated with the given reader.
+
+Arguments:
+
+    FileReader - The given reader.
+
+Return Value:
+
+    NTSTATUS
+
+--*/
+{
+    NTSTATUS ntStatus;
+#if defined(DMF_KERNEL_MODE)
+    OBJECT_ATTRIBUTES sectionAttributes;
+    SIZE_T viewSize;
+#endif
+
+    PAGED_CODE();
+
+    if (0 == FileReader->FileSize)
+    {
+        // Empty files cannot be mapped.
+        //
+        ntStatus = STATUS_MAPPED_FILE_SIZE_ZERO;
+        goto Exit;
+    }
+
+    if ((ULONGLONG)FileReader->FileSize > (ULONGLONG)((size_t)-1))
+    {
+        ntStatus = STATUS_FILE_TOO_LARGE;
+        goto Exit;
+    }
+
+#if defined(DMF_USER_MODE)
+    FileReader->SectionHandle = CreateFileMapping(FileReader->FileHandle,
+                                                  NULL,
+                                                  PAGE_READONLY,
+                                                  0,
+                                                  0,
+                                                  NULL);
+    if (NULL == FileReader->SectionHandle)
+    {
+        ntStatus = NTSTATUS_FROM_WIN32(GetLastError());
+        TraceEvents(TRACE_LEVEL_ERROR, DMF_TRACE, "CreateFileMapping fails: ntStatus=%!STATUS!", ntStatus);
+        goto Exit;
+    }
+
+    FileReader->View = MapViewOfFile(FileReader->SectionHandle,
+                                     FILE_MAP_READ,
+                                     0,
+                                     0,
+                                     0);
+    if (NULL == FileReader->View)
+    {
+        ntStatus = NTSTATUS_FROM_WIN32(GetLastError());
+        TraceEvents(TRACE_LEVEL_ERROR, DMF_TRACE, "MapViewOfFile fails: ntStatus=%!STATUS!", ntStatus);
+        goto Exit;
+    }
+#elif defined(DMF_KERNEL_MODE)
+    InitializeObjectAttributes(&sectionAttributes,
+                               NULL,
+                               OBJ_KERNEL_HANDLE,
+                               NULL,
+                               NULL);
+    ntStatus = ZwCreateSection(&FileReader->SectionHandle,
+                               SECTION_MAP_READ | SECTION_QUERY,
+                               &sectionAttributes,
+                               NULL,
+                               PAGE_READONLY,
+                               SEC_COMMIT,
+                               FileReader->FileHandle);
+    if (! NT_SUCCESS(ntStatus))
+    {
+        FileReader->SectionHandle = NULL;
+        TraceEvents(TRACE_LEVEL_ERROR, DMF_TRACE, "ZwCreateSection fails: ntStatus=%!STATUS!", ntStatus);
+        goto Exit;
+    }
+
+    // Map the view in system space (instead of in the address space of the current process) so that
+    // it can be used from any thread and cannot be changed or unmapped by a user-mode process.
+    //
+    ntStatus = ObReferenceObjectByHandle(FileReader->SectionHandle,
+                                         SECTION_MAP_READ,
+                                         NULL,
+                                         KernelMode,
+                                         &FileReader->SectionObject,
+                                         NULL);
+    if (! NT_SUCCESS(ntStatus))
+    {
+        FileReader->SectionObject = NULL;
+        TraceEvents(TRACE_LEVEL_ERROR, DMF_TRACE, "ObReferenceObjectByHandle fails: ntStatus=%!STATUS!", ntStatus);
+        goto Exit;
+    }
+
+    viewSize = 0;
+    ntStatus = MmMapViewInSystemSpace(FileReader->SectionObject,
+                                      &FileReader->View,
+                                      &viewSize);
+    if (! NT_SUCCESS(ntStatus))
+    {
+        FileReader->View = NULL;
+        TraceEvents(TRACE_LEVEL_ERROR, DMF_TRACE, "MmMapViewInSystemSpace fails: ntStatus=%!STATUS!", ntStatus);
+        goto Exit;
+    }
+#endif
+
+    // The view is rounded up to a whole page. Only the file's contents are returned.
+    //
+    FileReader->ViewSize = (size_t)FileReader->FileSize;
+    ntStatus = STATUS_SUCCESS;
+
+Exit:
+
+#if defined(DMF_KERNEL_MODE)
+    if ((! NT_SUCCESS(ntStatus)) &&
+        (FileReader->SectionObject != NULL))
+    {
+        ObDereferenceObject(FileReader->SectionObject);
+        FileReader->SectionObject = NULL;
+    }
+#endif
+
+    if ((! NT_SUCCESS(ntStatus)) &&
+        (FileReader->SectionHandle != NULL))
+    {
+#if defined(DMF_USER_MODE)
+        CloseHandle(FileReader->SectionHandle);
+#elif defined(DMF_KERNEL_MODE)
+        ZwClose(FileReader->SectionHandle);
+#endif
+        FileReader->SectionHandle = NULL;
+    }
+
+    return ntStatus;
+}
+#pragma code_seg()
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////////
 // WDF Module Callbacks
 ///////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -842,6 +1213,586 @@ Exit:
 }
 #pragma code_seg()
 
+#pragma code_seg("PAGE")
+_IRQL_requires_max_(PASSIVE_LEVEL)
+_Must_inspect_result_
+NTSTATUS
+DMF_File_ReaderChunkRead(
+    _In_opt_ DMFMODULE DmfModule,
+    _In_ File_Reader* FileReader,
+    _Outptr_result_bytebuffer_(*ChunkSize) UCHAR** Chunk,
+    _Out_ ULONG* ChunkSize
+    )
+/*++
+
+Routine Description:
+
+    Returns the next chunk of a file opened using DMF_File_ReaderOpen(). The chunk is in a buffer
+    that belongs to the reader so that arbitrarily large files are read using bounded memory.
+
+Arguments:
+
+    DmfModule - This Module's handle.
+    FileReader - The reader returned by DMF_File_ReaderOpen().
+    Chunk - Where the address of the chunk is written. It is valid until the next call that uses FileReader.
+    ChunkSize - Where the size of the chunk is written.
+
+Return Value:
+
+    STATUS_END_OF_FILE if the whole file has been read.
+    Otherwise, NTSTATUS
+
+--*/
+{
+    NTSTATUS ntStatus;
+
+    PAGED_CODE();
+
+    FuncEntry(DMF_TRACE);
+
+    DMFMODULE_VALIDATE_IN_METHOD_OPTIONAL(DmfModule,
+                                          File);
+
+    *Chunk = NULL;
+    *ChunkSize = 0;
+
+    if (FileReader->ChunkDataOffset == FileReader->ChunkDataSize)
+    {
+        ntStatus = File_ReaderChunkFill(FileReader);
+        if (! NT_SUCCESS(ntStatus))
+        {
+            goto Exit;
+        }
+    }
+
+    // Return the part of the chunk that has not been consumed yet.
+    //
+    *Chunk = &FileReader->ChunkBuffer[FileReader->ChunkDataOffset];
+    *ChunkSize = FileReader->ChunkDataSize - FileReader->ChunkDataOffset;
+    FileReader->ChunkDataOffset = FileReader->ChunkDataSize;
+    ntStatus = STATUS_SUCCESS;
+
+Exit:
+
+    FuncExit(DMF_TRACE, "ntStatus=%!STATUS!", ntStatus);
+
+    return ntStatus;
+}
+#pragma code_seg()
+
+#pragma code_seg("PAGE")
+_IRQL_requires_max_(PASSIVE_LEVEL)
+VOID
+DMF_File_ReaderClose(
+    _In_opt_ DMFMODULE DmfModule,
+    _In_ File_Reader* FileReader
+    )
+/*++
+
+Routine Description:
+
+    Closes a file opened using DMF_File_ReaderOpen() and frees all the resources associated with it,
+    including its chunk buffer and its mapped view.
+
+Arguments:
+
+    DmfModule - This Module's handle.
+    FileReader - The reader returned by DMF_File_ReaderOpen().
+
+Return Value:
+
+    None
+
+--*/
+{
+    PAGED_CODE();
+
+    FuncEntry(DMF_TRACE);
+
+    DMFMODULE_VALIDATE_IN_METHOD_OPTIONAL(DmfModule,
+                                          File);
+
+#if defined(DMF_USER_MODE)
+    if (FileReader->View != NULL)
+    {
+        UnmapViewOfFile(FileReader->View);
+        FileReader->View = NULL;
+    }
+    if (FileReader->SectionHandle != NULL)
+    {
+        CloseHandle(FileReader->SectionHandle);
+        FileReader->SectionHandle = NULL;
+    }
+    if (FileReader->FileHandle != NULL)
+    {
+        CloseHandle(FileReader->FileHandle);
+        FileReader->FileHandle = NULL;
+    }
+#elif defined(DMF_KERNEL_MODE)
+    if (FileReader->View != NULL)
+    {
+        MmUnmapViewInSystemSpace(FileReader->View);
+        FileReader->View = NULL;
+    }
+    if (FileReader->SectionObject != NULL)
+    {
+        ObDereferenceObject(FileReader->SectionObject);
+        FileReader->SectionObject = NULL;
+    }
+    if (FileReader->SectionHandle != NULL)
+    {
+        ZwClose(FileReader->SectionHandle);
+        FileReader->SectionHandle = NULL;
+    }
+    if (FileReader->FileHandle != NULL)
+    {
+        ZwClose(FileReader->FileHandle);
+        FileReader->FileHandle = NULL;
+    }
+#endif
+
+    // This also deletes the chunk buffer.
+    //
+    WdfObjectDelete(FileReader->ReaderMemory);
+
+    FuncExitVoid(DMF_TRACE);
+}
+#pragma code_seg()
+
+#pragma code_seg("PAGE")
+_IRQL_requires_max_(PASSIVE_LEVEL)
+_Must_inspect_result_
+NTSTATUS
+DMF_File_ReaderDecompress(
+    _In_opt_ DMFMODULE DmfModule,
+    _In_ File_Reader* FileReader,
+    _In_ USHORT CompressionFormat,
+    _In_ EVT_DMF_File_DecompressedDataProcess* DecompressedDataProcess,
+    _In_opt_ VOID* ClientContext
+    )
+/*++
+
+Routine Description:
+
+    Decompresses the rest of a file opened using DMF_File_ReaderOpen() one compressed chunk at a time
+    and passes each piece of decompressed data to the Client. Neither the whole compressed file nor
+    the whole decompressed data is ever in memory.
+
+Arguments:
+
+    DmfModule - This Module's handle.
+    FileReader - The reader returned by DMF_File_ReaderOpen().
+    CompressionFormat - Compression format of the file. Only COMPRESSION_FORMAT_LZNT1 is supported.
+    DecompressedDataProcess - Client callback that receives the decompressed data.
+    ClientContext - Client context passed to DecompressedDataProcess.
+
+Return Value:
+
+    NTSTATUS
+
+--*/
+{
+    NTSTATUS ntStatus;
+    WDF_OBJECT_ATTRIBUTES objectAttributes;
+    WDFMEMORY decompressMemory;
+    UCHAR* compressedChunk;
+    UCHAR* uncompressedChunk;
+    USHORT chunkHeader;
+    ULONG compressedDataSize;
+    ULONG bytesCopied;
+    ULONG finalUncompressedSize;
+    BOOLEAN endOfData;
+
+    PAGED_CODE();
+
+    FuncEntry(DMF_TRACE);
+
+    DMFMODULE_VALIDATE_IN_METHOD_OPTIONAL(DmfModule,
+                                          File);
+
+    decompressMemory = NULL;
+
+    // Only LZNT1 stores independent chunks that can be decompressed one at a time.
+    //
+    if ((CompressionFormat & File_CompressionFormatMask) != COMPRESSION_FORMAT_LZNT1)
+    {
+        ntStatus = STATUS_NOT_SUPPORTED;
+        TraceEvents(TRACE_LEVEL_ERROR, DMF_TRACE, "CompressionFormat=0x%04X not supported", CompressionFormat);
+        goto Exit;
+    }
+
+    // One buffer holds the compressed chunk (with its header) followed by the decompressed chunk.
+    //
+    WDF_OBJECT_ATTRIBUTES_INIT(&objectAttributes);
+    objectAttributes.ParentObject = FileReader->ReaderMemory;
+    ntStatus = WdfMemoryCreate(&objectAttributes,
+                               PagedPool,
+                               MemoryTag,
+                               File_Lznt1ChunkHeaderSize + File_Lznt1ChunkSize + File_Lznt1ChunkSize,
+                               &decompressMemory,
+                               (VOID**)&compressedChunk);
+    if (! NT_SUCCESS(ntStatus))
+    {
+        decompressMemory = NULL;
+        TraceEvents(TRACE_LEVEL_ERROR, DMF_TRACE, "WdfMemoryCreate fails: ntStatus=%!STATUS!", ntStatus);
+        goto Exit;
+    }
+    uncompressedChunk = &compressedChunk[File_Lznt1ChunkHeaderSize + File_Lznt1ChunkSize];
+
+    endOfData = FALSE;
+    while (! endOfData)
+    {
+        ntStatus = File_ReaderBytesCopy(FileReader,
+                                        compressedChunk,
+                                        File_Lznt1ChunkHeaderSize,
+                                        &bytesCopied);
+        if ((STATUS_END_OF_FILE == ntStatus) &&
+            (0 == bytesCopied))
+        {
+            // The compressed data ends at the end of the file.
+            //
+            ntStatus = STATUS_SUCCESS;
+            break;
+        }
+        if (! NT_SUCCESS(ntStatus))
+        {
+            goto Exit;
+        }
+
+        chunkHeader = *((USHORT UNALIGNED*)compressedChunk);
+        if (0 == chunkHeader)
+        {
+            // The compressed data ends before the end of the file.
+            //
+            endOfData = TRUE;
+            continue;
+        }
+
+        compressedDataSize = (chunkHeader & File_Lznt1ChunkDataSizeMask) + 1;
+        ntStatus = File_ReaderBytesCopy(FileReader,
+                                        &compressedChunk[File_Lznt1ChunkHeaderSize],
+                                        compressedDataSize,
+                                        &bytesCopied);
+        if (STATUS_END_OF_FILE == ntStatus)
+        {
+            ntStatus = STATUS_BAD_COMPRESSION_BUFFER;
+        }
+        if (! NT_SUCCESS(ntStatus))
+        {
+            TraceEvents(TRACE_LEVEL_ERROR, DMF_TRACE, "Compressed chunk truncated: ntStatus=%!STATUS!", ntStatus);
+            goto Exit;
+        }
+
+        ntStatus = DMF_File_BufferDecompress(DmfModule,
+                                             CompressionFormat,
+                                             uncompressedChunk,
+                                             File_Lznt1ChunkSize,
+                                             compressedChunk,
+                                             File_Lznt1ChunkHeaderSize + compressedDataSize,
+                                             &finalUncompressedSize);
+        if (! NT_SUCCESS(ntStatus))
+        {
+            TraceEvents(TRACE_LEVEL_ERROR, DMF_TRACE, "DMF_File_BufferDecompress fails: ntStatus=%!STATUS!", ntStatus);
+            goto Exit;
+        }
+
+        ntStatus = DecompressedDataProcess(DmfModule,
+                                           uncompressedChunk,
+                                           finalUncompressedSize,
+                                           ClientContext);
+        if (! NT_SUCCESS(ntStatus))
+        {
+            TraceEvents(TRACE_LEVEL_ERROR, DMF_TRACE, "DecompressedDataProcess fails: ntStatus=%!STATUS!", ntStatus);
+            goto Exit;
+        }
+    }
+
+Exit:
+
+    if (decompressMemory != NULL)
+    {
+        WdfObjectDelete(decompressMemory);
+    }
+
+    FuncExit(DMF_TRACE, "ntStatus=%!STATUS!", ntStatus);
+
+    return ntStatus;
+}
+#pragma code_seg()
+
+#pragma code_seg("PAGE")
+_IRQL_requires_max_(PASSIVE_LEVEL)
+_Must_inspect_result_
+NTSTATUS
+DMF_File_ReaderMap(
+    _In_opt_ DMFMODULE DmfModule,
+    _In_ File_Reader* FileReader,
+    _Outptr_result_bytebuffer_(*ViewSize) VOID** View,
+    _Out_ size_t* ViewSize
+    )
+/*++
+
+Routine Description:
+
+    Maps a read-only view of a whole file opened using DMF_File_ReaderOpen(). The file's contents
+    are paged in as they are accessed instead of being copied into an allocated buffer.
+
+Arguments:
+
+    DmfModule - This Module's handle.
+    FileReader - The reader returned by DMF_File_ReaderOpen().
+    View - Where the address of the view is written. It is valid until DMF_File_ReaderClose() is called.
+    ViewSize - Where the size of the view is written.
+
+Return Value:
+
+    NTSTATUS
+
+--*/
+{
+    NTSTATUS ntStatus;
+
+    PAGED_CODE();
+
+    FuncEntry(DMF_TRACE);
+
+    DMFMODULE_VALIDATE_IN_METHOD_OPTIONAL(DmfModule,
+                                          File);
+
+    *View = NULL;
+    *ViewSize = 0;
+
+    // The view is only created the first time.
+    //
+    if (NULL == FileReader->View)
+    {
+        ntStatus = File_ReaderViewCreate(FileReader);
+        if (! NT_SUCCESS(ntStatus))
+        {
+            goto Exit;
+        }
+    }
+
+    *View = FileReader->View;
+    *ViewSize = FileReader->ViewSize;
+    ntStatus = STATUS_SUCCESS;
+
+Exit:
+
+    FuncExit(DMF_TRACE, "ntStatus=%!STATUS!", ntStatus);
+
+    return ntStatus;
+}
+#pragma code_seg()
+
+#pragma code_seg("PAGE")
+_IRQL_requires_max_(PASSIVE_LEVEL)
+_Must_inspect_result_
+NTSTATUS
+DMF_File_ReaderOpen(
+    _In_opt_ DMFMODULE DmfModule,
+    _In_z_ WCHAR* FileName,
+    _In_ ULONG ChunkSize,
+    _Out_ File_Reader** FileReader,
+    _Out_opt_ LONGLONG* FileSize
+    )
+/*++
+
+Routine Description:
+
+    Opens a file so that it can be read one chunk at a time using DMF_File_ReaderChunkRead(),
+    decompressed one chunk at a time using DMF_File_ReaderDecompress() or mapped using DMF_File_ReaderMap().
+    Unlike DMF_File_Read(), the contents of the file are never copied into a buffer the size of the file.
+
+Arguments:
+
+    DmfModule - This Module's handle.
+    FileName - Name of the file.
+    ChunkSize - Size of the buffer each chunk is read into. Zero selects File_ReaderChunkSizeDefault.
+    FileReader - Where the reader is written. The Client must call DMF_File_ReaderClose() when it is done.
+    FileSize - Optional location where the size of the file is written.
+
+Return Value:
+
+    NTSTATUS
+
+--*/
+{
+    NTSTATUS ntStatus;
+    WDF_OBJECT_ATTRIBUTES objectAttributes;
+    WDFMEMORY readerMemory;
+    File_Reader* fileReader;
+    HANDLE fileHandle;
+    LARGE_INTEGER fileSize;
+#if defined(DMF_KERNEL_MODE)
+    UNICODE_STRING unicodeFileName;
+    OBJECT_ATTRIBUTES fileAttributes;
+    IO_STATUS_BLOCK ioStatusBlock;
+    FILE_STANDARD_INFORMATION fileInformation;
+#endif
+
+    PAGED_CODE();
+
+    FuncEntry(DMF_TRACE);
+
+    DMFMODULE_VALIDATE_IN_METHOD_OPTIONAL(DmfModule,
+                                          File);
+
+    TraceEvents(TRACE_LEVEL_VERBOSE,
+                DMF_TRACE,
+                "Opening file %S",
+                FileName);
+
+    *FileReader = NULL;
+    readerMemory = NULL;
+    fileHandle = NULL;
+
+    if (0 == ChunkSize)
+    {
+        ChunkSize = File_ReaderChunkSizeDefault;
+    }
+
+#if defined(DMF_USER_MODE)
+    fileHandle = CreateFile(FileName,
+                            GENERIC_READ,
+                            FILE_SHARE_READ,
+                            NULL,
+                            OPEN_EXISTING,
+                            FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
+                            NULL);
+    if (INVALID_HANDLE_VALUE == fileHandle)
+    {
+        fileHandle = NULL;
+        ntStatus = NTSTATUS_FROM_WIN32(GetLastError());
+        TraceError(DMF_TRACE,
+                   "CreateFile fails: to Open %S! ntStatus=%!STATUS!",
+                   FileName,
+                   ntStatus);
+        goto Exit;
+    }
+
+    if (! GetFileSizeEx(fileHandle,
+                        &fileSize))
+    {
+        ntStatus = NTSTATUS_FROM_WIN32(GetLastError());
+        TraceError(DMF_TRACE,
+                   "GetFileSizeEx fails: to Read %S !ntStatus=%!STATUS!",
+                   FileName,
+                   ntStatus);
+        goto Exit;
+    }
+#elif defined(DMF_KERNEL_MODE)
+    RtlInitUnicodeString(&unicodeFileName,
+                         FileName);
+
+    InitializeObjectAttributes(&fileAttributes,
+                               &unicodeFileName,
+                               OBJ_CASE_INSENSITIVE | OBJ_KERNEL_HANDLE,
+                               NULL,
+                               NULL);
+
+    ntStatus = ZwOpenFile(&fileHandle,
+                          GENERIC_READ | SYNCHRONIZE,
+                          &fileAttributes,
+                          &ioStatusBlock,
+                          FILE_SHARE_READ,
+                          FILE_SYNCHRONOUS_IO_NONALERT | FILE_SEQUENTIAL_ONLY);
+    if (! NT_SUCCESS(ntStatus))
+    {
+        fileHandle = NULL;
+        TraceError(DMF_TRACE,
+                   "ZwOpenFile fails: to Open %S !ntStatus=%!STATUS!",
+                   FileName,
+                   ntStatus);
+        goto Exit;
+    }
+
+    ntStatus = ZwQueryInformationFile(fileHandle,
+                                      &ioStatusBlock,
+                                      &fileInformation,
+                                      sizeof(fileInformation),
+                                      FileStandardInformation);
+    if (! NT_SUCCESS(ntStatus))
+    {
+        TraceEvents(TRACE_LEVEL_ERROR, DMF_TRACE, "ZwQueryInformationFile fails: ntStatus=%!STATUS!", ntStatus);
+        goto Exit;
+    }
+
+    fileSize = fileInformation.EndOfFile;
+#endif
+
+    WDF_OBJECT_ATTRIBUTES_INIT(&objectAttributes);
+    objectAttributes.ParentObject = DmfModule;
+    ntStatus = WdfMemoryCreate(&objectAttributes,
+                               PagedPool,
+                               MemoryTag,
+                               sizeof(File_Reader),
+                               &readerMemory,
+                               (VOID**)&fileReader);
+    if (! NT_SUCCESS(ntStatus))
+    {
+        readerMemory = NULL;
+        TraceEvents(TRACE_LEVEL_ERROR, DMF_TRACE, "WdfMemoryCreate fails: ntStatus=%!STATUS!", ntStatus);
+        goto Exit;
+    }
+
+    RtlZeroMemory(fileReader,
+                  sizeof(File_Reader));
+    fileReader->ReaderMemory = readerMemory;
+
+    // The chunk buffer is deleted when the reader is deleted.
+    //
+    WDF_OBJECT_ATTRIBUTES_INIT(&objectAttributes);
+    objectAttributes.ParentObject = readerMemory;
+    ntStatus = WdfMemoryCreate(&objectAttributes,
+                               PagedPool,
+                               MemoryTag,
+                               ChunkSize,
+                               &fileReader->ChunkMemory,
+                               (VOID**)&fileReader->ChunkBuffer);
+    if (! NT_SUCCESS(ntStatus))
+    {
+        TraceEvents(TRACE_LEVEL_ERROR, DMF_TRACE, "WdfMemoryCreate fails: ntStatus=%!STATUS!", ntStatus);
+        goto Exit;
+    }
+
+    fileReader->ChunkBufferSize = ChunkSize;
+    fileReader->FileSize = fileSize.QuadPart;
+    fileReader->FileHandle = fileHandle;
+
+    // The reader owns the handle and the memory now.
+    //
+    fileHandle = NULL;
+    readerMemory = NULL;
+
+    *FileReader = fileReader;
+    if (FileSize != NULL)
+    {
+        *FileSize = fileReader->FileSize;
+    }
+
+Exit:
+
+    if (fileHandle != NULL)
+    {
+#if defined(DMF_USER_MODE)
+        CloseHandle(fileHandle);
+#elif defined(DMF_KERNEL_MODE)
+        ZwClose(fileHandle);
+#endif
+    }
+
+    if (readerMemory != NULL)
+    {
+        WdfObjectDelete(readerMemory);
+    }
+
+    FuncExit(DMF_TRACE, "ntStatus=%!STATUS!", ntStatus);
+
+    return ntStatus;
+}
+#pragma code_seg()
+
 #pragma code_seg("PAGE")
 _IRQL_requires_max_(PASSIVE_LEVEL)
 _Must_inspect_result_
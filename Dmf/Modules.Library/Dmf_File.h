@@ -26,6 +26,29 @@ Environment:
 //
 DECLARE_DMF_MODULE_NO_CONFIG(File)
 
+// Opaque structure that holds the state of a file opened using DMF_File_ReaderOpen().
+//
+typedef struct _File_Reader File_Reader;
+
+// Size of the buffer DMF_File_ReaderChunkRead() uses when the Client passes zero.
+//
+#define File_ReaderChunkSizeDefault     (64 * 1024)
+
+// Client callback that receives the decompressed data from DMF_File_ReaderDecompress()
+// one piece at a time. Data is only valid during the callback.
+// Returning an error stops the decompression.
+//
+typedef
+_Function_class_(EVT_DMF_File_DecompressedDataProcess)
+_IRQL_requires_max_(PASSIVE_LEVEL)
+_IRQL_requires_same_
+_Must_inspect_result_
+NTSTATUS
+EVT_DMF_File_DecompressedDataProcess(_In_opt_ DMFMODULE DmfModule,
+                                     _In_reads_bytes_(DataSize) UCHAR* Data,
+                                     _In_ ULONG DataSize,
+                                     _In_opt_ VOID* ClientContext);
+
 // Module Methods
 //
 
@@ -82,6 +105,55 @@ DMF_File_ReadEx(
     _Out_opt_ size_t* BufferLength
     );
 
+_IRQL_requires_max_(PASSIVE_LEVEL)
+_Must_inspect_result_
+NTSTATUS
+DMF_File_ReaderChunkRead(
+    _In_opt_ DMFMODULE DmfModule,
+    _In_ File_Reader* FileReader,
+    _Outptr_result_bytebuffer_(*ChunkSize) UCHAR** Chunk,
+    _Out_ ULONG* ChunkSize
+    );
+
+_IRQL_requires_max_(PASSIVE_LEVEL)
+VOID
+DMF_File_ReaderClose(
+    _In_opt_ DMFMODULE DmfModule,
+    _In_ File_Reader* FileReader
+    );
+
+_IRQL_requires_max_(PASSIVE_LEVEL)
+_Must_inspect_result_
+NTSTATUS
+DMF_File_ReaderDecompress(
+    _In_opt_ DMFMODULE DmfModule,
+    _In_ File_Reader* FileReader,
+    _In_ USHORT CompressionFormat,
+    _In_ EVT_DMF_File_DecompressedDataProcess* DecompressedDataProcess,
+    _In_opt_ VOID* ClientContext
+    );
+
+_IRQL_requires_max_(PASSIVE_LEVEL)
+_Must_inspect_result_
+NTSTATUS
+DMF_File_ReaderMap(
+    _In_opt_ DMFMODULE DmfModule,
+    _In_ File_Reader* FileReader,
+    _Outptr_result_bytebuffer_(*ViewSize) VOID** View,
+    _Out_ size_t* ViewSize
+    );
+
+_IRQL_requires_max_(PASSIVE_LEVEL)
+_Must_inspect_result_
+NTSTATUS
+DMF_File_ReaderOpen(
+    _In_opt_ DMFMODULE DmfModule,
+    _In_z_ WCHAR* FileName,
+    _In_ ULONG ChunkSize,
+    _Out_ File_Reader** FileReader,
+    _Out_opt_ LONGLONG* FileSize
+    );
+
 _IRQL_requires_max_(PASSIVE_LEVEL)
 _Must_inspect_result_
 NTSTATUS
@@ -1133,7 +1133,10 @@ Return Value:
     DMFMODULE_VALIDATE_IN_METHOD(DmfModule,
                                  HashTable);
 
-    DMF_ModuleLock(DmfModule);
+    // Readers do not modify the table so they can run at the same time if the Client
+    // selected a reader/writer or sharded lock.
+    //
+    DMF_ModuleLockShared(DmfModule);
 
     moduleContext = DMF_CONTEXT_GET(DmfModule);
 
@@ -1165,7 +1168,7 @@ Return Value:
 
 Exit:
 
-    DMF_ModuleUnlock(DmfModule);
+    DMF_ModuleUnlockShared(DmfModule);
 
     return ntStatus;
 }
@@ -40,6 +40,24 @@ Environment:
 #include <gpio.h>
 #include <spb.h>
 
+// Register reads are sent as write/read pairs by the Child SpbTarget Module.
+//
+C_ASSERT(I2cTarget_MaximumNumberOfAddressReads <= SpbTarget_MaximumNumberOfWriteReads);
+
+// Number of send completion contexts allocated up front. More are allocated
+// from the look-aside list if more transfers are pending.
+//
+#define I2cTarget_NumberOfSendCompletionContexts                    4
+
+// Client's callback and its context for a pending asynchronous transfer. This allows
+// the Child SpbTarget's completion to be chained to the Client.
+//
+typedef struct
+{
+    EVT_DMF_I2cTarget_SendCompletion* EvtI2cTargetSendCompletion;
+    VOID* ClientContext;
+} I2cTarget_SendCompletionContext;
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////////
 // Module Private Context
 ///////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -59,6 +77,12 @@ typedef struct _DMF_CONTEXT_I2cTarget
     // Resource Index.
     //
     ULONG ResourceIndex;
+    // Sends asynchronous transfers to the I2C connection.
+    //
+    DMFMODULE DmfModuleSpbTarget;
+    // Send completion contexts of pending asynchronous transfers.
+    //
+    DMFMODULE DmfModuleBufferPoolSendCompletionContext;
 } DMF_CONTEXT_I2cTarget;
 
 // This macro declares the following function:
@@ -591,6 +615,185 @@ Exit:
 }
 #pragma code_seg()
 
+EVT_DMF_SpbTarget_SendCompletion I2cTarget_SpbTargetSendCompletion;
+
+_Function_class_(EVT_DMF_SpbTarget_SendCompletion)
+_IRQL_requires_max_(DISPATCH_LEVEL)
+_IRQL_requires_same_
+VOID
+I2cTarget_SpbTargetSendCompletion(
+    _In_ DMFMODULE DmfModule,
+    _In_opt_ VOID* ClientContext,
+    _In_ NTSTATUS CompletionStatus
+    )
+/*++
+
+Routine Description:
+
+    Chain the completion of an asynchronous transfer from the Child SpbTarget Module
+    to the Client. (Callback Clients must always receive callbacks from immediate descendant.)
+
+Arguments:
+
+    DmfModule - The Child SpbTarget Module's handle.
+    ClientContext - The transfer's send completion context.
+    CompletionStatus - Status of the transfer.
+
+Return Value:
+
+    None
+
+--*/
+{
+    DMFMODULE dmfModule;
+    DMF_CONTEXT_I2cTarget* moduleContext;
+    I2cTarget_SendCompletionContext* sendCompletionContext;
+    EVT_DMF_I2cTarget_SendCompletion* evtI2cTargetSendCompletion;
+    VOID* clientContext;
+
+    FuncEntry(DMF_TRACE);
+
+    dmfModule = DMF_ParentModuleGet(DmfModule);
+    moduleContext = DMF_CONTEXT_GET(dmfModule);
+
+    DmfAssert(ClientContext != NULL);
+    sendCompletionContext = (I2cTarget_SendCompletionContext*)ClientContext;
+    evtI2cTargetSendCompletion = sendCompletionContext->EvtI2cTargetSendCompletion;
+    clientContext = sendCompletionContext->ClientContext;
+
+    DMF_BufferPool_Put(moduleContext->DmfModuleBufferPoolSendCompletionContext,
+                       sendCompletionContext);
+    sendCompletionContext = NULL;
+
+    if (evtI2cTargetSendCompletion != NULL)
+    {
+        evtI2cTargetSendCompletion(dmfModule,
+                                   clientContext,
+                                   CompletionStatus);
+    }
+
+    FuncExitVoid(DMF_TRACE);
+}
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+_Must_inspect_result_
+static
+NTSTATUS
+I2cTarget_AddressReadsSend(
+    _In_ DMFMODULE DmfModule,
+    _In_reads_(NumberOfAddressReads) I2cTarget_AddressReadEntry* AddressReads,
+    _In_ ULONG NumberOfAddressReads,
+    _In_opt_ EVT_DMF_I2cTarget_SendCompletion* EvtI2cTargetSendCompletion,
+    _In_opt_ VOID* ClientContext
+    )
+/*++
+
+Routine Description:
+
+    Sends the given register reads as a single batch of write/read pairs using the Child
+    SpbTarget Module. The given callback is called once when the whole batch completes.
+
+Arguments:
+
+    DmfModule - This Module's handle.
+    AddressReads - The given register reads.
+    NumberOfAddressReads - Number of entries in AddressReads.
+    EvtI2cTargetSendCompletion - Client callback called when the batch completes.
+    ClientContext - Client context passed to EvtI2cTargetSendCompletion.
+
+Return Value:
+
+    STATUS_SUCCESS if the batch was sent. EvtI2cTargetSendCompletion is called only in this case.
+    Otherwise, NTSTATUS of the failure.
+
+--*/
+{
+    NTSTATUS ntStatus;
+    DMF_CONTEXT_I2cTarget* moduleContext;
+    DMF_CONFIG_I2cTarget* moduleConfig;
+    I2cTarget_SendCompletionContext* sendCompletionContext;
+    SpbTarget_WriteRead writeReads[I2cTarget_MaximumNumberOfAddressReads];
+    ULONG addressReadIndex;
+
+    FuncEntry(DMF_TRACE);
+
+    moduleContext = DMF_CONTEXT_GET(DmfModule);
+
+    moduleConfig = DMF_CONFIG_GET(DmfModule);
+
+    sendCompletionContext = NULL;
+
+    if ((0 == NumberOfAddressReads) ||
+        (NumberOfAddressReads > I2cTarget_MaximumNumberOfAddressReads))
+    {
+        ntStatus = STATUS_INVALID_PARAMETER;
+        TraceEvents(TRACE_LEVEL_ERROR, DMF_TRACE, "Invalid NumberOfAddressReads=%d", NumberOfAddressReads);
+        goto Exit;
+    }
+
+    if (! moduleContext->I2cConnectionAssigned)
+    {
+        ntStatus = STATUS_DEVICE_NOT_CONNECTED;
+        TraceEvents(TRACE_LEVEL_ERROR, DMF_TRACE, "No I2C Resources Found");
+        goto Exit;
+    }
+
+    // Each register read is a write of the address followed by a read of the data.
+    //
+    for (addressReadIndex = 0; addressReadIndex < NumberOfAddressReads; addressReadIndex++)
+    {
+        DmfAssert(AddressReads[addressReadIndex].Buffer != NULL);
+        DmfAssert(AddressReads[addressReadIndex].BufferLength > 0);
+
+        writeReads[addressReadIndex].WriteBuffer = AddressReads[addressReadIndex].Address;
+        writeReads[addressReadIndex].WriteBufferLength = AddressReads[addressReadIndex].AddressLength;
+        writeReads[addressReadIndex].ReadBuffer = (UCHAR*)AddressReads[addressReadIndex].Buffer;
+        writeReads[addressReadIndex].ReadBufferLength = AddressReads[addressReadIndex].BufferLength;
+        writeReads[addressReadIndex].DelayInUs = moduleConfig->ReadDelayUs;
+    }
+
+    ntStatus = DMF_BufferPool_Get(moduleContext->DmfModuleBufferPoolSendCompletionContext,
+                                  (VOID**)&sendCompletionContext,
+                                  NULL);
+    if (! NT_SUCCESS(ntStatus))
+    {
+        TraceEvents(TRACE_LEVEL_ERROR, DMF_TRACE, "DMF_BufferPool_Get fails: ntStatus=%!STATUS!", ntStatus);
+        sendCompletionContext = NULL;
+        goto Exit;
+    }
+
+    sendCompletionContext->EvtI2cTargetSendCompletion = EvtI2cTargetSendCompletion;
+    sendCompletionContext->ClientContext = ClientContext;
+
+    ntStatus = DMF_SpbTarget_WriteReadBatchSend(moduleContext->DmfModuleSpbTarget,
+                                                writeReads,
+                                                NumberOfAddressReads,
+                                                (ULONG)moduleConfig->ReadTimeoutMs,
+                                                I2cTarget_SpbTargetSendCompletion,
+                                                sendCompletionContext);
+    if (! NT_SUCCESS(ntStatus))
+    {
+        TraceEvents(TRACE_LEVEL_ERROR, DMF_TRACE, "DMF_SpbTarget_WriteReadBatchSend fails: ntStatus=%!STATUS!", ntStatus);
+        goto Exit;
+    }
+
+    // The completion routine owns the context now.
+    //
+    sendCompletionContext = NULL;
+
+Exit:
+
+    if (sendCompletionContext != NULL)
+    {
+        DMF_BufferPool_Put(moduleContext->DmfModuleBufferPoolSendCompletionContext,
+                           sendCompletionContext);
+    }
+
+    FuncExit(DMF_TRACE, "ntStatus=%!STATUS!", ntStatus);
+
+    return ntStatus;
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////////
 // WDF Module Callbacks
 ///////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -601,6 +804,84 @@ Exit:
 ///////////////////////////////////////////////////////////////////////////////////////////////////////
 //
 
+#pragma code_seg("PAGE")
+_Function_class_(DMF_ChildModulesAdd)
+_IRQL_requires_max_(PASSIVE_LEVEL)
+static
+VOID
+DMF_I2cTarget_ChildModulesAdd(
+    _In_ DMFMODULE DmfModule,
+    _In_ DMF_MODULE_ATTRIBUTES* DmfParentModuleAttributes,
+    _In_ PDMFMODULE_INIT DmfModuleInit
+    )
+/*++
+
+Routine Description:
+
+    Configure and add the required Child Modules to the given Parent Module.
+
+Arguments:
+
+    DmfModule - The given Parent Module.
+    DmfParentModuleAttributes - Pointer to the parent DMF_MODULE_ATTRIBUTES structure.
+    DmfModuleInit - Opaque structure to be passed to DMF_DmfModuleAdd.
+
+Return Value:
+
+    None
+
+--*/
+{
+    DMF_MODULE_ATTRIBUTES moduleAttributes;
+    DMF_CONTEXT_I2cTarget* moduleContext;
+    DMF_CONFIG_I2cTarget* moduleConfig;
+    DMF_CONFIG_SpbTarget moduleConfigSpbTarget;
+    DMF_CONFIG_BufferPool moduleConfigBufferPool;
+
+    PAGED_CODE();
+
+    UNREFERENCED_PARAMETER(DmfParentModuleAttributes);
+
+    moduleContext = DMF_CONTEXT_GET(DmfModule);
+    moduleConfig = DMF_CONFIG_GET(DmfModule);
+
+    // SpbTarget
+    // ---------
+    // NOTE: Asynchronous transfers are sent using this Module. It opens the same
+    //       I2C connection as this Module. This Module validates that the connection
+    //       is present, if necessary.
+    //
+    DMF_CONFIG_SpbTarget_AND_ATTRIBUTES_INIT(&moduleConfigSpbTarget,
+                                             &moduleAttributes);
+    moduleConfigSpbTarget.SpbConnectionMandatory = FALSE;
+    moduleConfigSpbTarget.SpbConnectionIndex = moduleConfig->I2cResourceIndex;
+    moduleConfigSpbTarget.SpbConnectionI2cOnly = TRUE;
+    moduleConfigSpbTarget.OpenMode = FILE_GENERIC_READ | FILE_GENERIC_WRITE;
+    moduleConfigSpbTarget.ShareAccess = FILE_SHARE_READ | FILE_SHARE_WRITE;
+    DMF_DmfModuleAdd(DmfModuleInit,
+                     &moduleAttributes,
+                     WDF_NO_OBJECT_ATTRIBUTES,
+                     &moduleContext->DmfModuleSpbTarget);
+
+    // BufferPoolSendCompletionContext
+    // -------------------------------
+    //
+    DMF_CONFIG_BufferPool_AND_ATTRIBUTES_INIT(&moduleConfigBufferPool,
+                                              &moduleAttributes);
+    moduleConfigBufferPool.BufferPoolMode = BufferPool_Mode_Source;
+    moduleConfigBufferPool.Mode.SourceSettings.EnableLookAside = TRUE;
+    moduleConfigBufferPool.Mode.SourceSettings.BufferCount = I2cTarget_NumberOfSendCompletionContexts;
+    moduleConfigBufferPool.Mode.SourceSettings.PoolType = NonPagedPoolNx;
+    moduleConfigBufferPool.Mode.SourceSettings.BufferSize = sizeof(I2cTarget_SendCompletionContext);
+    moduleAttributes.ClientModuleInstanceName = "BufferPoolSendCompletionContext";
+    moduleAttributes.PassiveLevel = FALSE;
+    DMF_DmfModuleAdd(DmfModuleInit,
+                     &moduleAttributes,
+                     WDF_NO_OBJECT_ATTRIBUTES,
+                     &moduleContext->DmfModuleBufferPoolSendCompletionContext);
+}
+#pragma code_seg()
+
 #pragma code_seg("PAGE")
 _Function_class_(DMF_Open)
 _IRQL_requires_max_(PASSIVE_LEVEL)
@@ -682,6 +963,9 @@ Return Value:
     WDF_IO_TARGET_OPEN_PARAMS_INIT_OPEN_BY_NAME(&openParams,
                                                 &resourcePathString,
                                                 FILE_GENERIC_READ | FILE_GENERIC_WRITE);
+    // The Child SpbTarget Module also opens this connection.
+    //
+    openParams.ShareAccess = FILE_SHARE_READ | FILE_SHARE_WRITE;
 
     //  Open the IoTarget for I/O operation.
     //
@@ -902,6 +1186,7 @@ Return Value:
     PAGED_CODE();
 
     DMF_CALLBACKS_DMF_INIT(&dmfCallbacksDmf_I2cTarget);
+    dmfCallbacksDmf_I2cTarget.ChildModulesAdd = DMF_I2cTarget_ChildModulesAdd;
     dmfCallbacksDmf_I2cTarget.DeviceOpen = DMF_I2cTarget_Open;
     dmfCallbacksDmf_I2cTarget.DeviceClose = DMF_I2cTarget_Close;
     dmfCallbacksDmf_I2cTarget.DeviceResourcesAssign = DMF_I2cTarget_ResourcesAssign;
@@ -987,6 +1272,107 @@ Return Value:
 }
 #pragma code_seg()
 
+_IRQL_requires_max_(DISPATCH_LEVEL)
+_Must_inspect_result_
+NTSTATUS
+DMF_I2cTarget_AddressReadAsynchronous(
+    _In_ DMFMODULE DmfModule,
+    _In_reads_(AddressLength) UCHAR* Address,
+    _In_ ULONG AddressLength,
+    _Out_writes_(BufferLength) VOID* Buffer,
+    _In_ ULONG BufferLength,
+    _In_opt_ EVT_DMF_I2cTarget_SendCompletion* EvtI2cTargetSendCompletion,
+    _In_opt_ VOID* ClientContext
+    )
+/*++
+
+Routine Description:
+
+    Reads from a given address asynchronously. The given callback is called when the read completes.
+
+Arguments:
+
+    DmfModule - This Module's handle.
+    Address - The address to read from. It must remain valid until the read completes.
+    AddressLength - The number of bytes that make up the Address.
+    Buffer - The address where the bytes that are read should be written. It must remain valid
+             until the read completes.
+    BufferLength - The number of bytes to read.
+    EvtI2cTargetSendCompletion - Client callback called when the read completes.
+    ClientContext - Client context passed to EvtI2cTargetSendCompletion.
+
+Return Value:
+
+    NTSTATUS
+
+--*/
+{
+    NTSTATUS ntStatus;
+    I2cTarget_AddressReadEntry addressRead;
+
+    DMFMODULE_VALIDATE_IN_METHOD(DmfModule,
+                                 I2cTarget);
+
+    addressRead.Address = Address;
+    addressRead.AddressLength = AddressLength;
+    addressRead.Buffer = Buffer;
+    addressRead.BufferLength = BufferLength;
+
+    ntStatus = I2cTarget_AddressReadsSend(DmfModule,
+                                          &addressRead,
+                                          1,
+                                          EvtI2cTargetSendCompletion,
+                                          ClientContext);
+
+    return ntStatus;
+}
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+_Must_inspect_result_
+NTSTATUS
+DMF_I2cTarget_AddressReadBatchSend(
+    _In_ DMFMODULE DmfModule,
+    _In_reads_(NumberOfAddressReads) I2cTarget_AddressReadEntry* AddressReads,
+    _In_ ULONG NumberOfAddressReads,
+    _In_opt_ EVT_DMF_I2cTarget_SendCompletion* EvtI2cTargetSendCompletion,
+    _In_opt_ VOID* ClientContext
+    )
+/*++
+
+Routine Description:
+
+    Reads from several addresses asynchronously using a single SPB sequence. The given callback
+    is called once when all the reads have completed.
+
+Arguments:
+
+    DmfModule - This Module's handle.
+    AddressReads - The register reads. This array may be freed as soon as this Method returns but
+                   the buffers it points to must remain valid until the sequence completes.
+    NumberOfAddressReads - Number of entries in AddressReads. Maximum is I2cTarget_MaximumNumberOfAddressReads.
+    EvtI2cTargetSendCompletion - Client callback called when the sequence completes.
+    ClientContext - Client context passed to EvtI2cTargetSendCompletion.
+
+Return Value:
+
+    NTSTATUS
+
+--*/
+{
+    NTSTATUS ntStatus;
+
+    DMFMODULE_VALIDATE_IN_METHOD(DmfModule,
+                                 I2cTarget);
+
+    ntStatus = I2cTarget_AddressReadsSend(DmfModule,
+                                          AddressReads,
+                                          NumberOfAddressReads,
+                                          EvtI2cTargetSendCompletion,
+                                          ClientContext);
+
+    return ntStatus;
+}
+
 #pragma code_seg("PAGE")
 _IRQL_requires_max_(PASSIVE_LEVEL)
 _Must_inspect_result_
@@ -20,6 +20,35 @@ Environment:
 
 #pragma once
 
+// Maximum number of register reads that can be sent in a single batch.
+//
+#define I2cTarget_MaximumNumberOfAddressReads                       16
+
+// A single register read in a batch.
+//
+typedef struct
+{
+    // The address to read from.
+    //
+    UCHAR* Address;
+    ULONG AddressLength;
+    // The address where the bytes that are read are written.
+    //
+    VOID* Buffer;
+    ULONG BufferLength;
+} I2cTarget_AddressReadEntry;
+
+// Callback function called when an asynchronous transfer completes.
+//
+typedef
+_Function_class_(EVT_DMF_I2cTarget_SendCompletion)
+_IRQL_requires_max_(DISPATCH_LEVEL)
+_IRQL_requires_same_
+VOID
+EVT_DMF_I2cTarget_SendCompletion(_In_ DMFMODULE DmfModule,
+                                 _In_opt_ VOID* ClientContext,
+                                 _In_ NTSTATUS CompletionStatus);
+
 // Client uses this structure to configure the Module specific parameters.
 //
 typedef struct
@@ -62,6 +91,30 @@ DMF_I2cTarget_AddressRead(
     _In_ ULONG BufferLength
     );
 
+_IRQL_requires_max_(DISPATCH_LEVEL)
+_Must_inspect_result_
+NTSTATUS
+DMF_I2cTarget_AddressReadAsynchronous(
+    _In_ DMFMODULE DmfModule,
+    _In_reads_(AddressLength) UCHAR* Address,
+    _In_ ULONG AddressLength,
+    _Out_writes_(BufferLength) VOID* Buffer,
+    _In_ ULONG BufferLength,
+    _In_opt_ EVT_DMF_I2cTarget_SendCompletion* EvtI2cTargetSendCompletion,
+    _In_opt_ VOID* ClientContext
+    );
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+_Must_inspect_result_
+NTSTATUS
+DMF_I2cTarget_AddressReadBatchSend(
+    _In_ DMFMODULE DmfModule,
+    _In_reads_(NumberOfAddressReads) I2cTarget_AddressReadEntry* AddressReads,
+    _In_ ULONG NumberOfAddressReads,
+    _In_opt_ EVT_DMF_I2cTarget_SendCompletion* EvtI2cTargetSendCompletion,
+    _In_opt_ VOID* ClientContext
+    );
+
 _IRQL_requires_max_(PASSIVE_LEVEL)
 _Must_inspect_result_
 NTSTATUS
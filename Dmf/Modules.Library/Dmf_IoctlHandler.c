@@ -58,6 +58,10 @@ typedef struct _DMF_CONTEXT_IoctlHandler
     // that the IOCTL call's WDFREQUEST is routed to the specific instance.
     //
     WDFCOLLECTION AssociatedFileObjects;
+    // Histograms of the time each IOCTL's handler takes (one probe per IOCTL record).
+    // NULL unless EnableLatencyHistogram is set.
+    //
+    DMFMODULE DmfModuleLatencyHistogram;
 } DMF_CONTEXT_IoctlHandler;
 
 // This macro declares the following function:
@@ -313,6 +317,7 @@ Return Value:
     NTSTATUS ntStatus;
     DMF_CONFIG_IoctlHandler* moduleConfig;
     KPROCESSOR_MODE requestSenderMode;
+    LONGLONG startTick;
 
     UNREFERENCED_PARAMETER(Queue);
     UNREFERENCED_PARAMETER(InputBufferLength);
@@ -491,6 +496,8 @@ Return Value:
 
             // Buffer is validated. Call client handler.
             //
+            DMF_LATENCYHISTOGRAM_PROBE_BEGIN(moduleContext->DmfModuleLatencyHistogram,
+                                             startTick);
             ntStatus = ioctlRecord->EvtIoctlHandlerFunction(DmfModule,
                                                             Queue,
                                                             Request,
@@ -500,6 +507,9 @@ Return Value:
                                                             outputBuffer,
                                                             outputBufferSize,
                                                             &bytesReturned);
+            DMF_LATENCYHISTOGRAM_PROBE_END(moduleContext->DmfModuleLatencyHistogram,
+                                           tableIndex,
+                                           startTick);
             break;
         }
     }
@@ -961,11 +971,134 @@ Return Value:
 }
 #pragma code_seg()
 
+#pragma code_seg("PAGE")
+_Function_class_(DMF_ModuleIoctlCodesGet)
+static
+_IRQL_requires_max_(PASSIVE_LEVEL)
+BOOLEAN
+DMF_IoctlHandler_ModuleIoctlCodesGet(
+    _In_ DMFMODULE DmfModule,
+    _Out_writes_opt_(IoctlCodesCount) ULONG* IoctlCodes,
+    _In_ ULONG IoctlCodesCount,
+    _Out_ ULONG* NumberOfIoctlCodes
+    )
+/*++
+
+Routine Description:
+
+    Tells DMF which IOCTLs this Module handles so that DMF does not dispatch other IOCTLs.
+
+Arguments:
+
+    DmfModule - This Module's handle.
+    IoctlCodes - Where the IOCTL codes in the Client's table are written.
+    IoctlCodesCount - Number of entries in IoctlCodes.
+    NumberOfIoctlCodes - Number of IOCTL codes in the Client's table.
+
+Return Value:
+
+    TRUE if this Module only handles the IOCTLs in the Client's table.
+    FALSE if this Module handles every IOCTL (it forwards unhandled requests).
+
+--*/
+{
+    BOOLEAN returnValue;
+    DMF_CONFIG_IoctlHandler* moduleConfig;
+
+    PAGED_CODE();
+
+    moduleConfig = DMF_CONFIG_GET(DmfModule);
+
+    if (moduleConfig->ForwardUnhandledRequests)
+    {
+        *NumberOfIoctlCodes = 0;
+        returnValue = FALSE;
+        goto Exit;
+    }
+
+    *NumberOfIoctlCodes = moduleConfig->IoctlRecordCount;
+    if ((IoctlCodes != NULL) &&
+        (IoctlCodesCount >= moduleConfig->IoctlRecordCount))
+    {
+        for (ULONG tableIndex = 0; tableIndex < moduleConfig->IoctlRecordCount; tableIndex++)
+        {
+            IoctlCodes[tableIndex] = (ULONG)(moduleConfig->IoctlRecords[tableIndex].IoctlCode);
+        }
+    }
+
+    returnValue = TRUE;
+
+Exit:
+
+    return returnValue;
+}
+#pragma code_seg()
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////////
 // DMF Module Callbacks
 ///////////////////////////////////////////////////////////////////////////////////////////////////////
 //
 
+#pragma code_seg("PAGE")
+_Function_class_(DMF_ChildModulesAdd)
+_IRQL_requires_max_(PASSIVE_LEVEL)
+VOID
+DMF_IoctlHandler_ChildModulesAdd(
+    _In_ DMFMODULE DmfModule,
+    _In_ DMF_MODULE_ATTRIBUTES* DmfParentModuleAttributes,
+    _In_ PDMFMODULE_INIT DmfModuleInit
+    )
+/*++
+
+Routine Description:
+
+    Configure and add the required Child Modules to the given Parent Module.
+
+Arguments:
+
+    DmfModule - The given Parent Module.
+    DmfParentModuleAttributes - Pointer to the parent DMF_MODULE_ATTRIBUTES structure.
+    DmfModuleInit - Opaque structure to be passed to DMF_DmfModuleAdd.
+
+Return Value:
+
+    None
+
+--*/
+{
+    DMF_MODULE_ATTRIBUTES moduleAttributes;
+    DMF_CONFIG_IoctlHandler* moduleConfig;
+    DMF_CONTEXT_IoctlHandler* moduleContext;
+    DMF_CONFIG_LatencyHistogram moduleConfigLatencyHistogram;
+
+    UNREFERENCED_PARAMETER(DmfParentModuleAttributes);
+
+    PAGED_CODE();
+
+    FuncEntry(DMF_TRACE);
+
+    moduleConfig = DMF_CONFIG_GET(DmfModule);
+    moduleContext = DMF_CONTEXT_GET(DmfModule);
+
+    if (moduleConfig->EnableLatencyHistogram &&
+        (moduleConfig->IoctlRecordCount > 0))
+    {
+        // LatencyHistogram
+        // ----------------
+        //
+        DMF_CONFIG_LatencyHistogram_AND_ATTRIBUTES_INIT(&moduleConfigLatencyHistogram,
+                                                        &moduleAttributes);
+        moduleConfigLatencyHistogram.NumberOfProbes = moduleConfig->IoctlRecordCount;
+        DMF_DmfModuleAdd(DmfModuleInit,
+                         &moduleAttributes,
+                         WDF_NO_OBJECT_ATTRIBUTES,
+                         &moduleContext->DmfModuleLatencyHistogram);
+    }
+
+    FuncExitVoid(DMF_TRACE);
+}
+#pragma code_seg()
+
 #pragma code_seg("PAGE")
 _Function_class_(DMF_Open)
 _IRQL_requires_max_(PASSIVE_LEVEL)
@@ -1196,6 +1329,7 @@ Return Value:
     FuncEntry(DMF_TRACE);
 
     DMF_CALLBACKS_DMF_INIT(&dmfCallbacksDmf_IoctlHandler);
+    dmfCallbacksDmf_IoctlHandler.ChildModulesAdd = DMF_IoctlHandler_ChildModulesAdd;
     dmfCallbacksDmf_IoctlHandler.DeviceOpen = DMF_IoctlHandler_Open;
     dmfCallbacksDmf_IoctlHandler.DeviceClose = DMF_IoctlHandler_Close;
 
@@ -1229,6 +1363,7 @@ Return Value:
 
     dmfModuleDescriptor_IoctlHandler.CallbacksDmf = &dmfCallbacksDmf_IoctlHandler;
     dmfModuleDescriptor_IoctlHandler.CallbacksWdf = &dmfCallbacksWdf_IoctlHandler;
+    dmfModuleDescriptor_IoctlHandler.ModuleIoctlCodesGet = DMF_IoctlHandler_ModuleIoctlCodesGet;
 
     ntStatus = DMF_ModuleCreate(Device,
                                 DmfModuleAttributes,
@@ -1404,5 +1539,65 @@ Exit:
 }
 #pragma code_seg()
 
+_IRQL_requires_max_(DISPATCH_LEVEL)
+_Must_inspect_result_
+NTSTATUS
+DMF_IoctlHandler_LatencyHistogramGet(
+    _In_ DMFMODULE DmfModule,
+    _In_ ULONG IoctlRecordIndex,
+    _Out_ LatencyHistogram_Snapshot* Snapshot,
+    _In_ BOOLEAN Reset
+    )
+/*++
+
+Routine Description:
+
+    Returns the histogram of the time taken by the handler of a given IOCTL and,
+    optionally, resets it.
+
+Arguments:
+
+    DmfModule - This Module's handle.
+    IoctlRecordIndex - Index of the IOCTL in the Client's IoctlRecords table.
+    Snapshot - Returns the histogram.
+    Reset - TRUE to reset the histogram.
+
+Return Value:
+
+    STATUS_NOT_SUPPORTED if EnableLatencyHistogram is not set in the Module Config.
+    STATUS_INVALID_PARAMETER if IoctlRecordIndex is not valid.
+
+--*/
+{
+    NTSTATUS ntStatus;
+    DMF_CONTEXT_IoctlHandler* moduleContext;
+
+    FuncEntry(DMF_TRACE);
+
+    DMFMODULE_VALIDATE_IN_METHOD(DmfModule,
+                                 IoctlHandler);
+
+    moduleContext = DMF_CONTEXT_GET(DmfModule);
+
+    if (NULL == moduleContext->DmfModuleLatencyHistogram)
+    {
+        RtlZeroMemory(Snapshot,
+                      sizeof(LatencyHistogram_Snapshot));
+        ntStatus = STATUS_NOT_SUPPORTED;
+        goto Exit;
+    }
+
+    ntStatus = DMF_LatencyHistogram_SnapshotGet(moduleContext->DmfModuleLatencyHistogram,
+                                                IoctlRecordIndex,
+                                                Snapshot,
+                                                Reset);
+
+Exit:
+
+    FuncExit(DMF_TRACE, "ntStatus=%!STATUS!", ntStatus);
+
+    return ntStatus;
+}
+
 // eof: Dmf_IoctlHandler.c
 //
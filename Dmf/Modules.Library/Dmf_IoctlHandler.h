@@ -154,6 +154,10 @@ typedef struct
     // Device Interface Reference String (optional).
     //
     WCHAR* ReferenceString;
+    // Keep a histogram of the time taken by the handler of each IOCTL.
+    // Use DMF_IoctlHandler_LatencyHistogramGet() to retrieve them.
+    //
+    BOOLEAN EnableLatencyHistogram;
 } DMF_CONFIG_IoctlHandler;
 
 // This macro declares the following functions:
@@ -187,5 +191,15 @@ DMF_IoctlHandler_IoctlStateSet(
     _In_ BOOLEAN Enable
     );
 
+_IRQL_requires_max_(DISPATCH_LEVEL)
+_Must_inspect_result_
+NTSTATUS
+DMF_IoctlHandler_LatencyHistogramGet(
+    _In_ DMFMODULE DmfModule,
+    _In_ ULONG IoctlRecordIndex,
+    _Out_ LatencyHistogram_Snapshot* Snapshot,
+    _In_ BOOLEAN Reset
+    );
+
 // eof: Dmf_IoctlHandler.h
 //
@@ -0,0 +1,899 @@
+/*++
+
+    Copyright (c) Microsoft Corporation. All rights reserved.
+    Licensed under the MIT license.
+
+Module Name:
+
+    Dmf_LatencyHistogram.c
+
+Abstract:
+
+    Keeps logarithmically bucketed histograms of latencies measured by Clients. Each
+    histogram is identified by a probe Id. Every processor records into its own copy of
+    each histogram using interlocked operations, so recording takes no lock and processors
+    do not contend with each other. The copies are added together when a snapshot is taken.
+
+Environment:
+
+    Kernel-mode Driver Framework
+    User-mode Driver Framework
+
+--*/
+
+// DMF and this Module's Library specific definitions.
+//
+#include "DmfModule.h"
+#include "DmfModules.Library.h"
+#include "DmfModules.Library.Trace.h"
+
+#if defined(DMF_INCLUDE_TMH)
+#include "Dmf_LatencyHistogram.tmh"
+#endif
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+// Module Private Enumerations and Structures
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+
+#define LATENCYHISTOGRAM_SUB_BUCKETS        (1 << LatencyHistogram_SubBucketBits)
+
+// Counters of a single probe written by a single processor.
+// Cache aligned so that processors do not share cache lines. The alignment also pads
+// the size to a whole number of cache lines, so every element of an array that starts
+// on a cache line boundary is aligned.
+//
+typedef struct DECLSPEC_CACHEALIGN
+{
+    LONG64 Count;
+    LONG64 TotalNanoseconds;
+    LONG64 MaximumNanoseconds;
+    LONG64 Buckets[LatencyHistogram_NumberOfBuckets];
+} LATENCYHISTOGRAM_COUNTERS;
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+// Module Private Context
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+
+typedef struct _DMF_CONTEXT_LatencyHistogram
+{
+    // Provides the tick counts and converts them to nanoseconds.
+    //
+    DMFMODULE DmfModuleTime;
+    // NumberOfProcessors * NumberOfProbes counters.
+    //
+    // Counters points at the first cache line boundary inside CountersMemory.
+    //
+    WDFMEMORY CountersMemory;
+    LATENCYHISTOGRAM_COUNTERS* Counters;
+    // Number of copies of each histogram.
+    //
+    ULONG NumberOfProcessors;
+} DMF_CONTEXT_LatencyHistogram;
+
+// This macro declares the following function:
+// DMF_CONTEXT_GET()
+//
+DMF_MODULE_DECLARE_CONTEXT(LatencyHistogram)
+
+// This macro declares the following function:
+// DMF_CONFIG_GET()
+//
+DMF_MODULE_DECLARE_CONFIG(LatencyHistogram)
+
+// Memory Pool Tag.
+//
+#define MemoryTag 'oMHL'
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+// DMF Module Support Code
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+
+static
+ULONG
+LatencyHistogram_BucketIndexGet(
+    _In_ ULONG64 Nanoseconds
+    )
+/*++
+
+Routine Description:
+
+    Given a latency, return the index of the bucket that counts it.
+    Latencies smaller than the number of sub-buckets have a bucket each. After that,
+    each power of two is split into the same number of sub-buckets.
+
+Arguments:
+
+    Nanoseconds - The given latency.
+
+Return Value:
+
+    Index of the bucket.
+
+--*/
+{
+    ULONG mostSignificantBit;
+    ULONG bucketIndex;
+
+    if (Nanoseconds < LATENCYHISTOGRAM_SUB_BUCKETS)
+    {
+        bucketIndex = (ULONG)Nanoseconds;
+        goto Exit;
+    }
+
+    if (Nanoseconds >> 32)
+    {
+        _BitScanReverse(&mostSignificantBit,
+                        (ULONG)(Nanoseconds >> 32));
+        mostSignificantBit += 32;
+    }
+    else
+    {
+        _BitScanReverse(&mostSignificantBit,
+                        (ULONG)Nanoseconds);
+    }
+
+    if (mostSignificantBit >= LatencyHistogram_NumberOfPowersOfTwo)
+    {
+        bucketIndex = LatencyHistogram_NumberOfBuckets - 1;
+        goto Exit;
+    }
+
+    bucketIndex = ((mostSignificantBit - LatencyHistogram_SubBucketBits + 1) << LatencyHistogram_SubBucketBits) +
+                  (ULONG)((Nanoseconds >> (mostSignificantBit - LatencyHistogram_SubBucketBits)) & (LATENCYHISTOGRAM_SUB_BUCKETS - 1));
+
+Exit:
+
+    DmfAssert(bucketIndex < LatencyHistogram_NumberOfBuckets);
+
+    return bucketIndex;
+}
+
+static
+ULONG64
+LatencyHistogram_BucketLowestGet(
+    _In_ ULONG BucketIndex
+    )
+/*++
+
+Routine Description:
+
+    Given a bucket index, return the smallest latency it counts. This is the inverse of
+    LatencyHistogram_BucketIndexGet().
+
+Arguments:
+
+    BucketIndex - The given bucket index.
+
+Return Value:
+
+    Smallest latency in nanoseconds counted by the bucket.
+
+--*/
+{
+    ULONG mostSignificantBit;
+    ULONG subBucket;
+
+    if (BucketIndex < LATENCYHISTOGRAM_SUB_BUCKETS)
+    {
+        return BucketIndex;
+    }
+
+    mostSignificantBit = (BucketIndex >> LatencyHistogram_SubBucketBits) + LatencyHistogram_SubBucketBits - 1;
+    subBucket = BucketIndex & (LATENCYHISTOGRAM_SUB_BUCKETS - 1);
+
+    return ((ULONG64)(LATENCYHISTOGRAM_SUB_BUCKETS + subBucket)) << (mostSignificantBit - LatencyHistogram_SubBucketBits);
+}
+
+static
+ULONG
+LatencyHistogram_ProcessorIndexGet(
+    _In_ DMF_CONTEXT_LatencyHistogram* ModuleContext
+    )
+/*++
+
+Routine Description:
+
+    Return the index of the copy of the histograms used by the current processor.
+    The thread may move to another processor right after this call. It does not matter
+    because counters are only written using interlocked operations.
+
+Arguments:
+
+    ModuleContext - This Module's context.
+
+Return Value:
+
+    Index of the copy of the histograms.
+
+--*/
+{
+    ULONG processorIndex;
+
+#if defined(DMF_KERNEL_MODE)
+    processorIndex = KeGetCurrentProcessorNumberEx(NULL);
+#else
+    // Group relative. Processors in different groups may share a copy.
+    //
+    processorIndex = GetCurrentProcessorNumber();
+#endif
+
+    return processorIndex % ModuleContext->NumberOfProcessors;
+}
+
+static
+ULONG64
+LatencyHistogram_CounterRead(
+    _Inout_ LONG64 volatile* Counter,
+    _In_ BOOLEAN Reset
+    )
+/*++
+
+Routine Description:
+
+    Read a counter atomically and, optionally, set it to zero at the same time.
+
+Arguments:
+
+    Counter - The counter to read.
+    Reset - TRUE to set the counter to zero.
+
+Return Value:
+
+    Value of the counter.
+
+--*/
+{
+    if (Reset)
+    {
+        return (ULONG64)InterlockedExchange64(Counter,
+                                              0);
+    }
+    else
+    {
+        // 64-bit reads are not atomic on all architectures.
+        //
+        return (ULONG64)InterlockedCompareExchange64(Counter,
+                                                     0,
+                                                     0);
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+// WDF Module Callbacks
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+// DMF Module Callbacks
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+
+#pragma code_seg("PAGE")
+_Function_class_(DMF_ChildModulesAdd)
+_IRQL_requires_max_(PASSIVE_LEVEL)
+VOID
+DMF_LatencyHistogram_ChildModulesAdd(
+    _In_ DMFMODULE DmfModule,
+    _In_ DMF_MODULE_ATTRIBUTES* DmfParentModuleAttributes,
+    _In_ PDMFMODULE_INIT DmfModuleInit
+    )
+/*++
+
+Routine Description:
+
+    Configure and add the required Child Modules to the given Parent Module.
+
+Arguments:
+
+    DmfModule - The given Parent Module.
+    DmfParentModuleAttributes - Pointer to the parent DMF_MODULE_ATTRIBUTES structure.
+    DmfModuleInit - Opaque structure to be passed to DMF_DmfModuleAdd.
+
+Return Value:
+
+    None
+
+--*/
+{
+    DMF_MODULE_ATTRIBUTES moduleAttributes;
+    DMF_CONTEXT_LatencyHistogram* moduleContext;
+
+    UNREFERENCED_PARAMETER(DmfParentModuleAttributes);
+
+    PAGED_CODE();
+
+    FuncEntry(DMF_TRACE);
+
+    moduleContext = DMF_CONTEXT_GET(DmfModule);
+
+    // Time
+    // ----
+    //
+    DMF_Time_ATTRIBUTES_INIT(&moduleAttributes);
+    DMF_DmfModuleAdd(DmfModuleInit,
+                     &moduleAttributes,
+                     WDF_NO_OBJECT_ATTRIBUTES,
+                     &moduleContext->DmfModuleTime);
+
+    FuncExitVoid(DMF_TRACE);
+}
+#pragma code_seg()
+
+#pragma code_seg("PAGE")
+_Function_class_(DMF_Open)
+_IRQL_requires_max_(PASSIVE_LEVEL)
+_Must_inspect_result_
+static
+NTSTATUS
+DMF_LatencyHistogram_Open(
+    _In_ DMFMODULE DmfModule
+    )
+/*++
+
+Routine Description:
+
+    Initialize an instance of a DMF Module of type LatencyHistogram.
+
+Arguments:
+
+    DmfModule - This Module's handle.
+
+Return Value:
+
+    NTSTATUS
+
+--*/
+{
+    NTSTATUS ntStatus;
+    DMF_CONTEXT_LatencyHistogram* moduleContext;
+    DMF_CONFIG_LatencyHistogram* moduleConfig;
+    WDF_OBJECT_ATTRIBUTES objectAttributes;
+    size_t countersSize;
+    VOID* countersBuffer;
+
+    PAGED_CODE();
+
+    FuncEntry(DMF_TRACE);
+
+    moduleContext = DMF_CONTEXT_GET(DmfModule);
+    moduleConfig = DMF_CONFIG_GET(DmfModule);
+
+    if (0 == moduleConfig->NumberOfProbes)
+    {
+        TraceEvents(TRACE_LEVEL_ERROR, DMF_TRACE, "Invalid NumberOfProbes=%d", moduleConfig->NumberOfProbes);
+        ntStatus = STATUS_INVALID_PARAMETER;
+        goto Exit;
+    }
+
+#if defined(DMF_KERNEL_MODE)
+    moduleContext->NumberOfProcessors = KeQueryMaximumProcessorCountEx(ALL_PROCESSOR_GROUPS);
+#else
+    moduleContext->NumberOfProcessors = GetMaximumProcessorCount(ALL_PROCESSOR_GROUPS);
+#endif
+    if (0 == moduleContext->NumberOfProcessors)
+    {
+        DmfAssert(FALSE);
+        moduleContext->NumberOfProcessors = 1;
+    }
+
+    // Probes are recorded at DISPATCH_LEVEL so the counters must be in non-paged pool.
+    // WdfMemoryCreate does not guarantee cache line alignment, so allocate an extra
+    // cache line and align the counters on a cache line boundary.
+    //
+    C_ASSERT(SYSTEM_CACHE_ALIGNMENT_SIZE >= TYPE_ALIGNMENT(LATENCYHISTOGRAM_COUNTERS));
+    countersSize = (size_t)moduleContext->NumberOfProcessors * moduleConfig->NumberOfProbes * sizeof(LATENCYHISTOGRAM_COUNTERS);
+    WDF_OBJECT_ATTRIBUTES_INIT(&objectAttributes);
+    objectAttributes.ParentObject = DmfModule;
+    ntStatus = WdfMemoryCreate(&objectAttributes,
+                               NonPagedPoolNx,
+                               MemoryTag,
+                               countersSize + SYSTEM_CACHE_ALIGNMENT_SIZE,
+                               &moduleContext->CountersMemory,
+                               &countersBuffer);
+    if (! NT_SUCCESS(ntStatus))
+    {
+        TraceEvents(TRACE_LEVEL_ERROR, DMF_TRACE, "WdfMemoryCreate fails: ntStatus=%!STATUS!", ntStatus);
+        moduleContext->CountersMemory = NULL;
+        goto Exit;
+    }
+
+    moduleContext->Counters = (LATENCYHISTOGRAM_COUNTERS*)(((ULONG_PTR)countersBuffer + SYSTEM_CACHE_ALIGNMENT_SIZE - 1) & ~((ULONG_PTR)SYSTEM_CACHE_ALIGNMENT_SIZE - 1));
+    RtlZeroMemory(moduleContext->Counters,
+                  countersSize);
+
+Exit:
+
+    FuncExit(DMF_TRACE, "ntStatus=%!STATUS!", ntStatus);
+
+    return ntStatus;
+}
+#pragma code_seg()
+
+#pragma code_seg("PAGE")
+_Function_class_(DMF_Close)
+_IRQL_requires_max_(PASSIVE_LEVEL)
+static
+VOID
+DMF_LatencyHistogram_Close(
+    _In_ DMFMODULE DmfModule
+    )
+/*++
+
+Routine Description:
+
+    Uninitialize an instance of a DMF Module of type LatencyHistogram.
+
+Arguments:
+
+    DmfModule - This Module's handle.
+
+Return Value:
+
+    None
+
+--*/
+{
+    DMF_CONTEXT_LatencyHistogram* moduleContext;
+
+    PAGED_CODE();
+
+    FuncEntry(DMF_TRACE);
+
+    moduleContext = DMF_CONTEXT_GET(DmfModule);
+
+    if (moduleContext->CountersMemory != NULL)
+    {
+        WdfObjectDelete(moduleContext->CountersMemory);
+        moduleContext->CountersMemory = NULL;
+        moduleContext->Counters = NULL;
+    }
+
+    FuncExitVoid(DMF_TRACE);
+}
+#pragma code_seg()
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+// Public Calls by Client
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+
+#pragma code_seg("PAGE")
+_IRQL_requires_max_(PASSIVE_LEVEL)
+_Must_inspect_result_
+NTSTATUS
+DMF_LatencyHistogram_Create(
+    _In_ WDFDEVICE Device,
+    _In_ DMF_MODULE_ATTRIBUTES* DmfModuleAttributes,
+    _In_ WDF_OBJECT_ATTRIBUTES* ObjectAttributes,
+    _Out_ DMFMODULE* DmfModule
+    )
+/*++
+
+Routine Description:
+
+    Create an instance of a DMF Module of type LatencyHistogram.
+
+Arguments:
+
+    Device - Client driver's WDFDEVICE object.
+    DmfModuleAttributes - Opaque structure that contains parameters DMF needs to initialize the Module.
+    ObjectAttributes - WDF object attributes for DMFMODULE.
+    DmfModule - Address of the location where the created DMFMODULE handle is returned.
+
+Return Value:
+
+    NTSTATUS
+
+--*/
+{
+    NTSTATUS ntStatus;
+    DMF_MODULE_DESCRIPTOR dmfModuleDescriptor_LatencyHistogram;
+    DMF_CALLBACKS_DMF dmfCallbacksDmf_LatencyHistogram;
+
+    PAGED_CODE();
+
+    FuncEntry(DMF_TRACE);
+
+    DMF_CALLBACKS_DMF_INIT(&dmfCallbacksDmf_LatencyHistogram);
+    dmfCallbacksDmf_LatencyHistogram.ChildModulesAdd = DMF_LatencyHistogram_ChildModulesAdd;
+    dmfCallbacksDmf_LatencyHistogram.DeviceOpen = DMF_LatencyHistogram_Open;
+    dmfCallbacksDmf_LatencyHistogram.DeviceClose = DMF_LatencyHistogram_Close;
+
+    DMF_MODULE_DESCRIPTOR_INIT_CONTEXT_TYPE(dmfModuleDescriptor_LatencyHistogram,
+                                            LatencyHistogram,
+                                            DMF_CONTEXT_LatencyHistogram,
+                                            DMF_MODULE_OPTIONS_DISPATCH_MAXIMUM,
+                                            DMF_MODULE_OPEN_OPTION_OPEN_Create);
+
+    dmfModuleDescriptor_LatencyHistogram.CallbacksDmf = &dmfCallbacksDmf_LatencyHistogram;
+
+    ntStatus = DMF_ModuleCreate(Device,
+                                DmfModuleAttributes,
+                                ObjectAttributes,
+                                &dmfModuleDescriptor_LatencyHistogram,
+                                DmfModule);
+    if (! NT_SUCCESS(ntStatus))
+    {
+        TraceEvents(TRACE_LEVEL_ERROR, DMF_TRACE, "DMF_ModuleCreate fails: ntStatus=%!STATUS!", ntStatus);
+    }
+
+    FuncExit(DMF_TRACE, "ntStatus=%!STATUS!", ntStatus);
+
+    return(ntStatus);
+}
+#pragma code_seg()
+
+// Module Methods
+//
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+VOID
+DMF_LatencyHistogram_BucketRangeGet(
+    _In_ DMFMODULE DmfModule,
+    _In_ ULONG BucketIndex,
+    _Out_ ULONG64* LowestNanoseconds,
+    _Out_ ULONG64* HighestNanoseconds
+    )
+/*++
+
+Routine Description:
+
+    Return the range of latencies counted by a given bucket.
+
+Arguments:
+
+    DmfModule - This Module's handle.
+    BucketIndex - Index of the bucket in LatencyHistogram_Snapshot.Buckets.
+    LowestNanoseconds - Returns the smallest latency counted by the bucket.
+    HighestNanoseconds - Returns the largest latency counted by the bucket.
+
+Return Value:
+
+    None
+
+--*/
+{
+    DMFMODULE_VALIDATE_IN_METHOD(DmfModule,
+                                 LatencyHistogram);
+
+    DmfAssert(BucketIndex < LatencyHistogram_NumberOfBuckets);
+
+    *LowestNanoseconds = LatencyHistogram_BucketLowestGet(BucketIndex);
+    if (BucketIndex + 1 < LatencyHistogram_NumberOfBuckets)
+    {
+        *HighestNanoseconds = LatencyHistogram_BucketLowestGet(BucketIndex + 1) - 1;
+    }
+    else
+    {
+        *HighestNanoseconds = MAXULONG64;
+    }
+}
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+ULONG64
+DMF_LatencyHistogram_PercentileGet(
+    _In_ DMFMODULE DmfModule,
+    _In_ LatencyHistogram_Snapshot* Snapshot,
+    _In_ ULONG Percentile
+    )
+/*++
+
+Routine Description:
+
+    Return the latency under which the given percentage of the latencies in a snapshot are.
+    The result is rounded up to the end of the bucket that contains it and is never more
+    than the largest latency recorded.
+
+Arguments:
+
+    DmfModule - This Module's handle.
+    Snapshot - Snapshot returned by DMF_LatencyHistogram_SnapshotGet().
+    Percentile - Percentage from 0 to 100.
+
+Return Value:
+
+    Latency in nanoseconds. Zero if the snapshot is empty.
+
+--*/
+{
+    ULONG64 target;
+    ULONG64 cumulativeCount;
+    ULONG64 result;
+    ULONG bucketIndex;
+
+    DMFMODULE_VALIDATE_IN_METHOD(DmfModule,
+                                 LatencyHistogram);
+
+    DmfAssert(Percentile <= 100);
+
+    result = 0;
+    if (0 == Snapshot->Count)
+    {
+        goto Exit;
+    }
+
+    // Number of latencies that must be at or below the result (rounded up).
+    //
+    target = (Snapshot->Count * min(Percentile, 100) + 99) / 100;
+    if (0 == target)
+    {
+        target = 1;
+    }
+
+    cumulativeCount = 0;
+    result = Snapshot->MaximumNanoseconds;
+    for (bucketIndex = 0; bucketIndex < LatencyHistogram_NumberOfBuckets; bucketIndex++)
+    {
+        cumulativeCount += Snapshot->Buckets[bucketIndex];
+        if (cumulativeCount >= target)
+        {
+            if (bucketIndex + 1 < LatencyHistogram_NumberOfBuckets)
+            {
+                result = min(LatencyHistogram_BucketLowestGet(bucketIndex + 1) - 1,
+                             Snapshot->MaximumNanoseconds);
+            }
+            break;
+        }
+    }
+
+Exit:
+
+    return result;
+}
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+LONGLONG
+DMF_LatencyHistogram_ProbeBegin(
+    _In_ DMFMODULE DmfModule
+    )
+/*++
+
+Routine Description:
+
+    Return the tick count at the start of an operation. Pass it to DMF_LatencyHistogram_ProbeEnd()
+    when the operation ends.
+
+Arguments:
+
+    DmfModule - This Module's handle.
+
+Return Value:
+
+    Current tick count.
+
+--*/
+{
+    DMF_CONTEXT_LatencyHistogram* moduleContext;
+
+    DMFMODULE_VALIDATE_IN_METHOD(DmfModule,
+                                 LatencyHistogram);
+
+    moduleContext = DMF_CONTEXT_GET(DmfModule);
+
+    return DMF_Time_TickCountGet(moduleContext->DmfModuleTime);
+}
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+VOID
+DMF_LatencyHistogram_ProbeEnd(
+    _In_ DMFMODULE DmfModule,
+    _In_ ULONG ProbeId,
+    _In_ LONGLONG StartTick
+    )
+/*++
+
+Routine Description:
+
+    Record the time elapsed since a given tick count in the histogram of a given probe.
+
+Arguments:
+
+    DmfModule - This Module's handle.
+    ProbeId - Identifies the histogram.
+    StartTick - Tick count returned by DMF_LatencyHistogram_ProbeBegin().
+
+Return Value:
+
+    None
+
+--*/
+{
+    NTSTATUS ntStatus;
+    DMF_CONTEXT_LatencyHistogram* moduleContext;
+    LONGLONG elapsedNanoseconds;
+
+    DMFMODULE_VALIDATE_IN_METHOD(DmfModule,
+                                 LatencyHistogram);
+
+    moduleContext = DMF_CONTEXT_GET(DmfModule);
+
+    ntStatus = DMF_Time_ElapsedTimeNanosecondsGet(moduleContext->DmfModuleTime,
+                                                  StartTick,
+                                                  &elapsedNanoseconds);
+    if (! NT_SUCCESS(ntStatus))
+    {
+        goto Exit;
+    }
+
+    DMF_LatencyHistogram_Record(DmfModule,
+                                ProbeId,
+                                (elapsedNanoseconds > 0) ? (ULONG64)elapsedNanoseconds : 0);
+
+Exit:
+
+    return;
+}
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+VOID
+DMF_LatencyHistogram_Record(
+    _In_ DMFMODULE DmfModule,
+    _In_ ULONG ProbeId,
+    _In_ ULONG64 Nanoseconds
+    )
+/*++
+
+Routine Description:
+
+    Record a latency measured by the Client in the histogram of a given probe.
+
+Arguments:
+
+    DmfModule - This Module's handle.
+    ProbeId - Identifies the histogram.
+    Nanoseconds - The latency.
+
+Return Value:
+
+    None
+
+--*/
+{
+    DMF_CONTEXT_LatencyHistogram* moduleContext;
+    DMF_CONFIG_LatencyHistogram* moduleConfig;
+    LATENCYHISTOGRAM_COUNTERS* counters;
+    LONG64 maximumNanoseconds;
+
+    // NOTE: No entry/exit logging because this Method is called in hot paths.
+    //
+
+    DMFMODULE_VALIDATE_IN_METHOD(DmfModule,
+                                 LatencyHistogram);
+
+    moduleContext = DMF_CONTEXT_GET(DmfModule);
+    moduleConfig = DMF_CONFIG_GET(DmfModule);
+
+    if (ProbeId >= moduleConfig->NumberOfProbes)
+    {
+        DmfAssert(FALSE);
+        goto Exit;
+    }
+
+    // Keep within the range of the signed counters.
+    //
+    if (Nanoseconds > MAXLONG64)
+    {
+        Nanoseconds = MAXLONG64;
+    }
+
+    counters = &moduleContext->Counters[(LatencyHistogram_ProcessorIndexGet(moduleContext) * moduleConfig->NumberOfProbes) + ProbeId];
+
+    InterlockedIncrement64(&counters->Buckets[LatencyHistogram_BucketIndexGet(Nanoseconds)]);
+    InterlockedAdd64(&counters->TotalNanoseconds,
+                     (LONG64)Nanoseconds);
+    InterlockedIncrement64(&counters->Count);
+
+    maximumNanoseconds = InterlockedCompareExchange64(&counters->MaximumNanoseconds,
+                                                      0,
+                                                      0);
+    while ((LONG64)Nanoseconds > maximumNanoseconds)
+    {
+        LONG64 previousMaximumNanoseconds;
+
+        previousMaximumNanoseconds = InterlockedCompareExchange64(&counters->MaximumNanoseconds,
+                                                                  (LONG64)Nanoseconds,
+                                                                  maximumNanoseconds);
+        if (previousMaximumNanoseconds == maximumNanoseconds)
+        {
+            break;
+        }
+        maximumNanoseconds = previousMaximumNanoseconds;
+    }
+
+Exit:
+
+    return;
+}
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+_Must_inspect_result_
+NTSTATUS
+DMF_LatencyHistogram_SnapshotGet(
+    _In_ DMFMODULE DmfModule,
+    _In_ ULONG ProbeId,
+    _Out_ LatencyHistogram_Snapshot* Snapshot,
+    _In_ BOOLEAN Reset
+    )
+/*++
+
+Routine Description:
+
+    Add the copies of the histogram of a given probe kept by all the processors and,
+    optionally, reset them.
+
+Arguments:
+
+    DmfModule - This Module's handle.
+    ProbeId - Identifies the histogram.
+    Snapshot - Returns the histogram.
+    Reset - TRUE to set the histogram to zero.
+
+Return Value:
+
+    STATUS_SUCCESS or STATUS_INVALID_PARAMETER if the probe Id is not valid.
+
+--*/
+{
+    NTSTATUS ntStatus;
+    DMF_CONTEXT_LatencyHistogram* moduleContext;
+    DMF_CONFIG_LatencyHistogram* moduleConfig;
+    LATENCYHISTOGRAM_COUNTERS* counters;
+    ULONG64 maximumNanoseconds;
+    ULONG processorIndex;
+    ULONG bucketIndex;
+
+    FuncEntry(DMF_TRACE);
+
+    DMFMODULE_VALIDATE_IN_METHOD(DmfModule,
+                                 LatencyHistogram);
+
+    moduleContext = DMF_CONTEXT_GET(DmfModule);
+    moduleConfig = DMF_CONFIG_GET(DmfModule);
+
+    RtlZeroMemory(Snapshot,
+                  sizeof(LatencyHistogram_Snapshot));
+
+    if (ProbeId >= moduleConfig->NumberOfProbes)
+    {
+        TraceEvents(TRACE_LEVEL_ERROR, DMF_TRACE, "Invalid ProbeId=%d", ProbeId);
+        ntStatus = STATUS_INVALID_PARAMETER;
+        goto Exit;
+    }
+
+    // Latencies recorded while the snapshot is taken may be partially included.
+    //
+    for (processorIndex = 0; processorIndex < moduleContext->NumberOfProcessors; processorIndex++)
+    {
+        counters = &moduleContext->Counters[(processorIndex * moduleConfig->NumberOfProbes) + ProbeId];
+
+        Snapshot->Count += LatencyHistogram_CounterRead(&counters->Count,
+                                                        Reset);
+        Snapshot->TotalNanoseconds += LatencyHistogram_CounterRead(&counters->TotalNanoseconds,
+                                                                   Reset);
+        maximumNanoseconds = LatencyHistogram_CounterRead(&counters->MaximumNanoseconds,
+                                                          Reset);
+        if (maximumNanoseconds > Snapshot->MaximumNanoseconds)
+        {
+            Snapshot->MaximumNanoseconds = maximumNanoseconds;
+        }
+        for (bucketIndex = 0; bucketIndex < LatencyHistogram_NumberOfBuckets; bucketIndex++)
+        {
+            Snapshot->Buckets[bucketIndex] += LatencyHistogram_CounterRead(&counters->Buckets[bucketIndex],
+                                                                           Reset);
+        }
+    }
+
+    ntStatus = STATUS_SUCCESS;
+
+Exit:
+
+    FuncExit(DMF_TRACE, "ntStatus=%!STATUS!", ntStatus);
+
+    return ntStatus;
+}
+
+// eof: Dmf_LatencyHistogram.c
+//
@@ -0,0 +1,148 @@
+/*++
+
+    Copyright (c) Microsoft Corporation. All rights reserved.
+    Licensed under the MIT license.
+
+Module Name:
+
+    Dmf_LatencyHistogram.h
+
+Abstract:
+
+    Companion file to Dmf_LatencyHistogram.c.
+
+Environment:
+
+    Kernel-mode Driver Framework
+    User-mode Driver Framework
+
+--*/
+
+#pragma once
+
+// Each power of two of nanoseconds is split into 2^LatencyHistogram_SubBucketBits buckets.
+// Thus, the width of a bucket is never more than 25% of its lower bound.
+//
+#define LatencyHistogram_SubBucketBits              2
+// Latencies of 2^LatencyHistogram_NumberOfPowersOfTwo nanoseconds (about 3 days) or more
+// are counted in the last bucket.
+//
+#define LatencyHistogram_NumberOfPowersOfTwo        48
+#define LatencyHistogram_NumberOfBuckets            ((LatencyHistogram_NumberOfPowersOfTwo - LatencyHistogram_SubBucketBits + 1) << LatencyHistogram_SubBucketBits)
+
+// Histogram of a single probe returned by DMF_LatencyHistogram_SnapshotGet().
+//
+typedef struct
+{
+    // Number of latencies recorded.
+    //
+    ULONG64 Count;
+    // Sum of all latencies recorded.
+    //
+    ULONG64 TotalNanoseconds;
+    // Largest latency recorded.
+    //
+    ULONG64 MaximumNanoseconds;
+    // Number of latencies recorded in each bucket.
+    // Use DMF_LatencyHistogram_BucketRangeGet() to get the range of each bucket.
+    //
+    ULONG64 Buckets[LatencyHistogram_NumberOfBuckets];
+} LatencyHistogram_Snapshot;
+
+// Client uses this structure to configure the Module specific parameters.
+//
+typedef struct
+{
+    // Number of separate histograms kept by this Module. Probe Ids are
+    // zero based indexes less than this number.
+    //
+    ULONG NumberOfProbes;
+} DMF_CONFIG_LatencyHistogram;
+
+// Callback to set default (non-zero) values in DMF_CONFIG_LatencyHistogram
+// referenced by DECLARE_DMF_MODULE_EX().
+// NOTE: This callback is called by DMF not by Clients directly.
+//
+__forceinline
+VOID
+DMF_CONFIG_LatencyHistogram_DEFAULT(
+    _Inout_ DMF_CONFIG_LatencyHistogram* ModuleConfig
+    )
+{
+    ModuleConfig->NumberOfProbes = 1;
+}
+
+// This macro declares the following functions:
+// DMF_LatencyHistogram_ATTRIBUTES_INIT()
+// DMF_CONFIG_LatencyHistogram_AND_ATTRIBUTES_INIT()
+// DMF_LatencyHistogram_Create()
+//
+// DMF_CONFIG_LatencyHistogram_DEFAULT() must be declared above.
+//
+DECLARE_DMF_MODULE_EX(LatencyHistogram)
+
+// Probes are written using these macros so that instrumentation that is not enabled
+// (the DMFMODULE is NULL) only costs a comparison.
+//
+#define DMF_LATENCYHISTOGRAM_PROBE_BEGIN(DmfModuleLatencyHistogram, StartTick)                          \
+    ((StartTick) = (((DmfModuleLatencyHistogram) != NULL) ?                                             \
+                    DMF_LatencyHistogram_ProbeBegin(DmfModuleLatencyHistogram) : 0))
+
+#define DMF_LATENCYHISTOGRAM_PROBE_END(DmfModuleLatencyHistogram, ProbeId, StartTick)                   \
+    (((DmfModuleLatencyHistogram) != NULL) ?                                                            \
+     DMF_LatencyHistogram_ProbeEnd(DmfModuleLatencyHistogram, ProbeId, StartTick) : (VOID)0)
+
+// Module Methods
+//
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+VOID
+DMF_LatencyHistogram_BucketRangeGet(
+    _In_ DMFMODULE DmfModule,
+    _In_ ULONG BucketIndex,
+    _Out_ ULONG64* LowestNanoseconds,
+    _Out_ ULONG64* HighestNanoseconds
+    );
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+ULONG64
+DMF_LatencyHistogram_PercentileGet(
+    _In_ DMFMODULE DmfModule,
+    _In_ LatencyHistogram_Snapshot* Snapshot,
+    _In_ ULONG Percentile
+    );
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+LONGLONG
+DMF_LatencyHistogram_ProbeBegin(
+    _In_ DMFMODULE DmfModule
+    );
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+VOID
+DMF_LatencyHistogram_ProbeEnd(
+    _In_ DMFMODULE DmfModule,
+    _In_ ULONG ProbeId,
+    _In_ LONGLONG StartTick
+    );
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+VOID
+DMF_LatencyHistogram_Record(
+    _In_ DMFMODULE DmfModule,
+    _In_ ULONG ProbeId,
+    _In_ ULONG64 Nanoseconds
+    );
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+_Must_inspect_result_
+NTSTATUS
+DMF_LatencyHistogram_SnapshotGet(
+    _In_ DMFMODULE DmfModule,
+    _In_ ULONG ProbeId,
+    _Out_ LatencyHistogram_Snapshot* Snapshot,
+    _In_ BOOLEAN Reset
+    );
+
+// eof: Dmf_LatencyHistogram.h
+//
@@ -96,9 +96,19 @@ typedef struct
 struct REQUESTCONTEXT 
 {
     LONGLONG Timestamp;
+    // Output buffer of the request retrieved when the request is added so that
+    // data can be copied directly into it (CompleteRequestsWithDataBuffer).
+    //
+    VOID* OutputBuffer;
+    size_t OutputBufferSize;
 };
 WDF_DECLARE_CONTEXT_TYPE_WITH_NAME(REQUESTCONTEXT, RequestContextGet)
 
+// Maximum number of data buffers returned in a single request when
+// CompleteRequestsWithDataBuffer is set.
+//
+#define NotifyUserWithRequest_MaximumDataBuffersPerRequest  (32)
+
 EVT_WDF_IO_QUEUE_IO_CANCELED_ON_QUEUE EvtIoCanceledOnQueue;
 
 VOID
@@ -318,6 +328,190 @@ Return Value:
     FuncExitVoid(DMF_TRACE);
 }
 
+_IRQL_requires_max_(DISPATCH_LEVEL)
+static
+VOID
+NotifyUserWithRequest_RequestCompleteWithDataBuffer(
+    _In_ DMFMODULE DmfModule,
+    _In_ WDFREQUEST Request,
+    _In_ VOID* DataBuffer,
+    _In_ NTSTATUS NtStatus
+    )
+/*++
+
+Routine Description:
+
+    Copy a single data buffer into the output buffer of a retrieved request and complete it.
+    Used when CompleteRequestsWithDataBuffer is set.
+
+Arguments:
+
+    DmfModule - This Module's handle.
+    Request - The retrieved request.
+    DataBuffer - Data to return in the request. Its size is SizeOfDataBuffer.
+    NtStatus - The status to send in completed request.
+
+Return Value:
+
+    None
+
+--*/
+{
+    DMF_CONFIG_NotifyUserWithRequest* moduleConfig;
+    REQUESTCONTEXT* requestContext;
+
+    moduleConfig = DMF_CONFIG_GET(DmfModule);
+
+    requestContext = RequestContextGet(Request);
+    DmfAssert(requestContext->OutputBufferSize >= (size_t)moduleConfig->SizeOfDataBuffer);
+
+    RtlCopyMemory(requestContext->OutputBuffer,
+                  DataBuffer,
+                  moduleConfig->SizeOfDataBuffer);
+
+    TraceEvents(TRACE_LEVEL_VERBOSE, DMF_TRACE, "Complete request=0x%p with data", Request);
+    WdfRequestCompleteWithInformation(Request,
+                                      NtStatus,
+                                      moduleConfig->SizeOfDataBuffer);
+}
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+static
+VOID
+NotifyUserWithRequest_CompleteRequestWithDataBuffers(
+    _In_ DMFMODULE DmfModule
+    )
+/*++
+
+Routine Description:
+
+    If there is a pending request and pending data, copy as many pending data buffers as fit in
+    the request's output buffer (up to MaximumDataBuffersPerRequest) directly into it and complete it.
+    Used when CompleteRequestsWithDataBuffer is set.
+
+Arguments:
+
+    DmfModule - This Module's handle.
+
+Return Value:
+
+    None
+
+--*/
+{
+    DMF_CONTEXT_NotifyUserWithRequest* moduleContext;
+    DMF_CONFIG_NotifyUserWithRequest* moduleConfig;
+    REQUESTCONTEXT* requestContext;
+    USEREVENT_ENTRY* userEventEntry;
+    VOID* clientBuffers[NotifyUserWithRequest_MaximumDataBuffersPerRequest];
+    VOID* clientBuffer;
+    WDFREQUEST request;
+    NTSTATUS ntStatus;
+    NTSTATUS requestNtStatus;
+    ULONG maximumNumberOfDataBuffers;
+    ULONG numberOfDataBuffers;
+    ULONG dataBufferIndex;
+
+    FuncEntry(DMF_TRACE);
+
+    moduleContext = DMF_CONTEXT_GET(DmfModule);
+    moduleConfig = DMF_CONFIG_GET(DmfModule);
+
+    request = NULL;
+    numberOfDataBuffers = 0;
+    requestNtStatus = STATUS_SUCCESS;
+
+    DMF_ModuleLock(DmfModule);
+
+    // Only retrieve a request when there is data to return in it.
+    //
+    if (0 == DMF_BufferQueue_Count(moduleContext->DmfModuleBufferQueue))
+    {
+        DMF_ModuleUnlock(DmfModule);
+        goto Exit;
+    }
+
+    ntStatus = WdfIoQueueRetrieveNextRequest(moduleContext->EventRequestQueue,
+                                             &request);
+    if (! NT_SUCCESS(ntStatus))
+    {
+        TraceEvents(TRACE_LEVEL_VERBOSE, DMF_TRACE, "WdfIoQueueRetrieveNextRequest fails: ntStatus=%!STATUS!", ntStatus);
+        request = NULL;
+        DMF_ModuleUnlock(DmfModule);
+        goto Exit;
+    }
+
+    DmfAssert(moduleContext->EventCountHeld > 0);
+    InterlockedDecrement(&moduleContext->EventCountHeld);
+
+    requestContext = RequestContextGet(request);
+    maximumNumberOfDataBuffers = (ULONG)(requestContext->OutputBufferSize / moduleConfig->SizeOfDataBuffer);
+    if (maximumNumberOfDataBuffers > moduleConfig->MaximumDataBuffersPerRequest)
+    {
+        maximumNumberOfDataBuffers = moduleConfig->MaximumDataBuffersPerRequest;
+    }
+    if (maximumNumberOfDataBuffers > NotifyUserWithRequest_MaximumDataBuffersPerRequest)
+    {
+        maximumNumberOfDataBuffers = NotifyUserWithRequest_MaximumDataBuffersPerRequest;
+    }
+    if (0 == maximumNumberOfDataBuffers)
+    {
+        maximumNumberOfDataBuffers = 1;
+    }
+
+    // Dequeue the data while holding the lock so that data is returned in order.
+    // All the data returned in a single request must have the same status.
+    //
+    while (numberOfDataBuffers < maximumNumberOfDataBuffers)
+    {
+        ntStatus = DMF_BufferQueue_Dequeue(moduleContext->DmfModuleBufferQueue,
+                                           &clientBuffer,
+                                           NULL);
+        if (! NT_SUCCESS(ntStatus))
+        {
+            break;
+        }
+
+        userEventEntry = (USEREVENT_ENTRY*)clientBuffer;
+        if (0 == numberOfDataBuffers)
+        {
+            requestNtStatus = userEventEntry->NtStatus;
+        }
+        else if (userEventEntry->NtStatus != requestNtStatus)
+        {
+            DMF_BufferQueue_EnqueueAtHead(moduleContext->DmfModuleBufferQueue,
+                                          clientBuffer);
+            break;
+        }
+
+        clientBuffers[numberOfDataBuffers] = clientBuffer;
+        numberOfDataBuffers++;
+    }
+
+    DMF_ModuleUnlock(DmfModule);
+
+    DmfAssert(numberOfDataBuffers > 0);
+
+    for (dataBufferIndex = 0; dataBufferIndex < numberOfDataBuffers; dataBufferIndex++)
+    {
+        userEventEntry = (USEREVENT_ENTRY*)clientBuffers[dataBufferIndex];
+        RtlCopyMemory((UCHAR*)requestContext->OutputBuffer + ((size_t)dataBufferIndex * moduleConfig->SizeOfDataBuffer),
+                      userEventEntry->EventCallbackContext,
+                      moduleConfig->SizeOfDataBuffer);
+        DMF_BufferQueue_Reuse(moduleContext->DmfModuleBufferQueue,
+                              clientBuffers[dataBufferIndex]);
+    }
+
+    TraceEvents(TRACE_LEVEL_VERBOSE, DMF_TRACE, "Complete request=0x%p with %u data buffers", request, numberOfDataBuffers);
+    WdfRequestCompleteWithInformation(request,
+                                      requestNtStatus,
+                                      (ULONG_PTR)numberOfDataBuffers * moduleConfig->SizeOfDataBuffer);
+
+Exit:
+
+    FuncExitVoid(DMF_TRACE);
+}
+
 _IRQL_requires_max_(DISPATCH_LEVEL)
 _Must_inspect_result_
 NTSTATUS
@@ -363,11 +557,20 @@ Return Value:
 
     DmfAssert(moduleConfig->MaximumNumberOfPendingDataBuffers > 0);
 
+    request = NULL;
+
+    if (moduleConfig->CompleteRequestsWithDataBuffer)
+    {
+        // The Module completes the request directly with possibly several data buffers.
+        //
+        NotifyUserWithRequest_CompleteRequestWithDataBuffers(DmfModule);
+        goto Exit;
+    }
+
     DMF_ModuleLock(DmfModule);
 
     // Check if request is available.
     //
-    request = NULL;
     ntStatus = WdfIoQueueFindRequest(moduleContext->EventRequestQueue,
                                      NULL,
                                      NULL,
@@ -497,11 +700,13 @@ Arguments:
 Return Value:
 
     STATUS_SUCCESS
+    STATUS_INVALID_PARAMETER if CompleteRequestsWithDataBuffer is set and SizeOfDataBuffer is zero.
 
 --*/
 {
     NTSTATUS ntStatus;
     DMF_CONTEXT_NotifyUserWithRequest* moduleContext;
+    DMF_CONFIG_NotifyUserWithRequest* moduleConfig;
     WDF_IO_QUEUE_CONFIG ioQueueConfig;
     WDFDEVICE device;
     WDF_OBJECT_ATTRIBUTES queueAttributes;
@@ -511,6 +716,18 @@ Return Value:
     FuncEntry(DMF_TRACE);
 
     moduleContext = DMF_CONTEXT_GET(DmfModule);
+    moduleConfig = DMF_CONFIG_GET(DmfModule);
+
+    // Data buffers are copied into the requests so they must have a size.
+    //
+    if (moduleConfig->CompleteRequestsWithDataBuffer &&
+        (0 == moduleConfig->SizeOfDataBuffer))
+    {
+        DmfAssert(FALSE);
+        TraceEvents(TRACE_LEVEL_ERROR, DMF_TRACE, "CompleteRequestsWithDataBuffer requires SizeOfDataBuffer");
+        ntStatus = STATUS_INVALID_PARAMETER;
+        goto Exit;
+    }
 
     device = DMF_ParentDeviceGet(DmfModule);
 
@@ -829,6 +1046,7 @@ Return Value:
     VOID* clientBufferContext;
     NTSTATUS ntStatus;
     BOOLEAN isLocked;
+    WDFREQUEST request;
 
     FuncEntry(DMF_TRACE);
 
@@ -855,6 +1073,40 @@ Return Value:
     DMF_ModuleLock(DmfModule);
     isLocked = TRUE;
 
+    if (moduleConfig->CompleteRequestsWithDataBuffer)
+    {
+        // The Module completes requests so there is no Client callback.
+        //
+        DmfAssert(NULL == EventCallbackFunction);
+
+        // Fast path: If no data is pending (so that order is preserved) and a request is
+        // pending, copy the data directly into the request without using the BufferQueue.
+        //
+        if (0 == DMF_BufferQueue_Count(moduleContext->DmfModuleBufferQueue))
+        {
+            ntStatus = WdfIoQueueRetrieveNextRequest(moduleContext->EventRequestQueue,
+                                                     &request);
+            if (NT_SUCCESS(ntStatus))
+            {
+                DmfAssert(moduleContext->EventCountHeld > 0);
+                InterlockedDecrement(&moduleContext->EventCountHeld);
+
+                DMF_ModuleUnlock(DmfModule);
+                isLocked = FALSE;
+
+                // SizeOfDataBuffer must be non-zero in this mode.
+                //
+                DmfAssert(EventCallbackContext != NULL);
+                #pragma warning(suppress:6387)
+                NotifyUserWithRequest_RequestCompleteWithDataBuffer(DmfModule,
+                                                                    request,
+                                                                    EventCallbackContext,
+                                                                    NtStatus);
+                goto Exit;
+            }
+        }
+    }
+
     // Retrieve the next buffer. 
     // This call should always succeed. The buffer list is created with a fixed number of buffers.
     // The consumer locks the DMFMODULE, consumes the content of the buffer and returns it back to the list.
@@ -964,6 +1216,8 @@ Return Value:
     DMF_CONTEXT_NotifyUserWithRequest* moduleContext;
     DMF_CONFIG_NotifyUserWithRequest* moduleConfig;
     NTSTATUS ntStatus;
+    VOID* outputBuffer;
+    size_t outputBufferSize;
 
     FuncEntry(DMF_TRACE);
 
@@ -973,6 +1227,9 @@ Return Value:
     moduleContext = DMF_CONTEXT_GET(DmfModule);
     moduleConfig = DMF_CONFIG_GET(DmfModule);
 
+    outputBuffer = NULL;
+    outputBufferSize = 0;
+
     ntStatus = DMF_ModuleReference(DmfModule);
     if (!NT_SUCCESS(ntStatus))
     {
@@ -980,6 +1237,22 @@ Return Value:
         goto ExitNoDereference;
     }
 
+    if (moduleConfig->CompleteRequestsWithDataBuffer)
+    {
+        // Retrieve the output buffer now so that data can be copied directly into it later.
+        // The request must be able to hold at least one data buffer.
+        //
+        ntStatus = WdfRequestRetrieveOutputBuffer(Request,
+                                                  moduleConfig->SizeOfDataBuffer,
+                                                  &outputBuffer,
+                                                  &outputBufferSize);
+        if (!NT_SUCCESS(ntStatus))
+        {
+            TraceEvents(TRACE_LEVEL_ERROR, DMF_TRACE, "WdfRequestRetrieveOutputBuffer fails: Request=%p ntStatus=%!STATUS!", Request, ntStatus);
+            goto Exit;
+        }
+    }
+
     if (InterlockedIncrement(&moduleContext->EventCountHeld) > moduleConfig->MaximumNumberOfPendingRequests)
     {
         // The maximum number of pending events allowed is exceeded.
@@ -990,7 +1263,8 @@ Return Value:
         goto Exit;
     }
 
-    if (moduleConfig->TimeStamping)
+    if (moduleConfig->TimeStamping ||
+        moduleConfig->CompleteRequestsWithDataBuffer)
     {
         WDF_OBJECT_ATTRIBUTES objectAttributes;
         WDF_OBJECT_ATTRIBUTES_INIT_CONTEXT_TYPE(&objectAttributes, 
@@ -1006,8 +1280,13 @@ Return Value:
             goto Exit;
         }
 
-        requestContext->Timestamp = DMF_Time_TickCountGet(moduleContext->DmfModuleTime);
-        TraceEvents(TRACE_LEVEL_VERBOSE, DMF_TRACE, "requestContext Timestamp=%lld", requestContext->Timestamp);
+        if (moduleConfig->TimeStamping)
+        {
+            requestContext->Timestamp = DMF_Time_TickCountGet(moduleContext->DmfModuleTime);
+            TraceEvents(TRACE_LEVEL_VERBOSE, DMF_TRACE, "requestContext Timestamp=%lld", requestContext->Timestamp);
+        }
+        requestContext->OutputBuffer = outputBuffer;
+        requestContext->OutputBufferSize = outputBufferSize;
     }
 
     // When a process comes or goes this request will be dequeued and completed.
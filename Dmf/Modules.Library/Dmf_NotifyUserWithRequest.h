@@ -61,6 +61,16 @@ typedef struct
     // if buffers run out too fast.
     //
     BOOLEAN EnableLookAside;
+    // This Module completes requests itself by copying data buffers directly into
+    // the output buffer of each request. Data buffers have a fixed size
+    // (SizeOfDataBuffer). Client passes NULL EventCallbackFunction to
+    // DMF_NotifyUserWithRequest_DataProcess().
+    //
+    BOOLEAN CompleteRequestsWithDataBuffer;
+    // When CompleteRequestsWithDataBuffer is set, the maximum number of pending data
+    // buffers returned in a single request. Zero means one.
+    //
+    ULONG MaximumDataBuffersPerRequest;
 } DMF_CONFIG_NotifyUserWithRequest;
 
 // This macro declares the following functions:
@@ -39,6 +39,9 @@ typedef struct
 {
     DMF_PORTABLE_EVENT* Event;
     NTSTATUS* NtStatus;
+    // Tick count when the workitem was enqueued (only when latency histogram is enabled).
+    //
+    LONGLONG EnqueueTick;
 } QUEUEDWORKITEM_WAIT_BLOCK;
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -54,6 +57,10 @@ typedef struct _DMF_CONTEXT_QueuedWorkItem
     // BufferQueue contains parameters for every enqueued workitem.
     //
     DMFMODULE DmfModuleBufferQueue;
+    // Histogram of the time from enqueue until the Client callback returns.
+    // NULL unless EnableLatencyHistogram is set.
+    //
+    DMFMODULE DmfModuleLatencyHistogram;
 } DMF_CONTEXT_QueuedWorkItem;
 
 // This macro declares the following function:
@@ -230,6 +237,9 @@ Return Value:
                                                                                  clientBufferContext);
 
     QUEUEDWORKITEM_WAIT_BLOCK* queuedWorkItemWaitBlock = QueuedWorkItem_WaitBlockFromClientBufferWithMetadata(clientBufferWithMetadata);
+    DMF_LATENCYHISTOGRAM_PROBE_END(moduleContext->DmfModuleLatencyHistogram,
+                                   0,
+                                   queuedWorkItemWaitBlock->EnqueueTick);
     if (queuedWorkItemWaitBlock->Event)
     {
         DMF_Portable_EventSet(queuedWorkItemWaitBlock->Event);
@@ -346,6 +356,18 @@ Return Value:
                      WDF_NO_OBJECT_ATTRIBUTES,
                      &moduleContext->DmfModuleScheduledTask);
 
+    if (moduleConfig->EnableLatencyHistogram)
+    {
+        // LatencyHistogram
+        // ----------------
+        //
+        DMF_LatencyHistogram_ATTRIBUTES_INIT(&moduleAttributes);
+        DMF_DmfModuleAdd(DmfModuleInit,
+                         &moduleAttributes,
+                         WDF_NO_OBJECT_ATTRIBUTES,
+                         &moduleContext->DmfModuleLatencyHistogram);
+    }
+
     FuncExitVoid(DMF_TRACE);
 }
 #pragma code_seg()
@@ -484,6 +506,8 @@ Return Value:
     QUEUEDWORKITEM_WAIT_BLOCK* queuedWorkItemWaitBlock = QueuedWorkItem_WaitBlockFromClientBufferWithMetadata(clientBufferWithMetadata);
     RtlZeroMemory(queuedWorkItemWaitBlock,
                   sizeof(QUEUEDWORKITEM_WAIT_BLOCK));
+    DMF_LATENCYHISTOGRAM_PROBE_BEGIN(moduleContext->DmfModuleLatencyHistogram,
+                                     queuedWorkItemWaitBlock->EnqueueTick);
 
     // Validate the size of the passed by caller.
     //
@@ -623,6 +647,8 @@ Return Value:
     ntStatusCall = STATUS_SUCCESS;
     queuedWorkItemWaitBlock->Event = &event;
     queuedWorkItemWaitBlock->NtStatus = &ntStatusCall;
+    DMF_LATENCYHISTOGRAM_PROBE_BEGIN(moduleContext->DmfModuleLatencyHistogram,
+                                     queuedWorkItemWaitBlock->EnqueueTick);
 
     // Add to pending work list.
     //
@@ -703,6 +729,63 @@ Return Value:
 }
 #pragma code_seg()
 
+_IRQL_requires_max_(DISPATCH_LEVEL)
+_Must_inspect_result_
+NTSTATUS
+DMF_QueuedWorkItem_LatencyHistogramGet(
+    _In_ DMFMODULE DmfModule,
+    _Out_ LatencyHistogram_Snapshot* Snapshot,
+    _In_ BOOLEAN Reset
+    )
+/*++
+
+Routine Description:
+
+    Returns the histogram of the time from when workitems are enqueued until their
+    callback returns and, optionally, resets it.
+
+Arguments:
+
+    DmfModule - This Module's handle.
+    Snapshot - Returns the histogram.
+    Reset - TRUE to reset the histogram.
+
+Return Value:
+
+    STATUS_NOT_SUPPORTED if EnableLatencyHistogram is not set in the Module Config.
+
+--*/
+{
+    NTSTATUS ntStatus;
+    DMF_CONTEXT_QueuedWorkItem* moduleContext;
+
+    FuncEntry(DMF_TRACE);
+
+    DMFMODULE_VALIDATE_IN_METHOD(DmfModule,
+                                 QueuedWorkItem);
+
+    moduleContext = DMF_CONTEXT_GET(DmfModule);
+
+    if (NULL == moduleContext->DmfModuleLatencyHistogram)
+    {
+        RtlZeroMemory(Snapshot,
+                      sizeof(LatencyHistogram_Snapshot));
+        ntStatus = STATUS_NOT_SUPPORTED;
+        goto Exit;
+    }
+
+    ntStatus = DMF_LatencyHistogram_SnapshotGet(moduleContext->DmfModuleLatencyHistogram,
+                                                0,
+                                                Snapshot,
+                                                Reset);
+
+Exit:
+
+    FuncExit(DMF_TRACE, "ntStatus=%!STATUS!", ntStatus);
+
+    return ntStatus;
+}
+
 _IRQL_requires_max_(DISPATCH_LEVEL)
 VOID
 DMF_QueuedWorkItem_StatusSet(
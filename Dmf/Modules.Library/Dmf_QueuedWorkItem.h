@@ -42,6 +42,10 @@ typedef struct
     // Consumer list holds buffers that have pending work.
     //
     DMF_CONFIG_BufferQueue BufferQueueConfig;
+    // Keep a histogram of the time from enqueue until the callback returns.
+    // Use DMF_QueuedWorkItem_LatencyHistogramGet() to retrieve it.
+    //
+    BOOLEAN EnableLatencyHistogram;
 } DMF_CONFIG_QueuedWorkItem;
 
 // Callback to set default (non-zero) values in DMF_CONFIG_QueuedWorkItem
@@ -102,6 +106,15 @@ DMF_QueuedWorkItem_Flush(
     _In_ DMFMODULE DmfModule
     );
 
+_IRQL_requires_max_(DISPATCH_LEVEL)
+_Must_inspect_result_
+NTSTATUS
+DMF_QueuedWorkItem_LatencyHistogramGet(
+    _In_ DMFMODULE DmfModule,
+    _Out_ LatencyHistogram_Snapshot* Snapshot,
+    _In_ BOOLEAN Reset
+    );
+
 _IRQL_requires_max_(DISPATCH_LEVEL)
 VOID
 DMF_QueuedWorkItem_StatusSet(
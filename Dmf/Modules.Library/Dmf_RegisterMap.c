@@ -0,0 +1,858 @@
+/*++
+
+    Copyright (c) Microsoft Corporation. All rights reserved.
+    Licensed under the MIT license.
+
+Module Name:
+
+    Dmf_RegisterMap.c
+
+Abstract:
+
+    Models a device as an array of 8-bit registers accessed over a slow bus (such as I2C or SPI).
+    Registers that do not change unless the driver writes them are cached so that reads and
+    read-modify-write operations do not access the bus. Writes to those registers are held
+    in the cache and written to the device in contiguous ranges when the Client syncs.
+
+Environment:
+
+    Kernel-mode Driver Framework
+    User-mode Driver Framework
+
+--*/
+
+// DMF and this Module's Library specific definitions.
+//
+#include "DmfModule.h"
+#include "DmfModules.Library.h"
+#include "DmfModules.Library.Trace.h"
+
+#if defined(DMF_INCLUDE_TMH)
+#include "Dmf_RegisterMap.tmh"
+#endif
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+// Module Private Enumerations and Structures
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+
+// Register may be cached.
+//
+#define REGISTERMAP_FLAG_CACHEABLE                                  0x01
+// Cached value is the value of the register.
+//
+#define REGISTERMAP_FLAG_VALID                                      0x02
+// Cached value has not been written to the device yet.
+//
+#define REGISTERMAP_FLAG_DIRTY                                      0x04
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+// Module Private Context
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+
+typedef struct _DMF_CONTEXT_RegisterMap
+{
+    // Holds both the cached values and the flags of all the registers.
+    //
+    WDFMEMORY RegistersMemory;
+    // Cached value of each register.
+    //
+    UCHAR* Values;
+    // REGISTERMAP_FLAG_* of each register.
+    //
+    UCHAR* Flags;
+    // Number of registers that are dirty.
+    //
+    ULONG DirtyRegisters;
+    // Statistics returned to the Client.
+    //
+    RegisterMap_Statistics Statistics;
+} DMF_CONTEXT_RegisterMap;
+
+// This macro declares the following function:
+// DMF_CONTEXT_GET()
+//
+DMF_MODULE_DECLARE_CONTEXT(RegisterMap)
+
+// This macro declares the following function:
+// DMF_CONFIG_GET()
+//
+DMF_MODULE_DECLARE_CONFIG(RegisterMap)
+
+// Memory Pool Tag.
+//
+#define MemoryTag 'MgeR'
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+// DMF Module Support Code
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+
+#pragma code_seg("PAGE")
+_IRQL_requires_max_(PASSIVE_LEVEL)
+_Must_inspect_result_
+static
+NTSTATUS
+RegisterMap_RegisterRead(
+    _In_ DMFMODULE DmfModule,
+    _In_ ULONG Register,
+    _Out_ UCHAR* Value
+    )
+/*++
+
+Routine Description:
+
+    Reads a register from the cache if possible. Otherwise, reads it from the device
+    and caches it if it is cacheable.
+    NOTE: Caller must hold the Module lock.
+
+Arguments:
+
+    DmfModule - This Module's handle.
+    Register - The register to read.
+    Value - Returns the value of the register.
+
+Return Value:
+
+    NTSTATUS
+
+--*/
+{
+    NTSTATUS ntStatus;
+    DMF_CONTEXT_RegisterMap* moduleContext;
+    DMF_CONFIG_RegisterMap* moduleConfig;
+    UCHAR value;
+
+    PAGED_CODE();
+
+    moduleContext = DMF_CONTEXT_GET(DmfModule);
+    moduleConfig = DMF_CONFIG_GET(DmfModule);
+
+    if (moduleContext->Flags[Register] & REGISTERMAP_FLAG_VALID)
+    {
+        DmfAssert(moduleContext->Flags[Register] & REGISTERMAP_FLAG_CACHEABLE);
+        *Value = moduleContext->Values[Register];
+        moduleContext->Statistics.CacheHits++;
+        ntStatus = STATUS_SUCCESS;
+        goto Exit;
+    }
+
+    ntStatus = moduleConfig->EvtRegisterMapBusRead(DmfModule,
+                                                   Register,
+                                                   &value,
+                                                   1);
+    moduleContext->Statistics.BusReads++;
+    if (! NT_SUCCESS(ntStatus))
+    {
+        TraceEvents(TRACE_LEVEL_ERROR, DMF_TRACE, "EvtRegisterMapBusRead Register=0x%X fails: ntStatus=%!STATUS!", Register, ntStatus);
+        goto Exit;
+    }
+
+    if (moduleContext->Flags[Register] & REGISTERMAP_FLAG_CACHEABLE)
+    {
+        moduleContext->Values[Register] = value;
+        moduleContext->Flags[Register] |= REGISTERMAP_FLAG_VALID;
+    }
+
+    *Value = value;
+
+Exit:
+
+    return ntStatus;
+}
+#pragma code_seg()
+
+#pragma code_seg("PAGE")
+_IRQL_requires_max_(PASSIVE_LEVEL)
+_Must_inspect_result_
+static
+NTSTATUS
+RegisterMap_RegisterWrite(
+    _In_ DMFMODULE DmfModule,
+    _In_ ULONG Register,
+    _In_ UCHAR Value
+    )
+/*++
+
+Routine Description:
+
+    Writes a cacheable register to the cache and marks it dirty. Volatile registers
+    are written to the device immediately.
+    NOTE: Caller must hold the Module lock.
+
+Arguments:
+
+    DmfModule - This Module's handle.
+    Register - The register to write.
+    Value - The value to write.
+
+Return Value:
+
+    NTSTATUS
+
+--*/
+{
+    NTSTATUS ntStatus;
+    DMF_CONTEXT_RegisterMap* moduleContext;
+    DMF_CONFIG_RegisterMap* moduleConfig;
+
+    PAGED_CODE();
+
+    moduleContext = DMF_CONTEXT_GET(DmfModule);
+    moduleConfig = DMF_CONFIG_GET(DmfModule);
+
+    if (moduleContext->Flags[Register] & REGISTERMAP_FLAG_CACHEABLE)
+    {
+        if ((moduleContext->Flags[Register] & REGISTERMAP_FLAG_VALID) &&
+            (moduleContext->Values[Register] == Value))
+        {
+            // Device already has (or will have after sync) this value.
+            //
+            ntStatus = STATUS_SUCCESS;
+            goto Exit;
+        }
+
+        moduleContext->Values[Register] = Value;
+        if (! (moduleContext->Flags[Register] & REGISTERMAP_FLAG_DIRTY))
+        {
+            moduleContext->DirtyRegisters++;
+        }
+        moduleContext->Flags[Register] |= (REGISTERMAP_FLAG_VALID | REGISTERMAP_FLAG_DIRTY);
+        moduleContext->Statistics.WritesDeferred++;
+        ntStatus = STATUS_SUCCESS;
+        goto Exit;
+    }
+
+    ntStatus = moduleConfig->EvtRegisterMapBusWrite(DmfModule,
+                                                    Register,
+                                                    &Value,
+                                                    1);
+    moduleContext->Statistics.BusWrites++;
+    if (! NT_SUCCESS(ntStatus))
+    {
+        TraceEvents(TRACE_LEVEL_ERROR, DMF_TRACE, "EvtRegisterMapBusWrite Register=0x%X fails: ntStatus=%!STATUS!", Register, ntStatus);
+        goto Exit;
+    }
+
+Exit:
+
+    return ntStatus;
+}
+#pragma code_seg()
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+// WDF Module Callbacks
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+// DMF Module Callbacks
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+
+#pragma code_seg("PAGE")
+_Function_class_(DMF_Open)
+_IRQL_requires_max_(PASSIVE_LEVEL)
+_Must_inspect_result_
+static
+NTSTATUS
+DMF_RegisterMap_Open(
+    _In_ DMFMODULE DmfModule
+    )
+/*++
+
+Routine Description:
+
+    Initialize an instance of a DMF Module of type RegisterMap.
+
+Arguments:
+
+    DmfModule - This Module's handle.
+
+Return Value:
+
+    NTSTATUS
+
+--*/
+{
+    NTSTATUS ntStatus;
+    DMF_CONTEXT_RegisterMap* moduleContext;
+    DMF_CONFIG_RegisterMap* moduleConfig;
+    WDF_OBJECT_ATTRIBUTES objectAttributes;
+    ULONG registerIndex;
+
+    PAGED_CODE();
+
+    FuncEntry(DMF_TRACE);
+
+    moduleContext = DMF_CONTEXT_GET(DmfModule);
+    moduleConfig = DMF_CONFIG_GET(DmfModule);
+
+    if ((0 == moduleConfig->NumberOfRegisters) ||
+        (NULL == moduleConfig->EvtRegisterMapBusRead) ||
+        (NULL == moduleConfig->EvtRegisterMapBusWrite))
+    {
+        TraceEvents(TRACE_LEVEL_ERROR, DMF_TRACE, "Invalid NumberOfRegisters=%d or missing callbacks", moduleConfig->NumberOfRegisters);
+        ntStatus = STATUS_INVALID_PARAMETER;
+        goto Exit;
+    }
+
+    // Values followed by Flags.
+    //
+    WDF_OBJECT_ATTRIBUTES_INIT(&objectAttributes);
+    objectAttributes.ParentObject = DmfModule;
+    ntStatus = WdfMemoryCreate(&objectAttributes,
+                               PagedPool,
+                               MemoryTag,
+                               2 * (size_t)moduleConfig->NumberOfRegisters,
+                               &moduleContext->RegistersMemory,
+                               (VOID**)&moduleContext->Values);
+    if (! NT_SUCCESS(ntStatus))
+    {
+        TraceEvents(TRACE_LEVEL_ERROR, DMF_TRACE, "WdfMemoryCreate fails: ntStatus=%!STATUS!", ntStatus);
+        moduleContext->RegistersMemory = NULL;
+        goto Exit;
+    }
+
+    RtlZeroMemory(moduleContext->Values,
+                  2 * (size_t)moduleConfig->NumberOfRegisters);
+    moduleContext->Flags = moduleContext->Values + moduleConfig->NumberOfRegisters;
+
+    // All registers are volatile unless the Client says otherwise.
+    //
+    if (moduleConfig->CacheableRegisters != NULL)
+    {
+        for (registerIndex = 0; registerIndex < moduleConfig->NumberOfRegisters; registerIndex++)
+        {
+            if (moduleConfig->CacheableRegisters[registerIndex])
+            {
+                moduleContext->Flags[registerIndex] = REGISTERMAP_FLAG_CACHEABLE;
+            }
+        }
+    }
+
+    moduleContext->DirtyRegisters = 0;
+    RtlZeroMemory(&moduleContext->Statistics,
+                  sizeof(moduleContext->Statistics));
+
+Exit:
+
+    FuncExit(DMF_TRACE, "ntStatus=%!STATUS!", ntStatus);
+
+    return ntStatus;
+}
+#pragma code_seg()
+
+#pragma code_seg("PAGE")
+_Function_class_(DMF_Close)
+_IRQL_requires_max_(PASSIVE_LEVEL)
+static
+VOID
+DMF_RegisterMap_Close(
+    _In_ DMFMODULE DmfModule
+    )
+/*++
+
+Routine Description:
+
+    Uninitialize an instance of a DMF Module of type RegisterMap.
+
+Arguments:
+
+    DmfModule - This Module's handle.
+
+Return Value:
+
+    None
+
+--*/
+{
+    DMF_CONTEXT_RegisterMap* moduleContext;
+
+    PAGED_CODE();
+
+    FuncEntry(DMF_TRACE);
+
+    moduleContext = DMF_CONTEXT_GET(DmfModule);
+
+    if (moduleContext->DirtyRegisters > 0)
+    {
+        // The device may no longer be accessible so these writes are lost.
+        // Clients must sync before the device is powered down.
+        //
+        TraceEvents(TRACE_LEVEL_WARNING, DMF_TRACE, "DirtyRegisters=%d", moduleContext->DirtyRegisters);
+    }
+
+    if (moduleContext->RegistersMemory != NULL)
+    {
+        WdfObjectDelete(moduleContext->RegistersMemory);
+        moduleContext->RegistersMemory = NULL;
+        moduleContext->Values = NULL;
+        moduleContext->Flags = NULL;
+    }
+
+    FuncExitVoid(DMF_TRACE);
+}
+#pragma code_seg()
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+// Public Calls by Client
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+
+#pragma code_seg("PAGE")
+_IRQL_requires_max_(PASSIVE_LEVEL)
+_Must_inspect_result_
+NTSTATUS
+DMF_RegisterMap_Create(
+    _In_ WDFDEVICE Device,
+    _In_ DMF_MODULE_ATTRIBUTES* DmfModuleAttributes,
+    _In_ WDF_OBJECT_ATTRIBUTES* ObjectAttributes,
+    _Out_ DMFMODULE* DmfModule
+    )
+/*++
+
+Routine Description:
+
+    Create an instance of a DMF Module of type RegisterMap.
+
+Arguments:
+
+    Device - Client's WDFDEVICE object.
+    DmfModuleAttributes - Opaque structure that contains parameters DMF needs to initialize the Module.
+    ObjectAttributes - WDF object attributes for DMFMODULE.
+    DmfModule - Address of the location where the created DMFMODULE handle is returned.
+
+Return Value:
+
+    NTSTATUS
+
+--*/
+{
+    NTSTATUS ntStatus;
+    DMF_MODULE_DESCRIPTOR dmfModuleDescriptor_RegisterMap;
+    DMF_CALLBACKS_DMF dmfCallbacksDmf_RegisterMap;
+
+    PAGED_CODE();
+
+    FuncEntry(DMF_TRACE);
+
+    DMF_CALLBACKS_DMF_INIT(&dmfCallbacksDmf_RegisterMap);
+    dmfCallbacksDmf_RegisterMap.DeviceOpen = DMF_RegisterMap_Open;
+    dmfCallbacksDmf_RegisterMap.DeviceClose = DMF_RegisterMap_Close;
+
+    DMF_MODULE_DESCRIPTOR_INIT_CONTEXT_TYPE(dmfModuleDescriptor_RegisterMap,
+                                            RegisterMap,
+                                            DMF_CONTEXT_RegisterMap,
+                                            DMF_MODULE_OPTIONS_PASSIVE,
+                                            DMF_MODULE_OPEN_OPTION_OPEN_Create);
+
+    dmfModuleDescriptor_RegisterMap.CallbacksDmf = &dmfCallbacksDmf_RegisterMap;
+
+    ntStatus = DMF_ModuleCreate(Device,
+                                DmfModuleAttributes,
+                                ObjectAttributes,
+                                &dmfModuleDescriptor_RegisterMap,
+                                DmfModule);
+    if (! NT_SUCCESS(ntStatus))
+    {
+        TraceEvents(TRACE_LEVEL_ERROR, DMF_TRACE, "DMF_ModuleCreate fails: ntStatus=%!STATUS!", ntStatus);
+    }
+
+    FuncExit(DMF_TRACE, "ntStatus=%!STATUS!", ntStatus);
+
+    return(ntStatus);
+}
+#pragma code_seg()
+
+// Module Methods
+//
+
+#pragma code_seg("PAGE")
+_IRQL_requires_max_(PASSIVE_LEVEL)
+VOID
+DMF_RegisterMap_Invalidate(
+    _In_ DMFMODULE DmfModule
+    )
+/*++
+
+Routine Description:
+
+    Discards all cached values, including those not written to the device yet.
+    Call this Method after the device is reset.
+
+Arguments:
+
+    DmfModule - This Module's handle.
+
+Return Value:
+
+    None
+
+--*/
+{
+    DMF_CONTEXT_RegisterMap* moduleContext;
+    DMF_CONFIG_RegisterMap* moduleConfig;
+    ULONG registerIndex;
+
+    PAGED_CODE();
+
+    FuncEntry(DMF_TRACE);
+
+    DMFMODULE_VALIDATE_IN_METHOD(DmfModule,
+                                 RegisterMap);
+
+    moduleContext = DMF_CONTEXT_GET(DmfModule);
+    moduleConfig = DMF_CONFIG_GET(DmfModule);
+
+    DMF_ModuleLock(DmfModule);
+
+    for (registerIndex = 0; registerIndex < moduleConfig->NumberOfRegisters; registerIndex++)
+    {
+        moduleContext->Flags[registerIndex] &= ~(REGISTERMAP_FLAG_VALID | REGISTERMAP_FLAG_DIRTY);
+    }
+    moduleContext->DirtyRegisters = 0;
+
+    DMF_ModuleUnlock(DmfModule);
+
+    FuncExitVoid(DMF_TRACE);
+}
+#pragma code_seg()
+
+#pragma code_seg("PAGE")
+_IRQL_requires_max_(PASSIVE_LEVEL)
+_Must_inspect_result_
+NTSTATUS
+DMF_RegisterMap_Read(
+    _In_ DMFMODULE DmfModule,
+    _In_ ULONG Register,
+    _Out_ UCHAR* Value
+    )
+/*++
+
+Routine Description:
+
+    Reads a register. Cacheable registers are read from the device only the first time.
+
+Arguments:
+
+    DmfModule - This Module's handle.
+    Register - The register to read.
+    Value - Returns the value of the register.
+
+Return Value:
+
+    NTSTATUS
+
+--*/
+{
+    NTSTATUS ntStatus;
+    DMF_CONFIG_RegisterMap* moduleConfig;
+
+    PAGED_CODE();
+
+    FuncEntry(DMF_TRACE);
+
+    DMFMODULE_VALIDATE_IN_METHOD(DmfModule,
+                                 RegisterMap);
+
+    moduleConfig = DMF_CONFIG_GET(DmfModule);
+
+    if (Register >= moduleConfig->NumberOfRegisters)
+    {
+        DmfAssert(FALSE);
+        ntStatus = STATUS_INVALID_PARAMETER;
+        goto Exit;
+    }
+
+    DMF_ModuleLock(DmfModule);
+
+    ntStatus = RegisterMap_RegisterRead(DmfModule,
+                                        Register,
+                                        Value);
+
+    DMF_ModuleUnlock(DmfModule);
+
+Exit:
+
+    FuncExit(DMF_TRACE, "ntStatus=%!STATUS!", ntStatus);
+
+    return ntStatus;
+}
+#pragma code_seg()
+
+#pragma code_seg("PAGE")
+_IRQL_requires_max_(PASSIVE_LEVEL)
+VOID
+DMF_RegisterMap_StatisticsGet(
+    _In_ DMFMODULE DmfModule,
+    _Out_ RegisterMap_Statistics* Statistics
+    )
+/*++
+
+Routine Description:
+
+    Returns the statistics this Module maintains.
+
+Arguments:
+
+    DmfModule - This Module's handle.
+    Statistics - Returns the statistics.
+
+Return Value:
+
+    None
+
+--*/
+{
+    DMF_CONTEXT_RegisterMap* moduleContext;
+
+    PAGED_CODE();
+
+    FuncEntry(DMF_TRACE);
+
+    DMFMODULE_VALIDATE_IN_METHOD(DmfModule,
+                                 RegisterMap);
+
+    moduleContext = DMF_CONTEXT_GET(DmfModule);
+
+    DMF_ModuleLock(DmfModule);
+    *Statistics = moduleContext->Statistics;
+    DMF_ModuleUnlock(DmfModule);
+
+    FuncExitVoid(DMF_TRACE);
+}
+#pragma code_seg()
+
+#pragma code_seg("PAGE")
+_IRQL_requires_max_(PASSIVE_LEVEL)
+_Must_inspect_result_
+NTSTATUS
+DMF_RegisterMap_Sync(
+    _In_ DMFMODULE DmfModule
+    )
+/*++
+
+Routine Description:
+
+    Writes all the dirty registers to the device. Each range of consecutive dirty registers
+    is written using a single multi-byte write.
+
+Arguments:
+
+    DmfModule - This Module's handle.
+
+Return Value:
+
+    NTSTATUS. If a write fails, the registers that were not written remain dirty.
+
+--*/
+{
+    NTSTATUS ntStatus;
+    DMF_CONTEXT_RegisterMap* moduleContext;
+    DMF_CONFIG_RegisterMap* moduleConfig;
+    ULONG firstRegister;
+    ULONG registerIndex;
+
+    PAGED_CODE();
+
+    FuncEntry(DMF_TRACE);
+
+    DMFMODULE_VALIDATE_IN_METHOD(DmfModule,
+                                 RegisterMap);
+
+    moduleContext = DMF_CONTEXT_GET(DmfModule);
+    moduleConfig = DMF_CONFIG_GET(DmfModule);
+
+    ntStatus = STATUS_SUCCESS;
+
+    DMF_ModuleLock(DmfModule);
+
+    registerIndex = 0;
+    while ((moduleContext->DirtyRegisters > 0) &&
+           (registerIndex < moduleConfig->NumberOfRegisters))
+    {
+        if (! (moduleContext->Flags[registerIndex] & REGISTERMAP_FLAG_DIRTY))
+        {
+            registerIndex++;
+            continue;
+        }
+
+        // Find the end of this range of dirty registers.
+        //
+        firstRegister = registerIndex;
+        while ((registerIndex < moduleConfig->NumberOfRegisters) &&
+               (moduleContext->Flags[registerIndex] & REGISTERMAP_FLAG_DIRTY))
+        {
+            registerIndex++;
+        }
+
+        ntStatus = moduleConfig->EvtRegisterMapBusWrite(DmfModule,
+                                                        firstRegister,
+                                                        &moduleContext->Values[firstRegister],
+                                                        registerIndex - firstRegister);
+        moduleContext->Statistics.BusWrites++;
+        if (! NT_SUCCESS(ntStatus))
+        {
+            TraceEvents(TRACE_LEVEL_ERROR, DMF_TRACE, "EvtRegisterMapBusWrite FirstRegister=0x%X NumberOfRegisters=%d fails: ntStatus=%!STATUS!", firstRegister, registerIndex - firstRegister, ntStatus);
+            break;
+        }
+
+        for (; firstRegister < registerIndex; firstRegister++)
+        {
+            moduleContext->Flags[firstRegister] &= ~REGISTERMAP_FLAG_DIRTY;
+            moduleContext->DirtyRegisters--;
+        }
+    }
+
+    DMF_ModuleUnlock(DmfModule);
+
+    FuncExit(DMF_TRACE, "ntStatus=%!STATUS!", ntStatus);
+
+    return ntStatus;
+}
+#pragma code_seg()
+
+#pragma code_seg("PAGE")
+_IRQL_requires_max_(PASSIVE_LEVEL)
+_Must_inspect_result_
+NTSTATUS
+DMF_RegisterMap_Update(
+    _In_ DMFMODULE DmfModule,
+    _In_ ULONG Register,
+    _In_ UCHAR Mask,
+    _In_ UCHAR Value
+    )
+/*++
+
+Routine Description:
+
+    Read-modify-write of the bits of a register selected by a given mask. If the register
+    is cacheable and cached, the device is not accessed until the next sync.
+
+Arguments:
+
+    DmfModule - This Module's handle.
+    Register - The register to update.
+    Mask - The bits to update.
+    Value - The new value of the bits to update.
+
+Return Value:
+
+    NTSTATUS
+
+--*/
+{
+    NTSTATUS ntStatus;
+    DMF_CONFIG_RegisterMap* moduleConfig;
+    UCHAR currentValue;
+    UCHAR newValue;
+
+    PAGED_CODE();
+
+    FuncEntry(DMF_TRACE);
+
+    DMFMODULE_VALIDATE_IN_METHOD(DmfModule,
+                                 RegisterMap);
+
+    moduleConfig = DMF_CONFIG_GET(DmfModule);
+
+    if (Register >= moduleConfig->NumberOfRegisters)
+    {
+        DmfAssert(FALSE);
+        ntStatus = STATUS_INVALID_PARAMETER;
+        goto Exit;
+    }
+
+    DMF_ModuleLock(DmfModule);
+
+    ntStatus = RegisterMap_RegisterRead(DmfModule,
+                                        Register,
+                                        &currentValue);
+    if (NT_SUCCESS(ntStatus))
+    {
+        newValue = (currentValue & ~Mask) | (Value & Mask);
+        if (newValue != currentValue)
+        {
+            ntStatus = RegisterMap_RegisterWrite(DmfModule,
+                                                 Register,
+                                                 newValue);
+        }
+    }
+
+    DMF_ModuleUnlock(DmfModule);
+
+Exit:
+
+    FuncExit(DMF_TRACE, "ntStatus=%!STATUS!", ntStatus);
+
+    return ntStatus;
+}
+#pragma code_seg()
+
+#pragma code_seg("PAGE")
+_IRQL_requires_max_(PASSIVE_LEVEL)
+_Must_inspect_result_
+NTSTATUS
+DMF_RegisterMap_Write(
+    _In_ DMFMODULE DmfModule,
+    _In_ ULONG Register,
+    _In_ UCHAR Value
+    )
+/*++
+
+Routine Description:
+
+    Writes a register. Cacheable registers are written to the device by the next sync.
+    Volatile registers are written to the device immediately.
+
+Arguments:
+
+    DmfModule - This Module's handle.
+    Register - The register to write.
+    Value - The value to write.
+
+Return Value:
+
+    NTSTATUS
+
+--*/
+{
+    NTSTATUS ntStatus;
+    DMF_CONFIG_RegisterMap* moduleConfig;
+
+    PAGED_CODE();
+
+    FuncEntry(DMF_TRACE);
+
+    DMFMODULE_VALIDATE_IN_METHOD(DmfModule,
+                                 RegisterMap);
+
+    moduleConfig = DMF_CONFIG_GET(DmfModule);
+
+    if (Register >= moduleConfig->NumberOfRegisters)
+    {
+        DmfAssert(FALSE);
+        ntStatus = STATUS_INVALID_PARAMETER;
+        goto Exit;
+    }
+
+    DMF_ModuleLock(DmfModule);
+
+    ntStatus = RegisterMap_RegisterWrite(DmfModule,
+                                         Register,
+                                         Value);
+
+    DMF_ModuleUnlock(DmfModule);
+
+Exit:
+
+    FuncExit(DMF_TRACE, "ntStatus=%!STATUS!", ntStatus);
+
+    return ntStatus;
+}
+#pragma code_seg()
+
+// eof: Dmf_RegisterMap.c
+//
@@ -0,0 +1,145 @@
+/*++
+
+    Copyright (c) Microsoft Corporation. All rights reserved.
+    Licensed under the MIT license.
+
+Module Name:
+
+    Dmf_RegisterMap.h
+
+Abstract:
+
+    Companion file to Dmf_RegisterMap.c.
+
+Environment:
+
+    Kernel-mode Driver Framework
+    User-mode Driver Framework
+
+--*/
+
+#pragma once
+
+// Callback function that reads consecutive registers from the device.
+//
+typedef
+_Function_class_(EVT_DMF_RegisterMap_BusRead)
+_IRQL_requires_max_(PASSIVE_LEVEL)
+_IRQL_requires_same_
+_Must_inspect_result_
+NTSTATUS
+EVT_DMF_RegisterMap_BusRead(_In_ DMFMODULE DmfModule,
+                            _In_ ULONG FirstRegister,
+                            _Out_writes_(NumberOfRegisters) UCHAR* Buffer,
+                            _In_ ULONG NumberOfRegisters);
+
+// Callback function that writes consecutive registers to the device.
+//
+typedef
+_Function_class_(EVT_DMF_RegisterMap_BusWrite)
+_IRQL_requires_max_(PASSIVE_LEVEL)
+_IRQL_requires_same_
+_Must_inspect_result_
+NTSTATUS
+EVT_DMF_RegisterMap_BusWrite(_In_ DMFMODULE DmfModule,
+                             _In_ ULONG FirstRegister,
+                             _In_reads_(NumberOfRegisters) UCHAR* Buffer,
+                             _In_ ULONG NumberOfRegisters);
+
+// Statistics maintained by this Module.
+//
+typedef struct
+{
+    // Number of register reads served from the cache.
+    //
+    ULONG64 CacheHits;
+    // Number of register reads that accessed the bus.
+    //
+    ULONG64 BusReads;
+    // Number of times EvtRegisterMapBusWrite was called.
+    //
+    ULONG64 BusWrites;
+    // Number of register writes held in the cache until the next sync.
+    //
+    ULONG64 WritesDeferred;
+} RegisterMap_Statistics;
+
+// Client uses this structure to configure the Module specific parameters.
+//
+typedef struct
+{
+    // Number of 8-bit registers in the device. Registers are numbered from 0.
+    //
+    ULONG NumberOfRegisters;
+    // Array of NumberOfRegisters entries. TRUE indicates the register only changes
+    // when the driver writes it so it can be cached. FALSE (volatile) registers
+    // are always read from and written to the device.
+    //
+    BOOLEAN* CacheableRegisters;
+    // Reads/writes consecutive registers from/to the device. The device is expected
+    // to auto-increment the register address during multi-byte transfers.
+    //
+    EVT_DMF_RegisterMap_BusRead* EvtRegisterMapBusRead;
+    EVT_DMF_RegisterMap_BusWrite* EvtRegisterMapBusWrite;
+} DMF_CONFIG_RegisterMap;
+
+// This macro declares the following functions:
+// DMF_RegisterMap_ATTRIBUTES_INIT()
+// DMF_CONFIG_RegisterMap_AND_ATTRIBUTES_INIT()
+// DMF_RegisterMap_Create()
+//
+DECLARE_DMF_MODULE(RegisterMap)
+
+// Module Methods
+//
+
+_IRQL_requires_max_(PASSIVE_LEVEL)
+VOID
+DMF_RegisterMap_Invalidate(
+    _In_ DMFMODULE DmfModule
+    );
+
+_IRQL_requires_max_(PASSIVE_LEVEL)
+_Must_inspect_result_
+NTSTATUS
+DMF_RegisterMap_Read(
+    _In_ DMFMODULE DmfModule,
+    _In_ ULONG Register,
+    _Out_ UCHAR* Value
+    );
+
+_IRQL_requires_max_(PASSIVE_LEVEL)
+VOID
+DMF_RegisterMap_StatisticsGet(
+    _In_ DMFMODULE DmfModule,
+    _Out_ RegisterMap_Statistics* Statistics
+    );
+
+_IRQL_requires_max_(PASSIVE_LEVEL)
+_Must_inspect_result_
+NTSTATUS
+DMF_RegisterMap_Sync(
+    _In_ DMFMODULE DmfModule
+    );
+
+_IRQL_requires_max_(PASSIVE_LEVEL)
+_Must_inspect_result_
+NTSTATUS
+DMF_RegisterMap_Update(
+    _In_ DMFMODULE DmfModule,
+    _In_ ULONG Register,
+    _In_ UCHAR Mask,
+    _In_ UCHAR Value
+    );
+
+_IRQL_requires_max_(PASSIVE_LEVEL)
+_Must_inspect_result_
+NTSTATUS
+DMF_RegisterMap_Write(
+    _In_ DMFMODULE DmfModule,
+    _In_ ULONG Register,
+    _In_ UCHAR Value
+    );
+
+// eof: Dmf_RegisterMap.h
+//
@@ -34,6 +34,9 @@ Environment:
 //
 
 #define DEFAULT_NUMBER_OF_PENDING_PASSIVE_LEVEL_COMPLETION_ROUTINES 4
+// Maximum number of completed single requests kept for reuse by later sends.
+//
+#define MAXIMUM_NUMBER_OF_RECYCLED_REQUESTS 16
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////////
 // Module Private Context
@@ -57,6 +60,20 @@ typedef struct _DMF_CONTEXT_RequestTarget
     // Pending reuse requests.
     //
     WDFCOLLECTION PendingReuseRequests;
+    // Completed single requests (and their memory objects) that are sent again by later
+    // single requests instead of creating new ones.
+    //
+    LIST_ENTRY RecycledRequestList;
+    // Incremented when the IoTarget changes so that requests created for a previous
+    // IoTarget are not recycled.
+    //
+    ULONG IoTargetGeneration;
+    // Number of single requests that are not in RecycledRequestList.
+    //
+    ULONG RequestsInUse;
+    // Statistics of the pool of recycled requests.
+    //
+    RequestTarget_RequestPoolStatistics RequestPoolStatistics;
 } DMF_CONTEXT_RequestTarget;
 
 // This macro declares the following function:
@@ -86,6 +103,27 @@ typedef struct
 } UNIQUE_REQUEST;
 WDF_DECLARE_CONTEXT_TYPE_WITH_NAME(UNIQUE_REQUEST, UniqueRequestContextGet)
 
+// Context of requests sent by the single request Methods so that they can be recycled.
+//
+typedef struct
+{
+    // Links the request into RecycledRequestList.
+    //
+    LIST_ENTRY ListEntry;
+    // The request this context belongs to.
+    //
+    WDFREQUEST Request;
+    // Memory objects used to attach the Client's buffers to the request. They are
+    // created the first time they are needed. Afterward, only their buffer is replaced.
+    //
+    WDFMEMORY MemoryForRequest;
+    WDFMEMORY MemoryForResponse;
+    // Value of IoTargetGeneration when the request was created.
+    //
+    ULONG IoTargetGeneration;
+} RequestTarget_RecycledRequestContext;
+WDF_DECLARE_CONTEXT_TYPE_WITH_NAME(RequestTarget_RecycledRequestContext, RequestTarget_RecycledRequestContextGet)
+
 typedef struct
 {
     DMFMODULE DmfModule;
@@ -482,6 +520,316 @@ Return Value:
     return returnValue;
 }
 
+_Must_inspect_result_
+static
+NTSTATUS
+RequestTarget_RecycledRequestGet(
+    _In_ DMFMODULE DmfModule,
+    _Out_ WDFREQUEST* Request
+    )
+/*++
+
+Routine Description:
+
+    Get a WDFREQUEST from the pool of recycled requests. If the pool is empty, create a new one.
+
+Arguments:
+
+    DmfModule - This Module's handle.
+    Request - Address where the request is returned.
+
+Return Value:
+
+    NTSTATUS
+
+--*/
+{
+    NTSTATUS ntStatus;
+    DMF_CONTEXT_RequestTarget* moduleContext;
+    WDF_OBJECT_ATTRIBUTES requestAttributes;
+    WDF_OBJECT_ATTRIBUTES recycledRequestAttributes;
+    RequestTarget_RecycledRequestContext* recycledRequestContext;
+    LIST_ENTRY* listEntry;
+    WDFREQUEST request;
+    ULONG ioTargetGeneration;
+
+    *Request = NULL;
+    moduleContext = DMF_CONTEXT_GET(DmfModule);
+
+    request = NULL;
+
+    DMF_ModuleLock(DmfModule);
+
+    if (! IsListEmpty(&moduleContext->RecycledRequestList))
+    {
+        listEntry = RemoveHeadList(&moduleContext->RecycledRequestList);
+        recycledRequestContext = CONTAINING_RECORD(listEntry,
+                                                   RequestTarget_RecycledRequestContext,
+                                                   ListEntry);
+        request = recycledRequestContext->Request;
+        moduleContext->RequestPoolStatistics.RequestsAvailable--;
+        moduleContext->RequestPoolStatistics.RequestsRecycled++;
+    }
+    else
+    {
+        moduleContext->RequestPoolStatistics.RequestsCreated++;
+    }
+    moduleContext->RequestsInUse++;
+    if (moduleContext->RequestsInUse > moduleContext->RequestPoolStatistics.MaximumRequestsInUse)
+    {
+        moduleContext->RequestPoolStatistics.MaximumRequestsInUse = moduleContext->RequestsInUse;
+    }
+    ioTargetGeneration = moduleContext->IoTargetGeneration;
+
+    DMF_ModuleUnlock(DmfModule);
+
+    if (request != NULL)
+    {
+        ntStatus = STATUS_SUCCESS;
+        goto Exit;
+    }
+
+    WDF_OBJECT_ATTRIBUTES_INIT_CONTEXT_TYPE(&requestAttributes,
+                                            UNIQUE_REQUEST);
+    requestAttributes.ParentObject = DmfModule;
+    ntStatus = WdfRequestCreate(&requestAttributes,
+                                moduleContext->IoTarget,
+                                &request);
+    if (! NT_SUCCESS(ntStatus))
+    {
+        request = NULL;
+        TraceEvents(TRACE_LEVEL_ERROR, DMF_TRACE, "WdfRequestCreate fails: ntStatus=%!STATUS!", ntStatus);
+        goto Exit;
+    }
+
+    WDF_OBJECT_ATTRIBUTES_INIT_CONTEXT_TYPE(&recycledRequestAttributes,
+                                            RequestTarget_RecycledRequestContext);
+    ntStatus = WdfObjectAllocateContext(request,
+                                        &recycledRequestAttributes,
+                                        (VOID**)&recycledRequestContext);
+    if (! NT_SUCCESS(ntStatus))
+    {
+        TraceEvents(TRACE_LEVEL_ERROR, DMF_TRACE, "WdfObjectAllocateContext fails: ntStatus=%!STATUS!", ntStatus);
+        WdfObjectDelete(request);
+        request = NULL;
+        goto Exit;
+    }
+
+    recycledRequestContext->Request = request;
+    recycledRequestContext->IoTargetGeneration = ioTargetGeneration;
+
+Exit:
+
+    if (NT_SUCCESS(ntStatus))
+    {
+        // The cancel id of a previous send must not match this send.
+        //
+        UNIQUE_REQUEST* uniqueRequestId = UniqueRequestContextGet(request);
+        uniqueRequestId->UniqueRequestIdCancel = 0;
+        *Request = request;
+    }
+    else
+    {
+        DMF_ModuleLock(DmfModule);
+        moduleContext->RequestsInUse--;
+        DMF_ModuleUnlock(DmfModule);
+    }
+
+    return ntStatus;
+}
+
+static
+VOID
+RequestTarget_RecycledRequestPut(
+    _In_ DMFMODULE DmfModule,
+    _In_ WDFREQUEST Request
+    )
+/*++
+
+Routine Description:
+
+    Return a WDFREQUEST that is no longer in use to the pool of recycled requests. The request
+    is deleted instead if the pool is full, if the request was formatted for a previous IoTarget
+    or if the Client could still cancel it.
+
+Arguments:
+
+    DmfModule - This Module's handle.
+    Request - The given request.
+
+Return Value:
+
+    None
+
+--*/
+{
+    NTSTATUS ntStatus;
+    DMF_CONTEXT_RequestTarget* moduleContext;
+    RequestTarget_RecycledRequestContext* recycledRequestContext;
+    UNIQUE_REQUEST* uniqueRequestId;
+    WDF_REQUEST_REUSE_PARAMS reuseParams;
+    BOOLEAN recycled;
+
+    moduleContext = DMF_CONTEXT_GET(DmfModule);
+    recycledRequestContext = RequestTarget_RecycledRequestContextGet(Request);
+    uniqueRequestId = UniqueRequestContextGet(Request);
+    recycled = FALSE;
+
+    // Release everything the previous send attached to the request (including
+    // references to the Client's buffers).
+    //
+    WDF_REQUEST_REUSE_PARAMS_INIT(&reuseParams,
+                                  WDF_REQUEST_REUSE_NO_FLAGS,
+                                  STATUS_SUCCESS);
+    ntStatus = WdfRequestReuse(Request,
+                               &reuseParams);
+
+    DMF_ModuleLock(DmfModule);
+
+    DmfAssert(moduleContext->RequestsInUse > 0);
+    moduleContext->RequestsInUse--;
+    // A request the Client can cancel is never recycled because DMF_RequestTarget_Cancel()
+    // may still hold a reference to it and would cancel the next send.
+    //
+    if (NT_SUCCESS(ntStatus) &&
+        (0 == uniqueRequestId->UniqueRequestIdCancel) &&
+        (recycledRequestContext->IoTargetGeneration == moduleContext->IoTargetGeneration) &&
+        (moduleContext->RequestPoolStatistics.RequestsAvailable < MAXIMUM_NUMBER_OF_RECYCLED_REQUESTS))
+    {
+        InsertTailList(&moduleContext->RecycledRequestList,
+                       &recycledRequestContext->ListEntry);
+        moduleContext->RequestPoolStatistics.RequestsAvailable++;
+        recycled = TRUE;
+    }
+    else
+    {
+        moduleContext->RequestPoolStatistics.RequestsDeleted++;
+    }
+
+    DMF_ModuleUnlock(DmfModule);
+
+    if (! recycled)
+    {
+        WdfObjectDelete(Request);
+    }
+}
+
+_Must_inspect_result_
+static
+NTSTATUS
+RequestTarget_RecycledRequestMemoryAssign(
+    _In_ WDFREQUEST Request,
+    _Inout_ WDFMEMORY* Memory,
+    _In_ VOID* Buffer,
+    _In_ size_t BufferSize
+    )
+/*++
+
+Routine Description:
+
+    Attach the given Client buffer to one of the memory objects of a recycled request. The memory
+    object is created the first time it is needed. Afterward, only its buffer is replaced.
+
+Arguments:
+
+    Request - The given request.
+    Memory - The memory object to update (or create).
+    Buffer - The given Client buffer.
+    BufferSize - Size of Buffer in bytes.
+
+Return Value:
+
+    NTSTATUS
+
+--*/
+{
+    NTSTATUS ntStatus;
+    WDF_OBJECT_ATTRIBUTES memoryAttributes;
+
+    if (*Memory != NULL)
+    {
+        WdfMemoryAssignBuffer(*Memory,
+                              Buffer,
+                              BufferSize);
+        ntStatus = STATUS_SUCCESS;
+        goto Exit;
+    }
+
+    WDF_OBJECT_ATTRIBUTES_INIT(&memoryAttributes);
+    memoryAttributes.ParentObject = Request;
+
+    ntStatus = WdfMemoryCreatePreallocated(&memoryAttributes,
+                                           Buffer,
+                                           BufferSize,
+                                           Memory);
+    if (! NT_SUCCESS(ntStatus))
+    {
+        *Memory = NULL;
+        TraceEvents(TRACE_LEVEL_ERROR, DMF_TRACE, "WdfMemoryCreatePreallocated fails: ntStatus=%!STATUS!", ntStatus);
+    }
+
+Exit:
+
+    return ntStatus;
+}
+
+static
+VOID
+RequestTarget_RecycledRequestsFlush(
+    _In_ DMFMODULE DmfModule
+    )
+/*++
+
+Routine Description:
+
+    Delete all the requests in the pool of recycled requests. Requests that are in use are
+    deleted when they complete. This is done when the IoTarget changes because requests
+    are created for a specific IoTarget.
+
+Arguments:
+
+    DmfModule - This Module's handle.
+
+Return Value:
+
+    None
+
+--*/
+{
+    DMF_CONTEXT_RequestTarget* moduleContext;
+    RequestTarget_RecycledRequestContext* recycledRequestContext;
+    LIST_ENTRY requestsToDelete;
+    LIST_ENTRY* listEntry;
+
+    moduleContext = DMF_CONTEXT_GET(DmfModule);
+
+    InitializeListHead(&requestsToDelete);
+
+    DMF_ModuleLock(DmfModule);
+
+    moduleContext->IoTargetGeneration++;
+    while (! IsListEmpty(&moduleContext->RecycledRequestList))
+    {
+        listEntry = RemoveHeadList(&moduleContext->RecycledRequestList);
+        InsertTailList(&requestsToDelete,
+                       listEntry);
+        moduleContext->RequestPoolStatistics.RequestsAvailable--;
+        moduleContext->RequestPoolStatistics.RequestsDeleted++;
+    }
+    DmfAssert(0 == moduleContext->RequestPoolStatistics.RequestsAvailable);
+
+    DMF_ModuleUnlock(DmfModule);
+
+    while (! IsListEmpty(&requestsToDelete))
+    {
+        listEntry = RemoveHeadList(&requestsToDelete);
+        recycledRequestContext = CONTAINING_RECORD(listEntry,
+                                                   RequestTarget_RecycledRequestContext,
+                                                   ListEntry);
+        WdfObjectDelete(recycledRequestContext->Request);
+    }
+}
+
 VOID
 RequestTarget_ProcessAsynchronousRequestRoot(
     _In_ DMFMODULE DmfModule,
@@ -581,7 +929,8 @@ Return Value:
 
     if (! ReuseRequest)
     {
-        WdfObjectDelete(Request);
+        RequestTarget_RecycledRequestPut(DmfModule,
+                                         Request);
     }
 
     // Undo reference taken during asynchronous call.
@@ -1373,6 +1722,7 @@ RequestTarget_RequestCreateAndSend(
 Routine Description:
 
     Creates and sends a synchronous request to the IoTarget given a buffer, IOCTL and other information.
+    The request and its memory objects are taken from the pool of recycled requests when possible.
 
 Arguments:
 
@@ -1400,8 +1750,7 @@ Return Value:
     WDFREQUEST request;
     WDFMEMORY memoryForRequest;
     WDFMEMORY memoryForResponse;
-    WDF_OBJECT_ATTRIBUTES requestAttributes;
-    WDF_OBJECT_ATTRIBUTES memoryAttributes;
+    RequestTarget_RecycledRequestContext* recycledRequestContext;
     WDF_REQUEST_SEND_OPTIONS sendOptions;
     size_t outputBufferSize;
     BOOLEAN requestSendResult;
@@ -1426,40 +1775,34 @@ Return Value:
 
     device = DMF_ParentDeviceGet(DmfModule);
 
-    WDF_OBJECT_ATTRIBUTES_INIT_CONTEXT_TYPE(&requestAttributes,
-                                            UNIQUE_REQUEST);
-    requestAttributes.ParentObject = DmfModule;
-    request = NULL;
-    ntStatus = WdfRequestCreate(&requestAttributes,
-                                moduleContext->IoTarget,
-                                &request);
+    ntStatus = RequestTarget_RecycledRequestGet(DmfModule,
+                                                &request);
     if (! NT_SUCCESS(ntStatus))
     {
         request = NULL;
-        TraceEvents(TRACE_LEVEL_ERROR, DMF_TRACE, "WdfRequestCreate fails: ntStatus=%!STATUS!", ntStatus);
+        TraceEvents(TRACE_LEVEL_ERROR, DMF_TRACE, "RequestTarget_RecycledRequestGet fails: ntStatus=%!STATUS!", ntStatus);
         return ntStatus;
     }
 
     UNIQUE_REQUEST* uniqueRequestId = UniqueRequestContextGet(request);
     dmfRequestIdCancel = 0;
 
-    WDF_OBJECT_ATTRIBUTES_INIT(&memoryAttributes);
-    memoryAttributes.ParentObject = request;
+    recycledRequestContext = RequestTarget_RecycledRequestContextGet(request);
 
     memoryForRequest = NULL;
     if (RequestLength > 0)
     {
         DmfAssert(RequestBuffer != NULL);
-        ntStatus = WdfMemoryCreatePreallocated(&memoryAttributes,
-                                               RequestBuffer,
-                                               RequestLength,
-                                               &memoryForRequest);
+        ntStatus = RequestTarget_RecycledRequestMemoryAssign(request,
+                                                             &recycledRequestContext->MemoryForRequest,
+                                                             RequestBuffer,
+                                                             RequestLength);
         if (! NT_SUCCESS(ntStatus))
         {
-            memoryForRequest = NULL;
-            TraceEvents(TRACE_LEVEL_ERROR, DMF_TRACE, "WdfMemoryCreate fails: ntStatus=%!STATUS!", ntStatus);
+            TraceEvents(TRACE_LEVEL_ERROR, DMF_TRACE, "RequestTarget_RecycledRequestMemoryAssign fails: ntStatus=%!STATUS!", ntStatus);
             goto Exit;
         }
+        memoryForRequest = recycledRequestContext->MemoryForRequest;
     }
 
     memoryForResponse = NULL;
@@ -1469,16 +1812,16 @@ Return Value:
         // 'using uninitialized memory'
         //
         #pragma warning(suppress:6001)
-        ntStatus = WdfMemoryCreatePreallocated(&memoryAttributes,
-                                               ResponseBuffer,
-                                               ResponseLength,
-                                               &memoryForResponse);
+        ntStatus = RequestTarget_RecycledRequestMemoryAssign(request,
+                                                             &recycledRequestContext->MemoryForResponse,
+                                                             ResponseBuffer,
+                                                             ResponseLength);
         if (! NT_SUCCESS(ntStatus))
         {
-            memoryForResponse = NULL;
-            TraceEvents(TRACE_LEVEL_ERROR, DMF_TRACE, "WdfMemoryCreate for position fails: ntStatus=%!STATUS!", ntStatus);
+            TraceEvents(TRACE_LEVEL_ERROR, DMF_TRACE, "RequestTarget_RecycledRequestMemoryAssign fails: ntStatus=%!STATUS!", ntStatus);
             goto Exit;
         }
+        memoryForResponse = recycledRequestContext->MemoryForResponse;
     }
 
     ntStatus = RequestTarget_FormatRequestForRequestType(DmfModule,
@@ -1627,16 +1970,18 @@ Exit:
 
     if (IsSynchronousRequest && request != NULL)
     {
-        // Delete the request if its Synchronous.
+        // Recycle the request if its Synchronous.
         //
-        WdfObjectDelete(request);
+        RequestTarget_RecycledRequestPut(DmfModule,
+                                         request);
         request = NULL;
     }
     else if (! IsSynchronousRequest && ! NT_SUCCESS(ntStatus) && request != NULL)
     {
-        // Delete the request if Asynchronous request failed.
+        // Recycle the request if Asynchronous request failed.
         //
-        WdfObjectDelete(request);
+        RequestTarget_RecycledRequestPut(DmfModule,
+                                         request);
         request = NULL;
     }
 
@@ -1821,6 +2166,8 @@ Return Value:
 
     moduleContext = DMF_CONTEXT_GET(DmfModule);
 
+    InitializeListHead(&moduleContext->RecycledRequestList);
+
     WDF_OBJECT_ATTRIBUTES_INIT(&objectAttributes);
     objectAttributes.ParentObject = DmfModule;
     ntStatus = WdfCollectionCreate(&objectAttributes,
@@ -1926,6 +2273,9 @@ Return Value:
         moduleContext->PendingReuseRequests = NULL;
     }
 
+    RequestTarget_RecycledRequestsFlush(DmfModule);
+    DmfAssert(0 == moduleContext->RequestsInUse);
+
     FuncExitVoid(DMF_TRACE);
 }
 #pragma code_seg()
@@ -2114,6 +2464,10 @@ Return Value:
 
     moduleContext->IoTarget = NULL;
 
+    // Recycled requests were created for the IoTarget that is cleared.
+    //
+    RequestTarget_RecycledRequestsFlush(DmfModule);
+
     DMF_ModuleDereference(DmfModule);
 
 Exit:
@@ -2164,6 +2518,10 @@ Return Value:
 
     moduleContext->IoTarget = IoTarget;
 
+    // Recycled requests may have been created for a previous IoTarget.
+    //
+    RequestTarget_RecycledRequestsFlush(DmfModule);
+
     DMF_ModuleDereference(DmfModule);
 
 Exit:
@@ -2171,6 +2529,45 @@ Exit:
     FuncExitVoid(DMF_TRACE);
 }
 
+_IRQL_requires_max_(DISPATCH_LEVEL)
+VOID
+DMF_RequestTarget_RequestPoolStatisticsGet(
+    _In_ DMFMODULE DmfModule,
+    _Out_ RequestTarget_RequestPoolStatistics* RequestPoolStatistics
+    )
+/*++
+
+Routine Description:
+
+    Returns the statistics of the pool of recycled requests used by the single request Methods.
+
+Arguments:
+
+    DmfModule - This Module's handle.
+    RequestPoolStatistics - Returns the statistics.
+
+Return Value:
+
+    None
+
+--*/
+{
+    DMF_CONTEXT_RequestTarget* moduleContext;
+
+    FuncEntry(DMF_TRACE);
+
+    DMFMODULE_VALIDATE_IN_METHOD(DmfModule,
+                                 RequestTarget);
+
+    moduleContext = DMF_CONTEXT_GET(DmfModule);
+
+    DMF_ModuleLock(DmfModule);
+    *RequestPoolStatistics = moduleContext->RequestPoolStatistics;
+    DMF_ModuleUnlock(DmfModule);
+
+    FuncExitVoid(DMF_TRACE);
+}
+
 _IRQL_requires_max_(DISPATCH_LEVEL)
 _Must_inspect_result_
 NTSTATUS
@@ -57,6 +57,27 @@ EVT_DMF_RequestTarget_SendCompletion(_In_ DMFMODULE DmfModule,
                                      _In_ size_t OutputBufferBytesRead,
                                      _In_ NTSTATUS CompletionStatus);
 
+// Statistics of the pool of WDFREQUESTs the single request Methods draw from.
+//
+typedef struct
+{
+    // Number of WDFREQUESTs created because the pool was empty.
+    //
+    ULONG64 RequestsCreated;
+    // Number of sends that used a WDFREQUEST from the pool.
+    //
+    ULONG64 RequestsRecycled;
+    // Number of completed WDFREQUESTs deleted instead of returned to the pool.
+    //
+    ULONG64 RequestsDeleted;
+    // Number of WDFREQUESTs currently in the pool.
+    //
+    ULONG RequestsAvailable;
+    // Largest number of WDFREQUESTs that were in use at the same time.
+    //
+    ULONG MaximumRequestsInUse;
+} RequestTarget_RequestPoolStatistics;
+
 // This macro declares the following functions:
 // DMF_RequestTarget_ATTRIBUTES_INIT()
 // DMF_CONFIG_RequestTarget_AND_ATTRIBUTES_INIT()
@@ -88,6 +109,13 @@ DMF_RequestTarget_IoTargetSet(
     _In_ WDFIOTARGET IoTarget
     );
 
+_IRQL_requires_max_(DISPATCH_LEVEL)
+VOID
+DMF_RequestTarget_RequestPoolStatisticsGet(
+    _In_ DMFMODULE DmfModule,
+    _Out_ RequestTarget_RequestPoolStatistics* RequestPoolStatistics
+    );
+
 _IRQL_requires_max_(DISPATCH_LEVEL)
 _Must_inspect_result_
 NTSTATUS
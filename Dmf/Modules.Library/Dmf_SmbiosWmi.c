@@ -33,6 +33,28 @@ Environment:
 ///////////////////////////////////////////////////////////////////////////////////////////////////////
 //
 
+// Number of possible SMBIOS structure types.
+//
+#define SmbiosWmi_NumberOfTypes                 (256)
+
+// Location of a single structure in the raw SMBIOS table.
+//
+typedef struct
+{
+    // Offset of the formatted area from the start of the structures.
+    //
+    ULONG Offset;
+    // Position of the first string of this structure in the string table.
+    //
+    ULONG FirstString;
+    // Number of strings in this structure's string set.
+    //
+    ULONG NumberOfStrings;
+    USHORT Handle;
+    UCHAR Type;
+    UCHAR Length;
+} SmbiosWmi_IndexEntry;
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////////
 // Module Private Context
 ///////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -68,6 +90,34 @@ typedef struct _DMF_CONTEXT_SmbiosWmi
     // Size of the raw SMBIOS table (including WMI header).
     //
     ULONG SmbiosTableDataSizeIncludesWmiContainer;
+
+    // Start of the first SMBIOS structure and the size of all structures
+    // (without any header that precedes them).
+    //
+    UCHAR* StructureData;
+    ULONG StructureDataSize;
+
+    // Index of all the structures built once when the Module opens.
+    // Entries are sorted by type. Structures of the same type are in table order.
+    //
+    WDFMEMORY MemoryIndexEntries;
+    SmbiosWmi_IndexEntry* IndexEntries;
+    ULONG NumberOfIndexEntries;
+    // Position of the first entry of each type in IndexEntries and the number of entries of each type.
+    //
+    ULONG TypeFirstEntry[SmbiosWmi_NumberOfTypes];
+    ULONG TypeNumberOfEntries[SmbiosWmi_NumberOfTypes];
+    // Open addressing hash table of structure handles. Each slot holds the position in
+    // IndexEntries plus one. Zero means the slot is empty.
+    //
+    WDFMEMORY MemoryHandleSlots;
+    ULONG* HandleSlots;
+    ULONG NumberOfHandleSlots;
+    // Address of each string of each structure (pre-resolved).
+    //
+    WDFMEMORY MemoryStrings;
+    CHAR** Strings;
+    ULONG NumberOfStrings;
 } DMF_CONTEXT_SmbiosWmi;
 
 // This macro declares the following function:
@@ -366,6 +416,382 @@ Exit:
     return ntStatus;
 }
 
+// Size of Type, Length and Handle which all structures start with.
+//
+#define SmbiosWmi_StructureHeaderSize       (sizeof(UCHAR) + sizeof(UCHAR) + sizeof(USHORT))
+
+_Must_inspect_result_
+BOOLEAN
+SmbiosWmi_StructureParse(
+    _In_ UCHAR* StructureData,
+    _In_ UCHAR* EndPointer,
+    _Out_writes_opt_(*NumberOfStrings) CHAR** Strings,
+    _Out_ ULONG* NumberOfStrings,
+    _Out_ UCHAR** NextStructureData
+    )
+/*++
+
+Routine Description:
+
+    Parse a single SMBIOS structure: its formatted area and its string set.
+    This function only reads the given buffer so it can be used with captured SMBIOS tables.
+
+Arguments:
+
+    StructureData - Start of the structure's formatted area.
+    EndPointer - The end of the SMBIOS data buffer.
+    Strings - Optional. If set, the address of each string is written here. It must be large
+              enough for the number of strings returned by a previous call without Strings.
+    NumberOfStrings - Number of strings in the structure's string set.
+    NextStructureData - Start of the next structure.
+
+Return Value:
+
+    TRUE if the structure is well formed.
+    FALSE if the structure does not fit in the buffer or its string set is not terminated.
+
+--*/
+{
+    SMBIOS_TABLE_HEADER* smbiosTableHeader;
+    UCHAR* stringData;
+    ULONG numberOfStrings;
+    BOOLEAN returnValue;
+
+    returnValue = FALSE;
+    numberOfStrings = 0;
+    *NumberOfStrings = 0;
+    *NextStructureData = EndPointer;
+
+    if (StructureData + SmbiosWmi_StructureHeaderSize > EndPointer)
+    {
+        goto Exit;
+    }
+
+    smbiosTableHeader = (SMBIOS_TABLE_HEADER*)StructureData;
+    if ((smbiosTableHeader->Length < SmbiosWmi_StructureHeaderSize) ||
+        (StructureData + smbiosTableHeader->Length > EndPointer))
+    {
+        goto Exit;
+    }
+
+    // The string set follows the formatted area and ends with a double null.
+    // A structure with no strings has just the double null.
+    //
+    stringData = StructureData + smbiosTableHeader->Length;
+    if (stringData + 1 >= EndPointer)
+    {
+        goto Exit;
+    }
+
+    if (0 == *stringData)
+    {
+        // The byte after the first null is in the buffer (checked above) and must also be
+        // null. Otherwise, the formatted area's Length is wrong.
+        //
+        if (stringData[1] != 0)
+        {
+            goto Exit;
+        }
+        stringData += 2;
+    }
+    else
+    {
+        for (;;)
+        {
+            if (Strings != NULL)
+            {
+                Strings[numberOfStrings] = (CHAR*)stringData;
+            }
+            numberOfStrings++;
+
+            while ((stringData < EndPointer) &&
+                   (*stringData != 0))
+            {
+                stringData++;
+            }
+
+            if (stringData + 1 >= EndPointer)
+            {
+                goto Exit;
+            }
+
+            // Skip the null that terminates this string.
+            //
+            stringData++;
+            if (0 == *stringData)
+            {
+                // Double null is the end of the string set.
+                //
+                stringData++;
+                break;
+            }
+        }
+    }
+
+    *NumberOfStrings = numberOfStrings;
+    *NextStructureData = stringData;
+    returnValue = TRUE;
+
+Exit:
+
+    return returnValue;
+}
+
+#pragma code_seg("PAGE")
+_Must_inspect_result_
+NTSTATUS
+SmbiosWmi_IndexBuild(
+    _In_ DMFMODULE DmfModule
+    )
+/*++
+
+Routine Description:
+
+    Build an index of all the SMBIOS structures so that Methods can find any structure by
+    type and instance or by handle, and any of its strings, without walking the table.
+    The table is walked twice: once to count the structures and strings and once to fill
+    the index.
+
+Arguments:
+
+    DmfModule - This Module's handle.
+
+Return Value:
+
+    NTSTATUS
+
+--*/
+{
+    DMF_CONTEXT_SmbiosWmi* moduleContext;
+    NTSTATUS ntStatus;
+    WDF_OBJECT_ATTRIBUTES objectAttributes;
+    UCHAR* dataPointer;
+    UCHAR* endPointer;
+    UCHAR* nextDataPointer;
+    SMBIOS_TABLE_HEADER* smbiosTableHeader;
+    SmbiosWmi_IndexEntry* indexEntry;
+    ULONG numberOfStrings;
+    ULONG numberOfEntriesAdded[SmbiosWmi_NumberOfTypes];
+    ULONG entryIndex;
+    ULONG stringIndex;
+    ULONG typeIndex;
+    ULONG slotIndex;
+    ULONG numberOfStructures;
+
+    PAGED_CODE();
+
+    FuncEntry(DMF_TRACE);
+
+    moduleContext = DMF_CONTEXT_GET(DmfModule);
+    ntStatus = STATUS_SUCCESS;
+
+    dataPointer = moduleContext->StructureData;
+    endPointer = (PUCHAR)OffsetToPointer(dataPointer,
+                                         moduleContext->StructureDataSize);
+
+    // Count the structures of each type and all the strings.
+    //
+    numberOfStructures = 0;
+    while (dataPointer < endPointer)
+    {
+        if (! SmbiosWmi_StructureParse(dataPointer,
+                                       endPointer,
+                                       NULL,
+                                       &numberOfStrings,
+                                       &nextDataPointer))
+        {
+            TraceEvents(TRACE_LEVEL_WARNING, DMF_TRACE, "Malformed structure at offset=%u", (ULONG)(dataPointer - moduleContext->StructureData));
+            break;
+        }
+
+        smbiosTableHeader = (SMBIOS_TABLE_HEADER*)dataPointer;
+        moduleContext->TypeNumberOfEntries[smbiosTableHeader->Type]++;
+        moduleContext->NumberOfStrings += numberOfStrings;
+        numberOfStructures++;
+
+        dataPointer = nextDataPointer;
+        if (SMBIOS_TABLE_127 == smbiosTableHeader->Type)
+        {
+            break;
+        }
+    }
+
+    if (0 == numberOfStructures)
+    {
+        TraceEvents(TRACE_LEVEL_WARNING, DMF_TRACE, "No SMBIOS structures found");
+        goto Exit;
+    }
+
+    WDF_OBJECT_ATTRIBUTES_INIT(&objectAttributes);
+    objectAttributes.ParentObject = DmfModule;
+    ntStatus = WdfMemoryCreate(&objectAttributes,
+                               NonPagedPoolNx,
+                               MemoryTag,
+                               numberOfStructures * sizeof(SmbiosWmi_IndexEntry),
+                               &moduleContext->MemoryIndexEntries,
+                               (VOID**)&moduleContext->IndexEntries);
+    if (!NT_SUCCESS(ntStatus))
+    {
+        TraceEvents(TRACE_LEVEL_ERROR, DMF_TRACE, "WdfMemoryCreate ntStatus=%!STATUS!", ntStatus);
+        goto Exit;
+    }
+
+    // Use at least twice as many slots as handles (rounded to a power of two) so probe sequences are short.
+    //
+    moduleContext->NumberOfHandleSlots = 16;
+    while (moduleContext->NumberOfHandleSlots < 2 * numberOfStructures)
+    {
+        moduleContext->NumberOfHandleSlots *= 2;
+    }
+    ntStatus = WdfMemoryCreate(&objectAttributes,
+                               NonPagedPoolNx,
+                               MemoryTag,
+                               moduleContext->NumberOfHandleSlots * sizeof(ULONG),
+                               &moduleContext->MemoryHandleSlots,
+                               (VOID**)&moduleContext->HandleSlots);
+    if (!NT_SUCCESS(ntStatus))
+    {
+        TraceEvents(TRACE_LEVEL_ERROR, DMF_TRACE, "WdfMemoryCreate ntStatus=%!STATUS!", ntStatus);
+        goto Exit;
+    }
+    RtlZeroMemory(moduleContext->HandleSlots,
+                  moduleContext->NumberOfHandleSlots * sizeof(ULONG));
+
+    if (moduleContext->NumberOfStrings > 0)
+    {
+        ntStatus = WdfMemoryCreate(&objectAttributes,
+                                   NonPagedPoolNx,
+                                   MemoryTag,
+                                   moduleContext->NumberOfStrings * sizeof(CHAR*),
+                                   &moduleContext->MemoryStrings,
+                                   (VOID**)&moduleContext->Strings);
+        if (!NT_SUCCESS(ntStatus))
+        {
+            TraceEvents(TRACE_LEVEL_ERROR, DMF_TRACE, "WdfMemoryCreate ntStatus=%!STATUS!", ntStatus);
+            goto Exit;
+        }
+    }
+
+    // Entries of each type start after the entries of all the lower types.
+    //
+    entryIndex = 0;
+    for (typeIndex = 0; typeIndex < SmbiosWmi_NumberOfTypes; typeIndex++)
+    {
+        moduleContext->TypeFirstEntry[typeIndex] = entryIndex;
+        entryIndex += moduleContext->TypeNumberOfEntries[typeIndex];
+        numberOfEntriesAdded[typeIndex] = 0;
+    }
+
+    // Fill the index. The same structures that were counted above are parsed again.
+    //
+    dataPointer = moduleContext->StructureData;
+    stringIndex = 0;
+    for (ULONG structureIndex = 0; structureIndex < numberOfStructures; structureIndex++)
+    {
+        if (! SmbiosWmi_StructureParse(dataPointer,
+                                       endPointer,
+                                       (moduleContext->Strings != NULL) ? &moduleContext->Strings[stringIndex] : NULL,
+                                       &numberOfStrings,
+                                       &nextDataPointer))
+        {
+            DmfAssert(FALSE);
+            ntStatus = STATUS_INTERNAL_ERROR;
+            goto Exit;
+        }
+
+        smbiosTableHeader = (SMBIOS_TABLE_HEADER*)dataPointer;
+        entryIndex = moduleContext->TypeFirstEntry[smbiosTableHeader->Type] + numberOfEntriesAdded[smbiosTableHeader->Type];
+        numberOfEntriesAdded[smbiosTableHeader->Type]++;
+
+        indexEntry = &moduleContext->IndexEntries[entryIndex];
+        indexEntry->Offset = (ULONG)(dataPointer - moduleContext->StructureData);
+        indexEntry->FirstString = stringIndex;
+        indexEntry->NumberOfStrings = numberOfStrings;
+        indexEntry->Handle = smbiosTableHeader->Handle;
+        indexEntry->Type = smbiosTableHeader->Type;
+        indexEntry->Length = smbiosTableHeader->Length;
+        stringIndex += numberOfStrings;
+
+        // Add the handle to the hash table (linear probing). If a handle appears twice,
+        // the first structure with that handle is found.
+        //
+        slotIndex = smbiosTableHeader->Handle & (moduleContext->NumberOfHandleSlots - 1);
+        while (moduleContext->HandleSlots[slotIndex] != 0)
+        {
+            if (moduleContext->IndexEntries[moduleContext->HandleSlots[slotIndex] - 1].Handle == smbiosTableHeader->Handle)
+            {
+                break;
+            }
+            slotIndex = (slotIndex + 1) & (moduleContext->NumberOfHandleSlots - 1);
+        }
+        if (0 == moduleContext->HandleSlots[slotIndex])
+        {
+            moduleContext->HandleSlots[slotIndex] = entryIndex + 1;
+        }
+
+        dataPointer = nextDataPointer;
+    }
+
+    moduleContext->NumberOfIndexEntries = numberOfStructures;
+
+    TraceEvents(TRACE_LEVEL_INFORMATION, DMF_TRACE, "SMBIOS index built: NumberOfIndexEntries=%u NumberOfStrings=%u",
+                moduleContext->NumberOfIndexEntries,
+                moduleContext->NumberOfStrings);
+
+Exit:
+
+    FuncExit(DMF_TRACE, "ntStatus=%!STATUS!", ntStatus);
+
+    return ntStatus;
+}
+#pragma code_seg()
+
+VOID
+SmbiosWmi_StructureFromEntry(
+    _In_ DMF_CONTEXT_SmbiosWmi* ModuleContext,
+    _In_ ULONG EntryIndex,
+    _Out_ SmbiosWmi_Structure* Structure
+    )
+/*++
+
+Routine Description:
+
+    Describe a structure in the index for a Client. The returned pointers point into this Module's table.
+
+Arguments:
+
+    ModuleContext - This Module's context.
+    EntryIndex - Position of the structure in IndexEntries.
+    Structure - The description of the structure is written here.
+
+Return Value:
+
+    None
+
+--*/
+{
+    SmbiosWmi_IndexEntry* indexEntry;
+
+    DmfAssert(EntryIndex < ModuleContext->NumberOfIndexEntries);
+
+    indexEntry = &ModuleContext->IndexEntries[EntryIndex];
+
+    Structure->Type = indexEntry->Type;
+    Structure->Handle = indexEntry->Handle;
+    Structure->FormattedArea = OffsetToPointer(ModuleContext->StructureData,
+                                               indexEntry->Offset);
+    Structure->FormattedAreaSize = indexEntry->Length;
+    Structure->NumberOfStrings = indexEntry->NumberOfStrings;
+    if (indexEntry->NumberOfStrings > 0)
+    {
+        Structure->Strings = &ModuleContext->Strings[indexEntry->FirstString];
+    }
+    else
+    {
+        Structure->Strings = NULL;
+    }
+}
+
 #if !defined(DMF_USER_MODE)
 
 #pragma code_seg("PAGE")
@@ -496,6 +922,9 @@ Return Value:
     //
     moduleContext->SmbiosTableData = (PUCHAR)rawSmbiosHeader->SMBIOSTableData;
     moduleContext->SmbiosTableDataSize = smbiosLength;
+    moduleContext->StructureData = (PUCHAR)rawSmbiosHeader->SMBIOSTableData;
+    moduleContext->StructureDataSize = min(rawSmbiosHeader->Length,
+                                           (ULONG)(smbiosLength - FIELD_OFFSET(RAW_SMBIOS_HEADER, SMBIOSTableData)));
     // For legacy support.
     //
     moduleContext->SmbiosTableDataSizeIncludesWmiContainer = bufferSize;
@@ -611,6 +1040,18 @@ Return Value:
     // It means the table was read successfully.
     // 
     moduleContext->SmbiosTableDataSize = neededBufferSize;
+
+    // The structures follow the header returned by GetSystemFirmwareTable().
+    //
+    if (neededBufferSize >= FIELD_OFFSET(RAW_SMBIOS_HEADER, SMBIOSTableData))
+    {
+        RAW_SMBIOS_HEADER* rawSmbiosHeader;
+
+        rawSmbiosHeader = (RAW_SMBIOS_HEADER*)moduleContext->SmbiosTableData;
+        moduleContext->StructureData = (PUCHAR)rawSmbiosHeader->SMBIOSTableData;
+        moduleContext->StructureDataSize = min(rawSmbiosHeader->Length,
+                                               (ULONG)(neededBufferSize - FIELD_OFFSET(RAW_SMBIOS_HEADER, SMBIOSTableData)));
+    }
     TraceEvents(TRACE_LEVEL_INFORMATION, DMF_TRACE, "SMBIOS Tables Read successfully: SmbiosTableDataSize=%u", moduleContext->SmbiosTableDataSize);
     ntStatus = STATUS_SUCCESS;
 
@@ -678,6 +1119,14 @@ Return Value:
     // later use by Methods.
     //
     ntStatus = SmbioWmi_TablesSet(DmfModule);
+    if (!NT_SUCCESS(ntStatus))
+    {
+        goto Exit;
+    }
+
+    // Index all the structures so that Methods do not need to walk the table.
+    //
+    ntStatus = SmbiosWmi_IndexBuild(DmfModule);
 
 Exit:
 
@@ -1032,5 +1481,229 @@ Return Value:
     *TargetBufferSize = moduleContext->SmbiosTableDataSize;
 }
 
+_Must_inspect_result_
+NTSTATUS
+DMF_SmbiosWmi_StringGet(
+    _In_ DMFMODULE DmfModule,
+    _In_ UCHAR Type,
+    _In_ ULONG Instance,
+    _In_ UCHAR StringNumber,
+    _Out_ CHAR** String
+    )
+/*++
+
+Routine Description:
+
+    Get a string of an SMBIOS structure given the structure's type and instance.
+    The string is not copied.
+    NOTE: The returned string points to memory that is private to the Module.
+
+Arguments:
+
+    DmfModule - This Module's handle.
+    Type - SMBIOS structure type.
+    Instance - Zero based instance of the structure among structures of the same type (in table order).
+    StringNumber - The string number as it appears in the structure's formatted area (one based).
+    String - The address of the null-terminated string is written here.
+
+Return Value:
+
+    STATUS_SUCCESS if the string is present.
+    STATUS_NOT_FOUND if the structure or the string is not present.
+
+--*/
+{
+    NTSTATUS ntStatus;
+    DMF_CONTEXT_SmbiosWmi* moduleContext;
+    SmbiosWmi_IndexEntry* indexEntry;
+
+    DMFMODULE_VALIDATE_IN_METHOD(DmfModule,
+                                 SmbiosWmi);
+
+    moduleContext = DMF_CONTEXT_GET(DmfModule);
+
+    *String = NULL;
+
+    if (Instance >= moduleContext->TypeNumberOfEntries[Type])
+    {
+        ntStatus = STATUS_NOT_FOUND;
+        goto Exit;
+    }
+
+    indexEntry = &moduleContext->IndexEntries[moduleContext->TypeFirstEntry[Type] + Instance];
+    if ((0 == StringNumber) ||
+        (StringNumber > indexEntry->NumberOfStrings))
+    {
+        // Zero means the structure does not have this string.
+        //
+        ntStatus = STATUS_NOT_FOUND;
+        goto Exit;
+    }
+
+    *String = moduleContext->Strings[indexEntry->FirstString + StringNumber - 1];
+    ntStatus = STATUS_SUCCESS;
+
+Exit:
+
+    return ntStatus;
+}
+
+_Must_inspect_result_
+NTSTATUS
+DMF_SmbiosWmi_StructureByHandleGet(
+    _In_ DMFMODULE DmfModule,
+    _In_ USHORT Handle,
+    _Out_ SmbiosWmi_Structure* Structure
+    )
+/*++
+
+Routine Description:
+
+    Get an SMBIOS structure given its handle. The structure is not copied.
+    NOTE: The pointers in the structure point to memory that is private to the Module.
+
+Arguments:
+
+    DmfModule - This Module's handle.
+    Handle - The handle of the structure.
+    Structure - The description of the structure is written here.
+
+Return Value:
+
+    STATUS_SUCCESS if the structure is present.
+    STATUS_NOT_FOUND if the structure is not present.
+
+--*/
+{
+    NTSTATUS ntStatus;
+    DMF_CONTEXT_SmbiosWmi* moduleContext;
+    ULONG slotIndex;
+    ULONG entryIndex;
+
+    DMFMODULE_VALIDATE_IN_METHOD(DmfModule,
+                                 SmbiosWmi);
+
+    moduleContext = DMF_CONTEXT_GET(DmfModule);
+
+    RtlZeroMemory(Structure,
+                  sizeof(SmbiosWmi_Structure));
+    ntStatus = STATUS_NOT_FOUND;
+
+    if (0 == moduleContext->NumberOfHandleSlots)
+    {
+        goto Exit;
+    }
+
+    // There is always at least one empty slot so the probe ends.
+    //
+    slotIndex = Handle & (moduleContext->NumberOfHandleSlots - 1);
+    while (moduleContext->HandleSlots[slotIndex] != 0)
+    {
+        entryIndex = moduleContext->HandleSlots[slotIndex] - 1;
+        if (moduleContext->IndexEntries[entryIndex].Handle == Handle)
+        {
+            SmbiosWmi_StructureFromEntry(moduleContext,
+                                         entryIndex,
+                                         Structure);
+            ntStatus = STATUS_SUCCESS;
+            break;
+        }
+        slotIndex = (slotIndex + 1) & (moduleContext->NumberOfHandleSlots - 1);
+    }
+
+Exit:
+
+    return ntStatus;
+}
+
+VOID
+DMF_SmbiosWmi_StructureCountGet(
+    _In_ DMFMODULE DmfModule,
+    _In_ UCHAR Type,
+    _Out_ ULONG* NumberOfStructures
+    )
+/*++
+
+Routine Description:
+
+    Get the number of SMBIOS structures of a given type.
+
+Arguments:
+
+    DmfModule - This Module's handle.
+    Type - SMBIOS structure type.
+    NumberOfStructures - The number of structures of the given type is written here.
+
+Return Value:
+
+    None
+
+--*/
+{
+    DMF_CONTEXT_SmbiosWmi* moduleContext;
+
+    DMFMODULE_VALIDATE_IN_METHOD(DmfModule,
+                                 SmbiosWmi);
+
+    moduleContext = DMF_CONTEXT_GET(DmfModule);
+
+    *NumberOfStructures = moduleContext->TypeNumberOfEntries[Type];
+}
+
+_Must_inspect_result_
+NTSTATUS
+DMF_SmbiosWmi_StructureGet(
+    _In_ DMFMODULE DmfModule,
+    _In_ UCHAR Type,
+    _In_ ULONG Instance,
+    _Out_ SmbiosWmi_Structure* Structure
+    )
+/*++
+
+Routine Description:
+
+    Get an SMBIOS structure given its type and instance. The structure is not copied.
+    NOTE: The pointers in the structure point to memory that is private to the Module.
+
+Arguments:
+
+    DmfModule - This Module's handle.
+    Type - SMBIOS structure type.
+    Instance - Zero based instance of the structure among structures of the same type (in table order).
+    Structure - The description of the structure is written here.
+
+Return Value:
+
+    STATUS_SUCCESS if the structure is present.
+    STATUS_NOT_FOUND if the structure is not present.
+
+--*/
+{
+    NTSTATUS ntStatus;
+    DMF_CONTEXT_SmbiosWmi* moduleContext;
+
+    DMFMODULE_VALIDATE_IN_METHOD(DmfModule,
+                                 SmbiosWmi);
+
+    moduleContext = DMF_CONTEXT_GET(DmfModule);
+
+    if (Instance >= moduleContext->TypeNumberOfEntries[Type])
+    {
+        RtlZeroMemory(Structure,
+                      sizeof(SmbiosWmi_Structure));
+        ntStatus = STATUS_NOT_FOUND;
+        goto Exit;
+    }
+
+    SmbiosWmi_StructureFromEntry(moduleContext,
+                                 moduleContext->TypeFirstEntry[Type] + Instance,
+                                 Structure);
+    ntStatus = STATUS_SUCCESS;
+
+Exit:
+
+    return ntStatus;
+}
+
 // eof: Dmf_SmbiosWmi.c
 //
@@ -41,6 +41,26 @@ typedef struct
     CHAR* Family;
 } SmbiosWmi_TableType01;
 
+// Any SMBIOS structure as it appears in the raw table.
+// The pointers point to memory that is private to the Module. Clients must not modify it.
+//
+typedef struct
+{
+    // Structure type and handle.
+    //
+    UCHAR Type;
+    USHORT Handle;
+    // Formatted area of the structure (starting with its Type, Length and Handle).
+    //
+    UCHAR* FormattedArea;
+    UCHAR FormattedAreaSize;
+    // Strings of the structure. The string number N used in the formatted area is Strings[N - 1].
+    // NULL if the structure has no strings.
+    //
+    CHAR** Strings;
+    ULONG NumberOfStrings;
+} SmbiosWmi_Structure;
+
 // This macro declares the following functions:
 // DMF_SmbiosWmi_ATTRIBUTES_INIT()
 // DMF_SmbiosWmi_Create()
@@ -96,5 +116,39 @@ DMF_SmbiosWmi_TableInformationGetEx(
     _Out_ size_t* TargetBufferSize
     );
 
+_Must_inspect_result_
+NTSTATUS
+DMF_SmbiosWmi_StringGet(
+    _In_ DMFMODULE DmfModule,
+    _In_ UCHAR Type,
+    _In_ ULONG Instance,
+    _In_ UCHAR StringNumber,
+    _Out_ CHAR** String
+    );
+
+_Must_inspect_result_
+NTSTATUS
+DMF_SmbiosWmi_StructureByHandleGet(
+    _In_ DMFMODULE DmfModule,
+    _In_ USHORT Handle,
+    _Out_ SmbiosWmi_Structure* Structure
+    );
+
+VOID
+DMF_SmbiosWmi_StructureCountGet(
+    _In_ DMFMODULE DmfModule,
+    _In_ UCHAR Type,
+    _Out_ ULONG* NumberOfStructures
+    );
+
+_Must_inspect_result_
+NTSTATUS
+DMF_SmbiosWmi_StructureGet(
+    _In_ DMFMODULE DmfModule,
+    _In_ UCHAR Type,
+    _In_ ULONG Instance,
+    _Out_ SmbiosWmi_Structure* Structure
+    );
+
 // eof: Dmf_SmbiosWmi.h
 //
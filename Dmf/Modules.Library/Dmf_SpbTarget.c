@@ -39,6 +39,29 @@ Environment:
 #include <reshub.h>
 #include <spb.h>
 
+// Number of SPB transfers needed to send the largest batch of write/read pairs.
+//
+#define SpbTarget_MaximumNumberOfTransfers                          (2 * SpbTarget_MaximumNumberOfWriteReads)
+
+// Number of asynchronous transfer contexts allocated up front. More are allocated
+// from the look-aside list if more transfers are pending.
+//
+#define SpbTarget_NumberOfAsynchronousContexts                      4
+
+// Context of a pending asynchronous transfer. The SPB sequence is stored here
+// because it must remain valid until the transfer completes.
+//
+typedef struct
+{
+    // Client's callback and its context.
+    //
+    EVT_DMF_SpbTarget_SendCompletion* EvtSpbTargetSendCompletion;
+    VOID* ClientContext;
+    // SPB sequence sent to the SPB controller.
+    //
+    SPB_TRANSFER_LIST_AND_ENTRIES(SpbTarget_MaximumNumberOfTransfers) Sequence;
+} SpbTarget_AsynchronousContext;
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////////
 // Module Private Context
 ///////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -75,6 +98,10 @@ typedef struct _DMF_CONTEXT_SpbTarget
     //
     DMFMODULE DmfModuleInterruptResource;
 
+    // Contexts of pending asynchronous transfers.
+    //
+    DMFMODULE DmfModuleBufferPoolAsynchronousContext;
+
     // Optional Callback from ISR (with Interrupt Spin Lock held).
     //
     EVT_DMF_InterruptResource_InterruptIsr* EvtSpbTargetInterruptIsr;
@@ -254,6 +281,236 @@ Return Value:
     return ntStatus;
 }
 
+EVT_DMF_RequestTarget_SendCompletion SpbTarget_AsynchronousSendCompletion;
+
+_Function_class_(EVT_DMF_RequestTarget_SendCompletion)
+_IRQL_requires_max_(DISPATCH_LEVEL)
+_IRQL_requires_same_
+VOID
+SpbTarget_AsynchronousSendCompletion(
+    _In_ DMFMODULE DmfModule,
+    _In_ VOID* ClientRequestContext,
+    _In_reads_(InputBufferBytesWritten) VOID* InputBuffer,
+    _In_ size_t InputBufferBytesWritten,
+    _In_reads_(OutputBufferBytesRead) VOID* OutputBuffer,
+    _In_ size_t OutputBufferBytesRead,
+    _In_ NTSTATUS CompletionStatus
+    )
+/*++
+
+Routine Description:
+
+    Called by the Child RequestTarget Module when an asynchronous SPB sequence completes.
+    Returns the transfer's context and calls the Client's callback.
+
+Arguments:
+
+    DmfModule - The Child RequestTarget Module's handle.
+    ClientRequestContext - The transfer's context.
+    InputBuffer - The SPB sequence that was sent.
+    InputBufferBytesWritten - Size of the SPB sequence.
+    OutputBuffer - Not used.
+    OutputBufferBytesRead - Not used.
+    CompletionStatus - Status of the SPB sequence.
+
+Return Value:
+
+    None
+
+--*/
+{
+    DMFMODULE dmfModule;
+    DMF_CONTEXT_SpbTarget* moduleContext;
+    SpbTarget_AsynchronousContext* asynchronousContext;
+    EVT_DMF_SpbTarget_SendCompletion* evtSpbTargetSendCompletion;
+    VOID* clientContext;
+
+    UNREFERENCED_PARAMETER(InputBuffer);
+    UNREFERENCED_PARAMETER(InputBufferBytesWritten);
+    UNREFERENCED_PARAMETER(OutputBuffer);
+    UNREFERENCED_PARAMETER(OutputBufferBytesRead);
+
+    FuncEntry(DMF_TRACE);
+
+    dmfModule = DMF_ParentModuleGet(DmfModule);
+    moduleContext = DMF_CONTEXT_GET(dmfModule);
+
+    asynchronousContext = (SpbTarget_AsynchronousContext*)ClientRequestContext;
+    evtSpbTargetSendCompletion = asynchronousContext->EvtSpbTargetSendCompletion;
+    clientContext = asynchronousContext->ClientContext;
+
+    // Return the context before calling the Client so that the Client can send
+    // the next transfer from its callback without growing the pool.
+    //
+    DMF_BufferPool_Put(moduleContext->DmfModuleBufferPoolAsynchronousContext,
+                       asynchronousContext);
+    asynchronousContext = NULL;
+
+    if (evtSpbTargetSendCompletion != NULL)
+    {
+        evtSpbTargetSendCompletion(dmfModule,
+                                   clientContext,
+                                   CompletionStatus);
+    }
+
+    FuncExit(DMF_TRACE, "CompletionStatus=%!STATUS!", CompletionStatus);
+}
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+_Must_inspect_result_
+static
+NTSTATUS
+SpbTarget_WriteReadsSend(
+    _In_ DMFMODULE DmfModule,
+    _In_reads_(NumberOfWriteReads) SpbTarget_WriteRead* WriteReads,
+    _In_ ULONG NumberOfWriteReads,
+    _In_ ULONG RequestTimeoutMilliseconds,
+    _In_opt_ EVT_DMF_SpbTarget_SendCompletion* EvtSpbTargetSendCompletion,
+    _In_opt_ VOID* ClientContext
+    )
+/*++
+
+Routine Description:
+
+    Packs the given write/read pairs into a single SPB sequence and sends it to the SPB
+    controller asynchronously. The given callback is called once when the whole
+    sequence completes.
+
+Arguments:
+
+    DmfModule - This Module's Module handle.
+    WriteReads - The given write/read pairs.
+    NumberOfWriteReads - Number of entries in WriteReads.
+    RequestTimeoutMilliseconds - Timeout in milliseconds.
+    EvtSpbTargetSendCompletion - Client callback called when the sequence completes.
+    ClientContext - Client context passed to EvtSpbTargetSendCompletion.
+
+Return Value:
+
+    STATUS_SUCCESS if the sequence was sent. EvtSpbTargetSendCompletion is called only in this case.
+    Otherwise, NTSTATUS of the failure.
+
+--*/
+{
+    NTSTATUS ntStatus;
+    DMF_CONTEXT_SpbTarget* moduleContext;
+    SpbTarget_AsynchronousContext* asynchronousContext;
+    SPB_TRANSFER_LIST_ENTRY* transfers;
+    ULONG transferCount;
+    ULONG writeReadIndex;
+    size_t sequenceLength;
+
+    FuncEntry(DMF_TRACE);
+
+    moduleContext = DMF_CONTEXT_GET(DmfModule);
+
+    asynchronousContext = NULL;
+
+    if ((0 == NumberOfWriteReads) ||
+        (NumberOfWriteReads > SpbTarget_MaximumNumberOfWriteReads))
+    {
+        ntStatus = STATUS_INVALID_PARAMETER;
+        TraceEvents(TRACE_LEVEL_ERROR, DMF_TRACE, "Invalid NumberOfWriteReads=%d", NumberOfWriteReads);
+        goto Exit;
+    }
+
+    if (! moduleContext->SpbConnectionAssigned)
+    {
+        ntStatus = STATUS_DEVICE_NOT_CONNECTED;
+        TraceEvents(TRACE_LEVEL_ERROR, DMF_TRACE, "No SPB Resources Found");
+        goto Exit;
+    }
+
+    ntStatus = DMF_BufferPool_Get(moduleContext->DmfModuleBufferPoolAsynchronousContext,
+                                  (VOID**)&asynchronousContext,
+                                  NULL);
+    if (! NT_SUCCESS(ntStatus))
+    {
+        TraceEvents(TRACE_LEVEL_ERROR, DMF_TRACE, "DMF_BufferPool_Get fails: ntStatus=%!STATUS!", ntStatus);
+        asynchronousContext = NULL;
+        goto Exit;
+    }
+
+    // Build SPB sequence. Zero length buffers do not generate a transfer.
+    //
+    // PreFAST cannot figure out the SPB_TRANSFER_LIST_ENTRY
+    // "struct hack" size but using a pointer to the entries quiets
+    // the warning. The size of the sequence is validated above.
+    //
+    transfers = asynchronousContext->Sequence.List.Transfers;
+    transferCount = 0;
+    for (writeReadIndex = 0; writeReadIndex < NumberOfWriteReads; writeReadIndex++)
+    {
+        if (WriteReads[writeReadIndex].WriteBufferLength > 0)
+        {
+            DmfAssert(WriteReads[writeReadIndex].WriteBuffer != NULL);
+            transfers[transferCount] = SPB_TRANSFER_LIST_ENTRY_INIT_SIMPLE(SpbTransferDirectionToDevice,
+                                                                           WriteReads[writeReadIndex].DelayInUs,
+                                                                           WriteReads[writeReadIndex].WriteBuffer,
+                                                                           WriteReads[writeReadIndex].WriteBufferLength);
+            transferCount++;
+        }
+        if (WriteReads[writeReadIndex].ReadBufferLength > 0)
+        {
+            DmfAssert(WriteReads[writeReadIndex].ReadBuffer != NULL);
+            transfers[transferCount] = SPB_TRANSFER_LIST_ENTRY_INIT_SIMPLE(SpbTransferDirectionFromDevice,
+                                                                           WriteReads[writeReadIndex].DelayInUs,
+                                                                           WriteReads[writeReadIndex].ReadBuffer,
+                                                                           WriteReads[writeReadIndex].ReadBufferLength);
+            transferCount++;
+        }
+    }
+    DmfAssert(transferCount <= SpbTarget_MaximumNumberOfTransfers);
+
+    if (0 == transferCount)
+    {
+        ntStatus = STATUS_INVALID_PARAMETER;
+        TraceEvents(TRACE_LEVEL_ERROR, DMF_TRACE, "No data to transfer");
+        goto Exit;
+    }
+
+    SPB_TRANSFER_LIST_INIT(&(asynchronousContext->Sequence.List), transferCount);
+
+    // Only send the entries that are used.
+    //
+    sequenceLength = FIELD_OFFSET(SPB_TRANSFER_LIST, Transfers) + (transferCount * sizeof(SPB_TRANSFER_LIST_ENTRY));
+
+    asynchronousContext->EvtSpbTargetSendCompletion = EvtSpbTargetSendCompletion;
+    asynchronousContext->ClientContext = ClientContext;
+
+    ntStatus = DMF_RequestTarget_Send(moduleContext->DmfModuleRequestTarget,
+                                      &asynchronousContext->Sequence,
+                                      sequenceLength,
+                                      NULL,
+                                      0,
+                                      ContinuousRequestTarget_RequestType_Ioctl,
+                                      IOCTL_SPB_EXECUTE_SEQUENCE,
+                                      RequestTimeoutMilliseconds,
+                                      SpbTarget_AsynchronousSendCompletion,
+                                      asynchronousContext);
+    if (! NT_SUCCESS(ntStatus))
+    {
+        TraceEvents(TRACE_LEVEL_ERROR, DMF_TRACE, "DMF_RequestTarget_Send fails: ntStatus=%!STATUS!", ntStatus);
+        goto Exit;
+    }
+
+    // The completion routine owns the context now.
+    //
+    asynchronousContext = NULL;
+
+Exit:
+
+    if (asynchronousContext != NULL)
+    {
+        DMF_BufferPool_Put(moduleContext->DmfModuleBufferPoolAsynchronousContext,
+                           asynchronousContext);
+    }
+
+    FuncExit(DMF_TRACE, "ntStatus=%!STATUS!", ntStatus);
+
+    return ntStatus;
+}
+
 EVT_DMF_InterruptResource_InterruptIsr SpbTarget_InterruptIsr;
 
 _Function_class_(EVT_DMF_InterruptResource_InterruptIsr)
@@ -414,11 +671,14 @@ Return Value:
     DMF_CONFIG_SpbTarget* moduleConfig;
     DMF_CONTEXT_SpbTarget* moduleContext;
     DMF_CONFIG_InterruptResource configInterruptResource;
+    DMF_CONFIG_BufferPool moduleConfigBufferPool;
 
     PAGED_CODE();
 
     FuncEntry(DMF_TRACE);
 
+    UNREFERENCED_PARAMETER(DmfParentModuleAttributes);
+
     moduleConfig = DMF_CONFIG_GET(DmfModule);
     moduleContext = DMF_CONTEXT_GET(DmfModule);
 
@@ -456,12 +716,35 @@ Return Value:
     // -------------
     //
     DMF_RequestTarget_ATTRIBUTES_INIT(&moduleAttributes);
-    moduleAttributes.PassiveLevel = DmfParentModuleAttributes->PassiveLevel;
+    // NOTE: Asynchronous transfers may be sent from the Client's DPC callback. Their
+    //       completion routine also runs at DISPATCH_LEVEL.
+    //
+    moduleAttributes.PassiveLevel = FALSE;
     DMF_DmfModuleAdd(DmfModuleInit,
                      &moduleAttributes,
                      WDF_NO_OBJECT_ATTRIBUTES,
                      &moduleContext->DmfModuleRequestTarget);
 
+    // BufferPoolAsynchronousContext
+    // -----------------------------
+    //
+    DMF_CONFIG_BufferPool_AND_ATTRIBUTES_INIT(&moduleConfigBufferPool,
+                                              &moduleAttributes);
+    moduleConfigBufferPool.BufferPoolMode = BufferPool_Mode_Source;
+    moduleConfigBufferPool.Mode.SourceSettings.EnableLookAside = TRUE;
+    moduleConfigBufferPool.Mode.SourceSettings.BufferCount = SpbTarget_NumberOfAsynchronousContexts;
+    // NOTE: Contexts must always be NonPagedPool because they are accessed in the
+    //       completion routine running at DISPATCH_LEVEL.
+    //
+    moduleConfigBufferPool.Mode.SourceSettings.PoolType = NonPagedPoolNx;
+    moduleConfigBufferPool.Mode.SourceSettings.BufferSize = sizeof(SpbTarget_AsynchronousContext);
+    moduleAttributes.ClientModuleInstanceName = "BufferPoolAsynchronousContext";
+    moduleAttributes.PassiveLevel = FALSE;
+    DMF_DmfModuleAdd(DmfModuleInit,
+                     &moduleAttributes,
+                     WDF_NO_OBJECT_ATTRIBUTES,
+                     &moduleContext->DmfModuleBufferPoolAsynchronousContext);
+
     FuncExitVoid(DMF_TRACE);
 }
 #pragma code_seg()
@@ -541,7 +824,8 @@ Return Value:
 
             if ((connectionClass == CM_RESOURCE_CONNECTION_CLASS_SERIAL) &&
                 ((connectionType == CM_RESOURCE_CONNECTION_TYPE_SERIAL_I2C) ||
-                    (connectionType == CM_RESOURCE_CONNECTION_TYPE_SERIAL_SPI)))
+                    ((connectionType == CM_RESOURCE_CONNECTION_TYPE_SERIAL_SPI) &&
+                     (! moduleConfig->SpbConnectionI2cOnly))))
             {
                 if (moduleConfig->SpbConnectionIndex == spbConnectionIndex)
                 {
@@ -635,6 +919,16 @@ Return Value:
     moduleContext = DMF_CONTEXT_GET(DmfModule);
     moduleConfig = DMF_CONFIG_GET(DmfModule);
 
+    if (! moduleContext->SpbConnectionAssigned)
+    {
+        // The connection is optional (SpbConnectionMandatory is not set) and it is
+        // not present. This Module opens but it does nothing.
+        //
+        TraceEvents(TRACE_LEVEL_VERBOSE, DMF_TRACE, "No SPB Resources Found");
+        ntStatus = STATUS_SUCCESS;
+        goto Exit;
+    }
+
     // Create the SPB target.
     //
     WDF_OBJECT_ATTRIBUTES targetAttributes;
@@ -1137,6 +1431,12 @@ MethodName(
                                                                                                                     \
     moduleContext = DMF_CONTEXT_GET(DmfModule);                                                                     \
                                                                                                                     \
+    if (! moduleContext->SpbConnectionAssigned)                                                                     \
+    {                                                                                                               \
+        ntStatus = STATUS_DEVICE_NOT_CONNECTED;                                                                     \
+        goto Exit;                                                                                                  \
+    }                                                                                                               \
+                                                                                                                    \
     ntStatus = DMF_RequestTarget_SendSynchronously(moduleContext->DmfModuleRequestTarget,                           \
                                                    NULL,                                                            \
                                                    0,                                                               \
@@ -1147,6 +1447,8 @@ MethodName(
                                                    0,                                                               \
                                                    &bytesWritten);                                                  \
                                                                                                                     \
+Exit:                                                                                                               \
+                                                                                                                    \
     return ntStatus;                                                                                                \
 }                                                                                                                   \
 
@@ -1222,6 +1524,13 @@ DMF_SpbTarget_BufferFullDuplex(
 
     moduleContext = DMF_CONTEXT_GET(DmfModule);
 
+    if (! moduleContext->SpbConnectionAssigned)
+    {
+        ntStatus = STATUS_DEVICE_NOT_CONNECTED;
+        TraceEvents(TRACE_LEVEL_ERROR, DMF_TRACE, "No SPB Resources Found");
+        goto Exit;
+    }
+
     ntStatus = DMF_RequestTarget_SendSynchronously(moduleContext->DmfModuleRequestTarget,
                                                    &sequence,
                                                    sizeof(sequence),
@@ -1232,6 +1541,8 @@ DMF_SpbTarget_BufferFullDuplex(
                                                    0,
                                                    &bytesWritten);
 
+Exit:
+
     FuncExit(DMF_TRACE, "ntStatus=%!STATUS!", ntStatus);
 
     return ntStatus;
@@ -1275,6 +1586,13 @@ DMF_SpbTarget_BufferWrite(
 
     moduleContext = DMF_CONTEXT_GET(DmfModule);
 
+    if (! moduleContext->SpbConnectionAssigned)
+    {
+        ntStatus = STATUS_DEVICE_NOT_CONNECTED;
+        TraceEvents(TRACE_LEVEL_ERROR, DMF_TRACE, "No SPB Resources Found");
+        goto Exit;
+    }
+
     ntStatus = DMF_RequestTarget_SendSynchronously(moduleContext->DmfModuleRequestTarget,
                                                    BufferToWrite,
                                                    NumberOfBytesToWrite,
@@ -1285,12 +1603,72 @@ DMF_SpbTarget_BufferWrite(
                                                    0,
                                                    &bytesWritten);
 
+Exit:
+
     FuncExit(DMF_TRACE, "ntStatus=%!STATUS!", ntStatus);
 
     return ntStatus;
 }
 #pragma code_seg()
 
+_IRQL_requires_max_(DISPATCH_LEVEL)
+_Must_inspect_result_
+NTSTATUS
+DMF_SpbTarget_BufferWriteAsynchronous(
+    _In_ DMFMODULE DmfModule,
+    _In_reads_(NumberOfBytesToWrite) UCHAR* BufferToWrite,
+    _In_ ULONG NumberOfBytesToWrite,
+    _In_ ULONG RequestTimeoutMilliseconds,
+    _In_opt_ EVT_DMF_SpbTarget_SendCompletion* EvtSpbTargetSendCompletion,
+    _In_opt_ VOID* ClientContext
+    )
+/*++
+ 
+  Routine Description:
+
+    This routine writes to the SPB controller asynchronously.
+
+  Arguments:
+
+    DmfModule - This Module's Module handle.
+    BufferToWrite- Data to write to the device. It must remain valid until the write completes.
+    NumberOfBytesToWrite - Length of BufferToWrite.
+    RequestTimeoutMilliseconds - Timeout in milliseconds.
+    EvtSpbTargetSendCompletion - Client callback called when the write completes.
+    ClientContext - Client context passed to EvtSpbTargetSendCompletion.
+
+  Return Value:
+
+    NTSTATUS
+
+--*/
+{
+    NTSTATUS ntStatus;
+    SpbTarget_WriteRead writeRead;
+
+    FuncEntry(DMF_TRACE);
+
+    DMFMODULE_VALIDATE_IN_METHOD(DmfModule,
+                                 SpbTarget);
+
+    writeRead.WriteBuffer = BufferToWrite;
+    writeRead.WriteBufferLength = NumberOfBytesToWrite;
+    writeRead.ReadBuffer = NULL;
+    writeRead.ReadBufferLength = 0;
+    writeRead.DelayInUs = 0;
+
+    ntStatus = SpbTarget_WriteReadsSend(DmfModule,
+                                        &writeRead,
+                                        1,
+                                        RequestTimeoutMilliseconds,
+                                        EvtSpbTargetSendCompletion,
+                                        ClientContext);
+
+    FuncExit(DMF_TRACE, "ntStatus=%!STATUS!", ntStatus);
+
+    return ntStatus;
+}
+
 #pragma code_seg("PAGE")
 _IRQL_requires_max_(PASSIVE_LEVEL)
 _Must_inspect_result_
@@ -1330,6 +1708,13 @@ DMF_SpbTarget_BufferWriteEx(
 
     moduleContext = DMF_CONTEXT_GET(DmfModule);
 
+    if (! moduleContext->SpbConnectionAssigned)
+    {
+        ntStatus = STATUS_DEVICE_NOT_CONNECTED;
+        TraceEvents(TRACE_LEVEL_ERROR, DMF_TRACE, "No SPB Resources Found");
+        goto Exit;
+    }
+
     ntStatus = DMF_RequestTarget_SendSynchronously(moduleContext->DmfModuleRequestTarget,
                                                    BufferToWrite,
                                                    NumberOfBytesToWrite,
@@ -1340,12 +1725,77 @@ DMF_SpbTarget_BufferWriteEx(
                                                    RequestTimeoutMilliseconds,
                                                    &bytesWritten);
 
+Exit:
+
     FuncExit(DMF_TRACE, "ntStatus=%!STATUS!", ntStatus);
 
     return ntStatus;
 }
 #pragma code_seg()
 
+_IRQL_requires_max_(DISPATCH_LEVEL)
+_Must_inspect_result_
+NTSTATUS
+DMF_SpbTarget_BufferWriteReadAsynchronous(
+    _In_ DMFMODULE DmfModule,
+    _In_reads_(InputBufferLength) UCHAR* InputBuffer,
+    _In_ ULONG InputBufferLength,
+    _Out_writes_(OutputBufferLength) UCHAR* OutputBuffer,
+    _In_ ULONG OutputBufferLength,
+    _In_ ULONG RequestTimeoutMilliseconds,
+    _In_opt_ EVT_DMF_SpbTarget_SendCompletion* EvtSpbTargetSendCompletion,
+    _In_opt_ VOID* ClientContext
+    )
+/*++
+ 
+  Routine Description:
+
+    This routine sends a write-read sequence to the SPB controller asynchronously. It reads a buffer
+    from a particular address.
+
+  Arguments:
+
+    DmfModule - This Module's Module handle.
+    InputBuffer - Address to read buffer from. It must remain valid until the sequence completes.
+    InputBufferLength - Length of InputBuffer.
+    OutputBuffer - Data read from device. It must remain valid until the sequence completes.
+    OutputBufferLength - Length of OutputBuffer.
+    RequestTimeoutMilliseconds - Timeout in milliseconds.
+    EvtSpbTargetSendCompletion - Client callback called when the sequence completes.
+    ClientContext - Client context passed to EvtSpbTargetSendCompletion.
+
+  Return Value:
+
+    NTSTATUS
+
+--*/
+{
+    NTSTATUS ntStatus;
+    SpbTarget_WriteRead writeRead;
+
+    FuncEntry(DMF_TRACE);
+
+    DMFMODULE_VALIDATE_IN_METHOD(DmfModule,
+                                 SpbTarget);
+
+    writeRead.WriteBuffer = InputBuffer;
+    writeRead.WriteBufferLength = InputBufferLength;
+    writeRead.ReadBuffer = OutputBuffer;
+    writeRead.ReadBufferLength = OutputBufferLength;
+    writeRead.DelayInUs = 0;
+
+    ntStatus = SpbTarget_WriteReadsSend(DmfModule,
+                                        &writeRead,
+                                        1,
+                                        RequestTimeoutMilliseconds,
+                                        EvtSpbTargetSendCompletion,
+                                        ClientContext);
+
+    FuncExit(DMF_TRACE, "ntStatus=%!STATUS!", ntStatus);
+
+    return ntStatus;
+}
+
 #pragma code_seg("PAGE")
 _IRQL_requires_max_(PASSIVE_LEVEL)
 _Must_inspect_result_
@@ -1420,6 +1870,13 @@ DMF_SpbTarget_BufferWriteReadEx(
 
     moduleContext = DMF_CONTEXT_GET(DmfModule);
 
+    if (! moduleContext->SpbConnectionAssigned)
+    {
+        ntStatus = STATUS_DEVICE_NOT_CONNECTED;
+        TraceEvents(TRACE_LEVEL_ERROR, DMF_TRACE, "No SPB Resources Found");
+        goto Exit;
+    }
+
     ntStatus = DMF_RequestTarget_SendSynchronously(moduleContext->DmfModuleRequestTarget,
                                                    &sequence,
                                                    sizeof(sequence),
@@ -1430,6 +1887,8 @@ DMF_SpbTarget_BufferWriteReadEx(
                                                    RequestTimeoutMilliseconds,
                                                    &bytesWritten);
 
+Exit:
+
     FuncExit(DMF_TRACE, "ntStatus=%!STATUS!", ntStatus);
 
     return ntStatus;
@@ -1508,6 +1967,13 @@ DMF_SpbTarget_BufferWriteRead(
 
     moduleContext = DMF_CONTEXT_GET(DmfModule);
 
+    if (! moduleContext->SpbConnectionAssigned)
+    {
+        ntStatus = STATUS_DEVICE_NOT_CONNECTED;
+        TraceEvents(TRACE_LEVEL_ERROR, DMF_TRACE, "No SPB Resources Found");
+        goto Exit;
+    }
+
     ntStatus = DMF_RequestTarget_SendSynchronously(moduleContext->DmfModuleRequestTarget,
                                                    &sequence,
                                                    sizeof(sequence),
@@ -1518,6 +1984,8 @@ DMF_SpbTarget_BufferWriteRead(
                                                    0,
                                                    &bytesWritten);
 
+Exit:
+
     FuncExit(DMF_TRACE, "ntStatus=%!STATUS!", ntStatus);
 
     return ntStatus;
@@ -1707,5 +2175,58 @@ Return Value:
     FuncExitVoid(DMF_TRACE);
 }
 
+_IRQL_requires_max_(DISPATCH_LEVEL)
+_Must_inspect_result_
+NTSTATUS
+DMF_SpbTarget_WriteReadBatchSend(
+    _In_ DMFMODULE DmfModule,
+    _In_reads_(NumberOfWriteReads) SpbTarget_WriteRead* WriteReads,
+    _In_ ULONG NumberOfWriteReads,
+    _In_ ULONG RequestTimeoutMilliseconds,
+    _In_opt_ EVT_DMF_SpbTarget_SendCompletion* EvtSpbTargetSendCompletion,
+    _In_opt_ VOID* ClientContext
+    )
+/*++
+ 
+  Routine Description:
+
+    Sends several write/read pairs to the SPB controller asynchronously as a single SPB sequence.
+    The given callback is called once when all the pairs have been transferred.
+
+  Arguments:
+
+    DmfModule - This Module's Module handle.
+    WriteReads - The write/read pairs. This array may be freed as soon as this Method returns but the
+                 buffers it points to must remain valid until the sequence completes.
+    NumberOfWriteReads - Number of entries in WriteReads. Maximum is SpbTarget_MaximumNumberOfWriteReads.
+    RequestTimeoutMilliseconds - Timeout in milliseconds.
+    EvtSpbTargetSendCompletion - Client callback called when the sequence completes.
+    ClientContext - Client context passed to EvtSpbTargetSendCompletion.
+
+  Return Value:
+
+    NTSTATUS
+
+--*/
+{
+    NTSTATUS ntStatus;
+
+    FuncEntry(DMF_TRACE);
+
+    DMFMODULE_VALIDATE_IN_METHOD(DmfModule,
+                                 SpbTarget);
+
+    ntStatus = SpbTarget_WriteReadsSend(DmfModule,
+                                        WriteReads,
+                                        NumberOfWriteReads,
+                                        RequestTimeoutMilliseconds,
+                                        EvtSpbTargetSendCompletion,
+                                        ClientContext);
+
+    FuncExit(DMF_TRACE, "ntStatus=%!STATUS!", ntStatus);
+
+    return ntStatus;
+}
+
 // eof: Dmf_SpbTarget.c
 //
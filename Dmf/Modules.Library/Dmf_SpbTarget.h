@@ -27,6 +27,41 @@ typedef EVT_DMF_InterruptResource_InterruptIsr EVT_DMF_SpbTarget_InterruptIsr;
 typedef EVT_DMF_InterruptResource_InterruptDpc EVT_DMF_SpbTarget_InterruptDpc;
 typedef EVT_DMF_InterruptResource_InterruptPassive EVT_DMF_SpbTarget_InterruptPassive;
 
+// Maximum number of write/read pairs that can be sent in a single batch.
+// Each pair uses up to two SPB transfers.
+//
+#define SpbTarget_MaximumNumberOfWriteReads                         16
+
+// A single write/read pair in a batch. Either buffer may be omitted by setting
+// its length to zero. A write followed by a read is executed with a restart
+// between them and without releasing the bus.
+//
+typedef struct
+{
+    // Data written to the device.
+    //
+    UCHAR* WriteBuffer;
+    ULONG WriteBufferLength;
+    // Data read from the device.
+    //
+    UCHAR* ReadBuffer;
+    ULONG ReadBufferLength;
+    // Delay in microseconds before each transfer of this pair.
+    //
+    ULONG DelayInUs;
+} SpbTarget_WriteRead;
+
+// Callback function called when an asynchronous transfer completes.
+//
+typedef
+_Function_class_(EVT_DMF_SpbTarget_SendCompletion)
+_IRQL_requires_max_(DISPATCH_LEVEL)
+_IRQL_requires_same_
+VOID
+EVT_DMF_SpbTarget_SendCompletion(_In_ DMFMODULE DmfModule,
+                                 _In_opt_ VOID* ClientContext,
+                                 _In_ NTSTATUS CompletionStatus);
+
 // Client uses this structure to configure the Module specific parameters.
 //
 typedef struct
@@ -37,6 +72,9 @@ typedef struct
     // GPIO Connection index for this instance.
     //
     ULONG SpbConnectionIndex;
+    // Count only I2C connections (not SPI connections) when looking for SpbConnectionIndex.
+    //
+    BOOLEAN SpbConnectionI2cOnly;
     // Open in Read or Write mode.
     //
     ULONG OpenMode;
@@ -78,6 +116,18 @@ DMF_SpbTarget_BufferWrite(
     _In_ ULONG NumberOfBytesToWrite
     );
 
+_IRQL_requires_max_(DISPATCH_LEVEL)
+_Must_inspect_result_
+NTSTATUS
+DMF_SpbTarget_BufferWriteAsynchronous(
+    _In_ DMFMODULE DmfModule,
+    _In_reads_(NumberOfBytesToWrite) UCHAR* BufferToWrite,
+    _In_ ULONG NumberOfBytesToWrite,
+    _In_ ULONG RequestTimeoutMilliseconds,
+    _In_opt_ EVT_DMF_SpbTarget_SendCompletion* EvtSpbTargetSendCompletion,
+    _In_opt_ VOID* ClientContext
+    );
+
 _IRQL_requires_max_(PASSIVE_LEVEL)
 _Must_inspect_result_
 NTSTATUS
@@ -99,6 +149,20 @@ DMF_SpbTarget_BufferWriteRead(
     _In_ ULONG OutputBufferLength
     );
 
+_IRQL_requires_max_(DISPATCH_LEVEL)
+_Must_inspect_result_
+NTSTATUS
+DMF_SpbTarget_BufferWriteReadAsynchronous(
+    _In_ DMFMODULE DmfModule,
+    _In_reads_(InputBufferLength) UCHAR* InputBuffer,
+    _In_ ULONG InputBufferLength,
+    _Out_writes_(OutputBufferLength) UCHAR* OutputBuffer,
+    _In_ ULONG OutputBufferLength,
+    _In_ ULONG RequestTimeoutMilliseconds,
+    _In_opt_ EVT_DMF_SpbTarget_SendCompletion* EvtSpbTargetSendCompletion,
+    _In_opt_ VOID* ClientContext
+    );
+
 _IRQL_requires_max_(PASSIVE_LEVEL)
 _Must_inspect_result_
 NTSTATUS
@@ -166,5 +230,17 @@ DMF_SpbTarget_IsResourceAssigned(
     _Out_opt_ BOOLEAN* InterruptAssigned
     );
 
+_IRQL_requires_max_(DISPATCH_LEVEL)
+_Must_inspect_result_
+NTSTATUS
+DMF_SpbTarget_WriteReadBatchSend(
+    _In_ DMFMODULE DmfModule,
+    _In_reads_(NumberOfWriteReads) SpbTarget_WriteRead* WriteReads,
+    _In_ ULONG NumberOfWriteReads,
+    _In_ ULONG RequestTimeoutMilliseconds,
+    _In_opt_ EVT_DMF_SpbTarget_SendCompletion* EvtSpbTargetSendCompletion,
+    _In_opt_ VOID* ClientContext
+    );
+
 // eof: Dmf_SpbTarget.h
 //
@@ -9,7 +9,8 @@ Module Name:
 
 Abstract:
 
-    Implements a Stack data structure.
+    Implements a Stack data structure. Elements are stored either in a child DMF_BufferQueue
+    or in a single preallocated array (optionally accessed without locks).
 
 Environment:
 
@@ -33,6 +34,33 @@ Environment:
 ///////////////////////////////////////////////////////////////////////////////////////////////////////
 //
 
+// In Stack_Mode_ArrayLockFree mode, each element of the array is preceded by this header.
+// Used and free nodes are kept in two lists that are linked by index.
+//
+typedef struct
+{
+    // Index of the next node in the list.
+    // NOTE: This may be read by a thread that lost a race to pop this node. That thread
+    //       discards the value because its compare exchange of the list head fails.
+    //
+    ULONG Next;
+    // Keeps the element that follows 64-bit aligned.
+    //
+    ULONG Reserved;
+} STACK_NODE;
+
+// Indicates the end of a list.
+//
+#define STACK_INDEX_NONE                        ((ULONG)-1)
+
+// The head of a list holds the index of the first node in its low 32 bits and a tag in
+// its high 32 bits. The tag changes every time the head changes so that a compare exchange
+// of the head fails if a node has been popped and pushed again in between (ABA).
+//
+#define STACK_HEAD(Index, Tag)                  ((LONG64)(((ULONG64)(Tag) << 32) | (ULONG64)(Index)))
+#define STACK_HEAD_INDEX(Head)                  ((ULONG)((ULONG64)(Head) & 0xFFFFFFFF))
+#define STACK_HEAD_TAG(Head)                    ((ULONG)((ULONG64)(Head) >> 32))
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////////
 // Module Private Context
 ///////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -41,8 +69,32 @@ Environment:
 typedef struct _DMF_CONTEXT_Stack
 {
     // BufferQueue that Module uses to implement a stack.
+    // (Stack_Mode_BufferQueue only.)
     //
     DMFMODULE DmfModuleBufferQueue;
+    // Preallocated array of StackDepth slots.
+    // (Stack_Mode_Array and Stack_Mode_ArrayLockFree only.)
+    //
+    WDFMEMORY MemoryArray;
+    UCHAR* Array;
+    // Size of each slot in the array.
+    //
+    size_t SlotSize;
+    // Number of elements in the stack. The top of the stack is at Array[Top - 1].
+    // (Stack_Mode_Array only. Protected by the Module lock.)
+    //
+    ULONG Top;
+    // Heads of the list of nodes that hold elements (top of the stack first) and of
+    // the list of free nodes. See STACK_HEAD().
+    // (Stack_Mode_ArrayLockFree only.)
+    //
+    volatile LONG64 HeadUsed;
+    volatile LONG64 HeadFree;
+    // Number of elements in the stack. It is incremented before an element is published
+    // and decremented after an element is removed so it is always in [0, StackDepth].
+    // (Stack_Mode_ArrayLockFree only.)
+    //
+    volatile LONG Count;
 } DMF_CONTEXT_Stack;
 
 // This macro declares the following function:
@@ -55,11 +107,145 @@ DMF_MODULE_DECLARE_CONTEXT(Stack)
 //
 DMF_MODULE_DECLARE_CONFIG(Stack)
 
+// Memory Pool Tag.
+//
+#define MemoryTag 'oMtS'
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////////
 // DMF Module Support Code
 ///////////////////////////////////////////////////////////////////////////////////////////////////////
 //
 
+__forceinline
+static
+STACK_NODE*
+Stack_NodeGet(
+    _In_ DMF_CONTEXT_Stack* ModuleContext,
+    _In_ ULONG NodeIndex
+    )
+/*++
+
+Routine Description:
+
+    Return the node at the given index of the array.
+
+Arguments:
+
+    ModuleContext - This Module's context.
+    NodeIndex - Index of the node.
+
+Return Value:
+
+    The node. Its element immediately follows it.
+
+--*/
+{
+    return (STACK_NODE*)(ModuleContext->Array + ((size_t)NodeIndex * ModuleContext->SlotSize));
+}
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+static
+ULONG
+Stack_ListPop(
+    _In_ DMF_CONTEXT_Stack* ModuleContext,
+    _Inout_ volatile LONG64* Head
+    )
+/*++
+
+Routine Description:
+
+    Remove the first node from the given list without acquiring any lock.
+
+Arguments:
+
+    ModuleContext - This Module's context.
+    Head - Head of the list.
+
+Return Value:
+
+    Index of the removed node or STACK_INDEX_NONE if the list is empty.
+
+--*/
+{
+    LONG64 headOld;
+    LONG64 headNew;
+    ULONG nodeIndex;
+
+    for (;;)
+    {
+        // Atomic read of the 64-bit head (also on 32-bit platforms).
+        //
+        headOld = InterlockedCompareExchange64(Head,
+                                               0,
+                                               0);
+        nodeIndex = STACK_HEAD_INDEX(headOld);
+        if (STACK_INDEX_NONE == nodeIndex)
+        {
+            break;
+        }
+
+        headNew = STACK_HEAD(Stack_NodeGet(ModuleContext, nodeIndex)->Next,
+                             STACK_HEAD_TAG(headOld) + 1);
+        if (InterlockedCompareExchange64(Head,
+                                         headNew,
+                                         headOld) == headOld)
+        {
+            break;
+        }
+    }
+
+    return nodeIndex;
+}
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+static
+VOID
+Stack_ListPush(
+    _In_ DMF_CONTEXT_Stack* ModuleContext,
+    _Inout_ volatile LONG64* Head,
+    _In_ ULONG NodeIndex
+    )
+/*++
+
+Routine Description:
+
+    Insert the given node at the start of the given list without acquiring any lock.
+
+Arguments:
+
+    ModuleContext - This Module's context.
+    Head - Head of the list.
+    NodeIndex - Index of the node to insert. The caller owns this node.
+
+Return Value:
+
+    None
+
+--*/
+{
+    LONG64 headOld;
+    LONG64 headNew;
+    STACK_NODE* node;
+
+    node = Stack_NodeGet(ModuleContext,
+                         NodeIndex);
+    for (;;)
+    {
+        headOld = InterlockedCompareExchange64(Head,
+                                               0,
+                                               0);
+        node->Next = STACK_HEAD_INDEX(headOld);
+        headNew = STACK_HEAD(NodeIndex,
+                             STACK_HEAD_TAG(headOld) + 1);
+        if (InterlockedCompareExchange64(Head,
+                                         headNew,
+                                         headOld) == headOld)
+        {
+            break;
+        }
+    }
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////////
 // WDF Module Callbacks
 ///////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -109,6 +295,13 @@ Return Value:
     moduleConfig = DMF_CONFIG_GET(DmfModule);
     moduleContext = DMF_CONTEXT_GET(DmfModule);
 
+    if (moduleConfig->Mode != Stack_Mode_BufferQueue)
+    {
+        // Elements are stored in an array allocated when this Module opens.
+        //
+        goto Exit;
+    }
+
     // DmfModuleBufferQueue
     // --------------------
     //
@@ -125,6 +318,157 @@ Return Value:
                      WDF_NO_OBJECT_ATTRIBUTES,
                      &moduleContext->DmfModuleBufferQueue);
 
+Exit:
+
+    FuncExitVoid(DMF_TRACE);
+}
+#pragma code_seg()
+
+#pragma code_seg("PAGE")
+_Function_class_(DMF_Open)
+_IRQL_requires_max_(PASSIVE_LEVEL)
+_Must_inspect_result_
+static
+NTSTATUS
+DMF_Stack_Open(
+    _In_ DMFMODULE DmfModule
+    )
+/*++
+
+Routine Description:
+
+    Initialize an instance of a DMF Module of type Stack.
+    In the Array modes, allocate the array that holds all the elements.
+
+Arguments:
+
+    DmfModule - This Module's handle.
+
+Return Value:
+
+    NTSTATUS
+
+--*/
+{
+    NTSTATUS ntStatus;
+    DMF_CONTEXT_Stack* moduleContext;
+    DMF_CONFIG_Stack* moduleConfig;
+    WDF_OBJECT_ATTRIBUTES objectAttributes;
+    ULONG nodeIndex;
+
+    PAGED_CODE();
+
+    FuncEntry(DMF_TRACE);
+
+    moduleConfig = DMF_CONFIG_GET(DmfModule);
+    moduleContext = DMF_CONTEXT_GET(DmfModule);
+
+    ntStatus = STATUS_SUCCESS;
+
+    if (Stack_Mode_BufferQueue == moduleConfig->Mode)
+    {
+        goto Exit;
+    }
+
+    if ((0 == moduleConfig->StackDepth) ||
+        (STACK_INDEX_NONE == moduleConfig->StackDepth) ||
+        (0 == moduleConfig->StackElementSize) ||
+        (moduleConfig->Mode >= Stack_Mode_Maximum))
+    {
+        ntStatus = STATUS_INVALID_PARAMETER;
+        DmfAssert(FALSE);
+        goto Exit;
+    }
+
+    if (Stack_Mode_Array == moduleConfig->Mode)
+    {
+        moduleContext->SlotSize = moduleConfig->StackElementSize;
+    }
+    else
+    {
+        moduleContext->SlotSize = sizeof(STACK_NODE) +
+                                  (((size_t)moduleConfig->StackElementSize + sizeof(ULONG64) - 1) & ~(sizeof(ULONG64) - 1));
+    }
+
+    WDF_OBJECT_ATTRIBUTES_INIT(&objectAttributes);
+    objectAttributes.ParentObject = DmfModule;
+    ntStatus = WdfMemoryCreate(&objectAttributes,
+                               NonPagedPoolNx,
+                               MemoryTag,
+                               (size_t)moduleConfig->StackDepth * moduleContext->SlotSize,
+                               &moduleContext->MemoryArray,
+                               (VOID**)&moduleContext->Array);
+    if (!NT_SUCCESS(ntStatus))
+    {
+        TraceEvents(TRACE_LEVEL_ERROR, DMF_TRACE, "WdfMemoryCreate fails: ntStatus=%!STATUS!", ntStatus);
+        goto Exit;
+    }
+
+    moduleContext->Top = 0;
+    moduleContext->Count = 0;
+    moduleContext->HeadUsed = STACK_HEAD(STACK_INDEX_NONE,
+                                         0);
+    moduleContext->HeadFree = STACK_HEAD(STACK_INDEX_NONE,
+                                         0);
+    if (Stack_Mode_ArrayLockFree == moduleConfig->Mode)
+    {
+        // Initially, all the nodes are free.
+        //
+        for (nodeIndex = 0; nodeIndex < moduleConfig->StackDepth; nodeIndex++)
+        {
+            Stack_ListPush(moduleContext,
+                           &moduleContext->HeadFree,
+                           nodeIndex);
+        }
+    }
+
+Exit:
+
+    FuncExit(DMF_TRACE, "ntStatus=%!STATUS!", ntStatus);
+
+    return ntStatus;
+}
+#pragma code_seg()
+
+#pragma code_seg("PAGE")
+_Function_class_(DMF_Close)
+_IRQL_requires_max_(PASSIVE_LEVEL)
+static
+VOID
+DMF_Stack_Close(
+    _In_ DMFMODULE DmfModule
+    )
+/*++
+
+Routine Description:
+
+    Uninitialize an instance of a DMF Module of type Stack.
+
+Arguments:
+
+    DmfModule - This Module's handle.
+
+Return Value:
+
+    None
+
+--*/
+{
+    DMF_CONTEXT_Stack* moduleContext;
+
+    PAGED_CODE();
+
+    FuncEntry(DMF_TRACE);
+
+    moduleContext = DMF_CONTEXT_GET(DmfModule);
+
+    if (moduleContext->MemoryArray != NULL)
+    {
+        WdfObjectDelete(moduleContext->MemoryArray);
+        moduleContext->MemoryArray = NULL;
+        moduleContext->Array = NULL;
+    }
+
     FuncExitVoid(DMF_TRACE);
 }
 #pragma code_seg()
@@ -173,6 +517,8 @@ Return Value:
 
     DMF_CALLBACKS_DMF_INIT(&dmfCallbacksDmf_Stack);
     dmfCallbacksDmf_Stack.ChildModulesAdd = DMF_Stack_ChildModulesAdd;
+    dmfCallbacksDmf_Stack.DeviceOpen = DMF_Stack_Open;
+    dmfCallbacksDmf_Stack.DeviceClose = DMF_Stack_Close;
 
     DMF_MODULE_DESCRIPTOR_INIT_CONTEXT_TYPE(dmfModuleDescriptor_Stack,
                                             Stack,
@@ -224,6 +570,7 @@ Return Value:
 --*/
 {
     DMF_CONTEXT_Stack* moduleContext;
+    DMF_CONFIG_Stack* moduleConfig;
     ULONG numberOfEntriesInList;
 
     FuncEntry(DMF_TRACE);
@@ -232,8 +579,26 @@ Return Value:
                                  Stack);
 
     moduleContext = DMF_CONTEXT_GET(DmfModule);
+    moduleConfig = DMF_CONFIG_GET(DmfModule);
 
-    numberOfEntriesInList = DMF_BufferQueue_Count(moduleContext->DmfModuleBufferQueue);
+    switch (moduleConfig->Mode)
+    {
+        case Stack_Mode_Array:
+        {
+            numberOfEntriesInList = moduleContext->Top;
+            break;
+        }
+        case Stack_Mode_ArrayLockFree:
+        {
+            numberOfEntriesInList = (ULONG)moduleContext->Count;
+            break;
+        }
+        default:
+        {
+            numberOfEntriesInList = DMF_BufferQueue_Count(moduleContext->DmfModuleBufferQueue);
+            break;
+        }
+    }
 
     FuncExit(DMF_TRACE, "numberOfEntriesInList=%d", numberOfEntriesInList);
 
@@ -262,6 +627,8 @@ Return Value:
 --*/
 {
     DMF_CONTEXT_Stack* moduleContext;
+    DMF_CONFIG_Stack* moduleConfig;
+    ULONG nodeIndex;
 
     FuncEntry(DMF_TRACE);
 
@@ -269,10 +636,44 @@ Return Value:
                                  Stack);
 
     moduleContext = DMF_CONTEXT_GET(DmfModule);
+    moduleConfig = DMF_CONFIG_GET(DmfModule);
 
-    // Move all the buffers from consumer list to producer list.
-    //
-    DMF_BufferQueue_Flush(moduleContext->DmfModuleBufferQueue);
+    switch (moduleConfig->Mode)
+    {
+        case Stack_Mode_Array:
+        {
+            DMF_ModuleLock(DmfModule);
+            moduleContext->Top = 0;
+            DMF_ModuleUnlock(DmfModule);
+            break;
+        }
+        case Stack_Mode_ArrayLockFree:
+        {
+            // Move all the nodes from used list to free list.
+            //
+            for (;;)
+            {
+                nodeIndex = Stack_ListPop(moduleContext,
+                                          &moduleContext->HeadUsed);
+                if (STACK_INDEX_NONE == nodeIndex)
+                {
+                    break;
+                }
+                InterlockedDecrement(&moduleContext->Count);
+                Stack_ListPush(moduleContext,
+                               &moduleContext->HeadFree,
+                               nodeIndex);
+            }
+            break;
+        }
+        default:
+        {
+            // Move all the buffers from consumer list to producer list.
+            //
+            DMF_BufferQueue_Flush(moduleContext->DmfModuleBufferQueue);
+            break;
+        }
+    }
 
     FuncExitVoid(DMF_TRACE);
 }
@@ -308,6 +709,7 @@ Return Value:
     DMF_CONFIG_Stack* moduleConfig;
     NTSTATUS ntStatus;
     UCHAR* stackBuffer;
+    ULONG nodeIndex;
 
     UNREFERENCED_PARAMETER(ClientBufferSize);
 
@@ -322,6 +724,50 @@ Return Value:
     DmfAssert(ClientBuffer != NULL);
     DmfAssert(ClientBufferSize == moduleConfig->StackElementSize);
 
+    // 'Possibly incorrect single element annotation on buffer'
+    //
+    __analysis_assume(ClientBufferSize == moduleConfig->StackElementSize);
+
+    if (Stack_Mode_Array == moduleConfig->Mode)
+    {
+        DMF_ModuleLock(DmfModule);
+        if (0 == moduleContext->Top)
+        {
+            DMF_ModuleUnlock(DmfModule);
+            ntStatus = STATUS_UNSUCCESSFUL;
+            goto Exit;
+        }
+        moduleContext->Top--;
+        #pragma warning(suppress:26007)
+        RtlCopyMemory(ClientBuffer,
+                      moduleContext->Array + ((size_t)moduleContext->Top * moduleContext->SlotSize),
+                      moduleConfig->StackElementSize);
+        DMF_ModuleUnlock(DmfModule);
+        ntStatus = STATUS_SUCCESS;
+        goto Exit;
+    }
+
+    if (Stack_Mode_ArrayLockFree == moduleConfig->Mode)
+    {
+        nodeIndex = Stack_ListPop(moduleContext,
+                                  &moduleContext->HeadUsed);
+        if (STACK_INDEX_NONE == nodeIndex)
+        {
+            ntStatus = STATUS_UNSUCCESSFUL;
+            goto Exit;
+        }
+        InterlockedDecrement(&moduleContext->Count);
+        #pragma warning(suppress:26007)
+        RtlCopyMemory(ClientBuffer,
+                      Stack_NodeGet(moduleContext, nodeIndex) + 1,
+                      moduleConfig->StackElementSize);
+        Stack_ListPush(moduleContext,
+                       &moduleContext->HeadFree,
+                       nodeIndex);
+        ntStatus = STATUS_SUCCESS;
+        goto Exit;
+    }
+
     // Dequeue buffer.
     //
     ntStatus = DMF_BufferQueue_Dequeue(moduleContext->DmfModuleBufferQueue,
@@ -335,10 +781,6 @@ Return Value:
 
     // Copy dequeued buffer to the client buffer.
     //
-
-    // 'Possibly incorrect single element annotation on buffer'
-    //
-    __analysis_assume(ClientBufferSize == moduleConfig->StackElementSize);
     #pragma warning(suppress:26007)
     RtlCopyMemory(ClientBuffer,
                   stackBuffer,
@@ -356,6 +798,155 @@ Exit:
     return ntStatus;
 }
 
+_IRQL_requires_max_(DISPATCH_LEVEL)
+_Must_inspect_result_
+NTSTATUS
+DMF_Stack_PopAll(
+    _In_ DMFMODULE DmfModule,
+    _Out_writes_bytes_(ClientBufferSize) VOID* ClientBuffer,
+    _In_ size_t ClientBufferSize,
+    _Out_ ULONG* NumberOfElements
+    )
+/*++
+
+Routine Description:
+
+    Pops all the elements in the stack into the given buffer, top of the stack first.
+
+Arguments:
+
+    DmfModule - This Module's handle.
+    ClientBuffer - The Client Buffer. It receives the elements one after the other.
+    ClientBufferSize - Size of Client buffer. In the Array modes it must be able to hold
+                       StackDepth elements. In Stack_Mode_BufferQueue mode, elements that do
+                       not fit remain in the stack.
+    NumberOfElements - Number of elements written to ClientBuffer.
+
+Return Value:
+
+    STATUS_SUCCESS (even if the stack is empty).
+    STATUS_BUFFER_TOO_SMALL if ClientBuffer cannot hold StackDepth elements in the Array modes.
+
+--*/
+{
+    DMF_CONTEXT_Stack* moduleContext;
+    DMF_CONFIG_Stack* moduleConfig;
+    NTSTATUS ntStatus;
+    UCHAR* clientBuffer;
+    UCHAR* stackBuffer;
+    ULONG numberOfElements;
+    ULONG nodeIndex;
+    ULONG nextNodeIndex;
+    LONG64 headOld;
+    LONG64 headNew;
+    STACK_NODE* node;
+
+    FuncEntry(DMF_TRACE);
+
+    DMFMODULE_VALIDATE_IN_METHOD(DmfModule,
+                                 Stack);
+
+    moduleContext = DMF_CONTEXT_GET(DmfModule);
+    moduleConfig = DMF_CONFIG_GET(DmfModule);
+
+    DmfAssert(ClientBuffer != NULL);
+    DmfAssert(NumberOfElements != NULL);
+
+    clientBuffer = (UCHAR*)ClientBuffer;
+    numberOfElements = 0;
+    ntStatus = STATUS_SUCCESS;
+
+    if ((moduleConfig->Mode != Stack_Mode_BufferQueue) &&
+        (ClientBufferSize < (size_t)moduleConfig->StackDepth * moduleConfig->StackElementSize))
+    {
+        ntStatus = STATUS_BUFFER_TOO_SMALL;
+        goto Exit;
+    }
+
+    switch (moduleConfig->Mode)
+    {
+        case Stack_Mode_Array:
+        {
+            DMF_ModuleLock(DmfModule);
+            while (moduleContext->Top > 0)
+            {
+                moduleContext->Top--;
+                RtlCopyMemory(clientBuffer + ((size_t)numberOfElements * moduleConfig->StackElementSize),
+                              moduleContext->Array + ((size_t)moduleContext->Top * moduleContext->SlotSize),
+                              moduleConfig->StackElementSize);
+                numberOfElements++;
+            }
+            DMF_ModuleUnlock(DmfModule);
+            break;
+        }
+        case Stack_Mode_ArrayLockFree:
+        {
+            // Detach the whole used list at once. After that, its nodes are owned by this thread.
+            //
+            for (;;)
+            {
+                headOld = InterlockedCompareExchange64(&moduleContext->HeadUsed,
+                                                       0,
+                                                       0);
+                headNew = STACK_HEAD(STACK_INDEX_NONE,
+                                     STACK_HEAD_TAG(headOld) + 1);
+                if (InterlockedCompareExchange64(&moduleContext->HeadUsed,
+                                                 headNew,
+                                                 headOld) == headOld)
+                {
+                    break;
+                }
+            }
+
+            nodeIndex = STACK_HEAD_INDEX(headOld);
+            while (nodeIndex != STACK_INDEX_NONE)
+            {
+                DmfAssert(numberOfElements < moduleConfig->StackDepth);
+                node = Stack_NodeGet(moduleContext,
+                                     nodeIndex);
+                RtlCopyMemory(clientBuffer + ((size_t)numberOfElements * moduleConfig->StackElementSize),
+                              node + 1,
+                              moduleConfig->StackElementSize);
+                numberOfElements++;
+                InterlockedDecrement(&moduleContext->Count);
+                nextNodeIndex = node->Next;
+                Stack_ListPush(moduleContext,
+                               &moduleContext->HeadFree,
+                               nodeIndex);
+                nodeIndex = nextNodeIndex;
+            }
+            break;
+        }
+        default:
+        {
+            while (ClientBufferSize >= ((size_t)numberOfElements + 1) * moduleConfig->StackElementSize)
+            {
+                if (!NT_SUCCESS(DMF_BufferQueue_Dequeue(moduleContext->DmfModuleBufferQueue,
+                                                        (VOID**)&stackBuffer,
+                                                        NULL)))
+                {
+                    break;
+                }
+                RtlCopyMemory(clientBuffer + ((size_t)numberOfElements * moduleConfig->StackElementSize),
+                              stackBuffer,
+                              moduleConfig->StackElementSize);
+                numberOfElements++;
+                DMF_BufferQueue_Reuse(moduleContext->DmfModuleBufferQueue,
+                                      stackBuffer);
+            }
+            break;
+        }
+    }
+
+Exit:
+
+    *NumberOfElements = numberOfElements;
+
+    FuncExit(DMF_TRACE, "ntStatus=%!STATUS! numberOfElements=%d", ntStatus, numberOfElements);
+
+    return ntStatus;
+}
+
 _IRQL_requires_max_(DISPATCH_LEVEL)
 _Must_inspect_result_
 NTSTATUS
@@ -378,6 +969,7 @@ Arguments:
 Return Value:
 
     NTSTATUS
+    In the Array modes, STATUS_BUFFER_OVERFLOW if StackDepth elements are in the stack.
 
 --*/
 {
@@ -385,6 +977,7 @@ Return Value:
     DMF_CONFIG_Stack* moduleConfig;
     NTSTATUS ntStatus;
     UCHAR* stackBuffer;
+    ULONG nodeIndex;
 
     FuncEntry(DMF_TRACE);
 
@@ -396,6 +989,47 @@ Return Value:
 
     DmfAssert(ClientBuffer != NULL);
 
+    if (Stack_Mode_Array == moduleConfig->Mode)
+    {
+        DMF_ModuleLock(DmfModule);
+        if (moduleContext->Top >= moduleConfig->StackDepth)
+        {
+            DMF_ModuleUnlock(DmfModule);
+            ntStatus = STATUS_BUFFER_OVERFLOW;
+            goto Exit;
+        }
+        RtlCopyMemory(moduleContext->Array + ((size_t)moduleContext->Top * moduleContext->SlotSize),
+                      ClientBuffer,
+                      moduleConfig->StackElementSize);
+        moduleContext->Top++;
+        DMF_ModuleUnlock(DmfModule);
+        ntStatus = STATUS_SUCCESS;
+        goto Exit;
+    }
+
+    if (Stack_Mode_ArrayLockFree == moduleConfig->Mode)
+    {
+        nodeIndex = Stack_ListPop(moduleContext,
+                                  &moduleContext->HeadFree);
+        if (STACK_INDEX_NONE == nodeIndex)
+        {
+            ntStatus = STATUS_BUFFER_OVERFLOW;
+            goto Exit;
+        }
+        RtlCopyMemory(Stack_NodeGet(moduleContext, nodeIndex) + 1,
+                      ClientBuffer,
+                      moduleConfig->StackElementSize);
+        // Count the element before it is published so that a concurrent Pop that
+        // removes it never decrements Count below zero.
+        //
+        InterlockedIncrement(&moduleContext->Count);
+        Stack_ListPush(moduleContext,
+                       &moduleContext->HeadUsed,
+                       nodeIndex);
+        ntStatus = STATUS_SUCCESS;
+        goto Exit;
+    }
+
     // Fetch buffer.
     //
     ntStatus = DMF_BufferQueue_Fetch(moduleContext->DmfModuleBufferQueue,
@@ -20,6 +20,25 @@ Environment:
 
 #pragma once
 
+// Selects how the stack stores its elements.
+//
+typedef enum
+{
+    // Elements are stored in a child DMF_BufferQueue. StackDepth buffers are preallocated and
+    // more are allocated as needed.
+    //
+    Stack_Mode_BufferQueue = 0,
+    // Elements are stored in a single preallocated array of StackDepth elements which is
+    // protected by the Module lock. Push fails when the stack is full.
+    //
+    Stack_Mode_Array,
+    // Same as Stack_Mode_Array but Push and Pop do not acquire any lock. Use this mode
+    // when many threads push and pop at the same time.
+    //
+    Stack_Mode_ArrayLockFree,
+    Stack_Mode_Maximum
+} Stack_ModeType;
+
 // Client uses this structure to configure the Module specific parameters.
 //
 typedef struct
@@ -30,6 +49,9 @@ typedef struct
     // The size of each entry.
     //
     ULONG StackElementSize;
+    // How the stack stores its elements.
+    //
+    Stack_ModeType Mode;
 } DMF_CONFIG_Stack;
 
 // This macro declares the following functions:
@@ -64,6 +86,16 @@ DMF_Stack_Pop(
     _In_ size_t ClientBufferSize
     );
 
+_IRQL_requires_max_(DISPATCH_LEVEL)
+_Must_inspect_result_
+NTSTATUS
+DMF_Stack_PopAll(
+    _In_ DMFMODULE DmfModule,
+    _Out_writes_bytes_(ClientBufferSize) VOID* ClientBuffer,
+    _In_ size_t ClientBufferSize,
+    _Out_ ULONG* NumberOfElements
+    );
+
 _IRQL_requires_max_(DISPATCH_LEVEL)
 _Must_inspect_result_
 NTSTATUS
@@ -70,6 +70,13 @@ typedef struct _DMF_CONTEXT_Thread
     // Indicates whether the thread is suspended.
     //
     BOOLEAN IsStopped;
+    // Time in microseconds of the first DMF_Thread_WorkReady() not yet handled
+    // by the thread. Zero if there is none.
+    //
+    volatile LONG64 WorkReadyTimeUs;
+    // Statistics about how the thread wakes up to do work.
+    //
+    Thread_Statistics Statistics;
 } DMF_CONTEXT_Thread;
 
 // This macro declares the following function:
@@ -91,6 +98,145 @@ DMF_MODULE_DECLARE_CONFIG(Thread)
 ///////////////////////////////////////////////////////////////////////////////////////////////////////
 //
 
+static
+ULONGLONG
+Thread_TimeMicrosecondsGet(
+    VOID
+    )
+/*++
+
+Routine Description:
+
+    Returns the current value of the performance counter in microseconds.
+
+Arguments:
+
+    None
+
+Return Value:
+
+    The current value of the performance counter in microseconds.
+
+--*/
+{
+    LARGE_INTEGER counter;
+    LARGE_INTEGER frequency;
+
+#if defined(DMF_USER_MODE)
+    QueryPerformanceCounter(&counter);
+    QueryPerformanceFrequency(&frequency);
+#else
+    counter = KeQueryPerformanceCounter(&frequency);
+#endif // defined(DMF_USER_MODE)
+
+    return (ULONGLONG)((counter.QuadPart / frequency.QuadPart) * 1000 * 1000) +
+           (ULONGLONG)(((counter.QuadPart % frequency.QuadPart) * 1000 * 1000) / frequency.QuadPart);
+}
+
+#pragma code_seg("PAGE")
+_IRQL_requires_max_(PASSIVE_LEVEL)
+static
+VOID
+Thread_ThreadPropertiesSet(
+    _In_ DMFMODULE DmfModule
+    )
+/*++
+
+Routine Description:
+
+    Apply the affinity, ideal processor and priority the Client set in the Config to the
+    current thread (this Module's thread). Failures are traced but are not fatal because
+    the thread can still do its work.
+
+Arguments:
+
+    DmfModule - This Module's handle.
+
+Return Value:
+
+    None
+
+--*/
+{
+    DMF_CONFIG_Thread* moduleConfig;
+
+    PAGED_CODE();
+
+    moduleConfig = DMF_CONFIG_GET(DmfModule);
+
+#if !defined(DMF_USER_MODE)
+    if (moduleConfig->AffinityMask != 0)
+    {
+        KAFFINITY affinity;
+
+        affinity = (KAFFINITY)moduleConfig->AffinityMask & KeQueryActiveProcessors();
+        if (0 == affinity)
+        {
+            TraceEvents(TRACE_LEVEL_ERROR, DMF_TRACE, "AffinityMask=0x%Ix has no active processors", moduleConfig->AffinityMask);
+        }
+        else
+        {
+            KeSetSystemAffinityThreadEx(affinity);
+        }
+    }
+
+    if (moduleConfig->IdealProcessorSet)
+    {
+        if (moduleConfig->IdealProcessor >= KeQueryActiveProcessorCount(NULL))
+        {
+            TraceEvents(TRACE_LEVEL_ERROR, DMF_TRACE, "IdealProcessor=%u is not active", moduleConfig->IdealProcessor);
+        }
+        else
+        {
+            KeSetIdealProcessorThread(KeGetCurrentThread(),
+                                      (UCHAR)moduleConfig->IdealProcessor);
+        }
+    }
+
+    if (moduleConfig->ThreadPrioritySet)
+    {
+        if ((moduleConfig->ThreadPriority < LOW_PRIORITY) ||
+            (moduleConfig->ThreadPriority > HIGH_PRIORITY))
+        {
+            TraceEvents(TRACE_LEVEL_ERROR, DMF_TRACE, "ThreadPriority=%d is invalid", moduleConfig->ThreadPriority);
+        }
+        else
+        {
+            KeSetPriorityThread(KeGetCurrentThread(),
+                                (KPRIORITY)moduleConfig->ThreadPriority);
+        }
+    }
+#else
+    if (moduleConfig->AffinityMask != 0)
+    {
+        if (0 == SetThreadAffinityMask(GetCurrentThread(),
+                                       (DWORD_PTR)moduleConfig->AffinityMask))
+        {
+            TraceEvents(TRACE_LEVEL_ERROR, DMF_TRACE, "SetThreadAffinityMask fails: AffinityMask=0x%Ix error=%d", moduleConfig->AffinityMask, GetLastError());
+        }
+    }
+
+    if (moduleConfig->IdealProcessorSet)
+    {
+        if ((DWORD)-1 == SetThreadIdealProcessor(GetCurrentThread(),
+                                                 moduleConfig->IdealProcessor))
+        {
+            TraceEvents(TRACE_LEVEL_ERROR, DMF_TRACE, "SetThreadIdealProcessor fails: IdealProcessor=%u error=%d", moduleConfig->IdealProcessor, GetLastError());
+        }
+    }
+
+    if (moduleConfig->ThreadPrioritySet)
+    {
+        if (! SetThreadPriority(GetCurrentThread(),
+                                moduleConfig->ThreadPriority))
+        {
+            TraceEvents(TRACE_LEVEL_ERROR, DMF_TRACE, "SetThreadPriority fails: ThreadPriority=%d error=%d", moduleConfig->ThreadPriority, GetLastError());
+        }
+    }
+#endif // !defined(DMF_USER_MODE)
+}
+#pragma code_seg()
+
 #pragma code_seg("PAGE")
 _IRQL_requires_max_(PASSIVE_LEVEL)
 VOID
@@ -120,6 +266,11 @@ Return Value:
     #define Thread_NumberOfWaitObjects (2)
     DMF_PORTABLE_EVENT* waitObjects[Thread_NumberOfWaitObjects];
     NTSTATUS waitStatus;
+    ULONG spinIndex;
+    ULONG timeoutMs;
+    BOOLEAN waited;
+    LONG64 workReadyTimeUs;
+    ULONG64 wakeLatencyUs;
 
     PAGED_CODE();
 
@@ -138,18 +289,69 @@ Return Value:
     waitObjects[0] = &moduleContext->EventStop;
     waitObjects[1] = &moduleContext->EventWorkReady;
 
+    timeoutMs = 0;
     waitStatus = STATUS_WAIT_1;
     while (STATUS_WAIT_0 != waitStatus)
     {
-        waitStatus = DMF_Portable_EventWaitForMultiple(ARRAYSIZE(waitObjects),
-                                                       waitObjects,
-                                                       FALSE,
-                                                       NULL,
-                                                       FALSE);
+        // Poll for work before waiting for it, if the Client wants to.
+        //
+        waitStatus = STATUS_TIMEOUT;
+        for (spinIndex = 0; spinIndex < moduleConfig->ThreadControl.DmfControl.SpinCountBeforeWait; spinIndex++)
+        {
+            waitStatus = DMF_Portable_EventWaitForMultiple(ARRAYSIZE(waitObjects),
+                                                           waitObjects,
+                                                           FALSE,
+                                                           &timeoutMs,
+                                                           FALSE);
+            if (STATUS_TIMEOUT != waitStatus)
+            {
+                break;
+            }
+            YieldProcessor();
+        }
+
+        waited = FALSE;
+        if (STATUS_TIMEOUT == waitStatus)
+        {
+            waited = TRUE;
+            waitStatus = DMF_Portable_EventWaitForMultiple(ARRAYSIZE(waitObjects),
+                                                           waitObjects,
+                                                           FALSE,
+                                                           NULL,
+                                                           FALSE);
+        }
+
         switch (waitStatus)
         {
             case STATUS_WAIT_1:
             {
+                // Measure the time since the work was signaled.
+                //
+                wakeLatencyUs = 0;
+                workReadyTimeUs = InterlockedExchange64(&moduleContext->WorkReadyTimeUs,
+                                                        0);
+                if (workReadyTimeUs != 0)
+                {
+                    wakeLatencyUs = Thread_TimeMicrosecondsGet() - (ULONG64)workReadyTimeUs;
+                }
+
+                DMF_ModuleLock(DmfModule);
+                moduleContext->Statistics.WorkCallbacks++;
+                if (waited)
+                {
+                    moduleContext->Statistics.WaitWakes++;
+                }
+                else
+                {
+                    moduleContext->Statistics.SpinWakes++;
+                }
+                moduleContext->Statistics.WakeLatencyTotalUs += wakeLatencyUs;
+                if (wakeLatencyUs > moduleContext->Statistics.WakeLatencyMaximumUs)
+                {
+                    moduleContext->Statistics.WakeLatencyMaximumUs = wakeLatencyUs;
+                }
+                DMF_ModuleUnlock(DmfModule);
+
                 // Do the work the Client needs to do.
                 //
                 DmfAssert(moduleConfig->ThreadControl.DmfControl.EvtThreadWork != NULL);
@@ -232,6 +434,8 @@ Return Value:
 
     moduleContext = DMF_CONTEXT_GET(dmfModule);
 
+    Thread_ThreadPropertiesSet(dmfModule);
+
     waitObjects[0] = &moduleContext->EventStart;
     waitObjects[1] = &moduleContext->EventClose;
 
@@ -895,6 +1099,46 @@ Return Value:
 }
 #pragma code_seg()
 
+_IRQL_requires_max_(DISPATCH_LEVEL)
+VOID
+DMF_Thread_StatisticsGet(
+    _In_ DMFMODULE DmfModule,
+    _Out_ Thread_Statistics* Statistics
+    )
+/*++
+
+Routine Description:
+
+    Returns the statistics this Module maintains so that Clients can see how long
+    the thread takes to start work after DMF_Thread_WorkReady() is called.
+
+Arguments:
+
+    DmfModule - This Module's handle.
+    Statistics - Returns the statistics.
+
+Return Value:
+
+    None
+
+--*/
+{
+    DMF_CONTEXT_Thread* moduleContext;
+
+    FuncEntry(DMF_TRACE);
+
+    DMFMODULE_VALIDATE_IN_METHOD(DmfModule,
+                                 Thread);
+
+    moduleContext = DMF_CONTEXT_GET(DmfModule);
+
+    DMF_ModuleLock(DmfModule);
+    *Statistics = moduleContext->Statistics;
+    DMF_ModuleUnlock(DmfModule);
+
+    FuncExitVoid(DMF_TRACE);
+}
+
 #pragma code_seg("PAGE")
 _IRQL_requires_max_(PASSIVE_LEVEL)
 _Must_inspect_result_
@@ -1027,6 +1271,12 @@ Return Value:
 
     moduleContext = DMF_CONTEXT_GET(DmfModule);
 
+    // Remember when the first unhandled work was signaled to measure wake latency.
+    //
+    InterlockedCompareExchange64(&moduleContext->WorkReadyTimeUs,
+                                 (LONG64)Thread_TimeMicrosecondsGet(),
+                                 0);
+
     DMF_Portable_EventSet(&moduleContext->EventWorkReady);
 
     FuncExitVoid(DMF_TRACE);
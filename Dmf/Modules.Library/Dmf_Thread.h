@@ -75,10 +75,56 @@ typedef struct
             // Optional callback that does work after looping but before thread ends.
             //
             EVT_DMF_Thread_Function* EvtThreadPost;
+            // Optional number of times the thread polls for work before it waits
+            // for work. This avoids wake up latency when work is signaled shortly
+            // after the previous work completes at the cost of CPU time.
+            //
+            ULONG SpinCountBeforeWait;
         } DmfControl;
     } ThreadControl;
+    // Optional processors the thread may run on (in the current processor group).
+    // Zero means the thread may run on any processor.
+    //
+    ULONG_PTR AffinityMask;
+    // Indicates that IdealProcessor is valid.
+    //
+    BOOLEAN IdealProcessorSet;
+    // Processor the scheduler should prefer for the thread.
+    //
+    ULONG IdealProcessor;
+    // Indicates that ThreadPriority is valid.
+    //
+    BOOLEAN ThreadPrioritySet;
+    // Priority of the thread.
+    // Kernel-mode: KPRIORITY (for example, LOW_REALTIME_PRIORITY).
+    // User-mode: THREAD_PRIORITY_* (for example, THREAD_PRIORITY_ABOVE_NORMAL).
+    //
+    LONG ThreadPriority;
 } DMF_CONFIG_Thread;
 
+// Statistics maintained by this Module when ThreadControlType_DmfControl is used.
+//
+typedef struct
+{
+    // Number of times the work callback has been called.
+    //
+    ULONG64 WorkCallbacks;
+    // Number of times work was found while polling before waiting.
+    //
+    ULONG64 SpinWakes;
+    // Number of times the thread waited for work.
+    //
+    ULONG64 WaitWakes;
+    // Total time in microseconds between DMF_Thread_WorkReady() and the start
+    // of the corresponding work callback.
+    //
+    ULONG64 WakeLatencyTotalUs;
+    // Largest time in microseconds between DMF_Thread_WorkReady() and the start
+    // of the corresponding work callback.
+    //
+    ULONG64 WakeLatencyMaximumUs;
+} Thread_Statistics;
+
 // This macro declares the following functions:
 // DMF_Thread_ATTRIBUTES_INIT()
 // DMF_CONFIG_Thread_AND_ATTRIBUTES_INIT()
@@ -95,6 +141,13 @@ DMF_Thread_IsStopPending(
     _In_ DMFMODULE DmfModule
     );
 
+_IRQL_requires_max_(DISPATCH_LEVEL)
+VOID
+DMF_Thread_StatisticsGet(
+    _In_ DMFMODULE DmfModule,
+    _Out_ Thread_Statistics* Statistics
+    );
+
 _IRQL_requires_max_(PASSIVE_LEVEL)
 _Must_inspect_result_
 NTSTATUS
@@ -33,8 +33,11 @@ Environment:
 ///////////////////////////////////////////////////////////////////////////////////////////////////////
 //
 
-typedef struct
+typedef struct _ThreadedBufferQueue_WorkBufferInternal
 {
+    // Next work buffer in the lock-free Consumer list.
+    //
+    struct _ThreadedBufferQueue_WorkBufferInternal* Next;
     // Optional Status.
     //
     NTSTATUS* NtStatus;
@@ -56,6 +59,25 @@ typedef struct _DMF_CONTEXT_ThreadedBufferQueue
     // Thread that reads BufferQueue to get work and return buffers.
     //
     DMFMODULE DmfModuleThread;
+    // Lock-free Consumer list used when LockFreeConsumerList is set.
+    // Producers add work buffers to PendingList and PendingAtHeadList without acquiring a lock.
+    // The consumer moves PendingList to ConsumerList in FIFO order while holding the Module lock.
+    //
+    ThreadedBufferQueue_WorkBufferInternal* volatile PendingList;
+    ThreadedBufferQueue_WorkBufferInternal* volatile PendingAtHeadList;
+    ThreadedBufferQueue_WorkBufferInternal* ConsumerList;
+    // Number of work buffers in the lock-free Consumer list.
+    //
+    volatile LONG ConsumerListCount;
+    // Set when the thread stops consuming work while work is pending so that the next
+    // enqueue sets the work ready event.
+    //
+    volatile LONG WorkReadyRequired;
+    // Statistics.
+    //
+    volatile LONG64 EnqueueCount;
+    volatile LONG64 DequeueCount;
+    volatile LONG64 WorkReadyCount;
 } DMF_CONTEXT_ThreadedBufferQueue;
 
 // This macro declares the following function:
@@ -240,6 +262,194 @@ Return Value:
     FuncExitVoid(DMF_TRACE);
 }
 
+static
+BOOLEAN
+ThreadedBufferQueue_LockFreePush(
+    _Inout_ ThreadedBufferQueue_WorkBufferInternal* volatile* ListHead,
+    _In_ ThreadedBufferQueue_WorkBufferInternal* WorkBuffer
+    )
+/*++
+
+Routine Description:
+
+    Adds a work buffer to the head of a lock-free list. Any number of callers may add work buffers
+    at the same time.
+
+Arguments:
+
+    ListHead - The given list.
+    WorkBuffer - The work buffer to add.
+
+Return Value:
+
+    TRUE if the list was empty.
+
+--*/
+{
+    ThreadedBufferQueue_WorkBufferInternal* listHead;
+
+    do
+    {
+        listHead = *ListHead;
+        WorkBuffer->Next = listHead;
+    } while (InterlockedCompareExchangePointer((VOID* volatile*)ListHead,
+                                               WorkBuffer,
+                                               listHead) != listHead);
+
+    return (listHead == NULL);
+}
+
+static
+ThreadedBufferQueue_WorkBufferInternal*
+ThreadedBufferQueue_LockFreePop(
+    _In_ DMFMODULE DmfModule
+    )
+/*++
+
+Routine Description:
+
+    Removes the next work buffer from the lock-free Consumer list. Work buffers added at head are
+    removed first, most recent first. Other work buffers are removed in FIFO order.
+
+Arguments:
+
+    DmfModule - This Module's handle.
+
+Return Value:
+
+    The work buffer or NULL if the list is empty.
+
+--*/
+{
+    DMF_CONTEXT_ThreadedBufferQueue* moduleContext;
+    ThreadedBufferQueue_WorkBufferInternal* workBuffer;
+    ThreadedBufferQueue_WorkBufferInternal* previousWorkBuffer;
+    ThreadedBufferQueue_WorkBufferInternal* pendingList;
+    ThreadedBufferQueue_WorkBufferInternal* nextWorkBuffer;
+
+    moduleContext = DMF_CONTEXT_GET(DmfModule);
+
+    // Only one caller removes work buffers at a time. Producers never wait for this lock.
+    //
+    DMF_ModuleLock(DmfModule);
+
+    // Since only this caller removes work buffers, the work buffer at the head of the list cannot
+    // be removed and added again before it is replaced by the next one.
+    //
+    workBuffer = moduleContext->PendingAtHeadList;
+    while (workBuffer != NULL)
+    {
+        previousWorkBuffer = (ThreadedBufferQueue_WorkBufferInternal*)InterlockedCompareExchangePointer((VOID* volatile*)&moduleContext->PendingAtHeadList,
+                                                                                                        workBuffer->Next,
+                                                                                                        workBuffer);
+        if (previousWorkBuffer == workBuffer)
+        {
+            break;
+        }
+        workBuffer = previousWorkBuffer;
+    }
+
+    if (NULL == workBuffer)
+    {
+        if (NULL == moduleContext->ConsumerList)
+        {
+            // Take all the pending work at once. It is in LIFO order so reverse it.
+            //
+            pendingList = (ThreadedBufferQueue_WorkBufferInternal*)InterlockedExchangePointer((VOID* volatile*)&moduleContext->PendingList,
+                                                                                              NULL);
+            while (pendingList != NULL)
+            {
+                nextWorkBuffer = pendingList->Next;
+                pendingList->Next = moduleContext->ConsumerList;
+                moduleContext->ConsumerList = pendingList;
+                pendingList = nextWorkBuffer;
+            }
+        }
+
+        workBuffer = moduleContext->ConsumerList;
+        if (workBuffer != NULL)
+        {
+            moduleContext->ConsumerList = workBuffer->Next;
+        }
+    }
+
+    DMF_ModuleUnlock(DmfModule);
+
+    if (workBuffer != NULL)
+    {
+        workBuffer->Next = NULL;
+        InterlockedDecrement(&moduleContext->ConsumerListCount);
+    }
+
+    return workBuffer;
+}
+
+static
+NTSTATUS
+ThreadedBufferQueue_Dequeue(
+    _In_ DMFMODULE DmfModule,
+    _Out_ ThreadedBufferQueue_WorkBufferInternal** WorkBuffer,
+    _Out_ VOID** WorkBufferContext
+    )
+/*++
+
+Routine Description:
+
+    Removes the next work buffer from the Consumer list.
+
+Arguments:
+
+    DmfModule - This Module's handle.
+    WorkBuffer - The work buffer removed from the list.
+    WorkBufferContext - Client context associated with the work buffer.
+
+Return Value:
+
+    STATUS_SUCCESS if a work buffer is removed from the list.
+    STATUS_UNSUCCESSFUL if the list is empty.
+
+--*/
+{
+    NTSTATUS ntStatus;
+    DMF_CONTEXT_ThreadedBufferQueue* moduleContext;
+    DMF_CONFIG_ThreadedBufferQueue* moduleConfig;
+
+    moduleContext = DMF_CONTEXT_GET(DmfModule);
+    moduleConfig = DMF_CONFIG_GET(DmfModule);
+
+    if (moduleConfig->LockFreeConsumerList)
+    {
+        *WorkBuffer = ThreadedBufferQueue_LockFreePop(DmfModule);
+        if (NULL == *WorkBuffer)
+        {
+            *WorkBufferContext = NULL;
+            ntStatus = STATUS_UNSUCCESSFUL;
+            goto Exit;
+        }
+
+        DMF_BufferQueue_ContextGet(moduleContext->DmfModuleBufferQueue,
+                                   *WorkBuffer,
+                                   WorkBufferContext);
+        ntStatus = STATUS_SUCCESS;
+    }
+    else
+    {
+        ntStatus = DMF_BufferQueue_Dequeue(moduleContext->DmfModuleBufferQueue,
+                                           (VOID**)WorkBuffer,
+                                           WorkBufferContext);
+        if (! NT_SUCCESS(ntStatus))
+        {
+            goto Exit;
+        }
+    }
+
+    InterlockedIncrement64(&moduleContext->DequeueCount);
+
+Exit:
+
+    return ntStatus;
+}
+
 #pragma code_seg("PAGE")
 _Function_class_(EVT_DMF_Thread_Function)
 VOID
@@ -271,6 +481,7 @@ Return Value:
     VOID* clientWorkBuffer;
     VOID* clientWorkBufferContext;
     DMFMODULE dmfModuleThreadedBufferQueue;
+    LONG64 enqueueCount;
 
     PAGED_CODE();
 
@@ -284,9 +495,9 @@ Start:
 
     // Get a buffer that contains the work the Client wants to do.
     //
-    ntStatus = DMF_BufferQueue_Dequeue(moduleContext->DmfModuleBufferQueue,
-                                       (VOID**)&workBuffer,
-                                       &clientWorkBufferContext);
+    ntStatus = ThreadedBufferQueue_Dequeue(dmfModuleThreadedBufferQueue,
+                                           &workBuffer,
+                                           &clientWorkBufferContext);
     if (! NT_SUCCESS(ntStatus))
     {
         // NOTE: Failure is expected and normal. It means there is no more work to do.
@@ -303,6 +514,7 @@ Start:
     //
     ThreadedBufferQueue_BufferDisposition bufferDisposition;
 
+    enqueueCount = moduleContext->EnqueueCount;
     bufferDisposition = moduleConfig->EvtThreadedBufferQueueWork(dmfModuleThreadedBufferQueue,
                                                                  (UCHAR*)clientWorkBuffer,
                                                                  moduleConfig->BufferQueueConfig.SourceSettings.BufferSize,
@@ -322,6 +534,20 @@ Start:
         // Do not retrieve the next buffer. 
         // (If Client wants to retrieve next buffer, Client should set this Module's work ready event.)
         //
+        if (moduleConfig->LockFreeConsumerList)
+        {
+            // Enqueue only sets the work ready event when the list was empty. Make sure work enqueued
+            // from now on sets it. Work enqueued while the Client did the work would have set it.
+            //
+            InterlockedExchange(&moduleContext->WorkReadyRequired,
+                                TRUE);
+            if ((enqueueCount != moduleContext->EnqueueCount) &&
+                InterlockedExchange(&moduleContext->WorkReadyRequired,
+                                    FALSE))
+            {
+                DMF_Thread_WorkReady(DmfModule);
+            }
+        }
         goto Exit;
     }
     else
@@ -369,6 +595,82 @@ Return Value:
     FuncExitVoid(DMF_TRACE);
 }
 
+static
+VOID
+ThreadedBufferQueue_Enqueue(
+    _In_ DMFMODULE DmfModule,
+    _In_ ThreadedBufferQueue_WorkBufferInternal* WorkBuffer,
+    _In_ BOOLEAN AtHead
+    )
+/*++
+
+Routine Description:
+
+    Adds a work buffer to the Consumer list and sets the work ready event if needed.
+
+Arguments:
+
+    DmfModule - This Module's handle.
+    WorkBuffer - The work buffer to add.
+    AtHead - Add the work buffer to the head of the list instead of the end.
+
+Return Value:
+
+    None
+
+--*/
+{
+    DMF_CONTEXT_ThreadedBufferQueue* moduleContext;
+    DMF_CONFIG_ThreadedBufferQueue* moduleConfig;
+    BOOLEAN workReady;
+
+    moduleContext = DMF_CONTEXT_GET(DmfModule);
+    moduleConfig = DMF_CONFIG_GET(DmfModule);
+
+    InterlockedIncrement64(&moduleContext->EnqueueCount);
+
+    if (moduleConfig->LockFreeConsumerList)
+    {
+        BOOLEAN listWasEmpty;
+
+        InterlockedIncrement(&moduleContext->ConsumerListCount);
+
+        listWasEmpty = ThreadedBufferQueue_LockFreePush(AtHead ? &moduleContext->PendingAtHeadList : &moduleContext->PendingList,
+                                                        WorkBuffer);
+
+        // The thread consumes work until the list is empty. So, it only needs to be told about work
+        // added to an empty list or added after it stopped with work still pending.
+        //
+        workReady = listWasEmpty;
+        if ((! workReady) &&
+            (moduleContext->WorkReadyRequired != FALSE))
+        {
+            workReady = (InterlockedExchange(&moduleContext->WorkReadyRequired,
+                                             FALSE) != FALSE);
+        }
+    }
+    else
+    {
+        if (AtHead)
+        {
+            DMF_BufferQueue_EnqueueAtHead(moduleContext->DmfModuleBufferQueue,
+                                          WorkBuffer);
+        }
+        else
+        {
+            DMF_BufferQueue_Enqueue(moduleContext->DmfModuleBufferQueue,
+                                    WorkBuffer);
+        }
+        workReady = TRUE;
+    }
+
+    if (workReady)
+    {
+        InterlockedIncrement64(&moduleContext->WorkReadyCount);
+        ThreadedBufferQueue_WorkReady(DmfModule);
+    }
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////////
 // WDF Module Callbacks
 ///////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -593,6 +895,7 @@ Return Value:
 --*/
 {
     DMF_CONTEXT_ThreadedBufferQueue* moduleContext;
+    DMF_CONFIG_ThreadedBufferQueue* moduleConfig;
     ULONG numberOfEntriesInList;
 
     FuncEntry(DMF_TRACE);
@@ -601,8 +904,16 @@ Return Value:
                                  ThreadedBufferQueue);
 
     moduleContext = DMF_CONTEXT_GET(DmfModule);
+    moduleConfig = DMF_CONFIG_GET(DmfModule);
 
-    numberOfEntriesInList = DMF_BufferQueue_Count(moduleContext->DmfModuleBufferQueue);
+    if (moduleConfig->LockFreeConsumerList)
+    {
+        numberOfEntriesInList = (ULONG)moduleContext->ConsumerListCount;
+    }
+    else
+    {
+        numberOfEntriesInList = DMF_BufferQueue_Count(moduleContext->DmfModuleBufferQueue);
+    }
 
     FuncExit(DMF_TRACE, "numberOfEntriesInList=%d", numberOfEntriesInList);
 
@@ -649,10 +960,9 @@ Return Value:
     workBuffer->Event = NULL;
     workBuffer->NtStatus = NULL;
 
-    DMF_BufferQueue_Enqueue(moduleContext->DmfModuleBufferQueue,
-                            workBuffer);
-
-    ThreadedBufferQueue_WorkReady(DmfModule);
+    ThreadedBufferQueue_Enqueue(DmfModule,
+                                workBuffer,
+                                FALSE);
 
     FuncExitVoid(DMF_TRACE);
 }
@@ -697,10 +1007,9 @@ Return Value:
     workBuffer->Event = NULL;
     workBuffer->NtStatus = NULL;
 
-    DMF_BufferQueue_EnqueueAtHead(moduleContext->DmfModuleBufferQueue,
-                                  workBuffer);
-
-    ThreadedBufferQueue_WorkReady(DmfModule);
+    ThreadedBufferQueue_Enqueue(DmfModule,
+                                workBuffer,
+                                TRUE);
 
     FuncExitVoid(DMF_TRACE);
 }
@@ -756,10 +1065,9 @@ Return Value:
     workBuffer->Event = &event;
     workBuffer->NtStatus = &ntStatus;
 
-    DMF_BufferQueue_Enqueue(moduleContext->DmfModuleBufferQueue,
-                            workBuffer);
-
-    ThreadedBufferQueue_WorkReady(DmfModule);
+    ThreadedBufferQueue_Enqueue(DmfModule,
+                                workBuffer,
+                                FALSE);
 
     // Infinite wait for the work to execute.
     //
@@ -828,10 +1136,9 @@ Return Value:
     workBuffer->Event = &event;
     workBuffer->NtStatus = &ntStatus;
 
-    DMF_BufferQueue_EnqueueAtHead(moduleContext->DmfModuleBufferQueue,
-                                  workBuffer);
-
-    ThreadedBufferQueue_WorkReady(DmfModule);
+    ThreadedBufferQueue_Enqueue(DmfModule,
+                                workBuffer,
+                                TRUE);
 
     // Infinite wait for the work to execute.
     //
@@ -946,9 +1253,9 @@ Return Value:
     ntStatus = STATUS_SUCCESS;
     while (NT_SUCCESS(ntStatus))
     {
-        ntStatus = DMF_BufferQueue_Dequeue(moduleContext->DmfModuleBufferQueue,
-                                           (VOID**)&workBuffer,
-                                           &bufferContext);
+        ntStatus = ThreadedBufferQueue_Dequeue(DmfModule,
+                                               &workBuffer,
+                                               &bufferContext);
         if (NT_SUCCESS(ntStatus))
         {
             // Return to free queue and tell caller no work was done.
@@ -1057,6 +1364,56 @@ Exit:
 }
 #pragma code_seg()
 
+_IRQL_requires_max_(DISPATCH_LEVEL)
+VOID
+DMF_ThreadedBufferQueue_StatisticsGet(
+    _In_ DMFMODULE DmfModule,
+    _Out_ ULONG64* EnqueueCount,
+    _Out_ ULONG64* DequeueCount,
+    _Out_ ULONG64* WorkReadyCount
+    )
+/*++
+
+Routine Description:
+
+    Returns the number of work buffers enqueued and dequeued and the number of times the
+    work ready event has been set by enqueues since the Module was created.
+
+Arguments:
+
+    DmfModule - This Module's handle.
+    EnqueueCount - Number of work buffers enqueued.
+    DequeueCount - Number of work buffers dequeued by the thread or flushed.
+    WorkReadyCount - Number of times an enqueue set the work ready event.
+
+Return Value:
+
+    None
+
+--*/
+{
+    DMF_CONTEXT_ThreadedBufferQueue* moduleContext;
+
+    FuncEntry(DMF_TRACE);
+
+    DMFMODULE_VALIDATE_IN_METHOD(DmfModule,
+                                 ThreadedBufferQueue);
+
+    moduleContext = DMF_CONTEXT_GET(DmfModule);
+
+    *EnqueueCount = (ULONG64)InterlockedCompareExchange64(&moduleContext->EnqueueCount,
+                                                          0,
+                                                          0);
+    *DequeueCount = (ULONG64)InterlockedCompareExchange64(&moduleContext->DequeueCount,
+                                                          0,
+                                                          0);
+    *WorkReadyCount = (ULONG64)InterlockedCompareExchange64(&moduleContext->WorkReadyCount,
+                                                            0,
+                                                            0);
+
+    FuncExitVoid(DMF_TRACE);
+}
+
 #pragma code_seg("PAGE")
 _IRQL_requires_max_(PASSIVE_LEVEL)
 VOID
@@ -80,6 +80,10 @@ typedef struct
     // buffer-attached resources.
     //
     EVT_DMF_ThreadedBufferQueue_ReuseCleanup* EvtThreadedBufferQueueReuseCleanup;
+    // Optional. Pending work is kept in a lock-free list instead of the Consumer list of BufferQueueConfig.
+    // Enqueue does not acquire a lock and only sets the work ready event when the list was empty.
+    //
+    BOOLEAN LockFreeConsumerList;
 } DMF_CONFIG_ThreadedBufferQueue;
 
 // This macro declares the following functions:
@@ -158,6 +162,15 @@ DMF_ThreadedBufferQueue_Start(
     _In_ DMFMODULE DmfModule
     );
 
+_IRQL_requires_max_(DISPATCH_LEVEL)
+VOID
+DMF_ThreadedBufferQueue_StatisticsGet(
+    _In_ DMFMODULE DmfModule,
+    _Out_ ULONG64* EnqueueCount,
+    _Out_ ULONG64* DequeueCount,
+    _Out_ ULONG64* WorkReadyCount
+    );
+
 _IRQL_requires_max_(PASSIVE_LEVEL)
 VOID
 DMF_ThreadedBufferQueue_Stop(
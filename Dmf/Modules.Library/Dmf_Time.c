@@ -368,7 +368,9 @@ Return Value:
     QueryPerformanceCounter(&endTick);
 #endif
 
-    DmfAssert(StartTick < endTick.QuadPart);
+    // Both tick counts are the same when very little time has elapsed.
+    //
+    DmfAssert(StartTick <= endTick.QuadPart);
 
     // Calculate the elapsed time.
     //
@@ -0,0 +1,828 @@
+/*++
+
+    Copyright (c) Microsoft Corporation. All rights reserved.
+    Licensed under the MIT license.
+
+Module Name:
+
+    Dmf_TimerWheel.c
+
+Abstract:
+
+    Services any number of Client timers using a single WDFTIMER. Timers are kept in
+    a hashed timer wheel. The WDFTIMER ticks only while at least one timer is started
+    and, on each tick, calls the callbacks of all the timers that expired in that tick.
+
+Environment:
+
+    Kernel-mode Driver Framework
+    User-mode Driver Framework
+
+--*/
+
+// DMF and this Module's Library specific definitions.
+//
+#include "DmfModule.h"
+#include "DmfModules.Library.h"
+#include "DmfModules.Library.Trace.h"
+
+#if defined(DMF_INCLUDE_TMH)
+#include "Dmf_TimerWheel.tmh"
+#endif
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+// Module Private Enumerations and Structures
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+// Module Private Context
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+
+typedef struct _DMF_CONTEXT_TimerWheel
+{
+    // One list of timers for each slot of the wheel.
+    // A timer is in the slot (ExpirationTick % NumberOfSlots).
+    //
+    WDFMEMORY SlotsMemory;
+    LIST_ENTRY* Slots;
+    ULONG NumberOfSlots;
+    // Duration of a tick.
+    //
+    ULONG TickMilliseconds;
+    ULONGLONG TickTime100ns;
+    // Tick numbers are counted from this time.
+    //
+    ULONGLONG StartTime100ns;
+    // All slots up to and including this tick have been processed.
+    //
+    ULONGLONG CurrentTick;
+    // The single timer that drives the wheel.
+    //
+    WDFTIMER TickTimer;
+    // Indicates TickTimer is started or its callback is running.
+    //
+    BOOLEAN TickTimerStarted;
+    // Prevents TickTimer from restarting when the Module closes.
+    //
+    BOOLEAN Closing;
+    // Timers that have expired but whose callbacks have not been called yet.
+    //
+    LIST_ENTRY ExpiredList;
+    // Timer whose callback is being called and the event that is set when that
+    // callback returns. Allows DMF_TimerWheel_TimerStop() to wait for the callback.
+    //
+    TimerWheel_Timer* ExecutingTimer;
+    DMF_PORTABLE_EVENT ExecutingTimerDoneEvent;
+    // Statistics returned to the Client.
+    //
+    TimerWheel_Statistics Statistics;
+} DMF_CONTEXT_TimerWheel;
+
+// This macro declares the following function:
+// DMF_CONTEXT_GET()
+//
+DMF_MODULE_DECLARE_CONTEXT(TimerWheel)
+
+// This macro declares the following function:
+// DMF_CONFIG_GET()
+//
+DMF_MODULE_DECLARE_CONFIG(TimerWheel)
+
+// Memory Pool Tag.
+//
+#define MemoryTag 'MWmT'
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+// DMF Module Support Code
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+
+static
+ULONGLONG
+TimerWheel_CurrentTime100nsGet(
+    VOID
+    )
+/*++
+
+Routine Description:
+
+    Returns the current interrupt time in 100ns units.
+
+Arguments:
+
+    None
+
+Return Value:
+
+    Current interrupt time.
+
+--*/
+{
+    ULONGLONG currentInterruptTime;
+
+#if defined(DMF_USER_MODE)
+    QueryInterruptTime(&currentInterruptTime);
+#else
+    currentInterruptTime = KeQueryInterruptTime();
+#endif
+
+    return currentInterruptTime;
+}
+
+static
+ULONGLONG
+TimerWheel_CurrentTickGet(
+    _In_ DMF_CONTEXT_TimerWheel* ModuleContext
+    )
+/*++
+
+Routine Description:
+
+    Returns the number of the tick the wheel is in now.
+
+Arguments:
+
+    ModuleContext - This Module's context.
+
+Return Value:
+
+    Tick number.
+
+--*/
+{
+    return (TimerWheel_CurrentTime100nsGet() - ModuleContext->StartTime100ns) / ModuleContext->TickTime100ns;
+}
+
+static
+VOID
+TimerWheel_TickTimerStart(
+    _In_ DMFMODULE DmfModule
+    )
+/*++
+
+Routine Description:
+
+    Starts the tick timer if it is not running already.
+    NOTE: Module lock must be held.
+
+Arguments:
+
+    DmfModule - This Module's handle.
+
+Return Value:
+
+    None
+
+--*/
+{
+    DMF_CONTEXT_TimerWheel* moduleContext;
+
+    DmfAssert(DMF_ModuleIsLocked(DmfModule));
+
+    moduleContext = DMF_CONTEXT_GET(DmfModule);
+
+    if ((! moduleContext->TickTimerStarted) &&
+        (! moduleContext->Closing))
+    {
+        moduleContext->TickTimerStarted = TRUE;
+        WdfTimerStart(moduleContext->TickTimer,
+                      WDF_REL_TIMEOUT_IN_MS(moduleContext->TickMilliseconds));
+    }
+}
+
+_Function_class_(EVT_WDF_TIMER)
+_IRQL_requires_max_(PASSIVE_LEVEL)
+VOID
+TimerWheel_TickTimerHandler(
+    _In_ WDFTIMER WdfTimer
+    )
+/*++
+
+Routine Description:
+
+    Tick timer callback. Moves all the timers that expired since the previous tick
+    to the expired list and then calls each of their callbacks. The tick timer is
+    restarted only if there are timers still pending.
+
+Arguments:
+
+    WdfTimer - The tick timer.
+
+Return Value:
+
+    None
+
+--*/
+{
+    DMFMODULE dmfModule;
+    DMF_CONTEXT_TimerWheel* moduleContext;
+    ULONGLONG tickStartTime100ns;
+    ULONGLONG nowTick;
+    ULONGLONG tickToScan;
+    ULONGLONG numberOfTicksToScan;
+    LIST_ENTRY* slot;
+    LIST_ENTRY* listEntry;
+    TimerWheel_Timer* timer;
+    EVT_DMF_TimerWheel_TimerExpired* evtTimerWheelTimerExpired;
+    VOID* clientCallbackContext;
+    ULONG timersExpired;
+
+    dmfModule = (DMFMODULE)WdfTimerGetParentObject(WdfTimer);
+    moduleContext = DMF_CONTEXT_GET(dmfModule);
+
+    tickStartTime100ns = TimerWheel_CurrentTime100nsGet();
+
+    DMF_ModuleLock(dmfModule);
+
+    DmfAssert(moduleContext->TickTimerStarted);
+
+    // Process every slot between the last processed tick and now. If the tick timer
+    // ran late by more than a full turn of the wheel, each slot is visited once.
+    //
+    nowTick = TimerWheel_CurrentTickGet(moduleContext);
+    numberOfTicksToScan = nowTick - moduleContext->CurrentTick;
+    if (numberOfTicksToScan > moduleContext->NumberOfSlots)
+    {
+        numberOfTicksToScan = moduleContext->NumberOfSlots;
+    }
+
+    for (tickToScan = 1; tickToScan <= numberOfTicksToScan; tickToScan++)
+    {
+        slot = &moduleContext->Slots[(moduleContext->CurrentTick + tickToScan) % moduleContext->NumberOfSlots];
+        listEntry = slot->Flink;
+        while (listEntry != slot)
+        {
+            timer = CONTAINING_RECORD(listEntry,
+                                      TimerWheel_Timer,
+                                      ListEntry);
+            listEntry = listEntry->Flink;
+
+            // Timers further away than a full turn stay in the slot.
+            //
+            if (timer->ExpirationTick <= nowTick)
+            {
+                RemoveEntryList(&timer->ListEntry);
+                InsertTailList(&moduleContext->ExpiredList,
+                               &timer->ListEntry);
+            }
+        }
+    }
+    moduleContext->CurrentTick = nowTick;
+
+    // Call the callbacks of all the timers that expired in this tick.
+    // The lock is released while each callback runs so that it can start or stop timers.
+    //
+    timersExpired = 0;
+    while (! IsListEmpty(&moduleContext->ExpiredList))
+    {
+        listEntry = RemoveHeadList(&moduleContext->ExpiredList);
+        timer = CONTAINING_RECORD(listEntry,
+                                  TimerWheel_Timer,
+                                  ListEntry);
+        timer->Armed = FALSE;
+        DmfAssert(moduleContext->Statistics.TimersPending > 0);
+        moduleContext->Statistics.TimersPending--;
+        evtTimerWheelTimerExpired = timer->EvtTimerWheelTimerExpired;
+        clientCallbackContext = timer->ClientCallbackContext;
+        moduleContext->ExecutingTimer = timer;
+        DMF_Portable_EventReset(&moduleContext->ExecutingTimerDoneEvent);
+
+        DMF_ModuleUnlock(dmfModule);
+
+        // NOTE: Client may reuse or free the timer as soon as this callback returns.
+        //
+        evtTimerWheelTimerExpired(dmfModule,
+                                  timer,
+                                  clientCallbackContext);
+
+        DMF_ModuleLock(dmfModule);
+
+        moduleContext->ExecutingTimer = NULL;
+        DMF_Portable_EventSet(&moduleContext->ExecutingTimerDoneEvent);
+        moduleContext->Statistics.TimersExpired++;
+        timersExpired++;
+    }
+
+    moduleContext->Statistics.Ticks++;
+    if (timersExpired > moduleContext->Statistics.MaximumTimersExpiredPerTick)
+    {
+        moduleContext->Statistics.MaximumTimersExpiredPerTick = timersExpired;
+    }
+    moduleContext->Statistics.TickTime100ns += TimerWheel_CurrentTime100nsGet() - tickStartTime100ns;
+
+    // Only keep ticking while there are timers to service.
+    //
+    if ((moduleContext->Statistics.TimersPending > 0) &&
+        (! moduleContext->Closing))
+    {
+        WdfTimerStart(moduleContext->TickTimer,
+                      WDF_REL_TIMEOUT_IN_MS(moduleContext->TickMilliseconds));
+    }
+    else
+    {
+        moduleContext->TickTimerStarted = FALSE;
+    }
+
+    DMF_ModuleUnlock(dmfModule);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+// WDF Module Callbacks
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+// DMF Module Callbacks
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+
+#pragma code_seg("PAGE")
+_Function_class_(DMF_Open)
+_IRQL_requires_max_(PASSIVE_LEVEL)
+_Must_inspect_result_
+static
+NTSTATUS
+DMF_TimerWheel_Open(
+    _In_ DMFMODULE DmfModule
+    )
+/*++
+
+Routine Description:
+
+    Initialize an instance of a DMF Module of type TimerWheel.
+
+Arguments:
+
+    DmfModule - This Module's handle.
+
+Return Value:
+
+    NTSTATUS
+
+--*/
+{
+    NTSTATUS ntStatus;
+    DMF_CONTEXT_TimerWheel* moduleContext;
+    DMF_CONFIG_TimerWheel* moduleConfig;
+    WDF_OBJECT_ATTRIBUTES objectAttributes;
+    WDF_TIMER_CONFIG timerConfig;
+    ULONG slotIndex;
+
+    PAGED_CODE();
+
+    FuncEntry(DMF_TRACE);
+
+    moduleContext = DMF_CONTEXT_GET(DmfModule);
+    moduleConfig = DMF_CONFIG_GET(DmfModule);
+
+    if ((0 == moduleConfig->TickMilliseconds) ||
+        (0 == moduleConfig->NumberOfSlots))
+    {
+        TraceEvents(TRACE_LEVEL_ERROR, DMF_TRACE, "Invalid TickMilliseconds=%d NumberOfSlots=%d", moduleConfig->TickMilliseconds, moduleConfig->NumberOfSlots);
+        ntStatus = STATUS_INVALID_PARAMETER;
+        goto Exit;
+    }
+
+    // NOTE: Slots are parented to the Module (not deleted in Close) so that Clients
+    //       can still stop their timers while this Module is closing.
+    //
+    WDF_OBJECT_ATTRIBUTES_INIT(&objectAttributes);
+    objectAttributes.ParentObject = DmfModule;
+    ntStatus = WdfMemoryCreate(&objectAttributes,
+                               NonPagedPoolNx,
+                               MemoryTag,
+                               sizeof(LIST_ENTRY) * moduleConfig->NumberOfSlots,
+                               &moduleContext->SlotsMemory,
+                               (VOID**)&moduleContext->Slots);
+    if (! NT_SUCCESS(ntStatus))
+    {
+        TraceEvents(TRACE_LEVEL_ERROR, DMF_TRACE, "WdfMemoryCreate fails: ntStatus=%!STATUS!", ntStatus);
+        goto Exit;
+    }
+
+    for (slotIndex = 0; slotIndex < moduleConfig->NumberOfSlots; slotIndex++)
+    {
+        InitializeListHead(&moduleContext->Slots[slotIndex]);
+    }
+    InitializeListHead(&moduleContext->ExpiredList);
+
+    moduleContext->NumberOfSlots = moduleConfig->NumberOfSlots;
+    moduleContext->TickMilliseconds = moduleConfig->TickMilliseconds;
+    moduleContext->TickTime100ns = (ULONGLONG)moduleConfig->TickMilliseconds * WDF_TIMEOUT_TO_MS;
+    moduleContext->StartTime100ns = TimerWheel_CurrentTime100nsGet();
+    moduleContext->CurrentTick = 0;
+    moduleContext->TickTimerStarted = FALSE;
+    moduleContext->Closing = FALSE;
+    moduleContext->ExecutingTimer = NULL;
+    RtlZeroMemory(&moduleContext->Statistics,
+                  sizeof(moduleContext->Statistics));
+
+    ntStatus = DMF_Portable_EventCreate(&moduleContext->ExecutingTimerDoneEvent,
+                                        NotificationEvent,
+                                        TRUE);
+    if (! NT_SUCCESS(ntStatus))
+    {
+        TraceEvents(TRACE_LEVEL_ERROR, DMF_TRACE, "DMF_Portable_EventCreate fails: ntStatus=%!STATUS!", ntStatus);
+        goto Exit;
+    }
+
+    // Timer callbacks are called at PASSIVE_LEVEL.
+    //
+    WDF_TIMER_CONFIG_INIT(&timerConfig,
+                          TimerWheel_TickTimerHandler);
+
+    WDF_OBJECT_ATTRIBUTES_INIT(&objectAttributes);
+    objectAttributes.ParentObject = DmfModule;
+    objectAttributes.ExecutionLevel = WdfExecutionLevelPassive;
+
+    ntStatus = WdfTimerCreate(&timerConfig,
+                              &objectAttributes,
+                              &moduleContext->TickTimer);
+    if (! NT_SUCCESS(ntStatus))
+    {
+        TraceEvents(TRACE_LEVEL_ERROR, DMF_TRACE, "WdfTimerCreate fails: ntStatus=%!STATUS!", ntStatus);
+        DMF_Portable_EventClose(&moduleContext->ExecutingTimerDoneEvent);
+        goto Exit;
+    }
+
+Exit:
+
+    FuncExit(DMF_TRACE, "ntStatus=%!STATUS!", ntStatus);
+
+    return ntStatus;
+}
+#pragma code_seg()
+
+#pragma code_seg("PAGE")
+_Function_class_(DMF_Close)
+_IRQL_requires_max_(PASSIVE_LEVEL)
+static
+VOID
+DMF_TimerWheel_Close(
+    _In_ DMFMODULE DmfModule
+    )
+/*++
+
+Routine Description:
+
+    Uninitialize an instance of a DMF Module of type TimerWheel.
+
+Arguments:
+
+    DmfModule - This Module's handle.
+
+Return Value:
+
+    None
+
+--*/
+{
+    DMF_CONTEXT_TimerWheel* moduleContext;
+
+    PAGED_CODE();
+
+    FuncEntry(DMF_TRACE);
+
+    moduleContext = DMF_CONTEXT_GET(DmfModule);
+
+    DMF_ModuleLock(DmfModule);
+    moduleContext->Closing = TRUE;
+    DMF_ModuleUnlock(DmfModule);
+
+    // Stop the tick timer and wait for a running tick to finish.
+    // The tick does not restart itself after Closing is set.
+    //
+    WdfTimerStop(moduleContext->TickTimer,
+                 TRUE);
+    WdfObjectDelete(moduleContext->TickTimer);
+    moduleContext->TickTimer = NULL;
+    moduleContext->TickTimerStarted = FALSE;
+
+    if (moduleContext->Statistics.TimersPending > 0)
+    {
+        // These timers will never expire. Their owners must stop them.
+        //
+        TraceEvents(TRACE_LEVEL_WARNING, DMF_TRACE, "TimersPending=%d", moduleContext->Statistics.TimersPending);
+    }
+
+    DmfAssert(NULL == moduleContext->ExecutingTimer);
+    DMF_Portable_EventClose(&moduleContext->ExecutingTimerDoneEvent);
+
+    FuncExitVoid(DMF_TRACE);
+}
+#pragma code_seg()
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+// Public Calls by Client
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+
+#pragma code_seg("PAGE")
+_IRQL_requires_max_(PASSIVE_LEVEL)
+_Must_inspect_result_
+NTSTATUS
+DMF_TimerWheel_Create(
+    _In_ WDFDEVICE Device,
+    _In_ DMF_MODULE_ATTRIBUTES* DmfModuleAttributes,
+    _In_ WDF_OBJECT_ATTRIBUTES* ObjectAttributes,
+    _Out_ DMFMODULE* DmfModule
+    )
+/*++
+
+Routine Description:
+
+    Create an instance of a DMF Module of type TimerWheel.
+
+Arguments:
+
+    Device - Client's WDFDEVICE object.
+    DmfModuleAttributes - Opaque structure that contains parameters DMF needs to initialize the Module.
+    ObjectAttributes - WDF object attributes for DMFMODULE.
+    DmfModule - Address of the location where the created DMFMODULE handle is returned.
+
+Return Value:
+
+    NTSTATUS
+
+--*/
+{
+    NTSTATUS ntStatus;
+    DMF_MODULE_DESCRIPTOR dmfModuleDescriptor_TimerWheel;
+    DMF_CALLBACKS_DMF dmfCallbacksDmf_TimerWheel;
+
+    PAGED_CODE();
+
+    FuncEntry(DMF_TRACE);
+
+    DMF_CALLBACKS_DMF_INIT(&dmfCallbacksDmf_TimerWheel);
+    dmfCallbacksDmf_TimerWheel.DeviceOpen = DMF_TimerWheel_Open;
+    dmfCallbacksDmf_TimerWheel.DeviceClose = DMF_TimerWheel_Close;
+
+    DMF_MODULE_DESCRIPTOR_INIT_CONTEXT_TYPE(dmfModuleDescriptor_TimerWheel,
+                                            TimerWheel,
+                                            DMF_CONTEXT_TimerWheel,
+                                            DMF_MODULE_OPTIONS_DISPATCH_MAXIMUM,
+                                            DMF_MODULE_OPEN_OPTION_OPEN_Create);
+
+    dmfModuleDescriptor_TimerWheel.CallbacksDmf = &dmfCallbacksDmf_TimerWheel;
+
+    ntStatus = DMF_ModuleCreate(Device,
+                                DmfModuleAttributes,
+                                ObjectAttributes,
+                                &dmfModuleDescriptor_TimerWheel,
+                                DmfModule);
+    if (! NT_SUCCESS(ntStatus))
+    {
+        TraceEvents(TRACE_LEVEL_ERROR, DMF_TRACE, "DMF_ModuleCreate fails: ntStatus=%!STATUS!", ntStatus);
+    }
+
+    FuncExit(DMF_TRACE, "ntStatus=%!STATUS!", ntStatus);
+
+    return(ntStatus);
+}
+#pragma code_seg()
+
+// Module Methods
+//
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+VOID
+DMF_TimerWheel_StatisticsGet(
+    _In_ DMFMODULE DmfModule,
+    _Out_ TimerWheel_Statistics* Statistics
+    )
+/*++
+
+Routine Description:
+
+    Returns the statistics this Module maintains so that Clients can compare the
+    cost of the wheel with the cost of one WDFTIMER per timer.
+
+Arguments:
+
+    DmfModule - This Module's handle.
+    Statistics - Returns the statistics.
+
+Return Value:
+
+    None
+
+--*/
+{
+    DMF_CONTEXT_TimerWheel* moduleContext;
+
+    FuncEntry(DMF_TRACE);
+
+    DMFMODULE_VALIDATE_IN_METHOD(DmfModule,
+                                 TimerWheel);
+
+    moduleContext = DMF_CONTEXT_GET(DmfModule);
+
+    DMF_ModuleLock(DmfModule);
+    *Statistics = moduleContext->Statistics;
+    DMF_ModuleUnlock(DmfModule);
+
+    FuncExitVoid(DMF_TRACE);
+}
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+VOID
+DMF_TimerWheel_TimerInitialize(
+    _In_ DMFMODULE DmfModule,
+    _Out_ TimerWheel_Timer* Timer,
+    _In_ EVT_DMF_TimerWheel_TimerExpired* EvtTimerWheelTimerExpired,
+    _In_opt_ VOID* ClientCallbackContext
+    )
+/*++
+
+Routine Description:
+
+    Initializes a Client allocated timer so that it can be started using this Module.
+
+Arguments:
+
+    DmfModule - This Module's handle.
+    Timer - The timer to initialize.
+    EvtTimerWheelTimerExpired - Callback called when the timer expires.
+    ClientCallbackContext - Context passed to EvtTimerWheelTimerExpired.
+
+Return Value:
+
+    None
+
+--*/
+{
+    FuncEntry(DMF_TRACE);
+
+    DMFMODULE_VALIDATE_IN_METHOD(DmfModule,
+                                 TimerWheel);
+
+    DmfAssert(EvtTimerWheelTimerExpired != NULL);
+
+    Timer->ListEntry.Flink = NULL;
+    Timer->ListEntry.Blink = NULL;
+    Timer->ExpirationTick = 0;
+    Timer->EvtTimerWheelTimerExpired = EvtTimerWheelTimerExpired;
+    Timer->ClientCallbackContext = ClientCallbackContext;
+    Timer->Armed = FALSE;
+
+    FuncExitVoid(DMF_TRACE);
+}
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+BOOLEAN
+DMF_TimerWheel_TimerStart(
+    _In_ DMFMODULE DmfModule,
+    _Inout_ TimerWheel_Timer* Timer,
+    _In_ ULONGLONG TimeoutMilliseconds
+    )
+/*++
+
+Routine Description:
+
+    Starts (or restarts) a timer. The timer expires on the first tick at or after
+    the given timeout (never before it).
+
+Arguments:
+
+    DmfModule - This Module's handle.
+    Timer - The timer to start. It must have been initialized by DMF_TimerWheel_TimerInitialize().
+    TimeoutMilliseconds - Relative timeout in milliseconds.
+
+Return Value:
+
+    TRUE if the timer was already started (it is restarted with the new timeout).
+    FALSE otherwise.
+
+--*/
+{
+    DMF_CONTEXT_TimerWheel* moduleContext;
+    ULONGLONG expirationTime100ns;
+    ULONGLONG expirationTick;
+    BOOLEAN timerWasStarted;
+
+    FuncEntry(DMF_TRACE);
+
+    DMFMODULE_VALIDATE_IN_METHOD(DmfModule,
+                                 TimerWheel);
+
+    DmfAssert(Timer->EvtTimerWheelTimerExpired != NULL);
+
+    moduleContext = DMF_CONTEXT_GET(DmfModule);
+
+    DMF_ModuleLock(DmfModule);
+
+    timerWasStarted = Timer->Armed;
+    if (timerWasStarted)
+    {
+        RemoveEntryList(&Timer->ListEntry);
+    }
+    else
+    {
+        Timer->Armed = TRUE;
+        moduleContext->Statistics.TimersPending++;
+    }
+
+    // Round up so that the timer never expires before its timeout.
+    // A timer never expires in a tick whose slot has already been processed.
+    //
+    expirationTime100ns = TimerWheel_CurrentTime100nsGet() - moduleContext->StartTime100ns + (TimeoutMilliseconds * WDF_TIMEOUT_TO_MS);
+    expirationTick = (expirationTime100ns + moduleContext->TickTime100ns - 1) / moduleContext->TickTime100ns;
+    if (expirationTick <= moduleContext->CurrentTick)
+    {
+        expirationTick = moduleContext->CurrentTick + 1;
+    }
+    Timer->ExpirationTick = expirationTick;
+    InsertTailList(&moduleContext->Slots[expirationTick % moduleContext->NumberOfSlots],
+                   &Timer->ListEntry);
+    moduleContext->Statistics.TimersStarted++;
+
+    TimerWheel_TickTimerStart(DmfModule);
+
+    DMF_ModuleUnlock(DmfModule);
+
+    FuncExit(DMF_TRACE, "timerWasStarted=%d", timerWasStarted);
+
+    return timerWasStarted;
+}
+
+_When_(Wait == TRUE, _IRQL_requires_max_(PASSIVE_LEVEL))
+_When_(Wait == FALSE, _IRQL_requires_max_(DISPATCH_LEVEL))
+BOOLEAN
+DMF_TimerWheel_TimerStop(
+    _In_ DMFMODULE DmfModule,
+    _Inout_ TimerWheel_Timer* Timer,
+    _In_ BOOLEAN Wait
+    )
+/*++
+
+Routine Description:
+
+    Stops a timer. Optionally, waits for its callback to return if the callback is running.
+
+Arguments:
+
+    DmfModule - This Module's handle.
+    Timer - The timer to stop.
+    Wait - If TRUE, wait for the timer's callback to return if it is running.
+           NOTE: Do not set this to TRUE from the timer's own callback.
+
+Return Value:
+
+    TRUE if the timer was started and is now stopped. Its callback will not be called.
+    FALSE if the timer was not started or its callback is running or has already run.
+
+--*/
+{
+    DMF_CONTEXT_TimerWheel* moduleContext;
+    BOOLEAN timerWasStarted;
+    NTSTATUS ntStatus;
+
+    FuncEntry(DMF_TRACE);
+
+    // This Method may be called while this Module closes so that Clients can
+    // stop their timers during their own Close.
+    //
+    DMFMODULE_VALIDATE_IN_METHOD_CLOSING_OK(DmfModule,
+                                            TimerWheel);
+
+    moduleContext = DMF_CONTEXT_GET(DmfModule);
+
+    DMF_ModuleLock(DmfModule);
+
+    timerWasStarted = Timer->Armed;
+    if (timerWasStarted)
+    {
+        // The timer is either in its slot or in the expired list.
+        //
+        RemoveEntryList(&Timer->ListEntry);
+        Timer->Armed = FALSE;
+        DmfAssert(moduleContext->Statistics.TimersPending > 0);
+        moduleContext->Statistics.TimersPending--;
+        moduleContext->Statistics.TimersStopped++;
+    }
+
+    if (Wait)
+    {
+        while (moduleContext->ExecutingTimer == Timer)
+        {
+            DMF_ModuleUnlock(DmfModule);
+            ntStatus = DMF_Portable_EventWaitForSingleObject(&moduleContext->ExecutingTimerDoneEvent,
+                                                             NULL,
+                                                             FALSE);
+            DmfAssert(NT_SUCCESS(ntStatus));
+            DMF_ModuleLock(DmfModule);
+        }
+    }
+
+    DMF_ModuleUnlock(DmfModule);
+
+    FuncExit(DMF_TRACE, "timerWasStarted=%d", timerWasStarted);
+
+    return timerWasStarted;
+}
+
+// eof: Dmf_TimerWheel.c
+//
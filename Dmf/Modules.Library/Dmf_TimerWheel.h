@@ -0,0 +1,158 @@
+/*++
+
+    Copyright (c) Microsoft Corporation. All rights reserved.
+    Licensed under the MIT license.
+
+Module Name:
+
+    Dmf_TimerWheel.h
+
+Abstract:
+
+    Companion file to Dmf_TimerWheel.c.
+
+Environment:
+
+    Kernel-mode Driver Framework
+    User-mode Driver Framework
+
+--*/
+
+#pragma once
+
+typedef struct _TimerWheel_Timer TimerWheel_Timer;
+
+// Callback function called when a timer expires.
+//
+typedef
+_Function_class_(EVT_DMF_TimerWheel_TimerExpired)
+_IRQL_requires_max_(PASSIVE_LEVEL)
+_IRQL_requires_same_
+VOID
+EVT_DMF_TimerWheel_TimerExpired(_In_ DMFMODULE DmfModule,
+                                _In_ TimerWheel_Timer* Timer,
+                                _In_opt_ VOID* ClientCallbackContext);
+
+// A single timer serviced by this Module. The Client allocates this structure
+// (usually inside its own per object context) and initializes it using
+// DMF_TimerWheel_TimerInitialize(). Client must not access the members directly.
+//
+struct _TimerWheel_Timer
+{
+    // Links the timer into its slot or into the list of expired timers.
+    //
+    LIST_ENTRY ListEntry;
+    // Tick number at which the timer expires.
+    //
+    ULONGLONG ExpirationTick;
+    // Client callback and its context.
+    //
+    EVT_DMF_TimerWheel_TimerExpired* EvtTimerWheelTimerExpired;
+    VOID* ClientCallbackContext;
+    // Indicates the timer is in a slot or in the list of expired timers.
+    //
+    BOOLEAN Armed;
+};
+
+// Statistics maintained by this Module.
+//
+typedef struct
+{
+    // Number of times a timer has been started.
+    //
+    ULONG64 TimersStarted;
+    // Number of times a started timer has been stopped before it expired.
+    //
+    ULONG64 TimersStopped;
+    // Number of timer callbacks that have been called.
+    //
+    ULONG64 TimersExpired;
+    // Number of timers currently started.
+    //
+    ULONG TimersPending;
+    // Number of times the tick timer has run.
+    //
+    ULONG64 Ticks;
+    // Largest number of timers that expired in a single tick.
+    //
+    ULONG MaximumTimersExpiredPerTick;
+    // Total time spent in the tick timer callback, including the Client callbacks.
+    //
+    ULONG64 TickTime100ns;
+} TimerWheel_Statistics;
+
+// Client uses this structure to configure the Module specific parameters.
+//
+typedef struct
+{
+    // Resolution of the timers in milliseconds. All timers that expire in the
+    // same tick are delivered together by a single timer callback.
+    //
+    ULONG TickMilliseconds;
+    // Number of slots in the wheel. Timers further away than this number of ticks
+    // stay in their slot until the wheel comes around to them again.
+    //
+    ULONG NumberOfSlots;
+} DMF_CONFIG_TimerWheel;
+
+// Callback to set default (non-zero) values in DMF_CONFIG_TimerWheel
+// referenced by DECLARE_DMF_MODULE_EX().
+// NOTE: This callback is called by DMF not by Clients directly.
+//
+__forceinline
+VOID
+DMF_CONFIG_TimerWheel_DEFAULT(
+    _Inout_ DMF_CONFIG_TimerWheel* ModuleConfig
+    )
+{
+    ModuleConfig->TickMilliseconds = 16;
+    ModuleConfig->NumberOfSlots = 256;
+}
+
+// This macro declares the following functions:
+// DMF_TimerWheel_ATTRIBUTES_INIT()
+// DMF_CONFIG_TimerWheel_AND_ATTRIBUTES_INIT()
+// DMF_TimerWheel_Create()
+//
+// DMF_CONFIG_TimerWheel_DEFAULT() must be declared above.
+//
+DECLARE_DMF_MODULE_EX(TimerWheel)
+
+// Module Methods
+//
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+VOID
+DMF_TimerWheel_StatisticsGet(
+    _In_ DMFMODULE DmfModule,
+    _Out_ TimerWheel_Statistics* Statistics
+    );
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+VOID
+DMF_TimerWheel_TimerInitialize(
+    _In_ DMFMODULE DmfModule,
+    _Out_ TimerWheel_Timer* Timer,
+    _In_ EVT_DMF_TimerWheel_TimerExpired* EvtTimerWheelTimerExpired,
+    _In_opt_ VOID* ClientCallbackContext
+    );
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+BOOLEAN
+DMF_TimerWheel_TimerStart(
+    _In_ DMFMODULE DmfModule,
+    _Inout_ TimerWheel_Timer* Timer,
+    _In_ ULONGLONG TimeoutMilliseconds
+    );
+
+_When_(Wait == TRUE, _IRQL_requires_max_(PASSIVE_LEVEL))
+_When_(Wait == FALSE, _IRQL_requires_max_(DISPATCH_LEVEL))
+BOOLEAN
+DMF_TimerWheel_TimerStop(
+    _In_ DMFMODULE DmfModule,
+    _Inout_ TimerWheel_Timer* Timer,
+    _In_ BOOLEAN Wait
+    );
+
+// eof: Dmf_TimerWheel.h
+//
@@ -34,6 +34,20 @@ Environment:
 ///////////////////////////////////////////////////////////////////////////////////////////////////////
 //
 
+// Format of each entry in an input report backlog Ring Buffer.
+//
+#pragma pack(push, 1)
+typedef struct
+{
+    // Size of Report in bytes.
+    //
+    ULONG ReportSize;
+    // The report (up to VirtualHidMini_InputReportBacklogConfig.MaximumReportSize bytes).
+    //
+    UCHAR Report[ANYSIZE_ARRAY];
+} VirtualHidMini_BacklogItem;
+#pragma pack(pop)
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////////
 // Module Private Context
 ///////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -45,6 +59,25 @@ typedef struct _DMF_CONTEXT_VirtualHidMini
     // dequeued. Then, data to copy into the requests is retrieved from the Client.
     //
     WDFQUEUE ManualQueue;
+    // Input report backlog. There is one Ring Buffer per configured report ID.
+    // All the fields below are protected by the Module lock.
+    //
+    DMFMODULE DmfModuleRingBufferBacklog[VirtualHidMini_InputReportBacklogReportIdsMaximum];
+    VirtualHidMini_InputReportBacklogStatistics BacklogStatistics[VirtualHidMini_InputReportBacklogReportIdsMaximum];
+    // Maximum number of reports each backlog holds.
+    //
+    ULONG BacklogCapacity;
+    // Total number of reports in all the backlogs.
+    //
+    ULONG BacklogTotalDepth;
+    // Backlogs are drained round robin so that a busy report ID does not starve the others.
+    //
+    ULONG BacklogNextIndex;
+    // Entry used to read from the backlogs.
+    //
+    WDFMEMORY BacklogItemMemory;
+    VirtualHidMini_BacklogItem* BacklogItem;
+    ULONG BacklogItemSize;
 } DMF_CONTEXT_VirtualHidMini;
 
 // This macro declares the following function:
@@ -546,6 +579,153 @@ Exit:
     return ntStatus;
 }
 
+_IRQL_requires_max_(DISPATCH_LEVEL)
+_Must_inspect_result_
+static
+BOOLEAN
+VirtualHidMini_BacklogIndexGet(
+    _In_ DMFMODULE DmfModule,
+    _In_ UCHAR ReportId,
+    _Out_ ULONG* BacklogIndex
+    )
+/*++
+
+Routine Description:
+
+    Find the input report backlog of a given report ID.
+
+Arguments:
+
+    DmfModule - This Module's handle.
+    ReportId - The given report ID.
+    BacklogIndex - Index of the backlog of the given report ID.
+
+Return Value:
+
+    TRUE if the given report ID has a backlog.
+
+--*/
+{
+    DMF_CONFIG_VirtualHidMini* moduleConfig;
+    ULONG reportIdIndex;
+    BOOLEAN found;
+
+    moduleConfig = DMF_CONFIG_GET(DmfModule);
+
+    found = FALSE;
+    *BacklogIndex = 0;
+
+    // A device that does not use report IDs has a single backlog for all reports.
+    //
+    if ((1 == moduleConfig->InputReportBacklog.NumberOfReportIds) &&
+        (0 == moduleConfig->InputReportBacklog.ReportIds[0]))
+    {
+        found = TRUE;
+        goto Exit;
+    }
+
+    for (reportIdIndex = 0; reportIdIndex < moduleConfig->InputReportBacklog.NumberOfReportIds; reportIdIndex++)
+    {
+        if (moduleConfig->InputReportBacklog.ReportIds[reportIdIndex] == ReportId)
+        {
+            *BacklogIndex = reportIdIndex;
+            found = TRUE;
+            break;
+        }
+    }
+
+Exit:
+
+    return found;
+}
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+static
+VOID
+VirtualHidMini_BacklogDrain(
+    _In_ DMFMODULE DmfModule
+    )
+/*++
+
+Routine Description:
+
+    Complete as many pending reads as possible using the reports in the input report backlogs.
+
+Arguments:
+
+    DmfModule - This Module's handle.
+
+Return Value:
+
+    None
+
+--*/
+{
+    NTSTATUS ntStatus;
+    DMF_CONTEXT_VirtualHidMini* moduleContext;
+    DMF_CONFIG_VirtualHidMini* moduleConfig;
+    WDFREQUEST request;
+    ULONG backlogIndex;
+    ULONG reportIdIndex;
+
+    moduleContext = DMF_CONTEXT_GET(DmfModule);
+    moduleConfig = DMF_CONFIG_GET(DmfModule);
+
+    for (;;)
+    {
+        DMF_ModuleLock(DmfModule);
+
+        if (0 == moduleContext->BacklogTotalDepth)
+        {
+            DMF_ModuleUnlock(DmfModule);
+            break;
+        }
+
+        ntStatus = WdfIoQueueRetrieveNextRequest(moduleContext->ManualQueue,
+                                                 &request);
+        if (! NT_SUCCESS(ntStatus))
+        {
+            // No more pending reads. The reports stay in the backlog until the next read arrives.
+            //
+            DMF_ModuleUnlock(DmfModule);
+            break;
+        }
+
+        // Find the next backlog that has a report.
+        //
+        backlogIndex = moduleContext->BacklogNextIndex;
+        for (reportIdIndex = 0; reportIdIndex < moduleConfig->InputReportBacklog.NumberOfReportIds; reportIdIndex++)
+        {
+            if (moduleContext->BacklogStatistics[backlogIndex].Depth > 0)
+            {
+                break;
+            }
+            backlogIndex = (backlogIndex + 1) % moduleConfig->InputReportBacklog.NumberOfReportIds;
+        }
+        DmfAssert(moduleContext->BacklogStatistics[backlogIndex].Depth > 0);
+        moduleContext->BacklogNextIndex = (backlogIndex + 1) % moduleConfig->InputReportBacklog.NumberOfReportIds;
+
+        ntStatus = DMF_RingBuffer_Read(moduleContext->DmfModuleRingBufferBacklog[backlogIndex],
+                                       (UCHAR*)moduleContext->BacklogItem,
+                                       moduleContext->BacklogItemSize);
+        DmfAssert(NT_SUCCESS(ntStatus));
+        moduleContext->BacklogStatistics[backlogIndex].Depth--;
+        moduleContext->BacklogTotalDepth--;
+        if (NT_SUCCESS(ntStatus))
+        {
+            moduleContext->BacklogStatistics[backlogIndex].ReportsDelivered++;
+            ntStatus = VirtualHidMini_RequestCopyFromBuffer(request,
+                                                            moduleContext->BacklogItem->Report,
+                                                            moduleContext->BacklogItem->ReportSize);
+        }
+
+        DMF_ModuleUnlock(DmfModule);
+
+        WdfRequestComplete(request,
+                           ntStatus);
+    }
+}
+
 _Must_inspect_result_
 NTSTATUS
 VirtualHidMini_ReadReport(
@@ -579,8 +759,10 @@ Return Value:
 {
     NTSTATUS ntStatus;
     DMF_CONTEXT_VirtualHidMini* moduleContext;
+    DMF_CONFIG_VirtualHidMini* moduleConfig;
 
     moduleContext = DMF_CONTEXT_GET(DmfModule);
+    moduleConfig = DMF_CONFIG_GET(DmfModule);
 
     // Forward the request to manual queue.
     //
@@ -594,6 +776,15 @@ Return Value:
     else 
     {
         *CompleteRequest = FALSE;
+
+        // Reports that arrived while no read was pending are returned now.
+        // NOTE: The backlog is checked under the Module lock so that a report that is
+        //       enqueued at the same time is not left in the backlog.
+        //
+        if (moduleConfig->InputReportBacklog.NumberOfReportIds > 0)
+        {
+            VirtualHidMini_BacklogDrain(DmfModule);
+        }
     }
 
     return ntStatus;
@@ -1395,6 +1586,224 @@ Return Value:
 ///////////////////////////////////////////////////////////////////////////////////////////////////////
 //
 
+#pragma code_seg("PAGE")
+_Function_class_(DMF_ChildModulesAdd)
+_IRQL_requires_max_(PASSIVE_LEVEL)
+VOID
+DMF_VirtualHidMini_ChildModulesAdd(
+    _In_ DMFMODULE DmfModule,
+    _In_ DMF_MODULE_ATTRIBUTES* DmfParentModuleAttributes,
+    _In_ PDMFMODULE_INIT DmfModuleInit
+    )
+/*++
+
+Routine Description:
+
+    Configure and add the required Child Modules to the given Parent Module.
+
+Arguments:
+
+    DmfModule - The given Parent Module.
+    DmfParentModuleAttributes - Pointer to the parent DMF_MODULE_ATTRIBUTES structure.
+    DmfModuleInit - Opaque structure to be passed to DMF_DmfModuleAdd.
+
+Return Value:
+
+    None
+
+--*/
+{
+    DMF_MODULE_ATTRIBUTES moduleAttributes;
+    DMF_CONFIG_VirtualHidMini* moduleConfig;
+    DMF_CONTEXT_VirtualHidMini* moduleContext;
+    DMF_CONFIG_RingBuffer moduleConfigRingBuffer;
+    ULONG reportIdIndex;
+    ULONG numberOfReportIds;
+
+    UNREFERENCED_PARAMETER(DmfParentModuleAttributes);
+
+    PAGED_CODE();
+
+    FuncEntry(DMF_TRACE);
+
+    moduleConfig = DMF_CONFIG_GET(DmfModule);
+    moduleContext = DMF_CONTEXT_GET(DmfModule);
+
+    // NOTE: Invalid settings are rejected when the Module opens.
+    //
+    numberOfReportIds = moduleConfig->InputReportBacklog.NumberOfReportIds;
+    if (numberOfReportIds > VirtualHidMini_InputReportBacklogReportIdsMaximum)
+    {
+        numberOfReportIds = 0;
+    }
+
+    if (VirtualHidMini_InputReportBacklogPolicy_LatestValueWins == moduleConfig->InputReportBacklog.Policy)
+    {
+        moduleContext->BacklogCapacity = 1;
+    }
+    else
+    {
+        moduleContext->BacklogCapacity = moduleConfig->InputReportBacklog.Depth;
+    }
+    moduleContext->BacklogItemSize = FIELD_OFFSET(VirtualHidMini_BacklogItem, Report) +
+                                     moduleConfig->InputReportBacklog.MaximumReportSize;
+
+    if ((0 == moduleContext->BacklogCapacity) ||
+        (0 == moduleConfig->InputReportBacklog.MaximumReportSize))
+    {
+        numberOfReportIds = 0;
+    }
+
+    // RingBufferBacklog
+    // -----------------
+    //
+    for (reportIdIndex = 0; reportIdIndex < numberOfReportIds; reportIdIndex++)
+    {
+        DMF_CONFIG_RingBuffer_AND_ATTRIBUTES_INIT(&moduleConfigRingBuffer,
+                                                  &moduleAttributes);
+        moduleConfigRingBuffer.ItemCount = moduleContext->BacklogCapacity;
+        moduleConfigRingBuffer.ItemSize = moduleContext->BacklogItemSize;
+        // The Module lock decides what is dropped. This mode just makes sure writes never fail.
+        //
+        moduleConfigRingBuffer.Mode = RingBuffer_Mode_DeleteOldestIfFullOnWrite;
+        moduleAttributes.ClientModuleInstanceName = "RingBufferBacklog";
+        DMF_DmfModuleAdd(DmfModuleInit,
+                         &moduleAttributes,
+                         WDF_NO_OBJECT_ATTRIBUTES,
+                         &moduleContext->DmfModuleRingBufferBacklog[reportIdIndex]);
+    }
+
+    FuncExitVoid(DMF_TRACE);
+}
+#pragma code_seg()
+
+#pragma code_seg("PAGE")
+_Function_class_(DMF_Open)
+_IRQL_requires_max_(PASSIVE_LEVEL)
+_Must_inspect_result_
+static
+NTSTATUS
+DMF_VirtualHidMini_Open(
+    _In_ DMFMODULE DmfModule
+    )
+/*++
+
+Routine Description:
+
+    Initialize an instance of a DMF Module of type VirtualHidMini.
+
+Arguments:
+
+    DmfModule - This Module's handle.
+
+Return Value:
+
+    NTSTATUS
+
+--*/
+{
+    NTSTATUS ntStatus;
+    DMF_CONTEXT_VirtualHidMini* moduleContext;
+    DMF_CONFIG_VirtualHidMini* moduleConfig;
+    WDF_OBJECT_ATTRIBUTES objectAttributes;
+
+    PAGED_CODE();
+
+    FuncEntry(DMF_TRACE);
+
+    moduleContext = DMF_CONTEXT_GET(DmfModule);
+    moduleConfig = DMF_CONFIG_GET(DmfModule);
+
+    ntStatus = STATUS_SUCCESS;
+
+    if (0 == moduleConfig->InputReportBacklog.NumberOfReportIds)
+    {
+        // Input report backlog is not used.
+        //
+        goto Exit;
+    }
+
+    if ((moduleConfig->InputReportBacklog.NumberOfReportIds > VirtualHidMini_InputReportBacklogReportIdsMaximum) ||
+        (moduleConfig->InputReportBacklog.Policy >= VirtualHidMini_InputReportBacklogPolicy_Maximum) ||
+        (0 == moduleContext->BacklogCapacity) ||
+        (0 == moduleConfig->InputReportBacklog.MaximumReportSize))
+    {
+        DmfAssert(FALSE);
+        ntStatus = STATUS_INVALID_PARAMETER;
+        TraceEvents(TRACE_LEVEL_ERROR, DMF_TRACE, "Invalid InputReportBacklog settings");
+        goto Exit;
+    }
+
+    WDF_OBJECT_ATTRIBUTES_INIT(&objectAttributes);
+    objectAttributes.ParentObject = DmfModule;
+    ntStatus = WdfMemoryCreate(&objectAttributes,
+                               NonPagedPoolNx,
+                               MemoryTag,
+                               moduleContext->BacklogItemSize,
+                               &moduleContext->BacklogItemMemory,
+                               (VOID**)&moduleContext->BacklogItem);
+    if (! NT_SUCCESS(ntStatus))
+    {
+        TraceEvents(TRACE_LEVEL_ERROR, DMF_TRACE, "WdfMemoryCreate fails: ntStatus=%!STATUS!", ntStatus);
+        goto Exit;
+    }
+
+    moduleContext->BacklogTotalDepth = 0;
+    moduleContext->BacklogNextIndex = 0;
+    RtlZeroMemory(moduleContext->BacklogStatistics,
+                  sizeof(moduleContext->BacklogStatistics));
+
+Exit:
+
+    FuncExit(DMF_TRACE, "ntStatus=%!STATUS!", ntStatus);
+
+    return ntStatus;
+}
+#pragma code_seg()
+
+#pragma code_seg("PAGE")
+_Function_class_(DMF_Close)
+_IRQL_requires_max_(PASSIVE_LEVEL)
+static
+VOID
+DMF_VirtualHidMini_Close(
+    _In_ DMFMODULE DmfModule
+    )
+/*++
+
+Routine Description:
+
+    Uninitialize an instance of a DMF Module of type VirtualHidMini.
+
+Arguments:
+
+    DmfModule - This Module's handle.
+
+Return Value:
+
+    None
+
+--*/
+{
+    DMF_CONTEXT_VirtualHidMini* moduleContext;
+
+    PAGED_CODE();
+
+    FuncEntry(DMF_TRACE);
+
+    moduleContext = DMF_CONTEXT_GET(DmfModule);
+
+    if (moduleContext->BacklogItemMemory != NULL)
+    {
+        WdfObjectDelete(moduleContext->BacklogItemMemory);
+        moduleContext->BacklogItemMemory = NULL;
+        moduleContext->BacklogItem = NULL;
+    }
+
+    FuncExitVoid(DMF_TRACE);
+}
+#pragma code_seg()
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////////
 // Public Calls by Client
 ///////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -1431,12 +1840,18 @@ Return Value:
 {
     NTSTATUS ntStatus;
     DMF_MODULE_DESCRIPTOR dmfModuleDescriptor_VirtualHidMini;
+    DMF_CALLBACKS_DMF dmfCallbacksDmf_VirtualHidMini;
     DMF_CALLBACKS_WDF dmfCallbacksWdf_VirtualHidMini;
 
     PAGED_CODE();
 
     FuncEntry(DMF_TRACE);
 
+    DMF_CALLBACKS_DMF_INIT(&dmfCallbacksDmf_VirtualHidMini);
+    dmfCallbacksDmf_VirtualHidMini.ChildModulesAdd = DMF_VirtualHidMini_ChildModulesAdd;
+    dmfCallbacksDmf_VirtualHidMini.DeviceOpen = DMF_VirtualHidMini_Open;
+    dmfCallbacksDmf_VirtualHidMini.DeviceClose = DMF_VirtualHidMini_Close;
+
     DMF_CALLBACKS_WDF_INIT(&dmfCallbacksWdf_VirtualHidMini);
 #if defined(DMF_USER_MODE)
     dmfCallbacksWdf_VirtualHidMini.ModuleDeviceIoControl = DMF_VirtualHidMini_ModuleDeviceIoControl;
@@ -1449,9 +1864,10 @@ Return Value:
     DMF_MODULE_DESCRIPTOR_INIT_CONTEXT_TYPE(dmfModuleDescriptor_VirtualHidMini,
                                             VirtualHidMini,
                                             DMF_CONTEXT_VirtualHidMini,
-                                            DMF_MODULE_OPTIONS_PASSIVE,
+                                            DMF_MODULE_OPTIONS_DISPATCH_MAXIMUM,
                                             DMF_MODULE_OPEN_OPTION_OPEN_PrepareHardware);
 
+    dmfModuleDescriptor_VirtualHidMini.CallbacksDmf = &dmfCallbacksDmf_VirtualHidMini;
     dmfModuleDescriptor_VirtualHidMini.CallbacksWdf = &dmfCallbacksWdf_VirtualHidMini;
 
     ntStatus = DMF_ModuleCreate(Device,
@@ -1488,6 +1904,69 @@ Exit:
 // Module Methods
 //
 
+_IRQL_requires_max_(DISPATCH_LEVEL)
+_Must_inspect_result_
+NTSTATUS
+DMF_VirtualHidMini_InputReportBacklogStatisticsGet(
+    _In_ DMFMODULE DmfModule,
+    _In_ UCHAR ReportId,
+    _Out_ VirtualHidMini_InputReportBacklogStatistics* Statistics
+    )
+/*++
+
+Routine Description:
+
+    Returns the input report backlog counters of a given report ID. Clients use them to
+    choose the backlog depth.
+
+Arguments:
+
+    DmfModule - This Module's handle.
+    ReportId - The given report ID.
+    Statistics - The counters are written here.
+
+Return Value:
+
+    STATUS_SUCCESS - Statistics is valid.
+    STATUS_NOT_FOUND - The given report ID does not have a backlog.
+
+--*/
+{
+    NTSTATUS ntStatus;
+    DMF_CONTEXT_VirtualHidMini* moduleContext;
+    ULONG backlogIndex;
+
+    FuncEntry(DMF_TRACE);
+
+    DMFMODULE_VALIDATE_IN_METHOD(DmfModule,
+                                 VirtualHidMini);
+
+    moduleContext = DMF_CONTEXT_GET(DmfModule);
+
+    RtlZeroMemory(Statistics,
+                  sizeof(VirtualHidMini_InputReportBacklogStatistics));
+
+    if (! VirtualHidMini_BacklogIndexGet(DmfModule,
+                                         ReportId,
+                                         &backlogIndex))
+    {
+        ntStatus = STATUS_NOT_FOUND;
+        goto Exit;
+    }
+
+    DMF_ModuleLock(DmfModule);
+    *Statistics = moduleContext->BacklogStatistics[backlogIndex];
+    DMF_ModuleUnlock(DmfModule);
+
+    ntStatus = STATUS_SUCCESS;
+
+Exit:
+
+    FuncExit(DMF_TRACE, "ntStatus=%!STATUS!", ntStatus);
+
+    return ntStatus;
+}
+
 VOID
 DMF_VirtualHidMini_InputReportComplete(
     _In_ DMFMODULE DmfModule,
@@ -1542,6 +2021,148 @@ Return Value:
     FuncExitVoid(DMF_TRACE);
 }
 
+_IRQL_requires_max_(DISPATCH_LEVEL)
+_Must_inspect_result_
+NTSTATUS
+DMF_VirtualHidMini_InputReportEnqueue(
+    _In_ DMFMODULE DmfModule,
+    _In_reads_(ReportSize) UCHAR* Report,
+    _In_ ULONG ReportSize
+    )
+/*++
+
+Routine Description:
+
+    Send an input report to HIDClass. If a read is pending, it is completed with the report.
+    Otherwise, the report is kept in the backlog of its report ID and it is returned when
+    HIDClass sends the next read. If the backlog is full, the Module's configured policy
+    decides which report is dropped.
+
+Arguments:
+
+    DmfModule - This Module's handle.
+    Report - The report. The first byte is the report ID if the device uses report IDs.
+    ReportSize - Size of Report in bytes.
+
+Return Value:
+
+    STATUS_SUCCESS - The report has been returned to HIDClass or it is in the backlog.
+    STATUS_INVALID_DEVICE_REQUEST - The Module is not configured with an input report backlog.
+    STATUS_INVALID_PARAMETER - The report ID does not have a backlog or the report is too large.
+
+--*/
+{
+    NTSTATUS ntStatus;
+    DMF_CONTEXT_VirtualHidMini* moduleContext;
+    DMF_CONFIG_VirtualHidMini* moduleConfig;
+    VirtualHidMini_InputReportBacklogStatistics* backlogStatistics;
+    WDFREQUEST request;
+    ULONG backlogIndex;
+    UCHAR* segments[2];
+    ULONG segmentSizes[2];
+    ULONG segmentOffsets[2];
+
+    FuncEntry(DMF_TRACE);
+
+    DMFMODULE_VALIDATE_IN_METHOD(DmfModule,
+                                 VirtualHidMini);
+
+    moduleContext = DMF_CONTEXT_GET(DmfModule);
+    moduleConfig = DMF_CONFIG_GET(DmfModule);
+
+    if (0 == moduleConfig->InputReportBacklog.NumberOfReportIds)
+    {
+        ntStatus = STATUS_INVALID_DEVICE_REQUEST;
+        goto Exit;
+    }
+
+    if ((0 == ReportSize) ||
+        (ReportSize > moduleConfig->InputReportBacklog.MaximumReportSize) ||
+        (! VirtualHidMini_BacklogIndexGet(DmfModule,
+                                          Report[0],
+                                          &backlogIndex)))
+    {
+        DmfAssert(FALSE);
+        ntStatus = STATUS_INVALID_PARAMETER;
+        goto Exit;
+    }
+
+    backlogStatistics = &moduleContext->BacklogStatistics[backlogIndex];
+    request = NULL;
+
+    DMF_ModuleLock(DmfModule);
+
+    backlogStatistics->ReportsEnqueued++;
+
+    // Older reports must be returned first. So, only complete a read directly
+    // when all the backlogs are empty.
+    //
+    if (0 == moduleContext->BacklogTotalDepth)
+    {
+        ntStatus = WdfIoQueueRetrieveNextRequest(moduleContext->ManualQueue,
+                                                 &request);
+        if (! NT_SUCCESS(ntStatus))
+        {
+            request = NULL;
+        }
+    }
+
+    if (request != NULL)
+    {
+        backlogStatistics->ReportsDelivered++;
+    }
+    else
+    {
+        segments[0] = (UCHAR*)&ReportSize;
+        segmentSizes[0] = sizeof(ReportSize);
+        segmentOffsets[0] = FIELD_OFFSET(VirtualHidMini_BacklogItem, ReportSize);
+        segments[1] = Report;
+        segmentSizes[1] = ReportSize;
+        segmentOffsets[1] = FIELD_OFFSET(VirtualHidMini_BacklogItem, Report);
+        ntStatus = DMF_RingBuffer_SegmentsWrite(moduleContext->DmfModuleRingBufferBacklog[backlogIndex],
+                                                segments,
+                                                segmentSizes,
+                                                segmentOffsets,
+                                                ARRAYSIZE(segments));
+        DmfAssert(NT_SUCCESS(ntStatus));
+
+        if (backlogStatistics->Depth == moduleContext->BacklogCapacity)
+        {
+            // The Ring Buffer has overwritten its oldest report.
+            //
+            backlogStatistics->ReportsDropped++;
+        }
+        else
+        {
+            backlogStatistics->Depth++;
+            moduleContext->BacklogTotalDepth++;
+            if (backlogStatistics->Depth > backlogStatistics->DepthMaximum)
+            {
+                backlogStatistics->DepthMaximum = backlogStatistics->Depth;
+            }
+        }
+    }
+
+    DMF_ModuleUnlock(DmfModule);
+
+    if (request != NULL)
+    {
+        ntStatus = VirtualHidMini_RequestCopyFromBuffer(request,
+                                                        Report,
+                                                        ReportSize);
+        WdfRequestComplete(request,
+                           ntStatus);
+    }
+
+    ntStatus = STATUS_SUCCESS;
+
+Exit:
+
+    FuncExit(DMF_TRACE, "ntStatus=%!STATUS!", ntStatus);
+
+    return ntStatus;
+}
+
 _Must_inspect_result_
 NTSTATUS
 DMF_VirtualHidMini_InputReportGenerate(
@@ -111,6 +111,68 @@ typedef struct _HID_DEVICE_ATTRIBUTES {
 
 typedef UCHAR VirtualHidMini_HID_REPORT_DESCRIPTOR;
 
+// Maximum number of report IDs that can have an input report backlog.
+//
+#define VirtualHidMini_InputReportBacklogReportIdsMaximum   8
+
+// Indicates what happens when a report is added to a full input report backlog.
+//
+typedef enum
+{
+    // The oldest report in the backlog is dropped.
+    //
+    VirtualHidMini_InputReportBacklogPolicy_DropOldest = 0,
+    // Only the latest report is kept. It replaces the report in the backlog, if any.
+    // Use this for reports that describe a state rather than an event.
+    //
+    VirtualHidMini_InputReportBacklogPolicy_LatestValueWins,
+    VirtualHidMini_InputReportBacklogPolicy_Maximum
+} VirtualHidMini_InputReportBacklogPolicyType;
+
+// Input report backlog settings.
+//
+typedef struct
+{
+    // Number of entries in ReportIds. Zero means there is no backlog.
+    //
+    ULONG NumberOfReportIds;
+    // Report IDs that have a backlog. Each report ID has its own backlog.
+    // If the device does not use report IDs, set a single report ID of zero.
+    //
+    UCHAR ReportIds[VirtualHidMini_InputReportBacklogReportIdsMaximum];
+    // Maximum number of reports kept per report ID (VirtualHidMini_InputReportBacklogPolicy_DropOldest only).
+    //
+    ULONG Depth;
+    // Maximum size in bytes of a report (including the report ID).
+    //
+    ULONG MaximumReportSize;
+    // What happens when the backlog of a report ID is full.
+    //
+    VirtualHidMini_InputReportBacklogPolicyType Policy;
+} VirtualHidMini_InputReportBacklogConfig;
+
+// Input report backlog counters of a single report ID.
+//
+typedef struct
+{
+    // Number of reports passed to DMF_VirtualHidMini_InputReportEnqueue().
+    //
+    ULONG64 ReportsEnqueued;
+    // Number of reports returned to HIDClass.
+    //
+    ULONG64 ReportsDelivered;
+    // Number of reports dropped because the backlog was full (or replaced by a newer
+    // report when the policy is VirtualHidMini_InputReportBacklogPolicy_LatestValueWins).
+    //
+    ULONG64 ReportsDropped;
+    // Number of reports currently in the backlog.
+    //
+    ULONG Depth;
+    // Largest number of reports that have been in the backlog at the same time.
+    //
+    ULONG DepthMaximum;
+} VirtualHidMini_InputReportBacklogStatistics;
+
 typedef 
 _Must_inspect_result_
 NTSTATUS
@@ -196,6 +258,11 @@ typedef struct
     EVT_VirtualHidMini_SetFeature* SetFeature;
     EVT_VirtualHidMini_GetInputReport* GetInputReport;
     EVT_VirtualHidMini_SetOutputReport* SetOutputReport;
+
+    // Optional backlog for reports sent using DMF_VirtualHidMini_InputReportEnqueue()
+    // when HIDClass has no read pending.
+    //
+    VirtualHidMini_InputReportBacklogConfig InputReportBacklog;
 } DMF_CONFIG_VirtualHidMini;
 
 // This macro declares the following functions:
@@ -217,6 +284,24 @@ DMF_VirtualHidMini_InputReportComplete(
     _In_ NTSTATUS NtStatus
     );
 
+_IRQL_requires_max_(DISPATCH_LEVEL)
+_Must_inspect_result_
+NTSTATUS
+DMF_VirtualHidMini_InputReportBacklogStatisticsGet(
+    _In_ DMFMODULE DmfModule,
+    _In_ UCHAR ReportId,
+    _Out_ VirtualHidMini_InputReportBacklogStatistics* Statistics
+    );
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+_Must_inspect_result_
+NTSTATUS
+DMF_VirtualHidMini_InputReportEnqueue(
+    _In_ DMFMODULE DmfModule,
+    _In_reads_(ReportSize) UCHAR* Report,
+    _In_ ULONG ReportSize
+    );
+
 _Must_inspect_result_
 NTSTATUS
 DMF_VirtualHidMini_InputReportGenerate(
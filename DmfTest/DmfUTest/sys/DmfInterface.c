@@ -258,6 +258,42 @@ Return Value:
                      WDF_NO_OBJECT_ATTRIBUTES,
                      NULL);
 
+    // Tests_ThreadedBufferQueue
+    // -------------------------
+    //
+    DMF_Tests_ThreadedBufferQueue_ATTRIBUTES_INIT(&moduleAttributes);
+    DMF_DmfModuleAdd(DmfModuleInit,
+                     &moduleAttributes,
+                     WDF_NO_OBJECT_ATTRIBUTES,
+                     NULL);
+
+    // Tests_TimerWheel
+    // ----------------
+    //
+    DMF_Tests_TimerWheel_ATTRIBUTES_INIT(&moduleAttributes);
+    DMF_DmfModuleAdd(DmfModuleInit,
+                     &moduleAttributes,
+                     WDF_NO_OBJECT_ATTRIBUTES,
+                     NULL);
+
+    // Tests_RegisterMap
+    // -----------------
+    //
+    DMF_Tests_RegisterMap_ATTRIBUTES_INIT(&moduleAttributes);
+    DMF_DmfModuleAdd(DmfModuleInit,
+                     &moduleAttributes,
+                     WDF_NO_OBJECT_ATTRIBUTES,
+                     NULL);
+
+    // Tests_LatencyHistogram
+    // ----------------------
+    //
+    DMF_Tests_LatencyHistogram_ATTRIBUTES_INIT(&moduleAttributes);
+    DMF_DmfModuleAdd(DmfModuleInit,
+                     &moduleAttributes,
+                     WDF_NO_OBJECT_ATTRIBUTES,
+                     NULL);
+
     if (isFunctionDriver)
     {
         // Tests_DefaultTarget
@@ -325,6 +361,22 @@ Return Value:
                          &moduleAttributes,
                          WDF_NO_OBJECT_ATTRIBUTES,
                          NULL);
+
+        // Bench_Containers
+        // ----------------
+        //
+        DMF_CONFIG_Bench_Containers moduleConfigBench_Containers;
+        DMF_CONFIG_Bench_Containers_AND_ATTRIBUTES_INIT(&moduleConfigBench_Containers,
+                                                        &moduleAttributes);
+        // Allow remote targets to start runs. Also, run continuously so that the
+        // results are available in the traces.
+        //
+        moduleConfigBench_Containers.CreateDeviceInterface = TRUE;
+        moduleConfigBench_Containers.AutoRunDurationMilliseconds = 100;
+        DMF_DmfModuleAdd(DmfModuleInit,
+                         &moduleAttributes,
+                         WDF_NO_OBJECT_ATTRIBUTES,
+                         NULL);
     }
 }
 #pragma code_seg()